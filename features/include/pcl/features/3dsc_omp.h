@@ -0,0 +1,169 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_FEATURES_3DSC_OMP_H_
+#define PCL_FEATURES_3DSC_OMP_H_
+
+#include <pcl/features/3dsc.h>
+
+namespace pcl
+{
+  /** \brief ShapeContext3DEstimationOMP estimates the 3D shape context descriptor, in parallel, using the
+    * OpenMP standard.
+    *
+    * Each thread keeps its own neighbor buffers and remembers the local point density of every search surface
+    * point it has already visited, so the density radius search is run at most once per point and thread
+    * instead of once per neighbor of every query point. The bins of a neighbor are looked up with a binary
+    * search over the radii, elevation and azimuth divisions precomputed in initCompute ().
+    *
+    * The random X axes are drawn in advance, in the same order as \ref ShapeContext3DEstimation, so the results
+    * do not depend on the number of threads and match the serial estimator whenever every finite query point
+    * has at least one neighbor.
+    *
+    * \attention
+    * The convention for a 3D shape context descriptor is:
+    *   - if a query point's nearest neighbors cannot be estimated, the feature descriptor will be set to NaN (not a number), and the RF to 0
+    *   - it is impossible to estimate a 3D shape context descriptor for a
+    *     point that doesn't have finite 3D coordinates. Therefore, any point
+    *     that contains NaN data on x, y, or z, will have its boundary feature
+    *     property set to NaN.
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointNT, typename PointOutT = pcl::ShapeContext1980>
+  class ShapeContext3DEstimationOMP : public ShapeContext3DEstimation<PointInT, PointNT, PointOutT>
+  {
+    public:
+      typedef boost::shared_ptr<ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT> > Ptr;
+      typedef boost::shared_ptr<const ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT> > ConstPtr;
+
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::search_radius_;
+      using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::searchForNeighbors;
+      using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::radii_interval_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::theta_divisions_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::phi_divisions_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::volume_lut_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::azimuth_bins_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::elevation_bins_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::radius_bins_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::point_density_radius_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::descriptor_length_;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::rnd;
+      using ShapeContext3DEstimation<PointInT, PointNT, PointOutT>::computePoint;
+
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+      typedef typename Feature<PointInT, PointOutT>::PointCloudIn PointCloudIn;
+
+      /** \brief Constructor.
+        * \param[in] random If true the random seed is set to current time, else it is
+        * set to 12345 prior to computing the descriptor (used to select X axis)
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      ShapeContext3DEstimationOMP (bool random = false, unsigned int nr_threads = 0) :
+        ShapeContext3DEstimation<PointInT, PointNT, PointOutT> (random), threads_ (nr_threads)
+      {
+        feature_name_ = "ShapeContext3DEstimationOMP";
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+    protected:
+      /** \brief Estimate a descriptor for a given point. Safe to call concurrently.
+        * \param[in] index the index of the point to estimate a descriptor for
+        * \param[in] normals a pointer to the set of normals
+        * \param[in] x_axis the (random) direction used to build the X axis of the RF
+        * \param[out] rf the reference frame
+        * \param[out] desc the resultant estimated descriptor, expected to be zeroed
+        * \param[out] nn_indices buffer for the indices of the neighbors of the point
+        * \param[out] nn_dists buffer for the squared distances of the neighbors of the point
+        * \param[in,out] densities the local point density of every search surface point, or -1 if not known yet
+        * \return true if the descriptor was computed successfully, false if there was an error
+        * (e.g. the nearest neighbor didn't return any neighbors)
+        */
+      bool
+      computePoint (size_t index, const pcl::PointCloud<PointNT> &normals, const float x_axis[3],
+                    float rf[9], std::vector<float> &desc,
+                    std::vector<int> &nn_indices, std::vector<float> &nn_dists, std::vector<int> &densities);
+
+      /** \brief Find the bin of a value, given the bin boundaries. Equivalent to picking the first upper
+        * boundary that is not smaller than the value, the first bin being the default.
+        * \param[in] divisions the (sorted) bin boundaries, lower bound of the first bin included
+        * \param[in] value the value to look up
+        */
+      static inline size_t
+      findBin (const std::vector<float> &divisions, float value)
+      {
+        std::vector<float>::const_iterator it = std::lower_bound (divisions.begin () + 1, divisions.end (), value);
+        return (it == divisions.end () ? 0 : static_cast<size_t> (it - divisions.begin ()) - 1);
+      }
+
+    private:
+      /** \brief Estimate the actual feature.
+        * \param[out] output the resultant feature
+        */
+      void
+      computeFeature (PointCloudOut &output);
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud
+        */
+      void
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &) {}
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/3dsc_omp.hpp>
+#endif
+
+#endif  //#ifndef PCL_FEATURES_3DSC_OMP_H_
@@ -41,9 +41,11 @@
 #define PCL_ESF_H_
 
 #include <pcl/features/feature.h>
+#include <pcl/features/boost.h>
 #define GRIDSIZE 64
 #define GRIDSIZE_H GRIDSIZE/2
 #include <vector>
+#include <ctime>
 
 namespace pcl
 {
@@ -74,21 +76,32 @@ namespace pcl
       typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
 
       /** \brief Empty constructor. */
-      ESFEstimation () : lut_ (), local_cloud_ ()
+      ESFEstimation () : lut_ (GRIDSIZE * GRIDSIZE, 0), local_cloud_ (),
+                         seed_ (static_cast<unsigned int> (std::time (0))), threads_ (1)
       {
         feature_name_ = "ESFEstimation";
-        lut_.resize (GRIDSIZE);
-        for (int i = 0; i < GRIDSIZE; ++i)
-        {
-          lut_[i].resize (GRIDSIZE);
-          for (int j = 0; j < GRIDSIZE; ++j)
-            lut_[i][j].resize (GRIDSIZE);
-        }
-        //lut_.resize (boost::extents[GRIDSIZE][GRIDSIZE][GRIDSIZE]);
         search_radius_ = 0;
         k_ = 5;
       }
 
+      /** \brief Set the seed of the random number generators used to sample the point triples. Two runs with the same
+        * seed and the same input produce the same descriptor, independently of the number of threads.
+        * By default the seed is set to the current time.
+        * \param[in] seed the seed
+        */
+      inline void
+      setSeed (unsigned int seed) { seed_ = seed; }
+
+      /** \brief Get the seed of the random number generators. */
+      inline unsigned int
+      getSeed () const { return (seed_); }
+
+      /** \brief Set the number of threads used to sample the point triples. By default a single thread is used.
+        * \param[in] nr_threads the number of threads to use (0 uses as many threads as OpenMP provides)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
       /** \brief Overloaded computed method from pcl::Feature.
         * \param[out] output the resultant point cloud model dataset containing the estimated features
         */
@@ -108,7 +121,14 @@ namespace pcl
       int
       lci (const int x1, const int y1, const int z1, 
            const int x2, const int y2, const int z2, 
-           float &ratio, int &incnt, int &pointcount);
+           float &ratio, int &incnt, int &pointcount) const;
+
+      /** \brief Returns true if the voxel (x, y, z) of the occupancy grid is set. */
+      inline bool
+      isOccupied (const int x, const int y, const int z) const
+      {
+        return (((lut_[x * GRIDSIZE + y] >> z) & 1) != 0);
+      }
      
       /** \brief ... */
       void
@@ -128,13 +148,19 @@ namespace pcl
 
     private:
 
-      /** \brief ... */
-      //boost::multi_array<int, 3> lut_;
-      std::vector<std::vector<std::vector<int> > > lut_;
+      /** \brief The occupancy grid, one bit per voxel: the bit z of lut_[x * GRIDSIZE + y] is the voxel (x, y, z).
+        * This requires GRIDSIZE to be 64. */
+      std::vector<uint64_t> lut_;
       
       /** \brief ... */
       PointCloudIn local_cloud_;
 
+      /** \brief The seed of the random number generators. */
+      unsigned int seed_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
         * \param[out] output the output point cloud
         */
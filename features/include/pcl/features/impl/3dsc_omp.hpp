@@ -0,0 +1,257 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+#define PCL_FEATURES_IMPL_3DSC_OMP_HPP_
+
+#include <algorithm>
+#include <pcl/features/3dsc_omp.h>
+#include <pcl/common/utils.h>
+#include <pcl/common/geometry.h>
+#include <pcl/common/angles.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::computePoint (
+    size_t index, const pcl::PointCloud<PointNT> &normals, const float x_axis_seed[3],
+    float rf[9], std::vector<float> &desc,
+    std::vector<int> &nn_indices, std::vector<float> &nn_dists, std::vector<int> &densities)
+{
+  // The RF is formed as this x_axis | y_axis | normal
+  Eigen::Map<Eigen::Vector3f> x_axis (rf);
+  Eigen::Map<Eigen::Vector3f> y_axis (rf + 3);
+  Eigen::Map<Eigen::Vector3f> normal (rf + 6);
+
+  // Find every point within specified search_radius_
+  const size_t neighb_cnt = searchForNeighbors ((*indices_)[index], search_radius_, nn_indices, nn_dists);
+  if (neighb_cnt == 0)
+  {
+    for (size_t i = 0; i < desc.size (); ++i)
+      desc[i] = std::numeric_limits<float>::quiet_NaN ();
+
+    memset (rf, 0, sizeof (rf[0]) * 9);
+    return (false);
+  }
+
+  float minDist = std::numeric_limits<float>::max ();
+  int minIndex = -1;
+  for (size_t i = 0; i < nn_indices.size (); i++)
+  {
+    if (nn_dists[i] < minDist)
+    {
+      minDist = nn_dists[i];
+      minIndex = nn_indices[i];
+    }
+  }
+
+  // Get origin point
+  Vector3fMapConst origin = input_->points[(*indices_)[index]].getVector3fMap ();
+  // Get origin normal
+  // Use pre-computed normals
+  normal = normals[minIndex].getNormalVector3fMap ();
+
+  // Compute and store the RF direction
+  x_axis[0] = x_axis_seed[0];
+  x_axis[1] = x_axis_seed[1];
+  x_axis[2] = x_axis_seed[2];
+  if (!pcl::utils::equal (normal[2], 0.0f))
+    x_axis[2] = - (normal[0]*x_axis[0] + normal[1]*x_axis[1]) / normal[2];
+  else if (!pcl::utils::equal (normal[1], 0.0f))
+    x_axis[1] = - (normal[0]*x_axis[0] + normal[2]*x_axis[2]) / normal[1];
+  else if (!pcl::utils::equal (normal[0], 0.0f))
+    x_axis[0] = - (normal[1]*x_axis[1] + normal[2]*x_axis[2]) / normal[0];
+
+  x_axis.normalize ();
+
+  // Check if the computed x axis is orthogonal to the normal
+  assert (pcl::utils::equal (x_axis[0]*normal[0] + x_axis[1]*normal[1] + x_axis[2]*normal[2], 0.0f, 1E-6f));
+
+  // Store the 3rd frame vector
+  y_axis.matrix () = normal.cross (x_axis);
+
+  // Local point density searches run on their own buffers, as nn_indices is still being iterated
+  std::vector<int> neighbour_indices;
+  std::vector<float> neighbour_distances;
+
+  // For each point within radius
+  for (size_t ne = 0; ne < neighb_cnt; ne++)
+  {
+    if (pcl::utils::equal (nn_dists[ne], 0.0f))
+      continue;
+    // Get neighbours coordinates
+    Eigen::Vector3f neighbour = surface_->points[nn_indices[ne]].getVector3fMap ();
+
+    /// ----- Compute current neighbour polar coordinates -----
+    /// Get distance between the neighbour and the origin
+    float r = sqrtf (nn_dists[ne]);
+
+    /// Project point into the tangent plane
+    Eigen::Vector3f proj;
+    pcl::geometry::project (neighbour, origin, normal, proj);
+    proj -= origin;
+
+    /// Normalize to compute the dot product
+    proj.normalize ();
+
+    /// Compute the angle between the projection and the x axis in the interval [0,360]
+    Eigen::Vector3f cross = x_axis.cross (proj);
+    float phi = pcl::rad2deg (std::atan2 (cross.norm (), x_axis.dot (proj)));
+    phi = cross.dot (normal) < 0.f ? (360.0f - phi) : phi;
+    /// Compute the angle between the neighbour and the z axis (normal) in the interval [0, 180]
+    Eigen::Vector3f no = neighbour - origin;
+    no.normalize ();
+    float theta = normal.dot (no);
+    theta = pcl::rad2deg (acosf (std::min (1.0f, std::max (-1.0f, theta))));
+
+    // Compute the Bin(j, k, l) coordinates of current neighbour
+    const size_t j = findBin (radii_interval_, r);
+    const size_t k = findBin (theta_divisions_, theta);
+    const size_t l = findBin (phi_divisions_, phi);
+
+    // Local point density = number of points in a sphere of radius "point_density_radius_" around the current neighbour
+    int &point_density = densities[nn_indices[ne]];
+    if (point_density < 0)
+      point_density = searchForNeighbors (*surface_, nn_indices[ne], point_density_radius_, neighbour_indices, neighbour_distances);
+    // point_density is NOT always bigger than 0 (on error, searchForNeighbors returns 0), so we must check for that
+    if (point_density == 0)
+      continue;
+
+    float w = (1.0f / static_cast<float> (point_density)) *
+              volume_lut_[(l*elevation_bins_*radius_bins_) +  (k*radius_bins_) + j];
+
+    assert (w >= 0.0);
+    if (w == std::numeric_limits<float>::infinity ())
+      PCL_ERROR ("Shape Context Error INF!\n");
+    if (w != w)
+      PCL_ERROR ("Shape Context Error IND!\n");
+    /// Accumulate w into correspondant Bin(j,k,l)
+    desc[(l*elevation_bins_*radius_bins_) + (k*radius_bins_) + j] += w;
+
+    assert (desc[(l*elevation_bins_*radius_bins_) + (k*radius_bins_) + j] >= 0);
+  } // end for each neighbour
+
+  // 3DSC does not define a repeatable local RF, we set it to zero to signal it to the user
+  memset (rf, 0, sizeof (rf[0]) * 9);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::ShapeContext3DEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  assert (descriptor_length_ == 1980);
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+  // The serial estimator draws a random X axis only for the finite points which have neighbors. Find these points
+  // first, so that the X axes can be drawn up front in the same order
+  std::vector<char> has_neighbors (indices_->size (), 0);
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
+  {
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int point_index = 0; point_index < static_cast<int> (indices_->size ()); ++point_index)
+    {
+      if (isFinite ((*input_)[(*indices_)[point_index]]))
+        has_neighbors[point_index] = (searchForNeighbors ((*indices_)[point_index], search_radius_, nn_indices, nn_dists) > 0);
+    }
+  }
+
+  std::vector<float> x_axis_seeds (3 * indices_->size (), 0.0f);
+  for (size_t point_index = 0; point_index < indices_->size (); ++point_index)
+  {
+    if (!has_neighbors[point_index])
+      continue;
+    for (int d = 0; d < 3; ++d)
+      x_axis_seeds[3 * point_index + d] = static_cast<float> (rnd ());
+  }
+
+  bool is_dense = true;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads) reduction(&&:is_dense)
+#endif
+  {
+    // Per thread work buffers
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+    std::vector<float> descriptor (descriptor_length_);
+    std::vector<int> densities (surface_->points.size (), -1);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+    for (int point_index = 0; point_index < static_cast<int> (indices_->size ()); ++point_index)
+    {
+      // If the point is not finite, set the descriptor to NaN and continue
+      if (!isFinite ((*input_)[(*indices_)[point_index]]))
+      {
+        for (size_t i = 0; i < descriptor_length_; ++i)
+          output[point_index].descriptor[i] = std::numeric_limits<float>::quiet_NaN ();
+
+        memset (output[point_index].rf, 0, sizeof (output[point_index].rf[0]) * 9);
+        is_dense = false;
+        continue;
+      }
+
+      std::fill (descriptor.begin (), descriptor.end (), 0.0f);
+      if (!computePoint (point_index, *normals_, &x_axis_seeds[3 * point_index], output[point_index].rf, descriptor,
+                         nn_indices, nn_dists, densities))
+        is_dense = false;
+      for (size_t j = 0; j < descriptor_length_; ++j)
+        output[point_index].descriptor[j] = descriptor[j];
+    }
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_ShapeContext3DEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::ShapeContext3DEstimationOMP<T,NT,OutT>;
+
+#endif
@@ -45,6 +45,10 @@
 #include <pcl/common/common.h>
 #include <pcl/common/transforms.h>
 #include <vector>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
@@ -52,18 +56,183 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
     PointCloudIn &pc, std::vector<float> &hist)
 {
   const int binsize = 64;
-  unsigned int sample_size = 20000;
-  srand (static_cast<unsigned int> (time (0)));
-  int maxindex = static_cast<int> (pc.points.size ());
-
-  int index1, index2, index3;
-  std::vector<float> d2v, d1v, d3v, wt_d3;
-  std::vector<int> wt_d2;
-  d1v.reserve (sample_size);
-  d2v.reserve (sample_size * 3);
-  d3v.reserve (sample_size);
-  wt_d2.reserve (sample_size * 3);
-  wt_d3.reserve (sample_size);
+  const int sample_size = 20000;
+  // The triples are sampled in blocks, each one with its own random number generator seeded from seed_ and the
+  // block index. The blocks are merged in order, so the descriptor does not depend on the number of threads.
+  const int block_size = 200;
+  const int nr_blocks = sample_size / block_size;
+  const int maxindex = static_cast<int> (pc.points.size ());
+
+  std::vector<std::vector<float> > d2v (nr_blocks), d3v (nr_blocks), wt_d3 (nr_blocks);
+  std::vector<std::vector<int> > wt_d2 (nr_blocks);
+  // h_mix_ratio, h_a3_in, h_a3_out and h_a3_mix of each block
+  std::vector<std::vector<float> > h_blocks (nr_blocks, std::vector<float> (4 * binsize, 0.0f));
+
+  const float pih = static_cast<float>(M_PI) / 2.0f;
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for num_threads(nr_threads) default(shared) schedule(dynamic, 1)
+#endif
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    boost::mt19937 rng (seed_ ^ (static_cast<unsigned int> (block + 1) * 2654435761u));
+    boost::uniform_int<int> uniform_distribution (0, maxindex - 1);
+    boost::variate_generator<boost::mt19937&, boost::uniform_int<int> > rand_index (rng, uniform_distribution);
+
+    d2v[block].reserve (block_size * 3);
+    d3v[block].reserve (block_size);
+    wt_d2[block].reserve (block_size * 3);
+    wt_d3[block].reserve (block_size);
+
+    float *h_mix_ratio = &h_blocks[block][0];
+    float *h_a3_in = h_mix_ratio + binsize;
+    float *h_a3_out = h_a3_in + binsize;
+    float *h_a3_mix = h_a3_out + binsize;
+
+    int index1, index2, index3;
+    float ratio = 0.0;
+    float a, b, c, s;
+    int th1, th2, th3;
+    int vxlcnt = 0;
+    int pcnt1, pcnt2, pcnt3;
+    for (int nn_idx = 0; nn_idx < block_size; ++nn_idx)
+    {
+      // get a new random point
+      index1 = rand_index ();
+      index2 = rand_index ();
+      index3 = rand_index ();
+
+      if (index1==index2 || index1 == index3 || index2 == index3)
+      {
+        nn_idx--;
+        continue;
+      }
+
+      Eigen::Vector4f p1 = pc.points[index1].getVector4fMap ();
+      Eigen::Vector4f p2 = pc.points[index2].getVector4fMap ();
+      Eigen::Vector4f p3 = pc.points[index3].getVector4fMap ();
+
+      // A3
+      Eigen::Vector4f v21 (p2 - p1);
+      Eigen::Vector4f v31 (p3 - p1);
+      Eigen::Vector4f v23 (p2 - p3);
+      a = v21.norm (); b = v31.norm (); c = v23.norm (); s = (a+b+c) * 0.5f;
+      if (s * (s-a) * (s-b) * (s-c) <= 0.001f)
+        continue;
+
+      v21.normalize ();
+      v31.normalize ();
+      v23.normalize ();
+
+      //TODO: .dot gives nan's
+      th1 = static_cast<int> (pcl_round (acos (fabs (v21.dot (v31))) / pih * (binsize-1)));
+      th2 = static_cast<int> (pcl_round (acos (fabs (v23.dot (v31))) / pih * (binsize-1)));
+      th3 = static_cast<int> (pcl_round (acos (fabs (v23.dot (v21))) / pih * (binsize-1)));
+      if (th1 < 0 || th1 >= binsize)
+      {
+        nn_idx--;
+        continue;
+      }
+      if (th2 < 0 || th2 >= binsize)
+      {
+        nn_idx--;
+        continue;
+      }
+      if (th3 < 0 || th3 >= binsize)
+      {
+        nn_idx--;
+        continue;
+      }
+
+      //pcl::PointXYZ cog(((rand()%100)-50.0f) / 100.0f,((rand()%100)-50.0f) / 100.0f,((rand()%100)-50.0f) / 100.0f);
+      // D1
+      //                      d1v.push_back( pcl::euclideanDistance(cog, pc.points[index1]) );
+
+      // D2
+      d2v[block].push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index2]));
+      d2v[block].push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index3]));
+      d2v[block].push_back (pcl::euclideanDistance (pc.points[index2], pc.points[index3]));
+
+      int vxlcnt_sum = 0;
+      int p_cnt = 0;
+      // IN, OUT, MIXED, Ratio line tracing, index1->index2
+      {
+        const int xs = p1[0] < 0.0? static_cast<int>(floor(p1[0])+GRIDSIZE_H): static_cast<int>(ceil(p1[0])+GRIDSIZE_H-1);
+        const int ys = p1[1] < 0.0? static_cast<int>(floor(p1[1])+GRIDSIZE_H): static_cast<int>(ceil(p1[1])+GRIDSIZE_H-1);
+        const int zs = p1[2] < 0.0? static_cast<int>(floor(p1[2])+GRIDSIZE_H): static_cast<int>(ceil(p1[2])+GRIDSIZE_H-1);
+        const int xt = p2[0] < 0.0? static_cast<int>(floor(p2[0])+GRIDSIZE_H): static_cast<int>(ceil(p2[0])+GRIDSIZE_H-1);
+        const int yt = p2[1] < 0.0? static_cast<int>(floor(p2[1])+GRIDSIZE_H): static_cast<int>(ceil(p2[1])+GRIDSIZE_H-1);
+        const int zt = p2[2] < 0.0? static_cast<int>(floor(p2[2])+GRIDSIZE_H): static_cast<int>(ceil(p2[2])+GRIDSIZE_H-1);
+        wt_d2[block].push_back (lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1));
+        if (wt_d2[block].back () == 2)
+          h_mix_ratio[static_cast<int> (pcl_round (ratio * (binsize-1)))]++;
+        vxlcnt_sum += vxlcnt;
+        p_cnt += pcnt1;
+      }
+      // IN, OUT, MIXED, Ratio line tracing, index1->index3
+      {
+        const int xs = p1[0] < 0.0? static_cast<int>(floor(p1[0])+GRIDSIZE_H): static_cast<int>(ceil(p1[0])+GRIDSIZE_H-1);
+        const int ys = p1[1] < 0.0? static_cast<int>(floor(p1[1])+GRIDSIZE_H): static_cast<int>(ceil(p1[1])+GRIDSIZE_H-1);
+        const int zs = p1[2] < 0.0? static_cast<int>(floor(p1[2])+GRIDSIZE_H): static_cast<int>(ceil(p1[2])+GRIDSIZE_H-1);
+        const int xt = p3[0] < 0.0? static_cast<int>(floor(p3[0])+GRIDSIZE_H): static_cast<int>(ceil(p3[0])+GRIDSIZE_H-1);
+        const int yt = p3[1] < 0.0? static_cast<int>(floor(p3[1])+GRIDSIZE_H): static_cast<int>(ceil(p3[1])+GRIDSIZE_H-1);
+        const int zt = p3[2] < 0.0? static_cast<int>(floor(p3[2])+GRIDSIZE_H): static_cast<int>(ceil(p3[2])+GRIDSIZE_H-1);
+        wt_d2[block].push_back (lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2));
+        if (wt_d2[block].back () == 2)
+          h_mix_ratio[static_cast<int>(pcl_round (ratio * (binsize-1)))]++;
+        vxlcnt_sum += vxlcnt;
+        p_cnt += pcnt2;
+      }
+      // IN, OUT, MIXED, Ratio line tracing, index2->index3
+      {
+        const int xs = p2[0] < 0.0? static_cast<int>(floor(p2[0])+GRIDSIZE_H): static_cast<int>(ceil(p2[0])+GRIDSIZE_H-1);
+        const int ys = p2[1] < 0.0? static_cast<int>(floor(p2[1])+GRIDSIZE_H): static_cast<int>(ceil(p2[1])+GRIDSIZE_H-1);
+        const int zs = p2[2] < 0.0? static_cast<int>(floor(p2[2])+GRIDSIZE_H): static_cast<int>(ceil(p2[2])+GRIDSIZE_H-1);
+        const int xt = p3[0] < 0.0? static_cast<int>(floor(p3[0])+GRIDSIZE_H): static_cast<int>(ceil(p3[0])+GRIDSIZE_H-1);
+        const int yt = p3[1] < 0.0? static_cast<int>(floor(p3[1])+GRIDSIZE_H): static_cast<int>(ceil(p3[1])+GRIDSIZE_H-1);
+        const int zt = p3[2] < 0.0? static_cast<int>(floor(p3[2])+GRIDSIZE_H): static_cast<int>(ceil(p3[2])+GRIDSIZE_H-1);
+        wt_d2[block].push_back (lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3));
+        if (wt_d2[block].back () == 2)
+          h_mix_ratio[static_cast<int>(pcl_round(ratio * (binsize-1)))]++;
+        vxlcnt_sum += vxlcnt;
+        p_cnt += pcnt3;
+      }
+
+      // D3 ( herons formula )
+      d3v[block].push_back (sqrtf (sqrtf (s * (s-a) * (s-b) * (s-c))));
+      if (vxlcnt_sum <= 21)
+      {
+        wt_d3[block].push_back (0);
+        h_a3_out[th1] += static_cast<float> (pcnt3) / 32.0f;
+        h_a3_out[th2] += static_cast<float> (pcnt1) / 32.0f;
+        h_a3_out[th3] += static_cast<float> (pcnt2) / 32.0f;
+      }
+      else
+        if (p_cnt - vxlcnt_sum < 4)
+        {
+          h_a3_in[th1] += static_cast<float> (pcnt3) / 32.0f;
+          h_a3_in[th2] += static_cast<float> (pcnt1) / 32.0f;
+          h_a3_in[th3] += static_cast<float> (pcnt2) / 32.0f;
+          wt_d3[block].push_back (1);
+        }
+        else
+        {
+          h_a3_mix[th1] += static_cast<float> (pcnt3) / 32.0f;
+          h_a3_mix[th2] += static_cast<float> (pcnt1) / 32.0f;
+          h_a3_mix[th3] += static_cast<float> (pcnt2) / 32.0f;
+          wt_d3[block].push_back (static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt));
+        }
+    }
+  }
+
+  // Merge the blocks in order
+  std::vector<float> d2v_all, d3v_all, wt_d3_all;
+  std::vector<int> wt_d2_all;
+  d2v_all.reserve (sample_size * 3);
+  d3v_all.reserve (sample_size);
+  wt_d2_all.reserve (sample_size * 3);
+  wt_d3_all.reserve (sample_size);
 
   float h_in[binsize] = {0};
   float h_out[binsize] = {0};
@@ -73,203 +242,61 @@ pcl::ESFEstimation<PointInT, PointOutT>::computeESF (
   float h_a3_in[binsize] = {0};
   float h_a3_out[binsize] = {0};
   float h_a3_mix[binsize] = {0};
-  float h_d1[binsize] = {0};
 
   float h_d3_in[binsize] = {0};
   float h_d3_out[binsize] = {0};
   float h_d3_mix[binsize] = {0};
 
-  float ratio=0.0;
-  float pih = static_cast<float>(M_PI) / 2.0f;
-  float a,b,c,s;
-  int th1,th2,th3;
-  int vxlcnt = 0;
-  int pcnt1,pcnt2,pcnt3;
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (int block = 0; block < nr_blocks; ++block)
   {
-    // get a new random point
-    index1 = rand()%maxindex;
-    index2 = rand()%maxindex;
-    index3 = rand()%maxindex;
-
-    if (index1==index2 || index1 == index3 || index2 == index3)
+    d2v_all.insert (d2v_all.end (), d2v[block].begin (), d2v[block].end ());
+    d3v_all.insert (d3v_all.end (), d3v[block].begin (), d3v[block].end ());
+    wt_d2_all.insert (wt_d2_all.end (), wt_d2[block].begin (), wt_d2[block].end ());
+    wt_d3_all.insert (wt_d3_all.end (), wt_d3[block].begin (), wt_d3[block].end ());
+    for (int i = 0; i < binsize; ++i)
     {
-      nn_idx--;
-      continue;
+      h_mix_ratio[i] += h_blocks[block][i];
+      h_a3_in[i] += h_blocks[block][binsize + i];
+      h_a3_out[i] += h_blocks[block][2 * binsize + i];
+      h_a3_mix[i] += h_blocks[block][3 * binsize + i];
     }
-
-    Eigen::Vector4f p1 = pc.points[index1].getVector4fMap ();
-    Eigen::Vector4f p2 = pc.points[index2].getVector4fMap ();
-    Eigen::Vector4f p3 = pc.points[index3].getVector4fMap ();
-
-    // A3
-    Eigen::Vector4f v21 (p2 - p1);
-    Eigen::Vector4f v31 (p3 - p1);
-    Eigen::Vector4f v23 (p2 - p3);
-    a = v21.norm (); b = v31.norm (); c = v23.norm (); s = (a+b+c) * 0.5f;
-    if (s * (s-a) * (s-b) * (s-c) <= 0.001f)
-      continue;
-
-    v21.normalize ();
-    v31.normalize ();
-    v23.normalize ();
-
-    //TODO: .dot gives nan's
-    th1 = static_cast<int> (pcl_round (acos (fabs (v21.dot (v31))) / pih * (binsize-1)));
-    th2 = static_cast<int> (pcl_round (acos (fabs (v23.dot (v31))) / pih * (binsize-1)));
-    th3 = static_cast<int> (pcl_round (acos (fabs (v23.dot (v21))) / pih * (binsize-1)));
-    if (th1 < 0 || th1 >= binsize)
-    {
-      nn_idx--;
-      continue;
-    }
-    if (th2 < 0 || th2 >= binsize)
-    {
-      nn_idx--;
-      continue;
-    }
-    if (th3 < 0 || th3 >= binsize)
-    {
-      nn_idx--;
-      continue;
-    }
-
-    //pcl::PointXYZ cog(((rand()%100)-50.0f) / 100.0f,((rand()%100)-50.0f) / 100.0f,((rand()%100)-50.0f) / 100.0f);
-    // D1
-    //                      d1v.push_back( pcl::euclideanDistance(cog, pc.points[index1]) );
-
-    // D2
-    d2v.push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index2]));
-    d2v.push_back (pcl::euclideanDistance (pc.points[index1], pc.points[index3]));
-    d2v.push_back (pcl::euclideanDistance (pc.points[index2], pc.points[index3]));
-
-    int vxlcnt_sum = 0;
-    int p_cnt = 0;
-    // IN, OUT, MIXED, Ratio line tracing, index1->index2
-    {
-      const int xs = p1[0] < 0.0? static_cast<int>(floor(p1[0])+GRIDSIZE_H): static_cast<int>(ceil(p1[0])+GRIDSIZE_H-1);
-      const int ys = p1[1] < 0.0? static_cast<int>(floor(p1[1])+GRIDSIZE_H): static_cast<int>(ceil(p1[1])+GRIDSIZE_H-1);
-      const int zs = p1[2] < 0.0? static_cast<int>(floor(p1[2])+GRIDSIZE_H): static_cast<int>(ceil(p1[2])+GRIDSIZE_H-1);
-      const int xt = p2[0] < 0.0? static_cast<int>(floor(p2[0])+GRIDSIZE_H): static_cast<int>(ceil(p2[0])+GRIDSIZE_H-1);
-      const int yt = p2[1] < 0.0? static_cast<int>(floor(p2[1])+GRIDSIZE_H): static_cast<int>(ceil(p2[1])+GRIDSIZE_H-1);
-      const int zt = p2[2] < 0.0? static_cast<int>(floor(p2[2])+GRIDSIZE_H): static_cast<int>(ceil(p2[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt1));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int> (pcl_round (ratio * (binsize-1)))]++;
-      vxlcnt_sum += vxlcnt;
-      p_cnt += pcnt1;
-    }
-    // IN, OUT, MIXED, Ratio line tracing, index1->index3
-    {
-      const int xs = p1[0] < 0.0? static_cast<int>(floor(p1[0])+GRIDSIZE_H): static_cast<int>(ceil(p1[0])+GRIDSIZE_H-1);
-      const int ys = p1[1] < 0.0? static_cast<int>(floor(p1[1])+GRIDSIZE_H): static_cast<int>(ceil(p1[1])+GRIDSIZE_H-1);
-      const int zs = p1[2] < 0.0? static_cast<int>(floor(p1[2])+GRIDSIZE_H): static_cast<int>(ceil(p1[2])+GRIDSIZE_H-1);
-      const int xt = p3[0] < 0.0? static_cast<int>(floor(p3[0])+GRIDSIZE_H): static_cast<int>(ceil(p3[0])+GRIDSIZE_H-1);
-      const int yt = p3[1] < 0.0? static_cast<int>(floor(p3[1])+GRIDSIZE_H): static_cast<int>(ceil(p3[1])+GRIDSIZE_H-1);
-      const int zt = p3[2] < 0.0? static_cast<int>(floor(p3[2])+GRIDSIZE_H): static_cast<int>(ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs, ys, zs, xt, yt, zt, ratio, vxlcnt, pcnt2));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int>(pcl_round (ratio * (binsize-1)))]++;
-      vxlcnt_sum += vxlcnt;
-      p_cnt += pcnt2;
-    }
-    // IN, OUT, MIXED, Ratio line tracing, index2->index3
-    {
-      const int xs = p2[0] < 0.0? static_cast<int>(floor(p2[0])+GRIDSIZE_H): static_cast<int>(ceil(p2[0])+GRIDSIZE_H-1);
-      const int ys = p2[1] < 0.0? static_cast<int>(floor(p2[1])+GRIDSIZE_H): static_cast<int>(ceil(p2[1])+GRIDSIZE_H-1);
-      const int zs = p2[2] < 0.0? static_cast<int>(floor(p2[2])+GRIDSIZE_H): static_cast<int>(ceil(p2[2])+GRIDSIZE_H-1);
-      const int xt = p3[0] < 0.0? static_cast<int>(floor(p3[0])+GRIDSIZE_H): static_cast<int>(ceil(p3[0])+GRIDSIZE_H-1);
-      const int yt = p3[1] < 0.0? static_cast<int>(floor(p3[1])+GRIDSIZE_H): static_cast<int>(ceil(p3[1])+GRIDSIZE_H-1);
-      const int zt = p3[2] < 0.0? static_cast<int>(floor(p3[2])+GRIDSIZE_H): static_cast<int>(ceil(p3[2])+GRIDSIZE_H-1);
-      wt_d2.push_back (this->lci (xs,ys,zs,xt,yt,zt,ratio,vxlcnt,pcnt3));
-      if (wt_d2.back () == 2)
-        h_mix_ratio[static_cast<int>(pcl_round(ratio * (binsize-1)))]++;
-      vxlcnt_sum += vxlcnt;
-      p_cnt += pcnt3;
-    }
-
-    // D3 ( herons formula )
-    d3v.push_back (sqrtf (sqrtf (s * (s-a) * (s-b) * (s-c))));
-    if (vxlcnt_sum <= 21)
-    {
-      wt_d3.push_back (0);
-      h_a3_out[th1] += static_cast<float> (pcnt3) / 32.0f;
-      h_a3_out[th2] += static_cast<float> (pcnt1) / 32.0f;
-      h_a3_out[th3] += static_cast<float> (pcnt2) / 32.0f;
-    }
-    else
-      if (p_cnt - vxlcnt_sum < 4)
-      {
-        h_a3_in[th1] += static_cast<float> (pcnt3) / 32.0f;
-        h_a3_in[th2] += static_cast<float> (pcnt1) / 32.0f;
-        h_a3_in[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (1);
-      }
-      else
-      {
-        h_a3_mix[th1] += static_cast<float> (pcnt3) / 32.0f;
-        h_a3_mix[th2] += static_cast<float> (pcnt1) / 32.0f;
-        h_a3_mix[th3] += static_cast<float> (pcnt2) / 32.0f;
-        wt_d3.push_back (static_cast<float> (vxlcnt_sum) / static_cast<float> (p_cnt));
-      }
   }
+
   // Normalizing, get max
-  float maxd1 = 0;
   float maxd2 = 0;
   float maxd3 = 0;
 
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
-  {
-    // get max of Dx
-    if (d1v[nn_idx] > maxd1)
-      maxd1 = d1v[nn_idx];
-    if (d2v[nn_idx] > maxd2)
-      maxd2 = d2v[nn_idx];
-    if (d2v[sample_size + nn_idx] > maxd2)
-      maxd2 = d2v[sample_size + nn_idx];
-    if (d2v[sample_size*2 +nn_idx] > maxd2)
-      maxd2 = d2v[sample_size*2 +nn_idx];
-    if (d3v[nn_idx] > maxd3)
-      maxd3 = d3v[nn_idx];
-  }
+  for (size_t nn_idx = 0; nn_idx < d2v_all.size (); ++nn_idx)
+    if (d2v_all[nn_idx] > maxd2)
+      maxd2 = d2v_all[nn_idx];
+  for (size_t nn_idx = 0; nn_idx < d3v_all.size (); ++nn_idx)
+    if (d3v_all[nn_idx] > maxd3)
+      maxd3 = d3v_all[nn_idx];
 
   // Normalize and create histogram
   int index;
-  for (size_t nn_idx = 0; nn_idx < sample_size; ++nn_idx)
+  for (size_t nn_idx = 0; nn_idx < d3v_all.size (); ++nn_idx)
   {
-    h_d1[static_cast<int>(pcl_round (d1v[nn_idx] / maxd1 * (binsize-1)))]++ ;
+    index = static_cast<int>(pcl_round (d3v_all[nn_idx] / maxd3 * (binsize-1)));
+    if (index < 0 || index >= binsize)
+      continue;
 
-    if (wt_d3[nn_idx] >= 0.999) // IN
-    {
-      index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
-      if (index >= 0 && index < binsize)
-        h_d3_in[index]++;
-    }
+    if (wt_d3_all[nn_idx] >= 0.999) // IN
+      h_d3_in[index]++;
+    else if (wt_d3_all[nn_idx] <= 0.001) // OUT
+      h_d3_out[index]++ ;
     else
-    {
-      if (wt_d3[nn_idx] <= 0.001) // OUT
-      {
-        index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
-        if (index >= 0 && index < binsize)
-          h_d3_out[index]++ ;
-      }
-      else
-      {
-        index = static_cast<int>(pcl_round (d3v[nn_idx] / maxd3 * (binsize-1)));
-        if (index >= 0 && index < binsize)
-          h_d3_mix[index]++;
-      }
-    }
+      h_d3_mix[index]++;
   }
   //normalize and create histogram
-  for (size_t nn_idx = 0; nn_idx < d2v.size(); ++nn_idx )
+  for (size_t nn_idx = 0; nn_idx < d2v_all.size(); ++nn_idx )
   {
-    if (wt_d2[nn_idx] == 0)
-      h_in[static_cast<int>(pcl_round (d2v[nn_idx] / maxd2 * (binsize-1)))]++ ;
-    if (wt_d2[nn_idx] == 1)
-      h_out[static_cast<int>(pcl_round (d2v[nn_idx] / maxd2 * (binsize-1)))]++;
-    if (wt_d2[nn_idx] == 2)
-      h_mix[static_cast<int>(pcl_round (d2v[nn_idx] / maxd2 * (binsize-1)))]++ ;
+    if (wt_d2_all[nn_idx] == 0)
+      h_in[static_cast<int>(pcl_round (d2v_all[nn_idx] / maxd2 * (binsize-1)))]++ ;
+    if (wt_d2_all[nn_idx] == 1)
+      h_out[static_cast<int>(pcl_round (d2v_all[nn_idx] / maxd2 * (binsize-1)))]++;
+    if (wt_d2_all[nn_idx] == 2)
+      h_mix[static_cast<int>(pcl_round (d2v_all[nn_idx] / maxd2 * (binsize-1)))]++ ;
   }
 
   //float weights[10] = {1,  1,  1,  1,  1,  1,  1,  1 , 1 ,  1};
@@ -312,7 +339,7 @@ template <typename PointInT, typename PointOutT> int
 pcl::ESFEstimation<PointInT, PointOutT>::lci (
     const int x1, const int y1, const int z1, 
     const int x2, const int y2, const int z2, 
-    float &ratio, int &incnt, int &pointcount)
+    float &ratio, int &incnt, int &pointcount) const
 {
   int voxelcount = 0;
   int voxel_in = 0;
@@ -349,7 +376,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i = 1; i<l; i++)
     {
       voxelcount++;;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -372,7 +399,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<m; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
       if (err_1 > 0)
       {
         act_voxel[0] +=  x_inc;
@@ -395,7 +422,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     for (int i=1; i<n; i++)
     {
       voxelcount++;
-      voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+      voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
       if (err_1 > 0)
       {
         act_voxel[1] += y_inc;
@@ -412,7 +439,7 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
     }
   }
   voxelcount++;
-  voxel_in +=  static_cast<int>(lut_[act_voxel[0]][act_voxel[1]][act_voxel[2]] == 1);
+  voxel_in +=  static_cast<int>(isOccupied (act_voxel[0], act_voxel[1], act_voxel[2]));
   incnt = voxel_in;
   pointcount = voxelcount;
 
@@ -430,58 +457,43 @@ pcl::ESFEstimation<PointInT, PointOutT>::lci (
 template <typename PointInT, typename PointOutT> void
 pcl::ESFEstimation<PointInT, PointOutT>::voxelize9 (PointCloudIn &cluster)
 {
-  int xi,yi,zi,xx,yy,zz;
+  int xi,yi,xx,yy,zz;
   for (size_t i = 0; i < cluster.points.size (); ++i)
   {
     xx = cluster.points[i].x<0.0? static_cast<int>(floor(cluster.points[i].x)+GRIDSIZE_H) : static_cast<int>(ceil(cluster.points[i].x)+GRIDSIZE_H-1);
     yy = cluster.points[i].y<0.0? static_cast<int>(floor(cluster.points[i].y)+GRIDSIZE_H) : static_cast<int>(ceil(cluster.points[i].y)+GRIDSIZE_H-1);
     zz = cluster.points[i].z<0.0? static_cast<int>(floor(cluster.points[i].z)+GRIDSIZE_H) : static_cast<int>(ceil(cluster.points[i].z)+GRIDSIZE_H-1);
 
+    // The voxels zz-1, zz and zz+1 of a (x, y) row are set at once
+    uint64_t z_mask = 0;
+    for (int zi = zz - 1; zi <= zz + 1; zi++)
+      if (zi >= 0 && zi < GRIDSIZE)
+        z_mask |= static_cast<uint64_t> (1) << zi;
+    if (z_mask == 0)
+      continue;
+
     for (int x = -1; x < 2; x++)
       for (int y = -1; y < 2; y++)
-        for (int z = -1; z < 2; z++)
+      {
+        xi = xx + x;
+        yi = yy + y;
+
+        if (yi >= GRIDSIZE || xi >= GRIDSIZE || yi < 0 || xi < 0)
         {
-          xi = xx + x;
-          yi = yy + y;
-          zi = zz + z;
-
-          if (yi >= GRIDSIZE || xi >= GRIDSIZE || zi>=GRIDSIZE || yi < 0 || xi < 0 || zi < 0)
-          {
-            ;
-          }
-          else
-            this->lut_[xi][yi][zi] = 1;
+          ;
         }
+        else
+          this->lut_[xi * GRIDSIZE + yi] |= z_mask;
+      }
   }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
-pcl::ESFEstimation<PointInT, PointOutT>::cleanup9 (PointCloudIn &cluster)
+pcl::ESFEstimation<PointInT, PointOutT>::cleanup9 (PointCloudIn &)
 {
-  int xi,yi,zi,xx,yy,zz;
-  for (size_t i = 0; i < cluster.points.size (); ++i)
-  {
-    xx = cluster.points[i].x<0.0? static_cast<int>(floor(cluster.points[i].x)+GRIDSIZE_H) : static_cast<int>(ceil(cluster.points[i].x)+GRIDSIZE_H-1);
-    yy = cluster.points[i].y<0.0? static_cast<int>(floor(cluster.points[i].y)+GRIDSIZE_H) : static_cast<int>(ceil(cluster.points[i].y)+GRIDSIZE_H-1);
-    zz = cluster.points[i].z<0.0? static_cast<int>(floor(cluster.points[i].z)+GRIDSIZE_H) : static_cast<int>(ceil(cluster.points[i].z)+GRIDSIZE_H-1);
-
-    for (int x = -1; x < 2; x++)
-      for (int y = -1; y < 2; y++)
-        for (int z = -1; z < 2; z++)
-        {
-          xi = xx + x;
-          yi = yy + y;
-          zi = zz + z;
-
-          if (yi >= GRIDSIZE || xi >= GRIDSIZE || zi>=GRIDSIZE || yi < 0 || xi < 0 || zi < 0)
-          {
-            ;
-          }
-          else
-            this->lut_[xi][yi][zi] = 0;
-        }
-  }
+  // Only one bit per voxel, clearing the whole grid is cheaper than clearing the voxels of every point
+  std::fill (this->lut_.begin (), this->lut_.end (), 0);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -541,6 +553,15 @@ pcl::ESFEstimation<PointInT, PointOutT>::compute (PointCloudOut &output)
 template <typename PointInT, typename PointOutT> void
 pcl::ESFEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
+  // At least three distinct points are needed to sample a triple
+  if (surface_->points.size () < 3)
+  {
+    PCL_ERROR ("[pcl::%s::computeFeature] The input cloud needs at least 3 points, it has %zu!\n", getClassName ().c_str (), surface_->points.size ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
   Eigen::Vector4f xyz_centroid;
   std::vector<float> hist;
   scale_points_unit_sphere (*surface_, static_cast<float>(GRIDSIZE_H), xyz_centroid);
@@ -0,0 +1,270 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_FEATURES_IMPL_PFH_OMP_H_
+#define PCL_FEATURES_IMPL_PFH_OMP_H_
+
+#include <pcl/features/pfh_omp.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::PairFeatureCache::reset (size_t max_entries)
+{
+  clear ();
+
+  // Round the number of buckets down to a power of two
+  size_t nr_buckets = 1;
+  while (nr_buckets * 2 * BUCKET_SIZE <= max_entries)
+    nr_buckets *= 2;
+  bucket_mask_ = nr_buckets - 1;
+
+  Entry empty_entry;
+  empty_entry.key = EMPTY_KEY;
+  empty_entry.tuple[0] = empty_entry.tuple[1] = empty_entry.tuple[2] = empty_entry.tuple[3] = 0.0f;
+  entries_.assign (nr_buckets * BUCKET_SIZE, empty_entry);
+  victims_.assign (nr_buckets, 0);
+
+#ifdef _OPENMP
+  locks_.resize (nr_buckets < MAX_LOCKS ? nr_buckets : MAX_LOCKS);
+  for (size_t i = 0; i < locks_.size (); ++i)
+    omp_init_lock (&locks_[i]);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::PairFeatureCache::clear ()
+{
+#ifdef _OPENMP
+  for (size_t i = 0; i < locks_.size (); ++i)
+    omp_destroy_lock (&locks_[i]);
+  std::vector<omp_lock_t> ().swap (locks_);
+#endif
+  std::vector<Entry> ().swap (entries_);
+  std::vector<unsigned char> ().swap (victims_);
+  bucket_mask_ = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::PairFeatureCache::find (
+    int p_idx, int q_idx, Eigen::Vector4f &tuple)
+{
+  const uint64_t key = makeKey (p_idx, q_idx);
+  const size_t bucket = static_cast<size_t> (hash (key)) & bucket_mask_;
+  const Entry *slots = &entries_[bucket * BUCKET_SIZE];
+
+  bool found = false;
+#ifdef _OPENMP
+  omp_lock_t &lock = locks_[bucket % locks_.size ()];
+  omp_set_lock (&lock);
+#endif
+  for (size_t s = 0; s < BUCKET_SIZE; ++s)
+  {
+    if (slots[s].key != key)
+      continue;
+    tuple = Eigen::Vector4f (slots[s].tuple[0], slots[s].tuple[1], slots[s].tuple[2], slots[s].tuple[3]);
+    found = true;
+    break;
+  }
+#ifdef _OPENMP
+  omp_unset_lock (&lock);
+#endif
+  return (found);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::PairFeatureCache::insert (
+    int p_idx, int q_idx, const Eigen::Vector4f &tuple)
+{
+  const uint64_t key = makeKey (p_idx, q_idx);
+  const size_t bucket = static_cast<size_t> (hash (key)) & bucket_mask_;
+  Entry *slots = &entries_[bucket * BUCKET_SIZE];
+
+#ifdef _OPENMP
+  omp_lock_t &lock = locks_[bucket % locks_.size ()];
+  omp_set_lock (&lock);
+#endif
+  // Another thread might have stored the same pair in the meantime
+  size_t s = 0;
+  while (s < BUCKET_SIZE && slots[s].key != key)
+    ++s;
+  if (s == BUCKET_SIZE)
+  {
+    // Evict the oldest slot of the bucket
+    s = victims_[bucket];
+    victims_[bucket] = static_cast<unsigned char> ((s + 1) % BUCKET_SIZE);
+    slots[s].key = key;
+    for (int d = 0; d < 4; ++d)
+      slots[s].tuple[d] = tuple[d];
+  }
+#ifdef _OPENMP
+  omp_unset_lock (&lock);
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::computePointPFHSignature (
+      const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals,
+      const std::vector<int> &indices, int nr_split, Eigen::VectorXf &pfh_histogram,
+      PairFeatureCache *cache)
+{
+  int h_index, h_p;
+  int f_index[3];
+  Eigen::Vector4f pfh_tuple;
+
+  // Clear the resultant point histogram
+  pfh_histogram.setZero ();
+
+  // Factorization constant
+  float hist_incr = 100.0f / static_cast<float> (indices.size () * (indices.size () - 1) / 2);
+
+  // Iterate over all the points in the neighborhood
+  for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
+  {
+    // If the 3D points are invalid, don't bother estimating, just continue
+    if (!isFinite (cloud.points[indices[i_idx]]))
+      continue;
+
+    for (size_t j_idx = 0; j_idx < i_idx; ++j_idx)
+    {
+      if (!isFinite (cloud.points[indices[j_idx]]))
+        continue;
+
+      // Use the same (ordered) key as PFHEstimation, so that cached and computed tuples are identical
+      if (!cache || !cache->find (indices[i_idx], indices[j_idx], pfh_tuple))
+      {
+        // Compute the pair NNi to NNj
+        if (!computePairFeatures (cloud, normals, indices[i_idx], indices[j_idx],
+                                  pfh_tuple[0], pfh_tuple[1], pfh_tuple[2], pfh_tuple[3]))
+          continue;
+        if (cache)
+          cache->insert (indices[i_idx], indices[j_idx], pfh_tuple);
+      }
+
+      // Normalize the f1, f2, f3 features and push them in the histogram
+      f_index[0] = static_cast<int> (floor (nr_split * ((pfh_tuple[0] + M_PI) * d_pi_)));
+      if (f_index[0] < 0)         f_index[0] = 0;
+      if (f_index[0] >= nr_split) f_index[0] = nr_split - 1;
+
+      f_index[1] = static_cast<int> (floor (nr_split * ((pfh_tuple[1] + 1.0) * 0.5)));
+      if (f_index[1] < 0)         f_index[1] = 0;
+      if (f_index[1] >= nr_split) f_index[1] = nr_split - 1;
+
+      f_index[2] = static_cast<int> (floor (nr_split * ((pfh_tuple[2] + 1.0) * 0.5)));
+      if (f_index[2] < 0)         f_index[2] = 0;
+      if (f_index[2] >= nr_split) f_index[2] = nr_split - 1;
+
+      // Copy into the histogram
+      h_index = 0;
+      h_p     = 1;
+      for (int d = 0; d < 3; ++d)
+      {
+        h_index += h_p * f_index[d];
+        h_p     *= nr_split;
+      }
+      pfh_histogram[h_index] += hist_incr;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{
+  const int nr_bins = nr_subdiv_ * nr_subdiv_ * nr_subdiv_;
+
+  // Size the shared cache after the search surface, but never past the user provided maximum
+  PairFeatureCache *cache = NULL;
+  if (use_cache_)
+  {
+    size_t max_entries = surface_->points.size () * 64;
+    if (max_entries > max_cache_size_)
+      max_entries = max_cache_size_;
+    pair_cache_.reset (max_entries);
+    cache = &pair_cache_;
+  }
+
+  bool is_dense = true;
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads) reduction(&&:is_dense)
+#endif
+  {
+    // Per thread work buffers
+    Eigen::VectorXf pfh_histogram (nr_bins);
+    // \note These resizes are irrelevant for a radiusSearch ().
+    std::vector<int> nn_indices (k_);
+    std::vector<float> nn_dists (k_);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int idx = 0; idx < static_cast<int> (indices_->size ()); ++idx)
+    {
+      if ((!input_->is_dense && !isFinite (input_->points[(*indices_)[idx]])) ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      {
+        for (int d = 0; d < nr_bins; ++d)
+          output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        is_dense = false;
+        continue;
+      }
+
+      // Estimate the PFH signature at each patch
+      computePointPFHSignature (*surface_, *normals_, nn_indices, nr_subdiv_, pfh_histogram, cache);
+
+      // Copy into the resultant cloud
+      for (int d = 0; d < nr_bins; ++d)
+        output.points[idx].histogram[d] = pfh_histogram[d];
+    }
+  }
+  output.is_dense = is_dense;
+
+  // The cached pairs are only valid for the current surface
+  pair_cache_.clear ();
+}
+
+#define PCL_INSTANTIATE_PFHEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::PFHEstimationOMP<T,NT,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_PFH_OMP_H_
@@ -152,6 +152,37 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::RGB2CIELAB (un
     B2 = -120.0f;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeLabCache ()
+{
+  surface_lab_.resize (3 * surface_->points.size ());
+  for (size_t i = 0; i < surface_->points.size (); ++i)
+  {
+    float L, a, b;
+    RGB2CIELAB (surface_->points[i].r, surface_->points[i].g, surface_->points[i].b, L, a, b);
+    surface_lab_[3 * i + 0] = L / 100.0f;
+    surface_lab_[3 * i + 1] = a / 120.0f;
+    surface_lab_[3 * i + 2] = b / 120.0f;
+  }
+
+  // The reference colors come from the input cloud; only the points in indices_ are described
+  input_lab_.clear ();
+  if (surface_ != input_)
+  {
+    input_lab_.resize (3 * indices_->size ());
+    for (size_t i = 0; i < indices_->size (); ++i)
+    {
+      const PointInT &p = input_->points[(*indices_)[i]];
+      float L, a, b;
+      RGB2CIELAB (p.r, p.g, p.b, L, a, b);
+      input_lab_[3 * i + 0] = L / 100.0f;
+      input_lab_[3 * i + 1] = a / 120.0f;
+      input_lab_[3 * i + 2] = b / 120.0f;
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
 pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
@@ -241,12 +272,8 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::normalizeHistog
 	// and not the sum of bins, as reported in the ECCV paper.
 	// This is due to additional experiments performed by the authors after its pubblication,
 	// where L2 normalization turned out better at handling point density variations.
-  double acc_norm = 0;
-  for (int j = 0; j < desc_length; j++)
-    acc_norm += shot[j] * shot[j];
-  acc_norm = sqrt (acc_norm);
-  for (int j = 0; j < desc_length; j++)
-    shot[j] /= static_cast<float> (acc_norm);
+  double acc_norm = sqrt (shot.head (desc_length).cast<double> ().squaredNorm ());
+  shot.head (desc_length) /= static_cast<float> (acc_norm);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -645,10 +672,19 @@ template <typename PointInT, typename PointNT, typename PointOutT, typename Poin
 pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
   const int index, const std::vector<int> &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot)
 {
-  // Clear the resultant shot
-  shot.setZero ();
   std::vector<double> binDistanceShape;
   std::vector<double> binDistanceColor;
+  computePointSHOT (index, indices, sqr_dists, shot, binDistanceShape, binDistanceColor);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
+  const int index, const std::vector<int> &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot,
+  std::vector<double> &binDistanceShape, std::vector<double> &binDistanceColor)
+{
+  // Clear the resultant shot
+  shot.setZero ();
   size_t nNeighbors = indices.size ();
   //Skip the current feature if the number of its neighbors is not sufficient for its description
   if (nNeighbors < 5)
@@ -672,35 +708,58 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSH
   {
     binDistanceColor.resize (nNeighbors);
 
-    //unsigned char redRef = input_->points[(*indices_)[index]].rgba >> 16 & 0xFF;
-    //unsigned char greenRef = input_->points[(*indices_)[index]].rgba >> 8& 0xFF;
-    //unsigned char blueRef = input_->points[(*indices_)[index]].rgba & 0xFF;
-    unsigned char redRef = input_->points[(*indices_)[index]].r;
-    unsigned char greenRef = input_->points[(*indices_)[index]].g;
-    unsigned char blueRef = input_->points[(*indices_)[index]].b;
+    // Use the colors converted by computeLabCache if available
+    const bool lab_cached = !surface_lab_.empty ();
 
     float LRef, aRef, bRef;
 
-    RGB2CIELAB (redRef, greenRef, blueRef, LRef, aRef, bRef);
-    LRef /= 100.0f;
-    aRef /= 120.0f;
-    bRef /= 120.0f;    //normalized LAB components (0<L<1, -1<a<1, -1<b<1)
+    if (lab_cached)
+    {
+      const float *lab_ref = input_lab_.empty () ? &surface_lab_[3 * (*indices_)[index]] : &input_lab_[3 * index];
+      LRef = lab_ref[0];
+      aRef = lab_ref[1];
+      bRef = lab_ref[2];
+    }
+    else
+    {
+      //unsigned char redRef = input_->points[(*indices_)[index]].rgba >> 16 & 0xFF;
+      //unsigned char greenRef = input_->points[(*indices_)[index]].rgba >> 8& 0xFF;
+      //unsigned char blueRef = input_->points[(*indices_)[index]].rgba & 0xFF;
+      unsigned char redRef = input_->points[(*indices_)[index]].r;
+      unsigned char greenRef = input_->points[(*indices_)[index]].g;
+      unsigned char blueRef = input_->points[(*indices_)[index]].b;
+
+      RGB2CIELAB (redRef, greenRef, blueRef, LRef, aRef, bRef);
+      LRef /= 100.0f;
+      aRef /= 120.0f;
+      bRef /= 120.0f;    //normalized LAB components (0<L<1, -1<a<1, -1<b<1)
+    }
 
     for (size_t i_idx = 0; i_idx < indices.size (); ++i_idx)
     {
-      //unsigned char red = surface_->points[indices[i_idx]].rgba >> 16 & 0xFF;
-      //unsigned char green = surface_->points[indices[i_idx]].rgba >> 8 & 0xFF;
-      //unsigned char blue = surface_->points[indices[i_idx]].rgba & 0xFF;
-      unsigned char red = surface_->points[indices[i_idx]].r;
-      unsigned char green = surface_->points[indices[i_idx]].g;
-      unsigned char blue = surface_->points[indices[i_idx]].b;
-
       float L, a, b;
 
-      RGB2CIELAB (red, green, blue, L, a, b);
-      L /= 100.0f;
-      a /= 120.0f;
-      b /= 120.0f;   //normalized LAB components (0<L<1, -1<a<1, -1<b<1)
+      if (lab_cached)
+      {
+        const float *lab = &surface_lab_[3 * indices[i_idx]];
+        L = lab[0];
+        a = lab[1];
+        b = lab[2];
+      }
+      else
+      {
+        //unsigned char red = surface_->points[indices[i_idx]].rgba >> 16 & 0xFF;
+        //unsigned char green = surface_->points[indices[i_idx]].rgba >> 8 & 0xFF;
+        //unsigned char blue = surface_->points[indices[i_idx]].rgba & 0xFF;
+        unsigned char red = surface_->points[indices[i_idx]].r;
+        unsigned char green = surface_->points[indices[i_idx]].g;
+        unsigned char blue = surface_->points[indices[i_idx]].b;
+
+        RGB2CIELAB (red, green, blue, L, a, b);
+        L /= 100.0f;
+        a /= 120.0f;
+        b /= 120.0f;   //normalized LAB components (0<L<1, -1<a<1, -1<b<1)
+      }
 
       double colorDistance = (fabs (LRef - L) + ((fabs (aRef - a) + fabs (bRef - b)) / 2)) /3;
 
@@ -732,6 +791,16 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSH
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
   const int index, const std::vector<int> &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot)
+{
+  std::vector<double> binDistanceShape;
+  computePointSHOT (index, indices, sqr_dists, shot, binDistanceShape);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
+  const int index, const std::vector<int> &indices, const std::vector<float> &sqr_dists, Eigen::VectorXf &shot,
+  std::vector<double> &binDistanceShape)
 {
   //Skip the current feature if the number of its neighbors is not sufficient for its description
   if (indices.size () < 5)
@@ -744,8 +813,6 @@ pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computePointSHOT (
     return;
   }
 
-   // Clear the resultant shot
-  std::vector<double> binDistanceShape;
   this->createBinDistanceShape (index, indices, binDistanceShape);
 
   // Interpolate
@@ -778,6 +845,9 @@ pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (pcl
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
+  // Buffer for the binned neighbors, reused across points
+  std::vector<double> bin_distance_shape;
+
   output.is_dense = true;
   // Iterating over the entire index vector
   for (size_t idx = 0; idx < indices_->size (); ++idx)
@@ -808,7 +878,7 @@ pcl::SHOTEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (pcl
     }
 
     // Estimate the SHOT descriptor at each patch
-    computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_);
+    this->computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_, bin_distance_shape);
 
     // Copy into the resultant cloud
     for (int d = 0; d < descLength_; ++d)
@@ -851,6 +921,9 @@ pcl::SHOTEstimation<PointInT, PointNT, Eigen::MatrixXf, PointRFT>::computeFeatur
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
+  // Buffer for the binned neighbors, reused across points
+  std::vector<double> bin_distance_shape;
+
   output.is_dense = true;
   // Iterating over the entire index vector
   for (size_t idx = 0; idx < indices_->size (); ++idx)
@@ -877,7 +950,7 @@ pcl::SHOTEstimation<PointInT, PointNT, Eigen::MatrixXf, PointRFT>::computeFeatur
      }
 
     // Estimate the SHOT at each patch
-    this->computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_);
+    this->computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_, bin_distance_shape);
 
     // Copy into the resultant cloud
     for (int d = 0; d < descLength_; ++d)
@@ -919,6 +992,13 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
+  // Buffers for the binned neighbors, reused across points
+  std::vector<double> bin_distance_shape, bin_distance_color;
+
+  // Convert the colors of the cloud once instead of once per neighborhood
+  if (b_describe_color_)
+    this->computeLabCache ();
+
   output.is_dense = true;
   // Iterating over the entire index vector
   for (size_t idx = 0; idx < indices_->size (); ++idx)
@@ -949,7 +1029,7 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
     }
 
     // Compute the SHOT descriptor for the current 3D feature
-    computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_);
+    this->computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_, bin_distance_shape, bin_distance_color);
 
     // Copy into the resultant cloud
     for (int d = 0; d < descLength_; ++d)
@@ -961,6 +1041,8 @@ pcl::SHOTColorEstimation<PointInT, PointNT, PointOutT, PointRFT>::computeFeature
       output.points[idx].rf[d + 6] = frames_->points[idx].z_axis[d];
     }
   }
+
+  this->clearLabCache ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -995,6 +1077,13 @@ pcl::SHOTColorEstimation<PointInT, PointNT, Eigen::MatrixXf, PointRFT>::computeF
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
 
+  // Buffers for the binned neighbors, reused across points
+  std::vector<double> bin_distance_shape, bin_distance_color;
+
+  // Convert the colors of the cloud once instead of once per neighborhood
+  if (b_describe_color_)
+    this->computeLabCache ();
+
   output.is_dense = true;
   // Iterating over the entire index vector
   for (size_t idx = 0; idx < indices_->size (); ++idx)
@@ -1021,7 +1110,7 @@ pcl::SHOTColorEstimation<PointInT, PointNT, Eigen::MatrixXf, PointRFT>::computeF
      }
 
     // Compute the SHOT descriptor for the current 3D feature
-    this->computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_);
+    this->computePointSHOT (static_cast<int> (idx), nn_indices, nn_dists, shot_, bin_distance_shape, bin_distance_color);
 
     // Copy into the resultant cloud
     for (int d = 0; d < descLength_; ++d)
@@ -1033,6 +1122,8 @@ pcl::SHOTColorEstimation<PointInT, PointNT, Eigen::MatrixXf, PointRFT>::computeF
       output.points (idx, shot_.size () + 6 + d) = frames_->points[idx].z_axis[d];
     }
   }
+
+  this->clearLabCache ();
 }
 
 #define PCL_INSTANTIATE_SHOTEstimation(T,NT,OutT,RFT) template class PCL_EXPORTS pcl::SHOTEstimation<T,NT,OutT,RFT>;
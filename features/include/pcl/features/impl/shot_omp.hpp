@@ -41,6 +41,10 @@
 #include <pcl/common/time.h>
 #include <pcl/features/shot_lrf_omp.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 template<typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> bool
 pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
 {
@@ -132,56 +136,61 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeature (
   int data_size = static_cast<int> (indices_->size ());
 
   output.is_dense = true;
-  // Iterating over the entire index vector
+
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
 #endif
-  for (int idx = 0; idx < data_size; ++idx)
   {
-
+    // Per-thread workspace, allocated once and reused for every point of the thread
     Eigen::VectorXf shot;
     shot.setZero (descLength_);
-
-    bool lrf_is_nan = false;
-    const PointRFT& current_frame = (*frames_)[idx];
-    if (!pcl_isfinite (current_frame.x_axis[0]) ||
-        !pcl_isfinite (current_frame.y_axis[0]) ||
-        !pcl_isfinite (current_frame.z_axis[0]))
-    {
-      PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
-        getClassName ().c_str (), (*indices_)[idx]);
-      lrf_is_nan = true;
-    }
-
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
     std::vector<int> nn_indices (k_);
     std::vector<float> nn_dists (k_);
+    std::vector<double> bin_distance_shape;
 
-    if (!isFinite ((*input_)[(*indices_)[idx]]) || lrf_is_nan || this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices,
-                                                                                           nn_dists) == 0)
+    // Iterating over the entire index vector; neighborhood sizes vary, so hand out small chunks
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int idx = 0; idx < data_size; ++idx)
     {
-      // Copy into the resultant cloud
-      for (int d = 0; d < shot.size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
-      for (int d = 0; d < 9; ++d)
-        output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
-
-      output.is_dense = false;
-      continue;
-    }
-
-    // Estimate the SHOT at each patch
-    this->computePointSHOT (idx, nn_indices, nn_dists, shot);
+      bool lrf_is_nan = false;
+      const PointRFT& current_frame = (*frames_)[idx];
+      if (!pcl_isfinite (current_frame.x_axis[0]) ||
+          !pcl_isfinite (current_frame.y_axis[0]) ||
+          !pcl_isfinite (current_frame.z_axis[0]))
+      {
+        PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
+          getClassName ().c_str (), (*indices_)[idx]);
+        lrf_is_nan = true;
+      }
+
+      if (!isFinite ((*input_)[(*indices_)[idx]]) || lrf_is_nan || this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices,
+                                                                                             nn_dists) == 0)
+      {
+        // Copy into the resultant cloud
+        for (int d = 0; d < descLength_; ++d)
+          output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+        for (int d = 0; d < 9; ++d)
+          output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        output.is_dense = false;
+        continue;
+      }
+
+      // Estimate the SHOT at each patch
+      this->computePointSHOT (idx, nn_indices, nn_dists, shot, bin_distance_shape);
 
-    // Copy into the resultant cloud
-    for (int d = 0; d < shot.size (); ++d)
-      output.points[idx].descriptor[d] = shot[d];
-    for (int d = 0; d < 3; ++d)
-    {
-      output.points[idx].rf[d + 0] = frames_->points[idx].x_axis[d];
-      output.points[idx].rf[d + 3] = frames_->points[idx].y_axis[d];
-      output.points[idx].rf[d + 6] = frames_->points[idx].z_axis[d];
+      // Copy into the resultant cloud
+      for (int d = 0; d < descLength_; ++d)
+        output.points[idx].descriptor[d] = shot[d];
+      for (int d = 0; d < 3; ++d)
+      {
+        output.points[idx].rf[d + 0] = frames_->points[idx].x_axis[d];
+        output.points[idx].rf[d + 3] = frames_->points[idx].y_axis[d];
+        output.points[idx].rf[d + 6] = frames_->points[idx].z_axis[d];
+      }
     }
   }
 }
@@ -205,59 +214,73 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::computeFeat
 
   int data_size = static_cast<int> (indices_->size ());
 
+  // Convert the colors of the cloud once, before the threads start: this also
+  // initializes the conversion tables of RGB2CIELAB outside of the parallel region
+  if (b_describe_color_)
+    this->computeLabCache ();
+
   output.is_dense = true;
-  // Iterating over the entire index vector
+
 #ifdef _OPENMP
-#pragma omp parallel for num_threads(threads_)
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
 #endif
-  for (int idx = 0; idx < data_size; ++idx)
   {
+    // Per-thread workspace, allocated once and reused for every point of the thread
     Eigen::VectorXf shot;
     shot.setZero (descLength_);
-
-    // Allocate enough space to hold the results
-    // \note This resize is irrelevant for a radiusSearch ().
     std::vector<int> nn_indices (k_);
     std::vector<float> nn_dists (k_);
+    std::vector<double> bin_distance_shape;
+    std::vector<double> bin_distance_color;
 
-    bool lrf_is_nan = false;
-    const PointRFT& current_frame = (*frames_)[idx];
-    if (!pcl_isfinite (current_frame.x_axis[0]) ||
-        !pcl_isfinite (current_frame.y_axis[0]) ||
-        !pcl_isfinite (current_frame.z_axis[0]))
+    // Iterating over the entire index vector; neighborhood sizes vary, so hand out small chunks
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int idx = 0; idx < data_size; ++idx)
     {
-      PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
-        getClassName ().c_str (), (*indices_)[idx]);
-      lrf_is_nan = true;
-    }
+      bool lrf_is_nan = false;
+      const PointRFT& current_frame = (*frames_)[idx];
+      if (!pcl_isfinite (current_frame.x_axis[0]) ||
+          !pcl_isfinite (current_frame.y_axis[0]) ||
+          !pcl_isfinite (current_frame.z_axis[0]))
+      {
+        PCL_WARN ("[pcl::%s::computeFeature] The local reference frame is not valid! Aborting description of point with index %d\n",
+          getClassName ().c_str (), (*indices_)[idx]);
+        lrf_is_nan = true;
+      }
+
+      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
+          lrf_is_nan ||
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      {
+        // Copy into the resultant cloud
+        for (int d = 0; d < descLength_; ++d)
+          output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
+        for (int d = 0; d < 9; ++d)
+          output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
+
+        output.is_dense = false;
+        continue;
+      }
+
+      // Estimate the SHOT at each patch
+      this->computePointSHOT (idx, nn_indices, nn_dists, shot, bin_distance_shape, bin_distance_color);
 
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        lrf_is_nan ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
-    {
       // Copy into the resultant cloud
-      for (int d = 0; d < shot.size (); ++d)
-        output.points[idx].descriptor[d] = std::numeric_limits<float>::quiet_NaN ();
-      for (int d = 0; d < 9; ++d)
-        output.points[idx].rf[d] = std::numeric_limits<float>::quiet_NaN ();
-
-      output.is_dense = false;
-      continue;
-    }
-
-    // Estimate the SHOT at each patch
-    this->computePointSHOT (idx, nn_indices, nn_dists, shot);
-
-    // Copy into the resultant cloud
-    for (int d = 0; d < shot.size (); ++d)
-      output.points[idx].descriptor[d] = shot[d];
-    for (int d = 0; d < 3; ++d)
-    {
-      output.points[idx].rf[d + 0] = frames_->points[idx].x_axis[d];
-      output.points[idx].rf[d + 3] = frames_->points[idx].y_axis[d];
-      output.points[idx].rf[d + 6] = frames_->points[idx].z_axis[d];
+      for (int d = 0; d < descLength_; ++d)
+        output.points[idx].descriptor[d] = shot[d];
+      for (int d = 0; d < 3; ++d)
+      {
+        output.points[idx].rf[d + 0] = frames_->points[idx].x_axis[d];
+        output.points[idx].rf[d + 3] = frames_->points[idx].y_axis[d];
+        output.points[idx].rf[d + 6] = frames_->points[idx].z_axis[d];
+      }
     }
   }
+
+  this->clearLabCache ();
 }
 
 #define PCL_INSTANTIATE_SHOTEstimationOMP(T,NT,OutT,RFT) template class PCL_EXPORTS pcl::SHOTEstimationOMP<T,NT,OutT,RFT>;
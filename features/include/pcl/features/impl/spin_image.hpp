@@ -47,6 +47,7 @@
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/features/spin_image.h>
 #include <cmath>
+#include <boost/throw_exception.hpp>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT>
@@ -66,6 +67,19 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::SpinImageEstimation (
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> Eigen::ArrayXXd 
 pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int index) const
+{
+  std::vector<int> nn_indices;
+  std::vector<float> nn_sqr_dists;
+  Eigen::ArrayXXd m_matrix, m_averAngles;
+  computeSiForPoint (index, nn_indices, nn_sqr_dists, m_matrix, m_averAngles);
+  return (m_matrix);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (
+    int index, std::vector<int> &nn_indices, std::vector<float> &nn_sqr_dists,
+    Eigen::ArrayXXd &m_matrix, Eigen::ArrayXXd &m_averAngles) const
 {
   assert (image_width_ > 0);
   assert (support_angle_cos_ <= 1.0 && support_angle_cos_ >= 0.0); // may be permit negative cosine?
@@ -84,8 +98,9 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
       rotation_axes_cloud_->points[index].getNormalVector3fMap () :
       origin_normal;  
 
-  Eigen::ArrayXXd m_matrix (Eigen::ArrayXXd::Zero (image_width_+1, 2*image_width_+1));
-  Eigen::ArrayXXd m_averAngles (Eigen::ArrayXXd::Zero (image_width_+1, 2*image_width_+1));
+  m_matrix.setZero (image_width_+1, 2*image_width_+1);
+  if (is_angular_)
+    m_averAngles.setZero (image_width_+1, 2*image_width_+1);
 
   // OK, we are interested in the points of the cylinder of height 2*r and
   // base radius r, where r = m_dBinSize * in_iImageWidth
@@ -98,14 +113,12 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
   else
     bin_size = search_radius_ / image_width_ / sqrt(2.0);
 
-  std::vector<int> nn_indices;
-  std::vector<float> nn_sqr_dists;
   const int neighb_cnt = this->searchForNeighbors (index, search_radius_, nn_indices, nn_sqr_dists);
   if (neighb_cnt < static_cast<int> (min_pts_neighb_))
   {
-    throw PCLException (
+    boost::throw_exception (PCLException (
       "Too few points for spin image, use setMinPointCountInNeighbourhood() to decrease the threshold or use larger feature radius",
-      "spin_image.hpp", "computeSiForPoint");
+      "spin_image.hpp", "computeSiForPoint"));
   }
 
   // for all neighbor points
@@ -120,8 +133,8 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
       {      
         PCL_ERROR ("[pcl::%s::computeSiForPoint] Normal for the point %d and/or the point %d are not normalized, dot ptoduct is %f.\n", 
           getClassName ().c_str (), nn_indices[i_neigh], index, cos_between_normals);
-        throw PCLException ("Some normals are not normalized",
-          "spin_image.hpp", "computeSiForPoint");
+        boost::throw_exception (PCLException ("Some normals are not normalized",
+          "spin_image.hpp", "computeSiForPoint"));
       }
       cos_between_normals = std::max (-1.0, std::min (1.0, cos_between_normals));
 
@@ -150,8 +163,8 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
     {      
       PCL_ERROR ("[pcl::%s::computeSiForPoint] Rotation axis for the point %d are not normalized, dot ptoduct is %f.\n", 
         getClassName ().c_str (), index, cos_dir_axis);
-      throw PCLException ("Some rotation axis is not normalized",
-        "spin_image.hpp", "computeSiForPoint");
+      boost::throw_exception (PCLException ("Some rotation axis is not normalized",
+        "spin_image.hpp", "computeSiForPoint"));
     }
     cos_dir_axis = std::max (-1.0, std::min (1.0, cos_dir_axis));
 
@@ -228,8 +241,6 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeSiForPoint (int i
     // normalization
     m_matrix /= m_matrix.sum();
   }
-
-  return m_matrix;
 }
 
 
@@ -322,9 +333,14 @@ pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::initCompute ()
 template <typename PointInT, typename PointNT, typename PointOutT> void 
 pcl::SpinImageEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 { 
+  // Work buffers, reused for every point
+  std::vector<int> nn_indices;
+  std::vector<float> nn_sqr_dists;
+  Eigen::ArrayXXd res, aver_angles;
+
   for (int i_input = 0; i_input < static_cast<int> (indices_->size ()); ++i_input)
   {
-    Eigen::ArrayXXd res = computeSiForPoint (indices_->at (i_input));
+    computeSiForPoint (indices_->at (i_input), nn_indices, nn_sqr_dists, res, aver_angles);
 
     // Copy into the resultant cloud
     for (int iRow = 0; iRow < res.rows () ; iRow++)
@@ -349,9 +365,15 @@ pcl::SpinImageEstimation<PointInT, PointNT, Eigen::MatrixXf>::computeFeatureEige
   output.channels["spin_image"].datatype = sensor_msgs::PointField::FLOAT32;
 
   output.points.resize (indices_->size (), 153);
+
+  // Work buffers, reused for every point
+  std::vector<int> nn_indices;
+  std::vector<float> nn_sqr_dists;
+  Eigen::ArrayXXd res, aver_angles;
+
   for (int i_input = 0; i_input < static_cast<int> (indices_->size ()); ++i_input)
   {
-    Eigen::ArrayXXd res = this->computeSiForPoint (indices_->at (i_input));
+    this->computeSiForPoint (indices_->at (i_input), nn_indices, nn_sqr_dists, res, aver_angles);
 
     // Copy into the resultant cloud
     for (int iRow = 0; iRow < res.rows () ; iRow++)
@@ -0,0 +1,102 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_FEATURES_IMPL_SPIN_IMAGE_OMP_H_
+#define PCL_FEATURES_IMPL_SPIN_IMAGE_OMP_H_
+
+#include <pcl/exceptions.h>
+#include <pcl/features/spin_image_omp.h>
+#include <boost/exception_ptr.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void 
+pcl::SpinImageEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
+{ 
+  // Exceptions cannot leave a parallel region, keep the first one and rethrow it at the end
+  boost::exception_ptr error;
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
+#endif
+  {
+    // Per thread work buffers
+    std::vector<int> nn_indices;
+    std::vector<float> nn_sqr_dists;
+    Eigen::ArrayXXd res, aver_angles;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int i_input = 0; i_input < static_cast<int> (indices_->size ()); ++i_input)
+    {
+      try
+      {
+        this->computeSiForPoint ((*indices_)[i_input], nn_indices, nn_sqr_dists, res, aver_angles);
+      }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (spin_image_omp_error)
+#endif
+        {
+          if (!error)
+            error = boost::current_exception ();
+        }
+        continue;
+      }
+
+      // Copy into the resultant cloud
+      for (int iRow = 0; iRow < res.rows () ; iRow++)
+        for (int iCol = 0; iCol < res.cols () ; iCol++)
+          output.points[i_input].histogram[ iRow*res.cols () + iCol ] = static_cast<float> (res (iRow, iCol));
+    }
+  }
+
+  if (error)
+    boost::rethrow_exception (error);
+}
+
+#define PCL_INSTANTIATE_SpinImageEstimationOMP(T,NT,OutT) template class PCL_EXPORTS pcl::SpinImageEstimationOMP<T,NT,OutT>;
+
+#endif    // PCL_FEATURES_IMPL_SPIN_IMAGE_OMP_H_
@@ -76,6 +76,14 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initCompute ()
     return (false);
   }
 
+  initLookupTables ();
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> void
+pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initLookupTables ()
+{
   // Update descriptor length
   descriptor_length_ = elevation_bins_ * azimuth_bins_ * radius_bins_;
 
@@ -135,7 +143,6 @@ pcl::UniqueShapeContext<PointInT, PointOutT, PointRFT>::initCompute ()
         volume_lut_[(l*elevation_bins_*radius_bins_) + k*radius_bins_ + j] = 1.0f / powf (V, e);
     }
   }
-  return (true);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,225 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_FEATURES_IMPL_USC_OMP_HPP_
+#define PCL_FEATURES_IMPL_USC_OMP_HPP_
+
+#include <algorithm>
+#include <pcl/features/usc_omp.h>
+#include <pcl/features/shot_lrf_omp.h>
+#include <pcl/common/geometry.h>
+#include <pcl/common/angles.h>
+#include <pcl/common/utils.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> bool
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::initCompute ()
+{
+  if (!Feature<PointInT, PointOutT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  // Default LRF estimation alg: SHOTLocalReferenceFrameEstimationOMP
+  typename boost::shared_ptr<SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT> > lrf_estimator (new SHOTLocalReferenceFrameEstimationOMP<PointInT, PointRFT> ());
+  lrf_estimator->setRadiusSearch (local_radius_);
+  lrf_estimator->setInputCloud (input_);
+  lrf_estimator->setIndices (indices_);
+  lrf_estimator->setNumberOfThreads (threads_);
+  if (!fake_surface_)
+    lrf_estimator->setSearchSurface (surface_);
+
+  if (!FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  if (search_radius_< min_radius_)
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] search_radius_ must be GREATER than min_radius_.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  this->initLookupTables ();
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> void
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::computePointDescriptor (
+    size_t index, std::vector<float> &desc,
+    std::vector<int> &nn_indices, std::vector<float> &nn_dists, std::vector<int> &densities)
+{
+  pcl::Vector3fMapConst origin = input_->points[(*indices_)[index]].getVector3fMap ();
+
+  const Eigen::Vector3f x_axis (frames_->points[index].x_axis[0],
+                                frames_->points[index].x_axis[1],
+                                frames_->points[index].x_axis[2]);
+  const Eigen::Vector3f normal (frames_->points[index].z_axis[0],
+                                frames_->points[index].z_axis[1],
+                                frames_->points[index].z_axis[2]);
+
+  // Find every point within specified search_radius_
+  const size_t neighb_cnt = searchForNeighbors ((*indices_)[index], search_radius_, nn_indices, nn_dists);
+
+  // Local point density searches run on their own buffers, as nn_indices is still being iterated
+  std::vector<int> neighbour_indices;
+  std::vector<float> neighbour_distances;
+
+  // For each point within radius
+  for (size_t ne = 0; ne < neighb_cnt; ne++)
+  {
+    if (pcl::utils::equal(nn_dists[ne], 0.0f))
+      continue;
+    // Get neighbours coordinates
+    Eigen::Vector3f neighbour = surface_->points[nn_indices[ne]].getVector3fMap ();
+
+    // ----- Compute current neighbour polar coordinates -----
+
+    // Get distance between the neighbour and the origin
+    float r = sqrtf (nn_dists[ne]);
+
+    // Project point into the tangent plane
+    Eigen::Vector3f proj;
+    pcl::geometry::project (neighbour, origin, normal, proj);
+    proj -= origin;
+
+    // Normalize to compute the dot product
+    proj.normalize ();
+
+    // Compute the angle between the projection and the x axis in the interval [0,360]
+    Eigen::Vector3f cross = x_axis.cross (proj);
+    float phi = rad2deg (std::atan2 (cross.norm (), x_axis.dot (proj)));
+    phi = cross.dot (normal) < 0.f ? (360.0f - phi) : phi;
+    /// Compute the angle between the neighbour and the z axis (normal) in the interval [0, 180]
+    Eigen::Vector3f no = neighbour - origin;
+    no.normalize ();
+    float theta = normal.dot (no);
+    theta = pcl::rad2deg (acosf (std::min (1.0f, std::max (-1.0f, theta))));
+
+    /// Compute the Bin(j, k, l) coordinates of current neighbour
+    const size_t j = findBin (radii_interval_, r);
+    const size_t k = findBin (theta_divisions_, theta);
+    const size_t l = findBin (phi_divisions_, phi);
+
+    /// Local point density = number of points in a sphere of radius "point_density_radius_" around the current neighbour
+    int &density = densities[nn_indices[ne]];
+    if (density < 0)
+      density = searchForNeighbors (*surface_, nn_indices[ne], point_density_radius_, neighbour_indices, neighbour_distances);
+    float point_density = static_cast<float> (density);
+    /// point_density is always bigger than 0 because FindPointsWithinRadius returns at least the point itself
+    float w = (1.0f / point_density) * volume_lut_[(l*elevation_bins_*radius_bins_) +
+                                                   (k*radius_bins_) +
+                                                   j];
+
+    assert (w >= 0.0);
+    if (w == std::numeric_limits<float>::infinity ())
+      PCL_ERROR ("Shape Context Error INF!\n");
+    if (w != w)
+      PCL_ERROR ("Shape Context Error IND!\n");
+    /// Accumulate w into correspondant Bin(j,k,l)
+    desc[(l*elevation_bins_*radius_bins_) + (k*radius_bins_) + j] += w;
+
+    assert (desc[(l*elevation_bins_*radius_bins_) + (k*radius_bins_) + j] >= 0);
+  } // end for each neighbour
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT, typename PointRFT> void
+pcl::UniqueShapeContextOMP<PointInT, PointOutT, PointRFT>::computeFeature (PointCloudOut &output)
+{
+  assert (descriptor_length_ == 1980);
+
+  bool is_dense = true;
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads) reduction(&&:is_dense)
+#endif
+  {
+    // Per thread work buffers
+    std::vector<int> nn_indices;
+    std::vector<float> nn_dists;
+    std::vector<float> descriptor (descriptor_length_);
+    std::vector<int> densities (surface_->points.size (), -1);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+    for (int point_index = 0; point_index < static_cast<int> (indices_->size ()); ++point_index)
+    {
+      // If the point is not finite, set the descriptor to NaN and continue
+      const PointRFT& current_frame = (*frames_)[point_index];
+      if (!isFinite ((*input_)[(*indices_)[point_index]]) ||
+          !pcl_isfinite (current_frame.x_axis[0]) ||
+          !pcl_isfinite (current_frame.y_axis[0]) ||
+          !pcl_isfinite (current_frame.z_axis[0])  )
+      {
+        for (size_t i = 0; i < descriptor_length_; ++i)
+          output[point_index].descriptor[i] = std::numeric_limits<float>::quiet_NaN ();
+
+        memset (output[point_index].rf, 0, sizeof (output[point_index].rf[0]) * 9);
+        is_dense = false;
+        continue;
+      }
+
+      for (int d = 0; d < 3; ++d)
+      {
+        output.points[point_index].rf[0 + d] = current_frame.x_axis[d];
+        output.points[point_index].rf[3 + d] = current_frame.y_axis[d];
+        output.points[point_index].rf[6 + d] = current_frame.z_axis[d];
+      }
+
+      std::fill (descriptor.begin (), descriptor.end (), 0.0f);
+      computePointDescriptor (point_index, descriptor, nn_indices, nn_dists, densities);
+      for (size_t j = 0; j < descriptor_length_; ++j)
+        output[point_index].descriptor[j] = descriptor[j];
+    }
+  }
+  output.is_dense = is_dense;
+}
+
+#define PCL_INSTANTIATE_UniqueShapeContextOMP(T,OutT,RFT) template class PCL_EXPORTS pcl::UniqueShapeContextOMP<T,OutT,RFT>;
+
+#endif
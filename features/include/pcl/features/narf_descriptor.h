@@ -61,9 +61,10 @@ namespace pcl
       // =====STRUCTS/CLASSES=====
       struct Parameters
       {
-        Parameters() : support_size(-1.0f), rotation_invariant(true) {}
+        Parameters() : support_size(-1.0f), rotation_invariant(true), max_no_of_threads(1) {}
         float support_size;
         bool rotation_invariant;
+        int max_no_of_threads;  //!< The maximum number of threads the descriptors are extracted with
       };
       
       // =====CONSTRUCTOR & DESTRUCTOR=====
@@ -0,0 +1,276 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_PFH_OMP_H_
+#define PCL_PFH_OMP_H_
+
+#include <pcl/features/feature.h>
+#include <pcl/features/pfh.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  /** \brief PFHEstimationOMP estimates the Point Feature Histogram (PFH) descriptor for a given point cloud
+    * dataset containing points and normals, in parallel, using the OpenMP standard.
+    *
+    * Unlike \ref PFHEstimation, the internal cache is a fixed size open-addressed hash table that is shared by all
+    * threads. Each entry stores the 4-tuple computed for an ordered pair of point indices, and is looked up using
+    * a hash of that pair. The table is split into small buckets, each guarded by one of a fixed set of striped
+    * locks, and full buckets evict their oldest entry first. The resultant histograms are identical to the ones
+    * computed by \ref PFHEstimation, with or without the cache.
+    *
+    * \note If you use this code in any academic work, please cite:
+    *
+    *   - R.B. Rusu, N. Blodow, Z.C. Marton, M. Beetz.
+    *     Aligning Point Cloud Views using Persistent Feature Histograms.
+    *     In Proceedings of the 21st IEEE/RSJ International Conference on Intelligent Robots and Systems (IROS),
+    *     Nice, France, September 22-26 2008.
+    *   - R.B. Rusu, Z.C. Marton, N. Blodow, M. Beetz.
+    *     Learning Informative Point Classes for the Acquisition of Object Model Maps.
+    *     In Proceedings of the 10th International Conference on Control, Automation, Robotics and Vision (ICARCV),
+    *     Hanoi, Vietnam, December 17-20 2008.
+    *
+    * \attention 
+    * The convention for PFH features is:
+    *   - if a query point's nearest neighbors cannot be estimated, the PFH feature will be set to NaN 
+    *     (not a number)
+    *   - it is impossible to estimate a PFH descriptor for a point that
+    *     doesn't have finite 3D coordinates. Therefore, any point that contains
+    *     NaN data on x, y, or z, will have its PFH feature property set to NaN.
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointNT, typename PointOutT = pcl::PFHSignature125>
+  class PFHEstimationOMP : public PFHEstimation<PointInT, PointNT, PointOutT>
+  {
+    public:
+      typedef boost::shared_ptr<PFHEstimationOMP<PointInT, PointNT, PointOutT> > Ptr;
+      typedef boost::shared_ptr<const PFHEstimationOMP<PointInT, PointNT, PointOutT> > ConstPtr;
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::k_;
+      using Feature<PointInT, PointOutT>::search_parameter_;
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::surface_;
+      using FeatureFromNormals<PointInT, PointNT, PointOutT>::normals_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::nr_subdiv_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::d_pi_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::max_cache_size_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::use_cache_;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::computePairFeatures;
+      using PFHEstimation<PointInT, PointNT, PointOutT>::computePointPFHSignature;
+
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      PFHEstimationOMP (unsigned int nr_threads = 0) : pair_cache_ (), threads_ (nr_threads)
+      {
+        feature_name_ = "PFHEstimationOMP";
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void 
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+    protected:
+      /** \brief Concurrent, fixed capacity cache of PFH 4-tuples, indexed by an ordered pair of point indices.
+        *
+        * Entries are grouped in buckets of \a BUCKET_SIZE slots. A key is hashed to a single bucket, so lookups
+        * never scan more than \a BUCKET_SIZE slots. Buckets are protected by a fixed number of striped locks
+        * (only when compiled with OpenMP), and a full bucket overwrites its slots in round-robin order, i.e.,
+        * oldest first.
+        */
+      class PairFeatureCache
+      {
+        public:
+          /** \brief Empty constructor. */
+          PairFeatureCache () : entries_ (), victims_ (), bucket_mask_ (0)
+#ifdef _OPENMP
+            , locks_ ()
+#endif
+          {}
+
+          /** \brief Copy constructor. The cache only lives for the duration of a computeFeature () call, so
+            * copies start out empty.
+            */
+          PairFeatureCache (const PairFeatureCache &) : entries_ (), victims_ (), bucket_mask_ (0)
+#ifdef _OPENMP
+            , locks_ ()
+#endif
+          {}
+
+          /** \brief Assignment operator. Leaves the cache untouched (see the copy constructor). */
+          PairFeatureCache &
+          operator = (const PairFeatureCache &) { return (*this); }
+
+          /** \brief Destructor. Releases the locks. */
+          ~PairFeatureCache () { clear (); }
+
+          /** \brief Drop all the cached entries and resize the table.
+            * \param[in] max_entries an upper bound on the number of entries to hold
+            */
+          void
+          reset (size_t max_entries);
+
+          /** \brief Release all the memory held by the cache. */
+          void
+          clear ();
+
+          /** \brief Look up the 4-tuple stored for an ordered pair of point indices.
+            * \param[in] p_idx the index of the first point (source)
+            * \param[in] q_idx the index of the second point (target)
+            * \param[out] tuple the cached 4-tuple, if found
+            * \return true if the pair was found in the cache, false otherwise
+            */
+          bool
+          find (int p_idx, int q_idx, Eigen::Vector4f &tuple);
+
+          /** \brief Store the 4-tuple of an ordered pair of point indices, evicting the oldest entry of its bucket
+            * if needed.
+            * \param[in] p_idx the index of the first point (source)
+            * \param[in] q_idx the index of the second point (target)
+            * \param[in] tuple the 4-tuple to store
+            */
+          void
+          insert (int p_idx, int q_idx, const Eigen::Vector4f &tuple);
+
+          /** \brief Check whether the cache holds any storage. */
+          inline bool
+          empty () const { return (entries_.empty ()); }
+
+        private:
+          /** \brief The number of slots in a bucket. */
+          static const size_t BUCKET_SIZE = 8;
+
+          /** \brief The maximum number of locks guarding the buckets. */
+          static const size_t MAX_LOCKS = 1024;
+
+          /** \brief The key of an unused slot. No pair of valid (non negative) point indices maps to it. */
+          static const uint64_t EMPTY_KEY = ~static_cast<uint64_t> (0);
+
+          /** \brief A cache slot. An unused slot has its key set to \a EMPTY_KEY. */
+          struct Entry
+          {
+            uint64_t key;
+            float tuple[4];
+          };
+
+          /** \brief Pack an ordered pair of indices into a 64 bit key. */
+          static inline uint64_t
+          makeKey (int p_idx, int q_idx)
+          {
+            return ((static_cast<uint64_t> (static_cast<uint32_t> (p_idx)) << 32) | static_cast<uint32_t> (q_idx));
+          }
+
+          /** \brief Mix the bits of a key (SplitMix64 finalizer). */
+          static inline uint64_t
+          hash (uint64_t key)
+          {
+            key ^= key >> 30;
+            key *= static_cast<uint64_t> (0xbf58476d1ce4e5b9ULL);
+            key ^= key >> 27;
+            key *= static_cast<uint64_t> (0x94d049bb133111ebULL);
+            key ^= key >> 31;
+            return (key);
+          }
+
+          /** \brief The cache slots, stored bucket after bucket. */
+          std::vector<Entry> entries_;
+
+          /** \brief The next slot to evict in every bucket. */
+          std::vector<unsigned char> victims_;
+
+          /** \brief The number of buckets minus one (the number of buckets is a power of two). */
+          size_t bucket_mask_;
+#ifdef _OPENMP
+          /** \brief The striped bucket locks. Bucket b is guarded by locks_[b % locks_.size ()]. */
+          std::vector<omp_lock_t> locks_;
+#endif
+      };
+
+      /** \brief Estimate the PFH signature of a point, using the shared pair cache instead of the (single threaded)
+        * internal cache of \ref PFHEstimation. Safe to call concurrently.
+        * \param[in] cloud the dataset containing the XYZ Cartesian coordinates of the two points
+        * \param[in] normals the dataset containing the surface normals at each point in \a cloud
+        * \param[in] indices the k-neighborhood point indices in the dataset
+        * \param[in] nr_split the number of subdivisions for each angular feature interval
+        * \param[out] pfh_histogram the resultant (combinatorial) PFH histogram representing the feature at the query point
+        * \param[in] cache the shared pair cache, or NULL to compute every pair
+        */
+      void 
+      computePointPFHSignature (const pcl::PointCloud<PointInT> &cloud, const pcl::PointCloud<PointNT> &normals, 
+                                const std::vector<int> &indices, int nr_split, Eigen::VectorXf &pfh_histogram,
+                                PairFeatureCache *cache);
+
+    private:
+      /** \brief Estimate the Point Feature Histograms (PFH) descriptors at a set of points given by
+        * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
+        * setSearchMethod ()
+        * \param[out] output the resultant point cloud model dataset that contains the PFH feature estimates
+        */
+      void 
+      computeFeature (PointCloudOut &output);
+
+      /** \brief The pair cache shared by all the threads. */
+      PairFeatureCache pair_cache_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud 
+        */
+      void 
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &) {}
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/pfh_omp.hpp>
+#endif
+
+#endif  //#ifndef PCL_PFH_OMP_H_
@@ -193,6 +193,12 @@ namespace pcl
       float* surface_change_scores_;
       Eigen::Vector3f* surface_change_directions_;
       
+      // The memory the per pixel pointers above point into. It is kept by clearData (), so that extracting the data for a
+      // new range image of the same size does not allocate memory for every pixel again.
+      std::vector<LocalSurface> surface_structure_storage_;
+      std::vector<ShadowBorderIndices> shadow_border_informations_storage_;
+      std::vector<Eigen::Vector3f> border_directions_storage_, average_border_directions_storage_;
+      
       
       // =====PROTECTED METHODS=====
       /** \brief Calculate a border score based on how distant the neighbor is, compared to the closest neighbors
@@ -264,6 +264,20 @@ namespace pcl
                         const std::vector<float> &sqr_dists,
                         Eigen::VectorXf &shot);
     protected:
+      /** \brief Estimate the SHOT descriptor for a given point, using a caller provided buffer for the binned neighbors
+        * \param[in] index the index of the point in indices_
+        * \param[in] indices the k-neighborhood point indices in surface_
+        * \param[in] sqr_dists the k-neighborhood point distances in surface_
+        * \param[out] shot the resultant SHOT descriptor representing the feature at the query point
+        * \param[out] bin_distance_shape workspace for the shape histogram bin of every neighbor
+        */
+      void
+      computePointSHOT (const int index,
+                        const std::vector<int> &indices,
+                        const std::vector<float> &sqr_dists,
+                        Eigen::VectorXf &shot,
+                        std::vector<double> &bin_distance_shape);
+
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -421,7 +435,9 @@ namespace pcl
         : SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT> (10),
           b_describe_shape_ (describe_shape),
           b_describe_color_ (describe_color),
-          nr_color_bins_ (30)
+          nr_color_bins_ (30),
+          surface_lab_ (),
+          input_lab_ ()
       {
         feature_name_ = "SHOTColorEstimation";
       };
@@ -438,6 +454,22 @@ namespace pcl
                         const std::vector<float> &sqr_dists,
                         Eigen::VectorXf &shot);
     protected:
+      /** \brief Estimate the SHOT descriptor for a given point, using caller provided buffers for the binned neighbors
+        * \param[in] index the index of the point in indices_
+        * \param[in] indices the k-neighborhood point indices in surface_
+        * \param[in] sqr_dists the k-neighborhood point distances in surface_
+        * \param[out] shot the resultant SHOT descriptor representing the feature at the query point
+        * \param[out] bin_distance_shape workspace for the shape histogram bin of every neighbor
+        * \param[out] bin_distance_color workspace for the color histogram bin of every neighbor
+        */
+      void
+      computePointSHOT (const int index,
+                        const std::vector<int> &indices,
+                        const std::vector<float> &sqr_dists,
+                        Eigen::VectorXf &shot,
+                        std::vector<double> &bin_distance_shape,
+                        std::vector<double> &bin_distance_color);
+
       /** \brief Estimate the Signatures of Histograms of OrienTations (SHOT) descriptors at a set of points given by
         * <setInputCloud (), setIndices ()> using the surface in setSearchSurface () and the spatial locator in
         * setSearchMethod ()
@@ -446,6 +478,21 @@ namespace pcl
       void
       computeFeature (pcl::PointCloud<PointOutT> &output);
 
+      /** \brief Convert the colors of the search surface (and of the input cloud, if it differs) to normalized
+        * CIELab once, so that the color histograms do not repeat the conversion for every neighborhood a point
+        * belongs to. Called at the beginning of computeFeature.
+        */
+      void
+      computeLabCache ();
+
+      /** \brief Drop the CIELab cache; computePointSHOT converts colors on the fly again afterwards. */
+      void
+      clearLabCache ()
+      {
+        surface_lab_.clear ();
+        input_lab_.clear ();
+      }
+
       /** \brief Quadrilinear interpolation; used when color and shape descriptions are both activated
         * \param[in] indices the neighborhood point indices
         * \param[in] sqr_dists the neighborhood point distances
@@ -475,6 +522,12 @@ namespace pcl
       /** \brief The number of bins in each color histogram. */
       int nr_color_bins_;
 
+      /** \brief Normalized CIELab components (L/100, a/120, b/120) of every point of surface_, empty if not cached. */
+      std::vector<float> surface_lab_;
+
+      /** \brief Normalized CIELab components of every point of input_, empty if input_ is the search surface. */
+      std::vector<float> input_lab_;
+
     public:
       /** \brief Converts RGB triplets to CIELab space.
         * \param[in] R the red channel
@@ -258,6 +258,17 @@ namespace pcl
       Eigen::ArrayXXd 
       computeSiForPoint (int index) const;
 
+      /** \brief Computes a spin-image for the point of the scan, reusing the given work buffers.
+        * \param[in] index the index of the reference point in the input cloud
+        * \param[out] nn_indices buffer for the indices of the neighbors of the reference point
+        * \param[out] nn_sqr_dists buffer for the squared distances of the neighbors of the reference point
+        * \param[out] m_matrix the estimated spin-image (or its variant)
+        * \param[out] m_averAngles buffer for the accumulated angles (only used for angular spin-images)
+        */
+      void
+      computeSiForPoint (int index, std::vector<int> &nn_indices, std::vector<float> &nn_sqr_dists,
+                         Eigen::ArrayXXd &m_matrix, Eigen::ArrayXXd &m_averAngles) const;
+
     private:
       PointCloudNConstPtr input_normals_;
       PointCloudNConstPtr rotation_axes_cloud_;
@@ -157,6 +157,10 @@ namespace pcl
       virtual bool
       initCompute ();
 
+      /** \brief Allocate the radii, elevation and azimuth intervals and fill the bin volume lookup table. */
+      void
+      initLookupTables ();
+
       /** \brief The actual feature computation.
         * \param[out] output the resultant features
         */
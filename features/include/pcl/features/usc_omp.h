@@ -0,0 +1,156 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_FEATURES_USC_OMP_H_
+#define PCL_FEATURES_USC_OMP_H_
+
+#include <pcl/features/usc.h>
+
+namespace pcl
+{
+  /** \brief UniqueShapeContextOMP estimates the Unique Shape Context descriptor, in parallel, using the OpenMP
+    * standard. The default local reference frames are computed with \ref SHOTLocalReferenceFrameEstimationOMP.
+    *
+    * Each thread keeps its own neighbor buffers and remembers the local point density of every search surface
+    * point it has already visited, so the density radius search is run at most once per point and thread
+    * instead of once per neighbor of every query point. The bins of a neighbor are looked up with a binary
+    * search over the radii, elevation and azimuth divisions precomputed in initCompute ().
+    *
+    * \ingroup features
+    */
+  template <typename PointInT, typename PointOutT = pcl::ShapeContext1980, typename PointRFT = pcl::ReferenceFrame>
+  class UniqueShapeContextOMP : public UniqueShapeContext<PointInT, PointOutT, PointRFT>
+  {
+    public:
+      using Feature<PointInT, PointOutT>::feature_name_;
+      using Feature<PointInT, PointOutT>::getClassName;
+      using Feature<PointInT, PointOutT>::indices_;
+      using Feature<PointInT, PointOutT>::search_radius_;
+      using Feature<PointInT, PointOutT>::surface_;
+      using Feature<PointInT, PointOutT>::fake_surface_;
+      using Feature<PointInT, PointOutT>::input_;
+      using Feature<PointInT, PointOutT>::searchForNeighbors;
+      using FeatureWithLocalReferenceFrames<PointInT, PointRFT>::frames_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::radii_interval_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::theta_divisions_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::phi_divisions_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::volume_lut_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::azimuth_bins_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::elevation_bins_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::radius_bins_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::min_radius_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::point_density_radius_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::descriptor_length_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::local_radius_;
+      using UniqueShapeContext<PointInT, PointOutT, PointRFT>::computePointDescriptor;
+
+      typedef typename Feature<PointInT, PointOutT>::PointCloudOut PointCloudOut;
+      typedef typename Feature<PointInT, PointOutT>::PointCloudIn PointCloudIn;
+      typedef typename boost::shared_ptr<UniqueShapeContextOMP<PointInT, PointOutT, PointRFT> > Ptr;
+      typedef typename boost::shared_ptr<const UniqueShapeContextOMP<PointInT, PointOutT, PointRFT> > ConstPtr;
+
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      UniqueShapeContextOMP (unsigned int nr_threads = 0) :
+        UniqueShapeContext<PointInT, PointOutT, PointRFT> (), threads_ (nr_threads)
+      {
+        feature_name_ = "UniqueShapeContextOMP";
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+    protected:
+      /** \brief Initialize computation by estimating the missing local reference frames in parallel, and
+        * allocating all the intervals and the volume lookup table.
+        */
+      virtual bool
+      initCompute ();
+
+      /** \brief Compute 3D shape context feature descriptor. Safe to call concurrently.
+        * \param[in] index point index in input_
+        * \param[out] desc descriptor to compute, expected to be zeroed
+        * \param[out] nn_indices buffer for the indices of the neighbors of the point
+        * \param[out] nn_dists buffer for the squared distances of the neighbors of the point
+        * \param[in,out] densities the local point density of every search surface point, or -1 if not known yet
+        */
+      void
+      computePointDescriptor (size_t index, std::vector<float> &desc,
+                              std::vector<int> &nn_indices, std::vector<float> &nn_dists, std::vector<int> &densities);
+
+      /** \brief Find the bin of a value, given the bin boundaries. Equivalent to picking the first upper
+        * boundary that is not smaller than the value, the first bin being the default.
+        * \param[in] divisions the (sorted) bin boundaries, lower bound of the first bin included
+        * \param[in] value the value to look up
+        */
+      static inline size_t
+      findBin (const std::vector<float> &divisions, float value)
+      {
+        std::vector<float>::const_iterator it = std::lower_bound (divisions.begin () + 1, divisions.end (), value);
+        return (it == divisions.end () ? 0 : static_cast<size_t> (it - divisions.begin ()) - 1);
+      }
+
+      /** \brief The actual feature computation.
+        * \param[out] output the resultant features
+        */
+      virtual void
+      computeFeature (PointCloudOut &output);
+
+    private:
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Make the computeFeature (&Eigen::MatrixXf); inaccessible from outside the class
+        * \param[out] output the output point cloud
+        */
+      void
+      computeFeatureEigen (pcl::PointCloud<Eigen::MatrixXf> &) {}
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/features/impl/usc_omp.hpp>
+#endif
+
+#endif  //#ifndef PCL_FEATURES_USC_OMP_H_
@@ -93,39 +93,36 @@ NarfDescriptor::computeFeature(NarfDescriptor::PointCloudOut& output)
     output.points.clear ();
     return;
   }
-  std::vector<Narf*> feature_list;
-  if (indices_)
+  int no_of_points = (indices_ ? static_cast<int> (indices_->size()) : static_cast<int> (range_image_->width*range_image_->height));
+  
+  // Every point gets its own list (a rotation invariant extraction can give several features per point), so that
+  // the output keeps the order of the points regardless of the number of threads
+  std::vector<std::vector<Narf*> > feature_lists (no_of_points);
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
+  for (int point_idx=0; point_idx<no_of_points; ++point_idx)
   {
-    for (size_t indices_idx=0; indices_idx<indices_->size(); ++indices_idx)
-    {
-      int point_index = (*indices_)[indices_idx];
-      int y=point_index/range_image_->width, x=point_index - y*range_image_->width;
-      Narf::extractFromRangeImageAndAddToList(*range_image_, static_cast<float> (x), static_cast<float> (y), 36, parameters_.support_size,
-                                              parameters_.rotation_invariant, feature_list);
-    }
+    int point_index = (indices_ ? (*indices_)[point_idx] : point_idx);
+    int y=point_index/range_image_->width, x=point_index - y*range_image_->width;
+    Narf::extractFromRangeImageAndAddToList(*range_image_, static_cast<float> (x), static_cast<float> (y), 36, parameters_.support_size,
+                                            parameters_.rotation_invariant, feature_lists[point_idx]);
   }
-  else
+  
+  size_t no_of_features = 0;
+  for (int point_idx=0; point_idx<no_of_points; ++point_idx)
+    no_of_features += feature_lists[point_idx].size();
+  
+  // Copy to NARF36 struct and cleanup
+  output.points.resize(no_of_features);
+  size_t feature_idx = 0;
+  for (int point_idx=0; point_idx<no_of_points; ++point_idx)
   {
-    for (unsigned int y=0; y<range_image_->height; ++y)
+    std::vector<Narf*>& feature_list = feature_lists[point_idx];
+    for (size_t i=0; i<feature_list.size(); ++i)
     {
-      for (unsigned int x=0; x<range_image_->width; ++x)
-      {
-        Narf::extractFromRangeImageAndAddToList(*range_image_, static_cast<float> (x), static_cast<float> (y), 36, parameters_.support_size,
-                                                parameters_.rotation_invariant, feature_list);
-      }
+      feature_list[i]->copyToNarf36(output.points[feature_idx++]);
+      delete feature_list[i];
     }
   }
-  
-  // Copy to NARF36 struct
-  output.points.resize(feature_list.size());
-  for (unsigned int i=0; i<feature_list.size(); ++i)
-  {
-    feature_list[i]->copyToNarf36(output.points[i]);
-  }
-  
-  // Cleanup
-  for (size_t i=0; i<feature_list.size(); ++i)
-    delete feature_list[i];
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -82,16 +82,7 @@ RangeImageBorderExtractor::clearData ()
   delete[] border_scores_right_;   border_scores_right_  = NULL;
   delete[] border_scores_top_;     border_scores_top_    = NULL;
   delete[] border_scores_bottom_;  border_scores_bottom_ = NULL;
-  //cout << PVARC(range_image_size_during_extraction_)<<PVARN((void*)this);
-  for (int i=0; i<range_image_size_during_extraction_; ++i)
-  {
-    if (surface_structure_!=NULL)
-      delete surface_structure_[i];
-    if (shadow_border_informations_!=NULL)
-      delete shadow_border_informations_[i];
-    if (border_directions_!=NULL)
-      delete border_directions_[i];
-  }
+  // The per pixel data lives in the storage vectors, which keep their memory for the next range image
   delete[] surface_structure_; surface_structure_ = NULL;
   delete border_descriptions_; border_descriptions_ = NULL;
   delete[] shadow_border_informations_; shadow_border_informations_ = NULL;
@@ -115,6 +106,7 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
   range_image_size_during_extraction_ = width*height;
   int array_size = range_image_size_during_extraction_;
   surface_structure_ = new LocalSurface*[array_size];
+  surface_structure_storage_.resize (array_size);
   int step_size = (std::max)(1, parameters_.pixel_radius_plane_extraction/2);
   //cout << PVARN(step_size);
   int no_of_nearest_neighbors = static_cast<int> (pow (static_cast<double> (parameters_.pixel_radius_plane_extraction/step_size + 1), 2.0));
@@ -129,7 +121,8 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
       local_surface = NULL;
       if (!range_image_->isValid(index))
         continue;
-      local_surface = new LocalSurface;
+      local_surface = &surface_structure_storage_[index];
+      *local_surface = LocalSurface ();
       Eigen::Vector3f point;
       range_image_->getPoint(x, y, point);
       //cout << PVARN(point);
@@ -139,7 +132,6 @@ RangeImageBorderExtractor::extractLocalSurfaceStructure ()
                                   local_surface->eigen_values_no_jumps,  &local_surface->normal,
                                   &local_surface->neighborhood_mean, &local_surface->eigen_values))
       {
-        delete local_surface;
         local_surface = NULL;
       }
       
@@ -192,11 +184,16 @@ RangeImageBorderExtractor::extractBorderScoreImages ()
 float* 
 RangeImageBorderExtractor::updatedScoresAccordingToNeighborValues (const float* border_scores) const
 {
-  float* new_scores = new float[range_image_->width*range_image_->height];
-  float* new_scores_ptr = new_scores;
-  for (int y=0; y < static_cast<int> (range_image_->height); ++y) 
-    for (int x=0; x < static_cast<int> (range_image_->width); ++x) 
+  int width  = range_image_->width,
+      height = range_image_->height;
+  float* new_scores = new float[width*height];
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
+  for (int y=0; y < height; ++y) 
+  {
+    float* new_scores_ptr = new_scores + y*width;
+    for (int x=0; x < width; ++x) 
       *(new_scores_ptr++) = updatedScoreAccordingToNeighborValues(x, y, border_scores);
+  }
   return (new_scores);
 }
 
@@ -239,6 +236,7 @@ RangeImageBorderExtractor::findAndEvaluateShadowBorders ()
   int width  = range_image_->width,
       height = range_image_->height;
   shadow_border_informations_ = new ShadowBorderIndices*[width*height];
+  shadow_border_informations_storage_.resize (width*height);
   for (int y = 0; y < static_cast<int> (height); ++y) 
   {
     for (int x = 0; x < static_cast<int> (width); ++x) 
@@ -250,22 +248,22 @@ RangeImageBorderExtractor::findAndEvaluateShadowBorders ()
       
       if (changeScoreAccordingToShadowBorderValue(x, y, -1, 0, border_scores_left_, border_scores_right_, shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==NULL ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==NULL ? &(shadow_border_informations_storage_[index] = ShadowBorderIndices ()) : shadow_border_indices);
         shadow_border_indices->left = shadow_border_idx;
       }
       if (changeScoreAccordingToShadowBorderValue(x, y, 1, 0, border_scores_right_, border_scores_left_, shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==NULL ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==NULL ? &(shadow_border_informations_storage_[index] = ShadowBorderIndices ()) : shadow_border_indices);
         shadow_border_indices->right = shadow_border_idx;
       }
       if (changeScoreAccordingToShadowBorderValue(x, y, 0, -1, border_scores_top_, border_scores_bottom_, shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==NULL ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==NULL ? &(shadow_border_informations_storage_[index] = ShadowBorderIndices ()) : shadow_border_indices);
         shadow_border_indices->top = shadow_border_idx;
       }
       if (changeScoreAccordingToShadowBorderValue(x, y, 0, 1, border_scores_bottom_, border_scores_top_, shadow_border_idx))
       {
-        shadow_border_indices = (shadow_border_indices==NULL ? new ShadowBorderIndices : shadow_border_indices);
+        shadow_border_indices = (shadow_border_indices==NULL ? &(shadow_border_informations_storage_[index] = ShadowBorderIndices ()) : shadow_border_indices);
         shadow_border_indices->bottom = shadow_border_idx;
       }
     }
@@ -470,6 +468,8 @@ RangeImageBorderExtractor::calculateBorderDirections ()
       height = range_image_->height,
       size   = width*height;
   border_directions_ = new Eigen::Vector3f*[size];
+  border_directions_storage_.resize (size);
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -479,9 +479,11 @@ RangeImageBorderExtractor::calculateBorderDirections ()
   }
   
   Eigen::Vector3f** average_border_directions = new Eigen::Vector3f*[size];
+  average_border_directions_storage_.resize (size);
   int radius = parameters_.pixel_radius_border_direction;
   int minimum_weight = radius+1;
   float min_cos_angle=cosf(deg2rad(120.0f));
+# pragma omp parallel for num_threads(parameters_.max_no_of_threads) default(shared) schedule(dynamic, 10)
   for (int y=0; y<height; ++y)
   {
     for (int x=0; x<width; ++x)
@@ -492,7 +494,8 @@ RangeImageBorderExtractor::calculateBorderDirections ()
       const Eigen::Vector3f* border_direction = border_directions_[index];
       if (border_direction==NULL)
         continue;
-      average_border_direction = new Eigen::Vector3f(*border_direction);
+      average_border_direction = &average_border_directions_storage_[index];
+      *average_border_direction = *border_direction;
       float weight_sum = 1.0f;
       for (int y2=(std::max)(0, y-radius); y2<=(std::min)(y+radius, height-1); ++y2)
       {
@@ -523,17 +526,13 @@ RangeImageBorderExtractor::calculateBorderDirections ()
         }
       }
       if (pcl_lrint (weight_sum) < minimum_weight)
-      {
-        delete average_border_direction;
         average_border_direction=NULL;
-      }
       else
         average_border_direction->normalize();
     }
   }
   
-  for (int i=0; i<size; ++i)
-    delete border_directions_[i];
+  // The averaged directions replace the original ones, the storage of which is only needed again for the next range image
   delete[] border_directions_;
   border_directions_ = average_border_directions;
 }
@@ -41,13 +41,19 @@
 #include <pcl/octree/octree_pointcloud.h>
 #include <pcl/compression/entropy_range_coder.h>
 
+#include <algorithm>
 #include <iterator>
 #include <iostream>
+#include <sstream>
 #include <vector>
 #include <string.h>
 #include <iostream>
 #include <stdio.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace pcl::octree;
 
 namespace pcl
@@ -121,6 +127,15 @@ namespace pcl
         pointCoder_.initializeEncoding ();
         pointCoder_.setPointCount (static_cast<unsigned int> (cloud_arg->points.size ()));
 
+        // leaf nodes are only collected during serialization if chunks are encoded separately
+        chunkLeafs_.clear ();
+        chunkLeafKeys_.clear ();
+        if (chunkCount_)
+        {
+          chunkLeafs_.reserve (this->leafCount_);
+          chunkLeafKeys_.reserve (this->leafCount_);
+        }
+
         // serialize octree
         if (iFrame_)
           // i-frame encoding - encode tree structure without referencing previous buffer
@@ -210,6 +225,7 @@ namespace pcl
       // initialize output cloud
       output_->points.clear ();
       output_->points.reserve (static_cast<std::size_t> (pointCount_));
+      chunkLeafKeys_.clear ();
 
       if (iFrame_)
         // i-frame decoding - decode tree structure without referencing previous buffer
@@ -218,6 +234,10 @@ namespace pcl
         // p-frame decoding - decode XOR encoded tree structure
         this->deserializeTree (binaryTreeDataVector_, true);
 
+      // decode leaf data of all chunks following the octree structure
+      if (chunkCount_)
+        this->decodeChunks (compressedTreeDataIn_arg);
+
       // assign point cloud properties
       output_->height = 1;
       output_->width = static_cast<uint32_t> (cloud_arg->points.size ());
@@ -263,6 +283,14 @@ namespace pcl
       compressedPointDataLen_ += entropyCoder_.encodeCharVectorToStream (binaryTreeDataVector_,
                                                                          compressedTreeDataOut_arg);
 
+      if (chunkCount_)
+      {
+        // leaf data is coded in independent chunks
+        this->encodeChunks (compressedTreeDataOut_arg);
+        compressedTreeDataOut_arg.flush ();
+        return;
+      }
+
       if (cloudWithColor_)
       {
         // encode averaged voxel color information
@@ -323,6 +351,10 @@ namespace pcl
       compressedPointDataLen_ += entropyCoder_.decodeStreamToCharVector (compressedTreeDataIn_arg,
                                                                          binaryTreeDataVector_);
 
+      // chunked leaf data is decoded after the octree structure by decodeChunks
+      if (chunkCount_)
+        return;
+
       if (dataWithColor_)
       {
         // decode averaged voxel color information
@@ -368,8 +400,9 @@ namespace pcl
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::writeFrameHeader (std::ostream& compressedTreeDataOut_arg)
     {
-      // encode header identifier
-      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (frameHeaderIdentifier_), strlen (frameHeaderIdentifier_));
+      // encode header identifier, chunked streams use their own identifier
+      const char* headerIdentifier = chunkCount_ ? frameHeaderIdentifierChunked_ : frameHeaderIdentifier_;
+      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (headerIdentifier), strlen (headerIdentifier));
       // encode point cloud header id
       compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&frameID_), sizeof (frameID_));
       // encode frame type (I/P-frame)
@@ -408,6 +441,10 @@ namespace pcl
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&maxX), sizeof (maxX));
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&maxY), sizeof (maxY));
         compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&maxZ), sizeof (maxZ));
+
+        // encode leaf data layout of chunked streams
+        if (chunkCount_)
+          compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&chunkCount_), sizeof (chunkCount_));
       }
     }
 
@@ -415,21 +452,29 @@ namespace pcl
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::syncToHeader ( std::istream& compressedTreeDataIn_arg)
     {
-      // sync to frame header
+      // sync to frame header of either a single stream or a chunked frame
       unsigned int headerIdPos = 0;
-      while (headerIdPos < strlen (frameHeaderIdentifier_))
+      unsigned int chunkedIdPos = 0;
+      while (headerIdPos < strlen (frameHeaderIdentifier_) && chunkedIdPos < strlen (frameHeaderIdentifierChunked_))
       {
         char readChar;
         compressedTreeDataIn_arg.read (static_cast<char*> (&readChar), sizeof (readChar));
         if (readChar != frameHeaderIdentifier_[headerIdPos++])
           headerIdPos = (frameHeaderIdentifier_[0]==readChar)?1:0;
+        if (readChar != frameHeaderIdentifierChunked_[chunkedIdPos++])
+          chunkedIdPos = (frameHeaderIdentifierChunked_[0]==readChar)?1:0;
       }
+      chunkedFrame_ = (chunkedIdPos == strlen (frameHeaderIdentifierChunked_));
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::readFrameHeader ( std::istream& compressedTreeDataIn_arg)
     {
+      // frames of a single stream carry their leaf data in the data vectors
+      if (!chunkedFrame_)
+        chunkCount_ = 0;
+
       // read header
       compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&frameID_), sizeof (frameID_));
       compressedTreeDataIn_arg.read (reinterpret_cast<char*>(&iFrame_), sizeof (iFrame_));
@@ -456,6 +501,10 @@ namespace pcl
         compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&maxY), sizeof (maxY));
         compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&maxZ), sizeof (maxZ));
 
+        // read leaf data layout of chunked streams
+        if (chunkedFrame_)
+          compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&chunkCount_), sizeof (chunkCount_));
+
         // reset octree and assign new bounding box & resolution
         this->deleteTree ();
         this->setResolution (octreeResolution);
@@ -467,11 +516,298 @@ namespace pcl
       }
     }
 
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::encodeChunks (std::ostream& compressedTreeDataOut_arg)
+    {
+      const std::size_t leafCount = chunkLeafs_.size ();
+      const std::size_t chunkCount = std::max<std::size_t> (1, std::min<std::size_t> (chunkCount_, leafCount));
+
+      std::vector<uint64_t> chunkLeafCount (chunkCount);
+      std::vector<uint64_t> chunkPointCount (chunkCount);
+      std::vector<uint64_t> chunkPointDataLen (chunkCount);
+      std::vector<uint64_t> chunkColorDataLen (chunkCount);
+      std::vector<std::string> chunkData (chunkCount);
+
+      const float pointPrecision = pointCoder_.getPrecision ();
+      const unsigned char colorBitDepth = colorCoder_.getBitDepth ();
+
+      int nr_threads = 1;
+#ifdef _OPENMP
+      nr_threads = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#pragma omp parallel for num_threads (nr_threads) schedule (dynamic, 1)
+#endif
+      for (int c = 0; c < static_cast<int> (chunkCount); ++c)
+      {
+        const std::size_t leafBegin = leafCount * c / chunkCount;
+        const std::size_t leafEnd = leafCount * (c + 1) / chunkCount;
+
+        // every chunk is coded with its own coder instances
+        PointCoding<PointT> pointCoder;
+        ColorCoding<PointT> colorCoder;
+        StaticRangeCoder entropyCoder;
+        std::vector<unsigned int> pointCountDataVector;
+
+        pointCoder.setPrecision (pointPrecision);
+        colorCoder.setBitDepth (colorBitDepth);
+        pointCoder.initializeEncoding ();
+        colorCoder.initializeEncoding ();
+
+        uint64_t pointCount = 0;
+        for (std::size_t i = leafBegin; i < leafEnd; ++i)
+        {
+          const std::vector<int>& leafIdx = chunkLeafs_[i]->getDataTVector ();
+          const OctreeKey& key = chunkLeafKeys_[i];
+
+          if (!doVoxelGridEnDecoding_)
+          {
+            double lowerVoxelCorner[3];
+            lowerVoxelCorner[0] = static_cast<double> (key.x) * this->resolution_ + this->minX_;
+            lowerVoxelCorner[1] = static_cast<double> (key.y) * this->resolution_ + this->minY_;
+            lowerVoxelCorner[2] = static_cast<double> (key.z) * this->resolution_ + this->minZ_;
+
+            pointCountDataVector.push_back (static_cast<unsigned int> (leafIdx.size ()));
+            pointCoder.encodePoints (leafIdx, lowerVoxelCorner, this->input_);
+            if (cloudWithColor_)
+              colorCoder.encodePoints (leafIdx, pointColorOffset_, this->input_);
+            pointCount += leafIdx.size ();
+          }
+          else
+          {
+            if (cloudWithColor_)
+              colorCoder.encodeAverageOfPoints (leafIdx, pointColorOffset_, this->input_);
+            pointCount++;
+          }
+        }
+
+        // entropy code the chunk data in the same order as entropyEncoding
+        std::ostringstream chunkStream;
+        uint64_t vectorSize;
+        uint64_t pointDataLen = 0;
+        uint64_t colorDataLen = 0;
+
+        if (cloudWithColor_)
+        {
+          std::vector<char>& pointAvgColorDataVector = colorCoder.getAverageDataVector ();
+          vectorSize = pointAvgColorDataVector.size ();
+          chunkStream.write (reinterpret_cast<const char*> (&vectorSize), sizeof (vectorSize));
+          colorDataLen += entropyCoder.encodeCharVectorToStream (pointAvgColorDataVector, chunkStream);
+        }
+
+        if (!doVoxelGridEnDecoding_)
+        {
+          vectorSize = pointCountDataVector.size ();
+          chunkStream.write (reinterpret_cast<const char*> (&vectorSize), sizeof (vectorSize));
+          pointDataLen += entropyCoder.encodeIntVectorToStream (pointCountDataVector, chunkStream);
+
+          std::vector<char>& pointDiffDataVector = pointCoder.getDifferentialDataVector ();
+          vectorSize = pointDiffDataVector.size ();
+          chunkStream.write (reinterpret_cast<const char*> (&vectorSize), sizeof (vectorSize));
+          pointDataLen += entropyCoder.encodeCharVectorToStream (pointDiffDataVector, chunkStream);
+
+          if (cloudWithColor_)
+          {
+            std::vector<char>& pointDiffColorDataVector = colorCoder.getDifferentialDataVector ();
+            vectorSize = pointDiffColorDataVector.size ();
+            chunkStream.write (reinterpret_cast<const char*> (&vectorSize), sizeof (vectorSize));
+            colorDataLen += entropyCoder.encodeCharVectorToStream (pointDiffColorDataVector, chunkStream);
+          }
+        }
+
+        chunkLeafCount[c] = leafEnd - leafBegin;
+        chunkPointCount[c] = pointCount;
+        chunkPointDataLen[c] = pointDataLen;
+        chunkColorDataLen[c] = colorDataLen;
+        chunkData[c] = chunkStream.str ();
+      }
+
+      // write chunk index
+      const uint32_t chunkIndexSize = static_cast<uint32_t> (chunkCount);
+      compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&chunkIndexSize), sizeof (chunkIndexSize));
+      for (std::size_t c = 0; c < chunkCount; ++c)
+      {
+        const uint64_t chunkDataSize = chunkData[c].size ();
+        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&chunkLeafCount[c]), sizeof (chunkLeafCount[c]));
+        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&chunkPointCount[c]), sizeof (chunkPointCount[c]));
+        compressedTreeDataOut_arg.write (reinterpret_cast<const char*> (&chunkDataSize), sizeof (chunkDataSize));
+      }
+
+      // write chunk data
+      for (std::size_t c = 0; c < chunkCount; ++c)
+      {
+        compressedTreeDataOut_arg.write (chunkData[c].data (), chunkData[c].size ());
+        compressedPointDataLen_ += chunkPointDataLen[c];
+        compressedColorDataLen_ += chunkColorDataLen[c];
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
+    OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::decodeChunks (std::istream& compressedTreeDataIn_arg)
+    {
+      // read chunk index
+      uint32_t chunkIndexSize = 0;
+      compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&chunkIndexSize), sizeof (chunkIndexSize));
+      const std::size_t chunkCount = chunkIndexSize;
+
+      std::vector<uint64_t> chunkLeafBegin (chunkCount + 1, 0);
+      std::vector<uint64_t> chunkPointBegin (chunkCount + 1, 0);
+      std::vector<uint64_t> chunkDataSize (chunkCount);
+      for (std::size_t c = 0; c < chunkCount; ++c)
+      {
+        uint64_t leafCount = 0, pointCount = 0;
+        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&leafCount), sizeof (leafCount));
+        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&pointCount), sizeof (pointCount));
+        compressedTreeDataIn_arg.read (reinterpret_cast<char*> (&chunkDataSize[c]), sizeof (chunkDataSize[c]));
+        chunkLeafBegin[c + 1] = chunkLeafBegin[c] + leafCount;
+        chunkPointBegin[c + 1] = chunkPointBegin[c] + pointCount;
+      }
+
+      // read chunk data
+      std::vector<std::string> chunkData (chunkCount);
+      for (std::size_t c = 0; c < chunkCount; ++c)
+      {
+        chunkData[c].resize (static_cast<std::size_t> (chunkDataSize[c]));
+        if (chunkDataSize[c])
+          compressedTreeDataIn_arg.read (&chunkData[c][0], static_cast<std::streamsize> (chunkDataSize[c]));
+      }
+
+      if (!compressedTreeDataIn_arg || chunkLeafBegin[chunkCount] != chunkLeafKeys_.size ())
+      {
+        PCL_ERROR ("[pcl::io::OctreePointCloudCompression::decodeChunks] Chunk index does not match the decoded octree.\n");
+        return;
+      }
+
+      output_->points.resize (static_cast<std::size_t> (chunkPointBegin[chunkCount]));
+
+      std::vector<uint64_t> chunkPointDataLen (chunkCount, 0);
+      std::vector<uint64_t> chunkColorDataLen (chunkCount, 0);
+
+      const float pointPrecision = pointCoder_.getPrecision ();
+      const unsigned char colorBitDepth = colorCoder_.getBitDepth ();
+
+      int nr_threads = 1;
+#ifdef _OPENMP
+      nr_threads = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#pragma omp parallel for num_threads (nr_threads) schedule (dynamic, 1)
+#endif
+      for (int c = 0; c < static_cast<int> (chunkCount); ++c)
+      {
+        // every chunk is decoded with its own coder instances
+        PointCoding<PointT> pointCoder;
+        ColorCoding<PointT> colorCoder;
+        StaticRangeCoder entropyCoder;
+        std::vector<unsigned int> pointCountDataVector;
+
+        pointCoder.setPrecision (pointPrecision);
+        colorCoder.setBitDepth (colorBitDepth);
+
+        // entropy decode the chunk data in the same order as entropyDecoding
+        std::istringstream chunkStream (chunkData[c]);
+        uint64_t vectorSize;
+
+        if (dataWithColor_)
+        {
+          std::vector<char>& pointAvgColorDataVector = colorCoder.getAverageDataVector ();
+          chunkStream.read (reinterpret_cast<char*> (&vectorSize), sizeof (vectorSize));
+          pointAvgColorDataVector.resize (static_cast<std::size_t> (vectorSize));
+          chunkColorDataLen[c] += entropyCoder.decodeStreamToCharVector (chunkStream, pointAvgColorDataVector);
+        }
+
+        if (!doVoxelGridEnDecoding_)
+        {
+          chunkStream.read (reinterpret_cast<char*> (&vectorSize), sizeof (vectorSize));
+          pointCountDataVector.resize (static_cast<std::size_t> (vectorSize));
+          chunkPointDataLen[c] += entropyCoder.decodeStreamToIntVector (chunkStream, pointCountDataVector);
+
+          std::vector<char>& pointDiffDataVector = pointCoder.getDifferentialDataVector ();
+          chunkStream.read (reinterpret_cast<char*> (&vectorSize), sizeof (vectorSize));
+          pointDiffDataVector.resize (static_cast<std::size_t> (vectorSize));
+          chunkPointDataLen[c] += entropyCoder.decodeStreamToCharVector (chunkStream, pointDiffDataVector);
+
+          if (dataWithColor_)
+          {
+            std::vector<char>& pointDiffColorDataVector = colorCoder.getDifferentialDataVector ();
+            chunkStream.read (reinterpret_cast<char*> (&vectorSize), sizeof (vectorSize));
+            pointDiffColorDataVector.resize (static_cast<std::size_t> (vectorSize));
+            chunkColorDataLen[c] += entropyCoder.decodeStreamToCharVector (chunkStream, pointDiffColorDataVector);
+          }
+        }
+
+        pointCoder.initializeDecoding ();
+        colorCoder.initializeDecoding ();
+
+        // decode points of all leaf nodes within this chunk
+        const std::size_t leafBegin = static_cast<std::size_t> (chunkLeafBegin[c]);
+        const std::size_t leafEnd = static_cast<std::size_t> (chunkLeafBegin[c + 1]);
+        const std::size_t pointEnd = static_cast<std::size_t> (chunkPointBegin[c + 1]);
+        std::size_t pointIdx = static_cast<std::size_t> (chunkPointBegin[c]);
+
+        if (!doVoxelGridEnDecoding_ && pointCountDataVector.size () != leafEnd - leafBegin)
+          continue;
+
+        for (std::size_t i = leafBegin; i < leafEnd; ++i)
+        {
+          const OctreeKey& key = chunkLeafKeys_[i];
+          std::size_t pointCount = 1;
+
+          if (!doVoxelGridEnDecoding_)
+          {
+            pointCount = pointCountDataVector[i - leafBegin];
+            if (pointIdx + pointCount > pointEnd)
+              break;
+
+            double lowerVoxelCorner[3];
+            lowerVoxelCorner[0] = static_cast<double> (key.x) * this->resolution_ + this->minX_;
+            lowerVoxelCorner[1] = static_cast<double> (key.y) * this->resolution_ + this->minY_;
+            lowerVoxelCorner[2] = static_cast<double> (key.z) * this->resolution_ + this->minZ_;
+
+            pointCoder.decodePoints (output_, lowerVoxelCorner, pointIdx, pointIdx + pointCount);
+          }
+          else
+          {
+            if (pointIdx >= pointEnd)
+              break;
+
+            // voxel center
+            PointT& point = output_->points[pointIdx];
+            point.x = static_cast<float> ((static_cast<double> (key.x) + 0.5) * this->resolution_ + this->minX_);
+            point.y = static_cast<float> ((static_cast<double> (key.y) + 0.5) * this->resolution_ + this->minY_);
+            point.z = static_cast<float> ((static_cast<double> (key.z) + 0.5) * this->resolution_ + this->minZ_);
+          }
+
+          if (cloudWithColor_)
+          {
+            if (dataWithColor_)
+              colorCoder.decodePoints (output_, pointIdx, pointIdx + pointCount, pointColorOffset_);
+            else
+              colorCoder.setDefaultColor (output_, pointIdx, pointIdx + pointCount, pointColorOffset_);
+          }
+
+          pointIdx += pointCount;
+        }
+      }
+
+      for (std::size_t c = 0; c < chunkCount; ++c)
+      {
+        compressedPointDataLen_ += chunkPointDataLen[c];
+        compressedColorDataLen_ += chunkColorDataLen[c];
+      }
+    }
+
     //////////////////////////////////////////////////////////////////////////////////////////////
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT> void
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::serializeTreeCallback (
         LeafNode &leaf_arg, const OctreeKey & key_arg)
     {
+      if (chunkCount_)
+      {
+        // leaf data is encoded later by encodeChunks
+        chunkLeafs_.push_back (&leaf_arg);
+        chunkLeafKeys_.push_back (key_arg);
+        return;
+      }
+
       // reference to point indices vector stored within octree leaf
       const std::vector<int>& leafIdx = leaf_arg.getDataTVector ();
 
@@ -507,6 +843,13 @@ namespace pcl
     OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::deserializeTreeCallback (LeafNode&,
         const OctreeKey& key_arg)
     {
+      if (chunkCount_)
+      {
+        // leaf data is decoded later by decodeChunks
+        chunkLeafKeys_.push_back (key_arg);
+        return;
+      }
+
       double lowerVoxelCorner[3];
       std::size_t pointCount, i, cloudSize;
       PointT newPoint;
@@ -56,6 +56,10 @@
 #include <limits>
 #include <assert.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace pcl
 {
   namespace io
@@ -80,8 +84,23 @@ namespace pcl
 
       analyzeOrganizedCloud (cloud_arg, maxDepth, focalLength);
 
-      // encode header identifier
-      compressedDataOut_arg.write (reinterpret_cast<const char*> (frameHeaderIdentifier_), strlen (frameHeaderIdentifier_));
+      // disparity and rgb image data
+      std::vector<uint16_t> disparityData;
+      std::vector<uint8_t> colorData;
+
+      uint32_t compressedDisparitySize = 0;
+      uint32_t compressedColorSize = 0;
+
+      // Convert point cloud to disparity and rgb image
+      OrganizedConversion<PointT>::convert (*cloud_arg, focalLength, disparityShift, disparityScale, convertToMono,  disparityData, colorData);
+
+      // Color information is only encoded if requested
+      if (!(CompressionPointTraits<PointT>::hasColor && doColorEncoding))
+        colorData.clear ();
+      const unsigned int colorChannels = convertToMono ? 1 : 3;
+
+      // encode header identifier and frame type
+      const bool predictFrame = writeFrameType (cloud_width, cloud_height, colorData, colorChannels, compressedDataOut_arg);
       // encode point cloud width
       compressedDataOut_arg.write (reinterpret_cast<const char*> (&cloud_width), sizeof (cloud_width));
       // encode frame type height
@@ -95,46 +114,9 @@ namespace pcl
       // encode frame disparity shift
       compressedDataOut_arg.write (reinterpret_cast<const char*> (&disparityShift), sizeof (disparityShift));
 
-      // disparity and rgb image data
-      std::vector<uint16_t> disparityData;
-      std::vector<uint8_t> colorData;
-
-      // compressed disparity and rgb image data
-      std::vector<uint8_t> compressedDisparity;
-      std::vector<uint8_t> compressedColor;
-
-      uint32_t compressedDisparitySize = 0;
-      uint32_t compressedColorSize = 0;
-
-      // Convert point cloud to disparity and rgb image
-      OrganizedConversion<PointT>::convert (*cloud_arg, focalLength, disparityShift, disparityScale, convertToMono,  disparityData, colorData);
-
-      // Compress disparity information
-      encodeMonoImageToPNG (disparityData, cloud_width, cloud_height, compressedDisparity, pngLevel_arg);
-
-      compressedDisparitySize = static_cast<uint32_t>(compressedDisparity.size());
-      // Encode size of compressed disparity image data
-      compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparitySize), sizeof (compressedDisparitySize));
-      // Output compressed disparity to ostream
-      compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparity[0]), compressedDisparity.size () * sizeof(uint8_t));
-
-      // Compress color information
-      if (CompressionPointTraits<PointT>::hasColor && doColorEncoding)
-      {
-        if (convertToMono)
-        {
-          encodeMonoImageToPNG (colorData, cloud_width, cloud_height, compressedColor, 1 /*Z_BEST_SPEED*/);
-        } else
-        {
-          encodeRGBImageToPNG (colorData, cloud_width, cloud_height, compressedColor, 1 /*Z_BEST_SPEED*/);
-        }
-      }
-
-      compressedColorSize = static_cast<uint32_t>(compressedColor.size ());
-      // Encode size of compressed Color image data
-      compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedColorSize), sizeof (compressedColorSize));
-      // Output compressed disparity to ostream
-      compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedColor[0]), compressedColor.size () * sizeof(uint8_t));
+      // Compress disparity and color information
+      encodeFrameImages (disparityData, colorData, colorChannels, cloud_width, cloud_height, predictFrame, pngLevel_arg,
+                         compressedDataOut_arg, compressedDisparitySize, compressedColorSize);
 
       if (bShowStatistics_arg)
       {
@@ -142,6 +124,8 @@ namespace pcl
         float bytesPerPoint = static_cast<float> (compressedDisparitySize+compressedColorSize) / static_cast<float> (pointCount);
 
         PCL_INFO("*** POINTCLOUD ENCODING ***\n");
+        if (iFrameRate_)
+          PCL_INFO("Encoding Frame: %s\n", predictFrame ? "Prediction frame" : "Intra frame");
         PCL_INFO("Number of encoded points: %ld\n", pointCount);
         PCL_INFO("Size of uncompressed point cloud: %.2f kBytes\n", (static_cast<float> (pointCount) * CompressionPointTraits<PointT>::bytesPerPoint) / 1024.0f);
         PCL_INFO("Size of compressed point cloud: %.2f kBytes\n", static_cast<float> (compressedDisparitySize+compressedColorSize) / 1024.0f);
@@ -178,58 +162,38 @@ namespace pcl
          assert (colorImage_arg.size()==cloud_size*3);
        }
 
-       // encode header identifier
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (frameHeaderIdentifier_), strlen (frameHeaderIdentifier_));
-       // encode point cloud width
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&width_arg), sizeof (width_arg));
-       // encode frame type height
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&height_arg), sizeof (height_arg));
-       // encode frame max depth
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&maxDepth), sizeof (maxDepth));
-       // encode frame focal lenght
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&focalLength_arg), sizeof (focalLength_arg));
-       // encode frame disparity scale
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&disparityScale_arg), sizeof (disparityScale_arg));
-       // encode frame disparity shift
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&disparityShift_arg), sizeof (disparityShift_arg));
-
-       // compressed disparity and rgb image data
-       std::vector<uint8_t> compressedDisparity;
-       std::vector<uint8_t> compressedColor;
-
        uint32_t compressedDisparitySize = 0;
        uint32_t compressedColorSize = 0;
 
        // Remove color information of invalid points
-       uint16_t* depth_ptr = &disparityMap_arg[0];
-       uint8_t* color_ptr = &colorImage_arg[0];
-
-       size_t i;
-       for (i=0; i<cloud_size; ++i, ++depth_ptr, color_ptr+=sizeof(uint8_t)*3)
+       if (colorImage_arg.size ())
        {
-         if (!(*depth_ptr) || (*depth_ptr==0x7FF))
-           memset(color_ptr, 0, sizeof(uint8_t)*3);
-       }
-
-       // Compress disparity information
-       encodeMonoImageToPNG (disparityMap_arg, width_arg, height_arg, compressedDisparity, pngLevel_arg);
+         uint16_t* depth_ptr = &disparityMap_arg[0];
+         uint8_t* color_ptr = &colorImage_arg[0];
 
-       compressedDisparitySize = static_cast<uint32_t>(compressedDisparity.size());
-       // Encode size of compressed disparity image data
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparitySize), sizeof (compressedDisparitySize));
-       // Output compressed disparity to ostream
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparity[0]), compressedDisparity.size () * sizeof(uint8_t));
+         size_t i;
+         for (i=0; i<cloud_size; ++i, ++depth_ptr, color_ptr+=sizeof(uint8_t)*3)
+         {
+           if (!(*depth_ptr) || (*depth_ptr==0x7FF))
+             memset(color_ptr, 0, sizeof(uint8_t)*3);
+         }
+       }
 
-       // Compress color information
+       // Select color information to be encoded
+       std::vector<uint8_t> monoImage;
+       std::vector<uint8_t> noColorImage;
+       std::vector<uint8_t>* colorImage = &noColorImage;
+       unsigned int colorChannels = 3;
        if (colorImage_arg.size() && doColorEncoding)
        {
          if (convertToMono)
          {
            size_t i, size;
-           vector<uint8_t> monoImage;
            size = width_arg*height_arg;
 
            monoImage.reserve(size);
+           colorImage = &monoImage;
+           colorChannels = 1;
 
            // grayscale conversion
            for (i=0; i<size; ++i)
@@ -239,20 +203,30 @@ namespace pcl
                                                       0.1140 * static_cast<float>(colorImage_arg[i*3+2]));
              monoImage.push_back(grayvalue);
            }
-           encodeMonoImageToPNG (monoImage, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
-
          } else
          {
-           encodeRGBImageToPNG (colorImage_arg, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
+           colorImage = &colorImage_arg;
          }
-
        }
 
-       compressedColorSize = static_cast<uint32_t>(compressedColor.size ());
-       // Encode size of compressed Color image data
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedColorSize), sizeof (compressedColorSize));
-       // Output compressed disparity to ostream
-       compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedColor[0]), compressedColor.size () * sizeof(uint8_t));
+       // encode header identifier and frame type
+       const bool predictFrame = writeFrameType (width_arg, height_arg, *colorImage, colorChannels, compressedDataOut_arg);
+       // encode point cloud width
+       compressedDataOut_arg.write (reinterpret_cast<const char*> (&width_arg), sizeof (width_arg));
+       // encode frame type height
+       compressedDataOut_arg.write (reinterpret_cast<const char*> (&height_arg), sizeof (height_arg));
+       // encode frame max depth
+       compressedDataOut_arg.write (reinterpret_cast<const char*> (&maxDepth), sizeof (maxDepth));
+       // encode frame focal lenght
+       compressedDataOut_arg.write (reinterpret_cast<const char*> (&focalLength_arg), sizeof (focalLength_arg));
+       // encode frame disparity scale
+       compressedDataOut_arg.write (reinterpret_cast<const char*> (&disparityScale_arg), sizeof (disparityScale_arg));
+       // encode frame disparity shift
+       compressedDataOut_arg.write (reinterpret_cast<const char*> (&disparityShift_arg), sizeof (disparityShift_arg));
+
+       // Compress disparity and color information
+       encodeFrameImages (disparityMap_arg, *colorImage, colorChannels, width_arg, height_arg, predictFrame, pngLevel_arg,
+                          compressedDataOut_arg, compressedDisparitySize, compressedColorSize);
 
        if (bShowStatistics_arg)
        {
@@ -260,6 +234,8 @@ namespace pcl
          float bytesPerPoint = static_cast<float> (compressedDisparitySize+compressedColorSize) / static_cast<float> (pointCount);
 
          PCL_INFO("*** POINTCLOUD ENCODING ***\n");
+         if (iFrameRate_)
+           PCL_INFO("Encoding Frame: %s\n", predictFrame ? "Prediction frame" : "Intra frame");
          PCL_INFO("Number of encoded points: %ld\n", pointCount);
          PCL_INFO("Size of uncompressed disparity map+color image: %.2f kBytes\n", (static_cast<float> (pointCount) * (sizeof(uint8_t)*3+sizeof(uint16_t))) / 1024.0f);
          PCL_INFO("Size of compressed point cloud: %.2f kBytes\n", static_cast<float> (compressedDisparitySize+compressedColorSize) / 1024.0f);
@@ -298,10 +274,12 @@ namespace pcl
       size_t png_height = 0;
       unsigned int png_channels = 1;
 
-      // sync to frame header
+      // sync to frame header of independently or temporally coded frames
       unsigned int headerIdPos = 0;
+      unsigned int temporalHeaderIdPos = 0;
       bool valid_stream = true;
-      while (valid_stream && (headerIdPos < strlen (frameHeaderIdentifier_)))
+      while (valid_stream && (headerIdPos < strlen (frameHeaderIdentifier_))
+                          && (temporalHeaderIdPos < strlen (temporalFrameHeaderIdentifier_)))
       {
         char readChar;
         compressedDataIn_arg.read (static_cast<char*> (&readChar), sizeof (readChar));
@@ -309,14 +287,21 @@ namespace pcl
           valid_stream = false;
         if (readChar != frameHeaderIdentifier_[headerIdPos++])
           headerIdPos = (frameHeaderIdentifier_[0] == readChar) ? 1 : 0;
+        if (readChar != temporalFrameHeaderIdentifier_[temporalHeaderIdPos++])
+          temporalHeaderIdPos = (temporalFrameHeaderIdentifier_[0] == readChar) ? 1 : 0;
 
         valid_stream &= compressedDataIn_arg.good ();
       }
 
+      const bool temporalFrame = (temporalHeaderIdPos == strlen (temporalFrameHeaderIdentifier_));
+      uint8_t frameType = 0;
+
       if (valid_stream) {
 
         //////////////
         // reading frame header
+        if (temporalFrame)
+          compressedDataIn_arg.read (reinterpret_cast<char*> (&frameType), sizeof (frameType));
         compressedDataIn_arg.read (reinterpret_cast<char*> (&cloud_width), sizeof (cloud_width));
         compressedDataIn_arg.read (reinterpret_cast<char*> (&cloud_height), sizeof (cloud_height));
         compressedDataIn_arg.read (reinterpret_cast<char*> (&maxDepth), sizeof (maxDepth));
@@ -339,6 +324,30 @@ namespace pcl
 
         // decode PNG compressed rgb data
         decodePNGToImage (compressedColor, colorData, png_width, png_height, png_channels);
+
+        if (temporalFrame)
+        {
+          if (frameType)
+          {
+            // P-frame - add decoded residuals to keyframe
+            if ((keyWidth_ != cloud_width) || (keyHeight_ != cloud_height) ||
+                !applyResidual (keyDisparityData_, disparityData) || !applyResidual (keyColorData_, colorData))
+            {
+              PCL_WARN ("[pcl::io::OrganizedPointCloudCompression::decodePointCloud] Prediction frame does not match the last I-frame.\n");
+              return (false);
+            }
+            png_channels = keyColorChannels_;
+          }
+          else
+          {
+            // I-frame - store keyframe
+            keyDisparityData_ = disparityData;
+            keyColorData_ = colorData;
+            keyWidth_ = cloud_width;
+            keyHeight_ = cloud_height;
+            keyColorChannels_ = png_channels;
+          }
+        }
       }
 
       // reconstruct point cloud
@@ -358,6 +367,8 @@ namespace pcl
         float bytesPerPoint = static_cast<float> (compressedDisparitySize+compressedColorSize) / static_cast<float> (pointCount);
 
         PCL_INFO("*** POINTCLOUD DECODING ***\n");
+        if (temporalFrame)
+          PCL_INFO("Encoding Frame: %s\n", frameType ? "Prediction frame" : "Intra frame");
         PCL_INFO("Number of encoded points: %ld\n", pointCount);
         PCL_INFO("Size of uncompressed point cloud: %.2f kBytes\n", (static_cast<float> (pointCount) * CompressionPointTraits<PointT>::bytesPerPoint) / 1024.0f);
         PCL_INFO("Size of compressed point cloud: %.2f kBytes\n", static_cast<float> (compressedDisparitySize+compressedColorSize) / 1024.0f);
@@ -419,6 +430,212 @@ namespace pcl
       focalLength_arg = focalLength;
     }
 
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT> bool
+    OrganizedPointCloudCompression<PointT>::writeFrameType (uint32_t width_arg,
+                                                            uint32_t height_arg,
+                                                            const std::vector<uint8_t>& colorData_arg,
+                                                            unsigned int colorChannels_arg,
+                                                            std::ostream& compressedDataOut_arg)
+    {
+      if (!iFrameRate_)
+      {
+        // encode header identifier
+        compressedDataOut_arg.write (reinterpret_cast<const char*> (frameHeaderIdentifier_), strlen (frameHeaderIdentifier_));
+        return (false);
+      }
+
+      // P-frames require a keyframe of the same layout
+      const bool predictFrame = (iFrameCounter_ > 0) &&
+                                (keyWidth_ == width_arg) && (keyHeight_ == height_arg) &&
+                                (keyColorData_.size () == colorData_arg.size ()) && (keyColorChannels_ == colorChannels_arg);
+
+      // enable I-frame rate
+      iFrameCounter_ = ((predictFrame ? iFrameCounter_ : 0) + 1) % iFrameRate_;
+
+      const uint8_t frameType = predictFrame ? 1 : 0;
+
+      // encode temporal header identifier
+      compressedDataOut_arg.write (reinterpret_cast<const char*> (temporalFrameHeaderIdentifier_), strlen (temporalFrameHeaderIdentifier_));
+      // encode frame type (I/P-frame)
+      compressedDataOut_arg.write (reinterpret_cast<const char*> (&frameType), sizeof (frameType));
+
+      return (predictFrame);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT> void
+    OrganizedPointCloudCompression<PointT>::encodeFrameImages (std::vector<uint16_t>& disparityData_arg,
+                                                               std::vector<uint8_t>& colorData_arg,
+                                                               unsigned int colorChannels_arg,
+                                                               uint32_t width_arg,
+                                                               uint32_t height_arg,
+                                                               bool predictFrame_arg,
+                                                               int pngLevel_arg,
+                                                               std::ostream& compressedDataOut_arg,
+                                                               uint32_t& compressedDisparitySize_arg,
+                                                               uint32_t& compressedColorSize_arg)
+    {
+      // compressed disparity and rgb image data
+      std::vector<uint8_t> compressedDisparity;
+      std::vector<uint8_t> compressedColor;
+
+      // images to be compressed
+      std::vector<uint16_t> disparityResidual;
+      std::vector<uint8_t> colorResidual;
+      std::vector<uint16_t>* disparityImage = &disparityData_arg;
+      std::vector<uint8_t>* colorImage = &colorData_arg;
+
+      bool disparityChanged = true;
+      bool colorChanged = !colorData_arg.empty ();
+
+      if (predictFrame_arg)
+      {
+        // P-frame - residuals against keyframe, images without changes are not transmitted
+        disparityChanged = (computeResidual (disparityData_arg, keyDisparityData_, disparityResidual) > 0);
+        colorChanged = colorChanged && (computeResidual (colorData_arg, keyColorData_, colorResidual) > 0);
+        disparityImage = &disparityResidual;
+        colorImage = &colorResidual;
+      }
+
+      // Compress disparity information
+      if (disparityChanged)
+        encodeMonoImageToPNG (*disparityImage, width_arg, height_arg, compressedDisparity, pngLevel_arg);
+
+      // Compress color information
+      if (colorChanged)
+      {
+        if (colorChannels_arg == 1)
+          encodeMonoImageToPNG (*colorImage, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
+        else
+          encodeRGBImageToPNG (*colorImage, width_arg, height_arg, compressedColor, 1 /*Z_BEST_SPEED*/);
+      }
+
+      compressedDisparitySize_arg = static_cast<uint32_t>(compressedDisparity.size());
+      // Encode size of compressed disparity image data
+      compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparitySize_arg), sizeof (compressedDisparitySize_arg));
+      // Output compressed disparity to ostream
+      if (compressedDisparitySize_arg)
+        compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedDisparity[0]), compressedDisparity.size () * sizeof(uint8_t));
+
+      compressedColorSize_arg = static_cast<uint32_t>(compressedColor.size ());
+      // Encode size of compressed Color image data
+      compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedColorSize_arg), sizeof (compressedColorSize_arg));
+      // Output compressed color to ostream
+      if (compressedColorSize_arg)
+        compressedDataOut_arg.write (reinterpret_cast<const char*> (&compressedColor[0]), compressedColor.size () * sizeof(uint8_t));
+
+      if (iFrameRate_ && !predictFrame_arg)
+      {
+        // I-frame - store keyframe
+        keyDisparityData_ = disparityData_arg;
+        keyColorData_ = colorData_arg;
+        keyWidth_ = width_arg;
+        keyHeight_ = height_arg;
+        keyColorChannels_ = colorChannels_arg;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT> std::size_t
+    OrganizedPointCloudCompression<PointT>::computeResidual (const std::vector<uint16_t>& image_arg,
+                                                             const std::vector<uint16_t>& reference_arg,
+                                                             std::vector<uint16_t>& residual_arg)
+    {
+      const std::size_t size = image_arg.size ();
+      assert (reference_arg.size () == size);
+
+      residual_arg.resize (size);
+
+      std::size_t changed = 0;
+      std::size_t i = 0;
+#ifdef __SSE2__
+      const __m128i zero = _mm_setzero_si128 ();
+      std::size_t changedBits = 0;
+      for (; i + 8 <= size; i += 8)
+      {
+        const __m128i image = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&image_arg[i]));
+        const __m128i reference = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&reference_arg[i]));
+        const __m128i residual = _mm_sub_epi16 (image, reference);
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (&residual_arg[i]), residual);
+
+        // change mask, two bits per pixel
+        int mask = ~_mm_movemask_epi8 (_mm_cmpeq_epi16 (residual, zero)) & 0xFFFF;
+        for (; mask; mask &= mask - 1)
+          ++changedBits;
+      }
+      changed = changedBits / 2;
+#endif
+      for (; i < size; ++i)
+      {
+        residual_arg[i] = static_cast<uint16_t> (image_arg[i] - reference_arg[i]);
+        if (residual_arg[i])
+          ++changed;
+      }
+
+      return (changed);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT> std::size_t
+    OrganizedPointCloudCompression<PointT>::computeResidual (const std::vector<uint8_t>& image_arg,
+                                                             const std::vector<uint8_t>& reference_arg,
+                                                             std::vector<uint8_t>& residual_arg)
+    {
+      const std::size_t size = image_arg.size ();
+      assert (reference_arg.size () == size);
+
+      residual_arg.resize (size);
+
+      std::size_t changed = 0;
+      std::size_t i = 0;
+#ifdef __SSE2__
+      const __m128i zero = _mm_setzero_si128 ();
+      for (; i + 16 <= size; i += 16)
+      {
+        const __m128i image = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&image_arg[i]));
+        const __m128i reference = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&reference_arg[i]));
+        const __m128i residual = _mm_sub_epi8 (image, reference);
+        _mm_storeu_si128 (reinterpret_cast<__m128i*> (&residual_arg[i]), residual);
+
+        // change mask, one bit per channel
+        int mask = ~_mm_movemask_epi8 (_mm_cmpeq_epi8 (residual, zero)) & 0xFFFF;
+        for (; mask; mask &= mask - 1)
+          ++changed;
+      }
+#endif
+      for (; i < size; ++i)
+      {
+        residual_arg[i] = static_cast<uint8_t> (image_arg[i] - reference_arg[i]);
+        if (residual_arg[i])
+          ++changed;
+      }
+
+      return (changed);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    template<typename PointT> template <typename T> bool
+    OrganizedPointCloudCompression<PointT>::applyResidual (const std::vector<T>& reference_arg,
+                                                           std::vector<T>& image_arg)
+    {
+      // image without changes
+      if (image_arg.empty ())
+      {
+        image_arg = reference_arg;
+        return (true);
+      }
+
+      if (image_arg.size () != reference_arg.size ())
+        return (false);
+
+      for (std::size_t i = 0; i < image_arg.size (); ++i)
+        image_arg[i] = static_cast<T> (reference_arg[i] + image_arg[i]);
+
+      return (true);
+    }
+
   }
 }
 
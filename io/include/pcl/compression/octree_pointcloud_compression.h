@@ -49,6 +49,8 @@
 
 #include <iterator>
 #include <iostream>
+#include <sstream>
+#include <string>
 #include <vector>
 #include <string.h>
 #include <iostream>
@@ -117,7 +119,8 @@ namespace pcl
           iFrameCounter_ (0), frameID_ (0), pointCount_ (0), iFrame_ (true),
           doColorEncoding_ (doColorEncoding_arg), cloudWithColor_ (false), dataWithColor_ (false),
           pointColorOffset_ (0), bShowStatistics (showStatistics_arg), 
-          compressedPointDataLen_ (), compressedColorDataLen_ (), selectedProfile_(compressionProfile_arg),
+          compressedPointDataLen_ (), compressedColorDataLen_ (), chunkCount_ (0), chunkedFrame_ (false), chunkLeafs_ (), chunkLeafKeys_ (),
+          selectedProfile_(compressionProfile_arg),
           pointResolution_(pointResolution_arg), octreeResolution_(octreeResolution_arg), colorBitResolution_(colorBitResolution_arg)
         {
           initialization();
@@ -181,6 +184,33 @@ namespace pcl
           return (output_);
         }
 
+        /** \brief Split the leaf data of each frame into independently entropy coded chunks.
+          * \note Chunks cover consecutive leaf nodes in octree order and are encoded and decoded in parallel
+          * \note using the number of threads set with setNumberOfThreads (). The octree structure itself is
+          * \note still coded as a single stream. Changing the chunk count enforces I-frame encoding.
+          * \note Chunked frames start with their own header identifier, streams encoded with a chunk count of 0
+          * \note keep the single stream format.
+          * \param chunkCount_arg: number of chunks per frame, 0 selects the single stream layout
+          */
+        inline void
+        setChunkCount (unsigned int chunkCount_arg)
+        {
+          if (chunkCount_ != chunkCount_arg)
+          {
+            chunkCount_ = chunkCount_arg;
+            iFrame_ = true;
+          }
+        }
+
+        /** \brief Get the number of independently entropy coded chunks per frame.
+          * \return number of chunks, 0 if the single stream layout is used
+          */
+        inline unsigned int
+        getChunkCount () const
+        {
+          return (chunkCount_);
+        }
+
         /** \brief Encode point cloud to output stream
           * \param cloud_arg:  point cloud to be compressed
           * \param compressedTreeDataOut_arg:  binary output stream containing compressed data
@@ -227,6 +257,20 @@ namespace pcl
         void
         entropyDecoding (std::istream& compressedTreeDataIn_arg);
 
+        /** \brief Encode the leaf data collected during serialization into chunks, entropy code them in parallel
+          * and write the chunk index followed by the chunk data to the output stream
+          * \param compressedTreeDataOut_arg: binary output stream
+          */
+        void
+        encodeChunks (std::ostream& compressedTreeDataOut_arg);
+
+        /** \brief Read the chunk index and chunk data from the input stream and decode the points of
+          * all leaf nodes collected during deserialization in parallel
+          * \param compressedTreeDataIn_arg: binary input stream
+          */
+        void
+        decodeChunks (std::istream& compressedTreeDataIn_arg);
+
         /** \brief Encode leaf node information during serialization
           * \param leaf_arg: reference to new leaf node
           * \param key_arg: octree key of new leaf node
@@ -283,9 +327,24 @@ namespace pcl
         uint64_t compressedPointDataLen_;
         uint64_t compressedColorDataLen_;
 
+        /** \brief Number of independently entropy coded chunks, 0 for the single stream layout */
+        uint32_t chunkCount_;
+
+        /** \brief True if the frame being decoded uses the chunked layout */
+        bool chunkedFrame_;
+
+        /** \brief Leaf nodes in serialization order, collected for chunked encoding */
+        std::vector<LeafNode*> chunkLeafs_;
+
+        /** \brief Keys of the leaf nodes in (de)serialization order, collected for chunked coding */
+        std::vector<OctreeKey> chunkLeafKeys_;
+
         // frame header identifier
         static const char* frameHeaderIdentifier_;
 
+        // frame header identifier of chunked streams
+        static const char* frameHeaderIdentifierChunked_;
+
         const compression_Profiles_e selectedProfile_;
         const double pointResolution_;
         const double octreeResolution_;
@@ -296,6 +355,10 @@ namespace pcl
     // define frame identifier
     template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
       const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frameHeaderIdentifier_ = "<PCL-OCT-COMPRESSED>";
+
+    // define frame identifier of chunked streams
+    template<typename PointT, typename LeafT, typename BranchT, typename OctreeT>
+      const char* OctreePointCloudCompression<PointT, LeafT, BranchT, OctreeT>::frameHeaderIdentifierChunked_ = "<PCL-OCT-CHUNKED>";
   }
 
 }
@@ -64,7 +64,9 @@ namespace pcl
         typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
 
         /** \brief Empty Constructor. */
-        OrganizedPointCloudCompression ()
+        OrganizedPointCloudCompression () :
+          iFrameRate_ (0), iFrameCounter_ (0),
+          keyDisparityData_ (), keyColorData_ (), keyWidth_ (0), keyHeight_ (0), keyColorChannels_ (1)
         {
         }
 
@@ -73,6 +75,28 @@ namespace pcl
         {
         }
 
+        /** \brief Enable temporal coding and define the number of frames between two I-frames (GOP size).
+         * \note In temporal mode, the disparity and color images of P-frames are coded as residuals against
+         * \note the most recent I-frame and images without changes are not transmitted at all. The decoder
+         * \note detects temporal streams automatically, but can only start decoding at an I-frame.
+         * \param[in] iFrameRate_arg: I-frame rate, 0 codes every frame independently (default)
+         */
+        inline void
+        setIFrameRate (unsigned int iFrameRate_arg)
+        {
+          iFrameRate_ = iFrameRate_arg;
+          iFrameCounter_ = 0;
+        }
+
+        /** \brief Get the number of frames between two I-frames.
+         * \return I-frame rate, 0 if every frame is coded independently
+         */
+        inline unsigned int
+        getIFrameRate () const
+        {
+          return (iFrameRate_);
+        }
+
         /** \brief Encode point cloud to output stream
          * \param[in] cloud_arg:  point cloud to be compressed
          * \param[out] compressedDataOut_arg:  binary output stream containing compressed data
@@ -136,14 +160,109 @@ namespace pcl
                                     float& maxDepth_arg,
                                     float& focalLength_arg) const;
 
+        /** \brief Write the frame header identifier and, in temporal mode, select the frame type
+         * \param[in] width_arg: width of disparity map/color image
+         * \param[in] height_arg: height of disparity map/color image
+         * \param[in] colorData_arg: color image to be encoded (empty if color is not encoded)
+         * \param[in] colorChannels_arg: number of channels of the color image
+         * \param[out] compressedDataOut_arg: binary output stream
+         * \return true if the frame is coded as residual against the keyframe
+         */
+        bool writeFrameType (uint32_t width_arg,
+                             uint32_t height_arg,
+                             const std::vector<uint8_t>& colorData_arg,
+                             unsigned int colorChannels_arg,
+                             std::ostream& compressedDataOut_arg);
+
+        /** \brief PNG encode disparity map and color image, or their residuals against the keyframe, and
+         * write them to the output stream. I-frames in temporal mode become the new keyframe.
+         * \param[in] disparityData_arg: 16-bit disparity map
+         * \param[in] colorData_arg: 8-bit color image (empty if color is not encoded)
+         * \param[in] colorChannels_arg: number of channels of the color image
+         * \param[in] width_arg: width of disparity map/color image
+         * \param[in] height_arg: height of disparity map/color image
+         * \param[in] predictFrame_arg: encode residuals against the keyframe
+         * \param[in] pngLevel_arg: png compression level of the disparity map
+         * \param[out] compressedDataOut_arg: binary output stream
+         * \param[out] compressedDisparitySize_arg: size of the compressed disparity data
+         * \param[out] compressedColorSize_arg: size of the compressed color data
+         */
+        void encodeFrameImages (std::vector<uint16_t>& disparityData_arg,
+                                std::vector<uint8_t>& colorData_arg,
+                                unsigned int colorChannels_arg,
+                                uint32_t width_arg,
+                                uint32_t height_arg,
+                                bool predictFrame_arg,
+                                int pngLevel_arg,
+                                std::ostream& compressedDataOut_arg,
+                                uint32_t& compressedDisparitySize_arg,
+                                uint32_t& compressedColorSize_arg);
+
+        /** \brief Compute the residual of an image against a reference image of the same size (modulo 2^16)
+         * \param[in] image_arg: input image
+         * \param[in] reference_arg: reference image
+         * \param[out] residual_arg: image - reference
+         * \return number of changed pixels
+         */
+        static std::size_t
+        computeResidual (const std::vector<uint16_t>& image_arg,
+                         const std::vector<uint16_t>& reference_arg,
+                         std::vector<uint16_t>& residual_arg);
+
+        /** \brief Compute the residual of an image against a reference image of the same size (modulo 2^8)
+         * \param[in] image_arg: input image
+         * \param[in] reference_arg: reference image
+         * \param[out] residual_arg: image - reference
+         * \return number of changed pixel channels
+         */
+        static std::size_t
+        computeResidual (const std::vector<uint8_t>& image_arg,
+                         const std::vector<uint8_t>& reference_arg,
+                         std::vector<uint8_t>& residual_arg);
+
+        /** \brief Add a decoded residual to a reference image. An empty residual leaves the reference unchanged.
+         * \param[in] reference_arg: reference image
+         * \param[in,out] image_arg: decoded residual, replaced by the reconstructed image
+         * \return false if the residual does not match the reference size
+         */
+        template <typename T> static bool
+        applyResidual (const std::vector<T>& reference_arg,
+                       std::vector<T>& image_arg);
+
+        /** \brief Number of frames between two I-frames, 0 disables temporal coding */
+        uint32_t iFrameRate_;
+
+        /** \brief Frames encoded since the last I-frame */
+        uint32_t iFrameCounter_;
+
+        /** \brief Disparity map of the keyframe */
+        std::vector<uint16_t> keyDisparityData_;
+
+        /** \brief Color image of the keyframe */
+        std::vector<uint8_t> keyColorData_;
+
+        /** \brief Size of the keyframe */
+        uint32_t keyWidth_;
+        uint32_t keyHeight_;
+
+        /** \brief Number of channels of the keyframe color image */
+        unsigned int keyColorChannels_;
+
       private:
         // frame header identifier
         static const char* frameHeaderIdentifier_;
+
+        // frame header identifier of temporally coded frames
+        static const char* temporalFrameHeaderIdentifier_;
     };
 
     // define frame identifier
     template<typename PointT>
     const char* OrganizedPointCloudCompression<PointT>::frameHeaderIdentifier_ = "<PCL-ORG-COMPRESSED>";
+
+    // define temporal frame identifier
+    template<typename PointT>
+    const char* OrganizedPointCloudCompression<PointT>::temporalFrameHeaderIdentifier_ = "<PCL-ORG-TEMPORAL>";
   }
 }
 
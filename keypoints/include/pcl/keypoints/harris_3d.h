@@ -84,6 +84,7 @@ namespace pcl
       , nonmax_ (true)
       , method_ (method)
       , threads_ (0)
+      , use_neighborhood_cache_ (false)
       {
         name_ = "HarrisKeypoint3D";
         search_radius_ = radius;
@@ -143,6 +144,13 @@ namespace pcl
         */
       inline void
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Search the neighborhood of each point only once and reuse it for the response and the non maxima
+        * suppression. This trades memory (all the neighborhoods are kept at the same time) for speed.
+        * \param[in] use_cache true to enable the neighborhood cache (default false)
+        */
+      inline void
+      setUseNeighborhoodCache (bool use_cache) { use_neighborhood_cache_ = use_cache; }
     protected:
       bool
       initCompute ();
@@ -163,6 +171,7 @@ namespace pcl
       ResponseMethod method_;
       PointCloudNConstPtr normals_;
       unsigned int threads_;
+      bool use_neighborhood_cache_;
   };
 }
 
@@ -75,6 +75,7 @@ namespace pcl
     , refine_ (true)
     , nonmax_ (true)
     , threads_ (0)
+    , use_neighborhood_cache_ (false)
     , normals_ (new pcl::PointCloud<NormalT>)
     , intensity_gradients_ (new pcl::PointCloud<pcl::IntensityGradient>)
     {
@@ -117,6 +118,13 @@ namespace pcl
       */
     inline void
     setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+    /** \brief Search the neighborhood of each point only once and reuse it for the response and the non maxima
+      * suppression. This trades memory (all the neighborhoods are kept at the same time) for speed.
+      * \param[in] use_cache true to enable the neighborhood cache (default false)
+      */
+    inline void
+    setUseNeighborhoodCache (bool use_cache) { use_neighborhood_cache_ = use_cache; }
   protected:
     void detectKeypoints (PointCloudOut &output);
     void responseTomasi (PointCloudOut &output) const;
@@ -127,6 +135,7 @@ namespace pcl
     bool refine_;
     bool nonmax_;
     unsigned int threads_;    
+    bool use_neighborhood_cache_;
     boost::shared_ptr<pcl::PointCloud<NormalT> > normals_;
     boost::shared_ptr<pcl::PointCloud<pcl::IntensityGradient> > intensity_gradients_;
   } ;
@@ -234,6 +234,9 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
   response->points.reserve (input_->points.size());
 
+  if (use_neighborhood_cache_ && (method_ != CURVATURE || nonmax_))
+    this->computeNeighborhoodCache (search_radius_, threads_);
+
   switch (method_)
   {
     case HARRIS:
@@ -264,8 +267,9 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.points.clear ();
     output.points.reserve (response->points.size());
 
+    std::vector<char> is_maxima (response->points.size (), 0);
 #ifdef _OPENMP
-#pragma omp parallel for shared (output) num_threads(threads_)   
+#pragma omp parallel for shared (is_maxima) num_threads(threads_)   
 #endif
     for (int idx = 0; idx < static_cast<int> (response->points.size ()); ++idx)
     {
@@ -276,23 +280,23 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
-      bool is_maxima = true;
+      this->searchForNeighborsCached (idx, search_radius_, nn_indices, nn_dists);
+      is_maxima[idx] = 1;
       for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
       {
         if (response->points[idx].intensity < response->points[*iIt].intensity)
         {
-          is_maxima = false;
+          is_maxima[idx] = 0;
           break;
         }
       }
-      if (is_maxima)
-#ifdef _OPENMP
-#pragma omp critical
-#endif
-        output.points.push_back (response->points[idx]);
     }
 
+    // Collect the maxima in the order of the input cloud
+    for (size_t idx = 0; idx < is_maxima.size (); ++idx)
+      if (is_maxima[idx])
+        output.points.push_back (response->points[idx]);
+
     if (refine_)
       refineCorners (output);
 
@@ -300,6 +304,8 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.width = static_cast<uint32_t> (output.points.size());
     output.is_dense = true;
   }
+
+  this->clearNeighborhoodCache ();
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -319,7 +325,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseHarris (PointCloudO
     {
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+      this->searchForNeighborsCached (pIdx, search_radius_, nn_indices, nn_dists);
       calculateNormalCovar (nn_indices, covar);
 
       float trace = covar [0] + covar [5] + covar [7];
@@ -358,7 +364,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseNoble (PointCloudOu
     {
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+      this->searchForNeighborsCached (pIdx, search_radius_, nn_indices, nn_dists);
       calculateNormalCovar (nn_indices, covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
@@ -396,7 +402,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseLowe (PointCloudOut
     {
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+      this->searchForNeighborsCached (pIdx, search_radius_, nn_indices, nn_dists);
       calculateNormalCovar (nn_indices, covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
@@ -453,7 +459,7 @@ pcl::HarrisKeypoint3D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
     {
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+      this->searchForNeighborsCached (pIdx, search_radius_, nn_indices, nn_dists);
       calculateNormalCovar (nn_indices, covar);
       float trace = covar [0] + covar [5] + covar [7];
       if (trace != 0)
@@ -211,6 +211,10 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
 
   boost::shared_ptr<pcl::PointCloud<PointOutT> > response (new pcl::PointCloud<PointOutT> ());
   response->points.reserve (input_->points.size());
+
+  if (use_neighborhood_cache_)
+    this->computeNeighborhoodCache (search_radius_, threads_);
+
   responseTomasi(*response);
 
   // just return the response
@@ -225,33 +229,34 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.points.clear ();
     output.points.reserve (response->points.size());
 
+    std::vector<char> is_maxima (response->points.size (), 0);
 #ifdef _OPENMP
   #pragma omp parallel for num_threads(threads_) default(shared)
 #endif  
-    for (size_t idx = 0; idx < response->points.size (); ++idx)
+    for (int idx = 0; idx < static_cast<int> (response->points.size ()); ++idx)
     {
       if (!isFinite (response->points[idx]) || response->points[idx].intensity < threshold_)
         continue;
 
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
-      bool is_maxima = true;
+      this->searchForNeighborsCached (idx, search_radius_, nn_indices, nn_dists);
+      is_maxima[idx] = 1;
       for (std::vector<int>::const_iterator iIt = nn_indices.begin(); iIt != nn_indices.end(); ++iIt)
       {
         if (response->points[idx].intensity < response->points[*iIt].intensity)
         {
-          is_maxima = false;
+          is_maxima[idx] = 0;
           break;
         }
       }
-      if (is_maxima)
-#ifdef _OPENMP
-        #pragma omp critical
-#endif
-        output.points.push_back (response->points[idx]);
     }
 
+    // Collect the maxima in the order of the input cloud
+    for (size_t idx = 0; idx < is_maxima.size (); ++idx)
+      if (is_maxima[idx])
+        output.points.push_back (response->points[idx]);
+
     if (refine_)
       refineCorners (output);
 
@@ -260,7 +265,7 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloud
     output.is_dense = true;
   }
 
-  
+  this->clearNeighborhoodCache ();
 }
 
 template <typename PointInT, typename PointOutT, typename NormalT> void
@@ -271,11 +276,12 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
   PCL_ALIGN (16) float covar [21];
   Eigen::SelfAdjointEigenSolver <Eigen::Matrix<float, 6, 6> > solver;
   Eigen::Matrix<float, 6, 6> covariance;
+  output.resize (input_->size ());
 
 #ifdef _OPENMP
   #pragma omp parallel for default (shared) private (pointOut, covar, covariance, solver) num_threads(threads_)
 #endif  
-  for (unsigned pIdx = 0; pIdx < input_->size (); ++pIdx)
+  for (int pIdx = 0; pIdx < static_cast<int> (input_->size ()); ++pIdx)
   {
     const PointInT& pointIn = input_->points [pIdx];
     pointOut.intensity = 0.0; //std::numeric_limits<float>::quiet_NaN ();
@@ -283,7 +289,7 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
     {
       std::vector<int> nn_indices;
       std::vector<float> nn_dists;
-      tree_->radiusSearch (pointIn, search_radius_, nn_indices, nn_dists);
+      this->searchForNeighborsCached (pIdx, search_radius_, nn_indices, nn_dists);
       calculateCombinedCovar (nn_indices, covar);
 
       float trace = covar [0] + covar [6] + covar [11] + covar [15] + covar [18] + covar [20];
@@ -344,11 +350,7 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::responseTomasi (PointCloudO
     pointOut.x = pointIn.x;
     pointOut.y = pointIn.y;
     pointOut.z = pointIn.z;
-#ifdef _OPENMP
-    #pragma omp critical
-#endif
-
-    output.points.push_back(pointOut);
+    output.points[pIdx] = pointOut;
   }
   output.height = input_->height;
   output.width = input_->width;
@@ -367,8 +369,12 @@ pcl::HarrisKeypoint6D<PointInT, PointOutT, NormalT>::refineCorners (PointCloudOu
   const Eigen::Vector3f* point;
   float diff;
   const unsigned max_iterations = 10;
-  for (typename PointCloudOut::iterator cornerIt = corners.begin(); cornerIt != corners.end(); ++cornerIt)
+#ifdef _OPENMP
+  #pragma omp parallel for shared (corners, search) private (nnT, NNT, NNTp, normal, point, diff) num_threads(threads_)
+#endif
+  for (int cIdx = 0; cIdx < static_cast<int> (corners.size ()); ++cIdx)
   {
+    PointOutT* cornerIt = &corners.points[cIdx];
     unsigned iterations = 0;
     do {
       NNT.setZero();
@@ -124,7 +124,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getBoundaryPoints (PointCloudI
     std::vector<float> nn_distances;
     int n_neighbors;
 
-    this->searchForNeighbors (static_cast<int> (index), border_radius, nn_indices, nn_distances);
+    this->searchForNeighborsCached (static_cast<int> (index), border_radius, nn_indices, nn_distances);
 
     n_neighbors = static_cast<int> (nn_indices.size ());
 
@@ -159,7 +159,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::getScatterMatrix (const int& c
   std::vector<float> nn_distances;
   int n_neighbors;
 
-  this->searchForNeighbors (current_index, salient_radius_, nn_indices, nn_distances);
+  this->searchForNeighborsCached (current_index, salient_radius_, nn_indices, nn_distances);
 
   n_neighbors = static_cast<int> (nn_indices.size ());
 
@@ -291,6 +291,9 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   // Make sure the output cloud is empty
   output.points.clear ();
 
+  if (use_neighborhood_cache_)
+    this->computeNeighborhoodCache (std::max (salient_radius_, std::max (non_max_radius_, border_radius_)), threads_);
+
   if (border_radius_ > 0.0)
     edge_points_ = getBoundaryPoints (*(input_->makeShared ()), border_radius_, angle_threshold_);
 
@@ -309,7 +312,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
       std::vector<int> nn_indices;
       std::vector<float> nn_distances;
 
-      this->searchForNeighbors (static_cast<int> (index), border_radius_, nn_indices, nn_distances);
+      this->searchForNeighborsCached (static_cast<int> (index), border_radius_, nn_indices, nn_distances);
 
       for (size_t j = 0 ; j < nn_indices.size (); j++)
       {
@@ -322,14 +325,11 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
     }
   }
 
-  Eigen::Vector3d *omp_mem = new Eigen::Vector3d[threads_];
-
-  for (int i = 0; i < threads_; i++)
-    omp_mem[i].setZero (3);
-
+  // The eigenvalue ratios and the third eigenvalue of every point; the points without a valid scatter matrix keep zeros
   double *prg_local_mem = new double[input_->size () * 3];
   double **prg_mem = new double * [input_->size ()];
 
+  memset (prg_local_mem, 0, sizeof (double) * input_->size () * 3);
   for (int i = 0; i < input_->size (); i++)
     prg_mem[i] = prg_local_mem + 3 * i;
 
@@ -338,12 +338,6 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
 #endif
   for (index = 0; index < int (input_->size ()); index++)
   {
-#ifdef _OPENMP
-    int tid = omp_get_thread_num ();
-#else
-    int tid = 0;
-#endif
-
     if (!borders[index])
     {
       //if the considered point is not a border point then compute the scatter matrix
@@ -360,14 +354,9 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
       if (!pcl_isfinite (e1c) || !pcl_isfinite (e2c) || !pcl_isfinite (e3c))
         continue;
 
-      omp_mem[tid][0] = e2c / e1c;
-      omp_mem[tid][1] = e3c / e2c;;
-      omp_mem[tid][2] = e3c;
-
-      for (int d = 0; d < omp_mem[tid].size (); ++d)
-      {
-        prg_mem[index][d] = omp_mem[tid][d];
-      }
+      prg_mem[index][0] = e2c / e1c;
+      prg_mem[index][1] = e3c / e2c;
+      prg_mem[index][2] = e3c;
     }
   }
 
@@ -381,6 +370,10 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
         {
           PCL_ERROR ("[pcl::%s::detectKeypoints] : compute failed! The third eigenvalue (%f) must be strict positive.\n",
                 name_.c_str (), prg_mem[index][2]);
+          this->clearNeighborhoodCache ();
+          delete[] borders;
+          delete[] prg_mem;
+          delete[] prg_local_mem;
           return;
         }
 
@@ -405,7 +398,7 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
       std::vector<float> nn_distances;
       int n_neighbors;
 
-      this->searchForNeighbors (static_cast<int> (index), non_max_radius_, nn_indices, nn_distances);
+      this->searchForNeighborsCached (static_cast<int> (index), non_max_radius_, nn_indices, nn_distances);
 
       n_neighbors = static_cast<int> (nn_indices.size ());
 
@@ -422,15 +415,10 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
     }
   }
 
-#ifdef _OPENMP
-#pragma omp parallel for shared (output) num_threads(threads_)
-#endif
+  // Collect the keypoints in the order of the input cloud
   for (index = 0; index < int (input_->size ()); index++)
   {
     if (feat_max[index])
-#ifdef _OPENMP
-#pragma omp critical
-#endif
       output.points.push_back(input_->points[index]);
   }
 
@@ -442,6 +430,8 @@ pcl::ISSKeypoint3D<PointInT, PointOutT, NormalT>::detectKeypoints (PointCloudOut
   if (border_radius_ > 0.0)
     normals_.reset (new pcl::PointCloud<NormalT>);
 
+  this->clearNeighborhoodCache ();
+
   delete[] borders;
   delete[] prg_mem;
   delete[] prg_local_mem;
@@ -38,6 +38,10 @@
 #ifndef PCL_KEYPOINT_IMPL_H_
 #define PCL_KEYPOINT_IMPL_H_
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> bool
 pcl::Keypoint<PointInT, PointOutT>::initCompute ()
@@ -136,5 +140,107 @@ pcl::Keypoint<PointInT, PointOutT>::compute (PointCloudOut &output)
     surface_.reset ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> int
+pcl::Keypoint<PointInT, PointOutT>::searchForNeighborsCached (int index, double radius,
+                                                              std::vector<int> &indices, std::vector<float> &distances) const
+{
+  if (neighborhood_offsets_.empty () || radius > neighborhood_radius_)
+    return (searchForNeighbors (index, radius, indices, distances));
+
+  const int begin = neighborhood_offsets_[index];
+  const int end = neighborhood_offsets_[index + 1];
+  indices.clear ();
+  distances.clear ();
+  indices.reserve (end - begin);
+  distances.reserve (end - begin);
+
+  // The cached neighbors keep the order of the search, filtering them preserves it
+  const float sqr_radius = static_cast<float> (radius * radius);
+  for (int i = begin; i < end; ++i)
+  {
+    if (neighborhood_sqr_distances_[i] <= sqr_radius)
+    {
+      indices.push_back (neighborhood_indices_[i]);
+      distances.push_back (neighborhood_sqr_distances_[i]);
+    }
+  }
+  return (static_cast<int> (indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::Keypoint<PointInT, PointOutT>::computeNeighborhoodCache (double radius, unsigned int nr_threads)
+{
+  const int nr_points = static_cast<int> (input_->points.size ());
+  neighborhood_offsets_.assign (nr_points + 1, 0);
+
+  // Every thread gets a contiguous block of points (static schedule, in thread order) and appends their
+  // neighborhoods to its own buffers, which are then concatenated
+  std::vector<std::vector<int> > thread_indices;
+  std::vector<std::vector<float> > thread_distances;
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    nr_threads = omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
+#endif
+  {
+#ifdef _OPENMP
+    const int tid = omp_get_thread_num ();
+#pragma omp single
+#else
+    const int tid = 0;
+#endif
+    {
+#ifdef _OPENMP
+      thread_indices.resize (omp_get_num_threads ());
+      thread_distances.resize (omp_get_num_threads ());
+#else
+      thread_indices.resize (1);
+      thread_distances.resize (1);
+#endif
+    }
+
+    std::vector<int> nn_indices;
+    std::vector<float> nn_distances;
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+    for (int idx = 0; idx < nr_points; ++idx)
+    {
+      if (!isFinite (input_->points[idx]))
+        continue;
+      searchForNeighbors (idx, radius, nn_indices, nn_distances);
+      neighborhood_offsets_[idx + 1] = static_cast<int> (nn_indices.size ());
+      thread_indices[tid].insert (thread_indices[tid].end (), nn_indices.begin (), nn_indices.end ());
+      thread_distances[tid].insert (thread_distances[tid].end (), nn_distances.begin (), nn_distances.end ());
+    }
+  }
+
+  for (int idx = 0; idx < nr_points; ++idx)
+    neighborhood_offsets_[idx + 1] += neighborhood_offsets_[idx];
+
+  neighborhood_indices_.clear ();
+  neighborhood_sqr_distances_.clear ();
+  neighborhood_indices_.reserve (neighborhood_offsets_[nr_points]);
+  neighborhood_sqr_distances_.reserve (neighborhood_offsets_[nr_points]);
+  for (size_t t = 0; t < thread_indices.size (); ++t)
+  {
+    neighborhood_indices_.insert (neighborhood_indices_.end (), thread_indices[t].begin (), thread_indices[t].end ());
+    neighborhood_sqr_distances_.insert (neighborhood_sqr_distances_.end (), thread_distances[t].begin (), thread_distances[t].end ());
+  }
+  neighborhood_radius_ = radius;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::Keypoint<PointInT, PointOutT>::clearNeighborhoodCache ()
+{
+  neighborhood_radius_ = 0;
+  std::vector<int> ().swap (neighborhood_offsets_);
+  std::vector<int> ().swap (neighborhood_indices_);
+  std::vector<float> ().swap (neighborhood_sqr_distances_);
+}
+
 #endif  //#ifndef PCL_KEYPOINT_IMPL_H_
 
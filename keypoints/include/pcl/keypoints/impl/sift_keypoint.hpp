@@ -41,6 +41,9 @@
 #include <pcl/keypoints/sift_keypoint.h>
 #include <pcl/common/io.h>
 #include <pcl/filters/voxel_grid.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void 
@@ -213,42 +216,69 @@ void pcl::SIFTKeypoint<PointInT, PointOutT>::computeScaleSpace (
   // For efficiency, we will only filter over points within 3 standard deviations 
   const float max_radius = 3.0f * scales.back ();
 
-  for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+  // The field values and the squared scales are shared by all points
+  const int nr_scales = static_cast<int> (scales.size ());
+  std::vector<float> values (input.size ());
+  for (size_t i_point = 0; i_point < input.size (); ++i_point)
+    values[i_point] = getFieldValue_ (input.points[i_point]);
+
+  std::vector<float> sigma_sqr (nr_scales), max_dist_sqr (nr_scales);
+  for (int i_scale = 0; i_scale < nr_scales; ++i_scale)
+  {
+    sigma_sqr[i_scale] = powf (scales[i_scale], 2.0f);
+    max_dist_sqr[i_scale] = 9*sigma_sqr[i_scale];
+  }
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
+#endif
   {
     std::vector<int> nn_indices;
     std::vector<float> nn_dist;
-    tree.radiusSearch (i_point, max_radius, nn_indices, nn_dist); // *
-    // * note: at this stage of the algorithm, we must find all points within a radius defined by the maximum scale, 
-    //   regardless of the configurable search method specified by the user, so we directly employ tree.radiusSearch 
-    //   here instead of using searchForNeighbors.
-
-    // For each scale, compute the Gaussian "filter response" at the current point
-    float filter_response = 0.0f;
-    float previous_filter_response;
-    for (size_t i_scale = 0; i_scale < scales.size (); ++i_scale)
-    {
-      float sigma_sqr = powf (scales[i_scale], 2.0f);
+    std::vector<float> numerator (nr_scales), denominator (nr_scales);
 
-      float numerator = 0.0f;
-      float denominator = 0.0f;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+    {
+      tree.radiusSearch (i_point, max_radius, nn_indices, nn_dist); // *
+      // * note: at this stage of the algorithm, we must find all points within a radius defined by the maximum scale, 
+      //   regardless of the configurable search method specified by the user, so we directly employ tree.radiusSearch 
+      //   here instead of using searchForNeighbors.
+
+      // Compute the Gaussian "filter responses" of all scales in a single pass over the neighborhood. The neighbors are
+      // sorted by distance and the scales increase, so each neighbor contributes to all scales from the first one
+      // for which it is within 3 standard deviations onwards.
+      std::fill (numerator.begin (), numerator.end (), 0.0f);
+      std::fill (denominator.begin (), denominator.end (), 0.0f);
+      int first_scale = 0;
       for (size_t i_neighbor = 0; i_neighbor < nn_indices.size (); ++i_neighbor)
       {
-        const float &value = getFieldValue_ (input.points[nn_indices[i_neighbor]]);
         const float &dist_sqr = nn_dist[i_neighbor];
-        if (dist_sqr <= 9*sigma_sqr)
+        while (first_scale < nr_scales && dist_sqr > max_dist_sqr[first_scale])
+          ++first_scale;
+        if (first_scale == nr_scales)
+          break; // i.e. if dist > 3 standard deviations of the largest scale, then terminate early
+
+        const float &value = values[nn_indices[i_neighbor]];
+        for (int i_scale = first_scale; i_scale < nr_scales; ++i_scale)
         {
-          float w = expf (-0.5f * dist_sqr / sigma_sqr);
-          numerator += value * w;
-          denominator += w;
+          float w = expf (-0.5f * dist_sqr / sigma_sqr[i_scale]);
+          numerator[i_scale] += value * w;
+          denominator[i_scale] += w;
         }
-        else break; // i.e. if dist > 3 standard deviations, then terminate early
       }
-      previous_filter_response = filter_response;
-      filter_response = numerator / denominator;
 
       // Compute the difference between adjacent scales
-      if (i_scale > 0)
+      float filter_response = numerator[0] / denominator[0];
+      for (int i_scale = 1; i_scale < nr_scales; ++i_scale)
+      {
+        float previous_filter_response = filter_response;
+        filter_response = numerator[i_scale] / denominator[i_scale];
         diff_of_gauss (i_point, i_scale - 1) = filter_response - previous_filter_response;
+      }
     }
   }
 }
@@ -260,59 +290,82 @@ pcl::SIFTKeypoint<PointInT, PointOutT>::findScaleSpaceExtrema (
     std::vector<int> &extrema_indices, std::vector<int> &extrema_scales)
 {
   const int k = 25;
-  std::vector<int> nn_indices (k);
-  std::vector<float> nn_dist (k);
-
+  const int nr_points = static_cast<int> (input.size ());
   const int nr_scales = static_cast<int> (diff_of_gauss.cols ());
-  std::vector<float> min_val (nr_scales), max_val (nr_scales);
 
-  for (int i_point = 0; i_point < static_cast<int> (input.size ()); ++i_point)
+  // The points are tested in parallel; the extrema are flagged per point and scale and collected in order afterwards
+  std::vector<char> is_extremum (static_cast<size_t> (nr_points) * nr_scales, 0);
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
+#endif
   {
-    // Define the local neighborhood around the current point
-    const size_t nr_nn = tree.nearestKSearch (i_point, k, nn_indices, nn_dist); //*
-    // * note: the neighborhood for finding local extrema is best defined as a small fixed-k neighborhood, regardless of
-    //   the configurable search method specified by the user, so we directly employ tree.nearestKSearch here instead 
-    //   of using searchForNeighbors
-
-    // At each scale, find the extreme values of the DoG within the current neighborhood
-    for (int i_scale = 0; i_scale < nr_scales; ++i_scale)
+    std::vector<int> nn_indices (k);
+    std::vector<float> nn_dist (k);
+    std::vector<float> min_val (nr_scales), max_val (nr_scales);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 64)
+#endif
+    for (int i_point = 0; i_point < nr_points; ++i_point)
     {
-      min_val[i_scale] = std::numeric_limits<float>::max ();
-      max_val[i_scale] = -std::numeric_limits<float>::max ();
+      // Define the local neighborhood around the current point
+      const size_t nr_nn = tree.nearestKSearch (i_point, k, nn_indices, nn_dist); //*
+      // * note: the neighborhood for finding local extrema is best defined as a small fixed-k neighborhood, regardless of
+      //   the configurable search method specified by the user, so we directly employ tree.nearestKSearch here instead 
+      //   of using searchForNeighbors
+
+      // At each scale, find the extreme values of the DoG within the current neighborhood
+      for (int i_scale = 0; i_scale < nr_scales; ++i_scale)
+      {
+        min_val[i_scale] = std::numeric_limits<float>::max ();
+        max_val[i_scale] = -std::numeric_limits<float>::max ();
+
+        for (size_t i_neighbor = 0; i_neighbor < nr_nn; ++i_neighbor)
+        {
+          const float &d = diff_of_gauss (nn_indices[i_neighbor], i_scale);
+
+          min_val[i_scale] = (std::min) (min_val[i_scale], d);
+          max_val[i_scale] = (std::max) (max_val[i_scale], d);
+        }
+      }
 
-      for (size_t i_neighbor = 0; i_neighbor < nr_nn; ++i_neighbor)
+      // If the current point is an extreme value with high enough contrast, flag it as a keypoint 
+      for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
       {
-        const float &d = diff_of_gauss (nn_indices[i_neighbor], i_scale);
+        const float &val = diff_of_gauss (i_point, i_scale);
 
-        min_val[i_scale] = (std::min) (min_val[i_scale], d);
-        max_val[i_scale] = (std::max) (max_val[i_scale], d);
+        // Does the point have sufficient contrast?
+        if (fabs (val) >= min_contrast_)
+        {
+          // Is it a local minimum?
+          if ((val == min_val[i_scale]) && 
+              (val <  min_val[i_scale - 1]) && 
+              (val <  min_val[i_scale + 1]))
+          {
+            is_extremum[static_cast<size_t> (i_point) * nr_scales + i_scale] = 1;
+          }
+          // Is it a local maximum?
+          else if ((val == max_val[i_scale]) && 
+                   (val >  max_val[i_scale - 1]) && 
+                   (val >  max_val[i_scale + 1]))
+          {
+            is_extremum[static_cast<size_t> (i_point) * nr_scales + i_scale] = 1;
+          }
+        }
       }
     }
+  }
 
-    // If the current point is an extreme value with high enough contrast, add it as a keypoint 
+  for (int i_point = 0; i_point < nr_points; ++i_point)
+  {
     for (int i_scale = 1; i_scale < nr_scales - 1; ++i_scale)
     {
-      const float &val = diff_of_gauss (i_point, i_scale);
-
-      // Does the point have sufficient contrast?
-      if (fabs (val) >= min_contrast_)
+      if (is_extremum[static_cast<size_t> (i_point) * nr_scales + i_scale])
       {
-        // Is it a local minimum?
-        if ((val == min_val[i_scale]) && 
-            (val <  min_val[i_scale - 1]) && 
-            (val <  min_val[i_scale + 1]))
-        {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
-        }
-        // Is it a local maximum?
-        else if ((val == max_val[i_scale]) && 
-                 (val >  max_val[i_scale - 1]) && 
-                 (val >  max_val[i_scale + 1]))
-        {
-          extrema_indices.push_back (i_point);
-          extrema_scales.push_back (i_scale);
-        }
+        extrema_indices.push_back (i_point);
+        extrema_scales.push_back (i_scale);
       }
     }
   }
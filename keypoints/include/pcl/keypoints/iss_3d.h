@@ -118,6 +118,7 @@ namespace pcl
       , normals_ (new pcl::PointCloud<NormalT>)
       , angle_threshold_ (static_cast<float> (M_PI) / 2.0f)
       , threads_ (0)
+      , use_neighborhood_cache_ (false)
       {
         name_ = "ISSKeypoint3D";
         search_radius_ = salient_radius_;
@@ -189,6 +190,14 @@ namespace pcl
       inline void
       setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
 
+      /** \brief Search the neighborhood of each point only once, for the largest of the salient, non maxima and
+        * border radii, and get the neighborhoods of the smaller radii from it. This trades memory (all the
+        * neighborhoods are kept at the same time) for speed.
+        * \param[in] use_cache true to enable the neighborhood cache (default false)
+        */
+      inline void
+      setUseNeighborhoodCache (bool use_cache) { use_neighborhood_cache_ = use_cache; }
+
     protected:
 
       /** \brief Compute the boundary points for the given input cloud.
@@ -256,6 +265,9 @@ namespace pcl
       /** \brief The number of threads that has to be used by the scheduler. */
       unsigned int threads_;
 
+      /** \brief Whether the neighborhoods are searched once and cached for all the radii. */
+      bool use_neighborhood_cache_;
+
   };
 
 }
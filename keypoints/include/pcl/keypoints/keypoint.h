@@ -79,7 +79,11 @@ namespace pcl
         tree_ (), 
         search_parameter_ (0), 
         search_radius_ (0), 
-        k_ (0) 
+        k_ (0),
+        neighborhood_radius_ (0),
+        neighborhood_offsets_ (),
+        neighborhood_indices_ (),
+        neighborhood_sqr_distances_ ()
       {};
 
       /** \brief Provide a pointer to the input dataset that we need to estimate features at every point for.
@@ -151,6 +155,17 @@ namespace pcl
           return (search_method_surface_ (*input_, index, parameter, indices, distances));
       }
 
+      /** \brief Search for the neighbors of an input point within a radius. The neighbors are taken from the
+        * neighborhood cache if it has been computed for a radius at least as large (see \a computeNeighborhoodCache),
+        * and searched with \a searchForNeighbors otherwise.
+        * \param index the index of the query point
+        * \param radius the search radius
+        * \param indices the resultant vector of indices of the neighbors
+        * \param distances the resultant vector of squared distances from the query point to the neighbors
+        */
+      int
+      searchForNeighborsCached (int index, double radius, std::vector<int> &indices, std::vector<float> &distances) const;
+
     protected:
       using PCLBase<PointInT>::deinitCompute;
 
@@ -181,6 +196,34 @@ namespace pcl
       /** \brief The number of K nearest neighbors to use for each point. */
       int k_;
 
+      /** \brief The radius the neighborhood cache was computed for (0 if there is no cache). */
+      double neighborhood_radius_;
+
+      /** \brief The neighbors of input point i are stored at positions [neighborhood_offsets_[i], neighborhood_offsets_[i + 1])
+        * of \a neighborhood_indices_ and \a neighborhood_sqr_distances_.
+        */
+      std::vector<int> neighborhood_offsets_;
+
+      /** \brief The neighbor indices of all input points, one neighborhood after the other. */
+      std::vector<int> neighborhood_indices_;
+
+      /** \brief The squared distances of all input points to their neighbors, one neighborhood after the other. */
+      std::vector<float> neighborhood_sqr_distances_;
+
+      /** \brief Search the neighbors of all input points within \a radius once and store them in compressed sparse row
+        * form. Detectors needing the neighborhoods of several radii can compute the cache for the largest one and get the
+        * others with \a searchForNeighborsCached, which only filters the cached neighbors by distance. Non finite points
+        * get an empty neighborhood.
+        * \param radius the largest radius the neighborhoods will be requested for
+        * \param nr_threads the number of threads to use for the searches (0 sets the value to automatic)
+        */
+      void
+      computeNeighborhoodCache (double radius, unsigned int nr_threads);
+
+      /** \brief Release the memory of the neighborhood cache. */
+      void
+      clearNeighborhoodCache ();
+
       /** \brief Get a string representation of the name of this class. */
       inline const std::string&
       getClassName () const { return (name_); }
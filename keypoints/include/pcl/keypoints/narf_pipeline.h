@@ -0,0 +1,139 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#ifndef PCL_NARF_PIPELINE_H_
+#define PCL_NARF_PIPELINE_H_
+
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/features/range_image_border_extractor.h>
+#include <pcl/features/narf_descriptor.h>
+#include <pcl/keypoints/narf_keypoint.h>
+
+namespace pcl {
+
+// Forward declarations
+class RangeImage;
+
+/** \brief Extracts NARF keypoints and their descriptors from a sequence of range images.
+  *
+  * The border data (surface structure, border scores, surface changes) is computed once per range image and
+  * shared by the interest value calculation and the keypoint extraction, the descriptors are then extracted at
+  * the keypoints. All stages run in parallel (over image rows, respectively keypoints) with the same number of
+  * threads and give the same result for any number of threads. The members are kept from one range image to the
+  * next, which avoids allocating the per pixel data again when the images have the same size, e.g., for every
+  * frame of a laser scanner.
+  *
+  * \code
+  * pcl::NarfPipeline narf_pipeline;
+  * narf_pipeline.getParameters ().support_size = 0.2f;
+  * narf_pipeline.getParameters ().max_no_of_threads = 4;
+  * for (...)  // every frame
+  * {
+  *   narf_pipeline.setRangeImage (&range_image);
+  *   narf_pipeline.compute (keypoint_indices, descriptors);
+  * }
+  * \endcode
+  * \ingroup keypoints
+  */
+class PCL_EXPORTS NarfPipeline
+{
+  public:
+    // =====PUBLIC STRUCTS=====
+    //! Parameters used in this class
+    struct Parameters
+    {
+      Parameters () : support_size (-1.0f), rotation_invariant (true), max_no_of_threads (1) {}
+      
+      float support_size;  //!< The size of the area covered by the keypoints and the descriptors (in meters)
+      bool rotation_invariant;  /**< Extract rotation invariant descriptors (this can give several descriptors
+                                  *  for one keypoint) */
+      int max_no_of_threads;  //!< The maximum number of threads used by all the stages
+    };
+    
+    // =====CONSTRUCTOR & DESTRUCTOR=====
+    NarfPipeline ();
+    
+    // =====PUBLIC METHODS=====
+    //! Set the range image the next call to compute works on, the data calculated for the last one is erased
+    void
+      setRangeImage (const RangeImage* range_image);
+    
+    /** Extract the keypoints and the descriptors at the keypoints
+      * \param keypoint_indices the image indices of the keypoints
+      * \param descriptors the descriptors, in the order of the keypoints */
+    void
+      compute (PointCloud<int>& keypoint_indices, PointCloud<Narf36>& descriptors);
+    
+    //! Getter for the parameter struct
+    Parameters&
+      getParameters () { return parameters_;}
+    
+    //! Get the border extractor, e.g., to change its parameters or to get the border descriptions
+    RangeImageBorderExtractor&
+      getBorderExtractor () { return border_extractor_;}
+    
+    //! Get the keypoint detector, e.g., to change its parameters or to get the interest image
+    NarfKeypoint&
+      getKeypointDetector () { return keypoint_detector_;}
+    
+    //! Get the descriptor extractor
+    NarfDescriptor&
+      getDescriptorExtractor () { return descriptor_extractor_;}
+    
+  protected:
+    // =====PROTECTED MEMBER VARIABLES=====
+    Parameters parameters_;
+    const RangeImage* range_image_;
+    RangeImageBorderExtractor border_extractor_;
+    NarfKeypoint keypoint_detector_;
+    NarfDescriptor descriptor_extractor_;
+    boost::shared_ptr<std::vector<int> > keypoint_indices_;
+    
+  private:
+    // The keypoint detector points to the border extractor of this object, therefore it can not be copied
+    NarfPipeline (const NarfPipeline&);
+    NarfPipeline&
+      operator= (const NarfPipeline&);
+};
+
+}  // end namespace pcl
+
+#endif  //#ifndef PCL_NARF_PIPELINE_H_
@@ -108,7 +108,7 @@ namespace pcl
       /** \brief Empty constructor. */
       SIFTKeypoint () : min_scale_ (0.0), nr_octaves_ (0), nr_scales_per_octave_ (0), 
         min_contrast_ (-std::numeric_limits<float>::max ()), scale_idx_ (-1), 
-        out_fields_ (), getFieldValue_ ()
+        out_fields_ (), getFieldValue_ (), threads_ (0)
       {
         name_ = "SIFTKeypoint";
       }
@@ -127,6 +127,12 @@ namespace pcl
       void 
       setMinimumContrast (float min_contrast);
 
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
     protected:
       bool
       initCompute ();
@@ -195,6 +201,9 @@ namespace pcl
       std::vector<sensor_msgs::PointField> out_fields_;
 
       SIFTKeypointFieldSelector<PointInT> getFieldValue_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 }
 
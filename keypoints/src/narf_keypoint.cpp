@@ -757,16 +757,21 @@ NarfKeypoint::calculateInterestPoints ()
   is_interest_point_image_.resize (size, false);
   
   typedef double RealForPolynomial;
-  PolynomialCalculationsT<RealForPolynomial> polynomial_calculations;
-  BivariatePolynomialT<RealForPolynomial> polynomial (2);
-  std::vector<Eigen::Matrix<RealForPolynomial, 3, 1> > sample_points;
-  std::vector<RealForPolynomial> x_values, y_values;
-  std::vector<int> types;
-  std::vector<bool> invalid_beams, old_invalid_beams;
   
-  pcl::PointCloud<InterestPoint>::VectorType tmp_interest_points;
+  // The maxima of every image row are searched (and refined) independently, the rows are concatenated afterwards
+  // so that the result does not depend on the number of threads
+  std::vector<pcl::PointCloud<InterestPoint>::VectorType> row_interest_points (height);
+# pragma omp parallel for num_threads (parameters_.max_no_of_threads) default (shared) schedule (dynamic, 10)
   for (int y=0; y<height; ++y)
   {
+    PolynomialCalculationsT<RealForPolynomial> polynomial_calculations;
+    BivariatePolynomialT<RealForPolynomial> polynomial (2);
+    std::vector<Eigen::Matrix<RealForPolynomial, 3, 1> > sample_points;
+    std::vector<RealForPolynomial> x_values, y_values;
+    std::vector<int> types;
+    std::vector<bool> invalid_beams, old_invalid_beams;
+    pcl::PointCloud<InterestPoint>::VectorType& tmp_interest_points = row_interest_points[y];
+    
     for (int x=0; x<width; ++x)
     {
       int index = y*width + x;
@@ -869,6 +874,10 @@ NarfKeypoint::calculateInterestPoints ()
     }
   }
   
+  pcl::PointCloud<InterestPoint>::VectorType tmp_interest_points;
+  for (int y=0; y<height; ++y)
+    tmp_interest_points.insert (tmp_interest_points.end (), row_interest_points[y].begin (), row_interest_points[y].end ());
+  
   std::sort (tmp_interest_points.begin (), tmp_interest_points.end (), isBetterInterestPoint);
   
   float min_distance_squared = powf (parameters_.min_distance_between_interest_points*parameters_.support_size, 2);
@@ -0,0 +1,106 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+#include <iostream>
+#include <pcl/keypoints/narf_pipeline.h>
+#include <pcl/range_image/range_image.h>
+
+namespace pcl 
+{
+
+/////////////////////////////////////////////////////////////////////////
+NarfPipeline::NarfPipeline () :
+  parameters_ (), range_image_ (NULL), border_extractor_ (), keypoint_detector_ (&border_extractor_),
+  descriptor_extractor_ (), keypoint_indices_ (new std::vector<int>)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////
+void
+NarfPipeline::setRangeImage (const RangeImage* range_image)
+{
+  range_image_ = range_image;
+  // This also gives the range image to the border extractor, which keeps its per pixel storage
+  keypoint_detector_.setRangeImage (range_image);
+  descriptor_extractor_.setRangeImage (range_image);
+}
+
+/////////////////////////////////////////////////////////////////////////
+void
+NarfPipeline::compute (PointCloud<int>& keypoint_indices, PointCloud<Narf36>& descriptors)
+{
+  keypoint_indices.points.clear ();
+  descriptors.points.clear ();
+  
+  if (range_image_ == NULL)
+  {
+    std::cerr << __PRETTY_FUNCTION__ << ": RangeImage is not set. Use setRangeImage (...).\n\n";
+    return;
+  }
+  if (parameters_.support_size <= 0.0f)
+  {
+    std::cerr << __PRETTY_FUNCTION__ << ": support size is not set. Use getParameters ().support_size = ...\n\n";
+    return;
+  }
+  
+  border_extractor_.getParameters ().max_no_of_threads = parameters_.max_no_of_threads;
+  
+  NarfKeypoint::Parameters& keypoint_parameters = keypoint_detector_.getParameters ();
+  keypoint_parameters.support_size = parameters_.support_size;
+  keypoint_parameters.max_no_of_threads = parameters_.max_no_of_threads;
+  keypoint_detector_.compute (keypoint_indices);
+  
+  // The descriptor extractor gets the keypoints through the same indices vector for every range image
+  keypoint_indices_->assign (keypoint_indices.points.begin (), keypoint_indices.points.end ());
+  descriptor_extractor_.setIndices (keypoint_indices_);
+  NarfDescriptor::Parameters& descriptor_parameters = descriptor_extractor_.getParameters ();
+  descriptor_parameters.support_size = parameters_.support_size;
+  descriptor_parameters.rotation_invariant = parameters_.rotation_invariant;
+  descriptor_parameters.max_no_of_threads = parameters_.max_no_of_threads;
+  descriptor_extractor_.compute (descriptors);
+  
+  keypoint_indices.width = static_cast<uint32_t> (keypoint_indices.points.size ());
+  keypoint_indices.height = 1;
+  keypoint_indices.is_dense = true;
+  descriptors.width = static_cast<uint32_t> (descriptors.points.size ());
+  descriptors.height = 1;
+  descriptors.is_dense = true;
+}
+
+}  // end namespace pcl
@@ -41,9 +41,14 @@
 
 #include <vector>
 #include <assert.h>
+#include <algorithm>
 
 #include <pcl/common/common.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -51,7 +56,7 @@ template<typename PointT, typename LeafContainerT, typename BranchContainerT, ty
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::OctreePointCloud (const double resolution) :
     OctreeT (), input_ (PointCloudConstPtr ()), indices_ (IndicesConstPtr ()),
     epsilon_ (0), resolution_ (resolution), minX_ (0.0f), maxX_ (resolution), minY_ (0.0f),
-    maxY_ (resolution), minZ_ (0.0f), maxZ_ (resolution), boundingBoxDefined_ (false)
+    maxY_ (resolution), minZ_ (0.0f), maxZ_ (resolution), boundingBoxDefined_ (false), threads_ (0)
 {
   assert (resolution > 0.0f);
 }
@@ -94,6 +99,209 @@ pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> void
+pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::addPointsFromInputCloudBulk ()
+{
+  // collect finite points in insertion order
+  std::vector<int> point_indices;
+  if (indices_)
+  {
+    point_indices.reserve (indices_->size ());
+    for (std::vector<int>::const_iterator current = indices_->begin (); current != indices_->end (); ++current)
+      if (isFinite (input_->points[*current]))
+        point_indices.push_back (*current);
+  }
+  else
+  {
+    point_indices.reserve (input_->points.size ());
+    for (size_t i = 0; i < input_->points.size (); i++)
+      if (isFinite (input_->points[i]))
+        point_indices.push_back (static_cast<int> (i));
+  }
+
+  const int nr_points = static_cast<int> (point_indices.size ());
+  if (!nr_points)
+    return;
+
+  int nr_threads = 1;
+#ifdef _OPENMP
+  nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+  // extent of the input cloud, reduced over per-thread bounds
+  std::vector<float> bounds (6 * nr_threads);
+  for (int t = 0; t < nr_threads; ++t)
+  {
+    bounds[6 * t + 0] = bounds[6 * t + 1] = bounds[6 * t + 2] = std::numeric_limits<float>::max ();
+    bounds[6 * t + 3] = bounds[6 * t + 4] = bounds[6 * t + 5] = -std::numeric_limits<float>::max ();
+  }
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+  for (int i = 0; i < nr_points; ++i)
+  {
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num ();
+#endif
+    const PointT& point = input_->points[point_indices[i]];
+    float* thread_bounds = &bounds[6 * t];
+    thread_bounds[0] = min (thread_bounds[0], point.x);
+    thread_bounds[1] = min (thread_bounds[1], point.y);
+    thread_bounds[2] = min (thread_bounds[2], point.z);
+    thread_bounds[3] = max (thread_bounds[3], point.x);
+    thread_bounds[4] = max (thread_bounds[4], point.y);
+    thread_bounds[5] = max (thread_bounds[5], point.z);
+  }
+
+  PointT min_pt = input_->points[point_indices[0]];
+  PointT max_pt = min_pt;
+  for (int t = 0; t < nr_threads; ++t)
+  {
+    min_pt.x = min (min_pt.x, bounds[6 * t + 0]);
+    min_pt.y = min (min_pt.y, bounds[6 * t + 1]);
+    min_pt.z = min (min_pt.z, bounds[6 * t + 2]);
+    max_pt.x = max (max_pt.x, bounds[6 * t + 3]);
+    max_pt.y = max (max_pt.y, bounds[6 * t + 4]);
+    max_pt.z = max (max_pt.z, bounds[6 * t + 5]);
+  }
+
+  if (this->octreeCanBulkBuild () && !boundingBoxDefined_)
+  {
+    // define the bounding box directly, growing it keeps an empty branch below the root
+    double padding = std::numeric_limits<float>::epsilon () * 512.0;
+    do
+    {
+      defineBoundingBox (min_pt.x, min_pt.y, min_pt.z,
+                         max_pt.x + padding, max_pt.y + padding, max_pt.z + padding);
+      padding = 2.0 * padding + resolution_;
+    } while (!isPointWithinBoundingBox (min_pt) || !isPointWithinBoundingBox (max_pt));
+  }
+  else if (!isPointWithinBoundingBox (min_pt) || !isPointWithinBoundingBox (max_pt))
+  {
+    // grow the octree in insertion order, the root layout depends on which point leaves the bounding box first
+    for (int i = 0; i < nr_points; ++i)
+      adoptBoundingBoxToPoint (input_->points[point_indices[i]]);
+  }
+
+  if (!this->octreeCanBulkBuild () || (this->octreeDepth_ > 21))
+  {
+    for (int i = 0; i < nr_points; ++i)
+      this->addPointIdx (point_indices[i]);
+    return;
+  }
+
+  // Morton codes of all points, ties are kept in insertion order
+  std::vector<std::pair<uint64_t, int> > sorted_keys (nr_points);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+  for (int i = 0; i < nr_points; ++i)
+  {
+    OctreeKey key;
+    genOctreeKeyforPoint (input_->points[point_indices[i]], key);
+    sorted_keys[i] = std::make_pair (genMortonCode (key), i);
+  }
+
+  // sort chunks in parallel and merge them pairwise
+  std::vector<int> chunk_begin (nr_threads + 1);
+  for (int c = 0; c <= nr_threads; ++c)
+    chunk_begin[c] = static_cast<int> (static_cast<long long> (nr_points) * c / nr_threads);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+  for (int c = 0; c < nr_threads; ++c)
+    std::sort (sorted_keys.begin () + chunk_begin[c], sorted_keys.begin () + chunk_begin[c + 1]);
+  for (int width = 1; width < nr_threads; width *= 2)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+    for (int c = 0; c < nr_threads; c += 2 * width)
+    {
+      if (c + width < nr_threads)
+        std::inplace_merge (sorted_keys.begin () + chunk_begin[c],
+                            sorted_keys.begin () + chunk_begin[c + width],
+                            sorted_keys.begin () + chunk_begin[min (c + 2 * width, nr_threads)]);
+    }
+  }
+
+  // one leaf node per run of equal codes; node i covers sorted_keys[node_begin[i]..node_begin[i+1])
+  std::vector<int> node_begin;
+  std::vector<uint64_t> node_codes;
+  for (int i = 0; i < nr_points; ++i)
+  {
+    if (!i || (sorted_keys[i].first != sorted_keys[i - 1].first))
+    {
+      node_begin.push_back (i);
+      node_codes.push_back (sorted_keys[i].first);
+    }
+  }
+  node_begin.push_back (nr_points);
+
+  std::vector<LeafNode*> leafs;
+  this->leafNodePool_.popNodes (node_codes.size (), leafs, threads_);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 256) num_threads (nr_threads)
+#endif
+  for (int n = 0; n < static_cast<int> (leafs.size ()); ++n)
+    for (int i = node_begin[n]; i < node_begin[n + 1]; ++i)
+      addPointIdxToLeaf (*leafs[n], point_indices[sorted_keys[i].second]);
+
+  std::vector<OctreeNode*> nodes (leafs.begin (), leafs.end ());
+  this->leafCount_ += leafs.size ();
+  this->objectCount_ += nr_points;
+
+  // link the nodes bottom-up, grouping children by the code of their parent
+  for (unsigned int depth = this->octreeDepth_; depth > 1; --depth)
+  {
+    std::vector<int> parent_first;
+    std::vector<uint64_t> parent_codes;
+    for (int n = 0; n < static_cast<int> (nodes.size ()); ++n)
+    {
+      if (!n || ((node_codes[n] >> 3) != (node_codes[n - 1] >> 3)))
+      {
+        parent_first.push_back (n);
+        parent_codes.push_back (node_codes[n] >> 3);
+      }
+    }
+    parent_first.push_back (static_cast<int> (nodes.size ()));
+
+    std::vector<BranchNode*> branches;
+    this->branchNodePool_.popNodes (parent_codes.size (), branches, threads_);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 256) num_threads (nr_threads)
+#endif
+    for (int p = 0; p < static_cast<int> (branches.size ()); ++p)
+    {
+      BranchNode& branch = *branches[p];
+      for (int n = parent_first[p]; n < parent_first[p + 1]; ++n)
+        this->setBranchChildPtr (branch, static_cast<unsigned char> (node_codes[n] & 7), nodes[n]);
+
+      for (int i = node_begin[parent_first[p]]; i < node_begin[parent_first[p + 1]]; ++i)
+        branch.setData (point_indices[sorted_keys[i].second]);
+    }
+
+    std::vector<int> parent_begin (parent_first.size ());
+    for (size_t p = 0; p < parent_first.size (); ++p)
+      parent_begin[p] = node_begin[parent_first[p]];
+
+    nodes.assign (branches.begin (), branches.end ());
+    node_codes.swap (parent_codes);
+    node_begin.swap (parent_begin);
+    this->branchCount_ += branches.size ();
+  }
+
+  // remaining nodes are the children of the root node
+  for (size_t n = 0; n < nodes.size (); ++n)
+    this->setBranchChildPtr (*this->rootNode_, static_cast<unsigned char> (node_codes[n] & 7), nodes[n]);
+  for (int i = 0; i < nr_points; ++i)
+    this->rootNode_->setData (point_indices[sorted_keys[i].second]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT, typename OctreeT> void
 pcl::octree::OctreePointCloud<PointT, LeafContainerT, BranchContainerT, OctreeT>::addPointFromCloud (const int pointIdx_arg, IndicesPtr indices_arg)
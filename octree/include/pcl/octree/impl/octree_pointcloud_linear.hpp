@@ -0,0 +1,1091 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_LINEAR_IMPL_H_
+#define PCL_OCTREE_POINTCLOUD_LINEAR_IMPL_H_
+
+#include <pcl/common/common.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <assert.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT>
+pcl::octree::OctreePointCloudLinear<PointT>::OctreePointCloudLinear (const double resolution) :
+  input_ (PointCloudConstPtr ()), indices_ (IndicesConstPtr ()), epsilon_ (0), resolution_ (resolution),
+  minX_ (0.0f), maxX_ (resolution), minY_ (0.0f), maxY_ (resolution), minZ_ (0.0f), maxZ_ (resolution),
+  boundingBoxDefined_ (false), octreeDepth_ (0), leafCount_ (0), nodes_ (), point_indices_ ()
+{
+  assert (resolution > 0.0f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::defineBoundingBox (const double minX_arg, const double minY_arg,
+                                                               const double minZ_arg, const double maxX_arg,
+                                                               const double maxY_arg, const double maxZ_arg)
+{
+  // bounding box cannot be changed once the octree contains elements
+  assert (nodes_.empty ());
+
+  assert (maxX_arg >= minX_arg);
+  assert (maxY_arg >= minY_arg);
+  assert (maxZ_arg >= minZ_arg);
+
+  minX_ = minX_arg;
+  maxX_ = maxX_arg;
+
+  minY_ = minY_arg;
+  maxY_ = maxY_arg;
+
+  minZ_ = minZ_arg;
+  maxZ_ = maxZ_arg;
+
+  // generate bit masks for octree
+  getKeyBitSize ();
+
+  boundingBoxDefined_ = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::getBoundingBox (double& minX_arg, double& minY_arg, double& minZ_arg,
+                                                            double& maxX_arg, double& maxY_arg, double& maxZ_arg) const
+{
+  minX_arg = minX_;
+  minY_arg = minY_;
+  minZ_arg = minZ_;
+
+  maxX_arg = maxX_;
+  maxY_arg = maxY_;
+  maxZ_arg = maxZ_;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::fitBoundingBox ()
+{
+  Eigen::Vector4f min_pt;
+  Eigen::Vector4f max_pt;
+
+  if (indices_)
+    pcl::getMinMax3D (*input_, *indices_, min_pt, max_pt);
+  else
+    pcl::getMinMax3D (*input_, min_pt, max_pt);
+
+  // same padding as OctreePointCloud::defineBoundingBox ()
+  const float minValue = std::numeric_limits<float>::epsilon () * 512.0f;
+
+  defineBoundingBox (min_pt (0), min_pt (1), min_pt (2),
+                     max_pt (0) + minValue, max_pt (1) + minValue, max_pt (2) + minValue);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::getKeyBitSize ()
+{
+  const float minValue = std::numeric_limits<float>::epsilon ();
+
+  // find maximum key values for x, y, z
+  const unsigned int maxKeyX = static_cast<unsigned int> ((maxX_ - minX_) / resolution_);
+  const unsigned int maxKeyY = static_cast<unsigned int> ((maxY_ - minY_) / resolution_);
+  const unsigned int maxKeyZ = static_cast<unsigned int> ((maxZ_ - minZ_) / resolution_);
+
+  // find maximum amount of keys
+  const unsigned int maxVoxels = std::max (std::max (std::max (maxKeyX, maxKeyY), maxKeyZ), static_cast<unsigned int> (2));
+
+  const unsigned int maxDepth = static_cast<unsigned int> (OctreeKey::maxDepth) - 1;
+
+  // tree depth == amount of bits of maxVoxels
+  octreeDepth_ = std::min (maxDepth, static_cast<unsigned int> (ceil (log (static_cast<double> (maxVoxels)) / log (2.0) - minValue)));
+
+  // the octree cube has to cover the whole bounding box, since points outside of it are not added
+  const double maxSideLen = std::max (std::max (maxX_ - minX_, maxY_ - minY_), maxZ_ - minZ_);
+  while (octreeDepth_ < maxDepth && static_cast<double> (1 << octreeDepth_) * resolution_ < maxSideLen)
+    octreeDepth_++;
+
+  const double octreeSideLen = static_cast<double> (1 << octreeDepth_) * resolution_ - minValue;
+
+  // center the input bounding box in the octree cube
+  const double octreeOversizeX = (octreeSideLen - (maxX_ - minX_)) / 2.0;
+  const double octreeOversizeY = (octreeSideLen - (maxY_ - minY_)) / 2.0;
+  const double octreeOversizeZ = (octreeSideLen - (maxZ_ - minZ_)) / 2.0;
+
+  minX_ -= octreeOversizeX;
+  minY_ -= octreeOversizeY;
+  minZ_ -= octreeOversizeZ;
+
+  maxX_ += octreeOversizeX;
+  maxY_ += octreeOversizeY;
+  maxZ_ += octreeOversizeZ;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::isMortonLess (const KeyIndexPair& a, const KeyIndexPair& b)
+{
+  const uint32_t diffX = a.first.x ^ b.first.x;
+  const uint32_t diffY = a.first.y ^ b.first.y;
+  const uint32_t diffZ = a.first.z ^ b.first.z;
+
+  if (!(diffX | diffY | diffZ))
+    return (a.second < b.second);
+
+  // the axis with the most significant differing bit decides, x before y before z on the same level
+  uint32_t diff = diffX;
+  int axis = 0;
+  if (diff < diffY && diff < (diff ^ diffY))
+  {
+    diff = diffY;
+    axis = 1;
+  }
+  if (diff < diffZ && diff < (diff ^ diffZ))
+    axis = 2;
+
+  switch (axis)
+  {
+    case 0:
+      return (a.first.x < b.first.x);
+    case 1:
+      return (a.first.y < b.first.y);
+    default:
+      return (a.first.z < b.first.z);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::addPointsFromInputCloud ()
+{
+  assert (input_);
+
+  nodes_.clear ();
+  point_indices_.clear ();
+  leafCount_ = 0;
+
+  if (!boundingBoxDefined_)
+    fitBoundingBox ();
+
+  // collect leaf keys of all finite points within the bounding box
+  const std::size_t nr_points = indices_ ? indices_->size () : input_->points.size ();
+  std::vector<KeyIndexPair> keys;
+  keys.reserve (nr_points);
+
+  for (std::size_t i = 0; i < nr_points; ++i)
+  {
+    const int index = indices_ ? (*indices_)[i] : static_cast<int> (i);
+    const PointT& point = input_->points[index];
+
+    if (!isFinite (point))
+      continue;
+
+    if (point.x < minX_ || point.y < minY_ || point.z < minZ_ ||
+        point.x >= maxX_ || point.y >= maxY_ || point.z >= maxZ_)
+      continue;
+
+    OctreeKey key;
+    genOctreeKeyforPoint (point, key);
+    keys.push_back (KeyIndexPair (key, index));
+  }
+
+  if (keys.empty ())
+    return;
+
+  // sorting along the Morton curve stores the points of every subtree consecutively
+  std::sort (keys.begin (), keys.end (), isMortonLess);
+
+  point_indices_.resize (keys.size ());
+
+  // nodes and their keys, level by level, starting with the root at level 0
+  std::vector<std::vector<LinearNode> > levels (octreeDepth_ + 1);
+  std::vector<std::vector<OctreeKey> > levelKeys (octreeDepth_ + 1);
+
+  // leaf nodes are the runs of equal keys
+  for (std::size_t i = 0; i < keys.size (); ++i)
+  {
+    point_indices_[i] = keys[i].second;
+
+    if (i && keys[i].first == keys[i - 1].first)
+    {
+      levels[octreeDepth_].back ().point_end++;
+      continue;
+    }
+
+    LinearNode leaf;
+    leaf.child_offset = 0;
+    leaf.point_begin = static_cast<uint32_t> (i);
+    leaf.point_end = static_cast<uint32_t> (i + 1);
+    leaf.child_mask = 0;
+
+    levels[octreeDepth_].push_back (leaf);
+    levelKeys[octreeDepth_].push_back (keys[i].first);
+  }
+
+  // branch nodes group the consecutive children that share their parent key
+  for (unsigned int depth = octreeDepth_; depth > 0; --depth)
+  {
+    const std::vector<LinearNode>& children = levels[depth];
+    const std::vector<OctreeKey>& childKeys = levelKeys[depth];
+
+    for (std::size_t i = 0; i < children.size (); ++i)
+    {
+      OctreeKey parentKey;
+      parentKey.x = childKeys[i].x >> 1;
+      parentKey.y = childKeys[i].y >> 1;
+      parentKey.z = childKeys[i].z >> 1;
+
+      const unsigned char childIdx = static_cast<unsigned char> (((childKeys[i].x & 1) << 2) |
+                                                                 ((childKeys[i].y & 1) << 1) |
+                                                                  (childKeys[i].z & 1));
+
+      if (i && parentKey == levelKeys[depth - 1].back ())
+      {
+        levels[depth - 1].back ().point_end = children[i].point_end;
+        levels[depth - 1].back ().child_mask |= 1u << childIdx;
+        continue;
+      }
+
+      // child_offset holds the position within the next level until the levels are concatenated
+      LinearNode branch;
+      branch.child_offset = static_cast<uint32_t> (i);
+      branch.point_begin = children[i].point_begin;
+      branch.point_end = children[i].point_end;
+      branch.child_mask = 1u << childIdx;
+
+      levels[depth - 1].push_back (branch);
+      levelKeys[depth - 1].push_back (parentKey);
+    }
+  }
+
+  assert (levels[0].size () == 1);
+
+  // concatenate the levels
+  std::size_t nodeCount = 0;
+  for (unsigned int depth = 0; depth <= octreeDepth_; ++depth)
+    nodeCount += levels[depth].size ();
+
+  nodes_.reserve (nodeCount);
+  for (unsigned int depth = 0; depth <= octreeDepth_; ++depth)
+  {
+    const uint32_t nextLevelOffset = static_cast<uint32_t> (nodes_.size () + levels[depth].size ());
+    for (std::size_t i = 0; i < levels[depth].size (); ++i)
+    {
+      nodes_.push_back (levels[depth][i]);
+      if (depth < octreeDepth_)
+        nodes_.back ().child_offset += nextLevelOffset;
+    }
+  }
+
+  leafCount_ = levels[octreeDepth_].size ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::deleteTree ()
+{
+  nodes_.clear ();
+  point_indices_.clear ();
+  leafCount_ = 0;
+  octreeDepth_ = 0;
+
+  minX_ = minY_ = minZ_ = 0.0;
+  maxX_ = maxY_ = maxZ_ = resolution_;
+
+  boundingBoxDefined_ = false;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::serializeTree (std::vector<char>& binary_out) const
+{
+  const double bounds[7] = { resolution_, minX_, minY_, minZ_, maxX_, maxY_, maxZ_ };
+  const uint32_t sizes[4] = { octreeDepth_, static_cast<uint32_t> (leafCount_),
+                              static_cast<uint32_t> (nodes_.size ()), static_cast<uint32_t> (point_indices_.size ()) };
+
+  const std::size_t nodeBytes = nodes_.size () * sizeof (LinearNode);
+  const std::size_t indexBytes = point_indices_.size () * sizeof (int);
+
+  binary_out.resize (sizeof (bounds) + sizeof (sizes) + nodeBytes + indexBytes);
+  char* data = &binary_out[0];
+
+  // the node and index arrays are plain data and are copied as they are
+  memcpy (data, bounds, sizeof (bounds));
+  data += sizeof (bounds);
+  memcpy (data, sizes, sizeof (sizes));
+  data += sizeof (sizes);
+  if (nodeBytes)
+    memcpy (data, &nodes_[0], nodeBytes);
+  data += nodeBytes;
+  if (indexBytes)
+    memcpy (data, &point_indices_[0], indexBytes);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::deserializeTree (const std::vector<char>& binary_in)
+{
+  double bounds[7];
+  uint32_t sizes[4];
+
+  if (binary_in.size () < sizeof (bounds) + sizeof (sizes))
+    return (false);
+
+  const char* data = &binary_in[0];
+  memcpy (bounds, data, sizeof (bounds));
+  data += sizeof (bounds);
+  memcpy (sizes, data, sizeof (sizes));
+  data += sizeof (sizes);
+
+  const std::size_t nodeBytes = static_cast<std::size_t> (sizes[2]) * sizeof (LinearNode);
+  const std::size_t indexBytes = static_cast<std::size_t> (sizes[3]) * sizeof (int);
+
+  if (binary_in.size () != sizeof (bounds) + sizeof (sizes) + nodeBytes + indexBytes ||
+      sizes[0] >= OctreeKey::maxDepth || sizes[1] > sizes[2] || bounds[0] <= 0.0)
+    return (false);
+
+  std::vector<LinearNode> nodes (sizes[2]);
+  std::vector<int> point_indices (sizes[3]);
+
+  if (nodeBytes)
+    memcpy (&nodes[0], data, nodeBytes);
+  data += nodeBytes;
+  if (indexBytes)
+    memcpy (&point_indices[0], data, indexBytes);
+
+  // the searches follow the offsets without any checks, so a corrupted buffer must not get through
+  for (uint32_t i = 0; i < sizes[2]; ++i)
+  {
+    const LinearNode& node = nodes[i];
+    if (node.point_begin > node.point_end || node.point_end > sizes[3] || node.child_mask > 0xFFu)
+      return (false);
+
+    if (node.child_mask)
+    {
+      uint32_t childCount = 0;
+      for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+        childCount += (node.child_mask >> childIdx) & 1u;
+
+      // children are stored behind their parent, which also rules out cycles
+      if (node.child_offset <= i || static_cast<std::size_t> (node.child_offset) + childCount > sizes[2])
+        return (false);
+    }
+  }
+
+  const std::size_t nr_points = input_ ? input_->points.size () : static_cast<std::size_t> (std::numeric_limits<int>::max ());
+  for (std::size_t i = 0; i < point_indices.size (); ++i)
+    if (point_indices[i] < 0 || static_cast<std::size_t> (point_indices[i]) >= nr_points)
+      return (false);
+
+  resolution_ = bounds[0];
+  minX_ = bounds[1];
+  minY_ = bounds[2];
+  minZ_ = bounds[3];
+  maxX_ = bounds[4];
+  maxY_ = bounds[5];
+  maxZ_ = bounds[6];
+
+  octreeDepth_ = sizes[0];
+  leafCount_ = sizes[1];
+  boundingBoxDefined_ = true;
+
+  nodes_.swap (nodes);
+  point_indices_.swap (point_indices);
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::genVoxelCenterFromOctreeKey (const OctreeKey & key_arg,
+                                                                         unsigned int treeDepth_arg,
+                                                                         PointT& point_arg) const
+{
+  // calculate voxel size of current tree depth
+  const double voxel_side_len = resolution_ * static_cast<double> (1 << (octreeDepth_ - treeDepth_arg));
+
+  point_arg.x = static_cast<float> ((static_cast<double> (key_arg.x) + 0.5f) * voxel_side_len + minX_);
+  point_arg.y = static_cast<float> ((static_cast<double> (key_arg.y) + 0.5f) * voxel_side_len + minY_);
+  point_arg.z = static_cast<float> ((static_cast<double> (key_arg.z) + 0.5f) * voxel_side_len + minZ_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::genVoxelBoundsFromOctreeKey (const OctreeKey & key_arg,
+                                                                         unsigned int treeDepth_arg,
+                                                                         Eigen::Vector3f &min_pt,
+                                                                         Eigen::Vector3f &max_pt) const
+{
+  // calculate voxel size of current tree depth
+  const double voxel_side_len = resolution_ * static_cast<double> (1 << (octreeDepth_ - treeDepth_arg));
+
+  min_pt (0) = static_cast<float> (static_cast<double> (key_arg.x) * voxel_side_len + minX_);
+  min_pt (1) = static_cast<float> (static_cast<double> (key_arg.y) * voxel_side_len + minY_);
+  min_pt (2) = static_cast<float> (static_cast<double> (key_arg.z) * voxel_side_len + minZ_);
+
+  max_pt (0) = static_cast<float> (static_cast<double> (key_arg.x + 1) * voxel_side_len + minX_);
+  max_pt (1) = static_cast<float> (static_cast<double> (key_arg.y + 1) * voxel_side_len + minY_);
+  max_pt (2) = static_cast<float> (static_cast<double> (key_arg.z + 1) * voxel_side_len + minZ_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::voxelSearch (const PointT& point, std::vector<int>& pointIdx_data) const
+{
+  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to voxelSearch!");
+
+  if (nodes_.empty () ||
+      point.x < minX_ || point.y < minY_ || point.z < minZ_ ||
+      point.x >= maxX_ || point.y >= maxY_ || point.z >= maxZ_)
+    return (false);
+
+  OctreeKey key;
+  genOctreeKeyforPoint (point, key);
+
+  // descend from the root along the key bits
+  uint32_t node = 0;
+  for (unsigned int depth = 1; depth <= octreeDepth_; ++depth)
+  {
+    const unsigned int bit = octreeDepth_ - depth;
+    const unsigned char childIdx = static_cast<unsigned char> ((((key.x >> bit) & 1) << 2) |
+                                                               (((key.y >> bit) & 1) << 1) |
+                                                                ((key.z >> bit) & 1));
+    if (!(nodes_[node].child_mask & (1u << childIdx)))
+      return (false);
+
+    node = getChildPosition (nodes_[node], childIdx);
+  }
+
+  pointIdx_data.insert (pointIdx_data.end (),
+                        point_indices_.begin () + nodes_[node].point_begin,
+                        point_indices_.begin () + nodes_[node].point_end);
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::nearestKSearch (const PointT &p_q, int k,
+                                                            std::vector<int> &k_indices,
+                                                            std::vector<float> &k_sqr_distances) const
+{
+  assert (isFinite (p_q) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+
+  if (k < 1 || nodes_.empty ())
+    return (0);
+
+  std::vector<prioPointQueueEntry> pointCandidates;
+
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  getKNearestNeighborRecursive (p_q, k, 0, key, 1, std::numeric_limits<double>::max (), pointCandidates);
+
+  k_indices.resize (pointCandidates.size ());
+  k_sqr_distances.resize (pointCandidates.size ());
+
+  for (std::size_t i = 0; i < pointCandidates.size (); ++i)
+  {
+    k_indices[i] = pointCandidates[i].pointIdx_;
+    k_sqr_distances[i] = pointCandidates[i].pointDistance_;
+  }
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::approxNearestSearch (const PointT &p_q, int &result_index,
+                                                                 float &sqr_distance) const
+{
+  assert (isFinite (p_q) && "Invalid (NaN, Inf) point coordinates given to approxNearestSearch!");
+
+  if (nodes_.empty ())
+    return;
+
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  // follow the child with the closest voxel center down to the leaf level
+  uint32_t node = 0;
+  for (unsigned int depth = 1; depth <= octreeDepth_; ++depth)
+  {
+    double minVoxelCenterDistance = std::numeric_limits<double>::max ();
+    unsigned char minChildIdx = 0xFF;
+    OctreeKey minChildKey;
+
+    for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+    {
+      if (!(nodes_[node].child_mask & (1u << childIdx)))
+        continue;
+
+      OctreeKey newKey;
+      PointT voxelCenter;
+
+      genChildKey (key, childIdx, newKey);
+      genVoxelCenterFromOctreeKey (newKey, depth, voxelCenter);
+
+      const double voxelPointDist = pointSquaredDist (voxelCenter, p_q);
+      if (voxelPointDist >= minVoxelCenterDistance)
+        continue;
+
+      minVoxelCenterDistance = voxelPointDist;
+      minChildIdx = childIdx;
+      minChildKey = newKey;
+    }
+
+    // every branch node has at least one child
+    assert (minChildIdx < 8);
+
+    node = getChildPosition (nodes_[node], minChildIdx);
+    key = minChildKey;
+  }
+
+  double smallestSquaredDist = std::numeric_limits<double>::max ();
+  for (uint32_t i = nodes_[node].point_begin; i < nodes_[node].point_end; ++i)
+  {
+    const double squaredDist = pointSquaredDist (getPointByIndex (point_indices_[i]), p_q);
+    if (squaredDist >= smallestSquaredDist)
+      continue;
+
+    result_index = point_indices_[i];
+    smallestSquaredDist = squaredDist;
+    sqr_distance = static_cast<float> (squaredDist);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::radiusSearch (const PointT &p_q, const double radius,
+                                                          std::vector<int> &k_indices,
+                                                          std::vector<float> &k_sqr_distances,
+                                                          unsigned int max_nn) const
+{
+  assert (isFinite (p_q) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+
+  if (nodes_.empty ())
+    return (0);
+
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  getNeighborsWithinRadiusRecursive (p_q, radius * radius, 0, key, 1, k_indices, k_sqr_distances, max_nn);
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::boxSearch (const Eigen::Vector3f &min_pt,
+                                                       const Eigen::Vector3f &max_pt,
+                                                       std::vector<int> &k_indices) const
+{
+  k_indices.clear ();
+
+  if (nodes_.empty ())
+    return (0);
+
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  boxSearchRecursive (min_pt, max_pt, 0, key, 1, k_indices);
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> double
+pcl::octree::OctreePointCloudLinear<PointT>::getKNearestNeighborRecursive (
+    const PointT& point, unsigned int K, uint32_t node, const OctreeKey& key, unsigned int treeDepth,
+    const double squaredSearchRadius, std::vector<prioPointQueueEntry>& pointCandidates) const
+{
+  const LinearNode& branch = nodes_[node];
+
+  prioNodeQueueEntry searchEntryHeap[8];
+  int entryCount = 0;
+
+  double smallestSquaredDist = squaredSearchRadius;
+
+  // get spatial voxel information
+  const double voxelSquaredDiameter = getVoxelSquaredDiameter (treeDepth);
+
+  // the children are stored consecutively in child index order
+  uint32_t childNode = branch.child_offset;
+  for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+  {
+    if (!(branch.child_mask & (1u << childIdx)))
+      continue;
+
+    prioNodeQueueEntry& entry = searchEntryHeap[entryCount++];
+    PointT voxelCenter;
+
+    genChildKey (key, childIdx, entry.key);
+    genVoxelCenterFromOctreeKey (entry.key, treeDepth, voxelCenter);
+
+    entry.node = childNode++;
+    entry.pointDistance = pointSquaredDist (voxelCenter, point);
+  }
+
+  std::sort (searchEntryHeap, searchEntryHeap + entryCount);
+
+  // iterate over all children in priority queue
+  // check if the distance to search candidate is smaller than the best point distance (smallestSquaredDist)
+  while ((entryCount > 0)
+      && (searchEntryHeap[entryCount - 1].pointDistance
+          < smallestSquaredDist + voxelSquaredDiameter / 4.0 + sqrt (smallestSquaredDist * voxelSquaredDiameter)
+              - epsilon_))
+  {
+    const prioNodeQueueEntry& entry = searchEntryHeap[entryCount - 1];
+
+    if (treeDepth < octreeDepth_)
+    {
+      // we have not reached maximum tree depth
+      smallestSquaredDist = getKNearestNeighborRecursive (point, K, entry.node, entry.key, treeDepth + 1,
+                                                          smallestSquaredDist, pointCandidates);
+    }
+    else
+    {
+      // we reached leaf node level
+      const LinearNode& leaf = nodes_[entry.node];
+
+      for (uint32_t i = leaf.point_begin; i < leaf.point_end; ++i)
+      {
+        // calculate point distance to search point
+        const float squaredDist = pointSquaredDist (getPointByIndex (point_indices_[i]), point);
+
+        // check if a closer match is found
+        if (squaredDist < smallestSquaredDist)
+        {
+          prioPointQueueEntry pointEntry;
+
+          pointEntry.pointDistance_ = squaredDist;
+          pointEntry.pointIdx_ = point_indices_[i];
+          pointCandidates.push_back (pointEntry);
+        }
+      }
+
+      std::sort (pointCandidates.begin (), pointCandidates.end ());
+
+      if (pointCandidates.size () > K)
+        pointCandidates.resize (K);
+
+      if (pointCandidates.size () == K)
+        smallestSquaredDist = pointCandidates.back ().pointDistance_;
+    }
+
+    // pop element from priority queue
+    --entryCount;
+  }
+
+  return (smallestSquaredDist);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::getNeighborsWithinRadiusRecursive (
+    const PointT& point, const double radiusSquared, uint32_t node, const OctreeKey& key,
+    unsigned int treeDepth, std::vector<int>& k_indices, std::vector<float>& k_sqr_distances,
+    unsigned int max_nn) const
+{
+  const LinearNode& branch = nodes_[node];
+
+  // get spatial voxel information
+  const double voxelSquaredDiameter = getVoxelSquaredDiameter (treeDepth);
+  const double radius = sqrt (radiusSquared);
+  const double voxelHalfDiameter = sqrt (voxelSquaredDiameter) / 2.0;
+
+  uint32_t childNode = branch.child_offset;
+  for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+  {
+    if (!(branch.child_mask & (1u << childIdx)))
+      continue;
+
+    const uint32_t child = childNode++;
+
+    OctreeKey newKey;
+    PointT voxelCenter;
+
+    genChildKey (key, childIdx, newKey);
+    genVoxelCenterFromOctreeKey (newKey, treeDepth, voxelCenter);
+
+    // calculate distance to search point
+    const float squaredDist = pointSquaredDist (voxelCenter, point);
+
+    // skip voxels outside of the search radius
+    if (squaredDist + epsilon_ > voxelSquaredDiameter / 4.0 + radiusSquared + sqrt (voxelSquaredDiameter * radiusSquared))
+      continue;
+
+    bool done;
+    if (treeDepth < octreeDepth_ && sqrt (squaredDist) + voxelHalfDiameter > radius)
+    {
+      // voxel intersects the search sphere boundary, refine on the next level
+      done = getNeighborsWithinRadiusRecursive (point, radiusSquared, child, newKey, treeDepth + 1,
+                                                k_indices, k_sqr_distances, max_nn);
+    }
+    else
+    {
+      // leaf voxel or voxel within the search sphere: its points are stored consecutively
+      done = getPointsWithinRadius (point, radiusSquared, nodes_[child], k_indices, k_sqr_distances, max_nn);
+    }
+
+    if (done)
+      return (true);
+  }
+
+  return (false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> bool
+pcl::octree::OctreePointCloudLinear<PointT>::getPointsWithinRadius (
+    const PointT& point, const double radiusSquared, const LinearNode& node,
+    std::vector<int>& k_indices, std::vector<float>& k_sqr_distances, unsigned int max_nn) const
+{
+  for (uint32_t i = node.point_begin; i < node.point_end; ++i)
+  {
+    // calculate point distance to search point
+    const float squaredDist = pointSquaredDist (getPointByIndex (point_indices_[i]), point);
+
+    // check if a match is found
+    if (squaredDist > radiusSquared)
+      continue;
+
+    // add point to result vector
+    k_indices.push_back (point_indices_[i]);
+    k_sqr_distances.push_back (squaredDist);
+
+    if (max_nn != 0 && k_indices.size () == static_cast<unsigned int> (max_nn))
+      return (true);
+  }
+
+  return (false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::boxSearchRecursive (const Eigen::Vector3f &min_pt,
+                                                                const Eigen::Vector3f &max_pt,
+                                                                uint32_t node, const OctreeKey& key,
+                                                                unsigned int treeDepth,
+                                                                std::vector<int>& k_indices) const
+{
+  const LinearNode& branch = nodes_[node];
+
+  uint32_t childNode = branch.child_offset;
+  for (unsigned char childIdx = 0; childIdx < 8; ++childIdx)
+  {
+    if (!(branch.child_mask & (1u << childIdx)))
+      continue;
+
+    const uint32_t child = childNode++;
+
+    OctreeKey newKey;
+    genChildKey (key, childIdx, newKey);
+
+    // voxel corners
+    Eigen::Vector3f lowerVoxelCorner;
+    Eigen::Vector3f upperVoxelCorner;
+    genVoxelBoundsFromOctreeKey (newKey, treeDepth, lowerVoxelCorner, upperVoxelCorner);
+
+    // test if search region overlap with voxel space
+    if ( (lowerVoxelCorner (0) > max_pt (0)) || (min_pt (0) > upperVoxelCorner (0)) ||
+         (lowerVoxelCorner (1) > max_pt (1)) || (min_pt (1) > upperVoxelCorner (1)) ||
+         (lowerVoxelCorner (2) > max_pt (2)) || (min_pt (2) > upperVoxelCorner (2)) )
+      continue;
+
+    const bool inside = (lowerVoxelCorner (0) > min_pt (0)) && (upperVoxelCorner (0) < max_pt (0)) &&
+                        (lowerVoxelCorner (1) > min_pt (1)) && (upperVoxelCorner (1) < max_pt (1)) &&
+                        (lowerVoxelCorner (2) > min_pt (2)) && (upperVoxelCorner (2) < max_pt (2));
+
+    if (treeDepth < octreeDepth_ && !inside)
+    {
+      // voxel intersects the search box boundary, refine on the next level
+      boxSearchRecursive (min_pt, max_pt, child, newKey, treeDepth + 1, k_indices);
+      continue;
+    }
+
+    // leaf voxel or voxel within the search box: its points are stored consecutively
+    for (uint32_t i = nodes_[child].point_begin; i < nodes_[child].point_end; ++i)
+    {
+      const PointT& candidatePoint = getPointByIndex (point_indices_[i]);
+
+      // check if point falls within search box
+      if ( (candidatePoint.x > min_pt (0)) && (candidatePoint.x < max_pt (0)) &&
+           (candidatePoint.y > min_pt (1)) && (candidatePoint.y < max_pt (1)) &&
+           (candidatePoint.z > min_pt (2)) && (candidatePoint.z < max_pt (2)) )
+        k_indices.push_back (point_indices_[i]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::getIntersectedVoxelCenters (Eigen::Vector3f origin,
+                                                                        Eigen::Vector3f direction,
+                                                                        AlignedPointTVector &voxelCenterList,
+                                                                        int maxVoxelCount) const
+{
+  voxelCenterList.clear ();
+
+  if (nodes_.empty ())
+    return (0);
+
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  // Voxel childIdx remapping
+  unsigned char a = 0;
+  double minX, minY, minZ, maxX, maxY, maxZ;
+
+  initIntersectedVoxel (origin, direction, minX, minY, minZ, maxX, maxY, maxZ, a);
+
+  if (std::max (std::max (minX, minY), minZ) < std::min (std::min (maxX, maxY), maxZ))
+    return (getIntersectedVoxelsRecursive (minX, minY, minZ, maxX, maxY, maxZ, a, 0, key, 0,
+                                           &voxelCenterList, 0, maxVoxelCount));
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::getIntersectedVoxelIndices (Eigen::Vector3f origin,
+                                                                        Eigen::Vector3f direction,
+                                                                        std::vector<int> &k_indices,
+                                                                        int maxVoxelCount) const
+{
+  k_indices.clear ();
+
+  if (nodes_.empty ())
+    return (0);
+
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  // Voxel childIdx remapping
+  unsigned char a = 0;
+  double minX, minY, minZ, maxX, maxY, maxZ;
+
+  initIntersectedVoxel (origin, direction, minX, minY, minZ, maxX, maxY, maxZ, a);
+
+  if (std::max (std::max (minX, minY), minZ) < std::min (std::min (maxX, maxY), maxZ))
+    return (getIntersectedVoxelsRecursive (minX, minY, minZ, maxX, maxY, maxZ, a, 0, key, 0,
+                                           0, &k_indices, maxVoxelCount));
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::getIntersectedVoxelsRecursive (
+    double minX, double minY, double minZ, double maxX, double maxY, double maxZ, unsigned char a,
+    uint32_t node, const OctreeKey& key, unsigned int treeDepth, AlignedPointTVector* voxelCenterList,
+    std::vector<int>* k_indices, int maxVoxelCount) const
+{
+  if (maxX < 0.0 || maxY < 0.0 || maxZ < 0.0)
+    return (0);
+
+  const LinearNode& current = nodes_[node];
+
+  // If leaf node, report voxel and increment intersection count
+  if (treeDepth == octreeDepth_)
+  {
+    if (voxelCenterList)
+    {
+      PointT newPoint;
+      genVoxelCenterFromOctreeKey (key, treeDepth, newPoint);
+      voxelCenterList->push_back (newPoint);
+    }
+    if (k_indices)
+      k_indices->insert (k_indices->end (),
+                         point_indices_.begin () + current.point_begin,
+                         point_indices_.begin () + current.point_end);
+    return (1);
+  }
+
+  // Voxel intersection count for branches children
+  int voxelCount = 0;
+
+  // Voxel mid lines
+  const double midX = 0.5 * (minX + maxX);
+  const double midY = 0.5 * (minY + maxY);
+  const double midZ = 0.5 * (minZ + maxZ);
+
+  // First voxel node ray will intersect
+  int currNode = getFirstIntersectedNode (minX, minY, minZ, midX, midY, midZ);
+
+  do
+  {
+    const unsigned char childIdx = static_cast<unsigned char> (currNode ^ a);
+    const bool hasChild = (current.child_mask & (1u << childIdx)) != 0;
+
+    OctreeKey childKey;
+    genChildKey (key, childIdx, childKey);
+
+    // child voxel bounds in ray parameter space and the next intersected child
+    double childMin[3], childMax[3];
+    int nextNode;
+
+    childMin[0] = (currNode & 4) ? midX : minX;
+    childMax[0] = (currNode & 4) ? maxX : midX;
+    childMin[1] = (currNode & 2) ? midY : minY;
+    childMax[1] = (currNode & 2) ? maxY : midY;
+    childMin[2] = (currNode & 1) ? midZ : minZ;
+    childMax[2] = (currNode & 1) ? maxZ : midZ;
+
+    nextNode = getNextIntersectedNode (childMax[0], childMax[1], childMax[2],
+                                       (currNode & 4) ? 8 : currNode | 4,
+                                       (currNode & 2) ? 8 : currNode | 2,
+                                       (currNode & 1) ? 8 : currNode | 1);
+
+    // Recursively call each intersected child node. Children that do not intersect will not be traversed.
+    if (hasChild)
+      voxelCount += getIntersectedVoxelsRecursive (childMin[0], childMin[1], childMin[2],
+                                                   childMax[0], childMax[1], childMax[2], a,
+                                                   getChildPosition (current, childIdx), childKey, treeDepth + 1,
+                                                   voxelCenterList, k_indices, maxVoxelCount);
+
+    currNode = nextNode;
+  } while ((currNode < 8) && (maxVoxelCount <= 0 || voxelCount < maxVoxelCount));
+
+  return (voxelCount);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::octree::OctreePointCloudLinear<PointT>::initIntersectedVoxel (Eigen::Vector3f &origin,
+                                                                  Eigen::Vector3f &direction,
+                                                                  double &minX, double &minY, double &minZ,
+                                                                  double &maxX, double &maxY, double &maxZ,
+                                                                  unsigned char &a) const
+{
+  // Account for division by zero when direction vector is 0.0
+  const float epsilon = 1e-10f;
+  if (direction.x () == 0.0)
+    direction.x () = epsilon;
+  if (direction.y () == 0.0)
+    direction.y () = epsilon;
+  if (direction.z () == 0.0)
+    direction.z () = epsilon;
+
+  // Voxel childIdx remapping
+  a = 0;
+
+  // Handle negative axis direction vector
+  if (direction.x () < 0.0)
+  {
+    origin.x () = static_cast<float> (minX_) + static_cast<float> (maxX_) - origin.x ();
+    direction.x () = -direction.x ();
+    a |= 4;
+  }
+  if (direction.y () < 0.0)
+  {
+    origin.y () = static_cast<float> (minY_) + static_cast<float> (maxY_) - origin.y ();
+    direction.y () = -direction.y ();
+    a |= 2;
+  }
+  if (direction.z () < 0.0)
+  {
+    origin.z () = static_cast<float> (minZ_) + static_cast<float> (maxZ_) - origin.z ();
+    direction.z () = -direction.z ();
+    a |= 1;
+  }
+  minX = (minX_ - origin.x ()) / direction.x ();
+  maxX = (maxX_ - origin.x ()) / direction.x ();
+  minY = (minY_ - origin.y ()) / direction.y ();
+  maxY = (maxY_ - origin.y ()) / direction.y ();
+  minZ = (minZ_ - origin.z ()) / direction.z ();
+  maxZ = (maxZ_ - origin.z ()) / direction.z ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> int
+pcl::octree::OctreePointCloudLinear<PointT>::getFirstIntersectedNode (double minX, double minY, double minZ,
+                                                                     double midX, double midY, double midZ)
+{
+  int currNode = 0;
+
+  if (minX > minY)
+  {
+    if (minX > minZ)
+    {
+      // max(minX, minY, minZ) is minX. Entry plane is YZ.
+      if (midY < minX)
+        currNode |= 2;
+      if (midZ < minX)
+        currNode |= 1;
+    }
+    else
+    {
+      // max(minX, minY, minZ) is minZ. Entry plane is XY.
+      if (midX < minZ)
+        currNode |= 4;
+      if (midY < minZ)
+        currNode |= 2;
+    }
+  }
+  else
+  {
+    if (minY > minZ)
+    {
+      // max(minX, minY, minZ) is minY. Entry plane is XZ.
+      if (midX < minY)
+        currNode |= 4;
+      if (midZ < minY)
+        currNode |= 1;
+    }
+    else
+    {
+      // max(minX, minY, minZ) is minZ. Entry plane is XY.
+      if (midX < minZ)
+        currNode |= 4;
+      if (midY < minZ)
+        currNode |= 2;
+    }
+  }
+
+  return (currNode);
+}
+
+#endif    // PCL_OCTREE_POINTCLOUD_LINEAR_IMPL_H_
@@ -44,6 +44,11 @@
 
 #include <pcl/common/common.h>
 #include <assert.h>
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 using namespace std;
 
@@ -209,14 +214,294 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::b
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::batchNearestKSearch (
+    const PointCloud &queries, int k, std::vector<int> &offsets, std::vector<int> &k_indices,
+    std::vector<float> &k_sqr_distances) const
+{
+  const int nr_queries = static_cast<int> (queries.points.size ());
+
+  int nr_threads = 1;
+#ifdef _OPENMP
+  nr_threads = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#endif
+
+  std::vector<int> order;
+  sortQueriesByMortonCode (queries, nr_threads, order);
+
+  // results are appended to per-thread buffers and gathered in query order afterwards
+  std::vector<std::vector<int> > thread_indices (nr_threads);
+  std::vector<std::vector<float> > thread_sqr_distances (nr_threads);
+  std::vector<int> result_thread (nr_queries);
+  std::vector<int> result_begin (nr_queries);
+  offsets.assign (nr_queries + 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads (nr_threads)
+#endif
+  {
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num ();
+#endif
+    std::vector<prioPointQueueEntry> pointCandidates;
+
+#ifdef _OPENMP
+#pragma omp for schedule (dynamic, 64)
+#endif
+    for (int i = 0; i < nr_queries; ++i)
+    {
+      const int query = order[i];
+      const PointT& point = queries.points[query];
+
+      result_thread[query] = t;
+      result_begin[query] = static_cast<int> (thread_indices[t].size ());
+
+      if (k < 1 || !isFinite (point))
+        continue;
+
+      OctreeKey key;
+      key.x = key.y = key.z = 0;
+
+      pointCandidates.clear ();
+      getKNearestNeighborRecursive (point, k, this->rootNode_, key, 1, numeric_limits<double>::max (), pointCandidates);
+
+      for (size_t j = 0; j < pointCandidates.size (); ++j)
+      {
+        thread_indices[t].push_back (pointCandidates[j].pointIdx_);
+        thread_sqr_distances[t].push_back (pointCandidates[j].pointDistance_);
+      }
+      offsets[query + 1] = static_cast<int> (pointCandidates.size ());
+    }
+  }
+
+  gatherBatchResults (thread_indices, thread_sqr_distances, result_thread, result_begin, offsets, k_indices,
+                      &k_sqr_distances, nr_threads);
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::batchRadiusSearch (
+    const PointCloud &queries, const double radius, std::vector<int> &offsets, std::vector<int> &k_indices,
+    std::vector<float> &k_sqr_distances, unsigned int max_nn) const
+{
+  const int nr_queries = static_cast<int> (queries.points.size ());
+
+  int nr_threads = 1;
+#ifdef _OPENMP
+  nr_threads = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#endif
+
+  std::vector<int> order;
+  sortQueriesByMortonCode (queries, nr_threads, order);
+
+  // results are appended to per-thread buffers and gathered in query order afterwards
+  std::vector<std::vector<int> > thread_indices (nr_threads);
+  std::vector<std::vector<float> > thread_sqr_distances (nr_threads);
+  std::vector<int> result_thread (nr_queries);
+  std::vector<int> result_begin (nr_queries);
+  offsets.assign (nr_queries + 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads (nr_threads)
+#endif
+  {
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num ();
+#endif
+    std::vector<int> query_indices;
+    std::vector<float> query_sqr_distances;
+
+#ifdef _OPENMP
+#pragma omp for schedule (dynamic, 64)
+#endif
+    for (int i = 0; i < nr_queries; ++i)
+    {
+      const int query = order[i];
+      const PointT& point = queries.points[query];
+
+      result_thread[query] = t;
+      result_begin[query] = static_cast<int> (thread_indices[t].size ());
+
+      if (!isFinite (point))
+        continue;
+
+      OctreeKey key;
+      key.x = key.y = key.z = 0;
+
+      // max_nn is checked against the size of the result vectors, so every query starts with empty ones
+      query_indices.clear ();
+      query_sqr_distances.clear ();
+      getNeighborsWithinRadiusRecursive (point, radius * radius, this->rootNode_, key, 1, query_indices,
+                                         query_sqr_distances, max_nn);
+
+      thread_indices[t].insert (thread_indices[t].end (), query_indices.begin (), query_indices.end ());
+      thread_sqr_distances[t].insert (thread_sqr_distances[t].end (), query_sqr_distances.begin (),
+                                      query_sqr_distances.end ());
+      offsets[query + 1] = static_cast<int> (query_indices.size ());
+    }
+  }
+
+  gatherBatchResults (thread_indices, thread_sqr_distances, result_thread, result_begin, offsets, k_indices,
+                      &k_sqr_distances, nr_threads);
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> int
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::batchBoxSearch (
+    const std::vector<Eigen::Vector3f> &min_pts, const std::vector<Eigen::Vector3f> &max_pts,
+    std::vector<int> &offsets, std::vector<int> &k_indices) const
+{
+  assert (min_pts.size () == max_pts.size ());
+  const int nr_queries = static_cast<int> (min_pts.size ());
+
+  int nr_threads = 1;
+#ifdef _OPENMP
+  nr_threads = this->threads_ ? static_cast<int> (this->threads_) : omp_get_max_threads ();
+#endif
+
+  // search areas are ordered by their centers
+  PointCloud centers;
+  centers.points.resize (nr_queries);
+  for (int i = 0; i < nr_queries; ++i)
+    centers.points[i].getVector3fMap () = (min_pts[i] + max_pts[i]) * 0.5f;
+
+  std::vector<int> order;
+  sortQueriesByMortonCode (centers, nr_threads, order);
+
+  // results are appended to per-thread buffers and gathered in query order afterwards
+  std::vector<std::vector<int> > thread_indices (nr_threads);
+  std::vector<std::vector<float> > thread_sqr_distances;
+  std::vector<int> result_thread (nr_queries);
+  std::vector<int> result_begin (nr_queries);
+  offsets.assign (nr_queries + 1, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule (dynamic, 64) num_threads (nr_threads)
+#endif
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    int t = 0;
+#ifdef _OPENMP
+    t = omp_get_thread_num ();
+#endif
+    const int query = order[i];
+
+    result_thread[query] = t;
+    result_begin[query] = static_cast<int> (thread_indices[t].size ());
+
+    OctreeKey key;
+    key.x = key.y = key.z = 0;
+
+    boxSearchRecursive (min_pts[query], max_pts[query], this->rootNode_, key, 1, thread_indices[t]);
+
+    offsets[query + 1] = static_cast<int> (thread_indices[t].size ()) - result_begin[query];
+  }
+
+  gatherBatchResults (thread_indices, thread_sqr_distances, result_thread, result_begin, offsets, k_indices,
+                      0, nr_threads);
+
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::sortQueriesByMortonCode (
+    const PointCloud &queries, int nr_threads, std::vector<int> &order) const
+{
+  const int nr_queries = static_cast<int> (queries.points.size ());
+
+  // Morton codes hold 21 bits per axis, deeper octrees are ordered by their upper levels
+  const double maxKey = static_cast<double> ((1 << this->octreeDepth_) - 1);
+  const unsigned int shift = this->octreeDepth_ > 21 ? this->octreeDepth_ - 21 : 0;
+
+  std::vector<std::pair<uint64_t, int> > codes (nr_queries);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    const PointT& point = queries.points[i];
+    codes[i].second = i;
+
+    if (!isFinite (point))
+    {
+      codes[i].first = numeric_limits<uint64_t>::max ();
+      continue;
+    }
+
+    OctreeKey key;
+    key.x = static_cast<unsigned int> (std::min (std::max ((point.x - this->minX_) / this->resolution_, 0.0), maxKey)) >> shift;
+    key.y = static_cast<unsigned int> (std::min (std::max ((point.y - this->minY_) / this->resolution_, 0.0), maxKey)) >> shift;
+    key.z = static_cast<unsigned int> (std::min (std::max ((point.z - this->minZ_) / this->resolution_, 0.0), maxKey)) >> shift;
+
+    codes[i].first = this->genMortonCode (key);
+  }
+
+  std::sort (codes.begin (), codes.end ());
+
+  order.resize (nr_queries);
+  for (int i = 0; i < nr_queries; ++i)
+    order[i] = codes[i].second;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT, typename LeafContainerT, typename BranchContainerT> void
+pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::gatherBatchResults (
+    const std::vector<std::vector<int> > &thread_indices,
+    const std::vector<std::vector<float> > &thread_sqr_distances,
+    const std::vector<int> &result_thread, const std::vector<int> &result_begin,
+    std::vector<int> &offsets, std::vector<int> &k_indices,
+    std::vector<float> *k_sqr_distances, int nr_threads)
+{
+  const int nr_queries = static_cast<int> (offsets.size ()) - 1;
+
+  // turn the result counts into offsets
+  for (int i = 0; i < nr_queries; ++i)
+    offsets[i + 1] += offsets[i];
+
+  k_indices.resize (offsets[nr_queries]);
+  if (k_sqr_distances)
+    k_sqr_distances->resize (offsets[nr_queries]);
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+  for (int i = 0; i < nr_queries; ++i)
+  {
+    const int count = offsets[i + 1] - offsets[i];
+    if (!count)
+      continue;
+
+    const std::vector<int>& indices = thread_indices[result_thread[i]];
+    std::copy (indices.begin () + result_begin[i], indices.begin () + result_begin[i] + count,
+               k_indices.begin () + offsets[i]);
+
+    if (k_sqr_distances)
+    {
+      const std::vector<float>& sqr_distances = thread_sqr_distances[result_thread[i]];
+      std::copy (sqr_distances.begin () + result_begin[i], sqr_distances.begin () + result_begin[i] + count,
+                 k_sqr_distances->begin () + offsets[i]);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template<typename PointT, typename LeafContainerT, typename BranchContainerT> double
 pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::getKNearestNeighborRecursive (
     const PointT & point, unsigned int K, const BranchNode* node, const OctreeKey& key, unsigned int treeDepth,
     const double squaredSearchRadius, std::vector<prioPointQueueEntry>& pointCandidates) const
 {
-  std::vector<prioBranchQueueEntry> searchEntryHeap;
-  searchEntryHeap.resize (8);
+  // at most 8 children, kept on the stack
+  prioBranchQueueEntry searchEntryHeap[8];
+  int entryCount = 8;
 
   unsigned char childIdx;
 
@@ -251,20 +536,20 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::g
     }
   }
 
-  std::sort (searchEntryHeap.begin (), searchEntryHeap.end ());
+  std::sort (searchEntryHeap, searchEntryHeap + entryCount);
 
   // iterate over all children in priority queue
   // check if the distance to search candidate is smaller than the best point distance (smallestSquaredDist)
-  while ((!searchEntryHeap.empty ())
-      && (searchEntryHeap.back ().pointDistance
+  while ((entryCount > 0)
+      && (searchEntryHeap[entryCount - 1].pointDistance
           < smallestSquaredDist + voxelSquaredDiameter / 4.0 + sqrt (smallestSquaredDist * voxelSquaredDiameter)
               - this->epsilon_))
   {
     const OctreeNode* childNode;
 
     // read from priority queue element
-    childNode = searchEntryHeap.back ().node;
-    newKey = searchEntryHeap.back ().key;
+    childNode = searchEntryHeap[entryCount - 1].node;
+    newKey = searchEntryHeap[entryCount - 1].key;
 
     if (treeDepth < this->octreeDepth_)
     {
@@ -314,7 +599,7 @@ pcl::octree::OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::g
         smallestSquaredDist = pointCandidates.back ().pointDistance_;
     }
     // pop element from priority queue
-    searchEntryHeap.pop_back ();
+    --entryCount;
   }
 
   return (smallestSquaredDist);
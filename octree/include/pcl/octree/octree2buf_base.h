@@ -900,6 +900,14 @@ namespace pcl
           return (false);
         }
 
+        /** \brief Test if octree can be built bottom-up from Morton sorted octree keys.
+         *  \return "false" - new leaf nodes have to be matched against the previous buffer
+         **/
+        inline bool octreeCanBulkBuild () const
+        {
+          return (false);
+        }
+
         /** \brief Prints binary representation of a byte - used for debugging
          *  \param data_arg - byte to be printed to stdout
          **/
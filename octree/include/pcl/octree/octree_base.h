@@ -676,6 +676,15 @@ namespace pcl
           return (true);
         }
 
+        /** \brief Test if octree can be built bottom-up from Morton sorted octree keys. This requires an empty octree with fixed depth.
+         *  \return "true" if the root node has no children and dynamic depth is disabled
+         **/
+        inline bool
+        octreeCanBulkBuild () const
+        {
+          return ((!maxObjsPerLeaf_) && (!getBranchBitPattern (*rootNode_)));
+        }
+
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Globals
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
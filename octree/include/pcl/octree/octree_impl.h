@@ -46,5 +46,6 @@
 #include <pcl/octree/impl/octree_pointcloud.hpp>
 #include <pcl/octree/impl/octree_iterator.hpp>
 #include <pcl/octree/impl/octree_search.hpp>
+#include <pcl/octree/impl/octree_pointcloud_linear.hpp>
 
 #endif
@@ -42,6 +42,10 @@
 
 #include <pcl/pcl_macros.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace pcl
 {
   namespace octree
@@ -105,6 +109,35 @@ namespace pcl
           return newLeafNode;
         }
 
+        /** \brief Pop a number of nodes from pool - Allocates the nodes missing in the pool in parallel
+        *  \param count_arg: number of nodes to pop
+        *  \param nodes_arg: receives the pointers to the octree nodes
+        *  \param threads_arg: number of threads used for the allocation (0: automatic)
+        *  */
+        void
+        popNodes (std::size_t count_arg, std::vector<NodeT*>& nodes_arg, unsigned int threads_arg = 0)
+        {
+          nodes_arg.resize (count_arg);
+
+          // reuse nodes from pool first
+          std::size_t reused = 0;
+          while ((reused < count_arg) && !nodePool_.empty ())
+          {
+            nodes_arg[reused] = nodePool_.back ();
+            nodePool_.pop_back ();
+            nodes_arg[reused]->reset ();
+            ++reused;
+          }
+
+          // node allocation is thread-safe and dominates large bulk builds
+#ifdef _OPENMP
+          const int nr_threads = threads_arg ? static_cast<int> (threads_arg) : omp_get_max_threads ();
+#pragma omp parallel for num_threads (nr_threads)
+#endif
+          for (int i = static_cast<int> (reused); i < static_cast<int> (count_arg); ++i)
+            nodes_arg[i] = new NodeT ();
+        }
+
 
         /** \brief Delete all nodes in pool
         *  */
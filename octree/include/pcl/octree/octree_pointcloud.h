@@ -210,6 +210,25 @@ namespace pcl
         void
         addPointsFromInputCloud ();
 
+        /** \brief Add points from input point cloud to an empty octree in one bulk operation.
+         * \note The octree keys of all points are computed in parallel and sorted by their Morton code. The leaf and
+         * \note branch nodes are then fetched from the octree node pools and linked bottom-up, level by level in parallel.
+         * \note The bounding box is grown once to the extent of the input cloud. If the octree is not empty, uses a
+         * \note dynamic depth, is double-buffered or deeper than 21 levels, the points are added one by one instead.
+         */
+        void
+        addPointsFromInputCloudBulk ();
+
+        /** \brief Set the number of threads used by addPointsFromInputCloudBulk () and by the batch searches of
+         * OctreePointCloudSearch.
+         * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+         */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
         /** \brief Add point at given index from input point cloud to octree. Index will be also added to indices vector.
          * \param[in] pointIdx_arg index of point to be added
          * \param[in] indices_arg pointer to indices vector of the dataset (given by \a setInputCloud)
@@ -415,6 +434,40 @@ namespace pcl
         const PointT&
         getPointByIndex (const unsigned int index_arg) const;
 
+        /** \brief Add point at index from input pointcloud dataset to a leaf node created by addPointsFromInputCloudBulk ().
+         * \param[in] leaf_arg the leaf node addressed by the point
+         * \param[in] pointIdx_arg the index representing the point in the dataset given by \a setInputCloud
+         */
+        virtual void
+        addPointIdxToLeaf (LeafNode& leaf_arg, const int pointIdx_arg)
+        {
+          leaf_arg.setData (pointIdx_arg);
+        }
+
+        /** \brief Interleave the bits of an octree key. The 3-bit groups of the result are the child node indices from the root
+         * \note down to the leaf node, so that sorting by this code orders leaf nodes depth-first. Supports up to 21 key bits.
+         * \param[in] key_arg octree key addressing a leaf node
+         * \return Morton code of the key
+         */
+        static inline uint64_t
+        genMortonCode (const OctreeKey& key_arg)
+        {
+          return ((spreadKeyBits (key_arg.x) << 2) | (spreadKeyBits (key_arg.y) << 1) | spreadKeyBits (key_arg.z));
+        }
+
+        /** \brief Insert two zero bits in front of each of the lower 21 bits of a key coordinate. */
+        static inline uint64_t
+        spreadKeyBits (uint32_t value_arg)
+        {
+          uint64_t x = value_arg & 0x1fffff;
+          x = (x | x << 32) & 0x1f00000000ffffull;
+          x = (x | x << 16) & 0x1f0000ff0000ffull;
+          x = (x | x << 8) & 0x100f00f00f00f00full;
+          x = (x | x << 4) & 0x10c30c30c30c30c3ull;
+          x = (x | x << 2) & 0x1249249249249249ull;
+          return (x);
+        }
+
         /** \brief Find octree leaf node at a given point
          * \param[in] point_arg query point
          * \return pointer to leaf node. If leaf node does not exist, pointer is 0.
@@ -548,6 +601,9 @@ namespace pcl
 
         /** \brief Flag indicating if octree has defined bounding box. */
         bool boundingBoxDefined_;
+
+        /** \brief The number of threads used by bulk builds and batch searches. */
+        unsigned int threads_;
     };
   }
 }
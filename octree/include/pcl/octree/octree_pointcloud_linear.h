@@ -0,0 +1,726 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2011, Willow Garage, Inc.
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_OCTREE_POINTCLOUD_LINEAR_H_
+#define PCL_OCTREE_POINTCLOUD_LINEAR_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include "octree_key.h"
+
+#include <utility>
+#include <vector>
+
+namespace pcl
+{
+  namespace octree
+  {
+    /** \brief @b Linear (pointer-free) octree pointcloud search class
+      * \note This class stores an octree in two contiguous arrays: the nodes, level by level, and the point
+      * \note indices, sorted in Morton order of their leaf keys. Every node references its children by a child
+      * \note bit mask and the offset of its first child, and its points by a range of the index array, so that
+      * \note all points below a node are stored consecutively. The octree is built once from the input cloud
+      * \note and is meant for read-mostly maps; use OctreePointCloudSearch if points have to be added or removed.
+      * \note The search methods return the same results as OctreePointCloudSearch for the same bounding box.
+      * \note typename: PointT: type of point used in pointcloud
+      * \ingroup octree
+      */
+    template<typename PointT>
+    class OctreePointCloudLinear
+    {
+      public:
+        // public typedefs
+        typedef boost::shared_ptr<std::vector<int> > IndicesPtr;
+        typedef boost::shared_ptr<const std::vector<int> > IndicesConstPtr;
+
+        typedef pcl::PointCloud<PointT> PointCloud;
+        typedef boost::shared_ptr<PointCloud> PointCloudPtr;
+        typedef boost::shared_ptr<const PointCloud> PointCloudConstPtr;
+
+        // Boost shared pointers
+        typedef boost::shared_ptr<OctreePointCloudLinear<PointT> > Ptr;
+        typedef boost::shared_ptr<const OctreePointCloudLinear<PointT> > ConstPtr;
+
+        // Eigen aligned allocator
+        typedef std::vector<PointT, Eigen::aligned_allocator<PointT> > AlignedPointTVector;
+
+        /** \brief @b Node of the linear octree.
+          * \note The children of a node are stored consecutively in ascending child index order, starting at
+          * \note \a child_offset. \a child_mask has bit i set if the child with index i exists.
+          */
+        struct LinearNode
+        {
+          /** \brief Position of the first child node in the node array. */
+          uint32_t child_offset;
+
+          /** \brief First position in the point index array of the points within this node. */
+          uint32_t point_begin;
+
+          /** \brief Position after the last point within this node in the point index array. */
+          uint32_t point_end;
+
+          /** \brief Bit pattern of the existing children. */
+          uint32_t child_mask;
+        };
+
+        /** \brief Constructor.
+          * \param[in] resolution octree resolution at lowest octree level
+          */
+        OctreePointCloudLinear (const double resolution);
+
+        /** \brief Empty deconstructor. */
+        virtual
+        ~OctreePointCloudLinear ()
+        {
+        }
+
+        /** \brief Provide a pointer to the input data set.
+          * \param[in] cloud_arg the const boost shared pointer to a PointCloud message
+          * \param[in] indices_arg the point indices subset that is to be used from \a cloud - if 0 the whole point cloud is used
+          */
+        inline void
+        setInputCloud (const PointCloudConstPtr &cloud_arg, const IndicesConstPtr &indices_arg = IndicesConstPtr ())
+        {
+          input_ = cloud_arg;
+          indices_ = indices_arg;
+        }
+
+        /** \brief Get a pointer to the vector of indices used.
+          * \return pointer to vector of indices used.
+          */
+        inline IndicesConstPtr const
+        getIndices () const
+        {
+          return (indices_);
+        }
+
+        /** \brief Get a pointer to the input point cloud dataset.
+          * \return pointer to pointcloud input class.
+          */
+        inline PointCloudConstPtr
+        getInputCloud () const
+        {
+          return (input_);
+        }
+
+        /** \brief Set the search epsilon precision (error bound) for nearest neighbors searches.
+          * \param[in] eps precision (error bound) for nearest neighbors searches
+          */
+        inline void
+        setEpsilon (double eps)
+        {
+          epsilon_ = eps;
+        }
+
+        /** \brief Get the search epsilon precision (error bound) for nearest neighbors searches. */
+        inline double
+        getEpsilon () const
+        {
+          return (epsilon_);
+        }
+
+        /** \brief Get octree voxel resolution
+          * \return voxel resolution at lowest tree level
+          */
+        inline double
+        getResolution () const
+        {
+          return (resolution_);
+        }
+
+        /** \brief Get the maximum depth of the octree.
+          * \return depth of the octree
+          */
+        inline unsigned int
+        getTreeDepth () const
+        {
+          return (octreeDepth_);
+        }
+
+        /** \brief Get the number of occupied leaf voxels. */
+        inline std::size_t
+        getLeafCount () const
+        {
+          return (leafCount_);
+        }
+
+        /** \brief Get the number of branch nodes, including the root node. */
+        inline std::size_t
+        getBranchCount () const
+        {
+          return (nodes_.size () - leafCount_);
+        }
+
+        /** \brief Get the node array of the octree. The root node is stored at position 0 if the octree is not empty. */
+        inline const std::vector<LinearNode>&
+        getNodes () const
+        {
+          return (nodes_);
+        }
+
+        /** \brief Get the point indices of the octree in Morton order of their leaf voxels. */
+        inline const std::vector<int>&
+        getPointIndices () const
+        {
+          return (point_indices_);
+        }
+
+        /** \brief Define bounding box for octree
+          * \note Bounding box cannot be changed once the octree contains elements.
+          * \param[in] minX_arg X coordinate of lower bounding box corner
+          * \param[in] minY_arg Y coordinate of lower bounding box corner
+          * \param[in] minZ_arg Z coordinate of lower bounding box corner
+          * \param[in] maxX_arg X coordinate of upper bounding box corner
+          * \param[in] maxY_arg Y coordinate of upper bounding box corner
+          * \param[in] maxZ_arg Z coordinate of upper bounding box corner
+          */
+        void
+        defineBoundingBox (const double minX_arg, const double minY_arg, const double minZ_arg,
+                           const double maxX_arg, const double maxY_arg, const double maxZ_arg);
+
+        /** \brief Get bounding box for octree
+          * \param[out] minX_arg X coordinate of lower bounding box corner
+          * \param[out] minY_arg Y coordinate of lower bounding box corner
+          * \param[out] minZ_arg Z coordinate of lower bounding box corner
+          * \param[out] maxX_arg X coordinate of upper bounding box corner
+          * \param[out] maxY_arg Y coordinate of upper bounding box corner
+          * \param[out] maxZ_arg Z coordinate of upper bounding box corner
+          */
+        void
+        getBoundingBox (double& minX_arg, double& minY_arg, double& minZ_arg,
+                        double& maxX_arg, double& maxY_arg, double& maxZ_arg) const;
+
+        /** \brief Build the octree from all finite points of the input point cloud. If no bounding box was defined,
+          * it is fitted to the input points. Points outside of a predefined bounding box are ignored.
+          */
+        void
+        addPointsFromInputCloud ();
+
+        /** \brief Delete the octree structure and the bounding box. */
+        void
+        deleteTree ();
+
+        /** \brief Serialize the octree structure, the bounding box and the point indices into a single binary blob.
+          * \note The input point cloud is not serialized.
+          * \param[out] binary_out the binary output buffer
+          */
+        void
+        serializeTree (std::vector<char>& binary_out) const;
+
+        /** \brief Restore an octree which was serialized by serializeTree (). The point cloud the octree was
+          * built from has to be provided separately by setInputCloud (). Child offsets and point ranges are checked
+          * against the buffer; point indices are checked against the input cloud if it is already set. The octree is
+          * left unchanged if the check fails.
+          * \param[in] binary_in the binary input buffer
+          * \return "true" if the buffer holds a valid octree; "false" otherwise
+          */
+        bool
+        deserializeTree (const std::vector<char>& binary_in);
+
+        /** \brief Search for neighbors within a voxel at given point
+          * \param[in] point point addressing a leaf node voxel
+          * \param[out] pointIdx_data the resultant indices of the neighboring voxel points
+          * \return "true" if leaf node exist; "false" otherwise
+          */
+        bool
+        voxelSearch (const PointT& point, std::vector<int>& pointIdx_data) const;
+
+        /** \brief Search for neighbors within a voxel at given point referenced by a point index
+          * \param[in] index the index in input cloud defining the query point
+          * \param[out] pointIdx_data the resultant indices of the neighboring voxel points
+          * \return "true" if leaf node exist; "false" otherwise
+          */
+        inline bool
+        voxelSearch (const int index, std::vector<int>& pointIdx_data) const
+        {
+          return (voxelSearch (getPointByIndex (index), pointIdx_data));
+        }
+
+        /** \brief Search for k-nearest neighbors at the query point.
+          * \param[in] cloud the point cloud data
+          * \param[in] index the index in \a cloud representing the query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (const PointCloud &cloud, int index, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const
+        {
+          return (nearestKSearch (cloud[index], k, k_indices, k_sqr_distances));
+        }
+
+        /** \brief Search for k-nearest neighbors at given query point.
+          * \param[in] p_q the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances  the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &p_q, int k, std::vector<int> &k_indices,
+                        std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for k-nearest neighbors at query point
+          * \param[in] index index representing the query point in the dataset given by \a setInputCloud.
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        inline int
+        nearestKSearch (int index, int k, std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const
+        {
+          return (nearestKSearch (getPointByIndex (index), k, k_indices, k_sqr_distances));
+        }
+
+        /** \brief Search for approx. nearest neighbor at the query point.
+          * \param[in] p_q the given query point
+          * \param[out] result_index the resultant index of the neighbor point
+          * \param[out] sqr_distance the resultant squared distance to the neighboring point
+          */
+        void
+        approxNearestSearch (const PointT &p_q, int &result_index, float &sqr_distance) const;
+
+        /** \brief Search for approx. nearest neighbor at the query point.
+          * \param[in] query_index index representing the query point in the dataset given by \a setInputCloud.
+          * \param[out] result_index the resultant index of the neighbor point
+          * \param[out] sqr_distance the resultant squared distance to the neighboring point
+          */
+        inline void
+        approxNearestSearch (int query_index, int &result_index, float &sqr_distance) const
+        {
+          approxNearestSearch (getPointByIndex (query_index), result_index, sqr_distance);
+        }
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \param[in] cloud the point cloud data
+          * \param[in] index the index in \a cloud representing the query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (const PointCloud &cloud, int index, double radius,
+                      std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const
+        {
+          return (radiusSearch (cloud.points[index], radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \param[in] p_q the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT &p_q, const double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const;
+
+        /** \brief Search for all neighbors of query point that are within a given radius.
+          * \param[in] index index representing the query point in the dataset given by \a setInputCloud.
+          * \param[in] radius radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value
+          * \return number of neighbors found in radius
+          */
+        inline int
+        radiusSearch (int index, const double radius, std::vector<int> &k_indices,
+                      std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const
+        {
+          return (radiusSearch (getPointByIndex (index), radius, k_indices, k_sqr_distances, max_nn));
+        }
+
+        /** \brief Search for points within rectangular search area
+          * \param[in] min_pt lower corner of search area
+          * \param[in] max_pt upper corner of search area
+          * \param[out] k_indices the resultant point indices
+          * \return number of points found within search area
+          */
+        int
+        boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, std::vector<int> &k_indices) const;
+
+        /** \brief Get a PointT vector of centers of all voxels that intersected by a ray (origin, direction).
+          * \param[in] origin ray origin
+          * \param[in] direction ray direction vector
+          * \param[out] voxelCenterList results are written to this vector of PointT elements
+          * \param[in] maxVoxelCount stop raycasting when this many voxels intersected (0: disable)
+          * \return number of intersected voxels
+          */
+        int
+        getIntersectedVoxelCenters (Eigen::Vector3f origin, Eigen::Vector3f direction,
+                                    AlignedPointTVector &voxelCenterList, int maxVoxelCount = 0) const;
+
+        /** \brief Get indices of all voxels that are intersected by a ray (origin, direction).
+          * \param[in] origin ray origin
+          * \param[in] direction ray direction vector
+          * \param[out] k_indices resulting point indices from intersected voxels
+          * \param[in] maxVoxelCount stop raycasting when this many voxels intersected (0: disable)
+          * \return number of intersected voxels
+          */
+        int
+        getIntersectedVoxelIndices (Eigen::Vector3f origin, Eigen::Vector3f direction,
+                                    std::vector<int> &k_indices, int maxVoxelCount = 0) const;
+
+        /** \brief Calculates the squared diameter of a voxel at given tree depth
+          * \param[in] treeDepth_arg depth/level in octree
+          * \return squared diameter
+          */
+        inline double
+        getVoxelSquaredDiameter (unsigned int treeDepth_arg) const
+        {
+          const double sideLen = resolution_ * static_cast<double> (1 << (octreeDepth_ - treeDepth_arg));
+          return (sideLen * sideLen * 3.0);
+        }
+
+      protected:
+        /** \brief @b Priority queue entry for child nodes in the nearest neighbor search. */
+        struct prioNodeQueueEntry
+        {
+          /** \brief Operator< sorting entries by decreasing distance. */
+          bool
+          operator < (const prioNodeQueueEntry& rhs) const
+          {
+            return (this->pointDistance > rhs.pointDistance);
+          }
+
+          /** \brief Position of the node in the node array. */
+          uint32_t node;
+
+          /** \brief Distance of the voxel center to the query point. */
+          float pointDistance;
+
+          /** \brief Octree key. */
+          OctreeKey key;
+        };
+
+        /** \brief @b Priority queue entry for point candidates in the nearest neighbor search. */
+        struct prioPointQueueEntry
+        {
+          /** \brief Operator< sorting entries by increasing distance. */
+          bool
+          operator < (const prioPointQueueEntry& rhs) const
+          {
+            return (this->pointDistance_ < rhs.pointDistance_);
+          }
+
+          /** \brief Index representing a point in the dataset given by \a setInputCloud. */
+          int pointIdx_;
+
+          /** \brief Distance to query point. */
+          float pointDistance_;
+        };
+
+        /** \brief Get point at index from input pointcloud dataset
+          * \param[in] index_arg index representing the point in the dataset given by \a setInputCloud
+          * \return PointT from input pointcloud dataset
+          */
+        inline const PointT&
+        getPointByIndex (const unsigned int index_arg) const
+        {
+          assert (index_arg < static_cast<unsigned int> (input_->points.size ()));
+          return (input_->points[index_arg]);
+        }
+
+        /** \brief Get the position of an existing child in the node array.
+          * \param[in] node the parent node
+          * \param[in] childIdx index of the child (0..7)
+          * \return position of the child node
+          */
+        inline uint32_t
+        getChildPosition (const LinearNode& node, unsigned char childIdx) const
+        {
+          // count the existing children in front of childIdx
+          uint32_t lower = node.child_mask & ((1u << childIdx) - 1u);
+          lower = (lower & 0x55u) + ((lower >> 1) & 0x55u);
+          lower = (lower & 0x33u) + ((lower >> 2) & 0x33u);
+          lower = (lower & 0x0Fu) + ((lower >> 4) & 0x0Fu);
+          return (node.child_offset + lower);
+        }
+
+        /** \brief Generate the key of a child voxel.
+          * \param[in] key key of the parent voxel
+          * \param[in] childIdx index of the child (0..7)
+          * \param[out] childKey key of the child voxel
+          */
+        static inline void
+        genChildKey (const OctreeKey& key, unsigned char childIdx, OctreeKey& childKey)
+        {
+          childKey.x = (key.x << 1) | (!!(childIdx & (1 << 2)));
+          childKey.y = (key.y << 1) | (!!(childIdx & (1 << 1)));
+          childKey.z = (key.z << 1) | (!!(childIdx & (1 << 0)));
+        }
+
+        /** \brief Leaf key of a point and its index in the input cloud. */
+        typedef std::pair<OctreeKey, int> KeyIndexPair;
+
+        /** \brief Compare two points by the position of their leaf keys on the Morton (Z-order) curve and by
+          * their index if both points fall into the same leaf voxel.
+          * \note The x coordinate carries the most significant bit of the child index on each level.
+          */
+        static bool
+        isMortonLess (const KeyIndexPair& a, const KeyIndexPair& b);
+
+        /** \brief Fit the bounding box to the input points and derive the octree depth from it. */
+        void
+        fitBoundingBox ();
+
+        /** \brief Derive the octree depth from the bounding box and pad the bounding box to a cube. */
+        void
+        getKeyBitSize ();
+
+        /** \brief Generate octree key for voxel at a given point
+          * \param[in] point_arg the point addressing a voxel
+          * \param[out] key_arg write octree key to this reference
+          */
+        inline void
+        genOctreeKeyforPoint (const PointT & point_arg, OctreeKey & key_arg) const
+        {
+          key_arg.x = static_cast<unsigned int> ((point_arg.x - minX_) / resolution_);
+          key_arg.y = static_cast<unsigned int> ((point_arg.y - minY_) / resolution_);
+          key_arg.z = static_cast<unsigned int> ((point_arg.z - minZ_) / resolution_);
+        }
+
+        /** \brief Generate a point at the center of a voxel given its key and tree depth.
+          * \param[in] key_arg octree key addressing a voxel
+          * \param[in] treeDepth_arg octree depth of the voxel
+          * \param[out] point_arg voxel center point
+          */
+        void
+        genVoxelCenterFromOctreeKey (const OctreeKey & key_arg, unsigned int treeDepth_arg, PointT& point_arg) const;
+
+        /** \brief Generate the bounds of a voxel given its key and tree depth.
+          * \param[in] key_arg octree key addressing a voxel
+          * \param[in] treeDepth_arg octree depth of the voxel
+          * \param[out] min_pt lower bound of voxel
+          * \param[out] max_pt upper bound of voxel
+          */
+        void
+        genVoxelBoundsFromOctreeKey (const OctreeKey & key_arg, unsigned int treeDepth_arg,
+                                     Eigen::Vector3f &min_pt, Eigen::Vector3f &max_pt) const;
+
+        /** \brief Helper function to calculate the squared distance between two points
+          * \param[in] pointA point A
+          * \param[in] pointB point B
+          * \return squared distance between point A and point B
+          */
+        inline float
+        pointSquaredDist (const PointT& pointA, const PointT& pointB) const
+        {
+          return ((pointA.getVector3fMap () - pointB.getVector3fMap ()).squaredNorm ());
+        }
+
+        /** \brief Recursive search method that finds neighbors within a given radius
+          * \param[in] point query point
+          * \param[in] radiusSquared squared search radius
+          * \param[in] node position of the current node in the node array
+          * \param[in] key octree key addressing the current node
+          * \param[in] treeDepth depth/level of the children of the current node
+          * \param[out] k_indices vector of indices found to be neighbors of query point
+          * \param[out] k_sqr_distances squared distances of neighbors to query point
+          * \param[in] max_nn maximum of neighbors to be found
+          * \return "true" if max_nn neighbors were found
+          */
+        bool
+        getNeighborsWithinRadiusRecursive (const PointT& point, const double radiusSquared, uint32_t node,
+                                           const OctreeKey& key, unsigned int treeDepth,
+                                           std::vector<int>& k_indices, std::vector<float>& k_sqr_distances,
+                                           unsigned int max_nn) const;
+
+        /** \brief Collect all points of a node range which are within a given radius
+          * \param[in] point query point
+          * \param[in] radiusSquared squared search radius
+          * \param[in] node the node holding the candidate points
+          * \param[out] k_indices vector of indices found to be neighbors of query point
+          * \param[out] k_sqr_distances squared distances of neighbors to query point
+          * \param[in] max_nn maximum of neighbors to be found
+          * \return "true" if max_nn neighbors were found
+          */
+        bool
+        getPointsWithinRadius (const PointT& point, const double radiusSquared, const LinearNode& node,
+                               std::vector<int>& k_indices, std::vector<float>& k_sqr_distances,
+                               unsigned int max_nn) const;
+
+        /** \brief Recursive search method that finds the K nearest neighbors
+          * \param[in] point query point
+          * \param[in] K amount of nearest neighbors to be found
+          * \param[in] node position of the current node in the node array
+          * \param[in] key octree key addressing the current node
+          * \param[in] treeDepth depth/level of the children of the current node
+          * \param[in] squaredSearchRadius squared search radius distance
+          * \param[out] pointCandidates priority queue of nearest neigbor point candidates
+          * \return squared search radius based on current point candidate set found
+          */
+        double
+        getKNearestNeighborRecursive (const PointT& point, unsigned int K, uint32_t node, const OctreeKey& key,
+                                      unsigned int treeDepth, const double squaredSearchRadius,
+                                      std::vector<prioPointQueueEntry>& pointCandidates) const;
+
+        /** \brief Recursive search method that finds points within a rectangular search area
+          * \param[in] min_pt lower corner of search area
+          * \param[in] max_pt upper corner of search area
+          * \param[in] node position of the current node in the node array
+          * \param[in] key octree key addressing the current node
+          * \param[in] treeDepth depth/level of the children of the current node
+          * \param[out] k_indices the resultant point indices
+          */
+        void
+        boxSearchRecursive (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, uint32_t node,
+                            const OctreeKey& key, unsigned int treeDepth, std::vector<int>& k_indices) const;
+
+        /** \brief Recursively search the tree for all intersected leaf nodes.
+          * This algorithm is based off the paper An Efficient Parametric Algorithm for Octree Traversal:
+          * http://wscg.zcu.cz/wscg2000/Papers_2000/X31.pdf
+          * \param[in] minX octree nodes X coordinate of lower bounding box corner
+          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
+          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
+          * \param[in] maxX octree nodes X coordinate of upper bounding box corner
+          * \param[in] maxY octree nodes Y coordinate of upper bounding box corner
+          * \param[in] maxZ octree nodes Z coordinate of upper bounding box corner
+          * \param[in] a child index remapping of negative ray directions
+          * \param[in] node position of the current node in the node array
+          * \param[in] key octree key addressing the current node
+          * \param[in] treeDepth depth/level of the current node
+          * \param[out] voxelCenterList if given, the intersected leaf voxel centers are appended to it
+          * \param[out] k_indices if given, the point indices of the intersected leaf voxels are appended to it
+          * \param[in] maxVoxelCount stop raycasting when this many voxels intersected (0: disable)
+          * \return number of voxels found
+          */
+        int
+        getIntersectedVoxelsRecursive (double minX, double minY, double minZ, double maxX, double maxY,
+                                       double maxZ, unsigned char a, uint32_t node, const OctreeKey& key,
+                                       unsigned int treeDepth, AlignedPointTVector* voxelCenterList,
+                                       std::vector<int>* k_indices, int maxVoxelCount) const;
+
+        /** \brief Initialize raytracing algorithm
+          * \param origin
+          * \param direction
+          * \param[out] minX octree nodes X coordinate of lower bounding box corner
+          * \param[out] minY octree nodes Y coordinate of lower bounding box corner
+          * \param[out] minZ octree nodes Z coordinate of lower bounding box corner
+          * \param[out] maxX octree nodes X coordinate of upper bounding box corner
+          * \param[out] maxY octree nodes Y coordinate of upper bounding box corner
+          * \param[out] maxZ octree nodes Z coordinate of upper bounding box corner
+          * \param a
+          */
+        void
+        initIntersectedVoxel (Eigen::Vector3f &origin, Eigen::Vector3f &direction,
+                              double &minX, double &minY, double &minZ,
+                              double &maxX, double &maxY, double &maxZ,
+                              unsigned char &a) const;
+
+        /** \brief Find first child node ray will enter
+          * \param[in] minX octree nodes X coordinate of lower bounding box corner
+          * \param[in] minY octree nodes Y coordinate of lower bounding box corner
+          * \param[in] minZ octree nodes Z coordinate of lower bounding box corner
+          * \param[in] midX octree nodes X coordinate of bounding box mid line
+          * \param[in] midY octree nodes Y coordinate of bounding box mid line
+          * \param[in] midZ octree nodes Z coordinate of bounding box mid line
+          * \return the first child node ray will enter
+          */
+        static int
+        getFirstIntersectedNode (double minX, double minY, double minZ, double midX, double midY, double midZ);
+
+        /** \brief Get the next visited node given the current node upper bounding box corner.
+          * \param[in] x current nodes X coordinate of upper bounding box corner
+          * \param[in] y current nodes Y coordinate of upper bounding box corner
+          * \param[in] z current nodes Z coordinate of upper bounding box corner
+          * \param[in] a next node if exit Plane YZ
+          * \param[in] b next node if exit Plane XZ
+          * \param[in] c next node if exit Plane XY
+          * \return the next child node ray will enter or 8 if exiting
+          */
+        static inline int
+        getNextIntersectedNode (double x, double y, double z, int a, int b, int c)
+        {
+          if (x < y)
+            return (x < z ? a : c);
+          return (y < z ? b : c);
+        }
+
+        /** \brief Pointer to input point cloud dataset. */
+        PointCloudConstPtr input_;
+
+        /** \brief A pointer to the vector of point indices to use. */
+        IndicesConstPtr indices_;
+
+        /** \brief Epsilon precision (error bound) for nearest neighbors searches. */
+        double epsilon_;
+
+        /** \brief Octree resolution. */
+        double resolution_;
+
+        // Octree bounding box coordinates
+        double minX_;
+        double maxX_;
+
+        double minY_;
+        double maxY_;
+
+        double minZ_;
+        double maxZ_;
+
+        /** \brief Flag indicating if octree has defined bounding box. */
+        bool boundingBoxDefined_;
+
+        /** \brief Octree depth. */
+        unsigned int octreeDepth_;
+
+        /** \brief Amount of leaf nodes. */
+        std::size_t leafCount_;
+
+        /** \brief Octree nodes, level by level and in Morton order within each level. */
+        std::vector<LinearNode> nodes_;
+
+        /** \brief Point indices in Morton order of their leaf voxels. */
+        std::vector<int> point_indices_;
+    };
+  }
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudLinear(T) template class PCL_EXPORTS pcl::octree::OctreePointCloudLinear<T>;
+
+#endif    // PCL_OCTREE_POINTCLOUD_LINEAR_H_
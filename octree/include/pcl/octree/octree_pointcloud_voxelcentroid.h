@@ -179,6 +179,17 @@ namespace pcl
           }
         }
 
+        /** \brief Add the point at a given index to the centroid of a leaf node created by a bulk build.
+          * \param[in] leaf_arg the leaf node addressed by the point
+          * \param[in] pointIdx_arg index of the point in the input cloud
+          */
+        virtual void
+        addPointIdxToLeaf (LeafNode& leaf_arg, const int pointIdx_arg)
+        {
+          LeafContainerT* container = &leaf_arg;
+          container->addPoint (this->getPointByIndex (pointIdx_arg));
+        }
+
         /** \brief Get centroid for a single voxel addressed by a PointT point.
           * \param[in] point_arg point addressing a voxel in octree
           * \param[out] voxel_centroid_arg centroid is written to this PointT reference
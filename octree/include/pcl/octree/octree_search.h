@@ -259,6 +259,51 @@ namespace pcl
         int
         boxSearch (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt, std::vector<int> &k_indices) const;
 
+        /** \brief Search for k-nearest neighbors of a batch of query points.
+          * \note The queries are processed in Morton order of their octree keys, so that consecutive queries traverse
+          * \note the same branch nodes, and are distributed over the threads given by setNumberOfThreads ().
+          * \note The results are returned in compressed sparse row layout: the neighbors of query i are stored at
+          * \note positions offsets[i] to offsets[i+1]-1 of k_indices and k_sqr_distances. Invalid (NaN, Inf)
+          * \note query points have no neighbors.
+          * \param[in] queries the query points
+          * \param[in] k the number of neighbors to search for
+          * \param[out] offsets the position of the first neighbor of each query, followed by the total number of neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return total number of neighbors found
+          */
+        int
+        batchNearestKSearch (const PointCloud &queries, int k, std::vector<int> &offsets,
+                             std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Search for all neighbors within a given radius of a batch of query points.
+          * \note The queries are processed in Morton order and in parallel, see batchNearestKSearch ().
+          * \param[in] queries the query points
+          * \param[in] radius the radius of the sphere bounding all neighbors of a query point
+          * \param[out] offsets the position of the first neighbor of each query, followed by the total number of neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors of each query to this value
+          * \return total number of neighbors found
+          */
+        int
+        batchRadiusSearch (const PointCloud &queries, const double radius, std::vector<int> &offsets,
+                           std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                           unsigned int max_nn = 0) const;
+
+        /** \brief Search for points within a batch of rectangular search areas.
+          * \note The search areas are processed in Morton order of their centers and in parallel, see
+          * \note batchNearestKSearch ().
+          * \param[in] min_pts lower corners of the search areas
+          * \param[in] max_pts upper corners of the search areas
+          * \param[out] offsets the position of the first point of each search area, followed by the total number of points
+          * \param[out] k_indices the resultant point indices
+          * \return total number of points found
+          */
+        int
+        batchBoxSearch (const std::vector<Eigen::Vector3f> &min_pts, const std::vector<Eigen::Vector3f> &max_pts,
+                        std::vector<int> &offsets, std::vector<int> &k_indices) const;
+
       protected:
         //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
         // Octree-based search routines & helpers
@@ -344,6 +389,32 @@ namespace pcl
             float pointDistance_;
         };
 
+        /** \brief Sort query points by the Morton code of their octree keys. Query points outside of the bounding
+          * box are clamped to it and invalid query points are moved to the end.
+          * \param[in] queries the query points
+          * \param[in] nr_threads the number of threads used to compute the Morton codes
+          * \param[out] order the indices of the query points in Morton order
+          */
+        void
+        sortQueriesByMortonCode (const PointCloud &queries, int nr_threads, std::vector<int> &order) const;
+
+        /** \brief Concatenate the per-thread results of a batch search in query order.
+          * \param[in] thread_indices the result indices appended by each thread
+          * \param[in] thread_sqr_distances the result distances appended by each thread, may be empty for box searches
+          * \param[in] result_thread the thread which processed each query
+          * \param[in] result_begin the position of the first result of each query in the buffer of its thread
+          * \param[in,out] offsets the number of results of query i at position i+1, replaced by the result offsets
+          * \param[out] k_indices the concatenated result indices
+          * \param[out] k_sqr_distances the concatenated result distances, or 0 for box searches
+          * \param[in] nr_threads the number of threads used to copy the results
+          */
+        static void
+        gatherBatchResults (const std::vector<std::vector<int> > &thread_indices,
+                            const std::vector<std::vector<float> > &thread_sqr_distances,
+                            const std::vector<int> &result_thread, const std::vector<int> &result_begin,
+                            std::vector<int> &offsets, std::vector<int> &k_indices,
+                            std::vector<float> *k_sqr_distances, int nr_threads);
+
         /** \brief Helper function to calculate the squared distance between two points
           * \param[in] pointA point A
           * \param[in] pointB point B
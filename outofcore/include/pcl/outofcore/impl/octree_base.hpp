@@ -49,12 +49,17 @@
 #include <pcl/filters/random_sample.h>
 #include <pcl/filters/extract_indices.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 // C++
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <exception>
+#include <algorithm>
 
 namespace pcl
 {
@@ -80,6 +85,8 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<sensor_msgs::PointCloud2> ())
+      , threads_ (0)
+      , lod_points_mutex_ ()
     {
       //validate the root filename
       if (!this->checkExtension (root_name))
@@ -108,6 +115,8 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<sensor_msgs::PointCloud2> ())
+      , threads_ (0)
+      , lod_points_mutex_ ()
     {
       //Enlarge the bounding box to a cube so our voxels will be cubes
       Eigen::Vector3d tmp_min = min;
@@ -130,6 +139,8 @@ namespace pcl
       , metadata_ (new OutofcoreOctreeBaseMetadata ())
       , sample_percent_ (0.125)
       , lod_filter_ptr_ (new pcl::RandomSample<sensor_msgs::PointCloud2> ())
+      , threads_ (0)
+      , lod_points_mutex_ ()
     {
       //Create a new outofcore tree
       this->init (max_depth, min, max, root_node_name, coord_sys);
@@ -236,6 +247,98 @@ namespace pcl
       return (pt_added);
     }
 
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> boost::uint64_t
+    OutofcoreOctreeBase<ContainerT, PointT>::addDataToLeafParallel (const AlignedPointTVector& p, const size_t batch_size)
+    {
+      boost::unique_lock < boost::shared_mutex > lock (read_write_mutex_);
+
+      int nr_threads = 1;
+#ifdef _OPENMP
+      nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+      const boost::uint64_t max_depth = this->getDepth ();
+
+      // partition deep enough for every thread to get several subtrees
+      boost::uint64_t partition_depth = 0;
+      for (size_t nr_subtrees = 1; nr_subtrees < 4 * static_cast<size_t> (nr_threads) && partition_depth < max_depth; nr_subtrees *= 8)
+        ++partition_depth;
+
+      std::vector<BranchNode*> nodes (1, root_node_);
+      std::vector<std::vector<const PointT*> > buckets (1);
+      buckets[0].reserve (p.size ());
+      for (size_t i = 0; i < p.size (); ++i)
+      {
+        if (root_node_->pointInBoundingBox (p[i]))
+          buckets[0].push_back (&p[i]);
+      }
+
+      if (buckets[0].size () != p.size ())
+        PCL_WARN ("[pcl::outofcore::OutofcoreOctreeBase::addDataToLeafParallel] Dropped %lu points outside the bounding box of the tree\n", p.size () - buckets[0].size ());
+
+      // serially bucket the points into the nodes at the partition depth
+      for (boost::uint64_t depth = 0; depth < partition_depth; ++depth)
+      {
+        std::vector<BranchNode*> next_nodes;
+        std::vector<std::vector<const PointT*> > next_buckets;
+
+        for (size_t n = 0; n < nodes.size (); ++n)
+        {
+          BranchNode* node = nodes[n];
+          if (node->hasUnloadedChildren ())
+            node->loadChildren (false);
+
+          std::vector<std::vector<const PointT*> > octants (8);
+          const Eigen::Vector3d mid_xyz = node->node_metadata_->getVoxelCenter ();
+          const std::vector<const PointT*>& bucket = buckets[n];
+          for (size_t i = 0; i < bucket.size (); ++i)
+          {
+            const PointT* pt = bucket[i];
+            const size_t box = static_cast<size_t> (((pt->z >= mid_xyz[2]) << 2) | ((pt->y >= mid_xyz[1]) << 1) | ((pt->x >= mid_xyz[0])));
+            octants[box].push_back (pt);
+          }
+          std::vector<const PointT*> ().swap (buckets[n]);
+
+          for (size_t i = 0; i < 8; ++i)
+          {
+            if (octants[i].empty ())
+              continue;
+            if (!node->children_[i])
+              node->createChild (i);
+            next_nodes.push_back (node->children_[i]);
+            next_buckets.push_back (std::vector<const PointT*> ());
+            next_buckets.back ().swap (octants[i]);
+          }
+        }
+
+        nodes.swap (next_nodes);
+        buckets.swap (next_buckets);
+      }
+
+      // fill the disjoint subtrees concurrently, a bounded batch at a time
+      const size_t batch = batch_size > 0 ? batch_size : 1;
+      const int nr_nodes = static_cast<int> (nodes.size ());
+      boost::uint64_t pt_added = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads) reduction(+:pt_added)
+#endif
+      for (int n = 0; n < nr_nodes; ++n)
+      {
+        const std::vector<const PointT*>& bucket = buckets[n];
+        std::vector<const PointT*> slice;
+        for (size_t start = 0; start < bucket.size (); start += batch)
+        {
+          const size_t end = std::min (bucket.size (), start + batch);
+          slice.assign (bucket.begin () + start, bucket.begin () + end);
+          pt_added += nodes[n]->addDataToLeaf (slice, true);
+        }
+      }
+
+      return (pt_added);
+    }
+
     
     ////////////////////////////////////////////////////////////////////////////////
 
@@ -309,6 +412,16 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename Container, typename PointT> void
+    OutofcoreOctreeBase<Container, PointT>::queryFrustum (const double *planes, const boost::uint32_t query_depth, std::vector<OutofcoreNodeType*>& nodes) const
+    {
+      boost::shared_lock < boost::shared_mutex > lock (read_write_mutex_);
+      nodes.clear ();
+      root_node_->queryFrustum (planes, query_depth, nodes);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> void
     OutofcoreOctreeBase<ContainerT, PointT>::queryBBIncludes (const Eigen::Vector3d& min, const Eigen::Vector3d& max, const boost::uint64_t query_depth, AlignedPointTVector& dst) const
     {
@@ -425,6 +538,16 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::queryBBIntersects (const Eigen::Vector3d& min, const Eigen::Vector3d& max, const boost::uint32_t query_depth, std::vector<OutofcoreNodeType*>& nodes) const
+    {
+      boost::shared_lock < boost::shared_mutex > lock (read_write_mutex_);
+      nodes.clear ();
+      root_node_->queryBBIntersects (min, max, query_depth, nodes);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> void
     OutofcoreOctreeBase<ContainerT, PointT>::writeVPythonVisual (const boost::filesystem::path filename)
     {
@@ -573,6 +696,124 @@ namespace pcl
 
     ////////////////////////////////////////////////////////////////////////////////
 
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBase<ContainerT, PointT>::buildLODParallel ()
+    {
+      if (root_node_== NULL)
+      {
+        PCL_ERROR ("Root node is null; aborting buildLODParallel.\n");
+        return;
+      }
+
+      boost::unique_lock < boost::shared_mutex > lock (read_write_mutex_);
+
+      int nr_threads = 1;
+#ifdef _OPENMP
+      nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+      // collect the nodes of every depth, clearing the old LOD of the internal nodes
+      std::vector<std::vector<BranchNode*> > levels (1, std::vector<BranchNode*> (1, root_node_));
+      while (true)
+      {
+        std::vector<BranchNode*> next_level;
+        const std::vector<BranchNode*>& level = levels.back ();
+        for (size_t n = 0; n < level.size (); ++n)
+        {
+          BranchNode* node = level[n];
+          if (node->hasUnloadedChildren ())
+            node->loadChildren (false);
+          if (node->getNodeType () == pcl::octree::LEAF_NODE)
+            continue;
+
+          node->clearData ();
+          for (size_t i = 0; i < 8; ++i)
+          {
+            if (node->getChildPtr (i))
+              next_level.push_back (node->getChildPtr (i));
+          }
+        }
+
+        if (next_level.empty ())
+          break;
+        levels.push_back (next_level);
+      }
+
+      // a level only reads its children, which are complete once the level below is done
+      for (int depth = static_cast<int> (levels.size ()) - 2; depth >= 0; --depth)
+      {
+        const std::vector<BranchNode*>& level = levels[depth];
+        const int nr_nodes = static_cast<int> (level.size ());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+        for (int n = 0; n < nr_nodes; ++n)
+        {
+          if (level[n]->getNodeType () == pcl::octree::LEAF_NODE)
+            continue;
+          const boost::uint32_t seed = static_cast<boost::uint32_t> (depth) * 2654435761u + static_cast<boost::uint32_t> (n);
+          boost::uint64_t nr_sampled = sampleChildrenToLOD (level[n], seed);
+          if (nr_sampled > 0)
+            this->incrementPointsInLOD (level[n]->getDepth (), nr_sampled);
+        }
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> boost::uint64_t
+    OutofcoreOctreeBase<ContainerT, PointT>::sampleChildrenToLOD (BranchNode* node, const boost::uint32_t seed)
+    {
+      boost::mt19937 rand_gen (seed);
+      sensor_msgs::PointCloud2::Ptr lod_cloud;
+
+      for (size_t i = 0; i < 8; ++i)
+      {
+        BranchNode* child = node->getChildPtr (i);
+        if (!child)
+          continue;
+
+        sensor_msgs::PointCloud2::Ptr child_cloud (new sensor_msgs::PointCloud2 ());
+        child->read (child_cloud);
+
+        const size_t nr_points = static_cast<size_t> (child_cloud->width) * child_cloud->height;
+        if (nr_points == 0)
+          continue;
+
+        size_t sample_size = static_cast<size_t> (static_cast<double> (nr_points) * sample_percent_);
+        if (sample_size == 0)
+          sample_size = 1;
+
+        // partial Fisher-Yates shuffle; the first sample_size indices are the sample
+        std::vector<int> indices (nr_points);
+        for (size_t k = 0; k < nr_points; ++k)
+          indices[k] = static_cast<int> (k);
+        for (size_t k = 0; k < sample_size; ++k)
+        {
+          boost::uniform_int<size_t> dist (k, nr_points - 1);
+          std::swap (indices[k], indices[dist (rand_gen)]);
+        }
+        indices.resize (sample_size);
+        std::sort (indices.begin (), indices.end ());
+
+        sensor_msgs::PointCloud2 sampled;
+        pcl::copyPointCloud (*child_cloud, indices, sampled);
+
+        if (!lod_cloud)
+          lod_cloud.reset (new sensor_msgs::PointCloud2 (sampled));
+        else
+          pcl::concatenatePointCloud (*lod_cloud, sampled, *lod_cloud);
+      }
+
+      if (!lod_cloud || lod_cloud->width * lod_cloud->height == 0)
+        return (0);
+
+      node->payload_->insertRange (lod_cloud);
+      return (static_cast<boost::uint64_t> (lod_cloud->width) * lod_cloud->height);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
     template<typename ContainerT, typename PointT> void
     OutofcoreOctreeBase<ContainerT, PointT>::printBoundingBox (OutofcoreOctreeBaseNode<ContainerT, PointT>& node) const
     {
@@ -679,6 +920,8 @@ namespace pcl
     template<typename ContainerT, typename PointT> void
     OutofcoreOctreeBase<ContainerT, PointT>::incrementPointsInLOD (boost::uint64_t depth, boost::uint64_t new_point_count)
     {
+      boost::mutex::scoped_lock lock (lod_points_mutex_);
+
       if (std::numeric_limits<uint64_t>::max () - metadata_->getLODPoints (depth) < new_point_count)
       {
         PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeBase::incrementPointsInLOD] Overflow error. Too many points in depth %d of outofcore octree with root at %s\n", depth, metadata_->getMetadataFilename().c_str());
@@ -1346,6 +1346,82 @@ namespace pcl
     }
 
 
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename Container, typename PointT> void
+    OutofcoreOctreeBaseNode<Container, PointT>::queryFrustum (const double planes[24], const boost::uint32_t query_depth, std::vector<OutofcoreOctreeBaseNode*>& nodes, const bool skip_vfc_check)
+    {
+      if (this->depth_ > query_depth)
+        return;
+
+      bool inside = true;
+      if (!skip_vfc_check)
+      {
+        Eigen::Vector3d min_bb, max_bb;
+        node_metadata_->getBoundingBox (min_bb, max_bb);
+        const Eigen::Vector3d center = node_metadata_->getVoxelCenter ();
+        const Eigen::Vector3d radius = (max_bb - center).cwiseAbs ();
+
+        for (int i = 0; i < 6; i++)
+        {
+          const double a = planes[(i*4)];
+          const double b = planes[(i*4)+1];
+          const double c = planes[(i*4)+2];
+          const double d = planes[(i*4)+3];
+
+          const double m = (center.x () * a) + (center.y () * b) + (center.z () * c) + d;
+          const double n = (radius.x () * fabs (a)) + (radius.y () * fabs (b)) + (radius.z () * fabs (c));
+
+          if (m + n < 0)
+            return;
+
+          if (m - n < 0)
+            inside = false;
+        }
+      }
+
+      if (this->depth_ == query_depth)
+      {
+        if (payload_->getDataSize () > 0)
+          nodes.push_back (this);
+        return;
+      }
+
+      if (hasUnloadedChildren ())
+        loadChildren (false);
+
+      for (size_t i = 0; i < 8; i++)
+      {
+        if (children_[i])
+          children_[i]->queryFrustum (planes, query_depth, nodes, inside);
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeBaseNode<ContainerT, PointT>::queryBBIntersects (const Eigen::Vector3d& min_bb, const Eigen::Vector3d& max_bb, const boost::uint32_t query_depth, std::vector<OutofcoreOctreeBaseNode*>& nodes)
+    {
+      if (!intersectsWithBoundingBox (min_bb, max_bb))
+        return;
+
+      if (this->depth_ < query_depth)
+      {
+        if (hasUnloadedChildren ())
+          loadChildren (false);
+
+        for (size_t i = 0; i < 8; i++)
+        {
+          if (children_[i])
+            children_[i]->queryBBIntersects (min_bb, max_bb, query_depth, nodes);
+        }
+        return;
+      }
+
+      if (payload_->getDataSize () > 0)
+        nodes.push_back (this);
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
 
     template<typename ContainerT, typename PointT> void
@@ -0,0 +1,649 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_COMPRESSED_CONTAINER_IMPL_H_
+#define PCL_OUTOFCORE_OCTREE_COMPRESSED_CONTAINER_IMPL_H_
+
+// C++
+#include <sstream>
+#include <ctime>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+// PCL
+#include <pcl/exceptions.h>
+#include <pcl/point_types.h>
+#include <pcl/common/io.h>
+#include <pcl/io/lzf.h>
+#include <pcl/ros/conversions.h>
+#include <sensor_msgs/PointCloud2.h>
+
+// PCL (Urban Robotics)
+#include <pcl/outofcore/octree_disk_container.h>
+#include <pcl/outofcore/octree_compressed_container.h>
+
+//allows operation on POSIX
+#ifndef WIN32
+#define _fseeki64 fseeko
+#endif
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    namespace detail
+    {
+      /** \brief Maximum number of points encoded into a single block */
+      const uint32_t compressed_block_points = 65536;
+
+      /** \brief Regroups \b n elements of \b size bytes so that byte \b b of every element is stored contiguously */
+      inline void
+      shuffleBytes (const char* in, const size_t n, const size_t size, char* out)
+      {
+        for (size_t i = 0; i < n; ++i)
+          for (size_t b = 0; b < size; ++b)
+            out[b * n + i] = in[i * size + b];
+      }
+
+      /** \brief Inverse of \ref shuffleBytes */
+      inline void
+      unshuffleBytes (const char* in, const size_t n, const size_t size, char* out)
+      {
+        for (size_t i = 0; i < n; ++i)
+          for (size_t b = 0; b < size; ++b)
+            out[i * size + b] = in[b * n + i];
+      }
+    }
+
+    template<typename PointT>
+    double OutofcoreOctreeCompressedContainer<PointT>::quantization_resolution_ = 0;
+
+    template<typename PointT>
+    boost::mutex OutofcoreOctreeCompressedContainer<PointT>::rng_mutex_;
+
+    template<typename PointT> boost::mt19937
+    OutofcoreOctreeCompressedContainer<PointT>::rand_gen_ (static_cast<unsigned int> (std::time (NULL)));
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeCompressedContainer<PointT>::OutofcoreOctreeCompressedContainer (const boost::filesystem::path &path)
+      : path_ (path.string ())
+      , file_path_ ()
+      , blocks_ ()
+      , point_count_ (0)
+      , file_size_ (0)
+    {
+      boost::filesystem::path payload_path = path;
+      if (boost::filesystem::is_directory (path))
+      {
+        std::string uuid;
+        OutofcoreOctreeDiskContainer<PointT>::getRandomUUIDString (uuid);
+        payload_path = path / boost::filesystem::path (uuid);
+        path_ = payload_path.string ();
+      }
+
+      file_path_ = payload_path.replace_extension (".pcq").string ();
+      scanBlocks ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreeCompressedContainer<PointT>::~OutofcoreOctreeCompressedContainer ()
+    {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::scanBlocks ()
+    {
+      blocks_.clear ();
+      point_count_ = 0;
+      file_size_ = 0;
+
+      if (!boost::filesystem::exists (file_path_))
+        return;
+
+      const uint64_t file_size = boost::filesystem::file_size (file_path_);
+      FILE* file = fopen (file_path_.c_str (), "rb");
+      if (file == NULL)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedContainer::%s] Could not open %s\n", __FUNCTION__, file_path_.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Could not open payload file");
+      }
+
+      uint64_t offset = 0;
+      BlockHeader header;
+      while (offset + sizeof (BlockHeader) <= file_size)
+      {
+        if (_fseeki64 (file, offset, SEEK_SET) != 0 ||
+            fread (&header, sizeof (BlockHeader), 1, file) != 1 ||
+            std::memcmp (header.magic, "PCQ1", 4) != 0)
+          break;
+
+        const uint64_t stored = header.compressed_bytes ? header.compressed_bytes : header.raw_bytes;
+        if (offset + sizeof (BlockHeader) + stored > file_size)
+          break;
+
+        BlockEntry entry;
+        entry.offset = offset;
+        entry.first = point_count_;
+        entry.count = header.count;
+        blocks_.push_back (entry);
+
+        point_count_ += header.count;
+        offset += sizeof (BlockHeader) + stored;
+      }
+      fclose (file);
+
+      if (offset != file_size)
+      {
+        PCL_WARN ("[pcl::outofcore::OutofcoreOctreeCompressedContainer::%s] Ignoring %llu trailing bytes of %s that do not form a complete block\n", __FUNCTION__, static_cast<unsigned long long> (file_size - offset), file_path_.c_str ());
+      }
+      file_size_ = offset;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::encodeBlock (const PointT* points, const uint32_t count, std::vector<char> &block)
+    {
+      BlockHeader header;
+      std::memset (&header, 0, sizeof (BlockHeader));
+      std::memcpy (header.magic, "PCQ1", 4);
+      header.count = count;
+
+      // Quantize the coordinates relative to the bounding box of the block if
+      // a resolution is set and the block is finite and small enough for 32 bit
+      const double step = quantization_resolution_;
+      if (step > 0)
+      {
+        double min_pt[3] = { points[0].x, points[0].y, points[0].z };
+        double max_pt[3] = { points[0].x, points[0].y, points[0].z };
+        bool finite = true;
+        for (uint32_t i = 0; i < count && finite; ++i)
+        {
+          const double p[3] = { points[i].x, points[i].y, points[i].z };
+          for (int d = 0; d < 3; ++d)
+          {
+            finite = finite && pcl_isfinite (p[d]);
+            min_pt[d] = std::min (min_pt[d], p[d]);
+            max_pt[d] = std::max (max_pt[d], p[d]);
+          }
+        }
+
+        if (finite)
+        {
+          const double extent = std::max (max_pt[0] - min_pt[0], std::max (max_pt[1] - min_pt[1], max_pt[2] - min_pt[2]));
+          const double levels = std::floor (extent / step + 0.5) + 1.0;
+          uint32_t bits = 1;
+          while (bits <= 32 && std::ldexp (1.0, bits) < levels)
+            ++bits;
+
+          if (bits <= 32)
+          {
+            header.bits = bits;
+            header.step = step;
+            for (int d = 0; d < 3; ++d)
+              header.origin[d] = min_pt[d];
+          }
+        }
+      }
+
+      // Layout before shuffling: three coordinate planes if quantized, then
+      // the point records with their coordinates zeroed if quantized
+      const size_t word = header.bits == 0 ? 0 : (header.bits <= 16 ? 2 : 4);
+      const size_t plane_bytes = 3 * count * word;
+      const size_t record_bytes = count * sizeof (PointT);
+      header.raw_bytes = static_cast<uint32_t> (plane_bytes + record_bytes);
+
+      std::vector<char> raw (header.raw_bytes);
+      std::memcpy (&raw[plane_bytes], points, record_bytes);
+      if (header.bits)
+      {
+        const double max_level = std::ldexp (1.0, header.bits) - 1.0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+          PointT &p = reinterpret_cast<PointT*> (&raw[plane_bytes])[i];
+          const double xyz[3] = { p.x, p.y, p.z };
+          for (int d = 0; d < 3; ++d)
+          {
+            const double q = std::min (std::floor ((xyz[d] - header.origin[d]) / step + 0.5), max_level);
+            const size_t pos = (d * count + i) * word;
+            if (word == 2)
+            {
+              const uint16_t v = static_cast<uint16_t> (q);
+              std::memcpy (&raw[pos], &v, 2);
+            }
+            else
+            {
+              const uint32_t v = static_cast<uint32_t> (q);
+              std::memcpy (&raw[pos], &v, 4);
+            }
+          }
+          p.x = p.y = p.z = 0.0f;
+        }
+      }
+
+      std::vector<char> shuffled (header.raw_bytes);
+      if (plane_bytes)
+        detail::shuffleBytes (&raw[0], 3 * count, word, &shuffled[0]);
+      detail::shuffleBytes (&raw[plane_bytes], count, sizeof (PointT), &shuffled[plane_bytes]);
+
+      // The output buffer covers the worst case expansion of LZF; the block
+      // is kept uncompressed if compression does not gain anything
+      block.resize (sizeof (BlockHeader) + header.raw_bytes + header.raw_bytes / 32 + 16);
+      header.compressed_bytes = pcl::lzfCompress (&shuffled[0], header.raw_bytes,
+                                                  &block[sizeof (BlockHeader)], static_cast<unsigned int> (block.size () - sizeof (BlockHeader)));
+      if (header.compressed_bytes == 0 || header.compressed_bytes >= header.raw_bytes)
+      {
+        header.compressed_bytes = 0;
+        std::memcpy (&block[sizeof (BlockHeader)], &shuffled[0], header.raw_bytes);
+        block.resize (sizeof (BlockHeader) + header.raw_bytes);
+      }
+      else
+        block.resize (sizeof (BlockHeader) + header.compressed_bytes);
+
+      std::memcpy (&block[0], &header, sizeof (BlockHeader));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::decodeBlock (FILE* file, const BlockEntry &entry, AlignedPointTVector &dst) const
+    {
+      BlockHeader header;
+      if (_fseeki64 (file, entry.offset, SEEK_SET) != 0 ||
+          fread (&header, sizeof (BlockHeader), 1, file) != 1)
+      {
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Could not read block header");
+      }
+
+      const uint32_t stored = header.compressed_bytes ? header.compressed_bytes : header.raw_bytes;
+      std::vector<char> buffer (stored);
+      if (stored && fread (&buffer[0], 1, stored, file) != stored)
+      {
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Could not read block");
+      }
+
+      std::vector<char> shuffled;
+      if (header.compressed_bytes)
+      {
+        shuffled.resize (header.raw_bytes);
+        if (pcl::lzfDecompress (&buffer[0], header.compressed_bytes, &shuffled[0], header.raw_bytes) != header.raw_bytes)
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedContainer::%s] Corrupt block at offset %llu of %s\n", __FUNCTION__, static_cast<unsigned long long> (entry.offset), file_path_.c_str ());
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Could not decompress block");
+        }
+      }
+      else
+      {
+        shuffled.swap (buffer);
+      }
+
+      const size_t count = header.count;
+      const size_t word = header.bits == 0 ? 0 : (header.bits <= 16 ? 2 : 4);
+      const size_t plane_bytes = 3 * count * word;
+
+      const size_t offset = dst.size ();
+      dst.resize (offset + count);
+      if (count)
+        detail::unshuffleBytes (&shuffled[plane_bytes], count, sizeof (PointT), reinterpret_cast<char*> (&dst[offset]));
+
+      if (header.bits)
+      {
+        std::vector<char> planes (plane_bytes);
+        detail::unshuffleBytes (&shuffled[0], 3 * count, word, &planes[0]);
+        for (size_t i = 0; i < count; ++i)
+        {
+          float* xyz[3] = { &dst[offset + i].x, &dst[offset + i].y, &dst[offset + i].z };
+          for (size_t d = 0; d < 3; ++d)
+          {
+            const size_t pos = (d * count + i) * word;
+            double q;
+            if (word == 2)
+            {
+              uint16_t v;
+              std::memcpy (&v, &planes[pos], 2);
+              q = v;
+            }
+            else
+            {
+              uint32_t v;
+              std::memcpy (&v, &planes[pos], 4);
+              q = v;
+            }
+            *xyz[d] = static_cast<float> (header.origin[d] + q * header.step);
+          }
+        }
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> PointT
+    OutofcoreOctreeCompressedContainer<PointT>::operator[] (uint64_t idx) const
+    {
+      if (idx >= point_count_)
+      {
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore:OutofcoreOctreeCompressedContainer] Index is out of range");
+      }
+
+      AlignedPointTVector p;
+      readPoints (idx, 1, p);
+      return (p[0]);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::insertRange (const PointT* start, const uint64_t count)
+    {
+      if (count == 0)
+        return;
+
+      FILE* file = fopen (file_path_.c_str (), "ab");
+      if (file == NULL)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedContainer::%s] Could not open %s for writing\n", __FUNCTION__, file_path_.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Could not open payload file");
+      }
+
+      std::vector<char> block;
+      for (uint64_t first = 0; first < count; first += detail::compressed_block_points)
+      {
+        const uint32_t block_count = static_cast<uint32_t> (std::min<uint64_t> (count - first, detail::compressed_block_points));
+        encodeBlock (start + first, block_count, block);
+
+        if (fwrite (&block[0], 1, block.size (), file) != block.size ())
+        {
+          fclose (file);
+          PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedContainer::%s] Could not write to %s\n", __FUNCTION__, file_path_.c_str ());
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Could not write block");
+        }
+
+        BlockEntry entry;
+        entry.offset = file_size_;
+        entry.first = point_count_;
+        entry.count = block_count;
+        blocks_.push_back (entry);
+
+        point_count_ += block_count;
+        file_size_ += block.size ();
+      }
+
+      fclose (file);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::insertRange (const PointT* const * start, const uint64_t count)
+    {
+      //copy the handles to a continuous block
+      AlignedPointTVector temp (count);
+      for (uint64_t i = 0; i < count; i++)
+      {
+        temp[i] = *(start[i]);
+      }
+
+      if (count > 0)
+        insertRange (&temp[0], count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::insertRange (const AlignedPointTVector& src)
+    {
+      if (!src.empty ())
+        insertRange (&src[0], src.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::insertRange (const sensor_msgs::PointCloud2::Ptr& input_cloud)
+    {
+      pcl::PointCloud<PointT> cloud;
+      pcl::fromROSMsg (*input_cloud, cloud);
+
+      insertRange (cloud.points);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::readPoints (const uint64_t start, const uint64_t count, AlignedPointTVector& dst) const
+    {
+      if (count == 0)
+        return;
+
+      if (start + count > point_count_)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedContainer::%s] Could not read points %llu to %llu of %s\n", __FUNCTION__, static_cast<unsigned long long> (start), static_cast<unsigned long long> (start + count), path_.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Outofcore Octree Exception: Read indices exceed range");
+      }
+
+      // Binary search for the block holding the first point
+      size_t lo = 0, hi = blocks_.size ();
+      while (hi - lo > 1)
+      {
+        const size_t mid = (lo + hi) / 2;
+        if (blocks_[mid].first <= start)
+          lo = mid;
+        else
+          hi = mid;
+      }
+
+      FILE* file = fopen (file_path_.c_str (), "rb");
+      if (file == NULL)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeCompressedContainer::%s] Could not open %s\n", __FUNCTION__, file_path_.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreeCompressedContainer] Could not open payload file");
+      }
+
+      dst.reserve (dst.size () + count);
+      const uint64_t end = start + count;
+      AlignedPointTVector block;
+      try
+      {
+        for (size_t b = lo; b < blocks_.size () && blocks_[b].first < end; ++b)
+        {
+          const BlockEntry &entry = blocks_[b];
+          block.clear ();
+          decodeBlock (file, entry, block);
+
+          const uint64_t from = std::max (start, entry.first) - entry.first;
+          const uint64_t to = std::min (end, entry.first + entry.count) - entry.first;
+          dst.insert (dst.end (), block.begin () + from, block.begin () + to);
+        }
+      }
+      catch (...)
+      {
+        fclose (file);
+        throw;
+      }
+      fclose (file);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::readRange (const uint64_t start, const uint64_t count, AlignedPointTVector& dst)
+    {
+      readPoints (start, count, dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::readRange (const uint64_t start, const uint64_t count, sensor_msgs::PointCloud2::Ptr& dst)
+    {
+      pcl::PointCloud<PointT> cloud;
+      readPoints (start, count, cloud.points);
+      cloud.width = static_cast<uint32_t> (cloud.points.size ());
+      cloud.height = 1;
+
+      pcl::toROSMsg (cloud, *dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreeCompressedContainer<PointT>::read (sensor_msgs::PointCloud2::Ptr& output_cloud)
+    {
+      sensor_msgs::PointCloud2::Ptr temp_output_cloud (new sensor_msgs::PointCloud2 ());
+      readRange (0, size (), temp_output_cloud);
+
+      if (output_cloud.get () != 0)
+      {
+        pcl::concatenatePointCloud (*output_cloud, *temp_output_cloud, *output_cloud);
+      }
+      else
+      {
+        output_cloud = temp_output_cloud;
+      }
+      return (0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::readRangeSubSample (const uint64_t start, const uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      dst.clear ();
+      if (count == 0)
+        return;
+
+      const uint64_t samples = static_cast<uint64_t> (percent * static_cast<double> (count));
+      if (samples == 0)
+      {
+        readRangeSubSample_bernoulli (start, count, percent, dst);
+        return;
+      }
+
+      AlignedPointTVector range;
+      readPoints (start, count, range);
+
+      boost::mutex::scoped_lock lock (rng_mutex_);
+      boost::uniform_int<uint64_t> dist (0, count - 1);
+      boost::variate_generator<boost::mt19937&, boost::uniform_int<uint64_t> > die (rand_gen_, dist);
+
+      dst.reserve (samples);
+      for (uint64_t i = 0; i < samples; i++)
+      {
+        dst.push_back (range[die ()]);
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::readRangeSubSample_bernoulli (const uint64_t start, const uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      dst.clear ();
+      if (count == 0)
+        return;
+
+      AlignedPointTVector range;
+      readPoints (start, count, range);
+
+      boost::mutex::scoped_lock lock (rng_mutex_);
+      boost::bernoulli_distribution<double> dist (percent);
+      boost::variate_generator<boost::mt19937&, boost::bernoulli_distribution<double> > coin (rand_gen_, dist);
+
+      for (uint64_t i = 0; i < count; i++)
+      {
+        if (coin ())
+        {
+          dst.push_back (range[i]);
+        }
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::clear ()
+    {
+      boost::filesystem::remove (file_path_);
+      blocks_.clear ();
+      point_count_ = 0;
+      file_size_ = 0;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreeCompressedContainer<PointT>::convertToXYZ (const boost::filesystem::path &path)
+    {
+      AlignedPointTVector points;
+      readPoints (0, size (), points);
+      if (points.empty ())
+        return;
+
+      FILE* fxyz = fopen (path.string ().c_str (), "w");
+      assert (fxyz != NULL);
+
+      for (size_t i = 0; i < points.size (); i++)
+      {
+        const PointT& p = points[i];
+
+        std::stringstream ss;
+        ss << std::fixed;
+        ss.precision (16);
+        ss << p.x << "\t" << p.y << "\t" << p.z << "\n";
+
+        fwrite (ss.str ().c_str (), 1, ss.str ().size (), fxyz);
+      }
+
+      int res = fclose (fxyz);
+      (void)res;
+      assert (res == 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+  }//namespace outofcore
+}//namespace pcl
+
+#endif //PCL_OUTOFCORE_OCTREE_COMPRESSED_CONTAINER_IMPL_H_
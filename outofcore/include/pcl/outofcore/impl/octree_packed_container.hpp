@@ -0,0 +1,300 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_PACKED_CONTAINER_IMPL_H_
+#define PCL_OUTOFCORE_OCTREE_PACKED_CONTAINER_IMPL_H_
+
+// C++
+#include <sstream>
+#include <ctime>
+
+// PCL
+#include <pcl/exceptions.h>
+#include <pcl/point_types.h>
+#include <pcl/common/io.h>
+#include <pcl/ros/conversions.h>
+#include <sensor_msgs/PointCloud2.h>
+
+// PCL (Urban Robotics)
+#include <pcl/outofcore/octree_disk_container.h>
+#include <pcl/outofcore/octree_packed_container.h>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    template<typename PointT>
+    boost::mutex OutofcoreOctreePackedContainer<PointT>::rng_mutex_;
+
+    template<typename PointT> boost::mt19937
+    OutofcoreOctreePackedContainer<PointT>::rand_gen_ (static_cast<unsigned int> (std::time (NULL)));
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreePackedContainer<PointT>::OutofcoreOctreePackedContainer (const boost::filesystem::path &path)
+      : store_ ()
+      , key_ ()
+      , path_ (path.string ())
+    {
+      boost::filesystem::path payload_path = path;
+      if (boost::filesystem::is_directory (path))
+      {
+        std::string uuid;
+        OutofcoreOctreeDiskContainer<PointT>::getRandomUUIDString (uuid);
+        payload_path = path / boost::filesystem::path (uuid);
+        path_ = payload_path.string ();
+      }
+
+      store_ = OutofcorePackedSegmentStore::locate (payload_path, key_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT>
+    OutofcoreOctreePackedContainer<PointT>::~OutofcoreOctreePackedContainer ()
+    {
+      store_->flush ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> PointT
+    OutofcoreOctreePackedContainer<PointT>::operator[] (uint64_t idx) const
+    {
+      PointT p;
+      if (!store_->read (key_, idx * sizeof (PointT), sizeof (PointT), reinterpret_cast<char*> (&p)))
+      {
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore:OutofcoreOctreePackedContainer] Index is out of range");
+      }
+      return (p);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::insertRange (const PointT* start, const uint64_t count)
+    {
+      store_->append (key_, start, count * sizeof (PointT), count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::insertRange (const PointT* const * start, const uint64_t count)
+    {
+      //copy the handles to a continuous block
+      AlignedPointTVector temp (count);
+      for (uint64_t i = 0; i < count; i++)
+      {
+        temp[i] = *(start[i]);
+      }
+
+      if (count > 0)
+        insertRange (&temp[0], count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::insertRange (const AlignedPointTVector& src)
+    {
+      if (!src.empty ())
+        insertRange (&src[0], src.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::insertRange (const sensor_msgs::PointCloud2::Ptr& input_cloud)
+    {
+      pcl::PointCloud<PointT> cloud;
+      pcl::fromROSMsg (*input_cloud, cloud);
+
+      insertRange (cloud.points);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::readPoints (const uint64_t start, const uint64_t count, AlignedPointTVector& dst) const
+    {
+      if (count == 0)
+        return;
+
+      const size_t offset = dst.size ();
+      dst.resize (offset + count);
+      if (!store_->read (key_, start * sizeof (PointT), count * sizeof (PointT), reinterpret_cast<char*> (&dst[offset])))
+      {
+        dst.resize (offset);
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreePackedContainer::%s] Could not read points %llu to %llu of %s\n", __FUNCTION__, static_cast<unsigned long long> (start), static_cast<unsigned long long> (start + count), path_.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcoreOctreePackedContainer] Outofcore Octree Exception: Read indices exceed range");
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::readRange (const uint64_t start, const uint64_t count, AlignedPointTVector& dst)
+    {
+      readPoints (start, count, dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::readRange (const uint64_t start, const uint64_t count, sensor_msgs::PointCloud2::Ptr& dst)
+    {
+      pcl::PointCloud<PointT> cloud;
+      readPoints (start, count, cloud.points);
+      cloud.width = static_cast<uint32_t> (cloud.points.size ());
+      cloud.height = 1;
+
+      pcl::toROSMsg (cloud, *dst);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> int
+    OutofcoreOctreePackedContainer<PointT>::read (sensor_msgs::PointCloud2::Ptr& output_cloud)
+    {
+      sensor_msgs::PointCloud2::Ptr temp_output_cloud (new sensor_msgs::PointCloud2 ());
+      readRange (0, size (), temp_output_cloud);
+
+      if (output_cloud.get () != 0)
+      {
+        pcl::concatenatePointCloud (*output_cloud, *temp_output_cloud, *output_cloud);
+      }
+      else
+      {
+        output_cloud = temp_output_cloud;
+      }
+      return (0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::readRangeSubSample (const uint64_t start, const uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      dst.clear ();
+      if (count == 0)
+        return;
+
+      const uint64_t samples = static_cast<uint64_t> (percent * static_cast<double> (count));
+      if (samples == 0)
+      {
+        readRangeSubSample_bernoulli (start, count, percent, dst);
+        return;
+      }
+
+      AlignedPointTVector range;
+      readPoints (start, count, range);
+
+      boost::mutex::scoped_lock lock (rng_mutex_);
+      boost::uniform_int<uint64_t> dist (0, count - 1);
+      boost::variate_generator<boost::mt19937&, boost::uniform_int<uint64_t> > die (rand_gen_, dist);
+
+      dst.reserve (samples);
+      for (uint64_t i = 0; i < samples; i++)
+      {
+        dst.push_back (range[die ()]);
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::readRangeSubSample_bernoulli (const uint64_t start, const uint64_t count, const double percent, AlignedPointTVector& dst)
+    {
+      dst.clear ();
+      if (count == 0)
+        return;
+
+      AlignedPointTVector range;
+      readPoints (start, count, range);
+
+      boost::mutex::scoped_lock lock (rng_mutex_);
+      boost::bernoulli_distribution<double> dist (percent);
+      boost::variate_generator<boost::mt19937&, boost::bernoulli_distribution<double> > coin (rand_gen_, dist);
+
+      for (uint64_t i = 0; i < count; i++)
+      {
+        if (coin ())
+        {
+          dst.push_back (range[i]);
+        }
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename PointT> void
+    OutofcoreOctreePackedContainer<PointT>::convertToXYZ (const boost::filesystem::path &path)
+    {
+      AlignedPointTVector points;
+      readPoints (0, size (), points);
+      if (points.empty ())
+        return;
+
+      FILE* fxyz = fopen (path.string ().c_str (), "w");
+      assert (fxyz != NULL);
+
+      for (size_t i = 0; i < points.size (); i++)
+      {
+        const PointT& p = points[i];
+
+        std::stringstream ss;
+        ss << std::fixed;
+        ss.precision (16);
+        ss << p.x << "\t" << p.y << "\t" << p.z << "\n";
+
+        fwrite (ss.str ().c_str (), 1, ss.str ().size (), fxyz);
+      }
+
+      int res = fclose (fxyz);
+      (void)res;
+      assert (res == 0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+  }//namespace outofcore
+}//namespace pcl
+
+#endif //PCL_OUTOFCORE_OCTREE_PACKED_CONTAINER_IMPL_H_
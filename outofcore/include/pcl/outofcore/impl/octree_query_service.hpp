@@ -0,0 +1,484 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_QUERY_SERVICE_IMPL_H_
+#define PCL_OUTOFCORE_OCTREE_QUERY_SERVICE_IMPL_H_
+
+#include <pcl/outofcore/octree_query_service.h>
+
+// C++
+#include <algorithm>
+#include <utility>
+
+#include <boost/bind.hpp>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT>
+    OutofcoreOctreeQueryService<ContainerT, PointT>::OutofcoreOctreeQueryService (const OctreePtr& octree, const unsigned int nr_workers, const boost::uint64_t cache_capacity)
+      : octree_ (octree)
+      , workers_ ()
+      , mutex_ ()
+      , work_cond_ ()
+      , idle_cond_ ()
+      , demand_queue_ ()
+      , prefetch_queue_ ()
+      , pending_ ()
+      , loading_ ()
+      , cache_ ()
+      , lru_ ()
+      , cache_capacity_ (cache_capacity)
+      , cache_usage_ (0)
+      , cache_hits_ (0)
+      , cache_misses_ (0)
+      , prefetch_ (true)
+      , stop_ (false)
+    {
+      const unsigned int nr_threads = nr_workers > 0 ? nr_workers : 1;
+      for (unsigned int i = 0; i < nr_threads; i++)
+        workers_.create_thread (boost::bind (&OutofcoreOctreeQueryService::workerLoop, this));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT>
+    OutofcoreOctreeQueryService<ContainerT, PointT>::~OutofcoreOctreeQueryService ()
+    {
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        stop_ = true;
+      }
+      work_cond_.notify_all ();
+      workers_.join_all ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> typename OutofcoreOctreeQueryService<ContainerT, PointT>::PayloadFuture
+    OutofcoreOctreeQueryService<ContainerT, PointT>::requestNode (NodeT* node, const Callback& callback)
+    {
+      Waiter waiter;
+      waiter.promise.reset (new boost::promise<PayloadConstPtr> ());
+      waiter.callback = callback;
+      PayloadFuture future (waiter.promise->get_future ());
+
+      if (node == NULL)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeQueryService::requestNode] Requested a NULL node\n");
+        waiter.promise->set_value (PayloadConstPtr ());
+        return (future);
+      }
+
+      PayloadConstPtr payload;
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        typename std::map<NodeT*, CacheEntry>::iterator it = cache_.find (node);
+        if (it == cache_.end ())
+        {
+          cache_misses_++;
+          enqueue (node, &waiter);
+          return (future);
+        }
+
+        cache_hits_++;
+        lru_.splice (lru_.begin (), lru_, it->second.lru);
+        payload = it->second.payload;
+      }
+
+      waiter.promise->set_value (payload);
+      if (callback)
+        callback (node, payload);
+
+      return (future);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::queryBoundingBox (const Eigen::Vector3d& min, const Eigen::Vector3d& max, const boost::uint32_t query_depth,
+                                                                       std::vector<NodeT*>& nodes, std::vector<PayloadFuture>& payloads, const Callback& callback)
+    {
+      octree_->queryBBIntersects (min, max, query_depth, nodes);
+      sortByDistance ((min + max) / 2.0, nodes);
+
+      payloads.clear ();
+      payloads.reserve (nodes.size ());
+      for (size_t i = 0; i < nodes.size (); i++)
+        payloads.push_back (requestNode (nodes[i], callback));
+
+      if (prefetch_ && query_depth < octree_->getDepth ())
+        prefetchBoundingBox (min, max, query_depth + 1);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::queryFrustum (const double* planes, const Eigen::Vector3d& eye, const boost::uint32_t query_depth,
+                                                                   std::vector<NodeT*>& nodes, std::vector<PayloadFuture>& payloads, const Callback& callback)
+    {
+      // the prefetches of the previous view are stale
+      cancelPrefetch ();
+
+      octree_->queryFrustum (planes, query_depth, nodes);
+      sortByDistance (eye, nodes);
+
+      payloads.clear ();
+      payloads.reserve (nodes.size ());
+      for (size_t i = 0; i < nodes.size (); i++)
+        payloads.push_back (requestNode (nodes[i], callback));
+
+      if (!prefetch_ || nodes.empty ())
+        return;
+
+      std::vector<NodeT*> prefetch_nodes;
+
+      // the next level of detail inside the view
+      if (query_depth < octree_->getDepth ())
+      {
+        octree_->queryFrustum (planes, query_depth + 1, prefetch_nodes);
+        sortByDistance (eye, prefetch_nodes);
+        boost::mutex::scoped_lock lock (mutex_);
+        for (size_t i = 0; i < prefetch_nodes.size (); i++)
+          enqueue (prefetch_nodes[i], NULL);
+      }
+
+      // the ring of nodes around the view, one voxel wide
+      Eigen::Vector3d view_min, view_max;
+      nodes[0]->getBoundingBox (view_min, view_max);
+      for (size_t i = 1; i < nodes.size (); i++)
+      {
+        Eigen::Vector3d node_min, node_max;
+        nodes[i]->getBoundingBox (node_min, node_max);
+        view_min = view_min.cwiseMin (node_min);
+        view_max = view_max.cwiseMax (node_max);
+      }
+      const double voxel_side = octree_->getVoxelSideLength (query_depth);
+      view_min.array () -= voxel_side;
+      view_max.array () += voxel_side;
+
+      octree_->queryBBIntersects (view_min, view_max, query_depth, prefetch_nodes);
+      sortByDistance (eye, prefetch_nodes);
+      boost::mutex::scoped_lock lock (mutex_);
+      for (size_t i = 0; i < prefetch_nodes.size (); i++)
+        enqueue (prefetch_nodes[i], NULL);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::prefetchBoundingBox (const Eigen::Vector3d& min, const Eigen::Vector3d& max, const boost::uint32_t query_depth)
+    {
+      std::vector<NodeT*> nodes;
+      octree_->queryBBIntersects (min, max, query_depth, nodes);
+      sortByDistance ((min + max) / 2.0, nodes);
+
+      boost::mutex::scoped_lock lock (mutex_);
+      for (size_t i = 0; i < nodes.size (); i++)
+        enqueue (nodes[i], NULL);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::cancelPrefetch ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      for (size_t i = 0; i < prefetch_queue_.size (); i++)
+      {
+        NodeT* node = prefetch_queue_[i];
+        typename std::map<NodeT*, std::vector<Waiter> >::iterator it = pending_.find (node);
+        // keep prefetches which a request is waiting for
+        if (it != pending_.end () && it->second.empty () && loading_.count (node) == 0)
+          pending_.erase (it);
+      }
+      prefetch_queue_.clear ();
+
+      if (demand_queue_.empty () && loading_.empty ())
+        idle_cond_.notify_all ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::waitUntilIdle ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      while (!demand_queue_.empty () || !prefetch_queue_.empty () || !loading_.empty ())
+        idle_cond_.wait (lock);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> bool
+    OutofcoreOctreeQueryService<ContainerT, PointT>::getCachedPayload (NodeT* node, PayloadConstPtr& payload)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      typename std::map<NodeT*, CacheEntry>::iterator it = cache_.find (node);
+      if (it == cache_.end ())
+        return (false);
+
+      lru_.splice (lru_.begin (), lru_, it->second.lru);
+      payload = it->second.payload;
+      return (true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::clearCache ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      evict (0);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::setCacheCapacity (const boost::uint64_t cache_capacity)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      cache_capacity_ = cache_capacity;
+      evict (cache_capacity_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> boost::uint64_t
+    OutofcoreOctreeQueryService<ContainerT, PointT>::getCacheCapacity () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (cache_capacity_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> boost::uint64_t
+    OutofcoreOctreeQueryService<ContainerT, PointT>::getCacheUsage () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (cache_usage_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> size_t
+    OutofcoreOctreeQueryService<ContainerT, PointT>::getNumCachedNodes () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (cache_.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> boost::uint64_t
+    OutofcoreOctreeQueryService<ContainerT, PointT>::getNumCacheHits () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (cache_hits_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> boost::uint64_t
+    OutofcoreOctreeQueryService<ContainerT, PointT>::getNumCacheMisses () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (cache_misses_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::workerLoop ()
+    {
+      while (true)
+      {
+        NodeT* node = NULL;
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          while (node == NULL)
+          {
+            if (stop_)
+              return;
+
+            std::deque<NodeT*>& queue = demand_queue_.empty () ? prefetch_queue_ : demand_queue_;
+            if (queue.empty ())
+            {
+              if (loading_.empty ())
+                idle_cond_.notify_all ();
+              work_cond_.wait (lock);
+              continue;
+            }
+
+            NodeT* candidate = queue.front ();
+            queue.pop_front ();
+
+            // skip cancelled prefetches and nodes queued twice
+            if (pending_.count (candidate) == 0 || loading_.count (candidate) != 0)
+              continue;
+
+            node = candidate;
+            loading_.insert (node);
+          }
+        }
+
+        sensor_msgs::PointCloud2::Ptr blob;
+        if (node->read (blob) != 0 || !blob)
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcoreOctreeQueryService] Failed to read the payload of a node at depth %lu\n", node->getDepth ());
+          blob.reset ();
+        }
+        const PayloadConstPtr payload (blob);
+
+        std::vector<Waiter> waiters;
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          typename std::map<NodeT*, std::vector<Waiter> >::iterator it = pending_.find (node);
+          if (it != pending_.end ())
+          {
+            waiters.swap (it->second);
+            pending_.erase (it);
+          }
+          if (payload)
+            insertIntoCache (node, payload);
+        }
+
+        for (size_t i = 0; i < waiters.size (); i++)
+        {
+          waiters[i].promise->set_value (payload);
+          if (waiters[i].callback)
+            waiters[i].callback (node, payload);
+        }
+
+        boost::mutex::scoped_lock lock (mutex_);
+        loading_.erase (node);
+        if (demand_queue_.empty () && prefetch_queue_.empty () && loading_.empty ())
+          idle_cond_.notify_all ();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::enqueue (NodeT* node, const Waiter* waiter)
+    {
+      if (cache_.count (node) != 0)
+        return;
+
+      typename std::map<NodeT*, std::vector<Waiter> >::iterator it = pending_.find (node);
+      if (it == pending_.end ())
+      {
+        it = pending_.insert (std::make_pair (node, std::vector<Waiter> ())).first;
+        if (waiter)
+          demand_queue_.push_back (node);
+        else
+          prefetch_queue_.push_back (node);
+        work_cond_.notify_one ();
+      }
+      else if (waiter && it->second.empty () && loading_.count (node) == 0)
+      {
+        // promote a queued prefetch; the stale prefetch entry is skipped by the workers
+        demand_queue_.push_back (node);
+        work_cond_.notify_one ();
+      }
+
+      if (waiter)
+        it->second.push_back (*waiter);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::insertIntoCache (NodeT* node, const PayloadConstPtr& payload)
+    {
+      const boost::uint64_t bytes = sizeof (sensor_msgs::PointCloud2) + payload->data.size ();
+      // payloads larger than the whole cache are only handed to the waiting requests
+      if (bytes > cache_capacity_ || cache_.count (node) != 0)
+        return;
+
+      evict (cache_capacity_ - bytes);
+
+      lru_.push_front (node);
+      CacheEntry& entry = cache_[node];
+      entry.payload = payload;
+      entry.bytes = bytes;
+      entry.lru = lru_.begin ();
+      cache_usage_ += bytes;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::evict (const boost::uint64_t capacity)
+    {
+      while (cache_usage_ > capacity && !lru_.empty ())
+      {
+        typename std::map<NodeT*, CacheEntry>::iterator it = cache_.find (lru_.back ());
+        cache_usage_ -= it->second.bytes;
+        cache_.erase (it);
+        lru_.pop_back ();
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    template<typename ContainerT, typename PointT> void
+    OutofcoreOctreeQueryService<ContainerT, PointT>::sortByDistance (const Eigen::Vector3d& point, std::vector<NodeT*>& nodes)
+    {
+      std::vector<std::pair<double, NodeT*> > order (nodes.size ());
+      for (size_t i = 0; i < nodes.size (); i++)
+      {
+        Eigen::Vector3d min, max;
+        nodes[i]->getBoundingBox (min, max);
+        order[i] = std::make_pair (((min + max) / 2.0 - point).squaredNorm (), nodes[i]);
+      }
+      std::sort (order.begin (), order.end ());
+
+      for (size_t i = 0; i < nodes.size (); i++)
+        nodes[i] = order[i].second;
+    }
+
+  }//namespace outofcore
+}//namespace pcl
+
+#endif //PCL_OUTOFCORE_OCTREE_QUERY_SERVICE_IMPL_H_
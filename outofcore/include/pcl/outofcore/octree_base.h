@@ -253,6 +253,22 @@ namespace pcl
         boost::uint64_t
         addPointCloud (sensor_msgs::PointCloud2::Ptr &input_cloud, const bool skip_bb_check = false);
 
+        /** \brief Add points to the leaves of the tree using several threads.
+         *
+         * The points are bucketed serially into the nodes of the upper levels
+         * of the tree, deep enough to give every thread several subtrees; the
+         * subtrees are then filled concurrently. Each worker pushes at most
+         * \b batch_size points at a time down its subtree, which bounds the
+         * temporary memory held per thread.
+         *
+         * \param[in] p the points to insert; points outside the bounding box of the tree are dropped
+         * \param[in] batch_size the maximum number of points a worker inserts into a subtree at once
+         * \return Number of points successfully copied to the octree
+         * \note unique read_write_mutex lock occurs
+         */
+        boost::uint64_t
+        addDataToLeafParallel (const AlignedPointTVector &p, const size_t batch_size = 1000000);
+
         /** \brief Recursively add points to the tree. 
          *
          * Recursively add points to the tree. 1/8 of the remaining
@@ -297,6 +313,14 @@ namespace pcl
 	      void
         queryFrustum (const double *planes, const Eigen::Vector3d &eye, const Eigen::Matrix4d &view_projection_matrix,
                       std::list<std::string>& file_names, const boost::uint32_t query_depth) const;
+
+        /** \brief Get the nodes holding data at query_depth which intersect the view frustum
+         *  \param[in] planes the six frustum planes (a, b, c, d), oriented towards the inside of the frustum
+         *  \param[in] query_depth 0 is root, (this->depth) is full
+         *  \param[out] nodes the nodes satisfying the query
+         */
+        void
+        queryFrustum (const double *planes, const boost::uint32_t query_depth, std::vector<OutofcoreNodeType*> &nodes) const;
         
         //--------------------------------------------------------------------------------
         //templated PointT methods
@@ -312,6 +336,16 @@ namespace pcl
         void
         queryBBIntersects (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const boost::uint32_t query_depth, std::list<std::string> &bin_name) const;
 
+        /** \brief Get the nodes holding data at query_depth which intersect with the bounding box specified by \ref min and \ref max.
+         *
+         * \param[in] min The minimum corner of the bounding box
+         * \param[in] max The maximum corner of the bounding box
+         * \param[in] query_depth 0 is root, (this->depth) is full
+         * \param[out] nodes the nodes satisfying the query
+         */
+        void
+        queryBBIntersects (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const boost::uint32_t query_depth, std::vector<OutofcoreNodeType*> &nodes) const;
+
         /** \brief Get Points in BB, only points inside BB. The query
          * processes the data at each node, filtering points that fall
          * out of the query bounds, and returns a single, concatenated
@@ -464,6 +498,37 @@ namespace pcl
         void
         buildLOD ();
 
+        /** \brief Generate the LODs bottom-up using several threads.
+         *
+         * The internal nodes of one depth are filled concurrently, starting
+         * at the level above the leaves. Each node stores a uniform random
+         * sample of sample_percent_ of the points of each of its children, so
+         * a node at depth d holds about sample_percent^(max_depth-d) of the
+         * points below it, as with \ref buildLOD. Only the children are read
+         * from disk instead of all the leaves below the node.
+         *
+         * \note The filter set with \ref setLODFilter is not used, since a
+         * single filter object can not be shared between threads.
+         */
+        void
+        buildLODParallel ();
+
+        /** \brief Initialize the scheduler and set the number of threads to use.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get the number of threads used by the parallel bulk loader and LOD builder (0 means automatic). */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
         /** \brief Prints size of BBox to stdout
          */ 
         void
@@ -588,6 +653,14 @@ namespace pcl
         inline void
         incrementPointsInLOD (boost::uint64_t depth, boost::uint64_t inc);
 
+        /** \brief Sample the points of the children of node into its payload; used by \ref buildLODParallel
+         *  \param[in] node the internal node to fill
+         *  \param[in] seed the seed of the random generator used for this node
+         *  \return the number of points written to the node
+         */
+        boost::uint64_t
+        sampleChildrenToLOD (BranchNode* node, const boost::uint32_t seed);
+
         /** \brief Auxiliary function to validate path_name extension is .octree
          *  
          *  \return 0 if bad; 1 if extension is .oct_idx
@@ -643,6 +716,12 @@ namespace pcl
         double sample_percent_;
 
         pcl::RandomSample<sensor_msgs::PointCloud2>::Ptr lod_filter_ptr_;
+
+        /** \brief Number of threads used by the parallel bulk loader and LOD builder; 0 means automatic */
+        unsigned int threads_;
+
+        /** \brief Protects the LOD point counts of the metadata, which the parallel methods update concurrently */
+        boost::mutex lod_points_mutex_;
         
     };
   }
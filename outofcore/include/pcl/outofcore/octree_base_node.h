@@ -148,6 +148,16 @@ namespace pcl
         void
         queryFrustum (const double planes[24], const Eigen::Vector3d &eye, const Eigen::Matrix4d &view_projection_matrix, std::list<std::string>& file_names, const boost::uint32_t query_depth, const bool skip_vfc_check = false);
 
+        /** \brief Recursively collects the nodes holding data at \b query_depth which intersect the view frustum
+         *
+         *  \param[in] planes the six frustum planes (a, b, c, d), oriented towards the inside of the frustum
+         *  \param[in] query_depth the depth of the nodes to collect
+         *  \param[out] nodes the nodes satisfying the query
+         *  \param[in] skip_vfc_check skip the culling test for nodes known to be inside the frustum
+         */
+        void
+        queryFrustum (const double planes[24], const boost::uint32_t query_depth, std::vector<OutofcoreOctreeBaseNode*> &nodes, const bool skip_vfc_check = false);
+
         //point extraction
         /** \brief Recursively add points that fall into the queried bounding box up to the \b query_depth 
          *
@@ -187,6 +197,11 @@ namespace pcl
         virtual void
         queryBBIntersects (const Eigen::Vector3d &min_bb, const Eigen::Vector3d &max_bb, const boost::uint32_t query_depth, std::list<std::string> &file_names);
 
+        /** \brief Recursively collects the nodes holding data at \b query_depth with which the queried bounding box intersects
+         */
+        void
+        queryBBIntersects (const Eigen::Vector3d &min_bb, const Eigen::Vector3d &max_bb, const boost::uint32_t query_depth, std::vector<OutofcoreOctreeBaseNode*> &nodes);
+
         /** \brief Write the voxel size to stdout at \ref query_depth 
          * \param[in] query_depth The depth at which to print the size of the voxel/bounding boxes
          */
@@ -0,0 +1,306 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_COMPRESSED_CONTAINER_H_
+#define PCL_OUTOFCORE_OCTREE_COMPRESSED_CONTAINER_H_
+
+// C++
+#include <cstdio>
+#include <vector>
+#include <string>
+
+#include <pcl/outofcore/boost.h>
+#include <pcl/outofcore/octree_abstract_node_container.h>
+#include <sensor_msgs/PointCloud2.h>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcoreOctreeCompressedContainer
+     *
+     *  \brief Node container storing its points as compressed blocks in a per-node file
+     *
+     *  Drop-in alternative to \ref OutofcoreOctreeDiskContainer. Every call
+     *  to insertRange appends one self-describing block to the payload file
+     *  of the node (the path handed to the constructor with its extension
+     *  replaced by ".pcq"). The records of a block are byte-shuffled and LZF
+     *  compressed; blocks that do not compress are stored as is.
+     *
+     *  If a quantization resolution is set (\ref setQuantizationResolution),
+     *  the coordinates of a block are additionally stored as integer offsets
+     *  from the minimum corner of the block's bounding box, which lies inside
+     *  the bounding box of the node. The error introduced is at most half the
+     *  resolution per coordinate; all other fields of PointT are kept
+     *  lossless. Blocks are decompressed on read, and only the blocks
+     *  overlapping the requested range are touched.
+     *
+     *  \ingroup outofcore
+     */
+    template<typename PointT = pcl::PointXYZ>
+    class OutofcoreOctreeCompressedContainer : public OutofcoreAbstractNodeContainer<PointT>
+    {
+      public:
+        typedef typename OutofcoreAbstractNodeContainer<PointT>::AlignedPointTVector AlignedPointTVector;
+
+        /** \brief Opens the payload of a node, indexing the blocks already on disk
+         *
+         * If \b path is a directory, a uuid named payload inside it is
+         * created; otherwise \b path names the payload of the node.
+         *
+         * \param[in] path payload path of the node
+         */
+        OutofcoreOctreeCompressedContainer (const boost::filesystem::path &path);
+
+        ~OutofcoreOctreeCompressedContainer ();
+
+        /** \brief provides random access to points based on a linear index */
+        PointT
+        operator[] (uint64_t idx) const;
+
+        /** \brief Compresses a block of points and appends it to the payload of this node
+         *
+         * \param[in] start address of the first point to insert
+         * \param[in] count number of points to insert
+         */
+        void
+        insertRange (const PointT* start, const uint64_t count);
+
+        void
+        insertRange (const PointT* const * start, const uint64_t count);
+
+        /** \brief Inserts a vector of points into the payload of this node */
+        void
+        insertRange (const AlignedPointTVector& src);
+
+        /** \brief Inserts a PointCloud2 object, converted to PointT, into the payload of this node */
+        void
+        insertRange (const sensor_msgs::PointCloud2::Ptr &input_cloud);
+
+        /** \brief Reads \b count points starting at \b start and appends them to \b dst
+         *
+         * \param[in] start index of first point to read
+         * \param[in] count number of points to read
+         * \param[out] dst destination of the points read
+         */
+        void
+        readRange (const uint64_t start, const uint64_t count, AlignedPointTVector &dst);
+
+        /** \brief Reads \b count points starting at \b start into the PointCloud2 \b dst, replacing its contents */
+        void
+        readRange (const uint64_t start, const uint64_t count, sensor_msgs::PointCloud2::Ptr &dst);
+
+        /** \brief Reads the entire payload into \b output_cloud, concatenating if it already holds points
+         *  \param[out] output_cloud
+         */
+        int
+        read (sensor_msgs::PointCloud2::Ptr &output_cloud);
+
+        /** \brief grab percent*count random points. points are \b not guaranteed to be
+         * unique (could have multiple identical points!)
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The percentage of count that is enough points to make up this random sample
+         * \param[out] dst std::vector as destination for randomly sampled points
+         */
+        void
+        readRangeSubSample (const uint64_t start, const uint64_t count, const double percent,
+                            AlignedPointTVector &dst);
+
+        /** \brief Use bernoulli trials to select points. All points selected will be unique.
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The probability with which every point is selected
+         * \param[out] dst std::vector as destination for randomly sampled points
+         */
+        void
+        readRangeSubSample_bernoulli (const uint64_t start, const uint64_t count,
+                                      const double percent, AlignedPointTVector& dst);
+
+        /** \brief Returns the number of points stored for this node, answered from the in-memory block index */
+        uint64_t
+        size () const
+        {
+          return (point_count_);
+        }
+
+        /** \brief STL-like empty test */
+        inline bool
+        empty () const
+        {
+          return (size () == 0);
+        }
+
+        /** \brief Blocks are written through on insertion, nothing to flush */
+        void
+        flush (const bool)
+        {
+        }
+
+        /** \brief Returns the payload path of this node */
+        inline std::string&
+        path ()
+        {
+          return (path_);
+        }
+
+        /** \brief Removes the payload file of this node */
+        void
+        clear ();
+
+        /** \brief write points to disk as ascii
+         *
+         * \param[in] path
+         */
+        void
+        convertToXYZ (const boost::filesystem::path &path);
+
+        /** \brief Returns the number of points in the payload, same as \ref size */
+        boost::uint64_t
+        getDataSize () const
+        {
+          return (size ());
+        }
+
+        /** \brief Returns the number of bytes the payload occupies on disk */
+        uint64_t
+        getStoredBytes () const
+        {
+          return (file_size_);
+        }
+
+        /** \brief Sets the quantization step used for the coordinates of blocks inserted from now on
+         *
+         * A resolution of 0 (the default) stores coordinates lossless. The
+         * setting is shared by all compressed containers of a point type and
+         * does not affect blocks already written, which record their own step.
+         *
+         * \param[in] resolution quantization step in the units of the point coordinates
+         */
+        static void
+        setQuantizationResolution (const double resolution)
+        {
+          quantization_resolution_ = resolution > 0 ? resolution : 0;
+        }
+
+        /** \brief Returns the quantization step for the coordinates of new blocks, 0 if lossless */
+        static double
+        getQuantizationResolution ()
+        {
+          return (quantization_resolution_);
+        }
+
+      private:
+        /** \brief On-disk header preceding every block of the payload */
+        struct BlockHeader
+        {
+          char magic[4];
+          /** \brief number of points in the block */
+          uint32_t count;
+          /** \brief size of the shuffled block before compression */
+          uint32_t raw_bytes;
+          /** \brief size of the compressed block, 0 if the block is stored uncompressed */
+          uint32_t compressed_bytes;
+          /** \brief bits per quantized coordinate, 0 if the coordinates are stored lossless */
+          uint32_t bits;
+          uint32_t reserved;
+          /** \brief minimum corner of the bounding box of the block */
+          double origin[3];
+          /** \brief quantization step */
+          double step;
+        };
+
+        /** \brief Location of a block inside the payload file */
+        struct BlockEntry
+        {
+          /** \brief file offset of the block header */
+          uint64_t offset;
+          /** \brief index of the first point of the block */
+          uint64_t first;
+          /** \brief number of points in the block */
+          uint64_t count;
+        };
+
+        //no copy construction
+        OutofcoreOctreeCompressedContainer (const OutofcoreOctreeCompressedContainer &);
+
+        OutofcoreOctreeCompressedContainer&
+        operator= (const OutofcoreOctreeCompressedContainer &);
+
+        /** \brief Builds the block index from the headers of the payload file */
+        void
+        scanBlocks ();
+
+        /** \brief Encodes \b count points into a block, header included */
+        static void
+        encodeBlock (const PointT* points, const uint32_t count, std::vector<char> &block);
+
+        /** \brief Decodes the block at \b entry of the open payload file, appending its points to \b dst */
+        void
+        decodeBlock (FILE* file, const BlockEntry &entry, AlignedPointTVector &dst) const;
+
+        /** \brief Reads the points [start, start + count) of the payload into \b dst, appending */
+        void
+        readPoints (const uint64_t start, const uint64_t count, AlignedPointTVector &dst) const;
+
+        /** \brief Payload path of the node as handed to the constructor */
+        std::string path_;
+
+        /** \brief Path of the compressed payload file */
+        std::string file_path_;
+
+        /** \brief Blocks of the payload in insertion order */
+        std::vector<BlockEntry> blocks_;
+
+        /** \brief Total number of points of all blocks */
+        uint64_t point_count_;
+
+        /** \brief Size of the payload file */
+        uint64_t file_size_;
+
+        static double quantization_resolution_;
+
+        static boost::mutex rng_mutex_;
+        static boost::mt19937 rand_gen_;
+    };
+  } //namespace outofcore
+} //namespace pcl
+
+#endif //PCL_OUTOFCORE_OCTREE_COMPRESSED_CONTAINER_H_
@@ -0,0 +1,244 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_PACKED_CONTAINER_H_
+#define PCL_OUTOFCORE_OCTREE_PACKED_CONTAINER_H_
+
+// C++
+#include <vector>
+#include <string>
+
+#include <pcl/outofcore/boost.h>
+#include <pcl/outofcore/octree_abstract_node_container.h>
+#include <pcl/outofcore/packed_segment_store.h>
+#include <sensor_msgs/PointCloud2.h>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcoreOctreePackedContainer
+     *
+     *  \brief Node container storing its points in the packed segment store of the tree
+     *
+     *  Drop-in alternative to \ref OutofcoreOctreeDiskContainer. The path
+     *  handed to the constructor is only used as a key: the points of all
+     *  nodes of a tree are appended to the segment files of a single
+     *  \ref OutofcorePackedSegmentStore in the root directory of the tree, so
+     *  no per-node payload files are created and size queries do not touch
+     *  the disk. Points are stored as raw PointT records; PointCloud2 input is
+     *  converted to PointT, fields that PointT does not have are dropped.
+     *
+     *  \ingroup outofcore
+     */
+    template<typename PointT = pcl::PointXYZ>
+    class OutofcoreOctreePackedContainer : public OutofcoreAbstractNodeContainer<PointT>
+    {
+      public:
+        typedef typename OutofcoreAbstractNodeContainer<PointT>::AlignedPointTVector AlignedPointTVector;
+
+        /** \brief Attaches the container to the packed store responsible for \b path
+         *
+         * If \b path is a directory, a uuid named payload inside it is
+         * created; otherwise \b path is the payload file name of the node,
+         * which does not need to exist on disk.
+         *
+         * \param[in] path payload path of the node
+         */
+        OutofcoreOctreePackedContainer (const boost::filesystem::path &path);
+
+        /** \brief flushes the offset index of the store */
+        ~OutofcoreOctreePackedContainer ();
+
+        /** \brief provides random access to points based on a linear index */
+        PointT
+        operator[] (uint64_t idx) const;
+
+        /** \brief Appends a block of points to the payload of this node
+         *
+         * \param[in] start address of the first point to insert
+         * \param[in] count number of points to insert
+         */
+        void
+        insertRange (const PointT* start, const uint64_t count);
+
+        void
+        insertRange (const PointT* const * start, const uint64_t count);
+
+        /** \brief Inserts a vector of points into the payload of this node */
+        void
+        insertRange (const AlignedPointTVector& src);
+
+        /** \brief Inserts a PointCloud2 object, converted to PointT, into the payload of this node */
+        void
+        insertRange (const sensor_msgs::PointCloud2::Ptr &input_cloud);
+
+        /** \brief Reads \b count points starting at \b start and appends them to \b dst
+         *
+         * \param[in] start index of first point to read
+         * \param[in] count number of points to read
+         * \param[out] dst destination of the points read
+         */
+        void
+        readRange (const uint64_t start, const uint64_t count, AlignedPointTVector &dst);
+
+        /** \brief Reads \b count points starting at \b start into the PointCloud2 \b dst, replacing its contents */
+        void
+        readRange (const uint64_t start, const uint64_t count, sensor_msgs::PointCloud2::Ptr &dst);
+
+        /** \brief Reads the entire payload into \b output_cloud, concatenating if it already holds points
+         *  \param[out] output_cloud
+         */
+        int
+        read (sensor_msgs::PointCloud2::Ptr &output_cloud);
+
+        /** \brief grab percent*count random points. points are \b not guaranteed to be
+         * unique (could have multiple identical points!)
+         *
+         * The range is read with a single sequential read and sampled in memory.
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The percentage of count that is enough points to make up this random sample
+         * \param[out] dst std::vector as destination for randomly sampled points
+         */
+        void
+        readRangeSubSample (const uint64_t start, const uint64_t count, const double percent,
+                            AlignedPointTVector &dst);
+
+        /** \brief Use bernoulli trials to select points. All points selected will be unique.
+         *
+         * \param[in] start The starting index of points to select
+         * \param[in] count The length of the range of points from which to randomly sample
+         * \param[in] percent The probability with which every point is selected
+         * \param[out] dst std::vector as destination for randomly sampled points
+         */
+        void
+        readRangeSubSample_bernoulli (const uint64_t start, const uint64_t count,
+                                      const double percent, AlignedPointTVector& dst);
+
+        /** \brief Returns the number of points stored for this node, answered from the in-memory index */
+        uint64_t
+        size () const
+        {
+          return (store_->getPointCount (key_));
+        }
+
+        /** \brief STL-like empty test */
+        inline bool
+        empty () const
+        {
+          return (size () == 0);
+        }
+
+        /** \brief Flushes the offset index of the store */
+        void
+        flush (const bool)
+        {
+          store_->flush ();
+        }
+
+        /** \brief Returns the payload path of this node */
+        inline std::string&
+        path ()
+        {
+          return (path_);
+        }
+
+        /** \brief Drops the points of this node; the space is reclaimed when the store is compacted */
+        inline void
+        clear ()
+        {
+          store_->erase (key_);
+        }
+
+        /** \brief write points to disk as ascii
+         *
+         * \param[in] path
+         */
+        void
+        convertToXYZ (const boost::filesystem::path &path);
+
+        /** \brief Returns the number of points in the payload, same as \ref size */
+        boost::uint64_t
+        getDataSize () const
+        {
+          return (size ());
+        }
+
+        /** \brief Returns the store holding the payload of this node, e.g. to compact it after building a tree */
+        inline OutofcorePackedSegmentStore::Ptr
+        getStore () const
+        {
+          return (store_);
+        }
+
+        /** \brief Returns the key of the payload of this node inside the store */
+        inline const std::string&
+        getKey () const
+        {
+          return (key_);
+        }
+
+      private:
+        //no copy construction
+        OutofcoreOctreePackedContainer (const OutofcoreOctreePackedContainer &);
+
+        OutofcoreOctreePackedContainer&
+        operator= (const OutofcoreOctreePackedContainer &);
+
+        /** \brief Reads the points [start, start + count) of the payload into \b dst, appending */
+        void
+        readPoints (const uint64_t start, const uint64_t count, AlignedPointTVector &dst) const;
+
+        /** \brief Shared store of the tree */
+        OutofcorePackedSegmentStore::Ptr store_;
+
+        /** \brief Key of this payload inside the store */
+        std::string key_;
+
+        /** \brief Payload path of the node */
+        std::string path_;
+
+        static boost::mutex rng_mutex_;
+        static boost::mt19937 rand_gen_;
+    };
+  } //namespace outofcore
+} //namespace pcl
+
+#endif //PCL_OUTOFCORE_OCTREE_PACKED_CONTAINER_H_
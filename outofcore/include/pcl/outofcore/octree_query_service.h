@@ -0,0 +1,287 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_OCTREE_QUERY_SERVICE_H_
+#define PCL_OUTOFCORE_OCTREE_QUERY_SERVICE_H_
+
+// C++
+#include <deque>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <pcl/outofcore/boost.h>
+#include <pcl/outofcore/octree_base.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/future.hpp>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcoreOctreeQueryService
+     *
+     *  \brief Asynchronous, cached access to the node payloads of an out-of-core octree
+     *
+     *  Requests are served by a pool of worker threads which read the
+     *  payloads of the requested nodes into sensor_msgs::PointCloud2 blobs.
+     *  The decoded payloads are kept in an LRU cache bounded by their size in
+     *  bytes, so revisiting a part of the tree does not touch the disk.
+     *  Completion is delivered through futures and optional callbacks;
+     *  callbacks run on a worker thread, or on the calling thread when the
+     *  payload is already cached.
+     *
+     *  Box and frustum queries also prefetch, at a lower priority than the
+     *  nodes that were asked for, the next level of detail inside the
+     *  queried region and, for frustum queries, the nodes surrounding the
+     *  view at the queried depth. Prefetches still waiting in the queue are
+     *  dropped when the next frustum is queried.
+     *
+     *  \note The tree must not be modified while requests are pending.
+     *  \ingroup outofcore
+     */
+    template<typename ContainerT = OutofcoreOctreeDiskContainer<pcl::PointXYZ>, typename PointT = pcl::PointXYZ>
+    class OutofcoreOctreeQueryService : boost::noncopyable
+    {
+      public:
+        typedef OutofcoreOctreeBase<ContainerT, PointT> OctreeT;
+        typedef boost::shared_ptr<OctreeT> OctreePtr;
+        typedef typename OctreeT::OutofcoreNodeType NodeT;
+
+        typedef sensor_msgs::PointCloud2::ConstPtr PayloadConstPtr;
+        typedef boost::shared_future<PayloadConstPtr> PayloadFuture;
+
+        /** \brief Completion callback, called with the node and its payload; the payload is empty if the node could not be read */
+        typedef boost::function<void (NodeT*, const PayloadConstPtr&)> Callback;
+
+        /** \brief Starts the worker pool
+         * \param[in] octree the tree to read the payloads from
+         * \param[in] nr_workers the number of worker threads (at least one is started)
+         * \param[in] cache_capacity the maximum size of the cached payloads in bytes
+         */
+        OutofcoreOctreeQueryService (const OctreePtr &octree, const unsigned int nr_workers = 2, const boost::uint64_t cache_capacity = 256 * 1024 * 1024);
+
+        /** \brief Stops the worker pool; requests that have not completed yet are abandoned */
+        ~OutofcoreOctreeQueryService ();
+
+        /** \brief Requests the payload of a single node
+         * \param[in] node the node to read
+         * \param[in] callback optional completion callback
+         * \return a future holding the payload once it has been read
+         */
+        PayloadFuture
+        requestNode (NodeT *node, const Callback &callback = Callback ());
+
+        /** \brief Requests the payloads of all nodes at query_depth which intersect the bounding box
+         *
+         * Nodes are requested nearest to the center of the box first; the
+         * next level of detail of the box is prefetched.
+         *
+         * \param[in] min the minimum corner of the bounding box
+         * \param[in] max the maximum corner of the bounding box
+         * \param[in] query_depth 0 is root, (octree depth) is full
+         * \param[out] nodes the nodes satisfying the query
+         * \param[out] payloads the futures of the payloads of \b nodes, in the same order
+         * \param[in] callback optional callback, called once per node
+         */
+        void
+        queryBoundingBox (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const boost::uint32_t query_depth,
+                          std::vector<NodeT*> &nodes, std::vector<PayloadFuture> &payloads, const Callback &callback = Callback ());
+
+        /** \brief Requests the payloads of all nodes at query_depth inside the view frustum
+         *
+         * Nodes are requested nearest to the eye first. Pending prefetches of
+         * the previous view are dropped; the next level of detail inside the
+         * frustum and the nodes surrounding the view are prefetched.
+         *
+         * \param[in] planes the six frustum planes (a, b, c, d), oriented towards the inside of the frustum
+         * \param[in] eye the position of the camera
+         * \param[in] query_depth 0 is root, (octree depth) is full
+         * \param[out] nodes the nodes satisfying the query
+         * \param[out] payloads the futures of the payloads of \b nodes, in the same order
+         * \param[in] callback optional callback, called once per node
+         */
+        void
+        queryFrustum (const double *planes, const Eigen::Vector3d &eye, const boost::uint32_t query_depth,
+                      std::vector<NodeT*> &nodes, std::vector<PayloadFuture> &payloads, const Callback &callback = Callback ());
+
+        /** \brief Queues the nodes at query_depth which intersect the bounding box for reading into the cache, at low priority */
+        void
+        prefetchBoundingBox (const Eigen::Vector3d &min, const Eigen::Vector3d &max, const boost::uint32_t query_depth);
+
+        /** \brief Drops the prefetches which have not been started yet */
+        void
+        cancelPrefetch ();
+
+        /** \brief Blocks until all queued requests and prefetches have completed */
+        void
+        waitUntilIdle ();
+
+        /** \brief Looks up the payload of a node in the cache without queuing a request
+         * \return true if the payload was cached
+         */
+        bool
+        getCachedPayload (NodeT *node, PayloadConstPtr &payload);
+
+        /** \brief Removes all payloads from the cache */
+        void
+        clearCache ();
+
+        /** \brief Sets the maximum size of the cached payloads in bytes, evicting the least recently used payloads if needed */
+        void
+        setCacheCapacity (const boost::uint64_t cache_capacity);
+
+        /** \brief Returns the maximum size of the cached payloads in bytes */
+        boost::uint64_t
+        getCacheCapacity () const;
+
+        /** \brief Returns the size of the cached payloads in bytes */
+        boost::uint64_t
+        getCacheUsage () const;
+
+        /** \brief Returns the number of nodes whose payload is cached */
+        size_t
+        getNumCachedNodes () const;
+
+        /** \brief Returns the number of requests served from the cache */
+        boost::uint64_t
+        getNumCacheHits () const;
+
+        /** \brief Returns the number of requests which had to be read from the tree */
+        boost::uint64_t
+        getNumCacheMisses () const;
+
+        /** \brief Enables or disables the prefetching of box and frustum queries (enabled by default) */
+        inline void
+        setPrefetch (const bool prefetch)
+        {
+          prefetch_ = prefetch;
+        }
+
+        /** \brief Returns whether box and frustum queries prefetch */
+        inline bool
+        getPrefetch () const
+        {
+          return (prefetch_);
+        }
+
+      protected:
+        /** \brief A request waiting for a node */
+        struct Waiter
+        {
+          boost::shared_ptr<boost::promise<PayloadConstPtr> > promise;
+          Callback callback;
+        };
+
+        /** \brief A cached payload and its position in the LRU list */
+        struct CacheEntry
+        {
+          PayloadConstPtr payload;
+          boost::uint64_t bytes;
+          typename std::list<NodeT*>::iterator lru;
+        };
+
+        /** \brief Serves the queues until the service is destroyed */
+        void
+        workerLoop ();
+
+        /** \brief Queues a node for reading; with a waiter the node is a demand request, otherwise a prefetch */
+        void
+        enqueue (NodeT *node, const Waiter *waiter);
+
+        /** \brief Inserts a payload into the cache and evicts down to the capacity; the mutex must be held */
+        void
+        insertIntoCache (NodeT *node, const PayloadConstPtr &payload);
+
+        /** \brief Evicts the least recently used payloads until the usage is at most \b capacity; the mutex must be held */
+        void
+        evict (const boost::uint64_t capacity);
+
+        /** \brief Sorts the nodes by the distance of their centers to a point */
+        static void
+        sortByDistance (const Eigen::Vector3d &point, std::vector<NodeT*> &nodes);
+
+        /** \brief The tree the payloads are read from */
+        OctreePtr octree_;
+
+        /** \brief The worker pool */
+        boost::thread_group workers_;
+
+        /** \brief Protects the queues, the pending requests and the cache */
+        mutable boost::mutex mutex_;
+
+        /** \brief Signalled when work is queued or the service stops */
+        boost::condition_variable work_cond_;
+
+        /** \brief Signalled when the queues run empty */
+        boost::condition_variable idle_cond_;
+
+        /** \brief Nodes requested by queries, served first */
+        std::deque<NodeT*> demand_queue_;
+
+        /** \brief Nodes queued by prefetching */
+        std::deque<NodeT*> prefetch_queue_;
+
+        /** \brief Requests waiting for each queued or loading node */
+        std::map<NodeT*, std::vector<Waiter> > pending_;
+
+        /** \brief Nodes currently read by a worker */
+        std::set<NodeT*> loading_;
+
+        /** \brief Cached payloads */
+        std::map<NodeT*, CacheEntry> cache_;
+
+        /** \brief Cached nodes, most recently used first */
+        std::list<NodeT*> lru_;
+
+        boost::uint64_t cache_capacity_;
+        boost::uint64_t cache_usage_;
+        boost::uint64_t cache_hits_;
+        boost::uint64_t cache_misses_;
+
+        bool prefetch_;
+        bool stop_;
+    };
+  }
+}
+
+#endif // PCL_OUTOFCORE_OCTREE_QUERY_SERVICE_H_
@@ -50,8 +50,12 @@
 
 #include <pcl/outofcore/octree_disk_container.h>
 #include <pcl/outofcore/octree_ram_container.h>
+#include <pcl/outofcore/octree_packed_container.h>
+#include <pcl/outofcore/octree_compressed_container.h>
 
 #include <pcl/outofcore/outofcore_iterator_base.h>
 #include <pcl/outofcore/outofcore_depth_first_iterator.h>
 
+#include <pcl/outofcore/octree_query_service.h>
+
 #endif // OUTOFCORE_H_
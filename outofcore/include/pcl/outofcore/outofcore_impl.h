@@ -47,5 +47,9 @@
 
 #include <pcl/outofcore/impl/octree_disk_container.hpp>
 #include <pcl/outofcore/impl/octree_ram_container.hpp>
+#include <pcl/outofcore/impl/octree_packed_container.hpp>
+#include <pcl/outofcore/impl/octree_compressed_container.hpp>
+
+#include <pcl/outofcore/impl/octree_query_service.hpp>
 
 #endif //OUTOFCORE_IMPL_H_
@@ -0,0 +1,289 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ */
+
+#ifndef PCL_OUTOFCORE_PACKED_SEGMENT_STORE_H_
+#define PCL_OUTOFCORE_PACKED_SEGMENT_STORE_H_
+
+#include <pcl/pcl_macros.h>
+#include <pcl/outofcore/boost.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    /** \class OutofcorePackedSegmentStore
+     *
+     *  \brief Shared, single directory storage for the point payloads of all nodes of an outofcore octree.
+     *
+     *  Instead of one PCD file per node, the payloads are appended to a few
+     *  large segment files (payload_NNNNNN.pack) in the root directory of the
+     *  tree. Every append writes one extent and one record to an append-only
+     *  offset index (payload.pack_idx), which is replayed when the store is
+     *  opened. A node payload is the ordered chain of its extents, keyed by
+     *  the path of the node's payload file relative to the root directory.
+     *
+     *  Payload sizes are answered from the in-memory index, so no file is
+     *  touched while traversing the tree. Reads go through pread on POSIX
+     *  systems, adjacent extents are merged into a single read and small reads
+     *  are served from a read-ahead window. \ref compact rewrites all live
+     *  payloads in depth-first order of the octree, one extent per node, so
+     *  that a query traversal reads the segments front to back.
+     *
+     *  Stores are shared per root directory within a process; use \ref open
+     *  or \ref locate rather than constructing them directly. Appends and reads
+     *  are thread safe; \ref compact must not run concurrently with other
+     *  accesses to the same store.
+     *
+     *  \ingroup outofcore
+     */
+    class PCL_EXPORTS OutofcorePackedSegmentStore
+    {
+      public:
+        typedef boost::shared_ptr<OutofcorePackedSegmentStore> Ptr;
+        typedef boost::shared_ptr<const OutofcorePackedSegmentStore> ConstPtr;
+
+        /** \brief Closes the segment files and flushes the offset index */
+        ~OutofcorePackedSegmentStore ();
+
+        /** \brief Open the store rooted at \b root_dir, creating it if it does not exist yet.
+         *  Returns the instance already open in this process if there is one.
+         *  \param[in] root_dir directory holding the segment files and the offset index
+         */
+        static Ptr
+        open (const boost::filesystem::path &root_dir);
+
+        /** \brief Find the store responsible for a node payload path.
+         *
+         *  Walks up the parent directories of \b payload_path until an open
+         *  store or an existing offset index is found. If there is none, a new
+         *  store is created in the directory of \b payload_path, i.e. the
+         *  first node created (the root) decides where the store of the tree lives.
+         *
+         *  \param[in] payload_path path of the payload file of a node
+         *  \param[out] key the key of the node payload inside the returned store
+         */
+        static Ptr
+        locate (const boost::filesystem::path &payload_path, std::string &key);
+
+        /** \brief Append \b bytes bytes holding \b count points to the payload of \b key */
+        void
+        append (const std::string &key, const void *data, const uint64_t bytes, const uint64_t count);
+
+        /** \brief Read \b bytes bytes starting at byte \b offset of the payload of \b key into \b dst
+         *  \return false if the range exceeds the payload or a read failed
+         */
+        bool
+        read (const std::string &key, const uint64_t offset, const uint64_t bytes, char *dst) const;
+
+        /** \brief Read the whole payload of \b key into \b dst, replacing its contents */
+        bool
+        read (const std::string &key, std::vector<char> &dst) const;
+
+        /** \brief Number of points stored for \b key */
+        uint64_t
+        getPointCount (const std::string &key) const;
+
+        /** \brief Number of payload bytes stored for \b key */
+        uint64_t
+        getByteCount (const std::string &key) const;
+
+        /** \brief Drop the payload of \b key. The space is reclaimed by \ref compact. */
+        void
+        erase (const std::string &key);
+
+        /** \brief Flush the offset index to disk */
+        void
+        flush ();
+
+        /** \brief Rewrite all live payloads in depth-first order of the node
+         *  directories, merging every payload into a single extent, and remove
+         *  the segment files that are no longer referenced.
+         */
+        void
+        compact ();
+
+        /** \brief Set the size at which a new segment file is started (default 1 GiB) */
+        void
+        setMaxSegmentSize (const uint64_t bytes);
+
+        /** \brief Get the size at which a new segment file is started */
+        uint64_t
+        getMaxSegmentSize () const;
+
+        /** \brief Set the size of the read-ahead window; 0 disables read-ahead (default 4 MiB) */
+        void
+        setReadAheadSize (const uint64_t bytes);
+
+        /** \brief Get the size of the read-ahead window */
+        uint64_t
+        getReadAheadSize () const;
+
+        /** \brief Number of segment files referenced by the index */
+        size_t
+        getNumSegments () const;
+
+        /** \brief Number of payloads with at least one point */
+        size_t
+        getNumPayloads () const;
+
+        /** \brief Get the directory the store lives in */
+        const boost::filesystem::path&
+        getRootDirectory () const
+        {
+          return (root_dir_);
+        }
+
+        /** \brief Name of the offset index file inside the root directory */
+        static const std::string index_filename;
+
+        /** \brief Extension of the segment files */
+        static const std::string segment_extension;
+
+      private:
+        /** \brief A contiguous run of payload bytes inside one segment file */
+        struct Extent
+        {
+          boost::uint32_t segment;
+          boost::uint64_t offset;
+          boost::uint64_t bytes;
+          boost::uint64_t count;
+        };
+
+        /** \brief The extents of one payload, in insertion order */
+        struct Payload
+        {
+          Payload () : extents (), bytes (0), count (0) {}
+
+          std::vector<Extent> extents;
+          boost::uint64_t bytes;
+          boost::uint64_t count;
+        };
+
+        /** \brief An open segment file */
+        struct Segment
+        {
+          Segment () : handle (-1), file (NULL), size (0) {}
+
+          int handle;
+          FILE *file;
+          boost::uint64_t size;
+        };
+
+        typedef std::map<std::string, Payload> PayloadMap;
+        typedef std::map<boost::uint32_t, Segment> SegmentMap;
+
+        explicit
+        OutofcorePackedSegmentStore (const boost::filesystem::path &root_dir);
+
+        // no copies, stores are shared through Ptr
+        OutofcorePackedSegmentStore (const OutofcorePackedSegmentStore &);
+        OutofcorePackedSegmentStore&
+        operator= (const OutofcorePackedSegmentStore &);
+
+        /** \brief Replay the offset index, returns false if it is not a packed store index */
+        bool
+        loadIndex ();
+
+        /** \brief Write the index file header, or a full index when \b payloads is given */
+        bool
+        writeIndex (const boost::filesystem::path &file, const PayloadMap *payloads);
+
+        void
+        writeRecord (FILE *f, const std::string &key, const Extent &extent);
+
+        boost::filesystem::path
+        getSegmentPath (const boost::uint32_t id) const;
+
+        /** \brief Open (or create) a segment file; caller holds \ref mutex_ */
+        Segment&
+        getSegment (const boost::uint32_t id) const;
+
+        /** \brief Append raw bytes to the current segment; caller holds \ref mutex_ */
+        Extent
+        appendToSegment (const void *data, const uint64_t bytes, const uint64_t count);
+
+        /** \brief Read a run of bytes from a segment, through the read-ahead window if it is small */
+        bool
+        readSegment (const boost::uint32_t id, const uint64_t offset, const uint64_t bytes, char *dst) const;
+
+        /** \brief Read from a segment file without caching */
+        bool
+        readSegmentDirect (Segment &segment, const uint64_t offset, const uint64_t bytes, char *dst) const;
+
+        void
+        closeSegments ();
+
+        /** \brief Depth-first order of payload keys; an ancestor directory sorts before its children */
+        static bool
+        depthFirstLess (const std::string &a, const std::string &b);
+
+        boost::filesystem::path root_dir_;
+
+        PayloadMap payloads_;
+
+        mutable SegmentMap segments_;
+
+        boost::uint32_t append_segment_;
+
+        FILE *index_file_;
+
+        uint64_t max_segment_size_;
+
+        uint64_t read_ahead_size_;
+
+        /** \brief Guards the payload map, the segment table and appends */
+        mutable boost::mutex mutex_;
+
+        /** \brief Guards the read-ahead window */
+        mutable boost::mutex window_mutex_;
+        mutable std::vector<char> window_;
+        mutable boost::uint32_t window_segment_;
+        mutable boost::uint64_t window_offset_;
+
+        static boost::mutex registry_mutex_;
+        static std::map<std::string, boost::weak_ptr<OutofcorePackedSegmentStore> > registry_;
+    };
+  }//namespace outofcore
+}//namespace pcl
+
+#endif //PCL_OUTOFCORE_PACKED_SEGMENT_STORE_H_
@@ -0,0 +1,812 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2010-2012, Willow Garage, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  $Id$
+ *
+ */
+
+#include <pcl/outofcore/packed_segment_store.h>
+
+#include <pcl/pcl_macros.h>
+#include <pcl/exceptions.h>
+#include <pcl/console/print.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <sstream>
+#include <iomanip>
+
+#ifdef _WIN32
+//allows 64 bit seeks on the segment files
+# define pcl_fseek64 _fseeki64
+# define pcl_ftell64 _ftelli64
+# include <io.h>
+#else
+# include <fcntl.h>
+# include <unistd.h>
+# include <sys/types.h>
+#endif
+
+namespace pcl
+{
+  namespace outofcore
+  {
+    const std::string OutofcorePackedSegmentStore::index_filename = "payload.pack_idx";
+    const std::string OutofcorePackedSegmentStore::segment_extension = ".pack";
+
+    boost::mutex OutofcorePackedSegmentStore::registry_mutex_;
+    std::map<std::string, boost::weak_ptr<OutofcorePackedSegmentStore> > OutofcorePackedSegmentStore::registry_;
+
+    namespace
+    {
+      /** \brief Magic number at the start of the offset index, followed by the records */
+      const char pack_index_magic[8] = {'P', 'C', 'L', 'P', 'A', 'C', 'K', '1'};
+
+      /** \brief Segment id of a record dropping the payload of its key */
+      const boost::uint32_t pack_tombstone = 0xFFFFFFFFu;
+
+      /** \brief Cut a file off after its first size bytes */
+      bool
+      truncateFile (const boost::filesystem::path &file, boost::uint64_t size)
+      {
+#ifdef _WIN32
+        FILE *f = fopen (file.string ().c_str (), "r+b");
+        if (f == NULL)
+          return (false);
+        const bool ok = (_chsize_s (_fileno (f), static_cast<__int64> (size)) == 0);
+        fclose (f);
+        return (ok);
+#else
+        const int fd = ::open (file.string ().c_str (), O_WRONLY);
+        if (fd < 0)
+          return (false);
+        const bool ok = (ftruncate (fd, static_cast<off_t> (size)) == 0);
+        ::close (fd);
+        return (ok);
+#endif
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcorePackedSegmentStore::OutofcorePackedSegmentStore (const boost::filesystem::path &root_dir)
+      : root_dir_ (root_dir.empty () ? boost::filesystem::path (".") : root_dir)
+      , payloads_ ()
+      , segments_ ()
+      , append_segment_ (0)
+      , index_file_ (NULL)
+      , max_segment_size_ (static_cast<uint64_t> (1) << 30)
+      , read_ahead_size_ (static_cast<uint64_t> (4) << 20)
+      , mutex_ ()
+      , window_mutex_ ()
+      , window_ ()
+      , window_segment_ (0)
+      , window_offset_ (0)
+    {
+      if (!boost::filesystem::exists (root_dir_))
+        boost::filesystem::create_directories (root_dir_);
+
+      const boost::filesystem::path index = root_dir_ / index_filename;
+      if (boost::filesystem::exists (index))
+      {
+        if (!loadIndex ())
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore] %s is not a packed payload index\n", index.string ().c_str ());
+          PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcorePackedSegmentStore] Outofcore Exception: bad payload index");
+        }
+      }
+      else if (!writeIndex (index, NULL))
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore] Could not create %s\n", index.string ().c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcorePackedSegmentStore] Outofcore Exception: could not create payload index");
+      }
+
+      index_file_ = fopen (index.string ().c_str (), "ab");
+      if (index_file_ == NULL)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore] Could not open %s for appending\n", index.string ().c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcorePackedSegmentStore] Outofcore Exception: could not open payload index");
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcorePackedSegmentStore::~OutofcorePackedSegmentStore ()
+    {
+      if (index_file_ != NULL)
+        fclose (index_file_);
+      closeSegments ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcorePackedSegmentStore::Ptr
+    OutofcorePackedSegmentStore::open (const boost::filesystem::path &root_dir)
+    {
+      boost::mutex::scoped_lock lock (registry_mutex_);
+
+      std::map<std::string, boost::weak_ptr<OutofcorePackedSegmentStore> >::iterator it = registry_.find (root_dir.string ());
+      if (it != registry_.end ())
+      {
+        Ptr store = it->second.lock ();
+        if (store)
+          return (store);
+      }
+
+      Ptr store (new OutofcorePackedSegmentStore (root_dir));
+      registry_[root_dir.string ()] = store;
+      return (store);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcorePackedSegmentStore::Ptr
+    OutofcorePackedSegmentStore::locate (const boost::filesystem::path &payload_path, std::string &key)
+    {
+      // candidate root directories from the payload directory upwards, with
+      // the payload key relative to each of them
+      std::vector<boost::filesystem::path> candidates;
+      std::vector<std::string> keys;
+
+      std::string relative = payload_path.filename ().string ();
+      boost::filesystem::path dir = payload_path.parent_path ();
+      while (true)
+      {
+        candidates.push_back (dir);
+        keys.push_back (relative);
+        if (!dir.has_parent_path ())
+          break;
+        relative = dir.filename ().string () + "/" + relative;
+        dir = dir.parent_path ();
+      }
+
+      // stores opened by this process first, this avoids touching the
+      // filesystem for every node of a tree that is being built or loaded
+      {
+        boost::mutex::scoped_lock lock (registry_mutex_);
+        for (size_t i = 0; i < candidates.size (); ++i)
+        {
+          std::map<std::string, boost::weak_ptr<OutofcorePackedSegmentStore> >::iterator it = registry_.find (candidates[i].string ());
+          if (it != registry_.end () && !it->second.expired ())
+          {
+            key = keys[i];
+            Ptr store = it->second.lock ();
+            if (store)
+              return (store);
+          }
+        }
+      }
+
+      for (size_t i = 0; i < candidates.size (); ++i)
+      {
+        const boost::filesystem::path dir_i = candidates[i].empty () ? boost::filesystem::path (".") : candidates[i];
+        if (boost::filesystem::exists (dir_i / index_filename))
+        {
+          key = keys[i];
+          return (open (candidates[i]));
+        }
+      }
+
+      key = keys.front ();
+      return (open (candidates.front ()));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::append (const std::string &key, const void *data, const uint64_t bytes, const uint64_t count)
+    {
+      if (bytes == 0)
+        return;
+
+      boost::mutex::scoped_lock lock (mutex_);
+
+      Extent extent = appendToSegment (data, bytes, count);
+      writeRecord (index_file_, key, extent);
+
+      Payload &payload = payloads_[key];
+      payload.extents.push_back (extent);
+      payload.bytes += bytes;
+      payload.count += count;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcorePackedSegmentStore::read (const std::string &key, const uint64_t offset, const uint64_t bytes, char *dst) const
+    {
+      std::vector<Extent> extents;
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        PayloadMap::const_iterator it = payloads_.find (key);
+        if (it == payloads_.end ())
+          return (bytes == 0);
+        if (offset + bytes > it->second.bytes)
+          return (false);
+        extents = it->second.extents;
+      }
+
+      // clip the extents to [offset, offset + bytes) and merge extents that
+      // are adjacent in the same segment into a single read
+      const uint64_t end = offset + bytes;
+      uint64_t position = 0;
+
+      bool pending = false;
+      boost::uint32_t run_segment = 0;
+      uint64_t run_offset = 0;
+      uint64_t run_bytes = 0;
+      char *run_dst = dst;
+
+      for (size_t i = 0; i < extents.size (); ++i)
+      {
+        const Extent &extent = extents[i];
+        const uint64_t extent_begin = position;
+        const uint64_t extent_end = position + extent.bytes;
+        position = extent_end;
+
+        if (extent_end <= offset)
+          continue;
+        if (extent_begin >= end)
+          break;
+
+        const uint64_t from = std::max (offset, extent_begin);
+        const uint64_t to = std::min (end, extent_end);
+        const uint64_t file_offset = extent.offset + (from - extent_begin);
+
+        if (pending && run_segment == extent.segment && run_offset + run_bytes == file_offset)
+        {
+          run_bytes += to - from;
+          continue;
+        }
+
+        if (pending && !readSegment (run_segment, run_offset, run_bytes, run_dst))
+          return (false);
+
+        pending = true;
+        run_segment = extent.segment;
+        run_offset = file_offset;
+        run_bytes = to - from;
+        run_dst = dst + (from - offset);
+      }
+
+      if (pending && !readSegment (run_segment, run_offset, run_bytes, run_dst))
+        return (false);
+
+      return (true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcorePackedSegmentStore::read (const std::string &key, std::vector<char> &dst) const
+    {
+      const uint64_t bytes = getByteCount (key);
+      dst.resize (static_cast<size_t> (bytes));
+      if (bytes == 0)
+        return (true);
+      return (read (key, 0, bytes, &dst[0]));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    uint64_t
+    OutofcorePackedSegmentStore::getPointCount (const std::string &key) const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      PayloadMap::const_iterator it = payloads_.find (key);
+      return (it == payloads_.end () ? 0 : it->second.count);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    uint64_t
+    OutofcorePackedSegmentStore::getByteCount (const std::string &key) const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      PayloadMap::const_iterator it = payloads_.find (key);
+      return (it == payloads_.end () ? 0 : it->second.bytes);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::erase (const std::string &key)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+
+      PayloadMap::iterator it = payloads_.find (key);
+      if (it == payloads_.end ())
+        return;
+      payloads_.erase (it);
+
+      Extent tombstone;
+      tombstone.segment = pack_tombstone;
+      tombstone.offset = 0;
+      tombstone.bytes = 0;
+      tombstone.count = 0;
+      writeRecord (index_file_, key, tombstone);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::flush ()
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      if (index_file_ != NULL)
+        fflush (index_file_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::compact ()
+    {
+      std::vector<std::string> keys;
+      boost::uint32_t first_segment;
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+        for (PayloadMap::const_iterator it = payloads_.begin (); it != payloads_.end (); ++it)
+          keys.push_back (it->first);
+
+        // always start a fresh segment, all existing ones are dropped afterwards
+        first_segment = append_segment_ + 1;
+        append_segment_ = first_segment;
+      }
+
+      std::sort (keys.begin (), keys.end (), depthFirstLess);
+
+      PayloadMap compacted;
+      std::vector<char> buffer;
+      for (size_t i = 0; i < keys.size (); ++i)
+      {
+        if (!read (keys[i], buffer))
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore::%s] Could not read payload %s, aborting compaction\n", __FUNCTION__, keys[i].c_str ());
+          return;
+        }
+
+        Payload &payload = compacted[keys[i]];
+        payload.count = getPointCount (keys[i]);
+        payload.bytes = buffer.size ();
+
+        boost::mutex::scoped_lock lock (mutex_);
+        payload.extents.push_back (appendToSegment (&buffer[0], payload.bytes, payload.count));
+      }
+
+      {
+        boost::mutex::scoped_lock lock (mutex_);
+
+        // swap in the new index, the old one stays valid until the rename
+        const boost::filesystem::path index = root_dir_ / index_filename;
+        const boost::filesystem::path index_tmp = root_dir_ / (index_filename + ".tmp");
+        if (!writeIndex (index_tmp, &compacted))
+        {
+          PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore::%s] Could not write %s, aborting compaction\n", __FUNCTION__, index_tmp.string ().c_str ());
+          return;
+        }
+
+        fclose (index_file_);
+        boost::filesystem::rename (index_tmp, index);
+        index_file_ = fopen (index.string ().c_str (), "ab");
+
+        payloads_.swap (compacted);
+
+        // drop the segments written before the compaction
+        for (boost::uint32_t id = 0; id < first_segment; ++id)
+        {
+          SegmentMap::iterator it = segments_.find (id);
+          if (it != segments_.end ())
+          {
+#ifdef _WIN32
+            fclose (it->second.file);
+#else
+            close (it->second.handle);
+#endif
+            segments_.erase (it);
+          }
+          boost::filesystem::remove (getSegmentPath (id));
+        }
+      }
+
+      boost::mutex::scoped_lock window_lock (window_mutex_);
+      window_.clear ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::setMaxSegmentSize (const uint64_t bytes)
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      max_segment_size_ = bytes;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    uint64_t
+    OutofcorePackedSegmentStore::getMaxSegmentSize () const
+    {
+      return (max_segment_size_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::setReadAheadSize (const uint64_t bytes)
+    {
+      boost::mutex::scoped_lock lock (window_mutex_);
+      read_ahead_size_ = bytes;
+      window_.clear ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    uint64_t
+    OutofcorePackedSegmentStore::getReadAheadSize () const
+    {
+      return (read_ahead_size_);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    size_t
+    OutofcorePackedSegmentStore::getNumSegments () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+
+      std::vector<boost::uint32_t> ids;
+      for (PayloadMap::const_iterator it = payloads_.begin (); it != payloads_.end (); ++it)
+        for (size_t i = 0; i < it->second.extents.size (); ++i)
+          ids.push_back (it->second.extents[i].segment);
+
+      std::sort (ids.begin (), ids.end ());
+      return (std::unique (ids.begin (), ids.end ()) - ids.begin ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    size_t
+    OutofcorePackedSegmentStore::getNumPayloads () const
+    {
+      boost::mutex::scoped_lock lock (mutex_);
+      return (payloads_.size ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcorePackedSegmentStore::loadIndex ()
+    {
+      const boost::filesystem::path index = root_dir_ / index_filename;
+      FILE *f = fopen (index.string ().c_str (), "rb");
+      if (f == NULL)
+        return (false);
+
+      char magic[sizeof (pack_index_magic)];
+      if (fread (magic, 1, sizeof (magic), f) != sizeof (magic) || memcmp (magic, pack_index_magic, sizeof (magic)) != 0)
+      {
+        fclose (f);
+        return (false);
+      }
+
+      // end of the last complete record
+      boost::uint64_t index_size = sizeof (magic);
+      bool truncated = false;
+
+      for (;;)
+      {
+        boost::uint32_t key_length = 0;
+        const size_t length_bytes = fread (&key_length, 1, sizeof (key_length), f);
+        if (length_bytes == 0 && !ferror (f))
+          break;
+
+        std::string key (key_length, '\0');
+        Extent extent;
+        bool complete = (length_bytes == sizeof (key_length));
+        complete = complete && (key_length == 0 || fread (&key[0], 1, key_length, f) == key_length);
+        complete = complete && fread (&extent.segment, sizeof (extent.segment), 1, f) == 1;
+        complete = complete && fread (&extent.offset, sizeof (extent.offset), 1, f) == 1;
+        complete = complete && fread (&extent.bytes, sizeof (extent.bytes), 1, f) == 1;
+        complete = complete && fread (&extent.count, sizeof (extent.count), 1, f) == 1;
+        if (ferror (f))
+        {
+          fclose (f);
+          return (false);
+        }
+        if (!complete)
+        {
+          // an interrupted append leaves a partial record behind, the data it points to is lost
+          PCL_WARN ("[pcl::outofcore::OutofcorePackedSegmentStore::%s] Ignoring truncated record at the end of %s\n", __FUNCTION__, index.string ().c_str ());
+          truncated = true;
+          break;
+        }
+        index_size += sizeof (key_length) + key_length + sizeof (extent.segment) + sizeof (extent.offset) +
+                      sizeof (extent.bytes) + sizeof (extent.count);
+
+        if (extent.segment == pack_tombstone)
+        {
+          payloads_.erase (key);
+          continue;
+        }
+
+        Payload &payload = payloads_[key];
+        payload.extents.push_back (extent);
+        payload.bytes += extent.bytes;
+        payload.count += extent.count;
+        append_segment_ = std::max (append_segment_, extent.segment);
+      }
+      fclose (f);
+
+      // records appended behind the partial one would not be readable anymore
+      if (truncated && !truncateFile (index, index_size))
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore::%s] Could not remove the truncated record from %s\n", __FUNCTION__, index.string ().c_str ());
+        return (false);
+      }
+      return (true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcorePackedSegmentStore::writeIndex (const boost::filesystem::path &file, const PayloadMap *payloads)
+    {
+      FILE *f = fopen (file.string ().c_str (), "wb");
+      if (f == NULL)
+        return (false);
+
+      bool ok = (fwrite (pack_index_magic, 1, sizeof (pack_index_magic), f) == sizeof (pack_index_magic));
+      if (payloads != NULL)
+      {
+        for (PayloadMap::const_iterator it = payloads->begin (); it != payloads->end (); ++it)
+          for (size_t i = 0; i < it->second.extents.size (); ++i)
+            writeRecord (f, it->first, it->second.extents[i]);
+      }
+
+      ok = (fclose (f) == 0) && ok;
+      return (ok);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::writeRecord (FILE *f, const std::string &key, const Extent &extent)
+    {
+      const boost::uint32_t key_length = static_cast<boost::uint32_t> (key.size ());
+
+      size_t written = fwrite (&key_length, sizeof (key_length), 1, f);
+      written += fwrite (key.data (), 1, key.size (), f);
+      written += fwrite (&extent.segment, sizeof (extent.segment), 1, f);
+      written += fwrite (&extent.offset, sizeof (extent.offset), 1, f);
+      written += fwrite (&extent.bytes, sizeof (extent.bytes), 1, f);
+      written += fwrite (&extent.count, sizeof (extent.count), 1, f);
+
+      if (written != key.size () + 5)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore::%s] Could not write index record for %s\n", __FUNCTION__, key.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcorePackedSegmentStore] Outofcore Exception: index write failed");
+      }
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    boost::filesystem::path
+    OutofcorePackedSegmentStore::getSegmentPath (const boost::uint32_t id) const
+    {
+      std::ostringstream name;
+      name << "payload_" << std::setw (6) << std::setfill ('0') << id << segment_extension;
+      return (root_dir_ / name.str ());
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcorePackedSegmentStore::Segment&
+    OutofcorePackedSegmentStore::getSegment (const boost::uint32_t id) const
+    {
+      SegmentMap::iterator it = segments_.find (id);
+      if (it != segments_.end ())
+        return (it->second);
+
+      const std::string file = getSegmentPath (id).string ();
+      Segment segment;
+#ifdef _WIN32
+      segment.file = fopen (file.c_str (), "r+b");
+      if (segment.file == NULL)
+        segment.file = fopen (file.c_str (), "w+b");
+      if (segment.file != NULL && pcl_fseek64 (segment.file, 0, SEEK_END) == 0)
+        segment.size = static_cast<uint64_t> (pcl_ftell64 (segment.file));
+      const bool opened = (segment.file != NULL);
+#else
+      segment.handle = ::open (file.c_str (), O_RDWR | O_CREAT, 0644);
+      if (segment.handle != -1)
+        segment.size = static_cast<uint64_t> (lseek (segment.handle, 0, SEEK_END));
+      const bool opened = (segment.handle != -1);
+#endif
+      if (!opened)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore::%s] Could not open segment %s\n", __FUNCTION__, file.c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcorePackedSegmentStore] Outofcore Exception: could not open segment");
+      }
+
+      return (segments_[id] = segment);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    OutofcorePackedSegmentStore::Extent
+    OutofcorePackedSegmentStore::appendToSegment (const void *data, const uint64_t bytes, const uint64_t count)
+    {
+      Segment *segment = &getSegment (append_segment_);
+      if (segment->size > 0 && segment->size + bytes > max_segment_size_)
+        segment = &getSegment (++append_segment_);
+
+      Extent extent;
+      extent.segment = append_segment_;
+      extent.offset = segment->size;
+      extent.bytes = bytes;
+      extent.count = count;
+
+      const char *src = static_cast<const char*> (data);
+      bool ok;
+#ifdef _WIN32
+      ok = (pcl_fseek64 (segment->file, segment->size, SEEK_SET) == 0) && (fwrite (src, 1, bytes, segment->file) == bytes);
+      ok = (fflush (segment->file) == 0) && ok;
+#else
+      uint64_t written = 0;
+      ok = true;
+      while (ok && written < bytes)
+      {
+        ssize_t res = pwrite (segment->handle, src + written, static_cast<size_t> (bytes - written), static_cast<off_t> (segment->size + written));
+        if (res > 0)
+          written += res;
+        else
+          ok = (res == -1 && errno == EINTR);
+      }
+#endif
+      if (!ok)
+      {
+        PCL_ERROR ("[pcl::outofcore::OutofcorePackedSegmentStore::%s] Could not append %llu bytes to %s\n", __FUNCTION__, static_cast<unsigned long long> (bytes), getSegmentPath (extent.segment).string ().c_str ());
+        PCL_THROW_EXCEPTION (PCLException, "[pcl::outofcore::OutofcorePackedSegmentStore] Outofcore Exception: segment write failed");
+      }
+
+      segment->size += bytes;
+      return (extent);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcorePackedSegmentStore::readSegment (const boost::uint32_t id, const uint64_t offset, const uint64_t bytes, char *dst) const
+    {
+      if (bytes >= read_ahead_size_)
+      {
+        Segment *segment;
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          segment = &getSegment (id);
+        }
+        return (readSegmentDirect (*segment, offset, bytes, dst));
+      }
+
+      // small reads are served from a window of read_ahead_size_ bytes, the
+      // payloads of neighbouring nodes then share one large read
+      boost::mutex::scoped_lock window_lock (window_mutex_);
+      if (window_.empty () || window_segment_ != id || offset < window_offset_ || offset + bytes > window_offset_ + window_.size ())
+      {
+        Segment *segment;
+        uint64_t segment_size;
+        {
+          boost::mutex::scoped_lock lock (mutex_);
+          segment = &getSegment (id);
+          segment_size = segment->size;
+        }
+        if (offset + bytes > segment_size)
+          return (false);
+
+        window_.resize (static_cast<size_t> (std::min (read_ahead_size_, segment_size - offset)));
+        if (!readSegmentDirect (*segment, offset, window_.size (), &window_[0]))
+        {
+          window_.clear ();
+          return (false);
+        }
+        window_segment_ = id;
+        window_offset_ = offset;
+      }
+
+      memcpy (dst, &window_[static_cast<size_t> (offset - window_offset_)], static_cast<size_t> (bytes));
+      return (true);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcorePackedSegmentStore::readSegmentDirect (Segment &segment, const uint64_t offset, const uint64_t bytes, char *dst) const
+    {
+#ifdef _WIN32
+      // stdio streams are not positioned reads, serialize them
+      boost::mutex::scoped_lock lock (mutex_);
+      return (pcl_fseek64 (segment.file, offset, SEEK_SET) == 0 && fread (dst, 1, bytes, segment.file) == bytes);
+#else
+      uint64_t done = 0;
+      while (done < bytes)
+      {
+        ssize_t res = pread (segment.handle, dst + done, static_cast<size_t> (bytes - done), static_cast<off_t> (offset + done));
+        if (res > 0)
+          done += res;
+        else if (res == 0 || errno != EINTR)
+          return (false);
+      }
+      return (true);
+#endif
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    void
+    OutofcorePackedSegmentStore::closeSegments ()
+    {
+      for (SegmentMap::iterator it = segments_.begin (); it != segments_.end (); ++it)
+      {
+#ifdef _WIN32
+        fclose (it->second.file);
+#else
+        close (it->second.handle);
+#endif
+      }
+      segments_.clear ();
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////
+
+    bool
+    OutofcorePackedSegmentStore::depthFirstLess (const std::string &a, const std::string &b)
+    {
+      // node directories are named after the child index, comparing the
+      // directory parts including the trailing separator puts a node before
+      // all of its descendants and siblings in child order
+      const size_t sep_a = a.rfind ('/');
+      const size_t sep_b = b.rfind ('/');
+      const std::string dir_a = (sep_a == std::string::npos) ? std::string () : a.substr (0, sep_a + 1);
+      const std::string dir_b = (sep_b == std::string::npos) ? std::string () : b.substr (0, sep_b + 1);
+
+      if (dir_a != dir_b)
+        return (dir_a < dir_b);
+      return (a < b);
+    }
+
+  }//namespace outofcore
+}//namespace pcl
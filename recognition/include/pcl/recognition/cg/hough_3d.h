@@ -125,6 +125,160 @@ namespace pcl
         /** \brief List of voters for each bin. */
         boost::unordered_map<int, std::vector<int> > voter_ids_;
     };
+
+    /** \brief SparseHoughSpace3D is a 3D voting space that only stores the bins which received at least one vote.
+      * Contrary to \ref HoughSpace3D, its memory footprint does not depend on the extent of the space, so fine bin
+      * sizes can be used on large scenes. The bins are kept in hash maps which are split into shards; a batch of
+      * votes is first collected in per-thread buffers and then merged, each thread owning a set of shards.
+      * Votes are accumulated in the order in which they are cast, so the results do not depend on the number of
+      * threads and are the same as those of \ref HoughSpace3D.
+      * \ingroup recognition
+      */
+    class PCL_EXPORTS SparseHoughSpace3D
+    {
+
+      public:
+
+        /** \brief Constructor
+          *
+          * \param[in] min_coord minimum (x,y,z) coordinates of the Hough space
+          * \param[in] bin_size  size of each bin of the Hough space.
+          * \param[in] max_coord maximum (x,y,z) coordinates of the Hough space.
+          * \param[in] nr_threads the number of threads used for voting and for finding maxima (0 sets it to automatic).
+          */
+        SparseHoughSpace3D (const Eigen::Vector3d &min_coord, const Eigen::Vector3d &bin_size, const Eigen::Vector3d &max_coord,
+                            unsigned int nr_threads = 0);
+
+        /** \brief Reset all cast votes. */
+        void
+        reset ();
+
+        /** \brief Casting a vote for a given position in the Hough space.
+          *
+          * \param[in] single_vote_coord coordinates of the vote being cast (in absolute coordinates)
+          * \param[in] weight weight associated with the vote.
+          * \param[in] voter_id the numeric id of the voter.
+          * \return the index of the bin in which the vote has been cast, or -1 if the vote is out of bounds.
+          */
+        int64_t
+        vote (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id);
+
+        /** \brief Vote for a given position in the 3D space. The weight is interpolated between the bin pointed by single_vote_coord and its neighbors.
+          *
+          * \param[in] single_vote_coord coordinates of the vote being cast.
+          * \param[in] weight weight associated with the vote.
+          * \param[in] voter_id the numeric id of the voter.
+          * \return the index of the bin in which the vote has been cast, or -1 if the vote is out of bounds.
+          */
+        int64_t
+        voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id);
+
+        /** \brief Cast a batch of votes in parallel. The i-th vote is cast with weight weights[i] and voter id i.
+          *
+          * \param[in] vote_coords coordinates of the votes being cast.
+          * \param[in] weights weights associated with the votes.
+          * \param[in] interpolate whether the weights are interpolated between neighboring bins (see \ref voteInt).
+          */
+        void
+        vote (const std::vector<Eigen::Vector3d> &vote_coords, const std::vector<double> &weights, bool interpolate);
+
+        /** \brief Find the bins with most votes. Bins that did not receive any vote are never returned.
+          *
+          * \param[in] min_threshold the minimum number of votes to be included in a bin in order to have its value returned.
+          * If set to a value between -1 and 0 the Hough space maximum_vote is found and the returned values are all the votes greater than -min_threshold * maximum_vote.
+          * \param[out] maxima_values the list of Hough Space bin values greater than min_threshold, sorted by bin index.
+          * \param[out] maxima_voter_ids for each value returned, a list of the voter ids who cast a vote in that position.
+          * \return The min_threshold used, either set by the user or found by this method.
+          */
+        double
+        findMaxima (double min_threshold, std::vector<double> & maxima_values, std::vector<std::vector<int> > &maxima_voter_ids);
+
+        /** \brief Set the number of threads used for voting and for finding maxima.
+          * \param[in] nr_threads the number of threads to use (0 sets it to automatic); takes effect on the next \ref reset.
+          */
+        inline void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
+        /** \brief Get the number of bins that received at least one vote. */
+        size_t
+        getNumberOfOccupiedBins () const;
+
+      protected:
+
+        /** \brief A bin of the Hough space. */
+        struct Bin
+        {
+          Bin () : value (0.0), voter_ids () {}
+
+          /** \brief The accumulated weight of the votes. */
+          double value;
+          /** \brief The voters who cast a vote in this bin. */
+          std::vector<int> voter_ids;
+        };
+
+        /** \brief A single (possibly interpolated) contribution to a bin. */
+        struct Contribution
+        {
+          int64_t bin_index;
+          double weight;
+          int voter_id;
+        };
+
+        typedef boost::unordered_map<int64_t, Bin> BinMap;
+
+        /** \brief Compute the contributions of a vote to the bins of the Hough space.
+          * \return the index of the bin pointed by the vote, or -1 if the vote is out of bounds.
+          */
+        int64_t
+        computeContributions (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id, bool interpolate,
+                              std::vector<Contribution> &contributions) const;
+
+        /** \brief Add a contribution to the bin it refers to. */
+        inline void
+        addContribution (const Contribution &contribution)
+        {
+          Bin &bin = bins_[getShardIndex (contribution.bin_index)][contribution.bin_index];
+          bin.value += contribution.weight;
+          bin.voter_ids.push_back (contribution.voter_id);
+        }
+
+        /** \brief Returns the shard in which the bin with the given index is stored. */
+        inline size_t
+        getShardIndex (int64_t bin_index) const
+        {
+          return (static_cast<size_t> (bin_index % static_cast<int64_t> (bins_.size ())));
+        }
+
+        /** \brief Returns the value of the bin with the given index (0 for bins without votes). */
+        inline double
+        getBinValue (int64_t bin_index) const
+        {
+          const BinMap &shard = bins_[getShardIndex (bin_index)];
+          const BinMap::const_iterator it = shard.find (bin_index);
+          return (it == shard.end () ? 0.0 : it->second.value);
+        }
+
+        /** \brief Minimum coordinate in the Hough Space. */
+        Eigen::Vector3d min_coord_;
+
+        /** \brief Size of each bin in the Hough Space. */
+        Eigen::Vector3d bin_size_;
+
+        /** \brief Number of bins for each dimension. */
+        Eigen::Vector3i bin_count_;
+
+        /** \brief Used to compute bin indices as if the Hough Space was a matrix. */
+        int64_t partial_bin_products_[4];
+
+        /** \brief The number of threads the scheduler should use. */
+        unsigned int threads_;
+
+        /** \brief The bins that received at least one vote, split into shards. */
+        std::vector<BinMap> bins_;
+    };
   }
 
   /** \brief Class implementing a 3D correspondence grouping algorithm that can deal with multiple instances of a model template
@@ -173,6 +327,7 @@ namespace pcl
         , hough_space_ ()
         , found_transformations_ ()
         , hough_space_initialized_ (false)
+        , threads_ (0)
       {}
 
       /** \brief Provide a pointer to the input dataset.
@@ -405,6 +560,15 @@ namespace pcl
         return (local_rf_search_radius_);
       }
 
+      /** \brief Initialize the scheduler and set the number of threads to use for the Hough voting.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
       /** \brief Call this function after setting the input, the input_rf and the hough_bin_size parameters to perform an off line training of the algorithm. This might be useful if one wants to perform once and for all a pre-computation of votes that only concern the models, increasing the on-line efficiency of the grouping algorithm. 
         * The algorithm is automatically trained on the first invocation of the recognize method or the cluster method if this training function has not been manually invoked.
         * 
@@ -468,7 +632,7 @@ namespace pcl
       float local_rf_search_radius_;
 
       /** \brief The Hough space. */
-      boost::shared_ptr<pcl::recognition::HoughSpace3D> hough_space_;
+      boost::shared_ptr<pcl::recognition::SparseHoughSpace3D> hough_space_;
 
       /** \brief Transformations found by clusterCorrespondences method. */
       std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > found_transformations_;
@@ -478,6 +642,9 @@ namespace pcl
         */
       bool hough_space_initialized_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief Cluster the input correspondences in order to distinguish between different instances of the model into the scene.
         * 
         * \param[out] model_instances a vector containing the clustered correspondences for each model found on the scene.
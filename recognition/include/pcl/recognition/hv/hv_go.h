@@ -15,6 +15,8 @@
 #include <pcl/features/normal_3d.h>
 #include <boost/graph/graph_traits.hpp>
 #include <boost/graph/adjacency_list.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
 
 namespace pcl
 {
@@ -26,7 +28,7 @@ namespace pcl
   template<typename ModelT, typename SceneT>
   class PCL_EXPORTS GlobalHypothesesVerification: public HypothesisVerification<ModelT, SceneT>
   {
-    private:
+    protected:
 
       //Helper classes
       struct RecognitionModel
@@ -38,6 +40,8 @@ namespace pcl
           std::vector<float> unexplained_in_neighborhood_weights; //weights for the points not being explained in the neighborhood of a hypothesis
           std::vector<int> outlier_indices_; //outlier indices of this model
           std::vector<int> complete_cloud_occupancy_indices_;
+          std::vector<bool> unexplained_in_neighborhood_explained_; //whether the points in unexplained_in_neighborhood are explained by this model as well
+          std::vector<float> explained_unexplained_weights_; //weight of the explained points in unexplained_in_neighborhood_weights (0 if not there)
           typename pcl::PointCloud<ModelT>::Ptr cloud_;
           typename pcl::PointCloud<ModelT>::Ptr complete_cloud_;
           int bad_information_;
@@ -68,13 +72,9 @@ namespace pcl
             cost_ = s.cost_;
           }
 
-          mets::gol_type what_if(int /*index*/, bool /*val*/) const
+          mets::gol_type what_if(int index, bool val) const
           {
-            /*std::vector<bool> tmp (solution_);
-            tmp[index] = val;
-            mets::gol_type sol = opt_->evaluateSolution (solution_, index); //evaluate without updating status
-            return sol;*/
-            return static_cast<mets::gol_type>(0);
+            return opt_->evaluateMove (solution_, index, val); //evaluate without updating status
           }
 
           mets::gol_type apply_and_evaluate(int index, bool val)
@@ -85,9 +85,10 @@ namespace pcl
             return sol;
           }
 
-          void apply(int /*index*/, bool /*val*/)
+          void apply(int index, bool val)
           {
-
+            solution_[index] = val;
+            cost_ = opt_->evaluateSolution (solution_, index); //this will update the state of the solution
           }
 
           void unapply(int index, bool val)
@@ -96,7 +97,7 @@ namespace pcl
             //update optimizer solution
             cost_ = opt_->evaluateSolution (solution_, index); //this will udpate the cost function in opt_
           }
-          void setSolution(std::vector<bool> & sol)
+          void setSolution(const std::vector<bool> & sol)
           {
             solution_ = sol;
           }
@@ -120,9 +121,10 @@ namespace pcl
           {
           }
 
-          mets::gol_type evaluate(const mets::feasible_solution& /*cs*/) const
+          mets::gol_type evaluate(const mets::feasible_solution& cs) const
           {
-            return static_cast<mets::gol_type>(0);
+            const SAModel& model = dynamic_cast<const SAModel&> (cs);
+            return model.what_if (index_, !model.solution_[index_]);
           }
 
           mets::gol_type apply_and_evaluate(mets::feasible_solution& cs)
@@ -131,8 +133,10 @@ namespace pcl
             return model.apply_and_evaluate (index_, !model.solution_[index_]);
           }
 
-          void apply(mets::feasible_solution& /*s*/) const
+          void apply(mets::feasible_solution& s) const
           {
+            SAModel& model = dynamic_cast<SAModel&> (s);
+            model.apply (index_, !model.solution_[index_]);
           }
 
           void unapply(mets::feasible_solution& s) const
@@ -156,7 +160,8 @@ namespace pcl
             return moves_m.end ();
           }
 
-          move_manager(int problem_size)
+          move_manager(int problem_size, unsigned int seed = 0) :
+              rng_ (seed)
           {
             for (int ii = 0; ii != problem_size; ++ii)
               moves_m.push_back (new move (ii));
@@ -171,9 +176,13 @@ namespace pcl
 
           void refresh(mets::feasible_solution& /*s*/)
           {
-            std::random_shuffle (moves_m.begin (), moves_m.end ());
+            //shuffle with an own generator, such that concurrent restarts do not share any state
+            for (size_t ii = moves_m.size (); ii > 1; --ii)
+              std::swap (moves_m[ii - 1], moves_m[boost::uniform_int<size_t> (0, ii - 1) (rng_)]);
           }
 
+        private:
+          boost::mt19937 rng_;
       };
 
       //inherited class attributes
@@ -215,6 +224,8 @@ namespace pcl
       int max_iterations_; //max iterations without improvement
       SAModel best_seen_;
       float initial_temp_;
+      int n_restarts_; //number of independent SA runs, the best solution is kept
+      unsigned int threads_;
 
       int n_cc_;
       std::vector<std::vector<int> > cc_;
@@ -420,6 +431,10 @@ namespace pcl
       mets::gol_type
       evaluateSolution(const std::vector<bool> & active, int changed);
 
+      //Returns the cost of the solution obtained by setting active[changed] to val, without updating the state
+      mets::gol_type
+      evaluateMove(const std::vector<bool> & active, int changed, bool val) const;
+
       bool
       addModel(typename pcl::PointCloud<ModelT>::ConstPtr & model, typename pcl::PointCloud<ModelT>::ConstPtr & complete_model,
           boost::shared_ptr<RecognitionModel> & recog_model);
@@ -427,9 +442,17 @@ namespace pcl
       void
       computeClutterCue(boost::shared_ptr<RecognitionModel> & recog_model);
 
+      //Adds the cues of all recognition models to the state and returns the cost of initial_solution (all models active)
+      mets::gol_type
+      initializeState(const std::vector<bool> & initial_solution);
+
       void
       SAOptimize(std::vector<int> & cc_indices, std::vector<bool> & sub_solution);
 
+      //Runs simulated annealing starting from the current state and returns the cost of the best solution found
+      mets::gol_type
+      runSA(const std::vector<bool> & initial_solution, mets::gol_type initial_cost, unsigned int seed, std::vector<bool> & best_solution);
+
     public:
       GlobalHypothesesVerification() : HypothesisVerification<ModelT, SceneT>()
       {
@@ -443,6 +466,8 @@ namespace pcl
         clutter_regularizer_ = 5.f;
         res_occupancy_grid_ = 0.01f;
         w_occupied_multiple_cm_ = 4.f;
+        n_restarts_ = 1;
+        threads_ = 0;
       }
 
       void
@@ -482,6 +507,18 @@ namespace pcl
       {
         detect_clutter_ = d;
       }
+
+      /** \brief Sets the number of independent simulated annealing runs (with different move orders); the best solution is kept. */
+      void setNumberOfRestarts(int n)
+      {
+        n_restarts_ = n;
+      }
+
+      /** \brief Sets the number of threads used to compute the cues and to run the restarts (0 means automatic). */
+      void setNumberOfThreads(unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
   };
 }
 
@@ -48,6 +48,10 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/board.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 template<typename PointModelT, typename PointSceneT, typename PointModelRfT, typename PointSceneRfT>
 template<typename PointType, typename PointRfType> void
@@ -186,7 +190,14 @@ pcl::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
 
   float max_distance = -std::numeric_limits<float>::max ();
 
-  // Calculating 3D Hough space dimensions and vote position for each match
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+  // Calculating the vote position for each match
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads) schedule(static)
+#endif
   for (int i=0; i< n_matches; ++i)
   {
     int scene_index = model_scene_corrs_->at (i).index_match;
@@ -205,7 +216,11 @@ pcl::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
     scene_votes[i].x () = scene_point_rf_x[0] * model_point_vote.x () + scene_point_rf_y[0] * model_point_vote.y () + scene_point_rf_z[0] * model_point_vote.z () + scene_point.x ();
     scene_votes[i].y () = scene_point_rf_x[1] * model_point_vote.x () + scene_point_rf_y[1] * model_point_vote.y () + scene_point_rf_z[1] * model_point_vote.z () + scene_point.y ();
     scene_votes[i].z () = scene_point_rf_x[2] * model_point_vote.x () + scene_point_rf_y[2] * model_point_vote.y () + scene_point_rf_z[2] * model_point_vote.z () + scene_point.z ();
+  }
 
+  // Calculating 3D Hough space dimensions
+  for (int i=0; i< n_matches; ++i)
+  {
     if (scene_votes[i].x () < d_min.x ()) 
       d_min.x () = scene_votes[i].x (); 
     if (scene_votes[i].x () > d_max.x ()) 
@@ -228,26 +243,17 @@ pcl::Hough3DGrouping<PointModelT, PointSceneT, PointModelRfT, PointSceneRfT>::ho
     }
   }
 
-  // Hough Voting
-  hough_space_.reset (new pcl::recognition::HoughSpace3D (d_min, bin_size, d_max));
-
-  for (int i = 0; i < n_matches; ++i)
+  std::vector<double> weights (n_matches, 1.0);
+  if (use_distance_weight_ && max_distance != 0)
   {
-    double weight = 1.0;
-    if (use_distance_weight_ && max_distance != 0)
-    {
-      weight = 1.0 - (model_scene_corrs_->at (i).distance / max_distance);
-    }
-    if (use_interpolation_)
-    {
-      hough_space_->voteInt (scene_votes[i], weight, i);
-    } 
-    else
-    {
-      hough_space_->vote (scene_votes[i], weight, i);
-    }
+    for (int i = 0; i < n_matches; ++i)
+      weights[i] = 1.0 - (model_scene_corrs_->at (i).distance / max_distance);
   }
 
+  // Hough Voting
+  hough_space_.reset (new pcl::recognition::SparseHoughSpace3D (d_min, bin_size, d_max, threads_));
+  hough_space_->vote (scene_votes, weights, use_interpolation_);
+
   hough_space_initialized_ = true;
 
   return (true);
@@ -39,6 +39,10 @@
 #include <pcl/common/time.h>
 #include <pcl/point_types.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 template<typename PointT, typename NormalT>
 inline void extractEuclideanClustersSmooth(const typename pcl::PointCloud<PointT> &cloud, const typename pcl::PointCloud<NormalT> &normals, float tolerance,
     const typename pcl::search::Search<PointT>::Ptr &tree, std::vector<pcl::PointIndices> &clusters, double eps_angle, float curvature_threshold,
@@ -177,6 +181,98 @@ mets::gol_type pcl::GlobalHypothesesVerification<ModelT, SceneT>::evaluateSoluti
   return static_cast<mets::gol_type> ((good_info - bad_info - static_cast<float> (duplicity) - unexplained_info - duplicity_cm - static_cast<float> (n_active_hyp)) * -1.f); //return the dual to our max problem
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename ModelT, typename SceneT>
+mets::gol_type pcl::GlobalHypothesesVerification<ModelT, SceneT>::evaluateMove(const std::vector<bool> & active, int changed, bool val) const
+{
+  //same computations as evaluateSolution, but only the sparse vectors of the changed hypothesis are visited and nothing is updated
+  const RecognitionModel & recog_model = *recognition_models_[changed];
+  const int sign = val ? 1 : -1;
+  const float sign_f = static_cast<float> (sign);
+
+  //explained information and duplicity (see updateExplainedVector)
+  float add_to_explained = 0.f;
+  int add_to_duplicity = 0;
+  for (size_t i = 0; i < recog_model.explained_.size (); i++)
+  {
+    const int prev = explained_by_RM_[recog_model.explained_[i]];
+    const int now = prev + sign;
+    add_to_explained += recog_model.explained_distances_[i] * sign_f;
+
+    if ((now > 1) && (prev > 1))
+      add_to_duplicity += sign;
+    else if ((now == 1) && (prev > 1))
+      add_to_duplicity -= 2;
+    else if ((now > 1) && (prev <= 1))
+      add_to_duplicity += 2;
+  }
+
+  //unexplained information in the neighborhood (see updateUnexplainedVector, which runs after updateExplainedVector)
+  float add_to_unexplained = 0.f;
+  for (size_t i = 0; i < recog_model.unexplained_in_neighborhood.size (); i++)
+  {
+    const int idx = recog_model.unexplained_in_neighborhood[i];
+    const int explained = explained_by_RM_[idx] + (recog_model.unexplained_in_neighborhood_explained_[i] ? sign : 0);
+
+    if (sign < 0)
+    {
+      if ((unexplained_by_RM_neighboorhods[idx] > 0) && (explained == 0))
+        add_to_unexplained -= recog_model.unexplained_in_neighborhood_weights[i];
+    } else
+    {
+      if (explained == 0)
+        add_to_unexplained += recog_model.unexplained_in_neighborhood_weights[i];
+    }
+  }
+
+  for (size_t i = 0; i < recog_model.explained_.size (); i++)
+  {
+    const int idx = recog_model.explained_[i];
+    const int explained = explained_by_RM_[idx] + sign;
+    const float unexplained = unexplained_by_RM_neighboorhods[idx] + sign_f * recog_model.explained_unexplained_weights_[i];
+
+    if (sign < 0)
+    {
+      if ((explained == 0) && (unexplained > 0))
+        add_to_unexplained += unexplained;
+    } else
+    {
+      if ((explained == 1) && (unexplained > 0))
+        add_to_unexplained -= unexplained;
+    }
+  }
+
+  //duplicity of the complete models (see updateCMDuplicity)
+  int add_to_duplicity_cm = 0;
+  for (size_t i = 0; i < recog_model.complete_cloud_occupancy_indices_.size (); i++)
+  {
+    const int prev = complete_cloud_occupancy_by_RM_[recog_model.complete_cloud_occupancy_indices_[i]];
+    const int now = prev + sign;
+
+    if ((now > 1) && (prev > 1))
+      add_to_duplicity_cm += sign;
+    else if ((now == 1) && (prev > 1))
+      add_to_duplicity_cm -= 2;
+    else if ((now > 1) && (prev <= 1))
+      add_to_duplicity_cm += 2;
+  }
+
+  int n_active_hyp = 0;
+  for (size_t i = 0; i < active.size (); i++)
+  {
+    if ((static_cast<int> (i) == changed) ? val : active[i])
+      n_active_hyp++;
+  }
+
+  int duplicity = previous_duplicity_ + add_to_duplicity;
+  float good_info = previous_explained_value + add_to_explained;
+  float unexplained_info = previous_unexplained_ + add_to_unexplained;
+  float bad_info = previous_bad_info_ + (recog_model.outliers_weight_ * static_cast<float> (recog_model.bad_information_)) * sign_f;
+  float duplicity_cm = static_cast<float> (previous_duplicity_complete_models_ + add_to_duplicity_cm) * w_occupied_multiple_cm_;
+
+  return static_cast<mets::gol_type> ((good_info - bad_info - static_cast<float> (duplicity) - unexplained_info - duplicity_cm - static_cast<float> (n_active_hyp)) * -1.f);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 template<typename ModelT, typename SceneT>
 void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
@@ -275,22 +371,38 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
     }
   }
 
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
   //compute cues
   {
     pcl::ScopeTime tcues ("Computing cues");
-    recognition_models_.resize (complete_models_.size ());
+    std::vector<boost::shared_ptr<RecognitionModel> > recog_models (complete_models_.size ());
+    std::vector<char> added (complete_models_.size ());
+
+    //the hypotheses are independent of each other, create the recognition models in parallel
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+    for (int i = 0; i < static_cast<int> (complete_models_.size ()); i++)
+    {
+      recog_models[i].reset (new RecognitionModel ());
+      added[i] = addModel (visible_models_[i], complete_models_[i], recog_models[i]);
+    }
+
+    recognition_models_.clear ();
     int valid = 0;
     for (int i = 0; i < static_cast<int> (complete_models_.size ()); i++)
     {
-      //create recognition model
-      recognition_models_[valid].reset (new RecognitionModel ());
-      if(addModel (visible_models_[i], complete_models_[i], recognition_models_[valid])) {
+      if (added[i])
+      {
+        recognition_models_.push_back (recog_models[i]);
         indices_[valid] = i;
         valid++;
       }
     }
 
-    recognition_models_.resize(valid);
     indices_.resize(valid);
   }
 
@@ -329,7 +441,10 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
 
   complete_cloud_occupancy_by_RM_.resize (size_x * size_y * size_z, 0);
 
-  for (size_t i = 0; i < recognition_models_.size (); i++)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+  for (int i = 0; i < static_cast<int> (recognition_models_.size ()); i++)
   {
 
     std::map<int, bool> banned;
@@ -346,16 +461,23 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
       banned_it = banned.find (idx);
       if (banned_it == banned.end ())
       {
-        complete_cloud_occupancy_by_RM_[idx]++;
         recognition_models_[i]->complete_cloud_occupancy_indices_.push_back (idx);
         banned[idx] = true;
       }
     }
   }
 
+  for (size_t i = 0; i < recognition_models_.size (); i++)
+  {
+    for (size_t j = 0; j < recognition_models_[i]->complete_cloud_occupancy_indices_.size (); j++)
+      complete_cloud_occupancy_by_RM_[recognition_models_[i]->complete_cloud_occupancy_indices_[j]]++;
+  }
+
   {
     pcl::ScopeTime tcues ("Computing clutter cues");
-#pragma omp parallel for schedule(dynamic, 4) num_threads(omp_get_num_procs())
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 4) num_threads(nr_threads)
+#endif
     for (int j = 0; j < static_cast<int> (recognition_models_.size ()); j++)
       computeClutterCue (recognition_models_[j]);
   }
@@ -369,20 +491,8 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::initialize()
 }
 
 template<typename ModelT, typename SceneT>
-void pcl::GlobalHypothesesVerification<ModelT, SceneT>::SAOptimize(std::vector<int> & cc_indices, std::vector<bool> & initial_solution)
+mets::gol_type pcl::GlobalHypothesesVerification<ModelT, SceneT>::initializeState(const std::vector<bool> & initial_solution)
 {
-
-  //temporal copy of recogniton_models_
-  std::vector < boost::shared_ptr<RecognitionModel> > recognition_models_copy;
-  recognition_models_copy = recognition_models_;
-
-  recognition_models_.clear ();
-
-  for (size_t j = 0; j < cc_indices.size (); j++)
-  {
-    recognition_models_.push_back (recognition_models_copy[cc_indices[j]]);
-  }
-
   for (size_t j = 0; j < recognition_models_.size (); j++)
   {
     boost::shared_ptr < RecognitionModel > recog_model = recognition_models_[j];
@@ -428,24 +538,93 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::SAOptimize(std::vector<i
   setPreviousBadInfo (bad_information_);
   setPreviousUnexplainedValue (unexplained_in_neighboorhod);
 
-  SAModel model;
-  model.cost_ = static_cast<mets::gol_type> ((good_information_ - bad_information_
-                                               - static_cast<float> (duplicity)
-                                               - static_cast<float> (occupied_multiple) * w_occupied_multiple_cm_
-                                               - static_cast<float> (recognition_models_.size ())
-                                               - unexplained_in_neighboorhod) * -1.f);
+  return static_cast<mets::gol_type> ((good_information_ - bad_information_
+                                       - static_cast<float> (duplicity)
+                                       - static_cast<float> (occupied_multiple) * w_occupied_multiple_cm_
+                                       - static_cast<float> (recognition_models_.size ())
+                                       - unexplained_in_neighboorhod) * -1.f);
+}
+
+template<typename ModelT, typename SceneT>
+void pcl::GlobalHypothesesVerification<ModelT, SceneT>::SAOptimize(std::vector<int> & cc_indices, std::vector<bool> & initial_solution)
+{
+
+  //temporal copy of recogniton_models_
+  std::vector < boost::shared_ptr<RecognitionModel> > recognition_models_copy;
+  recognition_models_copy = recognition_models_;
+
+  recognition_models_.clear ();
+
+  for (size_t j = 0; j < cc_indices.size (); j++)
+  {
+    recognition_models_.push_back (recognition_models_copy[cc_indices[j]]);
+  }
+
+  mets::gol_type initial_cost = initializeState (initial_solution);
 
+  //each restart modifies the state while searching, so all of them but the first one work on a copy
+  const int n_restarts = std::max (n_restarts_, 1);
+  std::vector<boost::shared_ptr<SAOptimizerT> > optimizers (n_restarts);
+  for (int r = 1; r < n_restarts; r++)
+    optimizers[r].reset (new SAOptimizerT (*this));
+
+  std::vector<std::vector<bool> > solutions (n_restarts);
+  std::vector<mets::gol_type> costs (n_restarts);
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_threads)
+#endif
+  for (int r = 0; r < n_restarts; r++)
+  {
+    SAOptimizerT * optimizer = (r == 0) ? this : optimizers[r].get ();
+    costs[r] = optimizer->runSA (initial_solution, initial_cost, static_cast<unsigned int> (r), solutions[r]);
+  }
+
+  //keep the best solution (the first one in case of ties)
+  int best = 0;
+  for (int r = 1; r < n_restarts; r++)
+  {
+    if (costs[r] < costs[best])
+      best = r;
+  }
+
+  if (best != 0)
+  {
+    best_seen_ = optimizers[best]->best_seen_;
+    best_seen_.setOptimizer (this);
+  }
+
+  for (size_t i = 0; i < solutions[best].size (); i++)
+  {
+    initial_solution[i] = solutions[best][i];
+  }
+
+  recognition_models_ = recognition_models_copy;
+
+}
+
+template<typename ModelT, typename SceneT>
+mets::gol_type pcl::GlobalHypothesesVerification<ModelT, SceneT>::runSA(const std::vector<bool> & initial_solution, mets::gol_type initial_cost,
+    unsigned int seed, std::vector<bool> & best_solution)
+{
+  SAModel model;
+  model.cost_ = initial_cost;
   model.setSolution (initial_solution);
   model.setOptimizer (this);
   SAModel best (model);
 
-  move_manager neigh (static_cast<int> (cc_indices.size ()));
+  move_manager neigh (static_cast<int> (initial_solution.size ()), seed);
 
   mets::best_ever_solution best_recorder (best);
   mets::noimprove_termination_criteria noimprove (max_iterations_);
   mets::linear_cooling linear_cooling;
   mets::simulated_annealing<move_manager> sa (model, best_recorder, neigh, noimprove, linear_cooling, initial_temp_, 1e-7, 2);
-  sa.setApplyAndEvaluate(true);
+  //moves are evaluated without touching the state (see evaluateMove) and only applied if accepted
+  sa.setApplyAndEvaluate(false);
 
   {
     pcl::ScopeTime t ("SA search...");
@@ -453,13 +632,8 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::SAOptimize(std::vector<i
   }
 
   best_seen_ = static_cast<const SAModel&> (best_recorder.best_seen ());
-  for (size_t i = 0; i < best_seen_.solution_.size (); i++)
-  {
-    initial_solution[i] = best_seen_.solution_[i];
-  }
-
-  recognition_models_ = recognition_models_copy;
-
+  best_solution = best_seen_.solution_;
+  return best_seen_.cost_;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -735,6 +909,26 @@ void pcl::GlobalHypothesesVerification<ModelT, SceneT>::computeClutterCue(boost:
     recog_model->unexplained_in_neighborhood_weights.resize (p);
     recog_model->unexplained_in_neighborhood.resize (p);
   }
+
+  //find the points being both explained and in the neighborhood of this hypothesis, evaluateMove needs them
+  std::vector < std::pair<int, int> > explained_sorted (recog_model->explained_.size ()); //first is index to scene point and second to explained_
+  for (size_t i = 0; i < recog_model->explained_.size (); i++)
+    explained_sorted[i] = std::make_pair (recog_model->explained_[i], static_cast<int> (i));
+
+  std::sort (explained_sorted.begin (), explained_sorted.end ());
+
+  recog_model->explained_unexplained_weights_.assign (recog_model->explained_.size (), 0.f);
+  recog_model->unexplained_in_neighborhood_explained_.assign (recog_model->unexplained_in_neighborhood.size (), false);
+  for (size_t i = 0; i < recog_model->unexplained_in_neighborhood.size (); i++)
+  {
+    std::vector < std::pair<int, int> >::const_iterator it = std::lower_bound (explained_sorted.begin (), explained_sorted.end (),
+        std::make_pair (recog_model->unexplained_in_neighborhood[i], -1));
+    if (it != explained_sorted.end () && it->first == recog_model->unexplained_in_neighborhood[i])
+    {
+      recog_model->unexplained_in_neighborhood_explained_[i] = true;
+      recog_model->explained_unexplained_weights_[it->second] = recog_model->unexplained_in_neighborhood_weights[i];
+    }
+  }
 }
 
 #define PCL_INSTANTIATE_GoHV(T1,T2) template class PCL_EXPORTS pcl::GlobalHypothesesVerification<T1,T2>;
@@ -227,6 +227,90 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::loadTemplates (const std::string &file_name
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointXYZT, typename PointRGBT> bool
+pcl::LineRGBD<PointXYZT, PointRGBT>::loadTemplateBank (const std::string &file_name)
+{
+  LINEMODTemplateBank::Ptr template_bank (new LINEMODTemplateBank);
+  if (!template_bank->open (file_name))
+    return (false);
+
+  template_point_clouds_.clear ();
+  bounding_boxes_.clear ();
+  object_ids_.clear ();
+  linemod_.setTemplateBank (template_bank);
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointXYZT, typename PointRGBT> bool
+pcl::LineRGBD<PointXYZT, PointRGBT>::saveTemplateBank (const std::string &file_name) const
+{
+  const size_t nr_templates = linemod_.getNumOfTemplates ();
+  const size_t nr_bank_templates = getNumOfBankTemplates ();
+
+  std::vector<SparseQuantizedMultiModTemplate> templates (nr_templates);
+  std::vector<size_t> object_ids (nr_templates);
+  std::vector<BoundingBoxXYZ> bounding_boxes (nr_templates);
+  pcl::PointCloud<pcl::PointXYZRGBA>::CloudVectorType clouds (nr_templates);
+  for (size_t template_id = 0; template_id < nr_templates; ++template_id)
+  {
+    linemod_.copyTemplate (template_id, templates[template_id]);
+    object_ids[template_id] = getTemplateObjectId (template_id);
+
+    if (template_id < nr_bank_templates)
+    {
+      bounding_boxes[template_id] = linemod_.getTemplateBank ()->getBoundingBox (template_id);
+      linemod_.getTemplateBank ()->getPointCloud (template_id, clouds[template_id]);
+      continue;
+    }
+
+    // templates loaded from LTM files might lack their point cloud
+    const size_t index = template_id - nr_bank_templates;
+    if (index < bounding_boxes_.size ())
+      bounding_boxes[template_id] = bounding_boxes_[index];
+    if (index < template_point_clouds_.size ())
+      clouds[template_id] = template_point_clouds_[index];
+  }
+
+  return (LINEMODTemplateBank::write (file_name, templates, object_ids, bounding_boxes, clouds));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointXYZT, typename PointRGBT> size_t
+pcl::LineRGBD<PointXYZT, PointRGBT>::getTemplateObjectId (const size_t template_id) const
+{
+  const size_t nr_bank_templates = getNumOfBankTemplates ();
+  if (template_id < nr_bank_templates)
+    return (linemod_.getTemplateBank ()->getObjectId (template_id));
+  return (object_ids_[template_id - nr_bank_templates]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointXYZT, typename PointRGBT> pcl::BoundingBoxXYZ
+pcl::LineRGBD<PointXYZT, PointRGBT>::getTemplateBoundingBox (const size_t template_id) const
+{
+  const size_t nr_bank_templates = getNumOfBankTemplates ();
+  if (template_id < nr_bank_templates)
+    return (linemod_.getTemplateBank ()->getBoundingBox (template_id));
+  return (bounding_boxes_[template_id - nr_bank_templates]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointXYZT, typename PointRGBT> const pcl::PointCloud<pcl::PointXYZRGBA> &
+pcl::LineRGBD<PointXYZT, PointRGBT>::getTemplatePointCloud (
+    const size_t template_id, pcl::PointCloud<pcl::PointXYZRGBA> & bank_cloud) const
+{
+  const size_t nr_bank_templates = getNumOfBankTemplates ();
+  if (template_id < nr_bank_templates)
+  {
+    linemod_.getTemplateBank ()->getPointCloud (template_id, bank_cloud);
+    return (bank_cloud);
+  }
+  return (template_point_clouds_[template_id - nr_bank_templates]);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointXYZT, typename PointRGBT> int
 pcl::LineRGBD<PointXYZT, PointRGBT>::createAndAddTemplate (
@@ -428,7 +512,7 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::detect (
 
     typename pcl::LineRGBD<PointXYZT, PointRGBT>::Detection detection;
     detection.template_id = linemod_detection.template_id;
-    detection.object_id = object_ids_[linemod_detection.template_id];
+    detection.object_id = getTemplateObjectId (linemod_detection.template_id);
     detection.detection_id = detection_id;
     detection.response = linemod_detection.score;
 
@@ -437,25 +521,24 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::detect (
     // of the template points; so we also compute the center of mass of the points
     // covered by the 
 
-    const pcl::SparseQuantizedMultiModTemplate & linemod_template = 
-      linemod_.getTemplate (linemod_detection.template_id);
+    const pcl::RegionXY template_region = linemod_.getTemplateRegion (linemod_detection.template_id);
 
     const size_t start_x = std::max (linemod_detection.x, 0);
     const size_t start_y = std::max (linemod_detection.y, 0);
-    const size_t end_x = std::min (static_cast<size_t> (start_x + linemod_template.region.width),
+    const size_t end_x = std::min (static_cast<size_t> (start_x + template_region.width),
                                    static_cast<size_t> (cloud_xyz_->width));
-    const size_t end_y = std::min (static_cast<size_t> (start_y + linemod_template.region.height),
+    const size_t end_y = std::min (static_cast<size_t> (start_y + template_region.height),
                                    static_cast<size_t> (cloud_xyz_->height));
 
     detection.region.x = linemod_detection.x;
     detection.region.y = linemod_detection.y;
-    detection.region.width  = linemod_template.region.width;
-    detection.region.height = linemod_template.region.height;
+    detection.region.width  = template_region.width;
+    detection.region.height = template_region.height;
 
     //std::cerr << "detection region: " << linemod_detection.x << ", "
     //  << linemod_detection.y << ", "
-    //  << linemod_template.region.width << ", "
-    //  << linemod_template.region.height << std::endl;
+    //  << template_region.width << ", "
+    //  << template_region.height << std::endl;
 
     float center_x = 0.0f;
     float center_y = 0.0f;
@@ -481,7 +564,7 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::detect (
     center_y *= inv_counter;
     center_z *= inv_counter;
 
-    pcl::BoundingBoxXYZ template_bounding_box = bounding_boxes_[detection.template_id];
+    pcl::BoundingBoxXYZ template_bounding_box = getTemplateBoundingBox (detection.template_id);
 
     detection.bounding_box = template_bounding_box;
     detection.bounding_box.x += center_x;
@@ -529,7 +612,7 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::detectSemiScaleInvariant (
 
     typename pcl::LineRGBD<PointXYZT, PointRGBT>::Detection detection;
     detection.template_id = linemod_detection.template_id;
-    detection.object_id = object_ids_[linemod_detection.template_id];
+    detection.object_id = getTemplateObjectId (linemod_detection.template_id);
     detection.detection_id = detection_id;
     detection.response = linemod_detection.score;
 
@@ -538,25 +621,24 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::detectSemiScaleInvariant (
     // of the template points; so we also compute the center of mass of the points
     // covered by the 
 
-    const pcl::SparseQuantizedMultiModTemplate & linemod_template = 
-      linemod_.getTemplate (linemod_detection.template_id);
+    const pcl::RegionXY template_region = linemod_.getTemplateRegion (linemod_detection.template_id);
 
     const size_t start_x = std::max (linemod_detection.x, 0);
     const size_t start_y = std::max (linemod_detection.y, 0);
-    const size_t end_x = std::min (static_cast<size_t> (start_x + linemod_template.region.width * linemod_detection.scale),
+    const size_t end_x = std::min (static_cast<size_t> (start_x + template_region.width * linemod_detection.scale),
                                    static_cast<size_t> (cloud_xyz_->width));
-    const size_t end_y = std::min (static_cast<size_t> (start_y + linemod_template.region.height * linemod_detection.scale),
+    const size_t end_y = std::min (static_cast<size_t> (start_y + template_region.height * linemod_detection.scale),
                                    static_cast<size_t> (cloud_xyz_->height));
 
     detection.region.x = linemod_detection.x;
     detection.region.y = linemod_detection.y;
-    detection.region.width  = linemod_template.region.width * linemod_detection.scale;
-    detection.region.height = linemod_template.region.height * linemod_detection.scale;
+    detection.region.width  = template_region.width * linemod_detection.scale;
+    detection.region.height = template_region.height * linemod_detection.scale;
 
     //std::cerr << "detection region: " << linemod_detection.x << ", "
     //  << linemod_detection.y << ", "
-    //  << linemod_template.region.width << ", "
-    //  << linemod_template.region.height << std::endl;
+    //  << template_region.width << ", "
+    //  << template_region.height << std::endl;
 
     float center_x = 0.0f;
     float center_y = 0.0f;
@@ -582,7 +664,7 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::detectSemiScaleInvariant (
     center_y *= inv_counter;
     center_z *= inv_counter;
 
-    pcl::BoundingBoxXYZ template_bounding_box = bounding_boxes_[detection.template_id];
+    pcl::BoundingBoxXYZ template_bounding_box = getTemplateBoundingBox (detection.template_id);
 
     detection.bounding_box = template_bounding_box;
     detection.bounding_box.x += center_x;
@@ -614,9 +696,10 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::computeTransformedTemplatePoints (
     PCL_ERROR ("ERROR pcl::LineRGBD::computeTransformedTemplatePoints - detection_id is out of bounds\n");
 
   const size_t template_id = detections_[detection_id].template_id;
-  const pcl::PointCloud<pcl::PointXYZRGBA> & template_point_cloud = template_point_clouds_[template_id];
+  pcl::PointCloud<pcl::PointXYZRGBA> bank_point_cloud;
+  const pcl::PointCloud<pcl::PointXYZRGBA> & template_point_cloud = getTemplatePointCloud (template_id, bank_point_cloud);
 
-  const pcl::BoundingBoxXYZ & template_bounding_box = bounding_boxes_[template_id];
+  const pcl::BoundingBoxXYZ template_bounding_box = getTemplateBoundingBox (template_id);
   const pcl::BoundingBoxXYZ & detection_bounding_box = detections_[detection_id].bounding_box;
 
   //std::cerr << "detection: " 
@@ -740,7 +823,8 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::applyProjectiveDepthICPOnDetections ()
     typename pcl::LineRGBD<PointXYZT, PointRGBT>::Detection & detection = detections_[detection_index];
 
     const size_t template_id = detection.template_id;
-    pcl::PointCloud<pcl::PointXYZRGBA> & point_cloud = template_point_clouds_[template_id];
+    pcl::PointCloud<pcl::PointXYZRGBA> bank_point_cloud;
+    const pcl::PointCloud<pcl::PointXYZRGBA> & point_cloud = getTemplatePointCloud (template_id, bank_point_cloud);
 
     const size_t start_x = detection.region.x;
     const size_t start_y = detection.region.y;
@@ -807,7 +891,7 @@ pcl::LineRGBD<PointXYZT, PointRGBT>::applyProjectiveDepthICPOnDetections ()
     }
     average_depth /= static_cast<float> (average_counter);
 
-    detection.bounding_box.z = bounding_boxes_[template_id].z + average_depth;// - detection.bounding_box.depth/2.0f;
+    detection.bounding_box.z = getTemplateBoundingBox (template_id).z + average_depth;// - detection.bounding_box.depth/2.0f;
   }
 }
 
@@ -42,9 +42,11 @@
 #include <cstddef>
 #include <string.h>
 #include <pcl/pcl_macros.h>
+#include <pcl/exceptions.h>
 #include <pcl/recognition/quantizable_modality.h>
 #include <pcl/recognition/region_xy.h>
 #include <pcl/recognition/sparse_quantized_multi_mod_template.h>
+#include <pcl/recognition/linemod/template_bank.h>
 
 namespace pcl
 {
@@ -415,22 +417,86 @@ namespace pcl
         average_detections_ = average_detections;
       }
 
-      /** \brief Returns the template with the specified ID.
+      /** \brief Sets the number of threads used for scoring the templates.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic).
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        nr_threads_ = nr_threads;
+      }
+
+      /** \brief Returns the template with the specified ID. Templates of the template bank can not be
+        *        accessed by reference, so the ID must not belong to the bank; use \ref getTemplateRegion or
+        *        \ref copyTemplate for IDs that may come from the bank, e.g. the ones of detections.
         * \param[in] template_id the ID of the template to return.
+        * \throws PCLException if the ID belongs to the template bank or is out of range.
         */
       inline const SparseQuantizedMultiModTemplate &
       getTemplate (int template_id) const
       { 
-        return (templates_[template_id]);
+        const size_t nr_bank_templates = getNumOfBankTemplates ();
+        if (template_id < 0 || static_cast<size_t> (template_id) < nr_bank_templates ||
+            static_cast<size_t> (template_id) - nr_bank_templates >= templates_.size ())
+          PCL_THROW_EXCEPTION (PCLException, "Template " << template_id << " is not an added template (" << nr_bank_templates
+                               << " bank templates, " << templates_.size () << " added templates)");
+        return (templates_[static_cast<size_t> (template_id) - nr_bank_templates]);
       }
 
-      /** \brief Returns the number of stored/trained templates. */
+      /** \brief Returns the region of the template with the specified ID.
+        * \param[in] template_id the ID of the template.
+        */
+      inline RegionXY
+      getTemplateRegion (int template_id) const
+      {
+        const size_t nr_bank_templates = getNumOfBankTemplates ();
+        if (static_cast<size_t> (template_id) < nr_bank_templates)
+          return (template_bank_->getRegion (template_id));
+        return (templates_[template_id - nr_bank_templates].region);
+      }
+
+      /** \brief Copies the template with the specified ID; works for templates of the template bank as well.
+        * \param[in] template_id the ID of the template to copy.
+        * \param[out] linemod_template the destination for the template.
+        */
+      void
+      copyTemplate (size_t template_id, SparseQuantizedMultiModTemplate & linemod_template) const;
+
+      /** \brief Returns the number of stored/trained templates, including the ones of the template bank. */
       inline size_t
       getNumOfTemplates () const
       {
-        return (templates_.size ());
+        return (getNumOfBankTemplates () + templates_.size ());
+      }
+
+      /** \brief Uses the templates of the specified bank in place. Overrides old templates; templates which are 
+        *        added afterwards get IDs following the ones of the bank.
+        * \param[in] template_bank the template bank (an opened bank or an empty pointer to remove the bank).
+        */
+      void
+      setTemplateBank (const LINEMODTemplateBank::ConstPtr & template_bank);
+
+      /** \brief Returns the template bank that is used, if any. */
+      inline LINEMODTemplateBank::ConstPtr
+      getTemplateBank () const
+      {
+        return (template_bank_);
       }
 
+      /** \brief Maps the specified template bank and uses its templates in place. Overrides old templates.
+        * \param[in] file_name the name of the template bank file.
+        * \return true, if the operation was successful, false otherwise.
+        */
+      bool
+      loadTemplateBank (const std::string & file_name);
+
+      /** \brief Writes all templates to a template bank which can be loaded with \ref loadTemplateBank.
+        * \param[in] file_name the name of the template bank file.
+        * \return true, if the operation was successful, false otherwise.
+        */
+      bool
+      saveTemplateBank (const std::string & file_name) const;
+
       /** \brief Saves the stored templates to the specified file.
         * \param[in] file_name the name of the file to save the templates to.
         */
@@ -457,6 +523,13 @@ namespace pcl
 
 
     private:
+      /** \brief Returns the number of templates stored in the template bank. */
+      inline size_t
+      getNumOfBankTemplates () const
+      {
+        return (template_bank_ ? template_bank_->getNumOfTemplates () : 0);
+      }
+
       /** template response threshold */
       float template_threshold_;
       /** states whether non-max-suppression on detections is enabled or not */
@@ -465,6 +538,10 @@ namespace pcl
       bool average_detections_;
       /** template storage */
       std::vector<SparseQuantizedMultiModTemplate> templates_;
+      /** memory-mapped template storage; its templates precede the ones in templates_ */
+      LINEMODTemplateBank::ConstPtr template_bank_;
+      /** number of threads used for scoring the templates (0 = automatic) */
+      unsigned int nr_threads_;
   };
 
 }
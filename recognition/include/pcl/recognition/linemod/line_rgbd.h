@@ -46,26 +46,6 @@
 namespace pcl
 {
 
-  struct BoundingBoxXYZ
-  {
-    /** \brief Constructor. */
-    BoundingBoxXYZ () : x (0.0f), y (0.0f), z (0.0f), width (0.0f), height (0.0f), depth (0.0f) {}
-
-    /** \brief X-coordinate of the upper left front point */
-    float x;
-    /** \brief Y-coordinate of the upper left front point */
-    float y;
-    /** \brief Z-coordinate of the upper left front point */
-    float z;
-
-    /** \brief Width of the bounding box */
-    float width;
-    /** \brief Height of the bounding box */
-    float height;
-    /** \brief Depth of the bounding box */
-    float depth;
-  };
-
   /** \brief High-level class for template matching using the LINEMOD approach based on RGB and Depth data.
     * \author Stefan Holzer
     */
@@ -130,6 +110,27 @@ namespace pcl
       bool
       addTemplate (const SparseQuantizedMultiModTemplate & sqmmt, pcl::PointCloud<pcl::PointXYZRGBA> & cloud, size_t object_id = 0);
 
+      /** \brief Maps a template bank (see \ref LINEMODTemplateBank) and uses it in place. Overrides old templates.
+        *
+        * The templates, object IDs, bounding boxes and template point clouds are read directly from the
+        * mapped file, so matching can start right after the bank has been opened.
+        *
+        * \param[in] file_name The name of the template bank file.
+        *
+        * \return true, if the operation was succesful, false otherwise.
+        */
+      bool
+      loadTemplateBank (const std::string &file_name);
+
+      /** \brief Writes all templates together with their object IDs, bounding boxes and point clouds to a
+        *        template bank that can be loaded with \ref loadTemplateBank.
+        * \param[in] file_name The name of the template bank file.
+        *
+        * \return true, if the operation was succesful, false otherwise.
+        */
+      bool
+      saveTemplateBank (const std::string &file_name) const;
+
       /** \brief Sets the threshold for the detection responses. Responses are between 0 and 1, where 1 is a best. 
         * \param[in] threshold The threshold used to decide where a template is detected.
         */
@@ -284,6 +285,29 @@ namespace pcl
       bool 
       readLTMHeader (int fd, pcl::io::TARHeader &header);
 
+      /** \brief Returns the number of templates stored in the template bank. */
+      inline size_t
+      getNumOfBankTemplates () const
+      {
+        const LINEMODTemplateBank::ConstPtr template_bank = linemod_.getTemplateBank ();
+        return (template_bank ? template_bank->getNumOfTemplates () : 0);
+      }
+
+      /** \brief Returns the object ID of the specified template. */
+      size_t
+      getTemplateObjectId (size_t template_id) const;
+
+      /** \brief Returns the bounding box of the specified template. */
+      BoundingBoxXYZ
+      getTemplateBoundingBox (size_t template_id) const;
+
+      /** \brief Returns the point cloud of the specified template.
+        * \param[in] template_id The ID of the template.
+        * \param[out] bank_cloud Storage for the cloud if the template is stored in the template bank.
+        */
+      const pcl::PointCloud<pcl::PointXYZRGBA> &
+      getTemplatePointCloud (size_t template_id, pcl::PointCloud<pcl::PointXYZRGBA> & bank_cloud) const;
+
       /** \brief Intersection volume threshold. */
       float intersection_volume_threshold_;
 
@@ -299,11 +323,11 @@ namespace pcl
       /** \brief RGB point cloud. */
       typename pcl::PointCloud<PointRGBT>::ConstPtr cloud_rgb_;
 
-      /** \brief Point clouds corresponding to the templates. */
+      /** \brief Point clouds corresponding to the templates (that are not stored in the template bank). */
       pcl::PointCloud<pcl::PointXYZRGBA>::CloudVectorType template_point_clouds_;
-      /** \brief Bounding boxes corresonding to the templates. */
+      /** \brief Bounding boxes corresonding to the templates (that are not stored in the template bank). */
       std::vector<pcl::BoundingBoxXYZ> bounding_boxes_;
-      /** \brief Object IDs corresponding to the templates. */
+      /** \brief Object IDs corresponding to the templates (that are not stored in the template bank). */
       std::vector<size_t> object_ids_;
 
       /** \brief Detections from last call of method detect (...). */
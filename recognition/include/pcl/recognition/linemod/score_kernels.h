@@ -0,0 +1,98 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_RECOGNITION_LINEMOD_SCORE_KERNELS
+#define PCL_RECOGNITION_LINEMOD_SCORE_KERNELS
+
+#include <cstddef>
+#include <vector>
+#include <pcl/pcl_macros.h>
+
+namespace pcl
+{
+  /** \brief Kernels used by LINEMOD for summing up the responses of the linearized maps. Responses are
+    * accumulated in 8-bit partial sums, which are periodically flushed into the 16-bit score sums.
+    * The score sums and the partial sums have to be 16-byte aligned.
+    */
+  struct PCL_EXPORTS LINEMODScoreKernels
+  {
+    /** \brief A single response is at most 4, so 63 responses fit into the 8-bit partial sums. */
+    static const size_t max_nr_pending_responses = 63;
+
+    /** \brief Name of the instruction set used by the kernels ("scalar", "SSE2" or "AVX2"). */
+    const char * name;
+    /** \brief Adds a linearized map to the partial sums. */
+    void (*accumulate) (unsigned char * tmp_score_sums, const unsigned char * data, size_t mem_size);
+    /** \brief Adds the partial sums to the score sums and resets them to zero. */
+    void (*flush) (unsigned short * score_sums, unsigned char * tmp_score_sums, size_t mem_size);
+
+    /** \brief Adds a linearized map to the partial sums and flushes them once they hold
+      * max_nr_pending_responses responses.
+      * \param[in,out] score_sums the score sums.
+      * \param[in,out] tmp_score_sums the partial sums.
+      * \param[in] data the linearized map.
+      * \param[in] mem_size the number of elements of the linearized map.
+      * \param[in,out] nr_pending_responses the number of responses in the partial sums.
+      */
+    inline void
+    addResponse (unsigned short * score_sums, unsigned char * tmp_score_sums, const unsigned char * data,
+                 const size_t mem_size, size_t & nr_pending_responses) const
+    {
+      accumulate (tmp_score_sums, data, mem_size);
+      if (++nr_pending_responses == max_nr_pending_responses)
+      {
+        flush (score_sums, tmp_score_sums, mem_size);
+        nr_pending_responses = 0;
+      }
+    }
+
+    /** \brief Returns the fastest kernels supported by the CPU; they are selected on first use. */
+    static const LINEMODScoreKernels &
+    getDefault ();
+
+    /** \brief Returns all kernels which are compiled in and supported by the CPU, from the scalar
+      * ones to the fastest ones.
+      */
+    static std::vector<LINEMODScoreKernels>
+    getAvailable ();
+  };
+}
+
+#endif
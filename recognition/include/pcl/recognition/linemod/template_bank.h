@@ -0,0 +1,311 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#ifndef PCL_RECOGNITION_LINEMOD_TEMPLATE_BANK
+#define PCL_RECOGNITION_LINEMOD_TEMPLATE_BANK
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/recognition/region_xy.h>
+#include <pcl/recognition/sparse_quantized_multi_mod_template.h>
+
+namespace pcl
+{
+
+  struct BoundingBoxXYZ
+  {
+    /** \brief Constructor. */
+    BoundingBoxXYZ () : x (0.0f), y (0.0f), z (0.0f), width (0.0f), height (0.0f), depth (0.0f) {}
+
+    /** \brief X-coordinate of the upper left front point */
+    float x;
+    /** \brief Y-coordinate of the upper left front point */
+    float y;
+    /** \brief Z-coordinate of the upper left front point */
+    float z;
+
+    /** \brief Width of the bounding box */
+    float width;
+    /** \brief Height of the bounding box */
+    float height;
+    /** \brief Depth of the bounding box */
+    float depth;
+  };
+
+  /** \brief A flat binary bank of LINEMOD templates which is memory-mapped and used in place.
+    *
+    * Unlike the stream based serialization of \ref SparseQuantizedMultiModTemplate, a template bank
+    * is matched directly from the mapped file, so opening it does not parse or copy any template.
+    * A bank consists of a versioned header followed by four arrays of fixed-size records:
+    *  - the objects, each referencing a contiguous range of templates,
+    *  - the templates, holding their region, 3D bounding box and the ranges of their features and points,
+    *  - the features of all templates,
+    *  - the (optional) organized template point clouds.
+    *
+    * Records are stored in the byte order of the machine that wrote the bank; banks written with a
+    * different byte order or format version are rejected by \ref open.
+    */
+  class PCL_EXPORTS LINEMODTemplateBank
+  {
+    public:
+      typedef boost::shared_ptr<LINEMODTemplateBank> Ptr;
+      typedef boost::shared_ptr<const LINEMODTemplateBank> ConstPtr;
+
+      /** \brief The version of the bank format written by this implementation. */
+      static const pcl::uint32_t VERSION = 1;
+
+      /** \brief File header of a template bank. */
+      struct Header
+      {
+        /** \brief Identifies the file as a template bank ("PCLLMTB"). */
+        char magic[8];
+        /** \brief Version of the bank format. */
+        pcl::uint32_t version;
+        /** \brief Written as 0x01020304; used for detecting banks of a different byte order. */
+        pcl::uint32_t byte_order_mark;
+        /** \brief Number of objects. */
+        pcl::uint32_t nr_objects;
+        /** \brief Number of templates. */
+        pcl::uint32_t nr_templates;
+        /** \brief Total number of features. */
+        pcl::uint64_t nr_features;
+        /** \brief Total number of template points. */
+        pcl::uint64_t nr_points;
+        /** \brief File offsets of the object, template, feature and point records. */
+        pcl::uint64_t objects_offset;
+        pcl::uint64_t templates_offset;
+        pcl::uint64_t features_offset;
+        pcl::uint64_t points_offset;
+        /** \brief Size of the complete file in bytes. */
+        pcl::uint64_t file_size;
+      };
+
+      /** \brief An object and the contiguous range of templates that belong to it. */
+      struct ObjectRecord
+      {
+        pcl::uint64_t object_id;
+        pcl::uint32_t first_template;
+        pcl::uint32_t nr_templates;
+      };
+
+      /** \brief A template: its region, its bounding box and the ranges of its features and points. */
+      struct TemplateRecord
+      {
+        pcl::int32_t region_x;
+        pcl::int32_t region_y;
+        pcl::int32_t region_width;
+        pcl::int32_t region_height;
+        float bounding_box_x;
+        float bounding_box_y;
+        float bounding_box_z;
+        float bounding_box_width;
+        float bounding_box_height;
+        float bounding_box_depth;
+        pcl::uint32_t object_index;
+        pcl::uint32_t nr_features;
+        pcl::uint64_t first_feature;
+        pcl::uint64_t first_point;
+        pcl::uint32_t cloud_width;
+        pcl::uint32_t cloud_height;
+      };
+
+      /** \brief A quantized multi-modality feature; has the same members as \ref QuantizedMultiModFeature. */
+      struct FeatureRecord
+      {
+        pcl::int32_t x;
+        pcl::int32_t y;
+        pcl::uint8_t modality_index;
+        pcl::uint8_t quantized_value;
+        pcl::uint16_t reserved;
+      };
+
+      /** \brief A point of a template point cloud. */
+      struct PointRecord
+      {
+        float x;
+        float y;
+        float z;
+        pcl::uint32_t rgba;
+      };
+
+      /** \brief Constructor. */
+      LINEMODTemplateBank ();
+
+      /** \brief Destructor. Unmaps the bank. */
+      ~LINEMODTemplateBank ();
+
+      /** \brief Maps the specified bank into memory and validates its header and record ranges.
+        * \param[in] file_name the name of the bank file.
+        * \return true, if the operation was successful, false otherwise.
+        */
+      bool
+      open (const std::string & file_name);
+
+      /** \brief Unmaps the bank. */
+      void
+      close ();
+
+      /** \brief Returns true if a bank is mapped. */
+      inline bool
+      isOpen () const
+      {
+        return (header_ != NULL);
+      }
+
+      /** \brief Writes a template bank. Templates are grouped by object in the order in which the objects
+        * first appear; the order of the templates of each object is preserved.
+        * \param[in] file_name the name of the bank file.
+        * \param[in] templates the templates to store.
+        * \param[in] object_ids the object ID of every template.
+        * \param[in] bounding_boxes the bounding box of every template (may be empty).
+        * \param[in] clouds the point cloud of every template (may be empty).
+        * \return true, if the operation was successful, false otherwise.
+        */
+      static bool
+      write (const std::string & file_name,
+             const std::vector<SparseQuantizedMultiModTemplate> & templates,
+             const std::vector<size_t> & object_ids,
+             const std::vector<BoundingBoxXYZ> & bounding_boxes = std::vector<BoundingBoxXYZ> (),
+             const PointCloud<PointXYZRGBA>::CloudVectorType & clouds = PointCloud<PointXYZRGBA>::CloudVectorType ());
+
+      /** \brief Returns the number of objects. */
+      inline size_t
+      getNumOfObjects () const
+      {
+        return (header_ ? header_->nr_objects : 0);
+      }
+
+      /** \brief Returns the number of templates. */
+      inline size_t
+      getNumOfTemplates () const
+      {
+        return (header_ ? header_->nr_templates : 0);
+      }
+
+      /** \brief Returns the record of the specified object. */
+      inline const ObjectRecord &
+      getObject (size_t object_index) const
+      {
+        return (objects_[object_index]);
+      }
+
+      /** \brief Returns the record of the specified template. */
+      inline const TemplateRecord &
+      getTemplateRecord (size_t template_index) const
+      {
+        return (templates_[template_index]);
+      }
+
+      /** \brief Returns the object ID of the specified template. */
+      inline size_t
+      getObjectId (size_t template_index) const
+      {
+        return (static_cast<size_t> (objects_[templates_[template_index].object_index].object_id));
+      }
+
+      /** \brief Returns the features of the specified template. */
+      inline const FeatureRecord *
+      getFeatures (size_t template_index) const
+      {
+        return (features_ + templates_[template_index].first_feature);
+      }
+
+      /** \brief Returns the number of features of the specified template. */
+      inline size_t
+      getNumOfFeatures (size_t template_index) const
+      {
+        return (templates_[template_index].nr_features);
+      }
+
+      /** \brief Returns the region of the specified template. */
+      RegionXY
+      getRegion (size_t template_index) const;
+
+      /** \brief Returns the bounding box of the specified template. */
+      BoundingBoxXYZ
+      getBoundingBox (size_t template_index) const;
+
+      /** \brief Copies the specified template out of the bank.
+        * \param[in] template_index the index of the template.
+        * \param[out] linemod_template the destination for the template.
+        */
+      void
+      getTemplate (size_t template_index, SparseQuantizedMultiModTemplate & linemod_template) const;
+
+      /** \brief Copies the point cloud of the specified template out of the bank.
+        * \param[in] template_index the index of the template.
+        * \param[out] cloud the destination for the point cloud.
+        */
+      void
+      getPointCloud (size_t template_index, PointCloud<PointXYZRGBA> & cloud) const;
+
+    private:
+      /** \brief Checks the header and the record ranges of the mapped bank and sets up the record pointers. */
+      bool
+      validate (size_t mapped_size);
+
+      /** \brief Start of the mapped file. */
+      char * map_;
+      /** \brief Size of the mapping in bytes. */
+      size_t map_size_;
+#ifdef _WIN32
+      /** \brief Handle of the file mapping. */
+      void * file_mapping_;
+#endif
+      /** \brief Pointers into the mapped file. */
+      const Header * header_;
+      const ObjectRecord * objects_;
+      const TemplateRecord * templates_;
+      const FeatureRecord * features_;
+      const PointRecord * points_;
+
+      /** \brief The bank owns a mapping, so it can not be copied. */
+      LINEMODTemplateBank (const LINEMODTemplateBank &);
+      LINEMODTemplateBank &
+      operator= (const LINEMODTemplateBank &);
+  };
+
+}
+
+#endif
@@ -45,6 +45,7 @@
 #include <pcl/point_cloud.h>
 #include <pcl/point_types.h>
 #include <string>
+#include <vector>
 #include <list>
 #include <set>
 #include <map>
@@ -73,15 +74,27 @@ namespace pcl
               points_ (points),
               normals_(normals),
               obj_name_(object_name){}
+            /** \brief Constructs a model which owns its points and normals (used for models loaded from a file). */
+            Model (const PointCloudIn::Ptr& points, const PointCloudN::Ptr& normals, std::string object_name):
+              points_ (points.get ()),
+              normals_(normals.get ()),
+              obj_name_(object_name),
+              own_points_ (points),
+              own_normals_ (normals){}
             virtual ~Model (){}
 
             ORROctree& getOctree() { return octree_;}
+            const ORROctree& getOctree() const { return octree_;}
 
           public:
             PointCloudIn *points_;
             PointCloudN *normals_;
             const std::string obj_name_;
             ORROctree octree_;
+
+          protected:
+            PointCloudIn::Ptr own_points_;
+            PointCloudN::Ptr own_normals_;
         };
 
         typedef std::list<std::pair<ORROctree::Node::Data*,ORROctree::Node::Data*> > node_data_pair_list;
@@ -111,6 +124,48 @@ namespace pcl
         bool
         addModel (PointCloudIn* points, PointCloudN* normals, const std::string& object_name);
 
+        /** \brief Adds several models to the hash table. The models are processed in parallel.
+          *
+          * \param[in] points represent the models to be added.
+          * \param[in] normals are the normals at the model points.
+          * \param[in] object_names are the unique names of the objects to be added.
+          *
+          * Returns true if all models have been added and false otherwise; in the latter case, no model is added. */
+        bool
+        addModels (const std::vector<PointCloudIn*>& points, const std::vector<PointCloudN*>& normals, const std::vector<std::string>& object_names);
+
+        /** \brief Saves the models and the hash table to a binary file which can be loaded with loadFromFile().
+          *
+          * The file contains the model points and normals and, for each oriented point pair in the hash table, the hash table cell and
+          * the ids of the two octree leaves. Loading it only rebuilds the octrees and refills the hash table, the pairs are not recomputed.
+          *
+          * Returns true on success and false otherwise. */
+        bool
+        saveToFile (const std::string& file_name) const;
+
+        /** \brief Replaces the models and the hash table by the ones saved in 'file_name' with saveToFile(). The file is memory mapped and
+          * has to be written with the same pair width and voxel size as this library. The models loaded from a file own their points and
+          * normals.
+          *
+          * Returns true on success and false otherwise (in that case the library is empty). */
+        bool
+        loadFromFile (const std::string& file_name);
+
+        /** \brief Set the number of threads used by addModels() and loadFromFile().
+          * \param[in] nr_threads the number of threads to use (0 sets the value back to automatic). */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+        }
+
+        /** \brief Returns the models of this library, sorted by name. */
+        const std::map<std::string,Model*>&
+        getModels () const
+        {
+          return (models_);
+        }
+
         /** \brief Returns the hash table built by this instance. */
         const HashTable*
         getHashTable ()
@@ -118,9 +173,29 @@ namespace pcl
           return (&hash_table_);
         }
 
+        /** \brief Returns the tolerance on the distance between the points of an oriented point pair. */
+        float
+        getPairWidthEps () const
+        {
+          return (pair_width_eps_);
+        }
+
       protected:
+        /** \brief An oriented point pair of a model together with the id of the hash table cell it belongs to. */
+        struct HashTableEntry
+        {
+          int cell_id;
+          ORROctree::Node::Data *data1, *data2;
+        };
+
+        /** \brief Computes the hash table entries of all oriented point pairs of the model (the octree has to be built already). */
+        void
+        computeHashTableEntries (Model* model, std::vector<HashTableEntry>& entries) const;
+
+        /** \brief Inserts the entries of the models in parallel; each thread fills its own set of hash table cells. Since the entries of each
+          * model are inserted in order, the result is the same as the one of a sequential insertion. */
         void
-        addToHashTable (const Model* model, ORROctree::Node::Data* data1, ORROctree::Node::Data* data2);
+        fillHashTable (const std::vector<Model*>& models, const std::vector<std::vector<HashTableEntry> >& entries);
 
       protected:
         std::map<std::string,Model*> models_;
@@ -128,6 +203,7 @@ namespace pcl
 
         HashTable hash_table_;
         int num_of_cells_[3];
+        unsigned int threads_;
     };
   } // namespace recognition
 } // namespace pcl
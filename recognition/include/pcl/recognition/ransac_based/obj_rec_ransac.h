@@ -40,11 +40,13 @@
 #define PCL_RECOGNITION_OBJ_REC_RANSAC_H_
 
 #include "model_library.h"
+#include "orr_octree.h"
 #include "auxiliary.h"
 #include <pcl/pcl_exports.h>
 #include <pcl/point_cloud.h>
 #include <cmath>
 #include <string>
+#include <vector>
 #include <list>
 
 #define OBJ_REC_RANSAC_VERBOSE
@@ -57,6 +59,10 @@ namespace pcl
       * representing the objects to be recognized and (ii) call recognize() with the 3D scene in which the objects should be recognized. Recognition means both
       * object identification and pose (position + orientation) estimation. Check the method descriptions for more details.
       *
+      * The hypotheses are generated and scored in parallel: each thread draws its own oriented point pairs from the scene, looks
+      * them up in the model library and scores the resulting rigid transforms. Every sample writes its hypotheses into its own
+      * slot of a shared pool, so no locking is needed and the result does not depend on the number of threads.
+      *
       * \note If you use this code in any academic work, please cite:
       *
       *   - Chavdar Papazov, Sami Haddadin, Sven Parusel, Kai Krieger and Darius Burschka.
@@ -144,15 +150,95 @@ namespace pcl
           return (model_library_.addModel (points, normals, object_name));
         }
 
+        /** \brief Add several object models to be recognized. The model octrees and hash table entries are computed in parallel (see
+          * setNumberOfThreads()). The method returns true if all models were added and false otherwise (in that case no model is added).
+          */
+        bool
+        addModels (const std::vector<PointCloudIn*>& points, const std::vector<PointCloudN*>& normals, const std::vector<std::string>& object_names)
+        {
+          return (model_library_.addModels (points, normals, object_names));
+        }
+
+        /** \brief Saves the model library (the models and the hash table) to a binary file. */
+        bool
+        saveModelLibrary (const std::string& file_name) const
+        {
+          return (model_library_.saveToFile (file_name));
+        }
+
+        /** \brief Replaces the model library by the one saved in 'file_name' with saveModelLibrary(). The library has to be saved by an
+          * instance constructed with the same pair width and voxel size. */
+        bool
+        loadModelLibrary (const std::string& file_name)
+        {
+          return (model_library_.loadFromFile (file_name));
+        }
+
         /** \brief This method performs the recognition of the models loaded to the model library with the method addModel().
           *
           * \param[in]  scene is the 3d scene in which the object should be recognized.
           * \param[in]  normals are the scene normals.
           * \param[out] recognized_objects is the list of output items each one containing the recognized model instance, its name, the aligning rigid transform
           * and the match confidence (see ObjRecRANSAC::Output for further explanations).
+          * \param[in]  success_probability is the desired probability of detecting all objects in the scene. It determines, together with the visibility and
+          * the relative object size, the number of oriented point pairs which are sampled from the scene.
           */
         void
-        recognize (const pcl::PointCloud<Eigen::Vector3d>& scene, const pcl::PointCloud<Eigen::Vector3d>& normals, std::list<ObjRecRANSAC::Output>& recognized_objects);
+        recognize (const PointCloudIn& scene, const PointCloudN& normals, std::list<ObjRecRANSAC::Output>& recognized_objects, double success_probability = 0.99);
+
+        /** \brief Sets the minimal fraction of the model (leaves of the model octree) which has to be matched to the scene in order to accept a hypothesis.
+          * Default is 0.2. */
+        void
+        setVisibility (float visibility)
+        {
+          visibility_ = visibility;
+        }
+
+        /** \brief Returns the minimal fraction of the model which has to be matched to the scene in order to accept a hypothesis. */
+        float
+        getVisibility () const
+        {
+          return (visibility_);
+        }
+
+        /** \brief Sets the expected size of the smallest object relative to the scene, i.e., the fraction of the scene points which lie on that object.
+          * Only used to compute the number of samples. Default is 0.05. */
+        void
+        setRelativeObjectSize (float size)
+        {
+          relative_object_size_ = size;
+        }
+
+        /** \brief Returns the expected size of the smallest object relative to the scene. */
+        float
+        getRelativeObjectSize () const
+        {
+          return (relative_object_size_);
+        }
+
+        /** \brief Set the number of threads used for generating and scoring the hypotheses and for adding and loading models.
+          * \param[in] nr_threads the number of threads to use (0 sets the value back to automatic). */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0)
+        {
+          threads_ = nr_threads;
+          model_library_.setNumberOfThreads (nr_threads);
+        }
+
+        /** \brief Sets the seed of the random sampling of the scene point pairs. For a given seed, the recognition result does not
+          * depend on the number of threads. Default is 0. */
+        void
+        setSeed (unsigned int seed)
+        {
+          seed_ = seed;
+        }
+
+        /** \brief Returns the seed of the random sampling of the scene point pairs. */
+        unsigned int
+        getSeed () const
+        {
+          return (seed_);
+        }
 
         /** \brief Computes the signature of the oriented point pair ((p1, n1), (p2, n2)) consisting of the angles between
           * n1 and (p2-p1),
@@ -171,8 +257,53 @@ namespace pcl
         }
 
       protected:
-        float pair_width_;
+        /** \brief A rigid transform aligning a model with the scene together with its score. */
+        class Hypothesis
+        {
+          public:
+            Hypothesis () : obj_model_ (NULL), match_confidence_ (0.0f) {}
+
+          public:
+            const ModelLibrary::Model* obj_model_;
+            /** \brief The rotation matrix (row-major) followed by the translation. */
+            float rigid_transform_[12];
+            /** \brief The fraction of the model leaves which have been matched to the scene. */
+            float match_confidence_;
+            /** \brief The (sorted) scene leaves explained by this hypothesis. */
+            std::vector<const ORROctree::Node*> explained_leaves_;
+        };
+
+        /** \brief Returns the number of oriented point pairs which have to be sampled to detect all objects with the given probability. */
+        int
+        computeNumberOfIterations (double success_probability) const;
+
+        /** \brief Samples 'num_iterations' oriented point pairs from the scene octree, generates a hypothesis for each matching model pair in the hash
+          * table and keeps the ones which pass the visibility test. Runs in parallel. */
+        void
+        generateHypotheses (int num_iterations, std::vector<Hypothesis>& hypotheses);
+
+        /** \brief Scores a hypothesis by counting the transformed model leaves which fall into full scene leaves.
+          * Returns false as soon as the hypothesis can not pass the visibility test anymore. */
+        bool
+        testHypothesis (Hypothesis& hypothesis) const;
+
+        /** \brief Resolves the conflicts between hypotheses explaining the same scene parts, starting with the best ones. */
+        void
+        filterHypotheses (std::vector<Hypothesis>& hypotheses, std::list<ObjRecRANSAC::Output>& recognized_objects) const;
+
+        /** \brief Computes the rigid transform which maps the oriented point pair (a1, a1_n, a2, a2_n) onto (b1, b1_n, b2, b2_n).
+          * Returns false if one of the pairs is degenerate. */
+        static bool
+        computeRigidTransform (const float *a1, const float *a1_n, const float *a2, const float *a2_n,
+                               const float *b1, const float *b1_n, const float *b2, const float *b2_n, float rigid_transform[12]);
+
+      protected:
+        float pair_width_, voxel_size_;
+        float visibility_, relative_object_size_;
+        unsigned int threads_;
+        unsigned int seed_;
         ModelLibrary model_library_;
+        ORROctree scene_octree_;
     };
 
 // === inline methods ===================================================================================================================================
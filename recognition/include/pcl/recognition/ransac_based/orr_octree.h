@@ -147,6 +147,15 @@ namespace pcl
         std::vector<ORROctree::Node*>&
         getFullLeaves () { return full_leaves_;}
 
+        /** \brief Returns a vector with all octree leaves which contain at least one point. */
+        const std::vector<ORROctree::Node*>&
+        getFullLeaves () const { return full_leaves_;}
+
+        /** \brief Returns the full leaf which contains 'p' or NULL if 'p' lies in an empty leaf or outside
+          * of the octree. The method does not modify the octree, so it can be called from several threads. */
+        ORROctree::Node*
+        getFullLeaf (const float* p) const;
+
         void getFullLeafPoints (PointCloudOut& out);
         void getNormalsOfFullLeaves (PointCloudN& out);
 
@@ -65,6 +65,10 @@ namespace pcl
       inline T*
       getVoxel (const REAL p[3]);
 
+      /** \brief Returns a pointer to the voxel which contains p or NULL if p is not inside the structure. */
+      inline const T*
+      getVoxel (const REAL p[3]) const;
+
       /** \brief Returns the linear voxel array. */
       const inline T*
       getVoxels () const
@@ -171,6 +175,13 @@ namespace pcl
       return &voxels_[z*num_of_voxels_xy_plane_ + y*num_of_voxels_[0] + x];
     }
 
+    template<class T, typename REAL>
+    inline const T*
+    VoxelStructure<T,REAL>::getVoxel(const REAL p[3]) const
+    {
+      return (const_cast<VoxelStructure<T,REAL>*> (this)->getVoxel (p));
+    }
+
   } // namespace recognition
 } // namespace pcl
 
@@ -42,6 +42,12 @@
 #include "pcl/recognition/cg/hough_3d.h"
 #include "pcl/recognition/impl/cg/hough_3d.hpp"
 
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 PCL_INSTANTIATE_PRODUCT(Hough3DGrouping, ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA))
                                          ((pcl::PointXYZ)(pcl::PointXYZI)(pcl::PointXYZRGB)(pcl::PointXYZRGBA))
                                          ((pcl::ReferenceFrame))((pcl::ReferenceFrame)))
@@ -267,3 +273,305 @@ pcl::recognition::HoughSpace3D::findMaxima (double min_threshold, std::vector<do
 
   return (min_threshold);
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::recognition::SparseHoughSpace3D::SparseHoughSpace3D (const Eigen::Vector3d &min_coord, const Eigen::Vector3d &bin_size,
+                                                          const Eigen::Vector3d &max_coord, unsigned int nr_threads)
+  : min_coord_ (min_coord)
+  , bin_size_ (bin_size)
+  , bin_count_ ()
+  , threads_ (nr_threads)
+  , bins_ ()
+{
+  for (int i = 0; i < 3; ++i)
+  {
+    bin_count_[i] = static_cast<int> (ceil ((max_coord[i] - min_coord_[i]) / bin_size_[i]));
+  }
+
+  partial_bin_products_[0] = 1;
+  for (int i=1; i<=3; ++i)
+    partial_bin_products_[i] = bin_count_[i-1]*partial_bin_products_[i-1];
+
+  reset ();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::recognition::SparseHoughSpace3D::reset ()
+{
+#ifdef _OPENMP
+  const size_t nr_shards = threads_ ? threads_ : static_cast<size_t> (omp_get_max_threads ());
+#else
+  const size_t nr_shards = 1;
+#endif
+
+  bins_.clear ();
+  bins_.resize (nr_shards);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+size_t
+pcl::recognition::SparseHoughSpace3D::getNumberOfOccupiedBins () const
+{
+  size_t nr_bins = 0;
+  for (size_t shard = 0; shard < bins_.size (); ++shard)
+    nr_bins += bins_[shard].size ();
+  return (nr_bins);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::int64_t
+pcl::recognition::SparseHoughSpace3D::computeContributions (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id,
+                                                            bool interpolate, std::vector<Contribution> &contributions) const
+{
+  Contribution contribution;
+  contribution.voter_id = voter_id;
+
+  pcl::int64_t central_bin_index = 0;
+  Eigen::Vector3i central_bin_coord;
+  for (int d = 0; d < 3; ++d)
+  {
+    central_bin_coord[d] = static_cast<int> (floor ((single_vote_coord[d] - min_coord_[d]) / bin_size_[d]));
+    if (central_bin_coord[d] < 0 || central_bin_coord[d] >= bin_count_[d])
+      return (-1);
+
+    central_bin_index += partial_bin_products_[d] * central_bin_coord[d];
+  }
+
+  if (!interpolate)
+  {
+    contribution.bin_index = central_bin_index;
+    contribution.weight = weight;
+    contributions.push_back (contribution);
+    return (central_bin_index);
+  }
+
+  // Same interpolation scheme as HoughSpace3D::voteInt, so that both spaces accumulate identical values
+  Eigen::Vector3f bin_centroid;
+  Eigen::Vector3f central_bin_weight;
+  Eigen::Vector3i interp_bin;
+  for (int d = 0; d < 3; ++d)
+  {
+    bin_centroid[d] = static_cast<float> ((2 * static_cast<double> (central_bin_coord[d]) * bin_size_[d] + bin_size_[d]) / 2.0 );
+    central_bin_weight[d] = static_cast<float> (1 - (fabs (single_vote_coord[d] - min_coord_[d] - bin_centroid[d]) / bin_size_[d] ) );
+
+    if ((single_vote_coord[d] - min_coord_[d]) < bin_centroid[d])
+      interp_bin[d] = central_bin_coord[d] - 1;
+    else if ((single_vote_coord[d] - min_coord_[d]) > bin_centroid[d])
+      interp_bin[d] = central_bin_coord[d] + 1;
+    else
+      interp_bin[d] = central_bin_coord[d];
+  }
+
+  const int n_neigh = 27; // total number of neighbours = 3^nDim = 27
+  for (int n = 0; n < n_neigh; ++n)
+  {
+    pcl::int64_t final_bin_index = 0;
+    float interp_weight = 1.0f;
+    int exp = 1;
+    bool invalid = false;
+
+    for (int d = 0; d < 3; ++d)
+    {
+      const int curr_neigh_index = central_bin_coord[d] + ( n % (exp*3) ) / exp - 1; // (n % 3^(d+1) / 3^d) - 1
+      if (curr_neigh_index < 0 || curr_neigh_index > bin_count_[d]-1)
+      {
+        invalid = true;
+        break;
+      }
+
+      if (curr_neigh_index == interp_bin[d])
+        interp_weight *= 1-central_bin_weight[d];
+      else if (curr_neigh_index == central_bin_coord[d])
+        interp_weight *= central_bin_weight[d];
+      else
+      {
+        invalid = true;
+        break;
+      }
+
+      final_bin_index += curr_neigh_index * partial_bin_products_[d];
+      exp *= 3;
+    }
+
+    if (!invalid)
+    {
+      contribution.bin_index = final_bin_index;
+      contribution.weight = weight * interp_weight;
+      contributions.push_back (contribution);
+    }
+  }
+
+  return (central_bin_index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::int64_t
+pcl::recognition::SparseHoughSpace3D::vote (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
+{
+  std::vector<Contribution> contributions;
+  const pcl::int64_t index = computeContributions (single_vote_coord, weight, voter_id, false, contributions);
+  for (size_t i = 0; i < contributions.size (); ++i)
+    addContribution (contributions[i]);
+  return (index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::int64_t
+pcl::recognition::SparseHoughSpace3D::voteInt (const Eigen::Vector3d &single_vote_coord, double weight, int voter_id)
+{
+  std::vector<Contribution> contributions;
+  const pcl::int64_t index = computeContributions (single_vote_coord, weight, voter_id, true, contributions);
+  for (size_t i = 0; i < contributions.size (); ++i)
+    addContribution (contributions[i]);
+  return (index);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::recognition::SparseHoughSpace3D::vote (const std::vector<Eigen::Vector3d> &vote_coords, const std::vector<double> &weights, bool interpolate)
+{
+  const size_t nr_votes = vote_coords.size ();
+  const size_t nr_shards = bins_.size ();
+
+  // One buffer per thread; each thread handles a contiguous range of voters so that, when the buffers are
+  // merged in thread order, every bin receives its votes in the order in which they have been cast
+  std::vector<std::vector<Contribution> > buffers (nr_shards);
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(static_cast<int> (nr_shards))
+#endif
+  {
+#ifdef _OPENMP
+    const size_t thread_id = static_cast<size_t> (omp_get_thread_num ());
+    const size_t nr_threads = static_cast<size_t> (omp_get_num_threads ());
+#else
+    const size_t thread_id = 0;
+    const size_t nr_threads = 1;
+#endif
+
+    const size_t begin = nr_votes * thread_id / nr_threads;
+    const size_t end = nr_votes * (thread_id + 1) / nr_threads;
+
+    std::vector<Contribution> &buffer = buffers[thread_id];
+    buffer.reserve ((end - begin) * (interpolate ? 8 : 1));
+    for (size_t i = begin; i < end; ++i)
+      computeContributions (vote_coords[i], weights[i], static_cast<int> (i), interpolate, buffer);
+
+#ifdef _OPENMP
+#pragma omp barrier
+#endif
+
+    for (size_t shard = thread_id; shard < nr_shards; shard += nr_threads)
+    {
+      for (size_t buffer_id = 0; buffer_id < nr_threads; ++buffer_id)
+      {
+        const std::vector<Contribution> &contributions = buffers[buffer_id];
+        for (size_t i = 0; i < contributions.size (); ++i)
+        {
+          if (getShardIndex (contributions[i].bin_index) == shard)
+            addContribution (contributions[i]);
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+double
+pcl::recognition::SparseHoughSpace3D::findMaxima (double min_threshold, std::vector<double> &maxima_values, std::vector<std::vector<int> > &maxima_voter_ids)
+{
+  typedef std::pair<pcl::int64_t, const Bin*> BinEntry;
+
+  std::vector<BinEntry> occupied_bins;
+  occupied_bins.reserve (getNumberOfOccupiedBins ());
+  for (size_t shard = 0; shard < bins_.size (); ++shard)
+    for (BinMap::const_iterator it = bins_[shard].begin (); it != bins_[shard].end (); ++it)
+      occupied_bins.push_back (BinEntry (it->first, &it->second));
+
+  const int nr_bins = static_cast<int> (occupied_bins.size ());
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#else
+  const int nr_threads = 1;
+#endif
+
+  // If min_threshold between -1 and 0 use it as a percentage of maximum vote
+  if (min_threshold < 0)
+  {
+    std::vector<double> thread_maxima (nr_threads, std::numeric_limits<double>::min ());
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads) schedule(static)
+#endif
+    for (int i = 0; i < nr_bins; ++i)
+    {
+#ifdef _OPENMP
+      double &thread_maximum = thread_maxima[omp_get_thread_num ()];
+#else
+      double &thread_maximum = thread_maxima[0];
+#endif
+      if (occupied_bins[i].second->value > thread_maximum)
+        thread_maximum = occupied_bins[i].second->value;
+    }
+
+    const double hough_maximum = *std::max_element (thread_maxima.begin (), thread_maxima.end ());
+    min_threshold = min_threshold >= -1 ? -min_threshold * hough_maximum : hough_maximum;
+  }
+
+  std::vector<std::vector<BinEntry> > thread_maxima (nr_threads);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads) schedule(dynamic, 256)
+#endif
+  for (int i = 0; i < nr_bins; ++i)
+  {
+    const pcl::int64_t index = occupied_bins[i].first;
+    const double value = occupied_bins[i].second->value;
+    if (value < min_threshold)
+      continue;
+
+    // Check with neighbors
+    bool is_maximum = true;
+    pcl::int64_t moduled_index = index;
+    for (int k = 2; k >= 0; --k)
+    {
+      moduled_index = moduled_index % partial_bin_products_[k+1];
+      const pcl::int64_t coord = moduled_index / partial_bin_products_[k];
+
+      if (coord > 0 && value < getBinValue (index - partial_bin_products_[k]))
+      {
+        is_maximum = false;
+        break;
+      }
+      if (coord < bin_count_[k]-1 && value < getBinValue (index + partial_bin_products_[k]))
+      {
+        is_maximum = false;
+        break;
+      }
+    }
+
+    if (is_maximum)
+    {
+#ifdef _OPENMP
+      thread_maxima[omp_get_thread_num ()].push_back (occupied_bins[i]);
+#else
+      thread_maxima[0].push_back (occupied_bins[i]);
+#endif
+    }
+  }
+
+  // Report the maxima sorted by bin index, as HoughSpace3D does
+  std::vector<BinEntry> maxima;
+  for (int t = 0; t < nr_threads; ++t)
+    maxima.insert (maxima.end (), thread_maxima[t].begin (), thread_maxima[t].end ());
+  std::sort (maxima.begin (), maxima.end ());
+
+  maxima_values.resize (maxima.size ());
+  maxima_voter_ids.resize (maxima.size ());
+  for (size_t i = 0; i < maxima.size (); ++i)
+  {
+    maxima_values[i] = maxima[i].second->value;
+    maxima_voter_ids[i] = maxima[i].second->voter_ids;
+  }
+
+  return (min_threshold);
+}
@@ -38,21 +38,103 @@
 //#define __SSE2__
 
 #include <pcl/recognition/linemod.h>
+#include <pcl/recognition/linemod/score_kernels.h>
 
-#ifdef __SSE2__
-#include <emmintrin.h>
+#ifdef _OPENMP
+#include <omp.h>
 #endif
 
 #include <fstream>
 
 //#define LINEMOD_USE_SEPARATE_ENERGY_MAPS
 
+namespace
+{
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Sums up the responses of all features of a template for every position of the linearized maps.
+    * \param[in] features the features of the template (QuantizedMultiModFeature or LINEMODTemplateBank::FeatureRecord).
+    * \param[in] nr_features the number of features of the template.
+    * \param[in] modality_linearized_maps the linearized maps of all modalities and quantization bins.
+    * \param[in] scale the scale applied to the feature positions.
+    * \param[in] kernels the kernels used for accumulating the responses.
+    * \param[in] mem_size the number of elements of a linearized map.
+    * \param[out] score_sums the resulting score sums (16-byte aligned, mem_size elements).
+    * \param[in] tmp_score_sums buffer for the partial sums (16-byte aligned, mem_size elements).
+    * \return the maximum score the template can reach.
+    */
+  template <typename FeatureT> int
+  computeScoreSums (const FeatureT * features,
+                    const size_t nr_features,
+                    std::vector<std::vector<pcl::LinearizedMaps> > & modality_linearized_maps,
+                    const float scale,
+                    const pcl::LINEMODScoreKernels & kernels,
+                    const size_t mem_size,
+                    unsigned short * score_sums,
+                    unsigned char * tmp_score_sums)
+  {
+    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
+    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
+
+    int max_score = 0;
+    size_t nr_pending_responses = 0;
+    for (size_t feature_index = 0; feature_index < nr_features; ++feature_index)
+    {
+      const FeatureT & feature = features[feature_index];
+      const size_t col_index = static_cast<size_t> (static_cast<float> (feature.x) * scale);
+      const size_t row_index = static_cast<size_t> (static_cast<float> (feature.y) * scale);
+
+      for (size_t bin_index = 0; bin_index < 8; ++bin_index)
+      {
+        if ((feature.quantized_value & (0x1<<bin_index)) != 0)
+        {
+          max_score += 4;
+
+          const unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (col_index, row_index);
+          kernels.addResponse (score_sums, tmp_score_sums, data, mem_size, nr_pending_responses);
+        }
+      }
+    }
+
+    if (nr_pending_responses > 0)
+      kernels.flush (score_sums, tmp_score_sums, mem_size);
+
+    return (max_score);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  /** \brief Sums up the responses of the template with the specified ID, which is either stored in the
+    * template bank (used in place) or in the template storage.
+    */
+  int
+  computeScoreSums (const pcl::LINEMODTemplateBank::ConstPtr & template_bank,
+                    const std::vector<pcl::SparseQuantizedMultiModTemplate> & templates,
+                    const size_t template_id,
+                    std::vector<std::vector<pcl::LinearizedMaps> > & modality_linearized_maps,
+                    const float scale,
+                    const pcl::LINEMODScoreKernels & kernels,
+                    const size_t mem_size,
+                    unsigned short * score_sums,
+                    unsigned char * tmp_score_sums)
+  {
+    const size_t nr_bank_templates = template_bank ? template_bank->getNumOfTemplates () : 0;
+    if (template_id < nr_bank_templates)
+      return (computeScoreSums (template_bank->getFeatures (template_id), template_bank->getNumOfFeatures (template_id),
+                                modality_linearized_maps, scale, kernels, mem_size, score_sums, tmp_score_sums));
+
+    const std::vector<pcl::QuantizedMultiModFeature> & features = templates[template_id - nr_bank_templates].features;
+    return (computeScoreSums (features.empty () ? NULL : &features[0], features.size (),
+                              modality_linearized_maps, scale, kernels, mem_size, score_sums, tmp_score_sums));
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 pcl::LINEMOD::LINEMOD () 
   : template_threshold_ (0.75f)
   , use_non_max_suppression_ (false)
   , average_detections_ (false)
   , templates_ ()
+  , template_bank_ ()
+  , nr_threads_ (0)
 {
 }
 
@@ -107,7 +189,7 @@ pcl::LINEMOD::createAndAddTemplate (const std::vector<pcl::QuantizableModality*>
   // add template to template storage
   templates_.push_back(linemod_template);
 
-  return static_cast<int> (templates_.size () - 1);
+  return static_cast<int> (getNumOfTemplates () - 1);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -117,7 +199,7 @@ pcl::LINEMOD::addTemplate (const SparseQuantizedMultiModTemplate & linemod_templ
   // add template to template storage
   templates_.push_back(linemod_template);
 
-  return static_cast<int> (templates_.size () - 1);
+  return static_cast<int> (getNumOfTemplates () - 1);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -213,148 +295,58 @@ pcl::LINEMOD::matchTemplates (const std::vector<QuantizableModality*> & modaliti
   // compute scores for templates
   const size_t width = modality_energy_maps[0].getWidth ();
   const size_t height = modality_energy_maps[0].getHeight ();
-  for (size_t template_index = 0; template_index < templates_.size (); ++template_index)
-  {
-    const size_t mem_width = width / step_size;
-    const size_t mem_height = height / step_size;
-    const size_t mem_size = mem_width * mem_height;
+  const size_t mem_width = width / step_size;
+  const size_t mem_height = height / step_size;
+  const size_t mem_size = mem_width * mem_height;
 
-#ifdef __SSE2__
-    unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
-    unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
-    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
-    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
+  const LINEMODScoreKernels & kernels = LINEMODScoreKernels::getDefault ();
 
-    //__m128i * score_sums_m128i = reinterpret_cast<__m128i*> (score_sums);
-    __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
+  // every template yields exactly one match, so the output can be allocated upfront
+  const size_t first_detection_index = detections.size ();
+  detections.resize (first_detection_index + getNumOfTemplates ());
 
-    const size_t mem_size_16 = mem_size / 16;
-    //const size_t mem_size_mod_16 = mem_size & 15;
-    const size_t mem_size_mod_16_base = mem_size_16 * 16;
+  const int nr_templates = static_cast<int> (getNumOfTemplates ());
+#ifdef _OPENMP
+  const int nr_threads = nr_threads_ ? static_cast<int> (nr_threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
+#endif
+  {
+    unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
+    unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
 
-    size_t max_score = 0;
-    size_t copy_back_counter = 0;
-    for (size_t feature_index = 0; feature_index < templates_[template_index].features.size (); ++feature_index)
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int template_index = 0; template_index < nr_templates; ++template_index)
     {
-      const QuantizedMultiModFeature & feature = templates_[template_index].features[feature_index];
-
-      for (size_t bin_index = 0; bin_index < 8; ++bin_index)
-      {
-        if ((feature.quantized_value & (0x1<<bin_index)) != 0)
-        {
-          max_score += 4;
-
-          unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          __m128i * data_m128i = reinterpret_cast<__m128i*> (data);
-
-          for (size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
-          {
-            __m128i aligned_data_m128i = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE2
-            //__m128i aligned_data_m128i = _mm_lddqu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE3
-            tmp_score_sums_m128i[mem_index] = _mm_add_epi8 (tmp_score_sums_m128i[mem_index], aligned_data_m128i);
-          }
-          for (size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-          {
-            tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
-          }
-        }
-      }
-
-      ++copy_back_counter;
-
-      //if ((feature_index & 7) == 7)
-      //if ((feature_index & 63) == 63)
-      if (copy_back_counter > 63) // only valid if each feature has only one bit set..
-      {
-        copy_back_counter = 0;
-
-        for (size_t mem_index = 0; mem_index < mem_size; mem_index += 16)
-        {
-          score_sums[mem_index+0]  = static_cast<unsigned short> (score_sums[mem_index+0]  + tmp_score_sums[mem_index+0]);
-          score_sums[mem_index+1]  = static_cast<unsigned short> (score_sums[mem_index+1]  + tmp_score_sums[mem_index+1]);
-          score_sums[mem_index+2]  = static_cast<unsigned short> (score_sums[mem_index+2]  + tmp_score_sums[mem_index+2]);
-          score_sums[mem_index+3]  = static_cast<unsigned short> (score_sums[mem_index+3]  + tmp_score_sums[mem_index+3]);
-          score_sums[mem_index+4]  = static_cast<unsigned short> (score_sums[mem_index+4]  + tmp_score_sums[mem_index+4]);
-          score_sums[mem_index+5]  = static_cast<unsigned short> (score_sums[mem_index+5]  + tmp_score_sums[mem_index+5]);
-          score_sums[mem_index+6]  = static_cast<unsigned short> (score_sums[mem_index+6]  + tmp_score_sums[mem_index+6]);
-          score_sums[mem_index+7]  = static_cast<unsigned short> (score_sums[mem_index+7]  + tmp_score_sums[mem_index+7]);
-          score_sums[mem_index+8]  = static_cast<unsigned short> (score_sums[mem_index+8]  + tmp_score_sums[mem_index+8]);
-          score_sums[mem_index+9]  = static_cast<unsigned short> (score_sums[mem_index+9]  + tmp_score_sums[mem_index+9]);
-          score_sums[mem_index+10] = static_cast<unsigned short> (score_sums[mem_index+10] + tmp_score_sums[mem_index+10]);
-          score_sums[mem_index+11] = static_cast<unsigned short> (score_sums[mem_index+11] + tmp_score_sums[mem_index+11]);
-          score_sums[mem_index+12] = static_cast<unsigned short> (score_sums[mem_index+12] + tmp_score_sums[mem_index+12]);
-          score_sums[mem_index+13] = static_cast<unsigned short> (score_sums[mem_index+13] + tmp_score_sums[mem_index+13]);
-          score_sums[mem_index+14] = static_cast<unsigned short> (score_sums[mem_index+14] + tmp_score_sums[mem_index+14]);
-          score_sums[mem_index+15] = static_cast<unsigned short> (score_sums[mem_index+15] + tmp_score_sums[mem_index+15]);
-        }
-        for (size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-        {
-          score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-        }
+      const int max_score = computeScoreSums (template_bank_, templates_, template_index, modality_linearized_maps, 1.0f,
+                                              kernels, mem_size, score_sums, tmp_score_sums);
 
-        memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-      }
-    }
-    {
+      const float inv_max_score = 1.0f / float (max_score);
+    
+      size_t max_value = 0;
+      size_t max_index = 0;
       for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
       {
-        score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-      }
-        
-      memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-    }
-#else
-    unsigned short * score_sums = new unsigned short[mem_size];
-    //unsigned char * score_sums = new unsigned char[mem_size];
-    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
-
-    size_t max_score = 0;
-    for (size_t feature_index = 0; feature_index < templates_[template_index].features.size (); ++feature_index)
-    {
-      const QuantizedMultiModFeature & feature = templates_[template_index].features[feature_index];
-
-      //feature.modality_index;
-      for (size_t bin_index = 0; bin_index < 8; ++bin_index)
-      {
-        if ((feature.quantized_value & (0x1<<bin_index)) != 0)
+        if (score_sums[mem_index] > max_value) 
         {
-          max_score += 4;
-
-          unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-          {
-            score_sums[mem_index] += data[mem_index];
-          }
+          max_value = score_sums[mem_index];
+          max_index = mem_index;
         }
       }
-    }
-#endif
-
-    const float inv_max_score = 1.0f / float (max_score);
-    
-    size_t max_value = 0;
-    size_t max_index = 0;
-    for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-    {
-      if (score_sums[mem_index] > max_value) 
-      {
-        max_value = score_sums[mem_index];
-        max_index = mem_index;
-      }
-    }
-
-    const size_t max_col_index = (max_index % mem_width) * step_size;
-    const size_t max_row_index = (max_index / mem_width) * step_size;
 
-    LINEMODDetection detection;
-    detection.x = static_cast<int> (max_col_index);
-    detection.y = static_cast<int> (max_row_index);
-    detection.template_id = static_cast<int> (template_index);
-    detection.score = static_cast<float> (max_value) * inv_max_score;
+      const size_t max_col_index = (max_index % mem_width) * step_size;
+      const size_t max_row_index = (max_index / mem_width) * step_size;
 
-    detections.push_back (detection);
+      LINEMODDetection & detection = detections[first_detection_index + template_index];
+      detection.x = static_cast<int> (max_col_index);
+      detection.y = static_cast<int> (max_row_index);
+      detection.template_id = static_cast<int> (template_index);
+      detection.score = static_cast<float> (max_value) * inv_max_score;
+    }
 
-    delete[] score_sums;
+    aligned_free (score_sums);
+    aligned_free (tmp_score_sums);
   }
 
   // release data
@@ -529,281 +521,202 @@ pcl::LINEMOD::detectTemplates (const std::vector<QuantizableModality*> & modalit
   // compute scores for templates
   const size_t width = modality_energy_maps[0].getWidth ();
   const size_t height = modality_energy_maps[0].getHeight ();
-  for (size_t template_index = 0; template_index < templates_.size (); ++template_index)
-  {
-    const size_t mem_width = width / step_size;
-    const size_t mem_height = height / step_size;
-    const size_t mem_size = mem_width * mem_height;
-
-#ifdef __SSE2__
-    unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
-    unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
-    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
-    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-
-    //__m128i * score_sums_m128i = reinterpret_cast<__m128i*> (score_sums);
-    __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
-
-    const size_t mem_size_16 = mem_size / 16;
-    //const size_t mem_size_mod_16 = mem_size & 15;
-    const size_t mem_size_mod_16_base = mem_size_16 * 16;
-
-    int max_score = 0;
-    size_t copy_back_counter = 0;
-    for (size_t feature_index = 0; feature_index < templates_[template_index].features.size (); ++feature_index)
-    {
-      const QuantizedMultiModFeature & feature = templates_[template_index].features[feature_index];
-
-      for (size_t bin_index = 0; bin_index < 8; ++bin_index)
-      {
-        if ((feature.quantized_value & (0x1<<bin_index)) != 0)
-        {
-          max_score += 4;
-
-          unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          __m128i * data_m128i = reinterpret_cast<__m128i*> (data);
-
-          for (size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
-          {
-            __m128i aligned_data_m128i = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE2
-            //__m128i aligned_data_m128i = _mm_lddqu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE3
-            tmp_score_sums_m128i[mem_index] = _mm_add_epi8 (tmp_score_sums_m128i[mem_index], aligned_data_m128i);
-          }
-          for (size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-          {
-            tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
-          }
-        }
-      }
+  const size_t mem_width = width / step_size;
+  const size_t mem_height = height / step_size;
+  const size_t mem_size = mem_width * mem_height;
 
-      ++copy_back_counter;
+  const LINEMODScoreKernels & kernels = LINEMODScoreKernels::getDefault ();
 
-      //if ((feature_index & 7) == 7)
-      //if ((feature_index & 63) == 63)
-      if (copy_back_counter > 63) // only valid if each feature has only one bit set..
-      {
-        copy_back_counter = 0;
-
-        for (size_t mem_index = 0; mem_index < mem_size; mem_index += 16)
-        {
-          score_sums[mem_index+0]  = static_cast<unsigned short> (score_sums[mem_index+0]  + tmp_score_sums[mem_index+0]);
-          score_sums[mem_index+1]  = static_cast<unsigned short> (score_sums[mem_index+1]  + tmp_score_sums[mem_index+1]);
-          score_sums[mem_index+2]  = static_cast<unsigned short> (score_sums[mem_index+2]  + tmp_score_sums[mem_index+2]);
-          score_sums[mem_index+3]  = static_cast<unsigned short> (score_sums[mem_index+3]  + tmp_score_sums[mem_index+3]);
-          score_sums[mem_index+4]  = static_cast<unsigned short> (score_sums[mem_index+4]  + tmp_score_sums[mem_index+4]);
-          score_sums[mem_index+5]  = static_cast<unsigned short> (score_sums[mem_index+5]  + tmp_score_sums[mem_index+5]);
-          score_sums[mem_index+6]  = static_cast<unsigned short> (score_sums[mem_index+6]  + tmp_score_sums[mem_index+6]);
-          score_sums[mem_index+7]  = static_cast<unsigned short> (score_sums[mem_index+7]  + tmp_score_sums[mem_index+7]);
-          score_sums[mem_index+8]  = static_cast<unsigned short> (score_sums[mem_index+8]  + tmp_score_sums[mem_index+8]);
-          score_sums[mem_index+9]  = static_cast<unsigned short> (score_sums[mem_index+9]  + tmp_score_sums[mem_index+9]);
-          score_sums[mem_index+10] = static_cast<unsigned short> (score_sums[mem_index+10] + tmp_score_sums[mem_index+10]);
-          score_sums[mem_index+11] = static_cast<unsigned short> (score_sums[mem_index+11] + tmp_score_sums[mem_index+11]);
-          score_sums[mem_index+12] = static_cast<unsigned short> (score_sums[mem_index+12] + tmp_score_sums[mem_index+12]);
-          score_sums[mem_index+13] = static_cast<unsigned short> (score_sums[mem_index+13] + tmp_score_sums[mem_index+13]);
-          score_sums[mem_index+14] = static_cast<unsigned short> (score_sums[mem_index+14] + tmp_score_sums[mem_index+14]);
-          score_sums[mem_index+15] = static_cast<unsigned short> (score_sums[mem_index+15] + tmp_score_sums[mem_index+15]);
-        }
-        for (size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-        {
-          score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-        }
-
-        memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-      }
-    }
-    {
-      for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-      {
-        score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-      }
-        
-      memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-    }
-#else
-    unsigned short * score_sums = new unsigned short[mem_size];
-    //unsigned char * score_sums = new unsigned char[mem_size];
-    memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
+  // detections are gathered per template so that their order does not depend on the scheduling
+  const int nr_templates = static_cast<int> (getNumOfTemplates ());
+  std::vector<std::vector<LINEMODDetection> > template_detections (getNumOfTemplates ());
 
+#ifdef _OPENMP
+  const int nr_threads = nr_threads_ ? static_cast<int> (nr_threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
+#endif
+  {
+    unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
+    unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
     unsigned short * score_sums_1 = new unsigned short[mem_size];
     unsigned short * score_sums_2 = new unsigned short[mem_size];
     unsigned short * score_sums_3 = new unsigned short[mem_size];
-    memset (score_sums_1, 0, mem_size*sizeof (score_sums_1[0]));
-    memset (score_sums_2, 0, mem_size*sizeof (score_sums_2[0]));
-    memset (score_sums_3, 0, mem_size*sizeof (score_sums_3[0]));
 #endif
 
-    int max_score = 0;
-    for (size_t feature_index = 0; feature_index < templates_[template_index].features.size (); ++feature_index)
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int template_index = 0; template_index < nr_templates; ++template_index)
     {
-      const QuantizedMultiModFeature & feature = templates_[template_index].features[feature_index];
+#ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
+      memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
+      memset (score_sums_1, 0, mem_size*sizeof (score_sums_1[0]));
+      memset (score_sums_2, 0, mem_size*sizeof (score_sums_2[0]));
+      memset (score_sums_3, 0, mem_size*sizeof (score_sums_3[0]));
 
-      //feature.modality_index;
-      for (size_t bin_index = 0; bin_index < 8; ++bin_index)
+      SparseQuantizedMultiModTemplate linemod_template;
+      copyTemplate (template_index, linemod_template);
+
+      int max_score = 0;
+      for (size_t feature_index = 0; feature_index < linemod_template.features.size (); ++feature_index)
       {
-        if ((feature.quantized_value & (0x1<<bin_index)) != 0)
-        {
-#ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
-          ++max_score;
+        const QuantizedMultiModFeature & feature = linemod_template.features[feature_index];
 
-          unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          unsigned char * data_1 = modality_linearized_maps_1[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          unsigned char * data_2 = modality_linearized_maps_2[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          unsigned char * data_3 = modality_linearized_maps_3[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
+        for (size_t bin_index = 0; bin_index < 8; ++bin_index)
+        {
+          if ((feature.quantized_value & (0x1<<bin_index)) != 0)
           {
-            score_sums[mem_index] += data[mem_index];
-            score_sums_1[mem_index] += data_1[mem_index];
-            score_sums_2[mem_index] += data_2[mem_index];
-            score_sums_3[mem_index] += data_3[mem_index];
-          }
-#else
-          max_score += 4;
+            ++max_score;
 
-          unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
-          for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-          {
-            score_sums[mem_index] += data[mem_index];
+            unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
+            unsigned char * data_1 = modality_linearized_maps_1[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
+            unsigned char * data_2 = modality_linearized_maps_2[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
+            unsigned char * data_3 = modality_linearized_maps_3[feature.modality_index][bin_index].getOffsetMap (feature.x, feature.y);
+            for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
+            {
+              score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + data[mem_index]);
+              score_sums_1[mem_index] = static_cast<unsigned short> (score_sums_1[mem_index] + data_1[mem_index]);
+              score_sums_2[mem_index] = static_cast<unsigned short> (score_sums_2[mem_index] + data_2[mem_index]);
+              score_sums_3[mem_index] = static_cast<unsigned short> (score_sums_3[mem_index] + data_3[mem_index]);
+            }
           }
-#endif
         }
       }
-    }
+#else
+      const int max_score = computeScoreSums (template_bank_, templates_, template_index, modality_linearized_maps, 1.0f,
+                                              kernels, mem_size, score_sums, tmp_score_sums);
 #endif
 
-    const float inv_max_score = 1.0f / float (max_score);
+      const float inv_max_score = 1.0f / float (max_score);
 
-    // we compute a new threshold based on the threshold supplied by the user;
-    // this is due to the use of the cosine approx. in the response computation;
+      // we compute a new threshold based on the threshold supplied by the user;
+      // this is due to the use of the cosine approx. in the response computation;
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
-    const float raw_threshold = (4.0f * float (max_score) / 2.0f + template_threshold_ * (4.0f * float (max_score) / 2.0f));
+      const float raw_threshold = (4.0f * float (max_score) / 2.0f + template_threshold_ * (4.0f * float (max_score) / 2.0f));
 #else
-    const float raw_threshold = (float (max_score) / 2.0f + template_threshold_ * (float (max_score) / 2.0f));
+      const float raw_threshold = (float (max_score) / 2.0f + template_threshold_ * (float (max_score) / 2.0f));
 #endif
 
-    //int max_value = 0;
-    //size_t max_index = 0;
-    for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-    {
-      //const float score = score_sums[mem_index] * inv_max_score;
+      //int max_value = 0;
+      //size_t max_index = 0;
+      for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
+      {
+        //const float score = score_sums[mem_index] * inv_max_score;
 
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
-      const float raw_score = score_sums[mem_index] 
-        + score_sums_1[mem_index]
-        + score_sums_2[mem_index]
-        + score_sums_3[mem_index];
+        const float raw_score = score_sums[mem_index] 
+          + score_sums_1[mem_index]
+          + score_sums_2[mem_index]
+          + score_sums_3[mem_index];
 
-      const float score = 2.0f * static_cast<float> (raw_score) * 0.25f * inv_max_score - 1.0f;
+        const float score = 2.0f * static_cast<float> (raw_score) * 0.25f * inv_max_score - 1.0f;
 #else
-      const float raw_score = score_sums[mem_index];
+        const float raw_score = score_sums[mem_index];
 
-      const float score = 2.0f * static_cast<float> (raw_score) * inv_max_score - 1.0f;
+        const float score = 2.0f * static_cast<float> (raw_score) * inv_max_score - 1.0f;
 #endif
 
 
-      //if (score > template_threshold_) 
-      if (raw_score > raw_threshold) /// \todo Ask Stefan why this line was used instead of the one above
-      {
-        const size_t mem_col_index = (mem_index % mem_width);
-        const size_t mem_row_index = (mem_index / mem_width);
-
-        if (use_non_max_suppression_)
+        //if (score > template_threshold_) 
+        if (raw_score > raw_threshold) /// \todo Ask Stefan why this line was used instead of the one above
         {
-          bool is_local_max = true;
-          for (size_t sup_row_index = mem_row_index-1; sup_row_index <= mem_row_index+1 && is_local_max; ++sup_row_index)
-          {
-            if (sup_row_index >= mem_height)
-              continue;
+          const size_t mem_col_index = (mem_index % mem_width);
+          const size_t mem_row_index = (mem_index / mem_width);
 
-            for (size_t sup_col_index = mem_col_index-1; sup_col_index <= mem_col_index+1; ++sup_col_index)
+          if (use_non_max_suppression_)
+          {
+            bool is_local_max = true;
+            for (size_t sup_row_index = mem_row_index-1; sup_row_index <= mem_row_index+1 && is_local_max; ++sup_row_index)
             {
-              if (sup_col_index >= mem_width)
+              if (sup_row_index >= mem_height)
                 continue;
 
-              if (score_sums[mem_index] < score_sums[sup_row_index*mem_width + sup_col_index])
+              for (size_t sup_col_index = mem_col_index-1; sup_col_index <= mem_col_index+1; ++sup_col_index)
               {
-                is_local_max = false;
-                break;
-              }
-            } 
-          }
+                if (sup_col_index >= mem_width)
+                  continue;
 
-          if (!is_local_max)
-            continue;
-        }
+                if (score_sums[mem_index] < score_sums[sup_row_index*mem_width + sup_col_index])
+                {
+                  is_local_max = false;
+                  break;
+                }
+              } 
+            }
 
-        LINEMODDetection detection;
+            if (!is_local_max)
+              continue;
+          }
 
-        if (average_detections_)
-        {
-          size_t average_col = 0;
-          size_t average_row = 0;
-          size_t sum = 0;
+          LINEMODDetection detection;
 
-          for (size_t sup_row_index = mem_row_index-1; sup_row_index <= mem_row_index+1; ++sup_row_index)
+          if (average_detections_)
           {
-            if (sup_row_index >= mem_height)
-              continue;
+            size_t average_col = 0;
+            size_t average_row = 0;
+            size_t sum = 0;
 
-            for (size_t sup_col_index = mem_col_index-1; sup_col_index <= mem_col_index+1; ++sup_col_index)
+            for (size_t sup_row_index = mem_row_index-1; sup_row_index <= mem_row_index+1; ++sup_row_index)
             {
-              if (sup_col_index >= mem_width)
+              if (sup_row_index >= mem_height)
                 continue;
 
-              const size_t weight = static_cast<size_t> (score_sums[sup_row_index*mem_width + sup_col_index]);
-              average_col += sup_col_index * weight;
-              average_row += sup_row_index * weight;
-              sum += weight;
-            } 
-          }
+              for (size_t sup_col_index = mem_col_index-1; sup_col_index <= mem_col_index+1; ++sup_col_index)
+              {
+                if (sup_col_index >= mem_width)
+                  continue;
 
-          average_col *= step_size;
-          average_row *= step_size;
+                const size_t weight = static_cast<size_t> (score_sums[sup_row_index*mem_width + sup_col_index]);
+                average_col += sup_col_index * weight;
+                average_row += sup_row_index * weight;
+                sum += weight;
+              } 
+            }
 
-          average_col /= sum;
-          average_row /= sum;
+            average_col *= step_size;
+            average_row *= step_size;
 
-          //std::cerr << mem_col_index << ", " << mem_row_index << " - " << average_col << ", " << average_row << std::endl;
-          std::cerr << mem_col_index*step_size << ", " << mem_row_index*step_size << " - " << average_col << ", " << average_row << std::endl;
+            average_col /= sum;
+            average_row /= sum;
 
-          const size_t detection_col_index = average_col;// * step_size;
-          const size_t detection_row_index = average_row;// * step_size;
+            //std::cerr << mem_col_index << ", " << mem_row_index << " - " << average_col << ", " << average_row << std::endl;
+            std::cerr << mem_col_index*step_size << ", " << mem_row_index*step_size << " - " << average_col << ", " << average_row << std::endl;
 
-          detection.x = static_cast<int> (detection_col_index);
-          detection.y = static_cast<int> (detection_row_index);
-        }
-        else
-        {
-          const size_t detection_col_index = mem_col_index * step_size;
-          const size_t detection_row_index = mem_row_index * step_size;
+            const size_t detection_col_index = average_col;// * step_size;
+            const size_t detection_row_index = average_row;// * step_size;
 
-          detection.x = static_cast<int> (detection_col_index);
-          detection.y = static_cast<int> (detection_row_index);
-        }
+            detection.x = static_cast<int> (detection_col_index);
+            detection.y = static_cast<int> (detection_row_index);
+          }
+          else
+          {
+            const size_t detection_col_index = mem_col_index * step_size;
+            const size_t detection_row_index = mem_row_index * step_size;
 
-        detection.template_id = static_cast<int> (template_index);
-        detection.score = score;
+            detection.x = static_cast<int> (detection_col_index);
+            detection.y = static_cast<int> (detection_row_index);
+          }
+
+          detection.template_id = static_cast<int> (template_index);
+          detection.score = score;
 
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
-        std::cerr << "score: " << static_cast<float> (raw_score) * inv_max_score * 0.25f << ", " << (2.0f * static_cast<float> (raw_score) * inv_max_score - 1.0f) << std::endl;
-        std::cerr << "score0: " << static_cast<float> (score_sums[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums[mem_index]) * inv_max_score - 1.0f) << std::endl;
-        std::cerr << "score1: " << static_cast<float> (score_sums_1[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums_1[mem_index]) * inv_max_score - 1.0f) << std::endl;
-        std::cerr << "score2: " << static_cast<float> (score_sums_2[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums_2[mem_index]) * inv_max_score - 1.0f) << std::endl;
-        std::cerr << "score3: " << static_cast<float> (score_sums_3[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums_3[mem_index]) * inv_max_score - 1.0f) << std::endl;
+          std::cerr << "score: " << static_cast<float> (raw_score) * inv_max_score * 0.25f << ", " << (2.0f * static_cast<float> (raw_score) * inv_max_score - 1.0f) << std::endl;
+          std::cerr << "score0: " << static_cast<float> (score_sums[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums[mem_index]) * inv_max_score - 1.0f) << std::endl;
+          std::cerr << "score1: " << static_cast<float> (score_sums_1[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums_1[mem_index]) * inv_max_score - 1.0f) << std::endl;
+          std::cerr << "score2: " << static_cast<float> (score_sums_2[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums_2[mem_index]) * inv_max_score - 1.0f) << std::endl;
+          std::cerr << "score3: " << static_cast<float> (score_sums_3[mem_index]) * inv_max_score << ", " << (2.0f * static_cast<float> (score_sums_3[mem_index]) * inv_max_score - 1.0f) << std::endl;
 #endif
 
 
-        detections.push_back (detection);
+          template_detections[template_index].push_back (detection);
+        }
       }
     }
 
-#ifdef __SSE2__
     aligned_free (score_sums);
     aligned_free (tmp_score_sums);
-#else
-    delete[] score_sums;
-#endif
-
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
     delete[] score_sums_1;
     delete[] score_sums_2;
@@ -811,6 +724,9 @@ pcl::LINEMOD::detectTemplates (const std::vector<QuantizableModality*> & modalit
 #endif
   }
 
+  for (size_t template_index = 0; template_index < template_detections.size (); ++template_index)
+    detections.insert (detections.end (), template_detections[template_index].begin (), template_detections[template_index].end ());
+
   // release data
   for (size_t modality_index = 0; modality_index < modality_linearized_maps.size (); ++modality_index)
   {
@@ -1000,149 +916,80 @@ pcl::LINEMOD::detectTemplatesSemiScaleInvariant (
   // compute scores for templates
   const size_t width = modality_energy_maps[0].getWidth ();
   const size_t height = modality_energy_maps[0].getHeight ();
-  for (size_t template_index = 0; template_index < templates_.size (); ++template_index)
-  {
-    const size_t mem_width = width / step_size;
-    const size_t mem_height = height / step_size;
-    const size_t mem_size = mem_width * mem_height;
-
-    for (float scale = min_scale; scale <= max_scale; scale *= scale_multiplier)
-    {
-#ifdef __SSE2__
-      unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
-      unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
-      memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
-      memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-
-      //__m128i * score_sums_m128i = reinterpret_cast<__m128i*> (score_sums);
-      __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
-
-      const size_t mem_size_16 = mem_size / 16;
-      //const size_t mem_size_mod_16 = mem_size & 15;
-      const size_t mem_size_mod_16_base = mem_size_16 * 16;
-
-      int max_score = 0;
-      size_t copy_back_counter = 0;
-      for (size_t feature_index = 0; feature_index < templates_[template_index].features.size (); ++feature_index)
-      {
-        const QuantizedMultiModFeature & feature = templates_[template_index].features[feature_index];
-
-        for (size_t bin_index = 0; bin_index < 8; ++bin_index)
-        {
-          if ((feature.quantized_value & (0x1<<bin_index)) != 0)
-          {
-            max_score += 4;
+  const size_t mem_width = width / step_size;
+  const size_t mem_height = height / step_size;
+  const size_t mem_size = mem_width * mem_height;
 
-            unsigned char *data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (
-                size_t (float (feature.x) * scale), size_t (float (feature.y) * scale));
-            __m128i * data_m128i = reinterpret_cast<__m128i*> (data);
+  const LINEMODScoreKernels & kernels = LINEMODScoreKernels::getDefault ();
 
-            for (size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
-            {
-              __m128i aligned_data_m128i = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE2
-              //__m128i aligned_data_m128i = _mm_lddqu_si128 (reinterpret_cast<const __m128i*> (data_m128i + mem_index)); // SSE3
-              tmp_score_sums_m128i[mem_index] = _mm_add_epi8 (tmp_score_sums_m128i[mem_index], aligned_data_m128i);
-            }
-            for (size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-            {
-              tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
-            }
-          }
-        }
-
-        ++copy_back_counter;
+  std::vector<float> scales;
+  for (float scale = min_scale; scale <= max_scale; scale *= scale_multiplier)
+    scales.push_back (scale);
 
-        //if ((feature_index & 7) == 7)
-        //if ((feature_index & 63) == 63)
-        if (copy_back_counter > 63) // only valid if each feature has only one bit set..
-        {
-          copy_back_counter = 0;
+  // every (template, scale) pair is scored independently; detections are gathered per pair
+  // so that their order does not depend on the scheduling
+  const int nr_scales = static_cast<int> (scales.size ());
+  const int nr_jobs = static_cast<int> (getNumOfTemplates ()) * nr_scales;
+  std::vector<std::vector<LINEMODDetection> > scale_detections (nr_jobs);
 
-          for (size_t mem_index = 0; mem_index < mem_size; mem_index += 16)
-          {
-            score_sums[mem_index+0]  = static_cast<unsigned short> (score_sums[mem_index+0]  + tmp_score_sums[mem_index+0]);
-            score_sums[mem_index+1]  = static_cast<unsigned short> (score_sums[mem_index+1]  + tmp_score_sums[mem_index+1]);
-            score_sums[mem_index+2]  = static_cast<unsigned short> (score_sums[mem_index+2]  + tmp_score_sums[mem_index+2]);
-            score_sums[mem_index+3]  = static_cast<unsigned short> (score_sums[mem_index+3]  + tmp_score_sums[mem_index+3]);
-            score_sums[mem_index+4]  = static_cast<unsigned short> (score_sums[mem_index+4]  + tmp_score_sums[mem_index+4]);
-            score_sums[mem_index+5]  = static_cast<unsigned short> (score_sums[mem_index+5]  + tmp_score_sums[mem_index+5]);
-            score_sums[mem_index+6]  = static_cast<unsigned short> (score_sums[mem_index+6]  + tmp_score_sums[mem_index+6]);
-            score_sums[mem_index+7]  = static_cast<unsigned short> (score_sums[mem_index+7]  + tmp_score_sums[mem_index+7]);
-            score_sums[mem_index+8]  = static_cast<unsigned short> (score_sums[mem_index+8]  + tmp_score_sums[mem_index+8]);
-            score_sums[mem_index+9]  = static_cast<unsigned short> (score_sums[mem_index+9]  + tmp_score_sums[mem_index+9]);
-            score_sums[mem_index+10] = static_cast<unsigned short> (score_sums[mem_index+10] + tmp_score_sums[mem_index+10]);
-            score_sums[mem_index+11] = static_cast<unsigned short> (score_sums[mem_index+11] + tmp_score_sums[mem_index+11]);
-            score_sums[mem_index+12] = static_cast<unsigned short> (score_sums[mem_index+12] + tmp_score_sums[mem_index+12]);
-            score_sums[mem_index+13] = static_cast<unsigned short> (score_sums[mem_index+13] + tmp_score_sums[mem_index+13]);
-            score_sums[mem_index+14] = static_cast<unsigned short> (score_sums[mem_index+14] + tmp_score_sums[mem_index+14]);
-            score_sums[mem_index+15] = static_cast<unsigned short> (score_sums[mem_index+15] + tmp_score_sums[mem_index+15]);
-          }
-          for (size_t mem_index = mem_size_mod_16_base; mem_index < mem_size; ++mem_index)
-          {
-            score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-          }
+#ifdef _OPENMP
+  const int nr_threads = nr_threads_ ? static_cast<int> (nr_threads_) : omp_get_max_threads ();
+#pragma omp parallel num_threads(nr_threads)
+#endif
+  {
+    unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size*sizeof(unsigned short)));
+    unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size*sizeof(unsigned char)));
+#ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
+    unsigned short * score_sums_1 = new unsigned short[mem_size];
+    unsigned short * score_sums_2 = new unsigned short[mem_size];
+    unsigned short * score_sums_3 = new unsigned short[mem_size];
+#endif
 
-          memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-        }
-      }
-      {
-        for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-        {
-          score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
-        }
-        
-        memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
-      }
-#else
-      unsigned short * score_sums = new unsigned short[mem_size];
-      //unsigned char * score_sums = new unsigned char[mem_size];
-      memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+    for (int job_index = 0; job_index < nr_jobs; ++job_index)
+    {
+      const int template_index = job_index / nr_scales;
+      const float scale = scales[job_index % nr_scales];
 
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
-      unsigned short * score_sums_1 = new unsigned short[mem_size];
-      unsigned short * score_sums_2 = new unsigned short[mem_size];
-      unsigned short * score_sums_3 = new unsigned short[mem_size];
+      memset (score_sums, 0, mem_size*sizeof (score_sums[0]));
       memset (score_sums_1, 0, mem_size*sizeof (score_sums_1[0]));
       memset (score_sums_2, 0, mem_size*sizeof (score_sums_2[0]));
       memset (score_sums_3, 0, mem_size*sizeof (score_sums_3[0]));
-#endif
+
+      SparseQuantizedMultiModTemplate linemod_template;
+      copyTemplate (template_index, linemod_template);
 
       int max_score = 0;
-      for (size_t feature_index = 0; feature_index < templates_[template_index].features.size (); ++feature_index)
+      for (size_t feature_index = 0; feature_index < linemod_template.features.size (); ++feature_index)
       {
-        const QuantizedMultiModFeature & feature = templates_[template_index].features[feature_index];
+        const QuantizedMultiModFeature & feature = linemod_template.features[feature_index];
 
-        //feature.modality_index;
         for (size_t bin_index = 0; bin_index < 8; ++bin_index)
         {
           if ((feature.quantized_value & (0x1<<bin_index)) != 0)
           {
-#ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
             ++max_score;
 
-            unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (feature.x*scale, feature.y*scale);
-            unsigned char * data_1 = modality_linearized_maps_1[feature.modality_index][bin_index].getOffsetMap (feature.x*scale, feature.y*scale);
-            unsigned char * data_2 = modality_linearized_maps_2[feature.modality_index][bin_index].getOffsetMap (feature.x*scale, feature.y*scale);
-            unsigned char * data_3 = modality_linearized_maps_3[feature.modality_index][bin_index].getOffsetMap (feature.x*scale, feature.y*scale);
+            unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (static_cast<size_t> (float (feature.x) * scale), static_cast<size_t> (float (feature.y) * scale));
+            unsigned char * data_1 = modality_linearized_maps_1[feature.modality_index][bin_index].getOffsetMap (static_cast<size_t> (float (feature.x) * scale), static_cast<size_t> (float (feature.y) * scale));
+            unsigned char * data_2 = modality_linearized_maps_2[feature.modality_index][bin_index].getOffsetMap (static_cast<size_t> (float (feature.x) * scale), static_cast<size_t> (float (feature.y) * scale));
+            unsigned char * data_3 = modality_linearized_maps_3[feature.modality_index][bin_index].getOffsetMap (static_cast<size_t> (float (feature.x) * scale), static_cast<size_t> (float (feature.y) * scale));
             for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
             {
-              score_sums[mem_index] += data[mem_index];
-              score_sums_1[mem_index] += data_1[mem_index];
-              score_sums_2[mem_index] += data_2[mem_index];
-              score_sums_3[mem_index] += data_3[mem_index];
+              score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + data[mem_index]);
+              score_sums_1[mem_index] = static_cast<unsigned short> (score_sums_1[mem_index] + data_1[mem_index]);
+              score_sums_2[mem_index] = static_cast<unsigned short> (score_sums_2[mem_index] + data_2[mem_index]);
+              score_sums_3[mem_index] = static_cast<unsigned short> (score_sums_3[mem_index] + data_3[mem_index]);
             }
-#else
-            max_score += 4;
-
-            unsigned char * data = modality_linearized_maps[feature.modality_index][bin_index].getOffsetMap (static_cast<size_t> (feature.x*scale), static_cast<size_t> (feature.y*scale));
-            for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
-            {
-              score_sums[mem_index] += data[mem_index];
-            }
-#endif
           }
         }
       }
+#else
+      const int max_score = computeScoreSums (template_bank_, templates_, template_index, modality_linearized_maps, scale,
+                                              kernels, mem_size, score_sums, tmp_score_sums);
 #endif
 
       const float inv_max_score = 1.0f / float (max_score);
@@ -1268,19 +1115,23 @@ pcl::LINEMOD::detectTemplatesSemiScaleInvariant (
 #endif
 
 
-          detections.push_back (detection);
+          scale_detections[job_index].push_back (detection);
         }
       }
+    }
 
-      delete[] score_sums;
+    aligned_free (score_sums);
+    aligned_free (tmp_score_sums);
 #ifdef LINEMOD_USE_SEPARATE_ENERGY_MAPS
-      delete[] score_sums_1;
-      delete[] score_sums_2;
-      delete[] score_sums_3;
+    delete[] score_sums_1;
+    delete[] score_sums_2;
+    delete[] score_sums_3;
 #endif
-    }
   }
 
+  for (size_t job_index = 0; job_index < scale_detections.size (); ++job_index)
+    detections.insert (detections.end (), scale_detections[job_index].begin (), scale_detections[job_index].end ());
+
   // release data
   for (size_t modality_index = 0; modality_index < modality_linearized_maps.size (); ++modality_index)
   {
@@ -1330,10 +1181,15 @@ pcl::LINEMOD::loadTemplates (const char * file_name)
 void
 pcl::LINEMOD::serialize (std::ostream & stream) const
 {
-  const int nr_templates = static_cast<int> (templates_.size ());
+  const int nr_templates = static_cast<int> (getNumOfTemplates ());
   write (stream, nr_templates);
+
+  SparseQuantizedMultiModTemplate linemod_template;
   for (int template_index = 0; template_index < nr_templates; ++template_index)
-    templates_[template_index].serialize (stream);
+  {
+    copyTemplate (template_index, linemod_template);
+    linemod_template.serialize (stream);
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -1341,6 +1197,7 @@ void
 pcl::LINEMOD::deserialize (std::istream & stream)
 {
   templates_.clear ();
+  template_bank_.reset ();
 
   int nr_templates;
   read (stream, nr_templates);
@@ -1348,3 +1205,47 @@ pcl::LINEMOD::deserialize (std::istream & stream)
   for (int template_index = 0; template_index < nr_templates; ++template_index)
     templates_[template_index].deserialize (stream);
 }
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::LINEMOD::setTemplateBank (const LINEMODTemplateBank::ConstPtr & template_bank)
+{
+  templates_.clear ();
+  template_bank_ = template_bank;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::LINEMOD::loadTemplateBank (const std::string & file_name)
+{
+  LINEMODTemplateBank::Ptr template_bank (new LINEMODTemplateBank);
+  if (!template_bank->open (file_name))
+    return (false);
+
+  setTemplateBank (template_bank);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::LINEMOD::saveTemplateBank (const std::string & file_name) const
+{
+  std::vector<SparseQuantizedMultiModTemplate> templates (getNumOfTemplates ());
+  for (size_t template_index = 0; template_index < templates.size (); ++template_index)
+    copyTemplate (template_index, templates[template_index]);
+
+  // plain LINEMOD templates do not belong to distinct objects
+  const std::vector<size_t> object_ids (templates.size (), 0);
+  return (LINEMODTemplateBank::write (file_name, templates, object_ids));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::LINEMOD::copyTemplate (const size_t template_id, SparseQuantizedMultiModTemplate & linemod_template) const
+{
+  const size_t nr_bank_templates = getNumOfBankTemplates ();
+  if (template_id < nr_bank_templates)
+    template_bank_->getTemplate (template_id, linemod_template);
+  else
+    linemod_template = templates_[template_id - nr_bank_templates];
+}
@@ -0,0 +1,214 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#include <pcl/recognition/linemod/score_kernels.h>
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// the AVX2 kernels are either compiled natively or, if the compiler supports it, with a
+// per-function target attribute; in the latter case they are only used if the CPU supports AVX2
+#if defined (__AVX2__)
+#  define LINEMOD_AVX2_KERNELS
+#  define LINEMOD_AVX2_TARGET
+#elif defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__)) && \
+      ((defined (__clang__) && (__clang_major__ > 3 || (__clang_major__ == 3 && __clang_minor__ >= 8))) || \
+       (!defined (__clang__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#  define LINEMOD_AVX2_KERNELS
+#  define LINEMOD_AVX2_TARGET __attribute__ ((target ("avx2")))
+#endif
+
+#ifdef LINEMOD_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace
+{
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  accumulateResponses (unsigned char * tmp_score_sums, const unsigned char * data, const size_t mem_size)
+  {
+    for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
+      tmp_score_sums[mem_index] = static_cast<unsigned char> (tmp_score_sums[mem_index] + data[mem_index]);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  flushResponses (unsigned short * score_sums, unsigned char * tmp_score_sums, const size_t mem_size)
+  {
+    for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
+      score_sums[mem_index] = static_cast<unsigned short> (score_sums[mem_index] + tmp_score_sums[mem_index]);
+
+    memset (tmp_score_sums, 0, mem_size*sizeof (tmp_score_sums[0]));
+  }
+
+#ifdef __SSE2__
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  accumulateResponsesSSE2 (unsigned char * tmp_score_sums, const unsigned char * data, const size_t mem_size)
+  {
+    __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
+    const __m128i * data_m128i = reinterpret_cast<const __m128i*> (data);
+
+    const size_t mem_size_16 = mem_size / 16;
+    for (size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
+      tmp_score_sums_m128i[mem_index] = _mm_add_epi8 (tmp_score_sums_m128i[mem_index], _mm_loadu_si128 (data_m128i + mem_index));
+
+    const size_t mem_size_mod_16_base = mem_size_16 * 16;
+    accumulateResponses (tmp_score_sums + mem_size_mod_16_base, data + mem_size_mod_16_base, mem_size - mem_size_mod_16_base);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  void
+  flushResponsesSSE2 (unsigned short * score_sums, unsigned char * tmp_score_sums, const size_t mem_size)
+  {
+    __m128i * score_sums_m128i = reinterpret_cast<__m128i*> (score_sums);
+    __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
+    const __m128i zero = _mm_setzero_si128 ();
+
+    const size_t mem_size_16 = mem_size / 16;
+    for (size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
+    {
+      const __m128i tmp_sums = tmp_score_sums_m128i[mem_index];
+      score_sums_m128i[2*mem_index+0] = _mm_add_epi16 (score_sums_m128i[2*mem_index+0], _mm_unpacklo_epi8 (tmp_sums, zero));
+      score_sums_m128i[2*mem_index+1] = _mm_add_epi16 (score_sums_m128i[2*mem_index+1], _mm_unpackhi_epi8 (tmp_sums, zero));
+      tmp_score_sums_m128i[mem_index] = zero;
+    }
+
+    const size_t mem_size_mod_16_base = mem_size_16 * 16;
+    flushResponses (score_sums + mem_size_mod_16_base, tmp_score_sums + mem_size_mod_16_base, mem_size - mem_size_mod_16_base);
+  }
+#endif
+
+#ifdef LINEMOD_AVX2_KERNELS
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  LINEMOD_AVX2_TARGET void
+  accumulateResponsesAVX2 (unsigned char * tmp_score_sums, const unsigned char * data, const size_t mem_size)
+  {
+    __m256i * tmp_score_sums_m256i = reinterpret_cast<__m256i*> (tmp_score_sums);
+    const __m256i * data_m256i = reinterpret_cast<const __m256i*> (data);
+
+    const size_t mem_size_32 = mem_size / 32;
+    for (size_t mem_index = 0; mem_index < mem_size_32; ++mem_index)
+    {
+      const __m256i tmp_sums = _mm256_loadu_si256 (tmp_score_sums_m256i + mem_index);
+      _mm256_storeu_si256 (tmp_score_sums_m256i + mem_index, _mm256_add_epi8 (tmp_sums, _mm256_loadu_si256 (data_m256i + mem_index)));
+    }
+
+    const size_t mem_size_mod_32_base = mem_size_32 * 32;
+    accumulateResponses (tmp_score_sums + mem_size_mod_32_base, data + mem_size_mod_32_base, mem_size - mem_size_mod_32_base);
+  }
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  LINEMOD_AVX2_TARGET void
+  flushResponsesAVX2 (unsigned short * score_sums, unsigned char * tmp_score_sums, const size_t mem_size)
+  {
+    __m256i * score_sums_m256i = reinterpret_cast<__m256i*> (score_sums);
+    __m128i * tmp_score_sums_m128i = reinterpret_cast<__m128i*> (tmp_score_sums);
+    const __m128i zero = _mm_setzero_si128 ();
+
+    const size_t mem_size_16 = mem_size / 16;
+    for (size_t mem_index = 0; mem_index < mem_size_16; ++mem_index)
+    {
+      const __m256i tmp_sums = _mm256_cvtepu8_epi16 (_mm_loadu_si128 (tmp_score_sums_m128i + mem_index));
+      const __m256i sums = _mm256_loadu_si256 (score_sums_m256i + mem_index);
+      _mm256_storeu_si256 (score_sums_m256i + mem_index, _mm256_add_epi16 (sums, tmp_sums));
+      _mm_storeu_si128 (tmp_score_sums_m128i + mem_index, zero);
+    }
+
+    const size_t mem_size_mod_16_base = mem_size_16 * 16;
+    flushResponses (score_sums + mem_size_mod_16_base, tmp_score_sums + mem_size_mod_16_base, mem_size - mem_size_mod_16_base);
+  }
+#endif
+
+  //////////////////////////////////////////////////////////////////////////////////////////////
+  bool
+  cpuSupportsAVX2 ()
+  {
+#if defined (__AVX2__)
+    return (true);
+#elif defined (LINEMOD_AVX2_KERNELS)
+    __builtin_cpu_init ();
+    return (__builtin_cpu_supports ("avx2") != 0);
+#else
+    return (false);
+#endif
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+std::vector<pcl::LINEMODScoreKernels>
+pcl::LINEMODScoreKernels::getAvailable ()
+{
+  std::vector<LINEMODScoreKernels> available;
+
+  LINEMODScoreKernels kernels;
+  kernels.name = "scalar";
+  kernels.accumulate = &accumulateResponses;
+  kernels.flush = &flushResponses;
+  available.push_back (kernels);
+#ifdef __SSE2__
+  kernels.name = "SSE2";
+  kernels.accumulate = &accumulateResponsesSSE2;
+  kernels.flush = &flushResponsesSSE2;
+  available.push_back (kernels);
+#endif
+#ifdef LINEMOD_AVX2_KERNELS
+  if (cpuSupportsAVX2 ())
+  {
+    kernels.name = "AVX2";
+    kernels.accumulate = &accumulateResponsesAVX2;
+    kernels.flush = &flushResponsesAVX2;
+    available.push_back (kernels);
+  }
+#endif
+  return (available);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+const pcl::LINEMODScoreKernels &
+pcl::LINEMODScoreKernels::getDefault ()
+{
+  static const LINEMODScoreKernels kernels = getAvailable ().back ();
+  return (kernels);
+}
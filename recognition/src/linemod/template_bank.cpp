@@ -0,0 +1,520 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id$
+ *
+ */
+
+
+#include <pcl/recognition/linemod/template_bank.h>
+#include <pcl/console/print.h>
+
+#include <fcntl.h>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#ifdef _WIN32
+# include <io.h>
+# include <windows.h>
+# define pcl_open                    _open
+# define pcl_close(fd)               _close(fd)
+# define pcl_lseek(fd,offset,origin) _lseeki64(fd,offset,origin)
+#else
+# include <unistd.h>
+# include <sys/mman.h>
+# define pcl_open                    ::open
+# define pcl_close(fd)               ::close(fd)
+# define pcl_lseek(fd,offset,origin) ::lseek(fd,offset,origin)
+#endif
+
+namespace
+{
+  const char bank_magic[8] = {'P', 'C', 'L', 'L', 'M', 'T', 'B', '\0'};
+  const pcl::uint32_t bank_byte_order_mark = 0x01020304;
+
+  /** \brief Rounds the specified file offset up to a multiple of 8 bytes. */
+  inline pcl::uint64_t
+  alignOffset (const pcl::uint64_t offset)
+  {
+    return ((offset + 7) & ~static_cast<pcl::uint64_t> (7));
+  }
+
+  /** \brief Fills the stream with zeros up to the specified offset. */
+  void
+  padStream (std::ostream & stream, const pcl::uint64_t offset)
+  {
+    const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    const pcl::uint64_t position = static_cast<pcl::uint64_t> (stream.tellp ());
+    stream.write (zeros, static_cast<std::streamsize> (offset - position));
+  }
+
+  /** \brief Checks whether an array of records lies within the file and is properly aligned. */
+  inline bool
+  isValidRange (const pcl::uint64_t offset, const pcl::uint64_t nr_records, const size_t record_size, const pcl::uint64_t file_size)
+  {
+    return (offset % 8 == 0 && offset >= sizeof (pcl::LINEMODTemplateBank::Header) && offset <= file_size &&
+            nr_records <= (file_size - offset) / record_size);
+  }
+
+  template <typename RecordT> inline void
+  writeRecord (std::ostream & stream, const RecordT & record)
+  {
+    stream.write (reinterpret_cast<const char*> (&record), sizeof (record));
+  }
+}
+
+const pcl::uint32_t pcl::LINEMODTemplateBank::VERSION;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::LINEMODTemplateBank::LINEMODTemplateBank ()
+  : map_ (NULL)
+  , map_size_ (0)
+#ifdef _WIN32
+  , file_mapping_ (NULL)
+#endif
+  , header_ (NULL)
+  , objects_ (NULL)
+  , templates_ (NULL)
+  , features_ (NULL)
+  , points_ (NULL)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::LINEMODTemplateBank::~LINEMODTemplateBank ()
+{
+  close ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::LINEMODTemplateBank::open (const std::string & file_name)
+{
+  close ();
+
+  int fd = pcl_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::open] Could not open %s!\n", file_name.c_str ());
+    return (false);
+  }
+
+  // 64 bit offsets, so that large banks are neither truncated nor wrapped around on platforms with a 32 bit long
+  const pcl::int64_t file_size = static_cast<pcl::int64_t> (pcl_lseek (fd, 0, SEEK_END));
+  if (file_size < static_cast<pcl::int64_t> (sizeof (Header)))
+  {
+    pcl_close (fd);
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::open] %s is not a template bank!\n", file_name.c_str ());
+    return (false);
+  }
+  if (static_cast<pcl::uint64_t> (file_size) > static_cast<pcl::uint64_t> (std::numeric_limits<size_t>::max ()))
+  {
+    pcl_close (fd);
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::open] %s is too large to be mapped!\n", file_name.c_str ());
+    return (false);
+  }
+
+  // map the whole file; it is used in place and never copied
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping (reinterpret_cast<HANDLE> (_get_osfhandle (fd)), NULL, PAGE_READONLY, 0, 0, NULL);
+  char *map = (fm == NULL) ? NULL : static_cast<char*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+  pcl_close (fd);
+  if (map == NULL)
+  {
+    if (fm != NULL)
+      CloseHandle (fm);
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::open] Error mapping view of file, %s\n", file_name.c_str ());
+    return (false);
+  }
+  file_mapping_ = fm;
+#else
+  char *map = static_cast<char*> (mmap (0, static_cast<size_t> (file_size), PROT_READ, MAP_SHARED, fd, 0));
+  pcl_close (fd);
+  if (map == reinterpret_cast<char*> (-1))    // MAP_FAILED
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::open] Error during mmap () of %s!\n", file_name.c_str ());
+    return (false);
+  }
+#endif
+
+  map_ = map;
+  map_size_ = static_cast<size_t> (file_size);
+  header_ = reinterpret_cast<const Header*> (map_);
+
+  if (!validate (map_size_))
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::open] %s is not a valid template bank!\n", file_name.c_str ());
+    close ();
+    return (false);
+  }
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::LINEMODTemplateBank::validate (const size_t mapped_size)
+{
+  const Header & header = *header_;
+  if (memcmp (header.magic, bank_magic, sizeof (bank_magic)) != 0)
+    return (false);
+  if (header.byte_order_mark != bank_byte_order_mark)
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::validate] The bank was written with a different byte order!\n");
+    return (false);
+  }
+  if (header.version != VERSION)
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::validate] Unsupported bank version %u (expected %u)!\n", header.version, VERSION);
+    return (false);
+  }
+  if (header.file_size != mapped_size)
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::validate] The bank is truncated!\n");
+    return (false);
+  }
+  if (!isValidRange (header.objects_offset, header.nr_objects, sizeof (ObjectRecord), header.file_size) ||
+      !isValidRange (header.templates_offset, header.nr_templates, sizeof (TemplateRecord), header.file_size) ||
+      !isValidRange (header.features_offset, header.nr_features, sizeof (FeatureRecord), header.file_size) ||
+      !isValidRange (header.points_offset, header.nr_points, sizeof (PointRecord), header.file_size))
+    return (false);
+
+  objects_ = reinterpret_cast<const ObjectRecord*> (map_ + header.objects_offset);
+  templates_ = reinterpret_cast<const TemplateRecord*> (map_ + header.templates_offset);
+  features_ = reinterpret_cast<const FeatureRecord*> (map_ + header.features_offset);
+  points_ = reinterpret_cast<const PointRecord*> (map_ + header.points_offset);
+
+  // every object has to reference its own templates and every template its own features and points; 
+  // the features themselves are not inspected, so opening a bank stays independent of its size
+  for (pcl::uint32_t object_index = 0; object_index < header.nr_objects; ++object_index)
+  {
+    const ObjectRecord & object = objects_[object_index];
+    if (static_cast<pcl::uint64_t> (object.first_template) + object.nr_templates > header.nr_templates)
+      return (false);
+    for (pcl::uint32_t template_index = object.first_template; template_index < object.first_template + object.nr_templates; ++template_index)
+    {
+      if (templates_[template_index].object_index != object_index)
+        return (false);
+    }
+  }
+  for (pcl::uint32_t template_index = 0; template_index < header.nr_templates; ++template_index)
+  {
+    const TemplateRecord & linemod_template = templates_[template_index];
+    if (linemod_template.object_index >= header.nr_objects)
+      return (false);
+    if (linemod_template.first_feature > header.nr_features ||
+        linemod_template.nr_features > header.nr_features - linemod_template.first_feature)
+      return (false);
+    const pcl::uint64_t nr_points = static_cast<pcl::uint64_t> (linemod_template.cloud_width) * linemod_template.cloud_height;
+    if (linemod_template.first_point > header.nr_points || nr_points > header.nr_points - linemod_template.first_point)
+      return (false);
+  }
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::LINEMODTemplateBank::close ()
+{
+  if (map_ != NULL)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile (map_);
+    CloseHandle (file_mapping_);
+    file_mapping_ = NULL;
+#else
+    if (munmap (map_, map_size_) == -1)
+      PCL_ERROR ("[pcl::LINEMODTemplateBank::close] Error during munmap ()!\n");
+#endif
+  }
+
+  map_ = NULL;
+  map_size_ = 0;
+  header_ = NULL;
+  objects_ = NULL;
+  templates_ = NULL;
+  features_ = NULL;
+  points_ = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::LINEMODTemplateBank::write (const std::string & file_name,
+                                 const std::vector<SparseQuantizedMultiModTemplate> & templates,
+                                 const std::vector<size_t> & object_ids,
+                                 const std::vector<BoundingBoxXYZ> & bounding_boxes,
+                                 const PointCloud<PointXYZRGBA>::CloudVectorType & clouds)
+{
+  const size_t nr_templates = templates.size ();
+  if (object_ids.size () != nr_templates ||
+      (!bounding_boxes.empty () && bounding_boxes.size () != nr_templates) ||
+      (!clouds.empty () && clouds.size () != nr_templates))
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::write] The number of object IDs, bounding boxes and clouds does not match the number of templates!\n");
+    return (false);
+  }
+
+  // group the templates by object, in the order in which the objects first appear
+  std::map<size_t, size_t> object_indices;
+  std::vector<size_t> objects;
+  std::vector<std::vector<size_t> > object_templates;
+  Header header;
+  memset (&header, 0, sizeof (header));
+  for (size_t template_index = 0; template_index < nr_templates; ++template_index)
+  {
+    std::map<size_t, size_t>::const_iterator it = object_indices.find (object_ids[template_index]);
+    if (it == object_indices.end ())
+    {
+      it = object_indices.insert (std::make_pair (object_ids[template_index], objects.size ())).first;
+      objects.push_back (object_ids[template_index]);
+      object_templates.push_back (std::vector<size_t> ());
+    }
+    object_templates[it->second].push_back (template_index);
+
+    const std::vector<QuantizedMultiModFeature> & features = templates[template_index].features;
+    for (size_t feature_index = 0; feature_index < features.size (); ++feature_index)
+    {
+      if (features[feature_index].modality_index > 255)
+      {
+        PCL_ERROR ("[pcl::LINEMODTemplateBank::write] Modality indices larger than 255 are not supported!\n");
+        return (false);
+      }
+    }
+
+    header.nr_features += features.size ();
+    if (!clouds.empty ())
+      header.nr_points += clouds[template_index].points.size ();
+  }
+
+  memcpy (header.magic, bank_magic, sizeof (bank_magic));
+  header.version = VERSION;
+  header.byte_order_mark = bank_byte_order_mark;
+  header.nr_objects = static_cast<pcl::uint32_t> (objects.size ());
+  header.nr_templates = static_cast<pcl::uint32_t> (nr_templates);
+  header.objects_offset = alignOffset (sizeof (Header));
+  header.templates_offset = alignOffset (header.objects_offset + header.nr_objects * sizeof (ObjectRecord));
+  header.features_offset = alignOffset (header.templates_offset + header.nr_templates * sizeof (TemplateRecord));
+  header.points_offset = alignOffset (header.features_offset + header.nr_features * sizeof (FeatureRecord));
+  header.file_size = header.points_offset + header.nr_points * sizeof (PointRecord);
+
+  std::ofstream stream (file_name.c_str (), std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+  if (!stream.is_open ())
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::write] Could not open %s for writing!\n", file_name.c_str ());
+    return (false);
+  }
+
+  writeRecord (stream, header);
+
+  padStream (stream, header.objects_offset);
+  pcl::uint32_t first_template = 0;
+  for (size_t object_index = 0; object_index < objects.size (); ++object_index)
+  {
+    ObjectRecord object;
+    object.object_id = objects[object_index];
+    object.first_template = first_template;
+    object.nr_templates = static_cast<pcl::uint32_t> (object_templates[object_index].size ());
+    writeRecord (stream, object);
+
+    first_template += object.nr_templates;
+  }
+
+  padStream (stream, header.templates_offset);
+  pcl::uint64_t first_feature = 0;
+  pcl::uint64_t first_point = 0;
+  for (size_t object_index = 0; object_index < objects.size (); ++object_index)
+  {
+    for (size_t index = 0; index < object_templates[object_index].size (); ++index)
+    {
+      const size_t template_index = object_templates[object_index][index];
+      const SparseQuantizedMultiModTemplate & linemod_template = templates[template_index];
+
+      TemplateRecord record;
+      memset (&record, 0, sizeof (record));
+      record.region_x = linemod_template.region.x;
+      record.region_y = linemod_template.region.y;
+      record.region_width = linemod_template.region.width;
+      record.region_height = linemod_template.region.height;
+      if (!bounding_boxes.empty ())
+      {
+        const BoundingBoxXYZ & bounding_box = bounding_boxes[template_index];
+        record.bounding_box_x = bounding_box.x;
+        record.bounding_box_y = bounding_box.y;
+        record.bounding_box_z = bounding_box.z;
+        record.bounding_box_width = bounding_box.width;
+        record.bounding_box_height = bounding_box.height;
+        record.bounding_box_depth = bounding_box.depth;
+      }
+      record.object_index = static_cast<pcl::uint32_t> (object_index);
+      record.nr_features = static_cast<pcl::uint32_t> (linemod_template.features.size ());
+      record.first_feature = first_feature;
+      record.first_point = first_point;
+      if (!clouds.empty ())
+      {
+        // unorganized clouds are stored as a single row
+        const PointCloud<PointXYZRGBA> & cloud = clouds[template_index];
+        const bool is_consistent = static_cast<size_t> (cloud.width) * cloud.height == cloud.points.size ();
+        record.cloud_width = is_consistent ? cloud.width : static_cast<pcl::uint32_t> (cloud.points.size ());
+        record.cloud_height = is_consistent ? cloud.height : 1;
+      }
+      writeRecord (stream, record);
+
+      first_feature += record.nr_features;
+      first_point += static_cast<pcl::uint64_t> (record.cloud_width) * record.cloud_height;
+    }
+  }
+
+  padStream (stream, header.features_offset);
+  for (size_t object_index = 0; object_index < objects.size (); ++object_index)
+  {
+    for (size_t index = 0; index < object_templates[object_index].size (); ++index)
+    {
+      const std::vector<QuantizedMultiModFeature> & features = templates[object_templates[object_index][index]].features;
+      for (size_t feature_index = 0; feature_index < features.size (); ++feature_index)
+      {
+        FeatureRecord record;
+        record.x = features[feature_index].x;
+        record.y = features[feature_index].y;
+        record.modality_index = static_cast<pcl::uint8_t> (features[feature_index].modality_index);
+        record.quantized_value = features[feature_index].quantized_value;
+        record.reserved = 0;
+        writeRecord (stream, record);
+      }
+    }
+  }
+
+  padStream (stream, header.points_offset);
+  for (size_t object_index = 0; object_index < objects.size () && !clouds.empty (); ++object_index)
+  {
+    for (size_t index = 0; index < object_templates[object_index].size (); ++index)
+    {
+      const PointCloud<PointXYZRGBA> & cloud = clouds[object_templates[object_index][index]];
+      for (size_t point_index = 0; point_index < cloud.points.size (); ++point_index)
+      {
+        PointRecord record;
+        record.x = cloud.points[point_index].x;
+        record.y = cloud.points[point_index].y;
+        record.z = cloud.points[point_index].z;
+        record.rgba = cloud.points[point_index].rgba;
+        writeRecord (stream, record);
+      }
+    }
+  }
+
+  stream.close ();
+  if (stream.fail ())
+  {
+    PCL_ERROR ("[pcl::LINEMODTemplateBank::write] Error writing %s!\n", file_name.c_str ());
+    return (false);
+  }
+
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::RegionXY
+pcl::LINEMODTemplateBank::getRegion (const size_t template_index) const
+{
+  const TemplateRecord & record = templates_[template_index];
+
+  RegionXY region;
+  region.x = record.region_x;
+  region.y = record.region_y;
+  region.width = record.region_width;
+  region.height = record.region_height;
+  return (region);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+pcl::BoundingBoxXYZ
+pcl::LINEMODTemplateBank::getBoundingBox (const size_t template_index) const
+{
+  const TemplateRecord & record = templates_[template_index];
+
+  BoundingBoxXYZ bounding_box;
+  bounding_box.x = record.bounding_box_x;
+  bounding_box.y = record.bounding_box_y;
+  bounding_box.z = record.bounding_box_z;
+  bounding_box.width = record.bounding_box_width;
+  bounding_box.height = record.bounding_box_height;
+  bounding_box.depth = record.bounding_box_depth;
+  return (bounding_box);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::LINEMODTemplateBank::getTemplate (const size_t template_index, SparseQuantizedMultiModTemplate & linemod_template) const
+{
+  const FeatureRecord * features = getFeatures (template_index);
+  const size_t nr_features = getNumOfFeatures (template_index);
+
+  linemod_template.features.resize (nr_features);
+  for (size_t feature_index = 0; feature_index < nr_features; ++feature_index)
+  {
+    QuantizedMultiModFeature & feature = linemod_template.features[feature_index];
+    feature.x = features[feature_index].x;
+    feature.y = features[feature_index].y;
+    feature.modality_index = features[feature_index].modality_index;
+    feature.quantized_value = features[feature_index].quantized_value;
+  }
+  linemod_template.region = getRegion (template_index);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::LINEMODTemplateBank::getPointCloud (const size_t template_index, PointCloud<PointXYZRGBA> & cloud) const
+{
+  const TemplateRecord & record = templates_[template_index];
+  const PointRecord * points = points_ + record.first_point;
+  const size_t nr_points = static_cast<size_t> (record.cloud_width) * record.cloud_height;
+
+  cloud.points.resize (nr_points);
+  cloud.width = record.cloud_width;
+  cloud.height = record.cloud_height;
+  cloud.is_dense = true;
+  for (size_t point_index = 0; point_index < nr_points; ++point_index)
+  {
+    PointXYZRGBA & point = cloud.points[point_index];
+    point.x = points[point_index].x;
+    point.y = points[point_index].y;
+    point.z = points[point_index].z;
+    point.rgba = points[point_index].rgba;
+
+    if (!pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+      cloud.is_dense = false;
+  }
+}
@@ -43,8 +43,30 @@
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/kdtree/impl/kdtree_flann.hpp>
 #include <pcl/console/print.h>
+#include <fcntl.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <vector>
+#ifdef _WIN32
+# include <io.h>
+# include <windows.h>
+# define pcl_open                    _open
+# define pcl_close(fd)               _close(fd)
+# define pcl_lseek(fd,offset,origin) _lseeki64(fd,offset,origin)
+#else
+# include <unistd.h>
+# include <sys/mman.h>
+# define pcl_open                    ::open
+# define pcl_close(fd)               ::close(fd)
+# define pcl_lseek(fd,offset,origin) ::lseek(fd,offset,origin)
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define PIf 3.14159265358979323846f
 
@@ -53,10 +75,120 @@ using namespace pcl;
 using namespace console;
 using namespace recognition;
 
+namespace
+{
+  // Layout of the files written by ModelLibrary::saveToFile(): a header followed by the model records, the points (with
+  // normals), the hash table entries of all models and the model names. All sections start at multiples of 8 bytes.
+  const char library_magic[8] = {'P', 'C', 'L', 'O', 'R', 'R', 'M', 'L'};
+  const pcl::uint32_t library_version = 1;
+  const pcl::uint32_t library_byte_order_mark = 0x01020304;
+
+  struct LibraryHeader
+  {
+    char magic[8];
+    pcl::uint32_t version;
+    pcl::uint32_t byte_order_mark;
+    float pair_width, voxel_size;
+    pcl::int32_t num_of_cells[3];
+    pcl::uint32_t num_of_models;
+    pcl::uint64_t num_of_points, num_of_entries;
+    pcl::uint64_t models_offset, points_offset, entries_offset, names_offset;
+    pcl::uint64_t file_size;
+  };
+
+  struct ModelRecord
+  {
+    pcl::uint64_t first_point, first_entry, num_of_entries, name_offset;
+    pcl::uint32_t num_of_points, num_of_full_leaves, name_length, reserved;
+  };
+
+  struct PointRecord
+  {
+    float x, y, z, normal_x, normal_y, normal_z;
+  };
+
+  struct EntryRecord
+  {
+    pcl::uint32_t cell_id, leaf_id1, leaf_id2;
+  };
+
+  inline pcl::uint64_t
+  alignOffset (pcl::uint64_t offset)
+  {
+    return ((offset + 7) & ~static_cast<pcl::uint64_t> (7));
+  }
+
+  void
+  padStream (ostream& stream, pcl::uint64_t offset)
+  {
+    const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    stream.write (zeros, static_cast<streamsize> (offset - static_cast<pcl::uint64_t> (stream.tellp ())));
+  }
+
+  inline bool
+  isValidRange (pcl::uint64_t offset, pcl::uint64_t num_of_records, size_t record_size, pcl::uint64_t file_size)
+  {
+    return (offset % 8 == 0 && offset >= sizeof (LibraryHeader) && offset <= file_size && num_of_records <= (file_size - offset)/record_size);
+  }
+
+  /** \brief Maps the whole file read-only into memory. Returns NULL on failure. */
+  const char*
+  mapFile (const string& file_name, size_t& size, void*& handle)
+  {
+    handle = NULL;
+    int fd = pcl_open (file_name.c_str (), O_RDONLY);
+    if ( fd == -1 )
+      return (NULL);
+
+    // A 64 bit offset, such that large files are not wrapped around on platforms with a 32 bit long
+    const pcl::int64_t file_size = static_cast<pcl::int64_t> (pcl_lseek (fd, 0, SEEK_END));
+    if ( file_size < static_cast<pcl::int64_t> (sizeof (LibraryHeader)) ||
+         static_cast<pcl::uint64_t> (file_size) > static_cast<pcl::uint64_t> (numeric_limits<size_t>::max ()) )
+    {
+      pcl_close (fd);
+      return (NULL);
+    }
+    size = static_cast<size_t> (file_size);
+
+#ifdef _WIN32
+    HANDLE fm = CreateFileMapping (reinterpret_cast<HANDLE> (_get_osfhandle (fd)), NULL, PAGE_READONLY, 0, 0, NULL);
+    char *map = (fm == NULL) ? NULL : static_cast<char*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+    pcl_close (fd);
+    if ( map == NULL )
+    {
+      if ( fm != NULL )
+        CloseHandle (fm);
+      return (NULL);
+    }
+    handle = fm;
+#else
+    char *map = static_cast<char*> (mmap (0, size, PROT_READ, MAP_SHARED, fd, 0));
+    pcl_close (fd);
+    if ( map == reinterpret_cast<char*> (-1) ) // MAP_FAILED
+      return (NULL);
+#endif
+
+    return (map);
+  }
+
+  void
+  unmapFile (const char* map, size_t size, void* handle)
+  {
+#ifdef _WIN32
+    UnmapViewOfFile (map);
+    CloseHandle (static_cast<HANDLE> (handle));
+    (void) size;
+#else
+    munmap (const_cast<char*> (map), size);
+    (void) handle;
+#endif
+  }
+}
+
 //============================================================================================================================================
 
 ModelLibrary::ModelLibrary (float pair_width, float voxel_size)
-: pair_width_ (pair_width), pair_width_eps_ (0.1f*pair_width), voxel_size_(voxel_size)
+: pair_width_ (pair_width), pair_width_eps_ (0.1f*pair_width), voxel_size_(voxel_size), threads_ (0)
 {
   num_of_cells_[0] = 10; // 60
   num_of_cells_[1] = 10; // 60
@@ -79,95 +211,410 @@ ModelLibrary::clear ()
     delete it->second;
   models_.clear();
 
-  // Clear the hash table
+  // Clear the hash table (but keep the cells, such that new models can be added)
   HashTableCell* cells = hash_table_.getVoxels();
-  int num_bins = num_of_cells_[0]*num_of_cells_[1]*num_of_cells_[2];
+  int num_bins = hash_table_.getNumberOfVoxels();
 
   // Clear each cell entry
   for ( int i = 0 ; i < num_bins ; ++i )
     cells[i].clear();
-
-  num_of_cells_[0] = num_of_cells_[1] = num_of_cells_[2] = 0;
 }
 
 //============================================================================================================================================
 
 bool
 ModelLibrary::addModel (PointCloudIn* points, PointCloudN* normals, const std::string& object_name)
+{
+  return (this->addModels (vector<PointCloudIn*> (1, points), vector<PointCloudN*> (1, normals), vector<string> (1, object_name)));
+}
+
+//============================================================================================================================================
+
+bool
+ModelLibrary::addModels (const std::vector<PointCloudIn*>& points, const std::vector<PointCloudN*>& normals, const std::vector<std::string>& object_names)
 {
 #ifdef OBJ_REC_RANSAC_VERBOSE
   printf("ModelLibrary::%s(): begin\n", __func__);
 #endif
 
-  // Try to insert a new model entry
-  pair<map<string,Model*>::iterator, bool> result = models_.insert (pair<string,Model*> (object_name, static_cast<Model*> (NULL)));
-
-  // Check if 'object_name' is unique
-  if (!result.second)
+  if ( points.size () != normals.size () || points.size () != object_names.size () )
   {
-    print_error ("'%s' already exists in the model library.\n", object_name.c_str ());
+    print_error ("The number of point clouds, normal clouds and object names differs.\n");
     return (false);
   }
 
-  // It is unique -> create a new library model
-  Model* new_model = new Model (points, normals, object_name);
-  result.first->second = new_model;
-
-  // Build the octree
-  ORROctree& octree = new_model->getOctree ();
-  octree.build (*points, voxel_size_, normals);
+  // Check if all names are unique
+  set<string> new_names;
+  for ( size_t i = 0 ; i < object_names.size () ; ++i )
+  {
+    if ( models_.find (object_names[i]) != models_.end () || !new_names.insert (object_names[i]).second )
+    {
+      print_error ("'%s' already exists in the model library.\n", object_names[i].c_str ());
+      return (false);
+    }
+  }
 
-  vector<ORROctree::Node*> &full_leaves = octree.getFullLeaves ();
-  list<ORROctree::Node*> inter_leaves;
-  ORROctree::Node::Data *node_data1;
-  int num_of_pairs = 0;
+  // They are unique -> create the new library models
+  const int num_models = static_cast<int> (object_names.size ());
+  vector<Model*> new_models (num_models);
+  for ( int i = 0 ; i < num_models ; ++i )
+  {
+    new_models[i] = new Model (points[i], normals[i], object_names[i]);
+    models_[object_names[i]] = new_models[i];
+  }
 
 #ifdef OBJ_REC_RANSAC_VERBOSE
   printf("\tfilling the hash table ... "); fflush(stdout);
 #endif
 
+  // Build the octrees and compute the oriented point pairs of the models in parallel
+  vector<vector<HashTableEntry> > entries (num_models);
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads) schedule(dynamic, 1)
+#endif
+  for ( int i = 0 ; i < num_models ; ++i )
+  {
+    new_models[i]->getOctree ().build (*points[i], voxel_size_, normals[i]);
+    this->computeHashTableEntries (new_models[i], entries[i]);
+  }
+
+  this->fillHashTable (new_models, entries);
+
+#ifdef OBJ_REC_RANSAC_VERBOSE
+  printf("OK\nModelLibrary::%s(): end\n", __func__);
+#endif
+
+  return (true);
+}
+
+//============================================================================================================================================
+
+void
+ModelLibrary::computeHashTableEntries (Model* model, std::vector<HashTableEntry>& entries) const
+{
+  ORROctree& octree = model->getOctree ();
+  vector<ORROctree::Node*> &full_leaves = octree.getFullLeaves ();
+  list<ORROctree::Node*> inter_leaves;
+  const HashTableCell* cells = hash_table_.getVoxels ();
+  HashTableEntry entry;
+  float key[3];
+
+  entries.clear ();
+
   // Run through all full leaves
   for ( vector<ORROctree::Node*>::iterator leaf1 = full_leaves.begin () ; leaf1 != full_leaves.end () ; ++leaf1 )
   {
-    node_data1 = (*leaf1)->getData ();
+    entry.data1 = (*leaf1)->getData ();
 
     // Get all full leaves at the right distance to the current leaf
     inter_leaves.clear ();
-    octree.getFullLeavesIntersectedBySphere (node_data1->getPoint (), pair_width_, inter_leaves);
+    octree.getFullLeavesIntersectedBySphere (entry.data1->getPoint (), pair_width_, inter_leaves);
 
     for ( list<ORROctree::Node*>::iterator leaf2 = inter_leaves.begin () ; leaf2 != inter_leaves.end () ; ++leaf2 )
     {
-      // Compute the hash table key
-      this->addToHashTable(new_model, node_data1, (*leaf2)->getData ());
+      entry.data2 = (*leaf2)->getData ();
+
+      // Compute the descriptor signature for the oriented point pair (data1, data2)
+      ObjRecRANSAC::compute_oriented_point_pair_signature (
+        entry.data1->getPoint (), entry.data1->getNormal (),
+        entry.data2->getPoint (), entry.data2->getNormal (), key);
 
-      ++num_of_pairs;
+      // Get the hash table cell containing 'key' (there is such a cell unless the signature is degenerate)
+      const HashTableCell* cell = hash_table_.getVoxel (key);
+      if ( !cell )
+        continue;
+
+      entry.cell_id = static_cast<int> (cell - cells);
+      entries.push_back (entry);
     }
   }
+}
 
-#ifdef OBJ_REC_RANSAC_VERBOSE
-  printf("OK\nModelLibrary::%s(): end\n", __func__);
+//============================================================================================================================================
+
+void
+ModelLibrary::fillHashTable (const std::vector<Model*>& models, const std::vector<std::vector<HashTableEntry> >& entries)
+{
+  HashTableCell* cells = hash_table_.getVoxels ();
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nr_threads)
+#endif
+  {
+#ifdef _OPENMP
+    const int thread_id = omp_get_thread_num (), num_threads = omp_get_num_threads ();
+#else
+    const int thread_id = 0, num_threads = 1;
 #endif
 
+    // Each thread fills only the cells it owns, so no synchronization is needed
+    for ( size_t i = 0 ; i < models.size () ; ++i )
+    {
+      for ( vector<HashTableEntry>::const_iterator entry = entries[i].begin () ; entry != entries[i].end () ; ++entry )
+      {
+        if ( entry->cell_id % num_threads == thread_id )
+          cells[entry->cell_id][models[i]].push_back (pair<ORROctree::Node::Data*,ORROctree::Node::Data*> (entry->data1, entry->data2));
+      }
+    }
+  }
+}
+
+//============================================================================================================================================
+
+bool
+ModelLibrary::saveToFile (const std::string& file_name) const
+{
+  const HashTableCell* cells = hash_table_.getVoxels ();
+  const int num_cells = hash_table_.getNumberOfVoxels ();
+
+  LibraryHeader header;
+  memset (&header, 0, sizeof (header));
+  memcpy (header.magic, library_magic, sizeof (library_magic));
+  header.version = library_version;
+  header.byte_order_mark = library_byte_order_mark;
+  header.pair_width = pair_width_;
+  header.voxel_size = voxel_size_;
+  header.num_of_cells[0] = num_of_cells_[0]; header.num_of_cells[1] = num_of_cells_[1]; header.num_of_cells[2] = num_of_cells_[2];
+  header.num_of_models = static_cast<pcl::uint32_t> (models_.size ());
+
+  // Collect the model records, the points and the hash table entries
+  vector<ModelRecord> model_records;
+  vector<PointRecord> point_records;
+  vector<EntryRecord> entry_records;
+  string names;
+
+  for ( map<string,Model*>::const_iterator it = models_.begin () ; it != models_.end () ; ++it )
+  {
+    const Model* model = it->second;
+    const vector<ORROctree::Node*>& full_leaves = model->getOctree ().getFullLeaves ();
+
+    ModelRecord model_record;
+    memset (&model_record, 0, sizeof (model_record));
+    model_record.first_point = point_records.size ();
+    model_record.num_of_points = static_cast<pcl::uint32_t> (model->points_->size ());
+    model_record.num_of_full_leaves = static_cast<pcl::uint32_t> (full_leaves.size ());
+    model_record.first_entry = entry_records.size ();
+    model_record.name_offset = names.size ();
+    model_record.name_length = static_cast<pcl::uint32_t> (model->obj_name_.size ());
+    names += model->obj_name_;
+
+    for ( size_t i = 0 ; i < model->points_->size () ; ++i )
+    {
+      PointRecord point_record = {(*model->points_)[i].x, (*model->points_)[i].y, (*model->points_)[i].z, 0.0f, 0.0f, 0.0f};
+      if ( model->normals_ )
+      {
+        point_record.normal_x = (*model->normals_)[i].normal_x;
+        point_record.normal_y = (*model->normals_)[i].normal_y;
+        point_record.normal_z = (*model->normals_)[i].normal_z;
+      }
+      point_records.push_back (point_record);
+    }
+
+    // The leaves are referenced by their position in the vector of full leaves, which is the same after rebuilding the octree
+    map<const ORROctree::Node::Data*,pcl::uint32_t> leaf_ids;
+    for ( size_t i = 0 ; i < full_leaves.size () ; ++i )
+      leaf_ids[full_leaves[i]->getData ()] = static_cast<pcl::uint32_t> (i);
+
+    for ( int cell_id = 0 ; cell_id < num_cells ; ++cell_id )
+    {
+      HashTableCell::const_iterator cell = cells[cell_id].find (model);
+      if ( cell == cells[cell_id].end () )
+        continue;
+
+      for ( node_data_pair_list::const_iterator pair = cell->second.begin () ; pair != cell->second.end () ; ++pair )
+      {
+        EntryRecord entry_record = {static_cast<pcl::uint32_t> (cell_id), leaf_ids[pair->first], leaf_ids[pair->second]};
+        entry_records.push_back (entry_record);
+      }
+    }
+
+    model_record.num_of_entries = entry_records.size () - model_record.first_entry;
+    model_records.push_back (model_record);
+  }
+
+  header.num_of_points = point_records.size ();
+  header.num_of_entries = entry_records.size ();
+  header.models_offset = alignOffset (sizeof (LibraryHeader));
+  header.points_offset = alignOffset (header.models_offset + model_records.size ()*sizeof (ModelRecord));
+  header.entries_offset = alignOffset (header.points_offset + point_records.size ()*sizeof (PointRecord));
+  header.names_offset = alignOffset (header.entries_offset + entry_records.size ()*sizeof (EntryRecord));
+  header.file_size = header.names_offset + names.size ();
+
+  ofstream file (file_name.c_str (), ios::out | ios::binary | ios::trunc);
+  if ( !file.is_open () )
+  {
+    print_error ("Could not open '%s' for writing.\n", file_name.c_str ());
+    return (false);
+  }
+
+  file.write (reinterpret_cast<const char*> (&header), sizeof (header));
+  padStream (file, header.models_offset);
+  if ( !model_records.empty () )
+    file.write (reinterpret_cast<const char*> (&model_records[0]), model_records.size ()*sizeof (ModelRecord));
+  padStream (file, header.points_offset);
+  if ( !point_records.empty () )
+    file.write (reinterpret_cast<const char*> (&point_records[0]), point_records.size ()*sizeof (PointRecord));
+  padStream (file, header.entries_offset);
+  if ( !entry_records.empty () )
+    file.write (reinterpret_cast<const char*> (&entry_records[0]), entry_records.size ()*sizeof (EntryRecord));
+  padStream (file, header.names_offset);
+  file.write (names.data (), static_cast<streamsize> (names.size ()));
+
+  if ( !file.good () )
+  {
+    print_error ("Error while writing '%s'.\n", file_name.c_str ());
+    return (false);
+  }
+
   return (true);
 }
 
 //============================================================================================================================================
 
-void
-ModelLibrary::addToHashTable (const ModelLibrary::Model* model, ORROctree::Node::Data* data1, ORROctree::Node::Data* data2)
+bool
+ModelLibrary::loadFromFile (const std::string& file_name)
 {
-  float key[3];
+  this->clear ();
+
+  size_t map_size = 0;
+  void* map_handle = NULL;
+  const char* map = mapFile (file_name, map_size, map_handle);
+  if ( !map )
+  {
+    print_error ("Could not map '%s'.\n", file_name.c_str ());
+    return (false);
+  }
+
+  // Validate the header and the section bounds
+  const LibraryHeader& header = *reinterpret_cast<const LibraryHeader*> (map);
+  const char* error = NULL;
+
+  if ( memcmp (header.magic, library_magic, sizeof (library_magic)) != 0 )
+    error = "is not a model library";
+  else if ( header.byte_order_mark != library_byte_order_mark )
+    error = "was written with a different byte order";
+  else if ( header.version != library_version )
+    error = "has an unsupported version";
+  else if ( header.file_size != map_size )
+    error = "is truncated";
+  else if ( header.pair_width != pair_width_ || header.voxel_size != voxel_size_ ||
+            header.num_of_cells[0] != num_of_cells_[0] || header.num_of_cells[1] != num_of_cells_[1] || header.num_of_cells[2] != num_of_cells_[2] )
+    error = "was built with a different pair width, voxel size or hash table";
+  else if ( !isValidRange (header.models_offset, header.num_of_models, sizeof (ModelRecord), map_size) ||
+            !isValidRange (header.points_offset, header.num_of_points, sizeof (PointRecord), map_size) ||
+            !isValidRange (header.entries_offset, header.num_of_entries, sizeof (EntryRecord), map_size) ||
+            header.names_offset < sizeof (LibraryHeader) || header.names_offset > map_size )
+    error = "is corrupted";
+
+  const ModelRecord* model_records = reinterpret_cast<const ModelRecord*> (map + header.models_offset);
+  const PointRecord* point_records = reinterpret_cast<const PointRecord*> (map + header.points_offset);
+  const EntryRecord* entry_records = reinterpret_cast<const EntryRecord*> (map + header.entries_offset);
+  const char* names = map + header.names_offset;
+  const pcl::uint64_t names_size = map_size - header.names_offset;
+
+  // Create the models (they own their points and normals)
+  const int num_models = error ? 0 : static_cast<int> (header.num_of_models);
+  vector<Model*> new_models;
+
+  for ( int i = 0 ; i < num_models && !error ; ++i )
+  {
+    const ModelRecord& record = model_records[i];
+    if ( record.first_point > header.num_of_points || record.num_of_points > header.num_of_points - record.first_point ||
+         record.first_entry > header.num_of_entries || record.num_of_entries > header.num_of_entries - record.first_entry ||
+         record.name_offset > names_size || record.name_length > names_size - record.name_offset )
+    {
+      error = "is corrupted";
+      break;
+    }
+
+    const string name (names + record.name_offset, record.name_length);
+    if ( models_.find (name) != models_.end () )
+    {
+      error = "contains duplicate model names";
+      break;
+    }
 
-  // Compute the descriptor signature for the oriented point pair (i, j)
-  ObjRecRANSAC::compute_oriented_point_pair_signature (
-    data1->getPoint (), data1->getNormal (),
-    data2->getPoint (), data2->getNormal (), key);
+    PointCloudIn::Ptr points (new PointCloudIn ());
+    PointCloudN::Ptr normals (new PointCloudN ());
+    points->resize (record.num_of_points);
+    normals->resize (record.num_of_points);
+    for ( pcl::uint32_t j = 0 ; j < record.num_of_points ; ++j )
+    {
+      const PointRecord& point_record = point_records[record.first_point + j];
+      (*points)[j].x = point_record.x; (*points)[j].y = point_record.y; (*points)[j].z = point_record.z;
+      (*normals)[j].normal_x = point_record.normal_x; (*normals)[j].normal_y = point_record.normal_y; (*normals)[j].normal_z = point_record.normal_z;
+    }
+
+    Model* model = new Model (points, normals, name);
+    models_[name] = model;
+    new_models.push_back (model);
+  }
 
-  // Get the hash table cell containing 'key' (there is for sure such a cell since the hash table bounds are large enough)
-  HashTableCell* cell = hash_table_.getVoxel (key);
+  // Rebuild the octrees and translate the entries to leaf pointers in parallel
+  vector<vector<HashTableEntry> > entries (new_models.size ());
+  vector<char> valid (new_models.size (), 1);
+  const int num_cells = hash_table_.getNumberOfVoxels ();
 
-  // Insert the pair (data1,data2) belonging to 'model'
-  (*cell)[model].push_back (std::pair<ORROctree::Node::Data*,ORROctree::Node::Data*> (data1, data2));
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads) schedule(dynamic, 1)
+#endif
+  for ( int i = 0 ; i < static_cast<int> (new_models.size ()) ; ++i )
+  {
+    const ModelRecord& record = model_records[i];
+    ORROctree& octree = new_models[i]->getOctree ();
+    octree.build (*new_models[i]->points_, voxel_size_, new_models[i]->normals_);
+
+    const vector<ORROctree::Node*>& full_leaves = octree.getFullLeaves ();
+    if ( full_leaves.size () != record.num_of_full_leaves )
+    {
+      valid[i] = 0;
+      continue;
+    }
+
+    entries[i].resize (static_cast<size_t> (record.num_of_entries));
+    for ( size_t j = 0 ; j < entries[i].size () ; ++j )
+    {
+      const EntryRecord& entry_record = entry_records[record.first_entry + j];
+      if ( entry_record.cell_id >= static_cast<pcl::uint32_t> (num_cells) ||
+           entry_record.leaf_id1 >= full_leaves.size () || entry_record.leaf_id2 >= full_leaves.size () )
+      {
+        valid[i] = 0;
+        break;
+      }
+      entries[i][j].cell_id = static_cast<int> (entry_record.cell_id);
+      entries[i][j].data1 = full_leaves[entry_record.leaf_id1]->getData ();
+      entries[i][j].data2 = full_leaves[entry_record.leaf_id2]->getData ();
+    }
+  }
+
+  if ( !error && find (valid.begin (), valid.end (), 0) != valid.end () )
+    error = "does not match the rebuilt octrees";
+
+  if ( error )
+  {
+    print_error ("'%s' %s.\n", file_name.c_str (), error);
+    unmapFile (map, map_size, map_handle);
+    this->clear ();
+    return (false);
+  }
+
+  this->fillHashTable (new_models, entries);
+  unmapFile (map, map_size, map_handle);
+
+  return (true);
 }
 
 //============================================================================================================================================
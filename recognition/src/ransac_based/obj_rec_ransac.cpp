@@ -38,19 +38,365 @@
  */
 
 #include <pcl/recognition/ransac_based/obj_rec_ransac.h>
+#include <pcl/console/print.h>
+#include <algorithm>
+#include <limits>
+#include <set>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+  /** \brief Returns the next number of the (splitmix64) random sequence defined by 'state'. Used instead of a shared
+    * generator, so that each sample can draw its own numbers, independently of the thread which processes it. */
+  inline pcl::uint64_t
+  nextRandom (pcl::uint64_t &state)
+  {
+    state += 0x9E3779B97F4A7C15ULL;
+    pcl::uint64_t z = state;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (z ^ (z >> 31));
+  }
+}
+
+//===========================================================================================================================================================================================
 
 pcl::recognition::ObjRecRANSAC::ObjRecRANSAC (float pair_width, float voxel_size, float /*fraction_of_pairs_in_hash_table*/)
-: pair_width_(pair_width), model_library_(pair_width, voxel_size)
+: pair_width_ (pair_width),
+  voxel_size_ (voxel_size),
+  visibility_ (0.2f),
+  relative_object_size_ (0.05f),
+  threads_ (0),
+  seed_ (0),
+  model_library_ (pair_width, voxel_size)
 {
 }
 
 //===========================================================================================================================================================================================
 
 void
-pcl::recognition::ObjRecRANSAC::recognize (const pcl::PointCloud<Eigen::Vector3d>& /*scene*/, const pcl::PointCloud<Eigen::Vector3d>& /*normals*/, std::list<ObjRecRANSAC::Output>& /*recognized_objects*/)
+pcl::recognition::ObjRecRANSAC::recognize (const PointCloudIn& scene, const PointCloudN& normals, std::list<ObjRecRANSAC::Output>& recognized_objects, double success_probability)
 {
-  // to be implemented
+  recognized_objects.clear ();
+
+  if ( scene.size () != normals.size () )
+  {
+    pcl::console::print_error ("[pcl::recognition::ObjRecRANSAC::recognize] The scene has %u points but %u normals.\n",
+                               static_cast<unsigned int> (scene.size ()), static_cast<unsigned int> (normals.size ()));
+    return;
+  }
+  if ( scene.empty () )
+    return;
+
+#ifdef OBJ_REC_RANSAC_VERBOSE
+  printf("ObjRecRANSAC::%s(): begin\n", __func__);
+#endif
+
+  // Build the scene octree; its full leaves are both the samples and the support for the hypotheses
+  scene_octree_.build (scene, voxel_size_, &normals);
+
+  int num_iterations = this->computeNumberOfIterations (success_probability);
+
+#ifdef OBJ_REC_RANSAC_VERBOSE
+  printf("\tgenerating hypotheses from %i oriented point pairs ... ", num_iterations); fflush(stdout);
+#endif
+
+  std::vector<Hypothesis> hypotheses;
+  this->generateHypotheses (num_iterations, hypotheses);
+
+#ifdef OBJ_REC_RANSAC_VERBOSE
+  printf("OK (%i accepted)\n\tfiltering hypotheses ... ", static_cast<int> (hypotheses.size ())); fflush(stdout);
+#endif
+
+  this->filterHypotheses (hypotheses, recognized_objects);
+
+#ifdef OBJ_REC_RANSAC_VERBOSE
+  printf("OK\nObjRecRANSAC::%s(): end\n", __func__);
+#endif
 }
 
 //===========================================================================================================================================================================================
 
+int
+pcl::recognition::ObjRecRANSAC::computeNumberOfIterations (double success_probability) const
+{
+  // The probability of drawing an oriented point pair which lies on the smallest object and is matched in the model library
+  double p = static_cast<double> (relative_object_size_)*static_cast<double> (visibility_);
+
+  if ( p <= 0.0 || p >= 1.0 || success_probability <= 0.0 || success_probability >= 1.0 )
+  {
+    pcl::console::print_error ("[pcl::recognition::ObjRecRANSAC::computeNumberOfIterations] Invalid parameters, sampling a single pair.\n");
+    return (1);
+  }
+
+  double num_iterations = ceil (log (1.0 - success_probability)/log (1.0 - p));
+
+  if ( num_iterations > static_cast<double> (std::numeric_limits<int>::max ()) )
+    return (std::numeric_limits<int>::max ());
+
+  return (std::max (1, static_cast<int> (num_iterations)));
+}
+
+//===========================================================================================================================================================================================
+
+void
+pcl::recognition::ObjRecRANSAC::generateHypotheses (int num_iterations, std::vector<Hypothesis>& hypotheses)
+{
+  hypotheses.clear ();
+
+  const vector<ORROctree::Node*>& scene_leaves = scene_octree_.getFullLeaves ();
+  if ( scene_leaves.empty () )
+    return;
+
+  const ModelLibrary::HashTable* hash_table = model_library_.getHashTable ();
+  const float pair_width_eps = model_library_.getPairWidthEps ();
+  const pcl::uint64_t num_scene_leaves = static_cast<pcl::uint64_t> (scene_leaves.size ());
+
+  // The hypothesis pool: every sample writes into its own slot, so the threads never have to synchronize
+  vector<vector<Hypothesis> > pool (num_iterations);
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#endif
+
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(nr_threads) schedule(dynamic, 8)
+#endif
+  for ( int i = 0 ; i < num_iterations ; ++i )
+  {
+    // Each seed selects its own, widely spaced family of sequences
+    pcl::uint64_t random_state = static_cast<pcl::uint64_t> (seed_) * 0xD1B54A32D192ED03ULL + static_cast<pcl::uint64_t> (i);
+
+    // Draw the first point of the pair
+    ORROctree::Node* leaf1 = scene_leaves[nextRandom (random_state) % num_scene_leaves];
+    const float *p1 = leaf1->getData ()->getPoint (), *n1 = leaf1->getData ()->getNormal ();
+
+    // Draw the second point among the ones at distance 'pair_width_' to the first one
+    list<ORROctree::Node*> candidates;
+    scene_octree_.getFullLeavesIntersectedBySphere (p1, pair_width_, candidates);
+    if ( candidates.empty () )
+      continue;
+
+    list<ORROctree::Node*>::iterator candidate = candidates.begin ();
+    advance (candidate, nextRandom (random_state) % static_cast<pcl::uint64_t> (candidates.size ()));
+    ORROctree::Node* leaf2 = *candidate;
+    if ( leaf2 == leaf1 )
+      continue;
+
+    const float *p2 = leaf2->getData ()->getPoint (), *n2 = leaf2->getData ()->getNormal ();
+
+    // Look up the model pairs with a similar signature
+    float key[3];
+    compute_oriented_point_pair_signature (p1, n1, p2, n2, key);
+    if ( key[0] != key[0] || key[1] != key[1] || key[2] != key[2] ) // degenerate pair (or missing normals)
+      continue;
+
+    const ModelLibrary::HashTableCell* cell = hash_table->getVoxel (key);
+    if ( !cell )
+      continue;
+
+    const float scene_pair_width = vecDistance3 (p1, p2);
+
+    for ( ModelLibrary::HashTableCell::const_iterator model = cell->begin () ; model != cell->end () ; ++model )
+    {
+      for ( ModelLibrary::node_data_pair_list::const_iterator pair = model->second.begin () ; pair != model->second.end () ; ++pair )
+      {
+        const ORROctree::Node::Data *a1 = pair->first, *a2 = pair->second;
+
+        if ( fabs (vecDistance3 (a1->getPoint (), a2->getPoint ()) - scene_pair_width) > pair_width_eps )
+          continue;
+
+        Hypothesis hypothesis;
+        hypothesis.obj_model_ = model->first;
+
+        if ( !computeRigidTransform (a1->getPoint (), a1->getNormal (), a2->getPoint (), a2->getNormal (), p1, n1, p2, n2, hypothesis.rigid_transform_) )
+          continue;
+
+        if ( !this->testHypothesis (hypothesis) )
+          continue;
+
+        // The scene pair lies on a single object, so keep only the best pose of each model for this sample
+        vector<Hypothesis>::iterator best = pool[i].begin ();
+        while ( best != pool[i].end () && best->obj_model_ != hypothesis.obj_model_ )
+          ++best;
+
+        if ( best == pool[i].end () )
+          pool[i].push_back (hypothesis);
+        else if ( hypothesis.match_confidence_ > best->match_confidence_ )
+          *best = hypothesis;
+      }
+    }
+  }
+
+  // Collect the accepted hypotheses in sample order
+  size_t num_hypotheses = 0;
+  for ( int i = 0 ; i < num_iterations ; ++i )
+    num_hypotheses += pool[i].size ();
+
+  hypotheses.reserve (num_hypotheses);
+  for ( int i = 0 ; i < num_iterations ; ++i )
+    hypotheses.insert (hypotheses.end (), pool[i].begin (), pool[i].end ());
+}
+
+//===========================================================================================================================================================================================
+
+bool
+pcl::recognition::ObjRecRANSAC::testHypothesis (Hypothesis& hypothesis) const
+{
+  const vector<ORROctree::Node*>& model_leaves = hypothesis.obj_model_->getOctree ().getFullLeaves ();
+  const int num_model_leaves = static_cast<int> (model_leaves.size ());
+  if ( num_model_leaves == 0 )
+    return (false);
+
+  const float *T = hypothesis.rigid_transform_;
+  float q[3];
+
+  // Pre-test on a few evenly spread model leaves: most of the hypotheses are wrong and get rejected here. Only half of
+  // the visibility is required, to account for the sampling.
+  const int num_probes = std::min (num_model_leaves, 64), probe_step = num_model_leaves/num_probes;
+  int num_probes_matched = 0;
+
+  for ( int i = 0 ; i < num_probes ; ++i )
+  {
+    const float *p = model_leaves[i*probe_step]->getData ()->getPoint ();
+    q[0] = T[0]*p[0] + T[1]*p[1] + T[2]*p[2] + T[9];
+    q[1] = T[3]*p[0] + T[4]*p[1] + T[5]*p[2] + T[10];
+    q[2] = T[6]*p[0] + T[7]*p[1] + T[8]*p[2] + T[11];
+
+    if ( scene_octree_.getFullLeaf (q) )
+      ++num_probes_matched;
+  }
+
+  if ( static_cast<float> (num_probes_matched) < 0.5f*visibility_*static_cast<float> (num_probes) )
+    return (false);
+
+  const int num_needed = static_cast<int> (ceil (visibility_*static_cast<float> (num_model_leaves)));
+  int num_matched = 0;
+
+  hypothesis.explained_leaves_.clear ();
+
+  for ( int i = 0 ; i < num_model_leaves ; ++i )
+  {
+    const float *p = model_leaves[i]->getData ()->getPoint ();
+    q[0] = T[0]*p[0] + T[1]*p[1] + T[2]*p[2] + T[9];
+    q[1] = T[3]*p[0] + T[4]*p[1] + T[5]*p[2] + T[10];
+    q[2] = T[6]*p[0] + T[7]*p[1] + T[8]*p[2] + T[11];
+
+    const ORROctree::Node* scene_leaf = scene_octree_.getFullLeaf (q);
+    if ( scene_leaf )
+    {
+      ++num_matched;
+      hypothesis.explained_leaves_.push_back (scene_leaf);
+    }
+    // Stop as soon as the hypothesis can not reach the required visibility anymore
+    else if ( num_matched + (num_model_leaves - i - 1) < num_needed )
+      return (false);
+  }
+
+  hypothesis.match_confidence_ = static_cast<float> (num_matched)/static_cast<float> (num_model_leaves);
+
+  sort (hypothesis.explained_leaves_.begin (), hypothesis.explained_leaves_.end ());
+  hypothesis.explained_leaves_.erase (unique (hypothesis.explained_leaves_.begin (), hypothesis.explained_leaves_.end ()),
+                                      hypothesis.explained_leaves_.end ());
+
+  return (num_matched >= num_needed);
+}
+
+//===========================================================================================================================================================================================
+
+void
+pcl::recognition::ObjRecRANSAC::filterHypotheses (std::vector<Hypothesis>& hypotheses, std::list<ObjRecRANSAC::Output>& recognized_objects) const
+{
+  // Sort by decreasing match confidence; ties are broken by the position in the pool, which keeps the result deterministic
+  vector<pair<float,int> > order (hypotheses.size ());
+  for ( size_t i = 0 ; i < hypotheses.size () ; ++i )
+    order[i] = pair<float,int> (-hypotheses[i].match_confidence_, static_cast<int> (i));
+  sort (order.begin (), order.end ());
+
+  // Two hypotheses are in conflict if they explain the same scene leaves. Accept the best ones first and reject every
+  // hypothesis which shares more than 'max_shared_fraction' of its scene support with the already accepted ones. Slightly
+  // misaligned copies of an accepted hypothesis share well above this fraction, touching objects far below it.
+  const float max_shared_fraction = 0.2f;
+  set<const ORROctree::Node*> explained_leaves;
+
+  for ( size_t i = 0 ; i < order.size () ; ++i )
+  {
+    const Hypothesis& hypothesis = hypotheses[order[i].second];
+
+    size_t num_conflicts = 0;
+    for ( vector<const ORROctree::Node*>::const_iterator leaf = hypothesis.explained_leaves_.begin () ; leaf != hypothesis.explained_leaves_.end () ; ++leaf )
+      if ( explained_leaves.find (*leaf) != explained_leaves.end () )
+        ++num_conflicts;
+
+    if ( static_cast<float> (num_conflicts) > max_shared_fraction*static_cast<float> (hypothesis.explained_leaves_.size ()) )
+      continue;
+
+    explained_leaves.insert (hypothesis.explained_leaves_.begin (), hypothesis.explained_leaves_.end ());
+
+    const float *T = hypothesis.rigid_transform_;
+    Eigen::Matrix4f rigid_transform;
+    rigid_transform << T[0], T[1], T[2], T[9],
+                       T[3], T[4], T[5], T[10],
+                       T[6], T[7], T[8], T[11],
+                       0.0f, 0.0f, 0.0f, 1.0f;
+
+    recognized_objects.push_back (ObjRecRANSAC::Output (hypothesis.obj_model_->obj_name_, rigid_transform, hypothesis.match_confidence_));
+  }
+}
+
+//===========================================================================================================================================================================================
+
+bool
+pcl::recognition::ObjRecRANSAC::computeRigidTransform (const float *a1, const float *a1_n, const float *a2, const float *a2_n,
+                                                       const float *b1, const float *b1_n, const float *b2, const float *b2_n, float rigid_transform[12])
+{
+  // Build an orthonormal frame for each pair: the first axis goes from the first to the second point, the second one is
+  // the (orthogonalized) mean normal and the third one completes the frame
+  float frame_a[9], frame_b[9];
+  const float *points[4] = {a1, a2, b1, b2}, *normals[4] = {a1_n, a2_n, b1_n, b2_n};
+  float *frames[2] = {frame_a, frame_b};
+
+  for ( int k = 0 ; k < 2 ; ++k )
+  {
+    const float *p1 = points[2*k], *p2 = points[2*k+1], *n1 = normals[2*k], *n2 = normals[2*k+1];
+    float *x = frames[k], *y = frames[k] + 3, *z = frames[k] + 6;
+
+    vecDiff3 (p2, p1, x);
+    float len = vecLength3 (x);
+    if ( len <= std::numeric_limits<float>::epsilon () )
+      return (false);
+    vecMult3 (x, 1.0f/len);
+
+    y[0] = n1[0] + n2[0]; y[1] = n1[1] + n2[1]; y[2] = n1[2] + n2[2];
+    float dot = vecDot3 (x, y);
+    y[0] -= dot*x[0]; y[1] -= dot*x[1]; y[2] -= dot*x[2];
+    len = vecLength3 (y);
+    if ( len <= 1e-4f )
+      return (false);
+    vecMult3 (y, 1.0f/len);
+
+    z[0] = x[1]*y[2] - x[2]*y[1];
+    z[1] = x[2]*y[0] - x[0]*y[2];
+    z[2] = x[0]*y[1] - x[1]*y[0];
+  }
+
+  // R = F_b * F_a^T, where the frame axes are the columns of F
+  for ( int r = 0 ; r < 3 ; ++r )
+    for ( int c = 0 ; c < 3 ; ++c )
+      rigid_transform[3*r + c] = frame_b[r]*frame_a[c] + frame_b[3 + r]*frame_a[3 + c] + frame_b[6 + r]*frame_a[6 + c];
+
+  // t = center_b - R*center_a
+  float center_a[3] = {0.5f*(a1[0] + a2[0]), 0.5f*(a1[1] + a2[1]), 0.5f*(a1[2] + a2[2])};
+  float center_b[3] = {0.5f*(b1[0] + b2[0]), 0.5f*(b1[1] + b2[1]), 0.5f*(b1[2] + b2[2])};
+  for ( int r = 0 ; r < 3 ; ++r )
+    rigid_transform[9 + r] = center_b[r] - vecDot3 (rigid_transform + 3*r, center_a);
+
+  return (true);
+}
+
+//===========================================================================================================================================================================================
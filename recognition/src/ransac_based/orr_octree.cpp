@@ -289,6 +289,34 @@ pcl::recognition::ORROctree::Node::createChildren()
 
 //====================================================================================================
 
+pcl::recognition::ORROctree::Node*
+pcl::recognition::ORROctree::getFullLeaf (const float* p) const
+{
+  if ( !root_ || p[0] < bounds_[0] || p[0] >= bounds_[1] || p[1] < bounds_[2] || p[1] >= bounds_[3] || p[2] < bounds_[4] || p[2] >= bounds_[5] )
+    return NULL;
+
+  ORROctree::Node* node = root_;
+  const float *c;
+  int id;
+
+  // Go down to the leaf containing p
+  while ( node->hasChildren () )
+  {
+    c = node->getCenter ();
+    id = 0;
+
+    if ( p[0] >= c[0] ) id |= 4;
+    if ( p[1] >= c[1] ) id |= 2;
+    if ( p[2] >= c[2] ) id |= 1;
+
+    node = node->getChild (id);
+  }
+
+  return (node->getData () ? node : NULL);
+}
+
+//====================================================================================================
+
 void
 pcl::recognition::ORROctree::getFullLeavesIntersectedBySphere (const float* p, float radius, std::list<ORROctree::Node*>& out)
 {
@@ -41,11 +41,17 @@
 #include <pcl/common/vector_average.h>
 #include <pcl/Vertices.h>
 #include <pcl/kdtree/kdtree_flann.h>
+#include <algorithm>
+#include <limits>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT>
 pcl::MarchingCubes<PointNT>::MarchingCubes () 
-: min_p_ (), max_p_ (), percentage_extend_grid_ (), iso_level_ ()
+: grid_blocks_ (), grid_block_keys_ (), use_sparse_grid_ (false), block_size_ (8), block_dilation_ (1), threads_ (0)
+, min_p_ (), max_p_ (), percentage_extend_grid_ (), iso_level_ ()
 {
 }
 
@@ -216,10 +222,287 @@ pcl::MarchingCubes<PointNT>::getGridValue (Eigen::Vector3i pos)
   if (pos[2] < 0 || pos[2] >= res_z_)
     return -1.0f;
 
+  if (use_sparse_grid_)
+    return (getSparseGridValue (pos));
+
   return grid_[pos[0]*res_y_*res_z_ + pos[1]*res_z_ + pos[2]];
 }
 
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> float
+pcl::MarchingCubes<PointNT>::getSignedDistance (const Eigen::Vector3f &)
+{
+  return (std::numeric_limits<float>::quiet_NaN ());
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> float
+pcl::MarchingCubes<PointNT>::getSparseGridValue (const Eigen::Vector3i &pos)
+{
+  if (pos[0] < 0 || pos[1] < 0 || pos[2] < 0)
+    return (std::numeric_limits<float>::quiet_NaN ());
+
+  typename GridBlocks::const_iterator it = grid_blocks_.find (getBlockKey (pos[0] / block_size_,
+                                                                          pos[1] / block_size_,
+                                                                          pos[2] / block_size_));
+  if (it == grid_blocks_.end ())
+    return (std::numeric_limits<float>::quiet_NaN ());
+
+  int lx = pos[0] % block_size_, ly = pos[1] % block_size_, lz = pos[2] % block_size_;
+  return (it->second[(lx * block_size_ + ly) * block_size_ + lz]);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::allocateSparseGrid ()
+{
+  grid_blocks_.clear ();
+  grid_block_keys_.clear ();
+
+  const int nr_blocks_x = (res_x_ + block_size_ - 1) / block_size_;
+  const int nr_blocks_y = (res_y_ + block_size_ - 1) / block_size_;
+  const int nr_blocks_z = (res_z_ + block_size_ - 1) / block_size_;
+  const Eigen::Vector4f size = max_p_ - min_p_;
+
+  // Collect the blocks containing at least one input point
+  std::vector<uint64_t> occupied;
+  occupied.reserve (input_->points.size ());
+  for (size_t i = 0; i < input_->points.size (); ++i)
+  {
+    const PointNT &p = input_->points[i];
+    if (!pcl_isfinite (p.x) || !pcl_isfinite (p.y) || !pcl_isfinite (p.z))
+      continue;
+    int bx = static_cast<int> ((p.x - min_p_[0]) / size[0] * float (res_x_)) / block_size_;
+    int by = static_cast<int> ((p.y - min_p_[1]) / size[1] * float (res_y_)) / block_size_;
+    int bz = static_cast<int> ((p.z - min_p_[2]) / size[2] * float (res_z_)) / block_size_;
+    bx = (std::max) (0, (std::min) (bx, nr_blocks_x - 1));
+    by = (std::max) (0, (std::min) (by, nr_blocks_y - 1));
+    bz = (std::max) (0, (std::min) (bz, nr_blocks_z - 1));
+    occupied.push_back (getBlockKey (bx, by, bz));
+  }
+  std::sort (occupied.begin (), occupied.end ());
+  occupied.erase (std::unique (occupied.begin (), occupied.end ()), occupied.end ());
+
+  // Dilate the occupied blocks, so that the surface near the points is fully contained in the grid
+  const uint64_t mask = (static_cast<uint64_t> (1) << 21) - 1;
+  for (size_t i = 0; i < occupied.size (); ++i)
+  {
+    int bx = static_cast<int> (occupied[i] >> 42),
+        by = static_cast<int> ((occupied[i] >> 21) & mask),
+        bz = static_cast<int> (occupied[i] & mask);
+    for (int dx = (std::max) (0, bx - block_dilation_); dx <= (std::min) (nr_blocks_x - 1, bx + block_dilation_); ++dx)
+      for (int dy = (std::max) (0, by - block_dilation_); dy <= (std::min) (nr_blocks_y - 1, by + block_dilation_); ++dy)
+        for (int dz = (std::max) (0, bz - block_dilation_); dz <= (std::min) (nr_blocks_z - 1, bz + block_dilation_); ++dz)
+          grid_blocks_[getBlockKey (dx, dy, dz)];
+  }
+
+  grid_block_keys_.reserve (grid_blocks_.size ());
+  const size_t block_volume = static_cast<size_t> (block_size_ * block_size_ * block_size_);
+  for (typename GridBlocks::iterator it = grid_blocks_.begin (); it != grid_blocks_.end (); ++it)
+  {
+    it->second.assign (block_volume, std::numeric_limits<float>::quiet_NaN ());
+    grid_block_keys_.push_back (it->first);
+  }
+  std::sort (grid_block_keys_.begin (), grid_block_keys_.end ());
+
+  PCL_DEBUG ("[pcl::%s::allocateSparseGrid] Allocated %lu blocks of %d^3 voxels.\n",
+             getClassName ().c_str (), grid_block_keys_.size (), block_size_);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::voxelizeSparseGrid ()
+{
+  // Resolve the blocks beforehand, the hash map must not be touched from the threads
+  std::vector<std::vector<float>*> blocks (grid_block_keys_.size ());
+  for (size_t b = 0; b < grid_block_keys_.size (); ++b)
+    blocks[b] = &grid_blocks_[grid_block_keys_[b]];
+
+  const uint64_t mask = (static_cast<uint64_t> (1) << 21) - 1;
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for schedule (dynamic) num_threads (nr_threads)
+#endif
+  for (int b = 0; b < static_cast<int> (blocks.size ()); ++b)
+  {
+    const int x0 = static_cast<int> (grid_block_keys_[b] >> 42) * block_size_,
+              y0 = static_cast<int> ((grid_block_keys_[b] >> 21) & mask) * block_size_,
+              z0 = static_cast<int> (grid_block_keys_[b] & mask) * block_size_;
+    std::vector<float> &block = *blocks[b];
+    Eigen::Vector3f point;
+    for (int lx = 0; lx < block_size_ && x0 + lx < res_x_; ++lx)
+      for (int ly = 0; ly < block_size_ && y0 + ly < res_y_; ++ly)
+        for (int lz = 0; lz < block_size_ && z0 + lz < res_z_; ++lz)
+        {
+          getGridPointPosition (x0 + lx, y0 + ly, z0 + lz, point);
+          block[(lx * block_size_ + ly) * block_size_ + lz] = getSignedDistance (point);
+        }
+  }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> void
+pcl::MarchingCubes<PointNT>::polygonizeSparseGrid (pcl::PointCloud<PointNT> &points,
+                                                   std::vector<pcl::Vertices> &polygons)
+{
+  // Cube corner offsets and the two corners of each cube edge, in the order used by the tables
+  static const int corner_offsets[8][3] = { {0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1},
+                                            {0, 1, 0}, {1, 1, 0}, {1, 1, 1}, {0, 1, 1} };
+  static const int edge_corners[12][2] = { {0, 1}, {1, 2}, {2, 3}, {3, 0}, {4, 5}, {5, 6},
+                                           {6, 7}, {7, 4}, {0, 4}, {1, 5}, {2, 6}, {3, 7} };
+
+  const int nr_blocks = static_cast<int> (grid_block_keys_.size ());
+  const int padded_size = block_size_ + 1;
+  const uint64_t mask = (static_cast<uint64_t> (1) << 21) - 1;
+
+  // Per block results: the vertices, identified by the global id of the edge they lie on, and the triangles
+  std::vector<std::vector<uint64_t> > block_edge_ids (nr_blocks);
+  std::vector<std::vector<Eigen::Vector3f> > block_vertices (nr_blocks);
+  std::vector<std::vector<int> > block_triangles (nr_blocks);
+
+#ifdef _OPENMP
+  const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#pragma omp parallel for schedule (dynamic) num_threads (nr_threads)
+#endif
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    const int x0 = static_cast<int> (grid_block_keys_[b] >> 42) * block_size_,
+              y0 = static_cast<int> ((grid_block_keys_[b] >> 21) & mask) * block_size_,
+              z0 = static_cast<int> (grid_block_keys_[b] & mask) * block_size_;
+
+    // Gather the block values, padded with one layer from the neighboring blocks
+    const std::vector<float> &block = grid_blocks_.find (grid_block_keys_[b])->second;
+    std::vector<float> values (padded_size * padded_size * padded_size);
+    for (int lx = 0; lx < padded_size; ++lx)
+      for (int ly = 0; ly < padded_size; ++ly)
+        for (int lz = 0; lz < padded_size; ++lz)
+        {
+          float &value = values[(lx * padded_size + ly) * padded_size + lz];
+          if (lx < block_size_ && ly < block_size_ && lz < block_size_)
+            value = block[(lx * block_size_ + ly) * block_size_ + lz];
+          else
+            value = getSparseGridValue (Eigen::Vector3i (x0 + lx, y0 + ly, z0 + lz));
+        }
+
+    boost::unordered_map<uint64_t, int> edge_to_vertex;
+    std::vector<uint64_t> &edge_ids = block_edge_ids[b];
+    std::vector<Eigen::Vector3f> &vertices = block_vertices[b];
+    std::vector<int> &triangles = block_triangles[b];
+
+    for (int lx = 0; lx < block_size_; ++lx)
+    {
+      int x = x0 + lx;
+      if (x < 1 || x >= res_x_ - 1)
+        continue;
+      for (int ly = 0; ly < block_size_; ++ly)
+      {
+        int y = y0 + ly;
+        if (y < 1 || y >= res_y_ - 1)
+          continue;
+        for (int lz = 0; lz < block_size_; ++lz)
+        {
+          int z = z0 + lz;
+          if (z < 1 || z >= res_z_ - 1)
+            continue;
+
+          float leaf[8];
+          bool valid = true;
+          int cubeindex = 0;
+          for (int c = 0; c < 8; ++c)
+          {
+            leaf[c] = values[((lx + corner_offsets[c][0]) * padded_size + ly + corner_offsets[c][1]) * padded_size +
+                             lz + corner_offsets[c][2]];
+            if (pcl_isnan (leaf[c]))
+            {
+              valid = false;
+              break;
+            }
+            if (leaf[c] < iso_level_)
+              cubeindex |= 1 << c;
+          }
+          // Cube is not fully allocated, or entirely in/out of the surface
+          if (!valid || edgeTable[cubeindex] == 0)
+            continue;
+
+          int edge_vertex[12];
+          for (int e = 0; e < 12; ++e)
+          {
+            if (!(edgeTable[cubeindex] & (1 << e)))
+              continue;
+            // Orient the edge from its lower to its upper corner, so that both cells sharing it produce the same vertex
+            int c1 = edge_corners[e][0], c2 = edge_corners[e][1];
+            int axis = 0;
+            while (corner_offsets[c1][axis] == corner_offsets[c2][axis])
+              ++axis;
+            if (corner_offsets[c1][axis] > corner_offsets[c2][axis])
+              std::swap (c1, c2);
+
+            const uint64_t edge_id = (static_cast<uint64_t> (x + corner_offsets[c1][0]) * res_y_ * res_z_ +
+                                      static_cast<uint64_t> (y + corner_offsets[c1][1]) * res_z_ +
+                                      static_cast<uint64_t> (z + corner_offsets[c1][2])) * 3 + axis;
+            boost::unordered_map<uint64_t, int>::const_iterator it = edge_to_vertex.find (edge_id);
+            if (it != edge_to_vertex.end ())
+            {
+              edge_vertex[e] = it->second;
+              continue;
+            }
+
+            Eigen::Vector3f p1, p2, vertex;
+            getGridPointPosition (x + corner_offsets[c1][0], y + corner_offsets[c1][1], z + corner_offsets[c1][2], p1);
+            getGridPointPosition (x + corner_offsets[c2][0], y + corner_offsets[c2][1], z + corner_offsets[c2][2], p2);
+            interpolateEdge (p1, p2, leaf[c1], leaf[c2], vertex);
+
+            edge_vertex[e] = static_cast<int> (vertices.size ());
+            edge_to_vertex[edge_id] = edge_vertex[e];
+            edge_ids.push_back (edge_id);
+            vertices.push_back (vertex);
+          }
+
+          for (int i = 0; triTable[cubeindex][i] != -1; ++i)
+            triangles.push_back (edge_vertex[triTable[cubeindex][i]]);
+        }
+      }
+    }
+  }
+
+  // Weld the vertices shared between blocks, visiting the blocks in key order to get a deterministic output
+  points.clear ();
+  polygons.clear ();
+  boost::unordered_map<uint64_t, int> edge_to_point;
+  std::vector<int> local_to_global;
+  for (int b = 0; b < nr_blocks; ++b)
+  {
+    local_to_global.resize (block_vertices[b].size ());
+    for (size_t v = 0; v < block_vertices[b].size (); ++v)
+    {
+      std::pair<boost::unordered_map<uint64_t, int>::iterator, bool> res =
+          edge_to_point.insert (std::make_pair (block_edge_ids[b][v], static_cast<int> (points.size ())));
+      local_to_global[v] = res.first->second;
+      if (res.second)
+      {
+        PointNT p;
+        p.getVector3fMap () = block_vertices[b][v];
+        points.push_back (p);
+      }
+    }
+
+    for (size_t t = 0; t + 2 < block_triangles[b].size (); t += 3)
+    {
+      pcl::Vertices v;
+      v.vertices.resize (3);
+      for (int j = 0; j < 3; ++j)
+        v.vertices[j] = local_to_global[block_triangles[b][t + j]];
+      polygons.push_back (v);
+    }
+  }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> void
 pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PolygonMesh &output)
@@ -233,6 +516,14 @@ pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PolygonMesh &output)
     return;
   }
 
+  if (use_sparse_grid_)
+  {
+    pcl::PointCloud<PointNT> points;
+    performReconstruction (points, output.polygons);
+    pcl::toROSMsg (points, output.cloud);
+    return;
+  }
+
   // Create grid
   grid_ = std::vector<float> (res_x_*res_y_*res_z_, 0.0f);
 
@@ -288,6 +579,40 @@ pcl::MarchingCubes<PointNT>::performReconstruction (pcl::PointCloud<PointNT> &po
     return;
   }
 
+  if (use_sparse_grid_)
+  {
+    if (!isSparseGridSupported ())
+    {
+      PCL_ERROR ("[pcl::%s::performReconstruction] The sparse grid is not supported by this class!\n", getClassName ().c_str ());
+      points.width = points.height = 0;
+      points.points.clear ();
+      polygons.clear ();
+      return;
+    }
+    if (block_size_ <= 0 || block_dilation_ < 0)
+    {
+      PCL_ERROR ("[pcl::%s::performReconstruction] Invalid sparse block size %d or dilation %d!\n", getClassName ().c_str (), block_size_, block_dilation_);
+      points.width = points.height = 0;
+      points.points.clear ();
+      polygons.clear ();
+      return;
+    }
+
+    // Only the blocks around the input points are allocated, the dense grid is not used
+    grid_.clear ();
+    tree_->setInputCloud (input_);
+    getBoundingBox ();
+    allocateSparseGrid ();
+
+    // The child class fills the sparse grid through voxelizeSparseGrid ()
+    voxelizeData ();
+
+    polygonizeSparseGrid (points, polygons);
+    grid_blocks_.clear ();
+    grid_block_keys_.clear ();
+    return;
+  }
+
   // Create grid
   grid_ = std::vector<float> (res_x_*res_y_*res_z_, 0.0f);
 
@@ -49,7 +49,9 @@
 template <typename PointNT>
 pcl::MarchingCubesRBF<PointNT>::MarchingCubesRBF ()
   : MarchingCubes<PointNT> (),
-    off_surface_epsilon_ (0.1f)
+    off_surface_epsilon_ (0.1f),
+    weights_ (),
+    centers_ ()
 {
 }
 
@@ -89,35 +91,48 @@ pcl::MarchingCubesRBF<PointNT>::voxelizeData ()
   // Solve_linear_system (M, d, w);
   w = M.fullPivLu ().solve (d);
 
-  std::vector<double> weights (2*N);
-  std::vector<Eigen::Vector3d> centers (2*N);
+  weights_.resize (2*N);
+  centers_.resize (2*N);
   for (unsigned int i = 0; i < N; ++i)
   {
-    centers[i] = Eigen::Vector3f (input_->points[i].getVector3fMap ()).cast<double> ();
-    centers[i + N] = Eigen::Vector3f (input_->points[i].getVector3fMap ()).cast<double> () + Eigen::Vector3f (input_->points[i].getNormalVector3fMap ()).cast<double> () * off_surface_epsilon_;
-    weights[i] = w (i, 0);
-    weights[i + N] = w (i + N, 0);
+    centers_[i] = Eigen::Vector3f (input_->points[i].getVector3fMap ()).cast<double> ();
+    centers_[i + N] = Eigen::Vector3f (input_->points[i].getVector3fMap ()).cast<double> () + Eigen::Vector3f (input_->points[i].getNormalVector3fMap ()).cast<double> () * off_surface_epsilon_;
+    weights_[i] = w (i, 0);
+    weights_[i + N] = w (i + N, 0);
+  }
+
+  if (use_sparse_grid_)
+  {
+    this->voxelizeSparseGrid ();
+    return;
   }
 
   for (int x = 0; x < res_x_; ++x)
     for (int y = 0; y < res_y_; ++y)
       for (int z = 0; z < res_z_; ++z)
       {
-        Eigen::Vector3d point;
-        point[0] = min_p_[0] + (max_p_[0] - min_p_[0]) * float (x) / float (res_x_);
-        point[1] = min_p_[1] + (max_p_[1] - min_p_[1]) * float (y) / float (res_y_);
-        point[2] = min_p_[2] + (max_p_[2] - min_p_[2]) * float (z) / float (res_z_);
-
-        double f = 0.0;
-        std::vector<double>::const_iterator w_it (weights.begin());
-        for (std::vector<Eigen::Vector3d>::const_iterator c_it = centers.begin ();
-             c_it != centers.end (); ++c_it, ++w_it)
-          f += *w_it * kernel (*c_it, point);
-
-        grid_[x * res_y_*res_z_ + y * res_z_ + z] = float (f);
+        Eigen::Vector3f point;
+        this->getGridPointPosition (x, y, z, point);
+
+        grid_[x * res_y_*res_z_ + y * res_z_ + z] = getSignedDistance (point);
       }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointNT> float
+pcl::MarchingCubesRBF<PointNT>::getSignedDistance (const Eigen::Vector3f &point)
+{
+  Eigen::Vector3d p = point.cast<double> ();
+
+  double f = 0.0;
+  std::vector<double>::const_iterator w_it (weights_.begin());
+  for (std::vector<Eigen::Vector3d>::const_iterator c_it = centers_.begin ();
+       c_it != centers_.end (); ++c_it, ++w_it)
+    f += *w_it * kernel (*c_it, p);
+
+  return (float (f));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointNT> double
 pcl::MarchingCubesRBF<PointNT>::kernel (Eigen::Vector3d c, Eigen::Vector3d x)
@@ -427,10 +427,77 @@ namespace pcl
       getPercentageExtendGrid ()
       { return percentage_extend_grid_; }
 
+      /** \brief Method that sets whether a sparse, block-hashed grid should be used instead of the dense one. Only the
+        * blocks containing input points (and their neighbors, see setSparseBlockDilation ()) are allocated, filled and
+        * polygonized, in parallel. Vertices on shared cell edges, including those across block seams, are welded, so
+        * the resultant mesh is indexed rather than a triangle soup.
+        * \param[in] use_sparse_grid true if the sparse grid should be used, false for the dense grid (default)
+        */
+      inline void
+      setUseSparseGrid (bool use_sparse_grid)
+      { use_sparse_grid_ = use_sparse_grid; }
+
+      /** \brief Method that returns whether the sparse, block-hashed grid is used. */
+      inline bool
+      getUseSparseGrid ()
+      { return (use_sparse_grid_); }
+
+      /** \brief Method that sets the edge length of a sparse grid block, in voxels.
+        * \param[in] block_size the number of voxels along each edge of a block (default 8)
+        */
+      inline void
+      setSparseBlockSize (int block_size)
+      { block_size_ = block_size; }
+
+      /** \brief Method that returns the edge length of a sparse grid block, in voxels. */
+      inline int
+      getSparseBlockSize ()
+      { return (block_size_); }
+
+      /** \brief Method that sets how many blocks around each block that contains input points are allocated as well.
+        * \param[in] block_dilation the number of neighboring blocks allocated in each direction (default 1)
+        */
+      inline void
+      setSparseBlockDilation (int block_dilation)
+      { block_dilation_ = block_dilation; }
+
+      /** \brief Method that returns how many blocks around each occupied block are allocated as well. */
+      inline int
+      getSparseBlockDilation ()
+      { return (block_dilation_); }
+
+      /** \brief Set the number of threads used to fill and polygonize the sparse grid.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      { threads_ = nr_threads; }
+
     protected:
+      /** \brief Block storage of the sparse grid, hashed by block key. */
+      typedef boost::unordered_map<uint64_t, std::vector<float> > GridBlocks;
+
       /** \brief The data structure storing the 3D grid */
       std::vector<float> grid_;
 
+      /** \brief The allocated blocks of the sparse grid. */
+      GridBlocks grid_blocks_;
+
+      /** \brief The keys of the allocated blocks of the sparse grid, in increasing order. */
+      std::vector<uint64_t> grid_block_keys_;
+
+      /** \brief True if the sparse grid is used instead of the dense one. */
+      bool use_sparse_grid_;
+
+      /** \brief The edge length of a sparse grid block, in voxels. */
+      int block_size_;
+
+      /** \brief The number of neighboring blocks allocated around each occupied block. */
+      int block_dilation_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief The grid resolution */
       int res_x_, res_y_, res_z_;
 
@@ -448,6 +515,64 @@ namespace pcl
       virtual void
       voxelizeData () = 0;
 
+      /** \brief Evaluate the scalar field at a given position. Needed by voxelizeSparseGrid (), which calls it
+        * concurrently from several threads. The default implementation returns NaN.
+        * \param[in] point the position in space
+        */
+      virtual float
+      getSignedDistance (const Eigen::Vector3f &point);
+
+      /** \brief Return true if the class fills the sparse grid, i.e., its voxelizeData () calls voxelizeSparseGrid ()
+        * and it overrides getSignedDistance (). Otherwise performReconstruction () refuses to use the sparse grid.
+        */
+      virtual bool
+      isSparseGridSupported () const
+      { return (false); }
+
+      /** \brief Allocate the blocks of the sparse grid around the input points, with all values set to NaN. */
+      void
+      allocateSparseGrid ();
+
+      /** \brief Fill the allocated blocks of the sparse grid in parallel, using getSignedDistance (). */
+      void
+      voxelizeSparseGrid ();
+
+      /** \brief Run marching cubes over the blocks of the sparse grid in parallel and weld the vertices.
+        * \param[out] points the vertices of the extracted mesh
+        * \param[out] polygons the triangles of the extracted mesh
+        */
+      void
+      polygonizeSparseGrid (pcl::PointCloud<PointNT> &points,
+                            std::vector<pcl::Vertices> &polygons);
+
+      /** \brief Method that returns the scalar value at the given position of the sparse grid, or NaN if the block
+        * containing it was not allocated.
+        * \param[in] pos The 3D position in the grid
+        */
+      float
+      getSparseGridValue (const Eigen::Vector3i &pos);
+
+      /** \brief Compute the key of a sparse grid block from its 3D block index. */
+      inline uint64_t
+      getBlockKey (int bx, int by, int bz) const
+      {
+        return ((static_cast<uint64_t> (bx) << 42) | (static_cast<uint64_t> (by) << 21) | static_cast<uint64_t> (bz));
+      }
+
+      /** \brief Compute the position in space of a grid point.
+        * \param[in] x the grid index along the x-axis
+        * \param[in] y the grid index along the y-axis
+        * \param[in] z the grid index along the z-axis
+        * \param[out] point the position of the grid point
+        */
+      inline void
+      getGridPointPosition (int x, int y, int z, Eigen::Vector3f &point) const
+      {
+        point[0] = min_p_[0] + (max_p_[0] - min_p_[0]) * float (x) / float (res_x_);
+        point[1] = min_p_[1] + (max_p_[1] - min_p_[1]) * float (y) / float (res_y_);
+        point[2] = min_p_[2] + (max_p_[2] - min_p_[2]) * float (z) / float (res_z_);
+      }
+
       /** \brief Interpolate along the voxel edge.
         * \param[in] p1 The first point on the edge
         * \param[in] p2 The second point on the edge
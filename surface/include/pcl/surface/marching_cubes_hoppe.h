@@ -60,6 +60,7 @@ namespace pcl
       using MarchingCubes<PointNT>::res_z_;
       using MarchingCubes<PointNT>::min_p_;
       using MarchingCubes<PointNT>::max_p_;
+      using MarchingCubes<PointNT>::use_sparse_grid_;
 
       typedef typename pcl::PointCloud<PointNT>::Ptr PointCloudPtr;
 
@@ -77,6 +78,17 @@ namespace pcl
       void
       voxelizeData ();
 
+    protected:
+      /** \brief Compute the signed distance to the tangent plane of the nearest input point.
+        * \param[in] point the position in space
+        */
+      float
+      getSignedDistance (const Eigen::Vector3f &point);
+
+      /** \brief The sparse grid is filled through getSignedDistance (). */
+      bool
+      isSparseGridSupported () const
+      { return (true); }
 
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
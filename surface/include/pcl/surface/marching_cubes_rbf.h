@@ -62,6 +62,7 @@ namespace pcl
       using MarchingCubes<PointNT>::res_z_;
       using MarchingCubes<PointNT>::min_p_;
       using MarchingCubes<PointNT>::max_p_;
+      using MarchingCubes<PointNT>::use_sparse_grid_;
 
       typedef typename pcl::PointCloud<PointNT>::Ptr PointCloudPtr;
 
@@ -98,9 +99,26 @@ namespace pcl
       double
       kernel (Eigen::Vector3d c, Eigen::Vector3d x);
 
+      /** \brief Evaluate the radial basis function at a given position.
+        * \param[in] point the position in space
+        */
+      float
+      getSignedDistance (const Eigen::Vector3f &point);
+
+      /** \brief The sparse grid is filled through getSignedDistance (). */
+      bool
+      isSparseGridSupported () const
+      { return (true); }
+
       /** \brief The off-surface displacement value. */
       float off_surface_epsilon_;
 
+      /** \brief The weights of the radial basis functions, computed in voxelizeData (). */
+      std::vector<double> weights_;
+
+      /** \brief The centers of the radial basis functions, computed in voxelizeData (). */
+      std::vector<Eigen::Vector3d> centers_;
+
     public:
       EIGEN_MAKE_ALIGNED_OPERATOR_NEW
   };
@@ -41,10 +41,12 @@
 #include <pcl/point_cloud.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/features/pfh.h>
+#include <pcl/features/pfh_omp.h>
 #include <pcl/features/fpfh.h>
 #include <pcl/features/fpfh_omp.h>
 #include <pcl/features/vfh.h>
 #include <pcl/features/gfpfh.h>
+#include <pcl/features/esf.h>
 #include <pcl/io/pcd_io.h>
 
 using namespace pcl;
@@ -262,6 +264,58 @@ TEST (PCL, PFHEstimation)
   (cloud.makeShared (), normals, test_indices, 125);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PFHEstimationOpenMP)
+{
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  // set parameters
+  n.setInputCloud (cloud.makeShared ());
+  n.setSearchMethod (tree);
+  n.setKSearch (10); // Use 10 nearest neighbors to estimate the normals
+  // estimate
+  n.compute (*normals);
+
+  PFHEstimation<PointXYZ, Normal, PFHSignature125> pfh;
+  pfh.setInputNormals (normals);
+  pfh.setInputCloud (cloud.makeShared ());
+  pfh.setSearchMethod (tree);
+  pfh.setKSearch (30);
+  PointCloud<PFHSignature125> pfhs;
+  pfh.compute (pfhs);
+
+  PFHEstimationOMP<PointXYZ, Normal, PFHSignature125> pfh_omp (4); // instantiate 4 threads
+  pfh_omp.setInputNormals (normals);
+  pfh_omp.setInputCloud (cloud.makeShared ());
+  pfh_omp.setSearchMethod (tree);
+  pfh_omp.setKSearch (30);
+
+  // The shared cache must not change the results, even when it is too small to hold all the pairs
+  for (int run = 0; run < 3; ++run)
+  {
+    pfh_omp.setUseInternalCache (run > 0);
+    if (run == 2)
+      pfh_omp.setMaximumCacheSize (100);
+
+    PointCloud<PFHSignature125> pfhs_omp;
+    pfh_omp.compute (pfhs_omp);
+    ASSERT_EQ (pfhs_omp.points.size (), pfhs.points.size ());
+    for (size_t i = 0; i < pfhs.points.size (); ++i)
+      for (int d = 0; d < 125; ++d)
+        EXPECT_NEAR (pfhs_omp.points[i].histogram[d], pfhs.points[i].histogram[d], 1e-4);
+  }
+
+  // Test results when setIndices and/or setSearchSurface are used
+
+  boost::shared_ptr<vector<int> > test_indices (new vector<int> (0));
+  for (size_t i = 0; i < cloud.size (); i+=3)
+    test_indices->push_back (static_cast<int> (i));
+
+  testIndicesAndSearchSurface<PFHEstimationOMP<PointXYZ, Normal, PFHSignature125>, PointXYZ, Normal, PFHSignature125>
+  (cloud.makeShared (), normals, test_indices, 125);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, FPFHEstimation)
 {
@@ -578,6 +632,46 @@ TEST (PCL, GFPFH)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ESFEstimation)
+{
+  ESFEstimation<PointXYZ, ESFSignature640> esf;
+  esf.setInputCloud (cloud.makeShared ());
+  esf.setSeed (12345);
+
+  // Object
+  PointCloud<ESFSignature640> esf_single, esf_parallel;
+  esf.compute (esf_single);
+  EXPECT_EQ (int (esf_single.points.size ()), 1);
+
+  float sum = 0;
+  for (size_t d = 0; d < 640; ++d)
+    sum += esf_single.points[0].histogram[d];
+  EXPECT_NEAR (sum, 1.0f, 1e-4);
+
+  // The same seed gives the same descriptor, independently of the number of threads (0 selects it automatically)
+  const unsigned int nr_threads[] = {4, 0};
+  for (int run = 0; run < 2; ++run)
+  {
+    esf.setNumberOfThreads (nr_threads[run]);
+    esf.compute (esf_parallel);
+    EXPECT_EQ (int (esf_parallel.points.size ()), 1);
+    for (size_t d = 0; d < 640; ++d)
+      EXPECT_EQ (esf_single.points[0].histogram[d], esf_parallel.points[0].histogram[d]);
+  }
+
+  // A different seed samples different triples
+  PointCloud<ESFSignature640> esf_other_seed;
+  esf.setSeed (54321);
+  esf.compute (esf_other_seed);
+  EXPECT_EQ (int (esf_other_seed.points.size ()), 1);
+  int nr_different_bins = 0;
+  for (size_t d = 0; d < 640; ++d)
+    if (esf_single.points[0].histogram[d] != esf_other_seed.points[0].histogram[d])
+      ++nr_different_bins;
+  EXPECT_GT (nr_different_bins, 0);
+}
+
 #ifndef PCL_ONLY_CORE_POINT_TYPES
   ///////////////////////////////////////////////////////////////////////////////////
   template <typename FeatureEstimation, typename PointT, typename NormalT> void
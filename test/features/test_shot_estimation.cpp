@@ -46,6 +46,8 @@
 #include "pcl/features/shot_lrf.h"
 #include <pcl/features/3dsc.h>
 #include <pcl/features/usc.h>
+#include <pcl/features/3dsc_omp.h>
+#include <pcl/features/usc_omp.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -1039,6 +1041,125 @@ TEST (PCL, USCEstimation)
   testSHOTLocalReferenceFrame<UniqueShapeContext<PointXYZ, ShapeContext1980>, PointXYZ, Normal, ShapeContext1980> (cloud.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, 3DSCEstimationOpenMP)
+{
+  float meshRes = 0.002f;
+  float radius = 20.0f * meshRes;
+  float rmin = radius / 10.0f;
+  float ptDensityRad = radius / 5.0f;
+
+  PointCloud<PointXYZ>::Ptr cloudptr = cloud.makeShared ();
+
+  // Estimate normals first
+  NormalEstimation<PointXYZ, Normal> ne;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  // set parameters
+  ne.setInputCloud (cloudptr);
+  ne.setSearchMethod (tree);
+  ne.setRadiusSearch (radius);
+  // estimate
+  ne.compute (*normals);
+
+  ShapeContext3DEstimation<PointXYZ, Normal, ShapeContext1980> sc3d;
+  sc3d.setInputCloud (cloudptr);
+  sc3d.setInputNormals (normals);
+  sc3d.setSearchMethod (tree);
+  sc3d.setRadiusSearch (radius);
+  sc3d.setMinimalRadius (rmin);
+  sc3d.setPointDensityRadius (ptDensityRad);
+  PointCloud<ShapeContext1980>::Ptr sc3ds (new PointCloud<ShapeContext1980> ());
+  sc3d.compute (*sc3ds);
+
+  // The random X axes are drawn in the same order, so both estimators must agree
+  ShapeContext3DEstimationOMP<PointXYZ, Normal, ShapeContext1980> sc3d_omp (false, 4); // instantiate 4 threads
+  sc3d_omp.setInputCloud (cloudptr);
+  sc3d_omp.setInputNormals (normals);
+  sc3d_omp.setSearchMethod (tree);
+  sc3d_omp.setRadiusSearch (radius);
+  sc3d_omp.setMinimalRadius (rmin);
+  sc3d_omp.setPointDensityRadius (ptDensityRad);
+  PointCloud<ShapeContext1980>::Ptr sc3ds_omp (new PointCloud<ShapeContext1980> ());
+  sc3d_omp.compute (*sc3ds_omp);
+  EXPECT_EQ (sc3ds_omp->size (), cloud.size ());
+
+  EXPECT_NEAR ((*sc3ds_omp)[94].descriptor[88], 55.2712f, 1e-4f);
+  EXPECT_NEAR ((*sc3ds_omp)[108].descriptor[548], 126.141f, 1e-4f);
+  checkDesc<ShapeContext1980> (*sc3ds, *sc3ds_omp);
+
+  // A query point without neighbors on the search surface does not get a random X axis, so the X axes of the
+  // following points must still be the same as the serial ones
+  PointCloud<PointXYZ>::Ptr queries (new PointCloud<PointXYZ> (cloud));
+  queries->points[10].x = queries->points[10].y = queries->points[10].z = 1000.0f;
+
+  ShapeContext3DEstimation<PointXYZ, Normal, ShapeContext1980> sc3d_surface;
+  sc3d_surface.setInputCloud (queries);
+  sc3d_surface.setSearchSurface (cloudptr);
+  sc3d_surface.setInputNormals (normals);
+  sc3d_surface.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+  sc3d_surface.setRadiusSearch (radius);
+  sc3d_surface.setMinimalRadius (rmin);
+  sc3d_surface.setPointDensityRadius (ptDensityRad);
+  sc3d_surface.compute (*sc3ds);
+
+  ShapeContext3DEstimationOMP<PointXYZ, Normal, ShapeContext1980> sc3d_surface_omp (false, 4);
+  sc3d_surface_omp.setInputCloud (queries);
+  sc3d_surface_omp.setSearchSurface (cloudptr);
+  sc3d_surface_omp.setInputNormals (normals);
+  sc3d_surface_omp.setSearchMethod (search::KdTree<PointXYZ>::Ptr (new search::KdTree<PointXYZ>));
+  sc3d_surface_omp.setRadiusSearch (radius);
+  sc3d_surface_omp.setMinimalRadius (rmin);
+  sc3d_surface_omp.setPointDensityRadius (ptDensityRad);
+  sc3d_surface_omp.compute (*sc3ds_omp);
+
+  ASSERT_EQ (sc3ds->size (), sc3ds_omp->size ());
+  EXPECT_TRUE (pcl_isnan ((*sc3ds_omp)[10].descriptor[0]));
+  for (size_t i = 0; i < sc3ds->size (); ++i)
+  {
+    if (i == 10)
+      continue;
+    for (size_t j = 0; j < 1980; ++j)
+      ASSERT_EQ ((*sc3ds)[i].descriptor[j], (*sc3ds_omp)[i].descriptor[j]);
+    for (size_t j = 0; j < 9; ++j)
+      ASSERT_EQ ((*sc3ds)[i].rf[j], (*sc3ds_omp)[i].rf[j]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, USCEstimationOpenMP)
+{
+  float meshRes = 0.002f;
+  float radius = 20.0f * meshRes;
+  float rmin = radius / 10.0f;
+  float ptDensityRad = radius / 5.0f;
+
+  UniqueShapeContext<PointXYZ, ShapeContext1980> uscd;
+  uscd.setInputCloud (cloud.makeShared ());
+  uscd.setSearchMethod (tree);
+  uscd.setRadiusSearch (radius);
+  uscd.setMinimalRadius (rmin);
+  uscd.setPointDensityRadius (ptDensityRad);
+  uscd.setLocalRadius (radius);
+  PointCloud<ShapeContext1980>::Ptr uscds (new PointCloud<ShapeContext1980>);
+  uscd.compute (*uscds);
+
+  UniqueShapeContextOMP<PointXYZ, ShapeContext1980> uscd_omp (4); // instantiate 4 threads
+  uscd_omp.setInputCloud (cloud.makeShared ());
+  uscd_omp.setSearchMethod (tree);
+  uscd_omp.setRadiusSearch (radius);
+  uscd_omp.setMinimalRadius (rmin);
+  uscd_omp.setPointDensityRadius (ptDensityRad);
+  uscd_omp.setLocalRadius (radius);
+  PointCloud<ShapeContext1980>::Ptr uscds_omp (new PointCloud<ShapeContext1980>);
+  uscd_omp.compute (*uscds_omp);
+  EXPECT_EQ (uscds_omp->size (), cloud.size ());
+
+  EXPECT_NEAR ((*uscds_omp)[160].rf[0], -0.97767f, 1e-4f);
+  EXPECT_NEAR ((*uscds_omp)[160].descriptor[56], 53.0597f, 1e-4f);
+  EXPECT_NEAR ((*uscds_omp)[168].descriptor[1563], 128.273f, 1e-4f);
+  checkDesc<ShapeContext1980> (*uscds, *uscds_omp);
+}
+
 #ifndef PCL_ONLY_CORE_POINT_TYPES
   ///////////////////////////////////////////////////////////////////////////////////
   template <typename FeatureEstimation, typename PointT, typename NormalT> void
@@ -42,6 +42,7 @@
 #include <pcl/features/normal_3d.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/features/spin_image.h>
+#include <pcl/features/spin_image_omp.h>
 #include <pcl/features/intensity_spin.h>
 
 using namespace pcl;
@@ -54,6 +55,19 @@ PointCloud<PointXYZ> cloud;
 vector<int> indices;
 KdTreePtr tree;
 
+/** \brief Search method failing with an exception derived from PCLException */
+class FailingKdTree : public search::KdTree<PointXYZ>
+{
+  public:
+    using search::KdTree<PointXYZ>::radiusSearch;
+
+    virtual int
+    radiusSearch (const PointXYZ &, double, std::vector<int> &, std::vector<float> &, unsigned int = 0) const
+    {
+      boost::throw_exception (ComputeFailedException ("Search failed", "test_spin_estimation.cpp", "radiusSearch"));
+    }
+};
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, SpinImageEstimation)
 {
@@ -232,6 +246,73 @@ TEST (PCL, SpinImageEstimation)
   EXPECT_NEAR (spin_images->points[300].histogram[144], 0.272542, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SpinImageEstimationOpenMP)
+{
+  // Estimate normals first
+  double mr = 0.002;
+  NormalEstimation<PointXYZ, Normal> n;
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  // set parameters
+  n.setInputCloud (cloud.makeShared ());
+  boost::shared_ptr<vector<int> > indicesptr (new vector<int> (indices));
+  n.setIndices (indicesptr);
+  n.setSearchMethod (tree);
+  n.setRadiusSearch (20 * mr);
+  n.compute (*normals);
+
+  typedef Histogram<153> SpinImage;
+  SpinImageEstimation<PointXYZ, Normal, SpinImage> spin_est (8, 0.5, 16);
+  spin_est.setInputCloud (cloud.makeShared ());
+  spin_est.setInputNormals (normals);
+  spin_est.setIndices (indicesptr);
+  spin_est.setSearchMethod (tree);
+  spin_est.setRadiusSearch (40*mr);
+
+  SpinImageEstimationOMP<PointXYZ, Normal, SpinImage> spin_est_omp (8, 0.5, 16, 4); // instantiate 4 threads
+  spin_est_omp.setInputCloud (cloud.makeShared ());
+  spin_est_omp.setInputNormals (normals);
+  spin_est_omp.setIndices (indicesptr);
+  spin_est_omp.setSearchMethod (tree);
+  spin_est_omp.setRadiusSearch (40*mr);
+
+  // Rectangular, radial and angular spin-images
+  for (int variant = 0; variant < 3; ++variant)
+  {
+    spin_est.setRadialStructure (variant == 1);
+    spin_est_omp.setRadialStructure (variant == 1);
+    spin_est.setAngularDomain (variant == 2);
+    spin_est_omp.setAngularDomain (variant == 2);
+
+    PointCloud<SpinImage> spin_images, spin_images_omp;
+    spin_est.compute (spin_images);
+    spin_est_omp.compute (spin_images_omp);
+    ASSERT_EQ (spin_images_omp.points.size (), indices.size ());
+    for (size_t i = 0; i < spin_images.points.size (); ++i)
+      for (int d = 0; d < 153; ++d)
+        EXPECT_NEAR (spin_images_omp.points[i].histogram[d], spin_images.points[i].histogram[d], 1e-4);
+  }
+
+  // Errors raised by any thread are forwarded to the caller
+  SpinImageEstimationOMP<PointXYZ, Normal, SpinImage> spin_est_fail (8, 0.5, static_cast<unsigned int> (cloud.size ()) + 1, 4);
+  spin_est_fail.setInputCloud (cloud.makeShared ());
+  spin_est_fail.setInputNormals (normals);
+  spin_est_fail.setSearchMethod (tree);
+  spin_est_fail.setRadiusSearch (40*mr);
+  PointCloud<SpinImage> spin_images_fail;
+  EXPECT_THROW (spin_est_fail.compute (spin_images_fail), PCLException);
+
+  // The exception keeps its type on the way out of the parallel region
+  boost::shared_ptr<FailingKdTree> failing_tree (new FailingKdTree);
+  SpinImageEstimationOMP<PointXYZ, Normal, SpinImage> spin_est_search_fail (8, 0.5, 16, 4);
+  spin_est_search_fail.setInputCloud (cloud.makeShared ());
+  spin_est_search_fail.setInputNormals (normals);
+  spin_est_search_fail.setIndices (indicesptr);
+  spin_est_search_fail.setSearchMethod (failing_tree);
+  spin_est_search_fail.setRadiusSearch (40*mr);
+  EXPECT_THROW (spin_est_search_fail.compute (spin_images_fail), ComputeFailedException);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IntensitySpinEstimation)
 {
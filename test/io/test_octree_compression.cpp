@@ -0,0 +1,210 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <pcl/octree/octree.h>
+#include <pcl/octree/octree_impl.h>
+
+#include <pcl/compression/entropy_range_coder.h>
+#include <pcl/compression/impl/entropy_range_coder.hpp>
+#include <pcl/compression/octree_pointcloud_compression.h>
+#include <pcl/compression/impl/octree_pointcloud_compression.hpp>
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <ctime>
+
+std::string baseline_stream_file;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Chunked_Compression_Test)
+{
+  typedef pcl::PointCloud<pcl::PointXYZRGBA> CloudT;
+
+  const pcl::io::compression_Profiles_e profiles[] = {pcl::io::LOW_RES_ONLINE_COMPRESSION_WITH_COLOR,
+                                                      pcl::io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR,
+                                                      pcl::io::HIGH_RES_ONLINE_COMPRESSION_WITHOUT_COLOR};
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  for (unsigned int p = 0; p < sizeof (profiles) / sizeof (profiles[0]); ++p)
+  {
+    // single stream and chunked encoders/decoders
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> encoderA (profiles[p]);
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> encoderB (profiles[p]);
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoderA (profiles[p]);
+    pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoderB (profiles[p]);
+
+    encoderB.setChunkCount (7);
+    encoderB.setNumberOfThreads (3);
+    decoderB.setNumberOfThreads (2);
+    EXPECT_EQ (encoderB.getChunkCount (), 7u);
+
+    CloudT::Ptr cloud (new CloudT ());
+    cloud->width = 2000;
+    cloud->height = 1;
+    cloud->points.resize (cloud->width);
+    for (size_t i = 0; i < cloud->points.size (); ++i)
+    {
+      cloud->points[i].x = static_cast<float> (0.5 * rand () / RAND_MAX);
+      cloud->points[i].y = static_cast<float> (0.5 * rand () / RAND_MAX);
+      cloud->points[i].z = static_cast<float> (0.2 * rand () / RAND_MAX);
+      cloud->points[i].rgba = static_cast<uint32_t> (rand ()) & 0xFFFFFF;
+    }
+
+    // an I-frame followed by P-frames of a slowly moving cloud
+    for (unsigned int frame = 0; frame < 4; ++frame)
+    {
+      for (size_t i = 0; i < cloud->points.size (); i += 3)
+        cloud->points[i].x += 0.003f;
+
+      std::stringstream streamA, streamB;
+      encoderA.encodePointCloud (cloud, streamA);
+      encoderB.encodePointCloud (cloud, streamB);
+
+      CloudT::Ptr outA (new CloudT ());
+      CloudT::Ptr outB (new CloudT ());
+      decoderA.decodePointCloud (streamA, outA);
+      decoderB.decodePointCloud (streamB, outB);
+
+      // chunked coding changes the stream layout but not the decoded cloud
+      ASSERT_EQ (outA->points.size (), outB->points.size ());
+      EXPECT_EQ (outA->width, outB->width);
+      EXPECT_EQ (decoderB.getChunkCount (), 7u);
+      for (size_t i = 0; i < outA->points.size (); ++i)
+      {
+        EXPECT_EQ (outA->points[i].x, outB->points[i].x);
+        EXPECT_EQ (outA->points[i].y, outB->points[i].y);
+        EXPECT_EQ (outA->points[i].z, outB->points[i].z);
+        EXPECT_EQ (outA->points[i].rgba, outB->points[i].rgba);
+      }
+
+      if (p > 0)
+        EXPECT_EQ (outB->points.size (), cloud->points.size ());
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Octree_Pointcloud_Compression_Stream_Format_Test)
+{
+  typedef pcl::PointCloud<pcl::PointXYZRGBA> CloudT;
+
+  // the cloud stored in octree_compressed_grid.bin, encoded by the single stream coder with the default profile
+  CloudT::Ptr cloud (new CloudT ());
+  cloud->width = 16;
+  cloud->height = 1;
+  cloud->points.resize (cloud->width);
+  for (int i = 0; i < 16; ++i)
+  {
+    cloud->points[i].x = 0.1f * static_cast<float> (i % 4);
+    cloud->points[i].y = 0.1f * static_cast<float> (i / 4);
+    cloud->points[i].z = 0.05f * static_cast<float> (i % 3);
+    cloud->points[i].rgba = 0x102030u * static_cast<uint32_t> (i + 1) & 0xFFFFFFu;
+  }
+
+  std::ifstream file (baseline_stream_file.c_str (), std::ios::in | std::ios::binary);
+  ASSERT_TRUE (file.good ());
+  const std::string baseline ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+
+  // a chunk count of 0 keeps the stream byte-identical to the single stream format
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> encoder (pcl::io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+  std::stringstream stream;
+  encoder.encodePointCloud (cloud, stream);
+  EXPECT_TRUE (stream.str () == baseline);
+
+  // streams in the single stream format still decode
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoderA;
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> decoderB;
+  std::stringstream baselineStream (baseline);
+  CloudT::Ptr outA (new CloudT ());
+  CloudT::Ptr outB (new CloudT ());
+  decoderA.decodePointCloud (baselineStream, outA);
+  decoderB.decodePointCloud (stream, outB);
+  EXPECT_EQ (decoderA.getChunkCount (), 0u);
+  ASSERT_EQ (outA->points.size (), cloud->points.size ());
+  ASSERT_EQ (outA->points.size (), outB->points.size ());
+  for (size_t i = 0; i < outA->points.size (); ++i)
+  {
+    EXPECT_EQ (outA->points[i].x, outB->points[i].x);
+    EXPECT_EQ (outA->points[i].y, outB->points[i].y);
+    EXPECT_EQ (outA->points[i].z, outB->points[i].z);
+    EXPECT_EQ (outA->points[i].rgba, outB->points[i].rgba);
+  }
+
+  // a decoder switches between chunked and single stream frames
+  pcl::io::OctreePointCloudCompression<pcl::PointXYZRGBA> chunkedEncoder (pcl::io::MED_RES_ONLINE_COMPRESSION_WITH_COLOR);
+  chunkedEncoder.setChunkCount (3);
+  std::stringstream chunkedStream;
+  chunkedEncoder.encodePointCloud (cloud, chunkedStream);
+  EXPECT_TRUE (chunkedStream.str () != baseline);
+
+  CloudT::Ptr outC (new CloudT ());
+  decoderA.decodePointCloud (chunkedStream, outC);
+  EXPECT_EQ (decoderA.getChunkCount (), 3u);
+  ASSERT_EQ (outC->points.size (), outA->points.size ());
+  for (size_t i = 0; i < outC->points.size (); ++i)
+  {
+    EXPECT_EQ (outA->points[i].x, outC->points[i].x);
+    EXPECT_EQ (outA->points[i].rgba, outC->points[i].rgba);
+  }
+
+  std::stringstream baselineStream2 (baseline);
+  decoderA.decodePointCloud (baselineStream2, outC);
+  EXPECT_EQ (decoderA.getChunkCount (), 0u);
+  EXPECT_EQ (outC->points.size (), outA->points.size ());
+}
+
+/* ---[ */
+int
+  main (int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "No test file given. Please pass the path of `octree_compressed_grid.bin` to the test." << std::endl;
+    return (-1);
+  }
+  baseline_stream_file = argv[1];
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
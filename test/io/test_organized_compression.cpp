@@ -0,0 +1,189 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <pcl/compression/organized_pointcloud_compression.h>
+#include <pcl/compression/impl/organized_pointcloud_compression.hpp>
+
+#include <gtest/gtest.h>
+#include <vector>
+#include <sstream>
+#include <ctime>
+
+typedef pcl::PointCloud<pcl::PointXYZRGBA> CloudT;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+expectEqualClouds (const CloudT& a, const CloudT& b)
+{
+  ASSERT_EQ (a.width, b.width);
+  ASSERT_EQ (a.height, b.height);
+  ASSERT_EQ (a.points.size (), b.points.size ());
+  for (size_t i = 0; i < a.points.size (); ++i)
+  {
+    EXPECT_EQ (pcl_isfinite (a.points[i].z), pcl_isfinite (b.points[i].z));
+    if (pcl_isfinite (a.points[i].z))
+    {
+      EXPECT_EQ (a.points[i].x, b.points[i].x);
+      EXPECT_EQ (a.points[i].y, b.points[i].y);
+      EXPECT_EQ (a.points[i].z, b.points[i].z);
+      EXPECT_EQ (a.points[i].rgba, b.points[i].rgba);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Organized_Pointcloud_Temporal_Compression_Test)
+{
+  const uint32_t width = 64;
+  const uint32_t height = 48;
+  const float focalLength = 525.0f / 10.0f;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  // static scene with a few invalid points
+  CloudT::Ptr cloud (new CloudT ());
+  cloud->width = width;
+  cloud->height = height;
+  cloud->is_dense = false;
+  cloud->points.resize (width * height);
+  for (uint32_t y = 0; y < height; ++y)
+    for (uint32_t x = 0; x < width; ++x)
+    {
+      pcl::PointXYZRGBA& point = cloud->points[y * width + x];
+      point.z = 1.0f + 2.0f * static_cast<float> (rand ()) / static_cast<float> (RAND_MAX);
+      point.x = (static_cast<float> (x) - static_cast<float> (width / 2)) * point.z / focalLength;
+      point.y = (static_cast<float> (y) - static_cast<float> (height / 2)) * point.z / focalLength;
+      point.rgba = static_cast<uint32_t> (rand ()) & 0xFFFFFF;
+      if (rand () % 50 == 0)
+        point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN ();
+    }
+
+  for (int mono = 0; mono < 2; ++mono)
+  {
+    pcl::io::OrganizedPointCloudCompression<pcl::PointXYZRGBA> encoderA, encoderB, decoderA, decoderB;
+    encoderB.setIFrameRate (4);
+    EXPECT_EQ (encoderB.getIFrameRate (), 4u);
+
+    std::vector<size_t> streamSizes;
+    for (int frame = 0; frame < 6; ++frame)
+    {
+      // a small moving region, frame 1 does not change at all
+      if (frame != 1)
+        for (uint32_t y = 10; y < 14; ++y)
+          for (uint32_t x = 4 * frame; x < 4 * frame + 6; ++x)
+          {
+            pcl::PointXYZRGBA& point = cloud->points[y * width + x];
+            point.z = 1.5f + 0.1f * static_cast<float> (frame);
+            point.x = (static_cast<float> (x) - static_cast<float> (width / 2)) * point.z / focalLength;
+            point.y = (static_cast<float> (y) - static_cast<float> (height / 2)) * point.z / focalLength;
+            point.rgba ^= 0x102030;
+          }
+
+      std::stringstream streamA, streamB;
+      encoderA.encodePointCloud (cloud, streamA, true, mono != 0, false);
+      encoderB.encodePointCloud (cloud, streamB, true, mono != 0, false);
+      streamSizes.push_back (streamB.str ().size ());
+
+      CloudT::Ptr outA (new CloudT ());
+      CloudT::Ptr outB (new CloudT ());
+      EXPECT_TRUE (decoderA.decodePointCloud (streamA, outA, false));
+      EXPECT_TRUE (decoderB.decodePointCloud (streamB, outB, false));
+
+      // temporal coding is lossless with respect to the independently coded frames
+      expectEqualClouds (*outA, *outB);
+    }
+
+    // P-frames are smaller than I-frames, frames 0 and 4 are I-frames
+    EXPECT_LT (streamSizes[1], streamSizes[2]);
+    EXPECT_LT (streamSizes[2], streamSizes[0]);
+    EXPECT_LT (streamSizes[5], streamSizes[4]);
+
+    // P-frames cannot be decoded without their I-frame
+    std::stringstream streamI, streamP;
+    encoderB.setIFrameRate (2);
+    encoderB.encodePointCloud (cloud, streamI, true, mono != 0, false);
+    encoderB.encodePointCloud (cloud, streamP, true, mono != 0, false);
+    pcl::io::OrganizedPointCloudCompression<pcl::PointXYZRGBA> decoderC;
+    CloudT::Ptr outC (new CloudT ());
+    EXPECT_FALSE (decoderC.decodePointCloud (streamP, outC, false));
+    EXPECT_TRUE (decoderC.decodePointCloud (streamI, outC, false));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, Organized_Raw_Disparity_Temporal_Compression_Test)
+{
+  const uint32_t width = 64;
+  const uint32_t height = 48;
+
+  std::vector<uint16_t> disparity (width * height);
+  std::vector<uint8_t> color (width * height * 3);
+  for (size_t i = 0; i < disparity.size (); ++i)
+    disparity[i] = static_cast<uint16_t> (400 + rand () % 600);
+  for (size_t i = 0; i < color.size (); ++i)
+    color[i] = static_cast<uint8_t> (rand () & 0xFF);
+
+  pcl::io::OrganizedPointCloudCompression<pcl::PointXYZRGBA> encoderA, encoderB, decoderA, decoderB;
+  encoderB.setIFrameRate (3);
+
+  for (int frame = 0; frame < 5; ++frame)
+  {
+    disparity[frame * 7] = static_cast<uint16_t> (disparity[frame * 7] + 5);
+
+    std::stringstream streamA, streamB;
+    encoderA.encodeRawDisparityMapWithColorImage (disparity, color, width, height, streamA, true, false, false);
+    encoderB.encodeRawDisparityMapWithColorImage (disparity, color, width, height, streamB, true, false, false);
+
+    CloudT::Ptr outA (new CloudT ());
+    CloudT::Ptr outB (new CloudT ());
+    EXPECT_TRUE (decoderA.decodePointCloud (streamA, outA, false));
+    EXPECT_TRUE (decoderB.decodePointCloud (streamB, outB, false));
+    expectEqualClouds (*outA, *outB);
+  }
+}
+
+/* ---[ */
+int
+  main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -0,0 +1,199 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/io.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/keypoints/harris_3d.h>
+#include <pcl/keypoints/harris_6d.h>
+
+using namespace pcl;
+
+typedef HarrisKeypoint3D<PointXYZ, PointXYZI> Harris3D;
+typedef HarrisKeypoint6D<PointXYZRGBA, PointXYZI> Harris6D;
+
+PointCloud<PointXYZRGBA>::Ptr cloud_rgba (new PointCloud<PointXYZRGBA> ());
+PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> ());
+
+const float radius = 0.01f;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief The runs compared by the tests: with and without the neighborhood cache, with one and more threads */
+const bool use_cache[] = {false, true, true, false};
+const unsigned int nr_threads[] = {1, 1, 3, 3};
+const int nr_runs = 4;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+compareKeypoints (const PointCloud<PointXYZI>& keypoints, const PointCloud<PointXYZI>& expected_keypoints)
+{
+  ASSERT_EQ (expected_keypoints.points.size (), keypoints.points.size ());
+  for (size_t i = 0; i < keypoints.points.size (); ++i)
+  {
+    EXPECT_EQ (expected_keypoints.points[i].x, keypoints.points[i].x);
+    EXPECT_EQ (expected_keypoints.points[i].y, keypoints.points[i].y);
+    EXPECT_EQ (expected_keypoints.points[i].z, keypoints.points[i].z);
+    EXPECT_EQ (expected_keypoints.points[i].intensity, keypoints.points[i].intensity);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+computeHarris3D (Harris3D::ResponseMethod method, bool use_neighborhood_cache, unsigned int threads,
+                 PointCloud<PointXYZI>& keypoints)
+{
+  Harris3D detector (method, radius, 1e-6f);
+  detector.setNonMaxSupression (true);
+  detector.setRefine (false);
+  detector.setUseNeighborhoodCache (use_neighborhood_cache);
+  detector.setNumberOfThreads (threads);
+  detector.setInputCloud (cloud);
+  detector.compute (keypoints);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+computeHarris6D (bool nonmax, bool refine, bool use_neighborhood_cache, unsigned int threads,
+                 PointCloud<PointXYZI>& keypoints)
+{
+  Harris6D detector (radius, 1e-6f);
+  detector.setNonMaxSupression (nonmax);
+  detector.setRefine (refine);
+  detector.setUseNeighborhoodCache (use_neighborhood_cache);
+  detector.setNumberOfThreads (threads);
+  detector.setInputCloud (cloud_rgba);
+  detector.compute (keypoints);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HarrisKeypoint3D_NeighborhoodCache)
+{
+  const Harris3D::ResponseMethod methods[] = {Harris3D::HARRIS, Harris3D::NOBLE, Harris3D::LOWE, Harris3D::TOMASI,
+                                              Harris3D::CURVATURE};
+  for (int method_idx = 0; method_idx < 5; ++method_idx)
+  {
+    PointCloud<PointXYZI> expected_keypoints;
+    computeHarris3D (methods[method_idx], use_cache[0], nr_threads[0], expected_keypoints);
+    ASSERT_FALSE (expected_keypoints.points.empty ());
+
+    // Neither the cache nor the number of threads may change the keypoints or their order
+    for (int run = 1; run < nr_runs; ++run)
+    {
+      SCOPED_TRACE (testing::Message () << "method " << methods[method_idx] << ", cache " << use_cache[run] << ", "
+                                        << nr_threads[run] << " threads");
+      PointCloud<PointXYZI> keypoints;
+      computeHarris3D (methods[method_idx], use_cache[run], nr_threads[run], keypoints);
+      compareKeypoints (keypoints, expected_keypoints);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HarrisKeypoint6D_NeighborhoodCache)
+{
+  PointCloud<PointXYZI> expected_keypoints;
+  computeHarris6D (true, false, use_cache[0], nr_threads[0], expected_keypoints);
+  ASSERT_FALSE (expected_keypoints.points.empty ());
+
+  for (int run = 1; run < nr_runs; ++run)
+  {
+    SCOPED_TRACE (testing::Message () << "cache " << use_cache[run] << ", " << nr_threads[run] << " threads");
+    PointCloud<PointXYZI> keypoints;
+    computeHarris6D (true, false, use_cache[run], nr_threads[run], keypoints);
+    compareKeypoints (keypoints, expected_keypoints);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HarrisKeypoint6D_Response)
+{
+  // Without non maxima suppression the response is returned; each response has to stay at the index of its point
+  PointCloud<PointXYZI> expected_response;
+  computeHarris6D (false, false, false, 1, expected_response);
+  ASSERT_EQ (cloud_rgba->points.size (), expected_response.points.size ());
+  for (size_t i = 0; i < cloud_rgba->points.size (); ++i)
+  {
+    EXPECT_EQ (cloud_rgba->points[i].x, expected_response.points[i].x);
+    EXPECT_EQ (cloud_rgba->points[i].y, expected_response.points[i].y);
+    EXPECT_EQ (cloud_rgba->points[i].z, expected_response.points[i].z);
+  }
+
+  PointCloud<PointXYZI> response;
+  computeHarris6D (false, false, false, 4, response);
+  compareKeypoints (response, expected_response);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, HarrisKeypoint6D_Refine)
+{
+  PointCloud<PointXYZI> unrefined_keypoints, expected_keypoints;
+  computeHarris6D (true, false, false, 1, unrefined_keypoints);
+  computeHarris6D (true, true, false, 1, expected_keypoints);
+  ASSERT_FALSE (expected_keypoints.points.empty ());
+  ASSERT_EQ (unrefined_keypoints.points.size (), expected_keypoints.points.size ());
+
+  // The corners are refined independently of each other, so the refinement must not depend on the number of threads
+  PointCloud<PointXYZI> keypoints;
+  computeHarris6D (true, true, false, 4, keypoints);
+  compareKeypoints (keypoints, expected_keypoints);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  if (argc < 2)
+  {
+    std::cerr << "No test file given. Please download `milk_color.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+
+  // Load a sample point cloud
+  if (io::loadPCDFile (argv[1], *cloud_rgba) < 0)
+  {
+    std::cerr << "Failed to read test file. Please download `milk_color.pcd` and pass its path to the test." << std::endl;
+    return (-1);
+  }
+  copyPointCloud (*cloud_rgba, *cloud);
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
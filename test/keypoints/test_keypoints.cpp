@@ -113,6 +113,42 @@ TEST (PCL, SIFTKeypoint)
 
 }
 
+TEST (PCL, SIFTKeypoint_threads)
+{
+  PointCloud<KeypointT> keypoints_serial, keypoints_parallel;
+
+  SIFTKeypoint<PointXYZI, KeypointT> sift_detector;
+  search::KdTree<PointXYZI>::Ptr tree (new search::KdTree<PointXYZI>);
+  sift_detector.setSearchMethod (tree);
+  sift_detector.setScales (0.02f, 5, 3);
+  sift_detector.setMinimumContrast (0.03f);
+  sift_detector.setInputCloud (cloud_xyzi);
+
+  sift_detector.setNumberOfThreads (1);
+  sift_detector.compute (keypoints_serial);
+  ASSERT_FALSE (keypoints_serial.points.empty ());
+
+  // 0 selects the number of threads automatically
+  const unsigned int nr_threads[] = {4, 0};
+  for (int run = 0; run < 2; ++run)
+  {
+    SCOPED_TRACE (testing::Message () << nr_threads[run] << " threads");
+    sift_detector.setNumberOfThreads (nr_threads[run]);
+    sift_detector.compute (keypoints_parallel);
+
+    // The keypoints have to be the same and in the same order
+    ASSERT_EQ (keypoints_serial.points.size (), keypoints_parallel.points.size ());
+    for (size_t i = 0; i < keypoints_serial.points.size (); ++i)
+    {
+      EXPECT_EQ (keypoints_serial.points[i].x, keypoints_parallel.points[i].x);
+      EXPECT_EQ (keypoints_serial.points[i].y, keypoints_parallel.points[i].y);
+      EXPECT_EQ (keypoints_serial.points[i].z, keypoints_parallel.points[i].z);
+      EXPECT_EQ (keypoints_serial.points[i].scale, keypoints_parallel.points[i].scale);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, SIFTKeypoint_radiusSearch)
 {
   const int nr_scales_per_octave = 3;
@@ -0,0 +1,167 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/range_image/range_image.h>
+#include <pcl/features/range_image_border_extractor.h>
+#include <pcl/features/narf_descriptor.h>
+#include <pcl/keypoints/narf_keypoint.h>
+#include <pcl/keypoints/narf_pipeline.h>
+
+using namespace pcl;
+
+const float support_size = 0.2f;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Creates a range image of a wall with three boxes in front of it, the boxes are moved sideways by shift */
+void
+createRangeImage (float shift, RangeImage& range_image)
+{
+  PointCloud<PointXYZ> cloud;
+  for (float y = -2.0f; y <= 2.0f; y += 0.02f)
+    for (float z = -1.0f; z <= 1.5f; z += 0.02f)
+      cloud.push_back (PointXYZ (5.0f, y, z));
+  for (int box_idx = 0; box_idx < 3; ++box_idx)
+  {
+    float center_x = 3.0f + 0.3f * static_cast<float> (box_idx),
+          center_y = -1.0f + static_cast<float> (box_idx) + shift,
+          size = 0.3f + 0.1f * static_cast<float> (box_idx);
+    for (float u = -size; u <= size; u += 0.01f)
+    {
+      for (float v = -size; v <= size; v += 0.01f)
+      {
+        cloud.push_back (PointXYZ (center_x - size, center_y + u, v));
+        cloud.push_back (PointXYZ (center_x + u, center_y - size, v));
+        cloud.push_back (PointXYZ (center_x + u, center_y + size, v));
+        cloud.push_back (PointXYZ (center_x + u, center_y + v, size));
+      }
+    }
+  }
+
+  range_image.createFromPointCloud (cloud, deg2rad (0.5f), deg2rad (360.0f), deg2rad (180.0f),
+                                    Eigen::Affine3f::Identity (), RangeImage::CAMERA_FRAME, 0.0f, 0.0f, 1);
+  range_image.setUnseenToMaxRange ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Extracts keypoints and descriptors without the pipeline, i.e., with a new border extractor, keypoint
+  * detector and descriptor extractor */
+void
+computeSeparately (const RangeImage& range_image, PointCloud<int>& keypoint_indices, PointCloud<Narf36>& descriptors)
+{
+  RangeImageBorderExtractor border_extractor;
+  NarfKeypoint keypoint_detector (&border_extractor);
+  keypoint_detector.getParameters ().support_size = support_size;
+  keypoint_detector.setRangeImage (&range_image);
+  keypoint_detector.compute (keypoint_indices);
+
+  std::vector<int> indices (keypoint_indices.points.begin (), keypoint_indices.points.end ());
+  NarfDescriptor descriptor_extractor (&range_image, &indices);
+  descriptor_extractor.getParameters ().support_size = support_size;
+  descriptor_extractor.compute (descriptors);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+compareResults (const PointCloud<int>& keypoint_indices, const PointCloud<Narf36>& descriptors,
+                const PointCloud<int>& expected_keypoint_indices, const PointCloud<Narf36>& expected_descriptors)
+{
+  ASSERT_EQ (expected_keypoint_indices.points.size (), keypoint_indices.points.size ());
+  for (size_t i = 0; i < keypoint_indices.points.size (); ++i)
+    EXPECT_EQ (expected_keypoint_indices.points[i], keypoint_indices.points[i]);
+
+  ASSERT_EQ (expected_descriptors.points.size (), descriptors.points.size ());
+  for (size_t i = 0; i < descriptors.points.size (); ++i)
+  {
+    const Narf36& descriptor = descriptors.points[i], & expected_descriptor = expected_descriptors.points[i];
+    EXPECT_FLOAT_EQ (expected_descriptor.x, descriptor.x);
+    EXPECT_FLOAT_EQ (expected_descriptor.y, descriptor.y);
+    EXPECT_FLOAT_EQ (expected_descriptor.z, descriptor.z);
+    EXPECT_FLOAT_EQ (expected_descriptor.roll, descriptor.roll);
+    EXPECT_FLOAT_EQ (expected_descriptor.pitch, descriptor.pitch);
+    EXPECT_FLOAT_EQ (expected_descriptor.yaw, descriptor.yaw);
+    for (int j = 0; j < 36; ++j)
+      EXPECT_FLOAT_EQ (expected_descriptor.descriptor[j], descriptor.descriptor[j]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NarfPipeline)
+{
+  RangeImage range_images[2];
+  createRangeImage (0.0f, range_images[0]);
+  createRangeImage (0.2f, range_images[1]);
+
+  PointCloud<int> expected_keypoint_indices[2];
+  PointCloud<Narf36> expected_descriptors[2];
+  for (int frame = 0; frame < 2; ++frame)
+  {
+    computeSeparately (range_images[frame], expected_keypoint_indices[frame], expected_descriptors[frame]);
+    ASSERT_FALSE (expected_keypoint_indices[frame].points.empty ());
+    ASSERT_FALSE (expected_descriptors[frame].points.empty ());
+  }
+
+  // The result must neither depend on the number of threads nor on the frame the pipeline processed before
+  const int max_no_of_threads[] = {1, 4};
+  for (int run = 0; run < 2; ++run)
+  {
+    NarfPipeline narf_pipeline;
+    narf_pipeline.getParameters ().support_size = support_size;
+    narf_pipeline.getParameters ().max_no_of_threads = max_no_of_threads[run];
+    for (int frame = 0; frame < 2; ++frame)
+    {
+      SCOPED_TRACE (testing::Message () << max_no_of_threads[run] << " threads, frame " << frame);
+      PointCloud<int> keypoint_indices;
+      PointCloud<Narf36> descriptors;
+      narf_pipeline.setRangeImage (&range_images[frame]);
+      narf_pipeline.compute (keypoint_indices, descriptors);
+      compareResults (keypoint_indices, descriptors, expected_keypoint_indices[frame], expected_descriptors[frame]);
+    }
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
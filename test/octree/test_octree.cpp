@@ -36,6 +36,7 @@
 #include <gtest/gtest.h>
 
 #include <vector>
+#include <algorithm>
 
 #include <stdio.h>
 
@@ -1161,6 +1162,82 @@ TEST (PCL, Octree_Pointcloud_Voxel_Centroid_Test)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Bulk_Build_Test)
+{
+  const unsigned int test_runs = 10;
+  unsigned int test_id;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  for (test_id = 0; test_id < test_runs; test_id++)
+  {
+    PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+    // generate point data with duplicate voxels and invalid points
+    cloudIn->width = 1000 + rand () % 1000;
+    cloudIn->height = 1;
+    cloudIn->is_dense = false;
+    cloudIn->points.resize (cloudIn->width * cloudIn->height);
+    for (size_t i = 0; i < cloudIn->points.size (); i++)
+    {
+      cloudIn->points[i] = PointXYZ (static_cast<float> (5.0 * rand () / RAND_MAX),
+                                     static_cast<float> (10.0 * rand () / RAND_MAX),
+                                     static_cast<float> (2.0 * rand () / RAND_MAX));
+      if (i % 97 == 0)
+        cloudIn->points[i].x = std::numeric_limits<float>::quiet_NaN ();
+    }
+
+    double resolution = 0.1 + 0.2 * rand () / RAND_MAX;
+
+    OctreePointCloudSearch<PointXYZ> octreeA (resolution);
+    OctreePointCloudSearch<PointXYZ> octreeB (resolution);
+    OctreePointCloudSearch<PointXYZ> octreeC (resolution);
+
+    // octree A and B share their bounding box, octree C defines its own
+    octreeA.setInputCloud (cloudIn);
+    octreeA.defineBoundingBox ();
+    octreeA.addPointsFromInputCloud ();
+
+    octreeB.setInputCloud (cloudIn);
+    octreeB.defineBoundingBox ();
+    octreeB.setNumberOfThreads (1 + test_id % 4);
+    octreeB.addPointsFromInputCloudBulk ();
+
+    octreeC.setInputCloud (cloudIn);
+    octreeC.addPointsFromInputCloudBulk ();
+
+    ASSERT_EQ (octreeA.getLeafCount (), octreeB.getLeafCount ());
+    ASSERT_EQ (octreeA.getBranchCount (), octreeB.getBranchCount ());
+
+    // both octrees have identical structure and leaf node content
+    std::vector<char> treeBinaryA;
+    std::vector<char> treeBinaryB;
+    std::vector<int> leafVectorA;
+    std::vector<int> leafVectorB;
+
+    octreeA.serializeTree (treeBinaryA, leafVectorA);
+    octreeB.serializeTree (treeBinaryB, leafVectorB);
+
+    ASSERT_EQ (treeBinaryA.size (), treeBinaryB.size ());
+    ASSERT_EQ (leafVectorA.size (), leafVectorB.size ());
+    for (size_t i = 0; i < treeBinaryA.size (); i++)
+      ASSERT_EQ (treeBinaryA[i], treeBinaryB[i]);
+    for (size_t i = 0; i < leafVectorA.size (); i++)
+      ASSERT_EQ (leafVectorA[i], leafVectorB[i]);
+
+    // every valid point is found in its voxel
+    for (size_t i = 0; i < cloudIn->points.size (); i++)
+    {
+      if (!isFinite (cloudIn->points[i]))
+        continue;
+
+      std::vector<int> pointIdxVec;
+      ASSERT_EQ (octreeC.voxelSearch (cloudIn->points[i], pointIdxVec), true);
+      ASSERT_EQ (std::find (pointIdxVec.begin (), pointIdxVec.end (), static_cast<int> (i)) != pointIdxVec.end (), true);
+    }
+  }
+}
+
 // helper class for priority queue
 class prioPointQueueEntry
 {
@@ -1625,6 +1702,343 @@ TEST (PCL, Octree_Pointcloud_Ray_Traversal)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Linear_Search)
+{
+  const unsigned int test_runs = 10;
+  const unsigned int query_runs = 20;
+  unsigned int test_id;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  for (test_id = 0; test_id < test_runs; test_id++)
+  {
+    PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+    // generate point data with invalid points
+    cloudIn->width = 1000 + rand () % 1000;
+    cloudIn->height = 1;
+    cloudIn->is_dense = false;
+    cloudIn->points.resize (cloudIn->width * cloudIn->height);
+    for (size_t i = 0; i < cloudIn->points.size (); i++)
+    {
+      cloudIn->points[i] = PointXYZ (static_cast<float> (5.0 * rand () / RAND_MAX),
+                                     static_cast<float> (10.0 * rand () / RAND_MAX),
+                                     static_cast<float> (10.0 * rand () / RAND_MAX));
+      if (i % 101 == 0)
+        cloudIn->points[i].y = std::numeric_limits<float>::quiet_NaN ();
+    }
+
+    double resolution = 0.1 + 0.5 * rand () / RAND_MAX;
+
+    OctreePointCloudSearch<PointXYZ> octree (resolution);
+    octree.setInputCloud (cloudIn);
+    octree.defineBoundingBox ();
+    octree.addPointsFromInputCloud ();
+
+    // the linear octree shares the final bounding box of the pointer based octree
+    double minX, minY, minZ, maxX, maxY, maxZ;
+    octree.getBoundingBox (minX, minY, minZ, maxX, maxY, maxZ);
+
+    OctreePointCloudLinear<PointXYZ> linearOctree (resolution);
+    linearOctree.setInputCloud (cloudIn);
+    linearOctree.defineBoundingBox (minX, minY, minZ, maxX, maxY, maxZ);
+    linearOctree.addPointsFromInputCloud ();
+
+    // a fitted bounding box holds all valid points
+    OctreePointCloudLinear<PointXYZ> fittedOctree (resolution);
+    fittedOctree.setInputCloud (cloudIn);
+    fittedOctree.addPointsFromInputCloud ();
+
+    ASSERT_EQ (linearOctree.getPointIndices ().size (), fittedOctree.getPointIndices ().size ());
+
+    ASSERT_EQ (octree.getTreeDepth (), linearOctree.getTreeDepth ());
+    ASSERT_EQ (octree.getLeafCount (), linearOctree.getLeafCount ());
+    ASSERT_EQ (octree.getBranchCount (), linearOctree.getBranchCount ());
+
+    // restore the octree from its binary representation
+    std::vector<char> treeBinary;
+    linearOctree.serializeTree (treeBinary);
+
+    OctreePointCloudLinear<PointXYZ> restoredOctree (1.0);
+    ASSERT_EQ (restoredOctree.deserializeTree (treeBinary), true);
+    restoredOctree.setInputCloud (cloudIn);
+
+    ASSERT_EQ (linearOctree.getLeafCount (), restoredOctree.getLeafCount ());
+    ASSERT_EQ (linearOctree.getPointIndices ().size (), restoredOctree.getPointIndices ().size ());
+
+    treeBinary.pop_back ();
+    ASSERT_EQ (restoredOctree.deserializeTree (treeBinary), false);
+
+    for (unsigned int query_id = 0; query_id < query_runs; query_id++)
+    {
+      const PointXYZ searchPoint (static_cast<float> (5.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX),
+                                  static_cast<float> (10.0 * rand () / RAND_MAX));
+
+      std::vector<int> indicesA, indicesB;
+      std::vector<float> distancesA, distancesB;
+
+      // radius search finds the same neighbors in the same order
+      const double searchRadius = 5.0 * rand () / RAND_MAX;
+      octree.radiusSearch (searchPoint, searchRadius, indicesA, distancesA);
+      restoredOctree.radiusSearch (searchPoint, searchRadius, indicesB, distancesB);
+
+      ASSERT_EQ (indicesA.size (), indicesB.size ());
+      for (size_t i = 0; i < indicesA.size (); i++)
+      {
+        ASSERT_EQ (indicesA[i], indicesB[i]);
+        ASSERT_EQ (distancesA[i], distancesB[i]);
+      }
+
+      // limited radius search stops at the same neighbor
+      octree.radiusSearch (searchPoint, searchRadius, indicesA, distancesA, 10);
+      restoredOctree.radiusSearch (searchPoint, searchRadius, indicesB, distancesB, 10);
+
+      ASSERT_EQ (indicesA.size (), indicesB.size ());
+      for (size_t i = 0; i < indicesA.size (); i++)
+        ASSERT_EQ (indicesA[i], indicesB[i]);
+
+      // k nearest neighbor search finds the same distances
+      const int K = 1 + rand () % 20;
+      octree.nearestKSearch (searchPoint, K, indicesA, distancesA);
+      linearOctree.nearestKSearch (searchPoint, K, indicesB, distancesB);
+
+      ASSERT_EQ (indicesA.size (), indicesB.size ());
+      for (size_t i = 0; i < indicesA.size (); i++)
+        ASSERT_EQ (distancesA[i], distancesB[i]);
+
+      // approximate nearest neighbor search descends into the same voxel
+      int resultA = -1, resultB = -1;
+      float sqrDistA = 0.0f, sqrDistB = 0.0f;
+      octree.approxNearestSearch (searchPoint, resultA, sqrDistA);
+      linearOctree.approxNearestSearch (searchPoint, resultB, sqrDistB);
+
+      ASSERT_EQ (resultA, resultB);
+      ASSERT_EQ (sqrDistA, sqrDistB);
+
+      // box search finds the same points in the same order
+      const Eigen::Vector3f boxMin (searchPoint.x - 1.0f, searchPoint.y - 2.0f, searchPoint.z - 3.0f);
+      const Eigen::Vector3f boxMax (searchPoint.x + 3.0f, searchPoint.y + 2.0f, searchPoint.z + 1.0f);
+      octree.boxSearch (boxMin, boxMax, indicesA);
+      linearOctree.boxSearch (boxMin, boxMax, indicesB);
+
+      ASSERT_EQ (indicesA.size (), indicesB.size ());
+      for (size_t i = 0; i < indicesA.size (); i++)
+        ASSERT_EQ (indicesA[i], indicesB[i]);
+
+      // ray traversal visits the same voxels in the same order
+      const Eigen::Vector3f origin (static_cast<float> (20.0 * rand () / RAND_MAX - 5.0),
+                                    static_cast<float> (20.0 * rand () / RAND_MAX - 5.0),
+                                    static_cast<float> (20.0 * rand () / RAND_MAX - 5.0));
+      const Eigen::Vector3f direction (searchPoint.getVector3fMap () - origin);
+
+      octree.getIntersectedVoxelIndices (origin, direction, indicesA);
+      linearOctree.getIntersectedVoxelIndices (origin, direction, indicesB);
+
+      ASSERT_EQ (indicesA.size (), indicesB.size ());
+      for (size_t i = 0; i < indicesA.size (); i++)
+        ASSERT_EQ (indicesA[i], indicesB[i]);
+
+      pcl::PointCloud<pcl::PointXYZ>::VectorType voxelsA, voxelsB;
+      octree.getIntersectedVoxelCenters (origin, direction, voxelsA, 3);
+      linearOctree.getIntersectedVoxelCenters (origin, direction, voxelsB, 3);
+
+      ASSERT_EQ (voxelsA.size (), voxelsB.size ());
+      for (size_t i = 0; i < voxelsA.size (); i++)
+        ASSERT_EQ ((voxelsA[i].getVector3fMap () - voxelsB[i].getVector3fMap ()).norm (), 0.0f);
+    }
+
+    // voxel search finds every valid point in its voxel
+    for (size_t i = 0; i < cloudIn->points.size (); i++)
+    {
+      if (!isFinite (cloudIn->points[i]))
+        continue;
+
+      std::vector<int> pointIdxVecA, pointIdxVecB;
+      ASSERT_EQ (octree.voxelSearch (cloudIn->points[i], pointIdxVecA), true);
+      ASSERT_EQ (linearOctree.voxelSearch (cloudIn->points[i], pointIdxVecB), true);
+      ASSERT_EQ (pointIdxVecA.size (), pointIdxVecB.size ());
+      for (size_t j = 0; j < pointIdxVecA.size (); j++)
+        ASSERT_EQ (pointIdxVecA[j], pointIdxVecB[j]);
+
+      pointIdxVecB.clear ();
+      ASSERT_EQ (fittedOctree.voxelSearch (cloudIn->points[i], pointIdxVecB), true);
+      ASSERT_EQ (std::find (pointIdxVecB.begin (), pointIdxVecB.end (), static_cast<int> (i)) != pointIdxVecB.end (), true);
+    }
+  }
+}
+
+TEST (PCL, Octree_Pointcloud_Linear_Corrupted_Buffer)
+{
+  typedef OctreePointCloudLinear<PointXYZ>::LinearNode LinearNode;
+
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+  for (int i = 0; i < 500; i++)
+    cloudIn->push_back (PointXYZ (static_cast<float> (i % 10), static_cast<float> ((i / 10) % 10), static_cast<float> (i / 100)));
+
+  OctreePointCloudLinear<PointXYZ> linearOctree (1.0);
+  linearOctree.setInputCloud (cloudIn);
+  linearOctree.addPointsFromInputCloud ();
+
+  std::vector<char> treeBinary;
+  linearOctree.serializeTree (treeBinary);
+
+  // the buffer starts with 7 doubles for the bounds and 4 sizes, followed by the nodes and the point indices
+  const std::size_t nodeStart = 7 * sizeof (double) + 4 * sizeof (uint32_t);
+  const std::size_t indexStart = nodeStart + linearOctree.getNodes ().size () * sizeof (LinearNode);
+  const uint32_t nodeCount = static_cast<uint32_t> (linearOctree.getNodes ().size ());
+  const uint32_t indexCount = static_cast<uint32_t> (linearOctree.getPointIndices ().size ());
+  ASSERT_EQ (treeBinary.size (), indexStart + indexCount * sizeof (int));
+
+  OctreePointCloudLinear<PointXYZ> restoredOctree (1.0);
+  restoredOctree.setInputCloud (cloudIn);
+  ASSERT_EQ (restoredOctree.deserializeTree (treeBinary), true);
+
+  // corrupt a single field of the root node, of a leaf node or of the point indices at a time
+  for (int corruption = 0; corruption < 7; corruption++)
+  {
+    std::vector<char> corruptedBinary (treeBinary);
+    LinearNode root, leaf;
+    memcpy (&root, &corruptedBinary[nodeStart], sizeof (LinearNode));
+    memcpy (&leaf, &corruptedBinary[indexStart - sizeof (LinearNode)], sizeof (LinearNode));
+    int index = 0;
+
+    switch (corruption)
+    {
+      case 0: root.child_offset = nodeCount; break;                   // children behind the node array
+      case 1: root.child_offset = 0; break;                           // root is its own child
+      case 2: root.child_mask = 0x1FF; break;                         // more than eight children
+      case 3: root.point_end = indexCount + 1; break;                 // range behind the index array
+      case 4: leaf.point_begin = leaf.point_end + 1; break;           // reversed range
+      case 5: index = -1; break;                                      // negative point index
+      case 6: index = static_cast<int> (cloudIn->points.size ()); break; // index behind the input cloud
+    }
+
+    memcpy (&corruptedBinary[nodeStart], &root, sizeof (LinearNode));
+    memcpy (&corruptedBinary[indexStart - sizeof (LinearNode)], &leaf, sizeof (LinearNode));
+    if (corruption >= 5)
+      memcpy (&corruptedBinary[indexStart], &index, sizeof (int));
+
+    OctreePointCloudLinear<PointXYZ> corruptedOctree (1.0);
+    corruptedOctree.setInputCloud (cloudIn);
+    EXPECT_EQ (corruptedOctree.deserializeTree (corruptedBinary), false) << "corruption " << corruption;
+    EXPECT_EQ (corruptedOctree.getNodes ().size (), 0u);
+
+    // a failed restore keeps the previous octree
+    EXPECT_EQ (restoredOctree.deserializeTree (corruptedBinary), false);
+    EXPECT_EQ (restoredOctree.getNodes ().size (), nodeCount);
+  }
+}
+
+TEST (PCL, Octree_Pointcloud_Batch_Search)
+{
+  const unsigned int test_runs = 5;
+  unsigned int test_id;
+
+  srand (static_cast<unsigned int> (time (NULL)));
+
+  for (test_id = 0; test_id < test_runs; test_id++)
+  {
+    PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+    PointCloud<PointXYZ> queries;
+
+    // generate point data
+    cloudIn->width = 1000 + rand () % 1000;
+    cloudIn->height = 1;
+    cloudIn->points.resize (cloudIn->width * cloudIn->height);
+    for (size_t i = 0; i < cloudIn->points.size (); i++)
+      cloudIn->points[i] = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                     static_cast<float> (10.0 * rand () / RAND_MAX),
+                                     static_cast<float> (10.0 * rand () / RAND_MAX));
+
+    // generate queries, partly outside of the bounding box and invalid
+    queries.points.resize (200);
+    for (size_t i = 0; i < queries.points.size (); i++)
+      queries.points[i] = PointXYZ (static_cast<float> (12.0 * rand () / RAND_MAX - 1.0),
+                                    static_cast<float> (12.0 * rand () / RAND_MAX - 1.0),
+                                    static_cast<float> (12.0 * rand () / RAND_MAX - 1.0));
+    queries.points[17].z = std::numeric_limits<float>::quiet_NaN ();
+
+    OctreePointCloudSearch<PointXYZ> octree (0.5 + 0.5 * rand () / RAND_MAX);
+    octree.setInputCloud (cloudIn);
+    octree.addPointsFromInputCloud ();
+    octree.setNumberOfThreads (1 + test_id % 4);
+
+    std::vector<int> offsets, batchIndices, k_indices;
+    std::vector<float> batchDistances, k_sqr_distances;
+
+    // k nearest neighbor search
+    const int K = 1 + rand () % 10;
+    octree.batchNearestKSearch (queries, K, offsets, batchIndices, batchDistances);
+
+    ASSERT_EQ (offsets.size (), queries.points.size () + 1);
+    ASSERT_EQ (offsets.back (), static_cast<int> (batchIndices.size ()));
+    ASSERT_EQ (offsets[18] - offsets[17], 0);
+
+    for (size_t i = 0; i < queries.points.size (); i++)
+    {
+      if (!isFinite (queries.points[i]))
+        continue;
+
+      octree.nearestKSearch (queries.points[i], K, k_indices, k_sqr_distances);
+
+      ASSERT_EQ (static_cast<int> (k_indices.size ()), offsets[i + 1] - offsets[i]);
+      for (size_t j = 0; j < k_indices.size (); j++)
+      {
+        ASSERT_EQ (k_indices[j], batchIndices[offsets[i] + j]);
+        ASSERT_EQ (k_sqr_distances[j], batchDistances[offsets[i] + j]);
+      }
+    }
+
+    // radius search with and without neighbor limit
+    const double searchRadius = 2.0 * rand () / RAND_MAX;
+    for (unsigned int max_nn = 0; max_nn < 20; max_nn += 15)
+    {
+      octree.batchRadiusSearch (queries, searchRadius, offsets, batchIndices, batchDistances, max_nn);
+
+      ASSERT_EQ (offsets.size (), queries.points.size () + 1);
+      ASSERT_EQ (offsets[18] - offsets[17], 0);
+
+      for (size_t i = 0; i < queries.points.size (); i++)
+      {
+        if (!isFinite (queries.points[i]))
+          continue;
+
+        octree.radiusSearch (queries.points[i], searchRadius, k_indices, k_sqr_distances, max_nn);
+
+        ASSERT_EQ (static_cast<int> (k_indices.size ()), offsets[i + 1] - offsets[i]);
+        for (size_t j = 0; j < k_indices.size (); j++)
+        {
+          ASSERT_EQ (k_indices[j], batchIndices[offsets[i] + j]);
+          ASSERT_EQ (k_sqr_distances[j], batchDistances[offsets[i] + j]);
+        }
+      }
+    }
+
+    // box search
+    std::vector<Eigen::Vector3f> minPts, maxPts;
+    for (size_t i = 0; i < queries.points.size (); i++)
+    {
+      if (!isFinite (queries.points[i]))
+        continue;
+      minPts.push_back (queries.points[i].getVector3fMap () - Eigen::Vector3f (1.0f, 0.5f, 2.0f));
+      maxPts.push_back (queries.points[i].getVector3fMap () + Eigen::Vector3f (0.5f, 2.0f, 1.0f));
+    }
+
+    octree.batchBoxSearch (minPts, maxPts, offsets, batchIndices);
+
+    ASSERT_EQ (offsets.size (), minPts.size () + 1);
+    for (size_t i = 0; i < minPts.size (); i++)
+    {
+      octree.boxSearch (minPts[i], maxPts[i], k_indices);
+
+      ASSERT_EQ (static_cast<int> (k_indices.size ()), offsets[i + 1] - offsets[i]);
+      for (size_t j = 0; j < k_indices.size (); j++)
+        ASSERT_EQ (k_indices[j], batchIndices[offsets[i] + j]);
+    }
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
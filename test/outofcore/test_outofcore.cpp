@@ -86,6 +86,11 @@ const static boost::filesystem::path filename_otreeB_LOD = "treeB_LOD/tree_test.
 
 const static  boost::filesystem::path outofcore_path ("point_cloud_octree/tree_test.oct_idx");
 
+const static boost::filesystem::path filename_otree_packed = "treePacked/tree_test.oct_idx";
+
+const static boost::filesystem::path filename_otree_parallel = "treeParallel/tree_test.oct_idx";
+const static boost::filesystem::path filename_otree_compressed = "treeCompressed/tree_test.oct_idx";
+
 
 typedef pcl::PointXYZ PointT;
 
@@ -96,8 +101,15 @@ typedef OutofcoreOctreeBaseNode<OutofcoreOctreeDiskContainer < PointT > , PointT
 typedef OutofcoreOctreeBase<OutofcoreOctreeRamContainer< PointT> , PointT> octree_ram;
 typedef OutofcoreOctreeBaseNode<OutofcoreOctreeRamContainer<PointT> , PointT> octree_ram_node;
 
+typedef OutofcoreOctreeBase<OutofcoreOctreePackedContainer<PointT> , PointT> octree_packed;
+
+typedef OutofcoreOctreeCompressedContainer<PointT> compressed_container;
+typedef OutofcoreOctreeBase<compressed_container, PointT> octree_compressed;
+
 typedef std::vector<PointT, Eigen::aligned_allocator<PointT> > AlignedPointTVector;
 
+typedef OutofcoreOctreeQueryService<OutofcoreOctreeDiskContainer<PointT>, PointT> query_service;
+
 AlignedPointTVector points;
 
 
@@ -428,6 +440,9 @@ class OutofcoreTest : public testing::Test
 
       boost::filesystem::remove_all (outofcore_path.parent_path ());
 
+      boost::filesystem::remove_all (filename_otree_packed.parent_path ());
+      boost::filesystem::remove_all (filename_otree_parallel.parent_path ());
+      boost::filesystem::remove_all (filename_otree_compressed.parent_path ());
     }
 
     double smallest_voxel_dim;
@@ -951,6 +966,474 @@ TEST_F (OutofcoreTest, PointCloud2_Query)
   cleanUpFilesystem ();
 }
 
+/** \brief Count the points of \b cloud inside the query box, using the same boundary convention as the octree */
+size_t
+countPointsInBox (const AlignedPointTVector &cloud, const Eigen::Vector3d &min, const Eigen::Vector3d &max)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < cloud.size (); i++)
+  {
+    const PointT &p = cloud[i];
+    if ((min[0] <= p.x) && (p.x < max[0]) && (min[1] <= p.y) && (p.y < max[1]) && (min[2] <= p.z) && (p.z < max[2]))
+      count++;
+  }
+  return (count);
+}
+
+TEST_F (OutofcoreTest, Outofcore_PackedContainer)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (0.0, 0.0, 0.0);
+  const Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  boost::mt19937 rng (rngseed);
+  boost::normal_distribution<float> dist (0.5f, .1f);
+
+  AlignedPointTVector cloud (numPts);
+  for (size_t i = 0; i < numPts; i++)
+  {
+    cloud[i].x = dist (rng);
+    cloud[i].y = dist (rng);
+    cloud[i].z = dist (rng);
+  }
+
+  std::vector<Eigen::Vector3d> query_min, query_max;
+  boost::uniform_real<float> query_dist (0, 1);
+  for (int i = 0; i < 10; i++)
+  {
+    Eigen::Vector3d qmin, qmax;
+    for (int j = 0; j < 3; j++)
+    {
+      qmin[j] = query_dist (rng);
+      qmax[j] = query_dist (rng);
+      if (qmax[j] < qmin[j])
+        std::swap (qmin[j], qmax[j]);
+    }
+    query_min.push_back (qmin);
+    query_max.push_back (qmax);
+  }
+
+  {
+    octree_packed tree (min, max, .1, filename_otree_packed, "ECEF");
+    tree.addDataToLeaf (cloud);
+    // insert in two batches so that the payloads are chains of several extents
+    tree.addDataToLeaf (cloud);
+
+    for (size_t i = 0; i < query_min.size (); i++)
+    {
+      AlignedPointTVector result;
+      tree.queryBBIncludes (query_min[i], query_max[i], tree.getDepth (), result);
+      EXPECT_EQ (2 * countPointsInBox (cloud, query_min[i], query_max[i]), result.size ());
+    }
+  }
+
+  // all payloads live in the segment files of the root directory
+  const boost::filesystem::path root_dir = filename_otree_packed.parent_path ();
+  EXPECT_TRUE (boost::filesystem::exists (root_dir / OutofcorePackedSegmentStore::index_filename));
+
+  size_t pcd_files = 0;
+  for (boost::filesystem::recursive_directory_iterator it (root_dir), end; it != end; ++it)
+  {
+    if (boost::filesystem::extension (it->path ()) == ".pcd")
+      pcd_files++;
+  }
+  EXPECT_EQ (0, pcd_files);
+
+  // reload from disk, compact and query again
+  octree_packed tree (filename_otree_packed, false);
+  OutofcorePackedSegmentStore::Ptr store = OutofcorePackedSegmentStore::open (root_dir);
+  EXPECT_EQ (2 * numPts, tree.getNumPointsAtDepth (tree.getDepth ()));
+
+  store->setMaxSegmentSize (16 * 1024);
+  store->compact ();
+  EXPECT_GT (store->getNumSegments (), 1);
+
+  for (size_t i = 0; i < query_min.size (); i++)
+  {
+    AlignedPointTVector result;
+    tree.queryBBIncludes (query_min[i], query_max[i], tree.getDepth (), result);
+    EXPECT_EQ (2 * countPointsInBox (cloud, query_min[i], query_max[i]), result.size ());
+
+    store->setReadAheadSize (0);
+    AlignedPointTVector uncached;
+    tree.queryBBIncludes (query_min[i], query_max[i], tree.getDepth (), uncached);
+    store->setReadAheadSize (4 * 1024 * 1024);
+
+    ASSERT_EQ (result.size (), uncached.size ());
+    for (size_t j = 0; j < result.size (); j++)
+      EXPECT_TRUE (compPt (result[j], uncached[j]));
+  }
+
+  // PointCloud2 queries read the same points
+  AlignedPointTVector result;
+  tree.queryBBIncludes (query_min[0], query_max[0], tree.getDepth (), result);
+  sensor_msgs::PointCloud2::Ptr blob (new sensor_msgs::PointCloud2 ());
+  tree.queryBBIncludes (query_min[0], query_max[0], tree.getDepth (), blob);
+  EXPECT_EQ (result.size (), blob->width * blob->height);
+
+  cleanUpFilesystem ();
+}
+
+TEST_F (OutofcoreTest, Outofcore_PackedIndexTruncatedRecord)
+{
+  const boost::filesystem::path root_dir = filename_otree_packed.parent_path ();
+  const boost::filesystem::path index = root_dir / OutofcorePackedSegmentStore::index_filename;
+  const int data[3] = {1, 2, 3};
+
+  // an interrupted append may stop within the key length or behind it
+  const size_t partial_bytes[2] = {2, 6};
+  for (int run = 0; run < 2; run++)
+  {
+    cleanUpFilesystem ();
+
+    OutofcorePackedSegmentStore::open (root_dir)->append ("a", data, sizeof (data), 3);
+    const boost::uintmax_t complete_size = boost::filesystem::file_size (index);
+
+    FILE *f = fopen (index.string ().c_str (), "ab");
+    ASSERT_TRUE (f != NULL);
+    const boost::uint32_t key_length = 1;
+    char partial_record[8] = {0};
+    memcpy (partial_record, &key_length, sizeof (key_length));
+    EXPECT_EQ (partial_bytes[run], fwrite (partial_record, 1, partial_bytes[run], f));
+    fclose (f);
+
+    // reopening cuts the partial record off, so the next record is appended behind the last complete one
+    {
+      OutofcorePackedSegmentStore::Ptr store = OutofcorePackedSegmentStore::open (root_dir);
+      EXPECT_EQ (complete_size, boost::filesystem::file_size (index));
+      EXPECT_EQ (3, store->getPointCount ("a"));
+      store->append ("b", data, sizeof (data), 3);
+    }
+
+    OutofcorePackedSegmentStore::Ptr store = OutofcorePackedSegmentStore::open (root_dir);
+    EXPECT_EQ (2, store->getNumPayloads ());
+    EXPECT_EQ (3, store->getPointCount ("a"));
+    EXPECT_EQ (3, store->getPointCount ("b"));
+
+    std::vector<char> payload;
+    ASSERT_TRUE (store->read ("b", payload));
+    ASSERT_EQ (sizeof (data), payload.size ());
+    EXPECT_EQ (0, memcmp (data, &payload[0], sizeof (data)));
+  }
+
+  cleanUpFilesystem ();
+}
+
+TEST_F (OutofcoreTest, Outofcore_ParallelBulkLoad)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (0.0, 0.0, 0.0);
+  const Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  boost::mt19937 rng (rngseed);
+  boost::normal_distribution<float> dist (0.5f, .1f);
+
+  AlignedPointTVector cloud (numPts);
+  for (size_t i = 0; i < numPts; i++)
+  {
+    cloud[i].x = dist (rng);
+    cloud[i].y = dist (rng);
+    cloud[i].z = dist (rng);
+  }
+  octree_packed serial_tree (4, min, max, filename_otreeA, "ECEF");
+  octree_packed parallel_tree (4, min, max, filename_otree_parallel, "ECEF");
+
+  serial_tree.addDataToLeaf (cloud);
+
+  parallel_tree.setNumberOfThreads (4);
+  EXPECT_EQ (4, parallel_tree.getNumberOfThreads ());
+  // small batches so every subtree is filled in several passes
+  EXPECT_EQ (numPts, parallel_tree.addDataToLeafParallel (cloud, 100));
+  EXPECT_EQ (numPts, parallel_tree.getNumPointsAtDepth (parallel_tree.getDepth ()));
+
+  // points outside of the bounding box are dropped
+  AlignedPointTVector outside (1, PointT (2.0f, 2.0f, 2.0f));
+  EXPECT_EQ (0, parallel_tree.addDataToLeafParallel (outside));
+
+  AlignedPointTVector serial_voxels, parallel_voxels;
+  serial_tree.getOccupiedVoxelCenters (serial_voxels);
+  parallel_tree.getOccupiedVoxelCenters (parallel_voxels);
+  EXPECT_EQ (serial_voxels.size (), parallel_voxels.size ());
+
+  boost::uniform_real<float> query_dist (0, 1);
+  for (int i = 0; i < 10; i++)
+  {
+    Eigen::Vector3d qmin, qmax;
+    for (int j = 0; j < 3; j++)
+    {
+      qmin[j] = query_dist (rng);
+      qmax[j] = query_dist (rng);
+      if (qmax[j] < qmin[j])
+        std::swap (qmin[j], qmax[j]);
+    }
+
+    AlignedPointTVector serial_result, parallel_result;
+    serial_tree.queryBBIncludes (qmin, qmax, serial_tree.getDepth (), serial_result);
+    parallel_tree.queryBBIncludes (qmin, qmax, parallel_tree.getDepth (), parallel_result);
+    EXPECT_EQ (countPointsInBox (cloud, qmin, qmax), parallel_result.size ());
+    EXPECT_EQ (serial_result.size (), parallel_result.size ());
+  }
+
+  // LODs are nested samples of the level below
+  parallel_tree.setSamplePercent (0.125);
+  parallel_tree.buildLODParallel ();
+
+  std::vector<size_t> lod_sizes (parallel_tree.getDepth () + 1);
+  for (size_t depth = 0; depth <= parallel_tree.getDepth (); depth++)
+  {
+    AlignedPointTVector lod;
+    parallel_tree.queryBBIncludes (min, max, depth, lod);
+    lod_sizes[depth] = lod.size ();
+    EXPECT_GE (lod_sizes[depth], 1) << "No points in the LOD indicates buildLODParallel failed\n";
+    if (depth > 0)
+      EXPECT_LE (lod_sizes[depth - 1], lod_sizes[depth]);
+  }
+  EXPECT_EQ (numPts, lod_sizes.back ()) << "Points in leaves were lost while building LOD!\n";
+  EXPECT_EQ (lod_sizes[0], parallel_tree.getNumPointsAtDepth (0));
+
+  // rebuilding replaces the LODs instead of appending to them
+  parallel_tree.buildLODParallel ();
+  for (size_t depth = 0; depth <= parallel_tree.getDepth (); depth++)
+  {
+    AlignedPointTVector lod;
+    parallel_tree.queryBBIncludes (min, max, depth, lod);
+    EXPECT_EQ (lod_sizes[depth], lod.size ());
+  }
+
+  cleanUpFilesystem ();
+}
+
+/** \brief Counts the callbacks of the query service and the points they deliver */
+struct PayloadCounter
+{
+  PayloadCounter (boost::mutex &mutex_arg, size_t &calls_arg, size_t &points_arg)
+    : mutex (mutex_arg), calls (calls_arg), points (points_arg) {}
+
+  void
+  operator() (octree_disk_node*, const sensor_msgs::PointCloud2::ConstPtr &payload)
+  {
+    boost::mutex::scoped_lock lock (mutex);
+    calls++;
+    if (payload)
+      points += payload->width * payload->height;
+  }
+
+  boost::mutex &mutex;
+  size_t &calls;
+  size_t &points;
+};
+
+TEST_F (OutofcoreTest, Outofcore_QueryService)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (0.0, 0.0, 0.0);
+  const Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  boost::mt19937 rng (rngseed);
+  boost::uniform_real<float> dist (0.0f, 1.0f);
+
+  AlignedPointTVector cloud (numPts);
+  for (size_t i = 0; i < numPts; i++)
+  {
+    cloud[i].x = dist (rng);
+    cloud[i].y = dist (rng);
+    cloud[i].z = dist (rng);
+  }
+
+  boost::shared_ptr<octree_disk> tree (new octree_disk (3, min, max, filename_otreeA, "ECEF"));
+  tree->addDataToLeaf (cloud);
+  tree->buildLOD ();
+
+  query_service service (tree, 3);
+  service.setPrefetch (false);
+
+  boost::mutex mutex;
+  size_t calls = 0, points = 0;
+  PayloadCounter counter (mutex, calls, points);
+
+  // every leaf is read once and delivered to both the future and the callback
+  std::vector<octree_disk_node*> nodes;
+  std::vector<query_service::PayloadFuture> payloads;
+  service.queryBoundingBox (min, max, 3, nodes, payloads, counter);
+  ASSERT_EQ (nodes.size (), payloads.size ());
+  ASSERT_FALSE (nodes.empty ());
+
+  size_t future_points = 0;
+  for (size_t i = 0; i < payloads.size (); i++)
+  {
+    sensor_msgs::PointCloud2::ConstPtr payload = payloads[i].get ();
+    ASSERT_TRUE (payload);
+    future_points += payload->width * payload->height;
+  }
+  service.waitUntilIdle ();
+
+  EXPECT_EQ (numPts, future_points);
+  EXPECT_EQ (numPts, points);
+  EXPECT_EQ (nodes.size (), calls);
+  EXPECT_EQ (nodes.size (), service.getNumCacheMisses ());
+  EXPECT_EQ (0, service.getNumCacheHits ());
+  EXPECT_EQ (nodes.size (), service.getNumCachedNodes ());
+
+  // the second pass is served from the cache
+  service.queryBoundingBox (min, max, 3, nodes, payloads, counter);
+  for (size_t i = 0; i < payloads.size (); i++)
+    EXPECT_TRUE (payloads[i].is_ready ());
+  EXPECT_EQ (nodes.size (), service.getNumCacheHits ());
+  EXPECT_EQ (2 * numPts, points);
+
+  // shrinking the cache evicts the least recently used payloads
+  const boost::uint64_t usage = service.getCacheUsage ();
+  service.setCacheCapacity (usage / 2);
+  EXPECT_LE (service.getCacheUsage (), usage / 2);
+  EXPECT_LT (service.getNumCachedNodes (), nodes.size ());
+
+  // a frustum query prefetches the next level of detail and the surrounding nodes
+  service.setCacheCapacity (usage * 4);
+  service.clearCache ();
+  service.setPrefetch (true);
+
+  const double planes[24] = { 1, 0, 0, -0.1,  -1, 0, 0, 0.4,
+                              0, 1, 0, -0.1,   0, -1, 0, 0.4,
+                              0, 0, 1, -0.1,   0, 0, -1, 0.4 };
+  const Eigen::Vector3d eye (0.25, 0.25, -1.0);
+
+  service.queryFrustum (planes, eye, 2, nodes, payloads);
+  ASSERT_FALSE (nodes.empty ());
+  for (size_t i = 0; i < nodes.size (); i++)
+  {
+    Eigen::Vector3d node_min, node_max;
+    nodes[i]->getBoundingBox (node_min, node_max);
+    EXPECT_LT (node_min[0], 0.4);
+    EXPECT_GT (node_max[0], 0.1);
+    EXPECT_TRUE (payloads[i].get ());
+  }
+  service.waitUntilIdle ();
+
+  sensor_msgs::PointCloud2::ConstPtr cached;
+  std::vector<octree_disk_node*> next_lod;
+  tree->queryFrustum (planes, 3, next_lod);
+  ASSERT_FALSE (next_lod.empty ());
+  for (size_t i = 0; i < next_lod.size (); i++)
+    EXPECT_TRUE (service.getCachedPayload (next_lod[i], cached));
+
+  std::vector<octree_disk_node*> ring;
+  tree->queryBBIntersects (Eigen::Vector3d (0.0, 0.0, 0.0), Eigen::Vector3d (0.75, 0.75, 0.75), 2, ring);
+  EXPECT_GT (ring.size (), nodes.size ());
+  for (size_t i = 0; i < ring.size (); i++)
+    EXPECT_TRUE (service.getCachedPayload (ring[i], cached));
+
+  cleanUpFilesystem ();
+}
+
+TEST_F (OutofcoreTest, Outofcore_CompressedContainer)
+{
+  cleanUpFilesystem ();
+
+  const Eigen::Vector3d min (0.0, 0.0, 0.0);
+  const Eigen::Vector3d max (1.0, 1.0, 1.0);
+
+  boost::mt19937 rng (rngseed);
+  boost::normal_distribution<float> dist (0.5f, .1f);
+
+  AlignedPointTVector cloud (numPts);
+  for (size_t i = 0; i < numPts; i++)
+  {
+    cloud[i].x = dist (rng);
+    cloud[i].y = dist (rng);
+    cloud[i].z = dist (rng);
+  }
+
+  const boost::filesystem::path root_dir = filename_otree_compressed.parent_path ();
+  boost::filesystem::create_directory (root_dir);
+
+  // lossless round trip, inserted in several blocks
+  compressed_container::setQuantizationResolution (0);
+  {
+    compressed_container payload (root_dir / "lossless.pcd");
+    for (size_t i = 0; i < numPts; i += numPts / 4)
+      payload.insertRange (&cloud[i], numPts / 4);
+    ASSERT_EQ (numPts, payload.size ());
+  }
+  {
+    compressed_container payload (root_dir / "lossless.pcd");
+    ASSERT_EQ (numPts, payload.size ());
+    EXPECT_LT (payload.getStoredBytes (), numPts * sizeof (PointT));
+
+    AlignedPointTVector points;
+    payload.readRange (0, numPts, points);
+    ASSERT_EQ (numPts, points.size ());
+    for (size_t i = 0; i < numPts; i++)
+      EXPECT_TRUE (compPt (cloud[i], points[i]));
+
+    // a range crossing block boundaries
+    AlignedPointTVector slice;
+    payload.readRange (numPts / 8, numPts / 2, slice);
+    ASSERT_EQ (numPts / 2, slice.size ());
+    for (size_t i = 0; i < slice.size (); i++)
+      EXPECT_TRUE (compPt (cloud[numPts / 8 + i], slice[i]));
+    EXPECT_TRUE (compPt (cloud[numPts - 1], payload[numPts - 1]));
+
+    EXPECT_ANY_THROW ({ AlignedPointTVector out; payload.readRange (numPts - 1, 2, out); });
+
+    payload.clear ();
+    EXPECT_EQ (0, payload.size ());
+    EXPECT_FALSE (boost::filesystem::exists (root_dir / "lossless.pcq"));
+  }
+
+  // quantized coordinates are within half a step of the input
+  const double resolution = 0.001;
+  compressed_container::setQuantizationResolution (resolution);
+  {
+    compressed_container payload (root_dir / "quantized.pcd");
+    payload.insertRange (cloud);
+
+    AlignedPointTVector points;
+    payload.readRange (0, numPts, points);
+    ASSERT_EQ (numPts, points.size ());
+    for (size_t i = 0; i < numPts; i++)
+    {
+      EXPECT_NEAR (cloud[i].x, points[i].x, resolution / 2 + 1e-6);
+      EXPECT_NEAR (cloud[i].y, points[i].y, resolution / 2 + 1e-6);
+      EXPECT_NEAR (cloud[i].z, points[i].z, resolution / 2 + 1e-6);
+    }
+    EXPECT_LT (payload.getStoredBytes (), numPts * 3 * sizeof (uint16_t) + 1024);
+  }
+  compressed_container::setQuantizationResolution (0);
+
+  // as node payloads of a tree
+  boost::filesystem::remove_all (root_dir);
+  {
+    octree_compressed tree (min, max, .1, filename_otree_compressed, "ECEF");
+    tree.addDataToLeaf (cloud);
+    tree.addDataToLeaf (cloud);
+  }
+
+  octree_compressed tree (filename_otree_compressed, false);
+  EXPECT_EQ (2 * numPts, tree.getNumPointsAtDepth (tree.getDepth ()));
+
+  boost::uniform_real<float> query_dist (0, 1);
+  for (int i = 0; i < 10; i++)
+  {
+    Eigen::Vector3d qmin, qmax;
+    for (int j = 0; j < 3; j++)
+    {
+      qmin[j] = query_dist (rng);
+      qmax[j] = query_dist (rng);
+      if (qmax[j] < qmin[j])
+        std::swap (qmin[j], qmax[j]);
+    }
+
+    AlignedPointTVector result;
+    tree.queryBBIncludes (qmin, qmax, tree.getDepth (), result);
+    EXPECT_EQ (2 * countPointsInBox (cloud, qmin, qmax), result.size ());
+  }
+
+  cleanUpFilesystem ();
+}
+
 /* [--- */
 int
 main (int argc, char** argv)
@@ -48,6 +48,7 @@
 #include <pcl/surface/marching_cubes_hoppe.h>
 #include <pcl/surface/marching_cubes_rbf.h>
 #include <pcl/common/common.h>
+#include <pcl/kdtree/kdtree_flann.h>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -100,6 +101,148 @@ TEST (PCL, MarchingCubesTest)
   EXPECT_EQ (vertices[vertices.size ()/2].vertices[2], 4286);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Check that every triangle of the sparse grid mesh is also a triangle of the dense grid mesh. */
+void
+checkTrianglesInDenseMesh (const PointCloud<PointNormal> &points, const std::vector<Vertices> &polygons,
+                           const PointCloud<PointNormal> &dense_points, const std::vector<Vertices> &dense_polygons)
+{
+  PointCloud<PointXYZ>::Ptr dense_centroids (new PointCloud<PointXYZ>);
+  for (size_t i = 0; i < dense_polygons.size (); ++i)
+  {
+    PointXYZ centroid;
+    centroid.getVector3fMap () = (dense_points[dense_polygons[i].vertices[0]].getVector3fMap () +
+                                  dense_points[dense_polygons[i].vertices[1]].getVector3fMap () +
+                                  dense_points[dense_polygons[i].vertices[2]].getVector3fMap ()) / 3.0f;
+    dense_centroids->push_back (centroid);
+  }
+  KdTreeFLANN<PointXYZ> dense_tree;
+  dense_tree.setInputCloud (dense_centroids);
+
+  std::vector<int> nn_indices (1);
+  std::vector<float> nn_sqr_dists (1);
+  for (size_t i = 0; i < polygons.size (); ++i)
+  {
+    ASSERT_EQ (polygons[i].vertices.size (), 3);
+    for (int j = 0; j < 3; ++j)
+      ASSERT_LT (polygons[i].vertices[j], points.size ());
+
+    PointXYZ centroid;
+    centroid.getVector3fMap () = (points[polygons[i].vertices[0]].getVector3fMap () +
+                                  points[polygons[i].vertices[1]].getVector3fMap () +
+                                  points[polygons[i].vertices[2]].getVector3fMap ()) / 3.0f;
+    ASSERT_EQ (dense_tree.nearestKSearch (centroid, 1, nn_indices, nn_sqr_dists), 1);
+    const Vertices &dense_polygon = dense_polygons[nn_indices[0]];
+    for (int j = 0; j < 3; ++j)
+    {
+      float min_distance = std::numeric_limits<float>::max ();
+      for (int k = 0; k < 3; ++k)
+        min_distance = (std::min) (min_distance, (points[polygons[i].vertices[j]].getVector3fMap () -
+                                                  dense_points[dense_polygon.vertices[k]].getVector3fMap ()).norm ());
+      EXPECT_LT (min_distance, 1e-5f) << "triangle " << i;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief A marching cubes class that only fills the dense grid. */
+class MarchingCubesDenseOnly : public MarchingCubes<PointNormal>
+{
+  public:
+    MarchingCubesDenseOnly () : nr_voxelize_calls (0) {}
+
+    int nr_voxelize_calls;
+
+  protected:
+    void
+    voxelizeData ()
+    {
+      ++nr_voxelize_calls;
+      std::fill (grid_.begin (), grid_.end (), 1.0f);
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesSparseGridTest)
+{
+  MarchingCubesHoppe<PointNormal> hoppe;
+  hoppe.setIsoLevel (0);
+  hoppe.setGridResolution (30, 30, 30);
+  hoppe.setPercentageExtendGrid (0.3f);
+  hoppe.setInputCloud (cloud_with_normals);
+  PointCloud<PointNormal> dense_points;
+  std::vector<Vertices> dense_vertices;
+  hoppe.reconstruct (dense_points, dense_vertices);
+
+  // With the blocks dilated over the whole grid, the sparse grid gives the same triangles as the dense one
+  hoppe.setUseSparseGrid (true);
+  hoppe.setSparseBlockSize (8);
+  hoppe.setSparseBlockDilation (4);
+  PointCloud<PointNormal> points;
+  std::vector<Vertices> vertices;
+  hoppe.reconstruct (points, vertices);
+  EXPECT_EQ (vertices.size (), dense_vertices.size ());
+  checkTrianglesInDenseMesh (points, vertices, dense_points, dense_vertices);
+
+  // Vertices are welded, including across block seams
+  EXPECT_LT (points.size (), 3 * vertices.size ());
+
+  // Only the blocks around the input points: a subset of the dense triangles
+  hoppe.setSparseBlockDilation (1);
+  hoppe.setNumberOfThreads (1);
+  hoppe.reconstruct (points, vertices);
+  EXPECT_GT (vertices.size (), 0);
+  EXPECT_LE (vertices.size (), dense_vertices.size ());
+  checkTrianglesInDenseMesh (points, vertices, dense_points, dense_vertices);
+
+  // The output does not depend on the number of threads
+  PointCloud<PointNormal> points_threads;
+  std::vector<Vertices> vertices_threads;
+  hoppe.setNumberOfThreads (4);
+  hoppe.reconstruct (points_threads, vertices_threads);
+  ASSERT_EQ (points_threads.size (), points.size ());
+  for (size_t i = 0; i < points.size (); ++i)
+  {
+    EXPECT_EQ (points_threads[i].x, points[i].x);
+    EXPECT_EQ (points_threads[i].y, points[i].y);
+    EXPECT_EQ (points_threads[i].z, points[i].z);
+  }
+  ASSERT_EQ (vertices_threads.size (), vertices.size ());
+  for (size_t i = 0; i < vertices.size (); ++i)
+    for (int j = 0; j < 3; ++j)
+      EXPECT_EQ (vertices_threads[i].vertices[j], vertices[i].vertices[j]);
+
+  MarchingCubesRBF<PointNormal> rbf;
+  rbf.setIsoLevel (0);
+  rbf.setGridResolution (20, 20, 20);
+  rbf.setPercentageExtendGrid (0.1f);
+  rbf.setInputCloud (cloud_with_normals);
+  rbf.setOffSurfaceDisplacement (0.02f);
+  rbf.reconstruct (dense_points, dense_vertices);
+
+  rbf.setUseSparseGrid (true);
+  rbf.setSparseBlockDilation (3);
+  rbf.reconstruct (points, vertices);
+  EXPECT_EQ (vertices.size (), dense_vertices.size ());
+  checkTrianglesInDenseMesh (points, vertices, dense_points, dense_vertices);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, MarchingCubesSparseGridUnsupported)
+{
+  // A class that does not evaluate its scalar field through getSignedDistance () can not fill the sparse grid
+  MarchingCubesDenseOnly marching_cubes;
+  marching_cubes.setIsoLevel (0);
+  marching_cubes.setGridResolution (10, 10, 10);
+  marching_cubes.setInputCloud (cloud_with_normals);
+  marching_cubes.setUseSparseGrid (true);
+  PointCloud<PointNormal> points;
+  std::vector<Vertices> vertices;
+  marching_cubes.reconstruct (points, vertices);
+  EXPECT_EQ (marching_cubes.nr_voxelize_calls, 0);
+  EXPECT_EQ (points.size (), 0);
+  EXPECT_EQ (vertices.size (), 0);
+}
 
 /* ---[ */
 int
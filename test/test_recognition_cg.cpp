@@ -138,6 +138,55 @@ TEST (PCL, Hough3DGrouping)
   EXPECT_LT (computeRmsE (model_, scene_, rototranslations[0]), 1E-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, SparseHoughSpace3D)
+{
+  srand (0);
+  const int nr_votes = 5000;
+  vector<Eigen::Vector3d> votes (nr_votes);
+  vector<double> weights (nr_votes);
+  Eigen::Vector3d min_coord, max_coord, bin_size;
+  min_coord.setConstant (numeric_limits<double>::max ());
+  max_coord.setConstant (-numeric_limits<double>::max ());
+  bin_size.setConstant (0.02);
+  for (int i = 0; i < nr_votes; ++i)
+  {
+    const double center = 0.25 * (rand () % 4);
+    for (int d = 0; d < 3; ++d)
+      votes[i][d] = center + 0.1 * (static_cast<double> (rand ()) / RAND_MAX - 0.5);
+    weights[i] = static_cast<double> (rand ()) / RAND_MAX;
+    min_coord = min_coord.cwiseMin (votes[i]);
+    max_coord = max_coord.cwiseMax (votes[i]);
+  }
+
+  for (int interpolate = 0; interpolate < 2; ++interpolate)
+  {
+    recognition::HoughSpace3D dense_space (min_coord, bin_size, max_coord);
+    for (int i = 0; i < nr_votes; ++i)
+    {
+      if (interpolate)
+        dense_space.voteInt (votes[i], weights[i], i);
+      else
+        dense_space.vote (votes[i], weights[i], i);
+    }
+    vector<double> dense_values;
+    vector<vector<int> > dense_voter_ids;
+    const double dense_threshold = dense_space.findMaxima (-0.5, dense_values, dense_voter_ids);
+    ASSERT_FALSE (dense_values.empty ());
+
+    for (unsigned int nr_threads = 1; nr_threads <= 4; ++nr_threads)
+    {
+      recognition::SparseHoughSpace3D sparse_space (min_coord, bin_size, max_coord, nr_threads);
+      sparse_space.vote (votes, weights, interpolate != 0);
+      vector<double> sparse_values;
+      vector<vector<int> > sparse_voter_ids;
+      EXPECT_EQ (dense_threshold, sparse_space.findMaxima (-0.5, sparse_values, sparse_voter_ids));
+      EXPECT_TRUE (dense_values == sparse_values);
+      EXPECT_TRUE (dense_voter_ids == sparse_voter_ids);
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, GeometricConsistencyGrouping)
 {
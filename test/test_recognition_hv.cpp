@@ -0,0 +1,201 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id: $
+ *
+ */
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/transforms.h>
+#include <pcl/recognition/hv/hv_go.h>
+#include "test_recognition_shapes.h"
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+using namespace pcl;
+
+typedef PointXYZ PointType;
+
+PointCloud<PointType>::Ptr scene_ (new PointCloud<PointType> ());
+vector<PointCloud<PointType>::ConstPtr> hypotheses_;
+vector<bool> ground_truth_;
+
+/** \brief Gives access to the state of the optimization, so that single moves can be checked. */
+class GlobalHypothesesVerificationAccess : public GlobalHypothesesVerification<PointType, PointType>
+{
+  public:
+    typedef GlobalHypothesesVerification<PointType, PointType> Base;
+
+    using Base::initialize;
+    using Base::initializeState;
+    using Base::evaluateSolution;
+    using Base::evaluateMove;
+
+    size_t
+    getNumberOfRecognitionModels () const
+    {
+      return (recognition_models_.size ());
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+setUpVerification (GlobalHypothesesVerification<PointType, PointType> & go, bool detect_clutter)
+{
+  go.setSceneCloud (scene_);
+  go.addModels (hypotheses_, false);
+  go.addCompleteModels (hypotheses_);
+  go.setInlierThreshold (0.005f);
+  go.setOcclusionThreshold (0.01f);
+  go.setRegularizer (3.0f);
+  go.setRadiusClutter (0.03f);
+  go.setClutterRegularizer (5.0f);
+  go.setDetectClutter (detect_clutter);
+  go.setRadiusNormals (0.02f);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Walks through random masks; from each of them, every move is evaluated without changing the state and compared
+  * to the cost obtained by applying the move (and reverting it afterwards). */
+void
+checkMoveEvaluation (bool detect_clutter)
+{
+  GlobalHypothesesVerificationAccess go;
+  setUpVerification (go, detect_clutter);
+  go.initialize ();
+
+  const int nr_models = static_cast<int> (go.getNumberOfRecognitionModels ());
+  ASSERT_EQ (nr_models, static_cast<int> (hypotheses_.size ()));
+
+  vector<bool> solution (nr_models, true);
+  go.initializeState (solution);
+
+  boost::mt19937 rng (42);
+  for (int step = 0; step < 40; ++step)
+  {
+    for (int changed = 0; changed < nr_models; ++changed)
+    {
+      const mets::gol_type predicted_cost = go.evaluateMove (solution, changed, !solution[changed]);
+
+      solution[changed] = !solution[changed];
+      const mets::gol_type cost = go.evaluateSolution (solution, changed);
+      solution[changed] = !solution[changed];
+      go.evaluateSolution (solution, changed);
+
+      EXPECT_NEAR (predicted_cost, cost, 1e-4 * (1.0 + fabs (cost))) << "step " << step << ", hypothesis " << changed;
+    }
+
+    const int changed = boost::uniform_int<int> (0, nr_models - 1) (rng);
+    solution[changed] = !solution[changed];
+    go.evaluateSolution (solution, changed);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GOEvaluateMove)
+{
+  checkMoveEvaluation (false);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GOEvaluateMoveClutter)
+{
+  checkMoveEvaluation (true);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GORestarts)
+{
+  // The restarts are independent of each other, so the result must not depend on the number of threads
+  const unsigned int nr_threads[] = {1, 3};
+  vector<bool> masks[2];
+  for (int run = 0; run < 2; ++run)
+  {
+    GlobalHypothesesVerification<PointType, PointType> go;
+    setUpVerification (go, true);
+    go.setNumberOfRestarts (4);
+    go.setNumberOfThreads (nr_threads[run]);
+    go.verify ();
+    go.getMask (masks[run]);
+    ASSERT_EQ (masks[run].size (), hypotheses_.size ());
+  }
+
+  for (size_t i = 0; i < hypotheses_.size (); ++i)
+  {
+    EXPECT_EQ (masks[0][i], masks[1][i]);
+    EXPECT_EQ (masks[0][i], ground_truth_[i]);
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  // Three objects in the scene; the first three hypotheses are correct, the others have the wrong shape or a wrong pose
+  for (int object_index = 0; object_index < 3; ++object_index)
+  {
+    PointCloud<PointType> blob, transformed_blob;
+    createBlob (object_index, 40, 0.0, blob);
+    const Eigen::Affine3f pose = Eigen::Translation3f (0.15f * static_cast<float> (object_index), 0.02f * static_cast<float> (object_index), 0.5f) *
+                                 Eigen::AngleAxisf (0.5f * static_cast<float> (object_index), Eigen::Vector3f::UnitZ ());
+    transformPointCloud (blob, transformed_blob, pose);
+    *scene_ += transformed_blob;
+  }
+
+  for (int hypothesis_index = 0; hypothesis_index < 12; ++hypothesis_index)
+  {
+    const int object_index = hypothesis_index % 3;
+    const bool is_correct = hypothesis_index < 3;
+    const float offset = is_correct ? 0.0f : 0.01f * static_cast<float> (1 + hypothesis_index % 4);
+
+    PointCloud<PointType> blob;
+    createBlob (is_correct ? object_index : (object_index + 1) % 3, 40, 0.0, blob);
+    const Eigen::Affine3f pose = Eigen::Translation3f (0.15f * static_cast<float> (object_index) + offset, 0.02f * static_cast<float> (object_index), 0.5f + offset) *
+                                 Eigen::AngleAxisf (0.5f * static_cast<float> (object_index) + 3.0f * offset, Eigen::Vector3f::UnitZ ());
+    PointCloud<PointType>::Ptr hypothesis (new PointCloud<PointType> ());
+    transformPointCloud (blob, *hypothesis, pose);
+    hypotheses_.push_back (hypothesis);
+    ground_truth_.push_back (is_correct);
+  }
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
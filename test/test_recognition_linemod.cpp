@@ -0,0 +1,428 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id: $
+ *
+ */
+#include <gtest/gtest.h>
+#include <pcl/recognition/linemod.h>
+#include <pcl/recognition/linemod/template_bank.h>
+#include <pcl/recognition/linemod/score_kernels.h>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace std;
+using namespace pcl;
+
+const char bank_file_name[] = "test_linemod_template_bank.bin";
+const char broken_bank_file_name[] = "test_linemod_template_bank_broken.bin";
+
+vector<SparseQuantizedMultiModTemplate> templates_;
+vector<size_t> object_ids_;
+vector<BoundingBoxXYZ> bounding_boxes_;
+PointCloud<PointXYZRGBA>::CloudVectorType clouds_;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+readFile (const string & file_name, vector<char> & data)
+{
+  ifstream stream (file_name.c_str (), ifstream::in | ifstream::binary);
+  data.assign (istreambuf_iterator<char> (stream), istreambuf_iterator<char> ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+writeFile (const string & file_name, const vector<char> & data)
+{
+  ofstream stream (file_name.c_str (), ofstream::out | ofstream::binary | ofstream::trunc);
+  stream.write (&data[0], static_cast<streamsize> (data.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+expectEqualTemplates (const SparseQuantizedMultiModTemplate & a, const SparseQuantizedMultiModTemplate & b)
+{
+  EXPECT_EQ (a.region.x, b.region.x);
+  EXPECT_EQ (a.region.y, b.region.y);
+  EXPECT_EQ (a.region.width, b.region.width);
+  EXPECT_EQ (a.region.height, b.region.height);
+  ASSERT_EQ (a.features.size (), b.features.size ());
+  for (size_t i = 0; i < a.features.size (); ++i)
+  {
+    EXPECT_EQ (a.features[i].x, b.features[i].x);
+    EXPECT_EQ (a.features[i].y, b.features[i].y);
+    EXPECT_EQ (a.features[i].modality_index, b.features[i].modality_index);
+    EXPECT_EQ (a.features[i].quantized_value, b.features[i].quantized_value);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LINEMODTemplateBankRoundTrip)
+{
+  ASSERT_TRUE (LINEMODTemplateBank::write (bank_file_name, templates_, object_ids_, bounding_boxes_, clouds_));
+
+  LINEMODTemplateBank bank;
+  ASSERT_TRUE (bank.open (bank_file_name));
+  ASSERT_EQ (bank.getNumOfTemplates (), templates_.size ());
+  EXPECT_EQ (bank.getNumOfObjects (), 2);
+
+  // The templates are grouped by object: the ones of object 3 (0 and 2) come before the one of object 7 (1)
+  const size_t bank_order[] = {0, 2, 1};
+  for (size_t bank_index = 0; bank_index < templates_.size (); ++bank_index)
+  {
+    const size_t template_index = bank_order[bank_index];
+
+    SparseQuantizedMultiModTemplate linemod_template;
+    bank.getTemplate (bank_index, linemod_template);
+    expectEqualTemplates (templates_[template_index], linemod_template);
+
+    const RegionXY region = bank.getRegion (bank_index);
+    EXPECT_EQ (templates_[template_index].region.x, region.x);
+    EXPECT_EQ (templates_[template_index].region.y, region.y);
+    EXPECT_EQ (templates_[template_index].region.width, region.width);
+    EXPECT_EQ (templates_[template_index].region.height, region.height);
+
+    EXPECT_EQ (object_ids_[template_index], bank.getObjectId (bank_index));
+
+    const BoundingBoxXYZ bounding_box = bank.getBoundingBox (bank_index);
+    EXPECT_EQ (bounding_boxes_[template_index].x, bounding_box.x);
+    EXPECT_EQ (bounding_boxes_[template_index].y, bounding_box.y);
+    EXPECT_EQ (bounding_boxes_[template_index].z, bounding_box.z);
+    EXPECT_EQ (bounding_boxes_[template_index].width, bounding_box.width);
+    EXPECT_EQ (bounding_boxes_[template_index].height, bounding_box.height);
+    EXPECT_EQ (bounding_boxes_[template_index].depth, bounding_box.depth);
+
+    PointCloud<PointXYZRGBA> cloud;
+    bank.getPointCloud (bank_index, cloud);
+    EXPECT_EQ (clouds_[template_index].width, cloud.width);
+    EXPECT_EQ (clouds_[template_index].height, cloud.height);
+    ASSERT_EQ (clouds_[template_index].size (), cloud.size ());
+    for (size_t i = 0; i < cloud.size (); ++i)
+    {
+      EXPECT_EQ (clouds_[template_index].points[i].x, cloud.points[i].x);
+      EXPECT_EQ (clouds_[template_index].points[i].y, cloud.points[i].y);
+      EXPECT_EQ (clouds_[template_index].points[i].z, cloud.points[i].z);
+      EXPECT_EQ (clouds_[template_index].points[i].rgba, cloud.points[i].rgba);
+    }
+  }
+
+  remove (bank_file_name);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LINEMODTemplateBankTemplateIDs)
+{
+  ASSERT_TRUE (LINEMODTemplateBank::write (bank_file_name, templates_, object_ids_));
+
+  // IDs of the bank come first, followed by the ones of the templates added afterwards
+  LINEMOD linemod;
+  ASSERT_TRUE (linemod.loadTemplateBank (bank_file_name));
+  const int added_id = linemod.addTemplate (templates_[1]);
+  EXPECT_EQ (added_id, 3);
+  ASSERT_EQ (linemod.getNumOfTemplates (), 4);
+
+  const size_t template_indices[] = {0, 2, 1, 1};
+  for (size_t template_id = 0; template_id < linemod.getNumOfTemplates (); ++template_id)
+  {
+    const SparseQuantizedMultiModTemplate & expected_template = templates_[template_indices[template_id]];
+
+    SparseQuantizedMultiModTemplate linemod_template;
+    linemod.copyTemplate (template_id, linemod_template);
+    expectEqualTemplates (expected_template, linemod_template);
+
+    const RegionXY region = linemod.getTemplateRegion (static_cast<int> (template_id));
+    EXPECT_EQ (expected_template.region.x, region.x);
+    EXPECT_EQ (expected_template.region.y, region.y);
+    EXPECT_EQ (expected_template.region.width, region.width);
+    EXPECT_EQ (expected_template.region.height, region.height);
+  }
+  expectEqualTemplates (templates_[1], linemod.getTemplate (added_id));
+
+  // Bank templates can not be returned by reference, and IDs beyond the added templates do not exist
+  EXPECT_THROW (linemod.getTemplate (0), PCLException);
+  EXPECT_THROW (linemod.getTemplate (2), PCLException);
+  EXPECT_THROW (linemod.getTemplate (-1), PCLException);
+  EXPECT_THROW (linemod.getTemplate (4), PCLException);
+
+  remove (bank_file_name);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LINEMODTemplateBankRejection)
+{
+  ASSERT_TRUE (LINEMODTemplateBank::write (bank_file_name, templates_, object_ids_));
+  vector<char> data;
+  readFile (bank_file_name, data);
+  ASSERT_GE (data.size (), sizeof (LINEMODTemplateBank::Header));
+
+  LINEMODTemplateBank bank;
+
+  // An unknown format version
+  vector<char> broken_data (data);
+  LINEMODTemplateBank::Header header;
+  memcpy (&header, &broken_data[0], sizeof (header));
+  ++header.version;
+  memcpy (&broken_data[0], &header, sizeof (header));
+  writeFile (broken_bank_file_name, broken_data);
+  EXPECT_FALSE (bank.open (broken_bank_file_name));
+  EXPECT_FALSE (bank.isOpen ());
+
+  // A bank written with the opposite byte order
+  broken_data = data;
+  const size_t mark_offset = offsetof (LINEMODTemplateBank::Header, byte_order_mark);
+  std::reverse (broken_data.begin () + mark_offset, broken_data.begin () + mark_offset + sizeof (header.byte_order_mark));
+  writeFile (broken_bank_file_name, broken_data);
+  EXPECT_FALSE (bank.open (broken_bank_file_name));
+  EXPECT_FALSE (bank.isOpen ());
+
+  // A truncated bank
+  broken_data.assign (data.begin (), data.end () - 1);
+  writeFile (broken_bank_file_name, broken_data);
+  EXPECT_FALSE (bank.open (broken_bank_file_name));
+  EXPECT_FALSE (bank.isOpen ());
+
+  // The unmodified bank is still accepted
+  EXPECT_TRUE (bank.open (bank_file_name));
+
+  remove (bank_file_name);
+  remove (broken_bank_file_name);
+}
+
+/** \brief A modality with a fixed quantized map, which is used unspread and spread alike */
+class FixedModality : public QuantizableModality
+{
+  public:
+    FixedModality (const QuantizedMap & map) : map_ (map) {}
+
+    virtual QuantizedMap &
+    getQuantizedMap () { return (map_); }
+
+    virtual QuantizedMap &
+    getSpreadedQuantizedMap () { return (map_); }
+
+    virtual void
+    extractFeatures (const MaskMap &, size_t, size_t, vector<QuantizedMultiModFeature> &) const {}
+
+    virtual void
+    extractAllFeatures (const MaskMap &, size_t, size_t, vector<QuantizedMultiModFeature> &) const {}
+
+  private:
+    QuantizedMap map_;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LINEMODScoreKernels)
+{
+  const vector<LINEMODScoreKernels> available = LINEMODScoreKernels::getAvailable ();
+  ASSERT_FALSE (available.empty ());
+  EXPECT_STREQ ("scalar", available.front ().name);
+  EXPECT_STREQ (available.back ().name, LINEMODScoreKernels::getDefault ().name);
+
+  // The size leaves a remainder for the 16 and the 32 byte wide kernels. More than 63 responses are summed up,
+  // so the partial sums are flushed in between; all-4 responses would overflow them otherwise.
+  const size_t mem_size = 32 * 20 + 16 + 7;
+  const size_t nr_responses = 2 * LINEMODScoreKernels::max_nr_pending_responses + 11;
+
+  boost::mt19937 rng (7);
+  boost::uniform_int<int> response_dist (0, 4);
+  vector<unsigned char> responses (nr_responses * mem_size + nr_responses);
+
+  unsigned short * score_sums = reinterpret_cast<unsigned short*> (aligned_malloc (mem_size * sizeof (unsigned short)));
+  unsigned char * tmp_score_sums = reinterpret_cast<unsigned char*> (aligned_malloc (mem_size));
+
+  for (int run = 0; run < 2; ++run)
+  {
+    for (size_t i = 0; i < responses.size (); ++i)
+      responses[i] = static_cast<unsigned char> (run == 0 ? response_dist (rng) : 4);
+
+    // Linearized maps are read at arbitrary offsets, so the data is not aligned
+    vector<unsigned short> expected_score_sums (mem_size, 0);
+    for (size_t response_index = 0; response_index < nr_responses; ++response_index)
+    {
+      const unsigned char * data = &responses[response_index * (mem_size + 1)];
+      for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
+        expected_score_sums[mem_index] = static_cast<unsigned short> (expected_score_sums[mem_index] + data[mem_index]);
+    }
+
+    for (size_t kernel_index = 0; kernel_index < available.size (); ++kernel_index)
+    {
+      SCOPED_TRACE (testing::Message () << available[kernel_index].name << " kernels, run " << run);
+      memset (score_sums, 0, mem_size * sizeof (unsigned short));
+      memset (tmp_score_sums, 0, mem_size);
+
+      size_t nr_pending_responses = 0;
+      for (size_t response_index = 0; response_index < nr_responses; ++response_index)
+        available[kernel_index].addResponse (score_sums, tmp_score_sums, &responses[response_index * (mem_size + 1)],
+                                             mem_size, nr_pending_responses);
+      if (nr_pending_responses > 0)
+        available[kernel_index].flush (score_sums, tmp_score_sums, mem_size);
+
+      for (size_t mem_index = 0; mem_index < mem_size; ++mem_index)
+      {
+        ASSERT_EQ (expected_score_sums[mem_index], score_sums[mem_index]) << "at " << mem_index;
+        ASSERT_EQ (0, tmp_score_sums[mem_index]) << "at " << mem_index;
+      }
+    }
+  }
+
+  aligned_free (score_sums);
+  aligned_free (tmp_score_sums);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LINEMODDetectionThreads)
+{
+  // A random quantized map, the templates are cut out of it, so every template is found at least once
+  const size_t width = 160, height = 120;
+  QuantizedMap map (width, height);
+  boost::mt19937 rng (11);
+  boost::uniform_int<int> bin_dist (0, 7);
+  for (size_t row_index = 0; row_index < height; ++row_index)
+    for (size_t col_index = 0; col_index < width; ++col_index)
+      map (col_index, row_index) = static_cast<unsigned char> ((1 << bin_dist (rng)) | (1 << bin_dist (rng)));
+  FixedModality modality (map);
+  vector<QuantizableModality*> modalities (1, &modality);
+
+  LINEMOD linemod;
+  boost::uniform_int<int> position_dist (0, 31);
+  for (int template_index = 0; template_index < 6; ++template_index)
+  {
+    // the scores are computed on a grid with a step size of 8
+    const size_t x = 16 + 16 * template_index, y = 8 + 8 * template_index;
+    SparseQuantizedMultiModTemplate linemod_template;
+    // 40 features with up to two bins each give more responses than the partial sums hold
+    for (int feature_index = 0; feature_index < 40; ++feature_index)
+    {
+      QuantizedMultiModFeature feature;
+      feature.x = position_dist (rng);
+      feature.y = position_dist (rng);
+      feature.modality_index = 0;
+      feature.quantized_value = map (x + feature.x, y + feature.y);
+      linemod_template.features.push_back (feature);
+    }
+    linemod_template.region.x = static_cast<int> (x);
+    linemod_template.region.y = static_cast<int> (y);
+    linemod_template.region.width = 32;
+    linemod_template.region.height = 32;
+    linemod.addTemplate (linemod_template);
+  }
+  linemod.setDetectionThreshold (0.6f);
+
+  vector<LINEMODDetection> expected_detections;
+  linemod.setNumberOfThreads (1);
+  linemod.detectTemplates (modalities, expected_detections);
+  ASSERT_GE (expected_detections.size (), 6u);
+
+  const unsigned int nr_threads[] = {3, 0};
+  for (int run = 0; run < 2; ++run)
+  {
+    SCOPED_TRACE (testing::Message () << nr_threads[run] << " threads");
+    vector<LINEMODDetection> detections;
+    linemod.setNumberOfThreads (nr_threads[run]);
+    linemod.detectTemplates (modalities, detections);
+
+    ASSERT_EQ (expected_detections.size (), detections.size ());
+    for (size_t i = 0; i < detections.size (); ++i)
+    {
+      EXPECT_EQ (expected_detections[i].x, detections[i].x);
+      EXPECT_EQ (expected_detections[i].y, detections[i].y);
+      EXPECT_EQ (expected_detections[i].template_id, detections[i].template_id);
+      EXPECT_EQ (expected_detections[i].score, detections[i].score);
+      EXPECT_EQ (expected_detections[i].scale, detections[i].scale);
+    }
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  // Three templates of two objects, with distinct features, regions, bounding boxes and clouds
+  const size_t object_ids[] = {3, 7, 3};
+  for (int template_index = 0; template_index < 3; ++template_index)
+  {
+    SparseQuantizedMultiModTemplate linemod_template;
+    for (int feature_index = 0; feature_index < 5 + 3 * template_index; ++feature_index)
+    {
+      QuantizedMultiModFeature feature;
+      feature.x = 2 * feature_index + template_index;
+      feature.y = 30 - feature_index;
+      feature.modality_index = static_cast<size_t> (feature_index % 2);
+      feature.quantized_value = static_cast<unsigned char> (1 << ((feature_index + template_index) % 8));
+      linemod_template.features.push_back (feature);
+    }
+    linemod_template.region.x = 10 * template_index;
+    linemod_template.region.y = 20 + template_index;
+    linemod_template.region.width = 40 + template_index;
+    linemod_template.region.height = 50 - template_index;
+    templates_.push_back (linemod_template);
+    object_ids_.push_back (object_ids[template_index]);
+
+    BoundingBoxXYZ bounding_box;
+    bounding_box.x = 0.1f * static_cast<float> (template_index);
+    bounding_box.y = -0.2f;
+    bounding_box.z = 1.5f;
+    bounding_box.width = 0.3f;
+    bounding_box.height = 0.4f + 0.1f * static_cast<float> (template_index);
+    bounding_box.depth = 0.25f;
+    bounding_boxes_.push_back (bounding_box);
+
+    PointCloud<PointXYZRGBA> cloud;
+    cloud.width = 2 + template_index;
+    cloud.height = 2;
+    for (size_t i = 0; i < cloud.width * cloud.height; ++i)
+    {
+      PointXYZRGBA point;
+      point.x = static_cast<float> (i);
+      point.y = static_cast<float> (template_index);
+      point.z = 1.0f + 0.01f * static_cast<float> (i);
+      point.rgba = static_cast<uint32_t> (0xff000000 + 97 * i + template_index);
+      cloud.points.push_back (point);
+    }
+    clouds_.push_back (cloud);
+  }
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
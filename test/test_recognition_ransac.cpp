@@ -0,0 +1,310 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * $Id: $
+ *
+ */
+#include <gtest/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/recognition/ransac_based/obj_rec_ransac.h>
+#include "test_recognition_shapes.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace pcl;
+using namespace pcl::recognition;
+
+PointCloud<PointXYZ> model_points_[2];
+PointCloud<Normal> model_normals_[2];
+Eigen::Affine3f model_poses_[2];
+PointCloud<PointXYZ> scene_points_;
+PointCloud<Normal> scene_normals_;
+
+const char library_file_name[] = "test_model_library.bin";
+const char broken_library_file_name[] = "test_model_library_broken.bin";
+
+/** \brief The oriented point pairs of a hash table cell: the model name and the indices of the two full leaves of each pair. */
+typedef map<string, vector<pair<int, int> > > CellContents;
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+recognize (unsigned int nr_threads, list<ObjRecRANSAC::Output> & recognized_objects)
+{
+  ObjRecRANSAC objrec (0.04f, 0.01f);
+  objrec.setNumberOfThreads (nr_threads);
+  objrec.setRelativeObjectSize (0.3f);
+  objrec.setVisibility (0.3f);
+  objrec.setSeed (7);
+  EXPECT_EQ (objrec.getSeed (), 7);
+
+  ASSERT_TRUE (objrec.addModel (&model_points_[0], &model_normals_[0], "blob0"));
+  ASSERT_TRUE (objrec.addModel (&model_points_[1], &model_normals_[1], "blob1"));
+
+  objrec.recognize (scene_points_, scene_normals_, recognized_objects);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ObjRecRANSACRecognition)
+{
+  const unsigned int nr_threads[] = {1, 4};
+  list<ObjRecRANSAC::Output> recognized_objects[2];
+
+  for (int run = 0; run < 2; ++run)
+  {
+    recognize (nr_threads[run], recognized_objects[run]);
+
+    // Both models are found at their ground truth poses, up to the voxel size
+    ASSERT_EQ (recognized_objects[run].size (), 2);
+    bool found[2] = {false, false};
+    for (list<ObjRecRANSAC::Output>::const_iterator object = recognized_objects[run].begin (); object != recognized_objects[run].end (); ++object)
+    {
+      ASSERT_TRUE (object->object_name_ == "blob0" || object->object_name_ == "blob1");
+      const int model_index = object->object_name_ == "blob0" ? 0 : 1;
+      EXPECT_FALSE (found[model_index]);
+      found[model_index] = true;
+
+      const Eigen::Matrix4f & ground_truth = model_poses_[model_index].matrix ();
+      for (int i = 0; i < 3; ++i)
+      {
+        for (int j = 0; j < 3; ++j)
+          EXPECT_NEAR (object->rigid_transform_ (i, j), ground_truth (i, j), 0.15f);
+        EXPECT_NEAR (object->rigid_transform_ (i, 3), ground_truth (i, 3), 0.01f);
+      }
+      EXPECT_GT (object->match_confidence_, 0.3);
+    }
+  }
+
+  // With the same seed, the result does not depend on the number of threads
+  ASSERT_EQ (recognized_objects[0].size (), recognized_objects[1].size ());
+  list<ObjRecRANSAC::Output>::const_iterator object1 = recognized_objects[1].begin ();
+  for (list<ObjRecRANSAC::Output>::const_iterator object0 = recognized_objects[0].begin (); object0 != recognized_objects[0].end (); ++object0, ++object1)
+  {
+    EXPECT_EQ (object0->object_name_, object1->object_name_);
+    EXPECT_EQ (object0->match_confidence_, object1->match_confidence_);
+    for (int i = 0; i < 16; ++i)
+      EXPECT_EQ (object0->rigid_transform_ (i), object1->rigid_transform_ (i));
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Describes the hash table by model names and leaf indices, which do not depend on the addresses of the models. */
+void
+getHashTableContents (ModelLibrary & library, vector<CellContents> & contents)
+{
+  const ModelLibrary::HashTable* hash_table = library.getHashTable ();
+  contents.assign (hash_table->getNumberOfVoxels (), CellContents ());
+
+  for (int cell_id = 0; cell_id < hash_table->getNumberOfVoxels (); ++cell_id)
+  {
+    const ModelLibrary::HashTableCell & cell = hash_table->getVoxels ()[cell_id];
+    for (ModelLibrary::HashTableCell::const_iterator model = cell.begin (); model != cell.end (); ++model)
+    {
+      const vector<ORROctree::Node*> & full_leaves = model->first->getOctree ().getFullLeaves ();
+      map<const ORROctree::Node::Data*, int> leaf_ids;
+      for (size_t i = 0; i < full_leaves.size (); ++i)
+        leaf_ids[full_leaves[i]->getData ()] = static_cast<int> (i);
+
+      vector<pair<int, int> > & pairs = contents[cell_id][model->first->obj_name_];
+      for (ModelLibrary::node_data_pair_list::const_iterator p = model->second.begin (); p != model->second.end (); ++p)
+        pairs.push_back (make_pair (leaf_ids[p->first], leaf_ids[p->second]));
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+addModels (ModelLibrary & library)
+{
+  vector<ModelLibrary::PointCloudIn*> points;
+  vector<ModelLibrary::PointCloudN*> normals;
+  vector<string> names;
+  for (int model_index = 0; model_index < 2; ++model_index)
+  {
+    points.push_back (&model_points_[model_index]);
+    normals.push_back (&model_normals_[model_index]);
+    names.push_back (model_index == 0 ? "blob0" : "blob1");
+  }
+  ASSERT_TRUE (library.addModels (points, normals, names));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+readFile (const string & file_name, vector<char> & data)
+{
+  ifstream stream (file_name.c_str (), ifstream::in | ifstream::binary);
+  data.assign (istreambuf_iterator<char> (stream), istreambuf_iterator<char> ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+void
+writeFile (const string & file_name, const vector<char> & data)
+{
+  ofstream stream (file_name.c_str (), ofstream::out | ofstream::binary | ofstream::trunc);
+  stream.write (&data[0], static_cast<streamsize> (data.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ModelLibraryRoundTrip)
+{
+  ModelLibrary library (0.04f, 0.01f);
+  addModels (library);
+  ASSERT_TRUE (library.saveToFile (library_file_name));
+
+  vector<CellContents> contents;
+  getHashTableContents (library, contents);
+
+  const unsigned int nr_threads[] = {1, 3};
+  for (int run = 0; run < 2; ++run)
+  {
+    ModelLibrary loaded_library (0.04f, 0.01f);
+    loaded_library.setNumberOfThreads (nr_threads[run]);
+    ASSERT_TRUE (loaded_library.loadFromFile (library_file_name));
+
+    const map<string, ModelLibrary::Model*> & models = library.getModels ();
+    const map<string, ModelLibrary::Model*> & loaded_models = loaded_library.getModels ();
+    ASSERT_EQ (models.size (), loaded_models.size ());
+    for (map<string, ModelLibrary::Model*>::const_iterator model = models.begin (), loaded_model = loaded_models.begin ();
+         model != models.end (); ++model, ++loaded_model)
+    {
+      EXPECT_EQ (model->first, loaded_model->first);
+      EXPECT_EQ (model->second->obj_name_, loaded_model->second->obj_name_);
+      EXPECT_EQ (model->second->points_->size (), loaded_model->second->points_->size ());
+      EXPECT_EQ (model->second->getOctree ().getFullLeaves ().size (), loaded_model->second->getOctree ().getFullLeaves ().size ());
+    }
+
+    vector<CellContents> loaded_contents;
+    getHashTableContents (loaded_library, loaded_contents);
+    ASSERT_EQ (contents.size (), loaded_contents.size ());
+    size_t nr_pairs = 0;
+    for (size_t cell_id = 0; cell_id < contents.size (); ++cell_id)
+    {
+      EXPECT_TRUE (contents[cell_id] == loaded_contents[cell_id]) << "hash table cell " << cell_id << " differs";
+      for (CellContents::const_iterator model = contents[cell_id].begin (); model != contents[cell_id].end (); ++model)
+        nr_pairs += model->second.size ();
+    }
+    EXPECT_GT (nr_pairs, 0);
+  }
+
+  remove (library_file_name);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ModelLibraryRejection)
+{
+  ModelLibrary library (0.04f, 0.01f);
+  addModels (library);
+  ASSERT_TRUE (library.saveToFile (library_file_name));
+  vector<char> data;
+  readFile (library_file_name, data);
+  ASSERT_GT (data.size (), 16);
+
+  // The header starts with an 8 byte magic, followed by the 32 bit version and byte order mark
+  const size_t version_offset = 8, byte_order_mark_offset = 12;
+  ModelLibrary loaded_library (0.04f, 0.01f);
+
+  vector<char> broken_data (data);
+  broken_data[0] = 'X';
+  writeFile (broken_library_file_name, broken_data);
+  EXPECT_FALSE (loaded_library.loadFromFile (broken_library_file_name));
+  EXPECT_TRUE (loaded_library.getModels ().empty ());
+
+  broken_data = data;
+  ++broken_data[version_offset];
+  writeFile (broken_library_file_name, broken_data);
+  EXPECT_FALSE (loaded_library.loadFromFile (broken_library_file_name));
+  EXPECT_TRUE (loaded_library.getModels ().empty ());
+
+  broken_data = data;
+  reverse (broken_data.begin () + byte_order_mark_offset, broken_data.begin () + byte_order_mark_offset + 4);
+  writeFile (broken_library_file_name, broken_data);
+  EXPECT_FALSE (loaded_library.loadFromFile (broken_library_file_name));
+  EXPECT_TRUE (loaded_library.getModels ().empty ());
+
+  broken_data.assign (data.begin (), data.end () - 1);
+  writeFile (broken_library_file_name, broken_data);
+  EXPECT_FALSE (loaded_library.loadFromFile (broken_library_file_name));
+  EXPECT_TRUE (loaded_library.getModels ().empty ());
+
+  // A library with a different pair width can not use the file
+  ModelLibrary other_library (0.05f, 0.01f);
+  EXPECT_FALSE (other_library.loadFromFile (library_file_name));
+  EXPECT_TRUE (other_library.getModels ().empty ());
+
+  // The unmodified file is still accepted
+  EXPECT_TRUE (loaded_library.loadFromFile (library_file_name));
+  EXPECT_EQ (loaded_library.getModels ().size (), 2);
+
+  remove (library_file_name);
+  remove (broken_library_file_name);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  // Two distinct models, each placed in the scene with a known rigid transform
+  model_poses_[0] = Eigen::Translation3f (0.3f, -0.1f, 0.5f) * Eigen::AngleAxisf (0.7f, Eigen::Vector3f (1.0f, 2.0f, 3.0f).normalized ());
+  model_poses_[1] = Eigen::Translation3f (-0.2f, 0.2f, 0.4f) * Eigen::AngleAxisf (-1.2f, Eigen::Vector3f (0.0f, 1.0f, 1.0f).normalized ());
+  for (int model_index = 0; model_index < 2; ++model_index)
+  {
+    createBlob (model_index, 60, 0.5, model_points_[model_index], &model_normals_[model_index]);
+
+    for (size_t i = 0; i < model_points_[model_index].size (); ++i)
+    {
+      PointXYZ point;
+      point.getVector3fMap () = model_poses_[model_index] * model_points_[model_index][i].getVector3fMap ();
+      scene_points_.push_back (point);
+
+      Normal normal;
+      normal.getNormalVector3fMap () = model_poses_[model_index].linear () * model_normals_[model_index][i].getNormalVector3fMap ();
+      scene_normals_.push_back (normal);
+    }
+  }
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
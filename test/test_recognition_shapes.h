@@ -0,0 +1,79 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_TEST_RECOGNITION_SHAPES_H_
+#define PCL_TEST_RECOGNITION_SHAPES_H_
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <cmath>
+
+/** \brief Samples a closed, irregular blob without rotational symmetries on a grid of nr_rows x 2 * nr_rows points;
+  * 'kind' selects one of several distinct shapes and 'phase' shifts the lobes of all of them.
+  * \param[out] normals if not NULL, receives the radial direction of each point, which is not the exact surface normal
+  * but is the same for a model and a transformed copy of it
+  */
+inline void
+createBlob (int kind, int nr_rows, double phase, pcl::PointCloud<pcl::PointXYZ> & points,
+            pcl::PointCloud<pcl::Normal> * normals = NULL)
+{
+  const double pi = 3.14159265358979323846;
+  const int nr_columns = 2 * nr_rows;
+  for (int i = 0; i < nr_rows; ++i)
+  {
+    for (int j = 0; j < nr_columns; ++j)
+    {
+      const double theta = pi * (i + 0.5) / nr_rows, phi = 2.0 * pi * j / nr_columns;
+      const double r = 0.05 * (1.0 + 0.3 * sin (3.0 * theta + kind + phase) * cos (2.0 * phi) + 0.15 * cos (5.0 * phi + kind));
+
+      pcl::PointXYZ point;
+      point.x = static_cast<float> (r * sin (theta) * cos (phi));
+      point.y = static_cast<float> (r * sin (theta) * sin (phi) * (0.7 + 0.2 * kind));
+      point.z = static_cast<float> (r * cos (theta) * 0.5);
+      points.push_back (point);
+
+      if (normals)
+      {
+        pcl::Normal normal;
+        normal.getNormalVector3fMap () = point.getVector3fMap ().normalized ();
+        normals->push_back (normal);
+      }
+    }
+  }
+}
+
+#endif // PCL_TEST_RECOGNITION_SHAPES_H_
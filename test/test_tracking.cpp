@@ -0,0 +1,262 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2012-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/common/transforms.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/tracking/tracking.h>
+#include <pcl/tracking/particle_filter.h>
+#include <pcl/tracking/particle_filter_omp.h>
+#include <pcl/tracking/coherence.h>
+#include <pcl/tracking/distance_coherence.h>
+#include <pcl/tracking/nearest_pair_point_cloud_coherence.h>
+#include <pcl/tracking/octree_point_cloud_coherence.h>
+
+using namespace pcl;
+using namespace pcl::tracking;
+
+typedef PointXYZ PointType;
+typedef ParticleXYZRPY StateType;
+
+PointCloud<PointType>::Ptr reference_ (new PointCloud<PointType> ());
+PointCloud<PointType>::Ptr input_ (new PointCloud<PointType> ());
+
+/** \brief Gives access to the single steps of a particle filter, so that two trackers can be run on the same particles. */
+template <typename TrackerT>
+class TrackerAccess : public TrackerT
+{
+  public:
+    using TrackerT::initCompute;
+    using TrackerT::weight;
+    using TrackerT::update;
+
+    void
+    setParticles (const PointCloud<StateType> &particles)
+    {
+      *this->particles_ = particles;
+    }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename TrackerT> void
+setUpTracker (TrackerT &tracker, bool use_on_the_fly_transformation)
+{
+  const std::vector<double> step_noise_covariance (6, 0.01 * 0.01);
+  const std::vector<double> initial_noise_covariance (6, 0.02 * 0.02);
+  const std::vector<double> initial_noise_mean (6, 0.0);
+
+  tracker.setTrans (Eigen::Affine3f::Identity ());
+  tracker.setStepNoiseCovariance (step_noise_covariance);
+  tracker.setInitialNoiseCovariance (initial_noise_covariance);
+  tracker.setInitialNoiseMean (initial_noise_mean);
+  tracker.setIterationNum (1);
+  tracker.setParticleNum (100);
+  tracker.setResampleLikelihoodThr (0.0);
+  tracker.setUseNormal (false);
+  tracker.setUseOnTheFlyTransformation (use_on_the_fly_transformation);
+
+  typename NearestPairPointCloudCoherence<PointType>::Ptr coherence (new NearestPairPointCloudCoherence<PointType>);
+  boost::shared_ptr<DistanceCoherence<PointType> > distance_coherence (new DistanceCoherence<PointType>);
+  coherence->addPointCoherence (distance_coherence);
+  boost::shared_ptr<search::KdTree<PointType> > search (new search::KdTree<PointType> (false));
+  coherence->setSearchMethod (search);
+  coherence->setMaximumDistance (0.02);
+  coherence->setBatchSize (16);
+  tracker.setCloudCoherence (coherence);
+
+  tracker.setReferenceCloud (reference_);
+  tracker.setInputCloud (input_);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/** \brief Weights the same particles with the serial and the OpenMP tracker and compares the weights and the
+  * resulting states. The random number generators of the trackers are seeded from the time, so both trackers get
+  * the particles of the serial tracker instead of a common seed.
+  */
+void
+compareSerialAndOMP (bool use_on_the_fly_transformation, unsigned int nr_threads)
+{
+  TrackerAccess<ParticleFilterTracker<PointType, StateType> > serial_tracker;
+  TrackerAccess<ParticleFilterOMPTracker<PointType, StateType> > omp_tracker;
+  setUpTracker (serial_tracker, use_on_the_fly_transformation);
+  setUpTracker (omp_tracker, use_on_the_fly_transformation);
+  omp_tracker.setNumberOfThreads (nr_threads);
+
+  ASSERT_TRUE (serial_tracker.initCompute ());
+  ASSERT_TRUE (omp_tracker.initCompute ());
+  omp_tracker.setParticles (*serial_tracker.getParticles ());
+
+  serial_tracker.weight ();
+  omp_tracker.weight ();
+
+  const PointCloud<StateType> &serial_particles = *serial_tracker.getParticles ();
+  const PointCloud<StateType> &omp_particles = *omp_tracker.getParticles ();
+  ASSERT_EQ (serial_particles.points.size (), omp_particles.points.size ());
+  bool all_equal = true;
+  for (size_t i = 0; i < serial_particles.points.size (); ++i)
+  {
+    EXPECT_EQ (serial_particles.points[i].weight, omp_particles.points[i].weight) << "particle " << i;
+    all_equal = all_equal && serial_particles.points[i].weight == serial_particles.points[0].weight;
+  }
+  // The particles are spread around the object, so they must not all get the same weight
+  EXPECT_FALSE (all_equal);
+
+  serial_tracker.update ();
+  omp_tracker.update ();
+  const StateType serial_result = serial_tracker.getResult (), omp_result = omp_tracker.getResult ();
+  EXPECT_EQ (serial_result.x, omp_result.x);
+  EXPECT_EQ (serial_result.y, omp_result.y);
+  EXPECT_EQ (serial_result.z, omp_result.z);
+  EXPECT_EQ (serial_result.roll, omp_result.roll);
+  EXPECT_EQ (serial_result.pitch, omp_result.pitch);
+  EXPECT_EQ (serial_result.yaw, omp_result.yaw);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, CoherenceWorkspaceCopy)
+{
+  // Copies, e.g. made by std::vector::resize in C++98, must not share the buffers of the original
+  typedef PointCloudCoherence<PointType>::Workspace Workspace;
+  Workspace prototype;
+  prototype.cloud->push_back (PointType (1.0f, 2.0f, 3.0f));
+  prototype.indices->push_back (0);
+  std::vector<Workspace> workspaces (3, prototype);
+  for (size_t i = 0; i < workspaces.size (); ++i)
+  {
+    EXPECT_NE (workspaces[i].cloud.get (), prototype.cloud.get ());
+    EXPECT_NE (workspaces[i].indices.get (), prototype.indices.get ());
+    for (size_t j = 0; j < i; ++j)
+    {
+      EXPECT_NE (workspaces[i].cloud.get (), workspaces[j].cloud.get ());
+      EXPECT_NE (workspaces[i].indices.get (), workspaces[j].indices.get ());
+    }
+    ASSERT_EQ (workspaces[i].cloud->size (), 1);
+    EXPECT_EQ (workspaces[i].cloud->points[0].y, 2.0f);
+    ASSERT_EQ (workspaces[i].indices->size (), 1);
+  }
+
+  Workspace assigned;
+  assigned = prototype;
+  EXPECT_NE (assigned.cloud.get (), prototype.cloud.get ());
+  EXPECT_EQ (assigned.cloud->size (), 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ParticleFilterOMP)
+{
+  compareSerialAndOMP (false, 4);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, ParticleFilterOMPOnTheFly)
+{
+  compareSerialAndOMP (true, 1);
+  compareSerialAndOMP (true, 4);
+  compareSerialAndOMP (true, 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, OctreePointCloudCoherence)
+{
+  // With a resolution not smaller than the maximum distance the octree lookup finds the same pairs as the kd-tree
+  NearestPairPointCloudCoherence<PointType> nearest_pair_coherence;
+  OctreePointCloudCoherence<PointType> octree_coherence (0.02);
+  boost::shared_ptr<DistanceCoherence<PointType> > distance_coherence (new DistanceCoherence<PointType>);
+  nearest_pair_coherence.addPointCoherence (distance_coherence);
+  octree_coherence.addPointCoherence (distance_coherence);
+  boost::shared_ptr<search::KdTree<PointType> > search (new search::KdTree<PointType> (false));
+  nearest_pair_coherence.setSearchMethod (search);
+  nearest_pair_coherence.setMaximumDistance (0.02);
+  octree_coherence.setMaximumDistance (0.02);
+
+  // The second target makes the octree switch its buffers and reuse the nodes of the first one
+  PointCloud<PointType>::Ptr targets[2] = {input_, PointCloud<PointType>::Ptr (new PointCloud<PointType> ())};
+  transformPointCloud (*input_, *targets[1], Eigen::Affine3f (Eigen::Translation3f (0.03f, 0.0f, -0.01f)));
+
+  PointCloudCoherence<PointType>::Workspace workspace;
+  for (int frame = 0; frame < 2; ++frame)
+  {
+    nearest_pair_coherence.setTargetCloud (targets[frame]);
+    octree_coherence.setTargetCloud (targets[frame]);
+    for (int i = 0; i < 10; ++i)
+    {
+      SCOPED_TRACE (testing::Message () << "frame " << frame << ", transformation " << i);
+      const float t = 0.004f * static_cast<float> (i);
+      const Eigen::Affine3f trans = Eigen::Translation3f (t, -0.5f * t, 0.25f * t) *
+                                    Eigen::AngleAxisf (2.0f * t, Eigen::Vector3f::UnitZ ());
+      PointCloud<PointType>::Ptr transformed (new PointCloud<PointType> ());
+      transformPointCloud (*reference_, *transformed, trans);
+
+      float expected_weight = 0.0f, weight = 0.0f, transformed_weight = 0.0f;
+      nearest_pair_coherence.compute (transformed, IndicesConstPtr (), expected_weight);
+      octree_coherence.compute (transformed, IndicesConstPtr (), weight);
+      octree_coherence.computeTransformed (*reference_, trans, workspace, transformed_weight);
+      EXPECT_LT (expected_weight, 0.0f);
+      EXPECT_NEAR (expected_weight, weight, 1e-5f * fabsf (expected_weight));
+      EXPECT_NEAR (expected_weight, transformed_weight, 1e-5f * fabsf (expected_weight));
+    }
+  }
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  // The reference is the surface of a box, the input is the same box moved by a few millimeters
+  for (float u = -0.05f; u <= 0.0501f; u += 0.01f)
+  {
+    for (float v = -0.05f; v <= 0.0501f; v += 0.01f)
+    {
+      reference_->push_back (PointType (u, v, -0.05f));
+      reference_->push_back (PointType (u, v, 0.05f));
+      reference_->push_back (PointType (u, -0.05f, v));
+      reference_->push_back (PointType (u, 0.05f, v));
+      reference_->push_back (PointType (-0.05f, u, v));
+      reference_->push_back (PointType (0.05f, u, v));
+    }
+  }
+  const Eigen::Affine3f motion = Eigen::Translation3f (0.004f, -0.003f, 0.002f) *
+                                 Eigen::AngleAxisf (0.05f, Eigen::Vector3f::UnitZ ());
+  transformPointCloud (*reference_, *input_, motion);
+
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -140,9 +140,9 @@ compute (const PointCloudXYZRGBA::ConstPtr & input, const char * templates_filen
     if (d.score < 0.6)
       continue;
 
-    const pcl::SparseQuantizedMultiModTemplate & tmplt = linemod.getTemplate (d.template_id);
-    int w = tmplt.region.width;
-    int h = tmplt.region.height;
+    const pcl::RegionXY region = linemod.getTemplateRegion (d.template_id);
+    int w = region.width;
+    int h = region.height;
     for (int x = d.x; x < d.x+w; ++x)
     {
       image[d.y][x] = png::rgb_pixel(0, 255, 0);
@@ -19,6 +19,8 @@ namespace pcl
     public:
       typedef typename NearestPairPointCloudCoherence<PointInT>::PointCoherencePtr PointCoherencePtr;
       typedef typename NearestPairPointCloudCoherence<PointInT>::PointCloudInConstPtr PointCloudInConstPtr;
+      typedef typename NearestPairPointCloudCoherence<PointInT>::PointCloudIn PointCloudIn;
+      typedef typename NearestPairPointCloudCoherence<PointInT>::Workspace Workspace;
       //using NearestPairPointCloudCoherence<PointInT>::search_;
       using NearestPairPointCloudCoherence<PointInT>::maximum_distance_;
       using NearestPairPointCloudCoherence<PointInT>::target_input_;
@@ -34,6 +36,16 @@ namespace pcl
         coherence_name_ = "ApproxNearestPairPointCloudCoherence";
       }
       
+      /** \brief compute coherence between the target cloud and cloud transformed by trans. The points are
+        * transformed one at a time and looked up approximately in the octree, without any scratch cloud.
+        * \param[in] cloud the pointcloud to be transformed
+        * \param[in] trans the transformation applied to cloud
+        * \param[in] workspace unused
+        * \param[out] w the coherence
+        */
+      virtual void
+      computeTransformed (const PointCloudIn &cloud, const Eigen::Affine3f &trans, Workspace &workspace, float &w);
+
     protected:
       /** \brief This method should get called before starting the actual computation. */
       virtual bool initCompute ();
@@ -2,6 +2,7 @@
 #define PCL_TRACKING_COHERENCE_H_
 
 #include <pcl/pcl_base.h>
+#include <pcl/common/eigen.h>
 
 namespace pcl
 {
@@ -68,6 +69,48 @@ namespace pcl
       typedef typename PointCloudIn::ConstPtr PointCloudInConstPtr;
       
       typedef typename PointCoherence<PointInT>::Ptr PointCoherencePtr;
+
+      /** \brief Scratch buffers used by computeTransformed (). Keep one per thread across calls, so that no memory
+        * is allocated once the buffers have grown to their working size.
+        */
+      struct Workspace
+      {
+        Workspace ()
+          : cloud (new PointCloudIn), indices (new std::vector<int>), k_indices (), k_sqr_distances ()
+        {}
+
+        /** \brief Copy constructor. Copies the buffers, so that no two workspaces (e.g. the elements of a resized
+          * std::vector) share a cloud or indices.
+          */
+        Workspace (const Workspace &other)
+          : cloud (new PointCloudIn (*other.cloud)), indices (new std::vector<int> (*other.indices))
+          , k_indices (other.k_indices), k_sqr_distances (other.k_sqr_distances)
+        {}
+
+        /** \brief Copy the buffers of other into the buffers of this workspace. */
+        Workspace&
+        operator= (const Workspace &other)
+        {
+          *cloud = *other.cloud;
+          *indices = *other.indices;
+          k_indices = other.k_indices;
+          k_sqr_distances = other.k_sqr_distances;
+          return (*this);
+        }
+
+        /** \brief The transformed points. */
+        PointCloudInPtr cloud;
+
+        /** \brief The indices of the transformed points to be taken into account. */
+        IndicesPtr indices;
+
+        /** \brief The nearest neighbor indices of a batch of query points. */
+        std::vector<std::vector<int> > k_indices;
+
+        /** \brief The nearest neighbor squared distances of a batch of query points. */
+        std::vector<std::vector<float> > k_sqr_distances;
+      };
+
       /** \brief Constructor. */
       PointCloudCoherence () : coherence_name_ (), target_input_ (), point_coherences_ () {}
 
@@ -79,6 +122,17 @@ namespace pcl
       compute (const PointCloudInConstPtr &cloud, const IndicesConstPtr &indices,
                float &w_i);
 
+      /** \brief compute coherence between the target cloud and a cloud transformed by trans, without creating a
+        * transformed copy of the cloud for every call. initCompute () has to be called first; afterwards this method
+        * can be called concurrently as long as every thread uses its own workspace.
+        * \param[in] cloud the pointcloud to be transformed, e.g. the reference cloud of a tracker
+        * \param[in] trans the transformation applied to cloud
+        * \param[in] workspace the scratch buffers to use
+        * \param[out] w the coherence
+        */
+      virtual void
+      computeTransformed (const PointCloudIn &cloud, const Eigen::Affine3f &trans, Workspace &workspace, float &w);
+
       /** \brief get a list of pcl::tracking::PointCoherence.*/
       inline std::vector<PointCoherencePtr>
       getPointCoherences () { return point_coherences_; }
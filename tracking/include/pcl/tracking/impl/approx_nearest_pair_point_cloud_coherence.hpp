@@ -36,6 +36,30 @@ namespace pcl
       w = - static_cast<float> (val);
     }
 
+    template <typename PointInT> void
+    ApproxNearestPairPointCloudCoherence<PointInT>::computeTransformed (
+        const PointCloudIn &cloud, const Eigen::Affine3f &trans, Workspace &, float &w)
+    {
+      double val = 0.0;
+      for (size_t i = 0; i < cloud.points.size (); i++)
+      {
+        int k_index = 0;
+        float k_distance = 0.0;
+        PointInT input_point = cloud.points[i];
+        input_point.getVector3fMap () = trans * cloud.points[i].getVector3fMap ();
+        search_->approxNearestSearch (input_point, k_index, k_distance);
+        if (k_distance < maximum_distance_ * maximum_distance_)
+        {
+          PointInT target_point = target_input_->points[k_index];
+          double coherence_val = 1.0;
+          for (size_t j = 0; j < point_coherences_.size (); j++)
+            coherence_val *= point_coherences_[j]->compute (input_point, target_point);
+          val += coherence_val;
+        }
+      }
+      w = - static_cast<float> (val);
+    }
+
     template <typename PointInT> bool
     ApproxNearestPairPointCloudCoherence<PointInT>::initCompute ()
     {
@@ -1,6 +1,8 @@
 #ifndef PCL_TRACKING_IMPL_COHERENCE_H_
 #define PCL_TRACKING_IMPL_COHERENCE_H_
 
+#include <pcl/common/transforms.h>
+
 namespace pcl
 {
   namespace tracking
@@ -52,6 +54,15 @@ namespace pcl
       }
       computeCoherence (cloud, indices, w);
     }
+
+    template <typename PointInT> void
+    PointCloudCoherence<PointInT>::computeTransformed (const PointCloudIn &cloud, const Eigen::Affine3f &trans,
+                                                       Workspace &workspace, float &w)
+    {
+      // the workspace cloud keeps its storage, so this does not allocate after the first call
+      pcl::transformPointCloud<PointInT> (cloud, *workspace.cloud, trans);
+      computeCoherence (workspace.cloud, IndicesConstPtr (), w);
+    }
   }
 }
 
@@ -40,6 +40,44 @@ namespace pcl
       w = - static_cast<float> (val);
     }
     
+    template <typename PointInT> void 
+    NearestPairPointCloudCoherence<PointInT>::computeTransformed (
+        const PointCloudIn &cloud, const Eigen::Affine3f &trans, Workspace &workspace, float &w)
+    {
+      PointCloudIn &batch = *workspace.cloud;
+      const std::vector<int> all_indices;   // empty, i.e. query every point of the batch
+      const size_t batch_size = static_cast<size_t> ((std::max) (batch_size_, 1));
+      const double maximum_sqr_distance = maximum_distance_ * maximum_distance_;
+      double val = 0.0;
+      for (size_t start = 0; start < cloud.points.size (); start += batch_size)
+      {
+        const size_t end = (std::min) (start + batch_size, cloud.points.size ());
+        batch.points.resize (end - start);
+        batch.width = static_cast<uint32_t> (end - start);
+        batch.height = 1;
+        for (size_t i = start; i < end; i++)
+        {
+          PointInT &input_point = batch.points[i - start];
+          input_point = cloud.points[i];
+          input_point.getVector3fMap () = trans * cloud.points[i].getVector3fMap ();
+        }
+
+        search_->nearestKSearch (batch, all_indices, 1, workspace.k_indices, workspace.k_sqr_distances);
+
+        for (size_t j = 0; j < batch.points.size (); j++)
+        {
+          if (workspace.k_indices[j].empty () || workspace.k_sqr_distances[j][0] >= maximum_sqr_distance)
+            continue;
+          PointInT target_point = target_input_->points[workspace.k_indices[j][0]];
+          double coherence_val = 1.0;
+          for (size_t i = 0; i < point_coherences_.size (); i++)
+            coherence_val *= point_coherences_[i]->compute (batch.points[j], target_point);
+          val += coherence_val;
+        }
+      }
+      w = - static_cast<float> (val);
+    }
+
     template <typename PointInT> bool
     NearestPairPointCloudCoherence<PointInT>::initCompute ()
     {
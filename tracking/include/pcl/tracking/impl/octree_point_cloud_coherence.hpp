@@ -0,0 +1,153 @@
+#ifndef PCL_TRACKING_IMPL_OCTREE_POINT_CLOUD_COHERENCE_H_
+#define PCL_TRACKING_IMPL_OCTREE_POINT_CLOUD_COHERENCE_H_
+
+#include <pcl/octree/octree_pointcloud_changedetector.h>
+
+namespace pcl
+{
+  namespace tracking
+  {
+    template <typename PointInT> bool
+    OctreePointCloudCoherence<PointInT>::TargetOctree::approxNearestSearch (
+        const PointInT &point, int &index, float &sqr_distance) const
+    {
+      index = -1;
+      sqr_distance = std::numeric_limits<float>::max ();
+      if (!this->input_ || !pcl_isfinite (point.x) || !pcl_isfinite (point.y) || !pcl_isfinite (point.z))
+        return (false);
+
+      // voxel coordinates of the query point, possibly outside of the bounding box
+      const double key_x = floor ((point.x - this->minX_) / this->resolution_);
+      const double key_y = floor ((point.y - this->minY_) / this->resolution_);
+      const double key_z = floor ((point.z - this->minZ_) / this->resolution_);
+      const double max_key = static_cast<double> (1 << this->octreeDepth_);
+
+      // findLeaf masks the key bits, so neighbors outside of the octree have to be rejected here
+      for (int dx = -1; dx <= 1; ++dx)
+      {
+        const double x = key_x + dx;
+        if (x < 0 || x >= max_key)
+          continue;
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+          const double y = key_y + dy;
+          if (y < 0 || y >= max_key)
+            continue;
+          for (int dz = -1; dz <= 1; ++dz)
+          {
+            const double z = key_z + dz;
+            if (z < 0 || z >= max_key)
+              continue;
+
+            pcl::octree::OctreeKey key;
+            key.x = static_cast<unsigned int> (x);
+            key.y = static_cast<unsigned int> (y);
+            key.z = static_cast<unsigned int> (z);
+
+            const LeafNode* leaf = this->findLeaf (key);
+            if (!leaf)
+              continue;
+
+            const std::vector<int> &leaf_indices = leaf->getDataTVector ();
+            for (size_t i = 0; i < leaf_indices.size (); ++i)
+            {
+              const float d = (this->input_->points[leaf_indices[i]].getVector3fMap () - point.getVector3fMap ()).squaredNorm ();
+              if (d < sqr_distance)
+              {
+                sqr_distance = d;
+                index = leaf_indices[i];
+              }
+            }
+          }
+        }
+      }
+      return (index != -1);
+    }
+
+    template <typename PointInT> void
+    OctreePointCloudCoherence<PointInT>::computeCoherence (
+        const PointCloudInConstPtr &cloud, const IndicesConstPtr &, float &w)
+    {
+      double val = 0.0;
+      for (size_t i = 0; i < cloud->points.size (); i++)
+      {
+        int k_index = 0;
+        float k_distance = 0.0;
+        PointInT input_point = cloud->points[i];
+        if (!octree_->approxNearestSearch (input_point, k_index, k_distance))
+          continue;
+        if (k_distance < maximum_distance_ * maximum_distance_)
+        {
+          PointInT target_point = target_input_->points[k_index];
+          double coherence_val = 1.0;
+          for (size_t j = 0; j < point_coherences_.size (); j++)
+            coherence_val *= point_coherences_[j]->compute (input_point, target_point);
+          val += coherence_val;
+        }
+      }
+      w = - static_cast<float> (val);
+    }
+
+    template <typename PointInT> void
+    OctreePointCloudCoherence<PointInT>::computeTransformed (
+        const PointCloudIn &cloud, const Eigen::Affine3f &trans, Workspace &, float &w)
+    {
+      double val = 0.0;
+      for (size_t i = 0; i < cloud.points.size (); i++)
+      {
+        int k_index = 0;
+        float k_distance = 0.0;
+        PointInT input_point = cloud.points[i];
+        input_point.getVector3fMap () = trans * cloud.points[i].getVector3fMap ();
+        if (!octree_->approxNearestSearch (input_point, k_index, k_distance))
+          continue;
+        if (k_distance < maximum_distance_ * maximum_distance_)
+        {
+          PointInT target_point = target_input_->points[k_index];
+          double coherence_val = 1.0;
+          for (size_t j = 0; j < point_coherences_.size (); j++)
+            coherence_val *= point_coherences_[j]->compute (input_point, target_point);
+          val += coherence_val;
+        }
+      }
+      w = - static_cast<float> (val);
+    }
+
+    template <typename PointInT> bool
+    OctreePointCloudCoherence<PointInT>::initCompute ()
+    {
+      if (!PointCloudCoherence<PointInT>::initCompute ())
+      {
+        PCL_ERROR ("[pcl::%s::initCompute] PointCloudCoherence::Init failed.\n", getClassName ().c_str ());
+        return (false);
+      }
+
+      if (resolution_ <= 0.0)
+      {
+        PCL_ERROR ("[pcl::%s::initCompute] Invalid octree resolution %f.\n", getClassName ().c_str (), resolution_);
+        return (false);
+      }
+
+      if (!octree_)
+      {
+        octree_.reset (new TargetOctree (resolution_));
+        new_target_ = true;
+      }
+
+      if (new_target_ && target_input_)
+      {
+        // keep the previous frame in the other buffer and reuse its nodes for the new target
+        octree_->switchBuffers ();
+        octree_->setInputCloud (target_input_);
+        octree_->addPointsFromInputCloud ();
+        new_target_ = false;
+      }
+
+      return (true);
+    }
+  }
+}
+
+#define PCL_INSTANTIATE_OctreePointCloudCoherence(T) template class PCL_EXPORTS pcl::tracking::OctreePointCloudCoherence<T>;
+
+#endif
@@ -15,7 +15,7 @@ pcl::tracking::ParticleFilterTracker<PointInT, StateT>::initCompute ()
     return (false);
   }
 
-  if (transed_reference_vector_.empty ())
+  if (transed_reference_vector_.empty () && !use_on_the_fly_transformation_)
   {
     // only one time allocation
     transed_reference_vector_.resize (particle_num_);
@@ -193,6 +193,31 @@ pcl::tracking::ParticleFilterTracker<PointInT, StateT>::calcBoundingBox (
 {
   x_min = y_min = z_min = std::numeric_limits<double>::max ();
   x_max = y_max = z_max = - std::numeric_limits<double>::max ();
+
+  if (use_on_the_fly_transformation_)
+  {
+    // the transformed corners of the bounding box of the reference enclose the transformed reference
+    PointInT ref_min, ref_max;
+    pcl::getMinMax3D (*ref_, ref_min, ref_max);
+    for (size_t i = 0; i < particles_->points.size (); i++)
+    {
+      const Eigen::Affine3f trans = toEigenMatrix (particles_->points[i]);
+      for (int c = 0; c < 8; c++)
+      {
+        const Eigen::Vector3f corner ((c & 1) ? ref_max.x : ref_min.x,
+                                      (c & 2) ? ref_max.y : ref_min.y,
+                                      (c & 4) ? ref_max.z : ref_min.z);
+        const Eigen::Vector3f p = trans * corner;
+        x_min = std::min (x_min, static_cast<double> (p[0]));
+        x_max = std::max (x_max, static_cast<double> (p[0]));
+        y_min = std::min (y_min, static_cast<double> (p[1]));
+        y_max = std::max (y_max, static_cast<double> (p[1]));
+        z_min = std::min (z_min, static_cast<double> (p[2]));
+        z_max = std::max (z_max, static_cast<double> (p[2]));
+      }
+    }
+    return;
+  }
   
   for (size_t i = 0; i < transed_reference_vector_.size (); i++)
   {
@@ -227,9 +252,36 @@ pcl::tracking::ParticleFilterTracker<PointInT, StateT>::testChangeDetection
 }
 
 template <typename PointInT, typename StateT> void
-pcl::tracking::ParticleFilterTracker<PointInT, StateT>::weight ()
+pcl::tracking::ParticleFilterTracker<PointInT, StateT>::weightOnTheFly (StateT &particle, CoherenceWorkspace &workspace)
 {
   if (!use_normal_)
+  {
+    coherence_->computeTransformed (*ref_, toEigenMatrix (particle), workspace, particle.weight);
+    return;
+  }
+
+  // the occlusion test needs the transformed normals, so the reference goes through the workspace cloud
+  workspace.indices->clear ();
+  computeTransformedPointCloudWithNormal (particle, *workspace.indices, *workspace.cloud);
+  coherence_->compute (workspace.cloud, workspace.indices, particle.weight);
+}
+
+template <typename PointInT, typename StateT> void
+pcl::tracking::ParticleFilterTracker<PointInT, StateT>::weight ()
+{
+  if (use_on_the_fly_transformation_)
+  {
+    PointCloudInPtr coherence_input (new PointCloudIn);
+    cropInputPointCloud (input_, *coherence_input);
+    
+    coherence_->setTargetCloud (coherence_input);
+    coherence_->initCompute ();
+    if (workspaces_.empty ())
+      workspaces_.resize (1);
+    for (size_t i = 0; i < particles_->points.size (); i++)
+      weightOnTheFly (particles_->points[i], workspaces_[0]);
+  }
+  else if (!use_normal_)
   {
     for (size_t i = 0; i < particles_->points.size (); i++)
     {
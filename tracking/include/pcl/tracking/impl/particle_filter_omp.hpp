@@ -1,10 +1,58 @@
 #ifndef PCL_TRACKING_IMPL_PARTICLE_OMP_FILTER_H_
 #define PCL_TRACKING_IMPL_PARTICLE_OMP_FILTER_H_
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 template <typename PointInT, typename StateT> void
 pcl::tracking::ParticleFilterOMPTracker<PointInT, StateT>::weight ()
 {
-  if (!use_normal_)
+  if (use_on_the_fly_transformation_)
+  {
+    PointCloudInPtr coherence_input (new PointCloudIn);
+    this->cropInputPointCloud (input_, *coherence_input);
+    bool update_weights = true;
+    if (!use_normal_)
+    {
+      if (change_counter_ == 0)
+      {
+        // test change detector
+        changed_ = update_weights = !use_change_detector_ || this->testChangeDetection (coherence_input);
+        if (changed_)
+          change_counter_ = change_detector_interval_;
+      }
+      else
+        --change_counter_;
+    }
+
+    if (update_weights)
+    {
+      coherence_->setTargetCloud (coherence_input);
+      coherence_->initCompute ();
+#ifdef _OPENMP
+      const int nr_threads = threads_ ? static_cast<int> (threads_) : omp_get_max_threads ();
+#else
+      const int nr_threads = 1;
+#endif
+      // every workspace gets its own buffers, see Workspace (const Workspace&)
+      if (static_cast<int> (workspaces_.size ()) < nr_threads)
+        workspaces_.resize (nr_threads);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16) num_threads(nr_threads)
+#endif
+      for (int i = 0; i < particle_num_; i++)
+      {
+#ifdef _OPENMP
+        const int tid = omp_get_thread_num ();
+#else
+        const int tid = 0;
+#endif
+        this->weightOnTheFly (particles_->points[i], workspaces_[tid]);
+      }
+    }
+  }
+  else if (!use_normal_)
   {
 #ifdef _OPENMP
 #pragma omp parallel for num_threads(threads_)
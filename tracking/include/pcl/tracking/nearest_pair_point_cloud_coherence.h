@@ -24,6 +24,8 @@ namespace pcl
         
         typedef typename PointCloudCoherence<PointInT>::PointCoherencePtr PointCoherencePtr;
         typedef typename PointCloudCoherence<PointInT>::PointCloudInConstPtr PointCloudInConstPtr;
+        typedef typename PointCloudCoherence<PointInT>::PointCloudIn PointCloudIn;
+        typedef typename PointCloudCoherence<PointInT>::Workspace Workspace;
         typedef PointCloudCoherence<PointInT> BaseClass;
         
         typedef boost::shared_ptr<NearestPairPointCloudCoherence<PointInT> > Ptr;
@@ -36,6 +38,7 @@ namespace pcl
           : new_target_ (false)
           , search_ ()
           , maximum_distance_ (std::numeric_limits<double>::max ())
+          , batch_size_ (64)
         {
           coherence_name_ = "NearestPairPointCloudCoherence";
         }
@@ -69,6 +72,24 @@ namespace pcl
           */
         inline void setMaximumDistance (double val) { maximum_distance_ = val; }
 
+        /** \brief set the number of points computeTransformed () transforms into the workspace at a time.
+          * \param[in] batch_size the number of points per batch (default: 64).
+          */
+        inline void setBatchSize (int batch_size) { batch_size_ = batch_size; }
+
+        /** \brief get the number of points computeTransformed () transforms into the workspace at a time. */
+        inline int getBatchSize () const { return (batch_size_); }
+
+        /** \brief compute coherence between the target cloud and cloud transformed by trans. The points are
+          * transformed in batches into the workspace, then the nearest neighbor of each point is looked up.
+          * \param[in] cloud the pointcloud to be transformed
+          * \param[in] trans the transformation applied to cloud
+          * \param[in] workspace the scratch buffers to use
+          * \param[out] w the coherence
+          */
+        virtual void
+        computeTransformed (const PointCloudIn &cloud, const Eigen::Affine3f &trans, Workspace &workspace, float &w);
+
       protected:
         using PointCloudCoherence<PointInT>::point_coherences_;
 
@@ -83,6 +104,9 @@ namespace pcl
 
         /** \brief max of distance for points to be taken into account*/
         double maximum_distance_;
+
+        /** \brief the number of points looked up at once in computeTransformed (). */
+        int batch_size_;
         
         /** \brief compute the nearest pairs and compute coherence using point_coherences_ */
         virtual void
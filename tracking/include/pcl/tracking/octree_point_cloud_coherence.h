@@ -0,0 +1,116 @@
+#ifndef PCL_TRACKING_OCTREE_POINT_CLOUD_COHERENCE_H_
+#define PCL_TRACKING_OCTREE_POINT_CLOUD_COHERENCE_H_
+
+#include <pcl/octree/octree_pointcloud_changedetector.h>
+#include <pcl/tracking/nearest_pair_point_cloud_coherence.h>
+
+namespace pcl
+{
+  namespace tracking
+  {
+    /** \brief @b OctreePointCloudCoherence computes coherence between two pointclouds using the
+      * approximate nearest point pairs found in a double-buffered octree (pcl::octree::Octree2BufBase).
+      * When a new target cloud is set, the octree switches buffers and re-inserts the target points,
+      * reusing the branch and leaf nodes of the previous frame so that only the voxels which changed
+      * between consecutive frames are allocated or released.
+      * Nearest neighbor queries are answered directly from the leaf keys by scanning the 3x3x3 voxel
+      * neighborhood of the query point. The result is exact for neighbors closer than the octree
+      * resolution, so the resolution should not be smaller than the maximum distance.
+      * \ingroup tracking
+      */
+    template <typename PointInT>
+    class OctreePointCloudCoherence: public NearestPairPointCloudCoherence<PointInT>
+    {
+    public:
+      typedef typename NearestPairPointCloudCoherence<PointInT>::PointCoherencePtr PointCoherencePtr;
+      typedef typename NearestPairPointCloudCoherence<PointInT>::PointCloudInConstPtr PointCloudInConstPtr;
+      typedef typename NearestPairPointCloudCoherence<PointInT>::PointCloudIn PointCloudIn;
+      typedef typename NearestPairPointCloudCoherence<PointInT>::Workspace Workspace;
+      using NearestPairPointCloudCoherence<PointInT>::maximum_distance_;
+      using NearestPairPointCloudCoherence<PointInT>::target_input_;
+      using NearestPairPointCloudCoherence<PointInT>::point_coherences_;
+      using NearestPairPointCloudCoherence<PointInT>::coherence_name_;
+      using NearestPairPointCloudCoherence<PointInT>::new_target_;
+      using NearestPairPointCloudCoherence<PointInT>::getClassName;
+
+      /** \brief @b TargetOctree is a change detector octree which answers approximate nearest neighbor
+        * queries from the point indices stored in its leaf nodes.
+        */
+      class TargetOctree : public pcl::octree::OctreePointCloudChangeDetector<PointInT>
+      {
+        public:
+          typedef pcl::octree::OctreePointCloudChangeDetector<PointInT> OctreeT;
+          typedef typename OctreeT::LeafNode LeafNode;
+
+          /** \brief Constructor.
+            * \param[in] resolution octree resolution at lowest octree level
+            */
+          TargetOctree (const double resolution) : OctreeT (resolution) {}
+
+          /** \brief Search for the nearest target point in the 3x3x3 voxel neighborhood of a query point.
+            * \param[in] point the query point
+            * \param[out] index the index of the nearest target point
+            * \param[out] sqr_distance the squared distance to the nearest target point
+            * \return true if a target point was found in the neighborhood
+            */
+          bool
+          approxNearestSearch (const PointInT &point, int &index, float &sqr_distance) const;
+      };
+
+      /** \brief empty constructor
+        * \param[in] resolution the side length of the octree voxels (default: 0.01)
+        */
+      OctreePointCloudCoherence (double resolution = 0.01) :
+        NearestPairPointCloudCoherence<PointInT> (), resolution_ (resolution), octree_ ()
+      {
+        coherence_name_ = "OctreePointCloudCoherence";
+      }
+
+      /** \brief set the side length of the octree voxels. The octree is rebuilt from scratch on the
+        * next call to compute ().
+        * \param[in] resolution the voxel side length
+        */
+      inline void
+      setResolution (double resolution)
+      {
+        resolution_ = resolution;
+        octree_.reset ();
+        new_target_ = true;
+      }
+
+      /** \brief get the side length of the octree voxels. */
+      inline double
+      getResolution () const { return (resolution_); }
+
+      /** \brief compute coherence between the target cloud and cloud transformed by trans. The points are
+        * transformed one at a time and looked up in the octree, without any scratch cloud.
+        * \param[in] cloud the pointcloud to be transformed
+        * \param[in] trans the transformation applied to cloud
+        * \param[in] workspace unused
+        * \param[out] w the coherence
+        */
+      virtual void
+      computeTransformed (const PointCloudIn &cloud, const Eigen::Affine3f &trans, Workspace &workspace, float &w);
+
+    protected:
+      /** \brief This method should get called before starting the actual computation. */
+      virtual bool initCompute ();
+
+      /** \brief compute the nearest pairs and compute coherence using point_coherences_ */
+      virtual void
+      computeCoherence (const PointCloudInConstPtr &cloud, const IndicesConstPtr &indices, float &w_j);
+
+      /** \brief the side length of the octree voxels. */
+      double resolution_;
+
+      /** \brief the double-buffered octree holding the target cloud. */
+      boost::shared_ptr<TargetOctree> octree_;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/tracking/impl/octree_point_cloud_coherence.hpp>
+#endif
+
+#endif
@@ -49,6 +49,7 @@ namespace pcl
         typedef PointCloudCoherence<PointInT> CloudCoherence;
         typedef boost::shared_ptr< CloudCoherence > CloudCoherencePtr;
         typedef boost::shared_ptr< const CloudCoherence > CloudCoherenceConstPtr;
+        typedef typename CloudCoherence::Workspace CoherenceWorkspace;
         
         /** \brief Empty constructor. */
         ParticleFilterTracker ()
@@ -80,6 +81,8 @@ namespace pcl
         , change_detector_interval_ (10)
         , change_detector_resolution_ (0.01)
         , use_change_detector_ (false)
+        , use_on_the_fly_transformation_ (false)
+        , workspaces_ ()
         {
           tracker_name_ = "ParticleFilterTracker";
           pass_x_.setFilterFieldName ("x");
@@ -246,6 +249,19 @@ namespace pcl
         /** \brief Get the value of use_change_detector_. */
         inline bool getUseChangeDetector () { return use_change_detector_; }
 
+        /** \brief Set the value of use_on_the_fly_transformation_. If true, the reference cloud is not transformed
+          * into a separate pointcloud for every particle; instead, the coherence transforms the reference points on
+          * the fly into a small per-thread workspace (see PointCloudCoherence::computeTransformed).
+          * \param[in] use_on_the_fly_transformation the value of use_on_the_fly_transformation_.
+          */
+        inline void setUseOnTheFlyTransformation (bool use_on_the_fly_transformation)
+        {
+          use_on_the_fly_transformation_ = use_on_the_fly_transformation;
+        }
+
+        /** \brief Get the value of use_on_the_fly_transformation_. */
+        inline bool getUseOnTheFlyTransformation () { return use_on_the_fly_transformation_; }
+
         /** \brief Set the motion ratio
           * \param[in] motion_ratio the ratio of hypothesis to use motion model.
          */
@@ -351,6 +367,14 @@ namespace pcl
                                                         PointCloudIn &cloud);
 
         
+        /** \brief Compute the likelihood of a particle without creating a transformed copy of the reference
+          * pointcloud, used if use_on_the_fly_transformation_ is true. The target cloud of coherence_ has to be set
+          * and initialized beforehand.
+          * \param[in,out] particle the particle to be weighted.
+          * \param[in] workspace the scratch buffers of the calling thread.
+          */
+        void weightOnTheFly (StateT &particle, CoherenceWorkspace &workspace);
+
         /** \brief This method should get called before starting the actual computation. */
         virtual bool initCompute ();
         
@@ -500,6 +524,12 @@ namespace pcl
         
         /** \brief The flag which will be true if using change detection. */
         bool use_change_detector_;
+
+        /** \brief A flag to transform the reference points on the fly while weighting. defaults to false. */
+        bool use_on_the_fly_transformation_;
+
+        /** \brief The scratch buffers of the coherence, one per thread. */
+        std::vector<CoherenceWorkspace> workspaces_;
     };
   }
 }
@@ -40,6 +40,8 @@ namespace pcl
       using ParticleFilterTracker<PointInT, StateT>::normalizeWeight;
       using ParticleFilterTracker<PointInT, StateT>::normalizeParticleWeight;
       using ParticleFilterTracker<PointInT, StateT>::calcBoundingBox;
+      using ParticleFilterTracker<PointInT, StateT>::use_on_the_fly_transformation_;
+      using ParticleFilterTracker<PointInT, StateT>::workspaces_;
 
       typedef Tracker<PointInT, StateT> BaseClass;
       